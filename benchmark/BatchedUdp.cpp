@@ -0,0 +1,147 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////
+// Batched udp benchmark.
+//
+// Sends datagrams over the loopback interface from a thread to a
+// receiving socket, one call per datagram or in batches by
+// SendBatch and ReceiveBatch. Reports the received datagrams per second.
+//
+// Usage: BatchedUdp [batch = 32] [datagrams = 1000000] [size = 100]
+//        A batch size of 1 uses Send and Receive.
+//
+////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/UdpSocket.hpp>
+#include <Bit/System/Thread.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Benchmark.hpp>
+#include <atomic>
+#include <cstdio>
+#include <vector>
+
+using namespace Bit;
+
+static const Uint16 g_Port = 12381;
+
+int main( int p_ArgumentCount, char ** p_ppArguments )
+{
+	const Int32 batchSize = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 1, 32 );
+	const Int32 datagramCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 2, 1000000 );
+	const Int32 datagramSize = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 3, 100 );
+
+	if( batchSize < 1 || datagramCount < 1 || datagramSize < 1 || datagramSize > 1400 )
+	{
+		std::printf( "Invalid arguments.\n" );
+		return 1;
+	}
+
+	UdpSocket receiver;
+	UdpSocket sender;
+	if( receiver.Open( g_Port ) == false || sender.Open( 0 ) == false )
+	{
+		std::printf( "Failed to open the sockets.\n" );
+		return 1;
+	}
+
+	// Every datagram of a batch has its own buffer.
+	std::vector<Uint8> buffers( batchSize * 1500, 0 );
+	std::vector<UdpSocket::Datagram> datagrams( batchSize );
+	for( Int32 i = 0; i < batchSize; i++ )
+	{
+		datagrams[ i ].pData = &buffers[ i * 1500 ];
+		datagrams[ i ].BufferSize = 1500;
+	}
+
+	std::atomic<Bool> sending( true );
+	Thread senderThread( [ & ]( )
+	{
+		std::vector<Uint8> data( datagramSize, 0 );
+		std::vector<UdpSocket::Datagram> batch( batchSize );
+		for( Int32 i = 0; i < batchSize; i++ )
+		{
+			batch[ i ].pData = &data[ 0 ];
+			batch[ i ].DataSize = datagramSize;
+			batch[ i ].RemoteAddress = Address( 127, 0, 0, 1 );
+			batch[ i ].RemotePort = g_Port;
+		}
+
+		for( Int32 sent = 0; sent < datagramCount; )
+		{
+			if( batchSize == 1 )
+			{
+				sender.Send( &data[ 0 ], datagramSize, Address( 127, 0, 0, 1 ), g_Port );
+				sent++;
+			}
+			else
+			{
+				const Int32 count = datagramCount - sent < batchSize ? datagramCount - sent : batchSize;
+				const Int32 result = sender.SendBatch( &batch[ 0 ], count );
+				sent += result > 0 ? result : 0;
+			}
+		}
+		sending = false;
+	} );
+
+	// Receive until the sender is done and the socket is drained.
+	const Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+	Uint64 received = 0;
+	Uint64 calls = 0;
+	while( true )
+	{
+		Int32 count = 0;
+		if( batchSize == 1 )
+		{
+			Address address;
+			Uint16 port = 0;
+			count = receiver.Receive( &buffers[ 0 ], 1500, address, port, Milliseconds( 100 ) ) > 0 ? 1 : 0;
+		}
+		else
+		{
+			count = receiver.ReceiveBatch( &datagrams[ 0 ], batchSize, Milliseconds( 100 ) );
+		}
+
+		if( count <= 0 )
+		{
+			if( sending == false )
+			{
+				break;
+			}
+			continue;
+		}
+
+		received += static_cast<Uint64>( count );
+		calls++;
+	}
+
+	// Exclude the final timeout.
+	const Float64 seconds = static_cast<Float64>( Timer::GetSystemTimeNanoseconds( ) - startTime ) / 1000000000.0 - 0.1;
+	senderThread.Finish( );
+
+	std::printf( "Batch: %i, size: %i bytes\n", batchSize, datagramSize );
+	std::printf( "Received: %llu/%i datagrams in %llu calls, %.3f s\n", static_cast<unsigned long long>( received ),
+				 datagramCount, static_cast<unsigned long long>( calls ), seconds );
+	std::printf( "Throughput: %.0f datagrams/s\n", static_cast<Float64>( received ) / seconds );
+	return 0;
+}
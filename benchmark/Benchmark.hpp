@@ -0,0 +1,128 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_BENCHMARK_BENCHMARK_HPP
+#define BIT_BENCHMARK_BENCHMARK_HPP
+
+#include <Bit/Build.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Bit
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \brief Helpers shared by the benchmark programs.
+	///
+	/// The benchmarks are standalone programs, built by
+	/// build/makefile/Makefile-bit-benchmark against the static libraries.
+	/// Every program takes its parameters as optional command line
+	/// arguments, see the description at the top of each program.
+	///
+	////////////////////////////////////////////////////////////////
+	namespace Benchmark
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get a command line argument as an integer.
+		///
+		/// \param p_Index Index of the argument, 1 for the first one.
+		/// \param p_Default Value returned if the argument is missing.
+		///
+		////////////////////////////////////////////////////////////////
+		inline Int32 GetArgument( int p_ArgumentCount, char ** p_ppArguments, const int p_Index, const Int32 p_Default )
+		{
+			if( p_Index >= p_ArgumentCount )
+			{
+				return p_Default;
+			}
+
+			return static_cast<Int32>( atoi( p_ppArguments[ p_Index ] ) );
+		}
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get a percentile of the values, the values are sorted.
+		///
+		/// \param p_Percentile Percentile, 0 to 100.
+		///
+		/// \return The percentile, 0 if there are no values.
+		///
+		////////////////////////////////////////////////////////////////
+		inline Float64 GetPercentile( std::vector<Float64> & p_Values, const Float64 p_Percentile )
+		{
+			if( p_Values.size( ) == 0 )
+			{
+				return 0.0;
+			}
+
+			std::sort( p_Values.begin( ), p_Values.end( ) );
+			SizeType index = static_cast<SizeType>( p_Percentile / 100.0 * static_cast<Float64>( p_Values.size( ) ) );
+			if( index >= p_Values.size( ) )
+			{
+				index = p_Values.size( ) - 1;
+			}
+
+			return p_Values[ index ];
+		}
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the processor time used by all the threads of the process.
+		///
+		/// \return Time in seconds, the wall time on Windows.
+		///
+		////////////////////////////////////////////////////////////////
+		inline Float64 GetProcessTime( )
+		{
+			return static_cast<Float64>( std::clock( ) ) / static_cast<Float64>( CLOCKS_PER_SEC );
+		}
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the number of threads of the process.
+		///
+		/// \return The thread count, 0 if unknown(Windows).
+		///
+		////////////////////////////////////////////////////////////////
+		inline Uint32 GetThreadCount( )
+		{
+			std::ifstream file( "/proc/self/status" );
+			std::string line;
+			while( std::getline( file, line ) )
+			{
+				if( line.compare( 0, 8, "Threads:" ) == 0 )
+				{
+					return static_cast<Uint32>( atoi( line.c_str( ) + 8 ) );
+				}
+			}
+
+			return 0;
+		}
+
+	}
+
+}
+
+#endif
@@ -0,0 +1,201 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////
+// Connect flood benchmark.
+//
+// Floods a server with connect packets from a single socket,
+// reporting the challenges answered per second and the connections
+// created by the flood. Then measures the lookup of 1000
+// connections by the connection table against a std::map, and the
+// time to create and verify a connect cookie.
+//
+// Usage: ConnectFlood [connect packets = 200000] [lookups = 10000000]
+//
+////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Server.hpp>
+#include <Bit/Network/Net/Private/ConnectionTable.hpp>
+#include <Bit/Network/Net/Private/ConnectCookie.hpp>
+#include <Bit/Network/Net/Private/NetPacket.hpp>
+#include <Bit/Network/UdpSocket.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Benchmark.hpp>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <vector>
+
+using namespace Bit;
+using namespace Bit::Net;
+
+static const Uint16 g_Port = 12390;
+static const std::string g_Identifier = "Bit Engine Network";
+static const SizeType g_ConnectionCount = 1000;
+static const Int32 g_BurstSize = 64;
+
+class BenchmarkServer : public Server
+{
+
+public:
+
+	using Server::Start;
+	using Server::GetConnectionCount;
+
+};
+
+// Send the connect packets in bursts, return the number of challenges received.
+static Int32 FloodServer( UdpSocket & p_Socket, const Int32 p_PacketCount )
+{
+	std::vector<Uint8> packet( ConnectPacketSize + g_Identifier.size( ) );
+	packet[ 0 ] = PacketType::Connect;
+	std::memcpy( &packet[ ConnectPacketSize ], g_Identifier.data( ), g_Identifier.size( ) );
+
+	Uint8 buffer[ 128 ];
+	Address address;
+	Uint16 port = 0;
+	Int32 challenges = 0;
+
+	for( Int32 sent = 0; sent < p_PacketCount; sent += g_BurstSize )
+	{
+		for( Int32 i = 0; i < g_BurstSize; i++ )
+		{
+			const Uint16 sequence = static_cast<Uint16>( sent + i );
+			std::memcpy( &packet[ 1 ], &sequence, sizeof( sequence ) );
+			p_Socket.Send( &packet[ 0 ], packet.size( ), Address( 127, 0, 0, 1 ), g_Port );
+		}
+
+		// Receive the challenges of the burst, a lost one times out.
+		for( Int32 i = 0; i < g_BurstSize; i++ )
+		{
+			const Int32 size = p_Socket.Receive( buffer, sizeof( buffer ), address, port, Milliseconds( 10 ) );
+			if( size <= 0 )
+			{
+				break;
+			}
+			if( size == static_cast<Int32>( ChallengePacketSize ) && buffer[ 0 ] == PacketType::Challenge )
+			{
+				challenges++;
+			}
+		}
+	}
+
+	return challenges;
+}
+
+int main( int p_ArgumentCount, char ** p_ppArguments )
+{
+	const Int32 packetCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 1, 200000 );
+	const Int32 lookupCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 2, 10000000 );
+
+	if( packetCount < 1 || lookupCount < 1 )
+	{
+		std::printf( "Invalid arguments.\n" );
+		return 1;
+	}
+
+	// Connect flood.
+	BenchmarkServer server;
+	if( server.Start( Server::Properties( g_Port, 8, Seconds( 5.0f ), 22, 30, g_Identifier ) ) == false )
+	{
+		std::printf( "Failed to start the server.\n" );
+		return 1;
+	}
+
+	UdpSocket socket;
+	if( socket.Open( 0 ) == false )
+	{
+		std::printf( "Failed to open the socket.\n" );
+		return 1;
+	}
+
+	Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+	const Int32 challenges = FloodServer( socket, packetCount );
+	const Float64 floodTime = static_cast<Float64>( Timer::GetSystemTimeNanoseconds( ) - startTime ) / 1000000000.0;
+
+	std::printf( "Connect packets: %i, challenges: %i, %.0f challenges/s, connections: %u\n", packetCount, challenges,
+				 static_cast<Float64>( challenges ) / floodTime, static_cast<Uint32>( server.GetConnectionCount( ) ) );
+
+	// Lookup of the connections in a random order, the connections are never dereferenced.
+	ConnectionTable table;
+	std::map<Uint64, Connection *> map;
+	std::vector<Uint32> addresses( g_ConnectionCount );
+	std::vector<Uint16> ports( g_ConnectionCount );
+	Uint32 random = 12345;
+	for( SizeType i = 0; i < g_ConnectionCount; i++ )
+	{
+		random = random * 1664525 + 1013904223;
+		addresses[ i ] = 0x0A000000 | ( random >> 8 );
+		ports[ i ] = static_cast<Uint16>( 1024 + random % 60000 );
+
+		Connection * pConnection = reinterpret_cast<Connection *>( i + 1 );
+		table.Add( addresses[ i ], ports[ i ], pConnection );
+		map[ ( static_cast<Uint64>( addresses[ i ] ) << 16 ) | ports[ i ] ] = pConnection;
+	}
+
+	std::vector<Uint32> order( 4096 );
+	for( SizeType i = 0; i < order.size( ); i++ )
+	{
+		random = random * 1664525 + 1013904223;
+		order[ i ] = ( random >> 8 ) % g_ConnectionCount;
+	}
+
+	SizeType found = 0;
+	startTime = Timer::GetSystemTimeNanoseconds( );
+	for( Int32 i = 0; i < lookupCount; i++ )
+	{
+		const Uint32 index = order[ i & 4095 ];
+		found += table.Find( addresses[ index ], ports[ index ] ) != NULL;
+	}
+	const Uint64 tableTime = Timer::GetSystemTimeNanoseconds( ) - startTime;
+
+	startTime = Timer::GetSystemTimeNanoseconds( );
+	for( Int32 i = 0; i < lookupCount; i++ )
+	{
+		const Uint32 index = order[ i & 4095 ];
+		found += map.find( ( static_cast<Uint64>( addresses[ index ] ) << 16 ) | ports[ index ] ) != map.end( );
+	}
+	const Uint64 mapTime = Timer::GetSystemTimeNanoseconds( ) - startTime;
+
+	std::printf( "Lookup of %u connections, found: %u/%i\n", static_cast<Uint32>( g_ConnectionCount ),
+				 static_cast<Uint32>( found ), 2 * lookupCount );
+	std::printf( "ConnectionTable: %.1f ns, std::map: %.1f ns per lookup\n",
+				 static_cast<Float64>( tableTime ) / lookupCount, static_cast<Float64>( mapTime ) / lookupCount );
+
+	// Connect cookies.
+	ConnectCookie cookie;
+	const Int32 cookieCount = lookupCount / 10;
+	Uint32 verified = 0;
+	startTime = Timer::GetSystemTimeNanoseconds( );
+	for( Int32 i = 0; i < cookieCount; i++ )
+	{
+		const Uint32 index = order[ i & 4095 ];
+		const Time time = Microseconds( static_cast<Uint64>( i ) );
+		verified += cookie.Verify( cookie.Create( addresses[ index ], ports[ index ], time ), addresses[ index ], ports[ index ], time );
+	}
+	const Uint64 cookieTime = Timer::GetSystemTimeNanoseconds( ) - startTime;
+
+	std::printf( "ConnectCookie: %.1f ns per create and verify, verified: %u/%i\n",
+				 static_cast<Float64>( cookieTime ) / cookieCount, verified, cookieCount );
+	return 0;
+}
@@ -0,0 +1,192 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////
+// Delta snapshot benchmark.
+//
+// Moves a number of entities every tick and creates the entity
+// snapshot messages of simulated clients, the snapshot and the
+// acknowledgement of each client are lost by the given loss.
+// Reports the snapshot bytes per tick and client, delta encoded
+// against the acknowledged baselines and as full states. Snapshots
+// are capped at MaxSnapshotSize(1200 bytes), about 55 entities of
+// full state, larger worlds defer entities to the upcoming snapshots.
+//
+// Usage: DeltaSnapshot [loss percent = 10] [entities = 40] [clients = 8] [ticks = 600]
+//
+////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Server.hpp>
+#include <Bit/Network/Net/Variable.hpp>
+#include <Bit/System/Randomizer.hpp>
+#include <Benchmark.hpp>
+#include <cstdio>
+#include <vector>
+
+using namespace Bit;
+using namespace Bit::Net;
+
+// Ticks until an acknowledgement reaches the server.
+static const Int32 g_AckDelay = 3;
+
+class BenchmarkEntity : public Entity
+{
+
+public:
+
+	Variable<Vector3f32>	Position;
+	Variable<Int32>			Health;
+	Variable<Uint8>			State;
+
+};
+
+class BenchmarkServer : public Server
+{
+
+public:
+
+	using Server::m_EntityManager;
+
+};
+
+struct SimulatedClient
+{
+
+	SimulatedClient( ) :
+		AckedSnapshot( -1 ),
+		DeltaBytes( 0 )
+	{
+	}
+
+	Int32					AckedSnapshot;
+	EntityInterest			Interest;
+	std::vector<Int32>		PendingAcks;	///< Snapshot id of the acknowledgements on their way, per arrival tick.
+	Uint64					DeltaBytes;
+
+};
+
+int main( int p_ArgumentCount, char ** p_ppArguments )
+{
+	const Int32 loss = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 1, 10 );
+	const Int32 entityCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 2, 40 );
+	const Int32 clientCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 3, 8 );
+	const Int32 tickCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 4, 600 );
+
+	static BenchmarkServer server;
+	EntityManager & entityManager = server.m_EntityManager;
+	entityManager.LinkEntity<BenchmarkEntity>( "BenchmarkEntity" );
+	entityManager.RegisterVariable( "BenchmarkEntity", "Position", &BenchmarkEntity::Position );
+	entityManager.RegisterVariable( "BenchmarkEntity", "Health", &BenchmarkEntity::Health );
+	entityManager.RegisterVariable( "BenchmarkEntity", "State", &BenchmarkEntity::State );
+
+	std::vector<BenchmarkEntity *> entities;
+	for( Int32 i = 0; i < entityCount; i++ )
+	{
+		entities.push_back( static_cast<BenchmarkEntity *>( entityManager.CreateEntityByName( "BenchmarkEntity" ) ) );
+		entities.back( )->Health.Set( 100 );
+	}
+
+	Randomizer randomizer( 1 );
+	std::vector<SimulatedClient> clients( clientCount );
+	std::vector<Uint8> message;
+	EntityInterest fullInterest;
+	Uint64 fullBytes = 0;
+
+	for( Int32 tick = 0; tick < tickCount; tick++ )
+	{
+		// A quarter of the entities move, a few are hurt or change state.
+		for( Int32 i = 0; i < entityCount; i++ )
+		{
+			if( ( i + tick ) % 4 == 0 )
+			{
+				Vector3f32 position = entities[ i ]->Position.Get( );
+				position.x += 0.25f;
+				entities[ i ]->Position.Set( position );
+			}
+			if( ( i * 7 + tick ) % 50 == 0 )
+			{
+				entities[ i ]->Health.Set( entities[ i ]->Health.Get( ) - 1 );
+			}
+			if( ( i + tick ) % 90 == 0 )
+			{
+				entities[ i ]->State.Set( static_cast<Uint8>( ( i + tick ) % 3 ) );
+			}
+		}
+
+		const Uint16 snapshotId = entityManager.CreateWorldSnapshot( );
+
+		// Full state, as sent without any acknowledged baseline.
+		message.clear( );
+		fullInterest.Clear( );
+		if( entityManager.CreateSnapshotMessage( -1, EntityInterest::View( ), fullInterest, message ) )
+		{
+			fullBytes += message.size( );
+		}
+
+		for( SizeType c = 0; c < clients.size( ); c++ )
+		{
+			SimulatedClient & client = clients[ c ];
+
+			// Use the acknowledgements arriving at this tick as baselines.
+			for( SizeType i = 0; i < client.PendingAcks.size( ); )
+			{
+				if( client.PendingAcks[ i ] >> 16 == tick )
+				{
+					const Uint16 ackedId = static_cast<Uint16>( client.PendingAcks[ i ] & 0xFFFF );
+					if( client.AckedSnapshot < 0 || EntitySnapshot::IsNewer( ackedId, static_cast<Uint16>( client.AckedSnapshot ) ) )
+					{
+						client.AckedSnapshot = ackedId;
+					}
+					client.PendingAcks.erase( client.PendingAcks.begin( ) + i );
+					continue;
+				}
+				i++;
+			}
+
+			message.clear( );
+			if( entityManager.CreateSnapshotMessage( client.AckedSnapshot, EntityInterest::View( ), client.Interest, message ) == false )
+			{
+				continue;
+			}
+			client.DeltaBytes += message.size( );
+
+			// Lose the snapshot or its acknowledgement.
+			if( randomizer.Randomize( 99 ) < loss || randomizer.Randomize( 99 ) < loss )
+			{
+				continue;
+			}
+			client.PendingAcks.push_back( ( ( tick + g_AckDelay ) << 16 ) | snapshotId );
+		}
+	}
+
+	Uint64 deltaBytes = 0;
+	for( SizeType c = 0; c < clients.size( ); c++ )
+	{
+		deltaBytes += clients[ c ].DeltaBytes;
+	}
+
+	std::printf( "Entities: %i, clients: %i, ticks: %i, loss: %i%%\n", entityCount, clientCount, tickCount, loss );
+	std::printf( "Full state: %.1f bytes/tick per client\n", static_cast<Float64>( fullBytes ) / tickCount );
+	std::printf( "Delta:      %.1f bytes/tick per client\n", static_cast<Float64>( deltaBytes ) / tickCount / clientCount );
+	return 0;
+}
@@ -0,0 +1,135 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////
+// Dirty tracking benchmark.
+//
+// Sets the variables of a large number of entities and takes world
+// snapshots with every entity changed, a few entities changed and
+// none changed. Reports the time per Set and per world snapshot.
+//
+// Usage: DirtyTracking [entities = 50000] [rounds = 10]
+//
+////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Server.hpp>
+#include <Bit/Network/Net/Variable.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Benchmark.hpp>
+#include <cstdio>
+#include <vector>
+
+using namespace Bit;
+using namespace Bit::Net;
+
+class BenchmarkEntity : public Entity
+{
+
+public:
+
+	Variable<Float32>	X;
+	Variable<Float32>	Y;
+	Variable<Int32>		Health;
+
+};
+
+class BenchmarkServer : public Server
+{
+
+public:
+
+	using Server::m_EntityManager;
+
+};
+
+// Take a world snapshot, return the time in microseconds.
+static Float64 TakeWorldSnapshot( EntityManager & p_EntityManager )
+{
+	const Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+	p_EntityManager.CreateWorldSnapshot( );
+	return static_cast<Float64>( Timer::GetSystemTimeNanoseconds( ) - startTime ) / 1000.0;
+}
+
+int main( int p_ArgumentCount, char ** p_ppArguments )
+{
+	const Int32 entityCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 1, 50000 );
+	const Int32 roundCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 2, 10 );
+
+	if( entityCount < 1 || entityCount > 60000 || roundCount < 1 )
+	{
+		std::printf( "Invalid arguments.\n" );
+		return 1;
+	}
+
+	static BenchmarkServer server;
+	EntityManager & entityManager = server.m_EntityManager;
+	entityManager.LinkEntity<BenchmarkEntity>( "BenchmarkEntity" );
+	entityManager.RegisterVariable( "BenchmarkEntity", "X", &BenchmarkEntity::X );
+	entityManager.RegisterVariable( "BenchmarkEntity", "Y", &BenchmarkEntity::Y );
+	entityManager.RegisterVariable( "BenchmarkEntity", "Health", &BenchmarkEntity::Health );
+
+	std::vector<BenchmarkEntity *> entities;
+	for( Int32 i = 0; i < entityCount; i++ )
+	{
+		entities.push_back( static_cast<BenchmarkEntity *>( entityManager.CreateEntityByName( "BenchmarkEntity" ) ) );
+	}
+	entityManager.CreateWorldSnapshot( );
+
+	// Set, every call changes the value.
+	const Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+	for( Int32 round = 0; round < roundCount; round++ )
+	{
+		for( Int32 i = 0; i < entityCount; i++ )
+		{
+			entities[ i ]->X.Set( static_cast<Float32>( round * entityCount + i ) );
+		}
+	}
+	const Float64 setTime = static_cast<Float64>( Timer::GetSystemTimeNanoseconds( ) - startTime ) /
+							( static_cast<Float64>( roundCount ) * entityCount );
+
+	Float64 allTime = 0.0;
+	Float64 fewTime = 0.0;
+	Float64 noneTime = 0.0;
+	for( Int32 round = 0; round < roundCount; round++ )
+	{
+		for( Int32 i = 0; i < entityCount; i++ )
+		{
+			entities[ i ]->Y.Set( static_cast<Float32>( round + i + 1 ) );
+		}
+		allTime += TakeWorldSnapshot( entityManager );
+
+		for( Int32 i = 0; i < entityCount; i += 100 )
+		{
+			entities[ i ]->Health.Set( round + 1 );
+		}
+		fewTime += TakeWorldSnapshot( entityManager );
+
+		noneTime += TakeWorldSnapshot( entityManager );
+	}
+
+	std::printf( "Entities: %i\n", entityCount );
+	std::printf( "Set: %.1f ns\n", setTime );
+	std::printf( "World snapshot, every entity changed: %.0f us, 1%% changed: %.0f us, none changed: %.0f us\n",
+				 allTime / roundCount, fewTime / roundCount, noneTime / roundCount );
+	return 0;
+}
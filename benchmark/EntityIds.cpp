@@ -0,0 +1,225 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////
+// Entity id benchmark.
+//
+// Synchronizes a number of entities from a server entity manager to
+// a client entity manager by snapshot messages, referring to the
+// classes and variables by numeric id. Reports the bytes and parse
+// time of the messages, next to the legacy full entity message
+// keyed by class and variable names.
+//
+// Usage: EntityIds [entities = 1000] [ticks = 200]
+//
+////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Server.hpp>
+#include <Bit/Network/Net/Client.hpp>
+#include <Bit/Network/Net/Variable.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Benchmark.hpp>
+#include <cstdio>
+#include <vector>
+
+using namespace Bit;
+using namespace Bit::Net;
+
+class BenchmarkPlayer : public Entity
+{
+
+public:
+
+	Variable<Vector3f32>	Position;
+	Variable<Float32>		Direction;
+	Variable<Int32>			Health;
+	Variable<Uint8>			Weapon;
+
+};
+
+class BenchmarkProjectile : public Entity
+{
+
+public:
+
+	Variable<Vector3f32>	Position;
+	Variable<Vector3f32>	Velocity;
+
+};
+
+class BenchmarkServer : public Server
+{
+
+public:
+
+	using Server::m_EntityManager;
+
+};
+
+class BenchmarkClient : public Client
+{
+
+public:
+
+	BenchmarkClient( ) :
+		Client( 0 )
+	{
+	}
+
+	using Client::m_EntityManager;
+
+};
+
+// Link the same classes on both sides, in the same order.
+static void LinkEntities( EntityManager & p_EntityManager )
+{
+	p_EntityManager.LinkEntity<BenchmarkPlayer>( "BenchmarkPlayer" );
+	p_EntityManager.RegisterVariable( "BenchmarkPlayer", "Position", &BenchmarkPlayer::Position );
+	p_EntityManager.RegisterVariable( "BenchmarkPlayer", "Direction", &BenchmarkPlayer::Direction );
+	p_EntityManager.RegisterVariable( "BenchmarkPlayer", "Health", &BenchmarkPlayer::Health );
+	p_EntityManager.RegisterVariable( "BenchmarkPlayer", "Weapon", &BenchmarkPlayer::Weapon );
+	p_EntityManager.LinkEntity<BenchmarkProjectile>( "BenchmarkProjectile" );
+	p_EntityManager.RegisterVariable( "BenchmarkProjectile", "Position", &BenchmarkProjectile::Position );
+	p_EntityManager.RegisterVariable( "BenchmarkProjectile", "Velocity", &BenchmarkProjectile::Velocity );
+}
+
+int main( int p_ArgumentCount, char ** p_ppArguments )
+{
+	const Int32 entityCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 1, 1000 );
+	const Int32 tickCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 2, 200 );
+
+	static BenchmarkServer server;
+	static BenchmarkClient client;
+	EntityManager & serverManager = server.m_EntityManager;
+	EntityManager & clientManager = client.m_EntityManager;
+	LinkEntities( serverManager );
+	LinkEntities( clientManager );
+
+	std::vector<Uint8> message;
+	serverManager.CreateClassTableMessage( message );
+	const SizeType classTableSize = message.size( );
+	if( clientManager.ParseClassTableMessage( &message[ 0 ], message.size( ) ) == false )
+	{
+		std::printf( "Failed to parse the class table message.\n" );
+		return 1;
+	}
+
+	std::vector<BenchmarkPlayer *> players;
+	std::vector<Uint16> entityIds;
+	for( Int32 i = 0; i < entityCount; i++ )
+	{
+		if( i % 2 == 0 )
+		{
+			players.push_back( static_cast<BenchmarkPlayer *>( serverManager.CreateEntityByName( "BenchmarkPlayer" ) ) );
+			players.back( )->Health.Set( 100 );
+			entityIds.push_back( players.back( )->GetId( ) );
+		}
+		else
+		{
+			BenchmarkProjectile * pProjectile = static_cast<BenchmarkProjectile *>( serverManager.CreateEntityByName( "BenchmarkProjectile" ) );
+			pProjectile->Velocity.Set( Vector3f32( 1.0f, 0.0f, 0.0f ) );
+			entityIds.push_back( pProjectile->GetId( ) );
+		}
+	}
+
+	// The legacy message, keyed by the class and variable names.
+	message.clear( );
+	serverManager.CreateFullEntityMessage( message, true );
+	const SizeType legacySize = message.size( );
+
+	// Synchronize the client, every snapshot is acknowledged.
+	EntityInterest interest;
+	Int32 ackedSnapshot = -1;
+	Bool synchronized = false;
+	Uint64 syncBytes = 0;
+	Uint64 syncMessages = 0;
+	Uint64 tickBytes = 0;
+	Uint64 tickMessages = 0;
+	Uint64 syncParseTime = 0;
+	Uint64 tickParseTime = 0;
+	Uint32 failures = 0;
+
+	for( Int32 tick = 0; tick < tickCount; tick++ )
+	{
+		// The players move, the projectiles are unchanged.
+		for( SizeType i = 0; i < players.size( ); i++ )
+		{
+			if( ( i + tick ) % 4 == 0 )
+			{
+				Vector3f32 position = players[ i ]->Position.Get( );
+				position.x += 0.25f;
+				players[ i ]->Position.Set( position );
+				players[ i ]->Direction.Set( static_cast<Float32>( tick ) );
+			}
+		}
+
+		serverManager.CreateWorldSnapshot( );
+		message.clear( );
+		if( serverManager.CreateSnapshotMessage( ackedSnapshot, EntityInterest::View( ), interest, message ) == false )
+		{
+			continue;
+		}
+
+		const Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+		Uint16 snapshotId = 0;
+		const Bool parsed = clientManager.ParseSnapshotMessage( &message[ 0 ], message.size( ), snapshotId );
+		const Uint64 time = Timer::GetSystemTimeNanoseconds( ) - startTime;
+
+		if( parsed == false )
+		{
+			failures++;
+			continue;
+		}
+		ackedSnapshot = snapshotId;
+
+		if( synchronized )
+		{
+			tickBytes += message.size( );
+			tickParseTime += time;
+			tickMessages++;
+			continue;
+		}
+		syncBytes += message.size( );
+		syncParseTime += time;
+		syncMessages++;
+
+		// Synchronized when the client has every entity.
+		synchronized = true;
+		for( SizeType i = 0; i < entityIds.size( ) && synchronized; i++ )
+		{
+			synchronized = clientManager.GetEntity( entityIds[ i ] ) != NULL;
+		}
+	}
+
+	std::printf( "Entities: %i, class table: %u bytes\n", entityCount, static_cast<Uint32>( classTableSize ) );
+	std::printf( "Legacy full entity message: %u bytes\n", static_cast<Uint32>( legacySize ) );
+	std::printf( "Snapshots until synchronized: %llu messages, %llu bytes, parse %.1f us/snapshot%s\n",
+				 static_cast<unsigned long long>( syncMessages ), static_cast<unsigned long long>( syncBytes ),
+				 syncMessages ? static_cast<Float64>( syncParseTime ) / 1000.0 / static_cast<Float64>( syncMessages ) : 0.0,
+				 synchronized ? "" : "(not synchronized)" );
+	std::printf( "Snapshots after: %.1f bytes/tick, parse %.1f us/snapshot\n",
+				 tickMessages ? static_cast<Float64>( tickBytes ) / static_cast<Float64>( tickMessages ) : 0.0,
+				 tickMessages ? static_cast<Float64>( tickParseTime ) / 1000.0 / static_cast<Float64>( tickMessages ) : 0.0 );
+	std::printf( "Parse failures: %u\n", failures );
+	return 0;
+}
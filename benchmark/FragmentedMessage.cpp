@@ -0,0 +1,234 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////
+// Fragmented message benchmark.
+//
+// Sends large reliable host messages from a server to a loopback
+// client, and large user messages from the client to the server,
+// fragmented into datagrams. Reports the throughput of each direction
+// and whether every message arrived intact.
+//
+// Usage: FragmentedMessage [host message kB = 4096] [messages = 8] [user message kB = 256]
+//
+////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Server.hpp>
+#include <Bit/Network/Net/Client.hpp>
+#include <Bit/Network/Net/HostRecipientFilter.hpp>
+#include <Bit/Network/Net/HostMessageDecoder.hpp>
+#include <Bit/Network/Net/UserMessageDecoder.hpp>
+#include <Bit/System/Sleep.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Benchmark.hpp>
+#include <atomic>
+#include <cstdio>
+#include <vector>
+
+using namespace Bit;
+using namespace Bit::Net;
+
+static const Uint16 g_Port = 12382;
+
+class BenchmarkServer : public Server
+{
+
+public:
+
+	using Server::HookUserMessage;
+	using Server::CreateHostMessage;
+	using Server::CreateRecipientFilter;
+	using Server::Start;
+
+};
+
+class BenchmarkClient : public Client
+{
+
+public:
+
+	BenchmarkClient( ) :
+		Client( 0 )
+	{
+	}
+
+	using Client::Connect;
+	using Client::HookHostMessage;
+	using Client::CreateUserMessage;
+
+};
+
+// Fill the message data with a pattern depending on the message index.
+static void FillData( std::vector<Uint8> & p_Data, const Int32 p_Index )
+{
+	for( SizeType i = 0; i < p_Data.size( ); i++ )
+	{
+		p_Data[ i ] = static_cast<Uint8>( i * 31 + p_Index );
+	}
+}
+
+// Count the received messages, comparing them with the sent data.
+template<typename Decoder>
+static void VerifyMessage( Decoder & p_Message, std::vector<Uint8> & p_Buffer, std::vector<Uint8> & p_Expected,
+						   std::atomic<Int32> & p_Count, std::atomic<Int32> & p_Errors )
+{
+	const Int32 index = p_Message.ReadInt( );
+	p_Buffer.resize( p_Expected.size( ) );
+	FillData( p_Expected, index );
+	if( p_Message.ReadArray( &p_Buffer[ 0 ], p_Buffer.size( ) ) == false || p_Buffer != p_Expected )
+	{
+		p_Errors++;
+	}
+	p_Count++;
+}
+
+class HostListener : public HostMessageListener
+{
+
+public:
+
+	HostListener( const SizeType p_Size ) :
+		Count( 0 ),
+		Errors( 0 ),
+		m_Expected( p_Size )
+	{
+	}
+
+	virtual void HandleMessage( HostMessageDecoder & p_Message )
+	{
+		VerifyMessage( p_Message, m_Buffer, m_Expected, Count, Errors );
+	}
+
+	std::atomic<Int32> Count;
+	std::atomic<Int32> Errors;
+
+private:
+
+	std::vector<Uint8> m_Buffer;
+	std::vector<Uint8> m_Expected;
+
+};
+
+class UserListener : public UserMessageListener
+{
+
+public:
+
+	UserListener( const SizeType p_Size ) :
+		Count( 0 ),
+		Errors( 0 ),
+		m_Expected( p_Size )
+	{
+	}
+
+	virtual void HandleMessage( UserMessageDecoder & p_Message )
+	{
+		VerifyMessage( p_Message, m_Buffer, m_Expected, Count, Errors );
+	}
+
+	std::atomic<Int32> Count;
+	std::atomic<Int32> Errors;
+
+private:
+
+	std::vector<Uint8> m_Buffer;
+	std::vector<Uint8> m_Expected;
+
+};
+
+// Wait for the messages, return the seconds since the start time.
+static Float64 WaitForMessages( std::atomic<Int32> & p_Count, const Int32 p_Expected, const Uint64 p_StartTime )
+{
+	while( p_Count < p_Expected && Timer::GetSystemTimeNanoseconds( ) - p_StartTime < 60000000000ULL )
+	{
+		Sleep( Milliseconds( 1 ) );
+	}
+
+	return static_cast<Float64>( Timer::GetSystemTimeNanoseconds( ) - p_StartTime ) / 1000000000.0;
+}
+
+int main( int p_ArgumentCount, char ** p_ppArguments )
+{
+	const Int32 hostSize = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 1, 4096 ) * 1024;
+	const Int32 messageCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 2, 8 );
+	const Int32 userSize = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 3, 256 ) * 1024 - 64;
+
+	BenchmarkServer server;
+	UserListener userListener( userSize );
+	server.HookUserMessage( &userListener, "fragmented" );
+	if( server.Start( Server::Properties( g_Port, 8, Seconds( 5.0f ) ) ) == false )
+	{
+		std::printf( "Failed to start the server.\n" );
+		return 1;
+	}
+
+	BenchmarkClient client;
+	HostListener hostListener( hostSize );
+	client.HookHostMessage( &hostListener, "fragmented" );
+	if( client.Connect( Address( 127, 0, 0, 1 ), g_Port, Seconds( 5.0f ) ) != Client::Succeeded )
+	{
+		std::printf( "Failed to connect.\n" );
+		return 1;
+	}
+
+	// Host messages.
+	std::vector<Uint8> data( hostSize );
+	Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+	for( Int32 i = 0; i < messageCount; i++ )
+	{
+		FillData( data, i );
+		HostMessage * pMessage = server.CreateHostMessage( "fragmented", hostSize + 4 );
+		pMessage->WriteInt( i );
+		pMessage->WriteArray( &data[ 0 ], data.size( ) );
+		HostRecipientFilter * pFilter = server.CreateRecipientFilter( );
+		pFilter->AddAllUsers( );
+		pMessage->Send( pFilter );
+		delete pFilter;
+		delete pMessage;
+	}
+	const Float64 hostTime = WaitForMessages( hostListener.Count, messageCount, startTime );
+
+	// User messages, limited in size by the server, leaving room for the message header.
+	data.resize( userSize );
+	startTime = Timer::GetSystemTimeNanoseconds( );
+	for( Int32 i = 0; i < messageCount; i++ )
+	{
+		FillData( data, i );
+		UserMessage * pMessage = client.CreateUserMessage( "fragmented", userSize + 4 );
+		pMessage->WriteInt( i );
+		pMessage->WriteArray( &data[ 0 ], data.size( ) );
+		pMessage->Send( true );
+		delete pMessage;
+	}
+	const Float64 userTime = WaitForMessages( userListener.Count, messageCount, startTime );
+
+	std::printf( "Host messages: %i/%i of %i kB, errors: %i, %.3f s, %.1f MB/s\n",
+				 static_cast<Int32>( hostListener.Count ), messageCount, hostSize / 1024, static_cast<Int32>( hostListener.Errors ),
+				 hostTime, static_cast<Float64>( hostListener.Count ) * hostSize / hostTime / 1000000.0 );
+	std::printf( "User messages: %i/%i of %i kB, errors: %i, %.3f s, %.1f MB/s\n",
+				 static_cast<Int32>( userListener.Count ), messageCount, ( userSize + 64 ) / 1024, static_cast<Int32>( userListener.Errors ),
+				 userTime, static_cast<Float64>( userListener.Count ) * userSize / userTime / 1000000.0 );
+
+	// The client is destroyed, and disconnected, before the server.
+	return 0;
+}
@@ -0,0 +1,181 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////
+// Interest management benchmark.
+//
+// Moves entities spread over a square world and creates the snapshot
+// messages of simulated clients, each one seeing the entities within
+// its view. Every snapshot is acknowledged at once. Reports the time
+// per tick of taking the world snapshot and creating the messages,
+// and the bytes per client, with views and with every entity relevant.
+//
+// Usage: InterestManagement [entities = 10000] [clients = 200] [view radius = 150] [ticks = 50]
+//
+////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Server.hpp>
+#include <Bit/Network/Net/Variable.hpp>
+#include <Bit/System/Randomizer.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Benchmark.hpp>
+#include <cstdio>
+#include <vector>
+
+using namespace Bit;
+using namespace Bit::Net;
+
+static const Float32 g_WorldSize = 4000.0f;
+
+class BenchmarkEntity : public Entity
+{
+
+public:
+
+	Variable<Vector3f32>	Position;
+	Variable<Int32>			Health;
+
+};
+
+class BenchmarkServer : public Server
+{
+
+public:
+
+	using Server::m_EntityManager;
+
+};
+
+struct SimulatedClient
+{
+
+	SimulatedClient( ) :
+		AckedSnapshot( -1 )
+	{
+	}
+
+	Int32					AckedSnapshot;
+	EntityInterest::View	View;
+	EntityInterest			Interest;
+
+};
+
+// Run the ticks, outputs the time per tick in microseconds and the bytes per client and tick.
+static void RunTicks(	EntityManager & p_EntityManager,
+						std::vector<BenchmarkEntity *> & p_Entities,
+						std::vector<Vector3f32> & p_Velocities,
+						std::vector<SimulatedClient> & p_Clients,
+						const Int32 p_TickCount,
+						Float64 & p_TickTime,
+						Float64 & p_Bytes )
+{
+	std::vector<Uint8> message;
+	Uint64 time = 0;
+	Uint64 bytes = 0;
+
+	for( Int32 tick = 0; tick < p_TickCount; tick++ )
+	{
+		for( SizeType i = 0; i < p_Entities.size( ); i++ )
+		{
+			const Vector3f32 position = p_Entities[ i ]->Position.Get( ) + p_Velocities[ i ];
+			p_Entities[ i ]->Position.Set( position );
+			p_Entities[ i ]->SetPosition( position );
+		}
+
+		const Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+		const Uint16 snapshotId = p_EntityManager.CreateWorldSnapshot( );
+		for( SizeType c = 0; c < p_Clients.size( ); c++ )
+		{
+			message.clear( );
+			if( p_EntityManager.CreateSnapshotMessage( p_Clients[ c ].AckedSnapshot, p_Clients[ c ].View,
+													   p_Clients[ c ].Interest, message ) )
+			{
+				p_Clients[ c ].AckedSnapshot = snapshotId;
+				bytes += message.size( );
+			}
+		}
+		time += Timer::GetSystemTimeNanoseconds( ) - startTime;
+	}
+
+	p_TickTime = static_cast<Float64>( time ) / 1000.0 / p_TickCount;
+	p_Bytes = static_cast<Float64>( bytes ) / p_TickCount / p_Clients.size( );
+}
+
+int main( int p_ArgumentCount, char ** p_ppArguments )
+{
+	const Int32 entityCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 1, 10000 );
+	const Int32 clientCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 2, 200 );
+	const Int32 viewRadius = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 3, 150 );
+	const Int32 tickCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 4, 50 );
+
+	if( entityCount < 1 || entityCount > 60000 || clientCount < 1 )
+	{
+		std::printf( "Invalid arguments.\n" );
+		return 1;
+	}
+
+	static BenchmarkServer server;
+	EntityManager & entityManager = server.m_EntityManager;
+	entityManager.LinkEntity<BenchmarkEntity>( "BenchmarkEntity" );
+	entityManager.RegisterVariable( "BenchmarkEntity", "Position", &BenchmarkEntity::Position );
+	entityManager.RegisterVariable( "BenchmarkEntity", "Health", &BenchmarkEntity::Health );
+	entityManager.SetInterestCellSize( static_cast<Float32>( viewRadius ) );
+
+	Randomizer randomizer( 1 );
+	std::vector<BenchmarkEntity *> entities;
+	std::vector<Vector3f32> velocities;
+	for( Int32 i = 0; i < entityCount; i++ )
+	{
+		BenchmarkEntity * pEntity = static_cast<BenchmarkEntity *>( entityManager.CreateEntityByName( "BenchmarkEntity" ) );
+		const Vector3f32 position(	static_cast<Float32>( randomizer.Randomize( static_cast<Int32>( g_WorldSize ) ) ),
+									static_cast<Float32>( randomizer.Randomize( static_cast<Int32>( g_WorldSize ) ) ), 0.0f );
+		pEntity->Position.Set( position );
+		pEntity->SetPosition( position );
+		pEntity->Health.Set( 100 );
+		entities.push_back( pEntity );
+		velocities.push_back( Vector3f32( static_cast<Float32>( randomizer.Randomize( -10, 10 ) ) * 0.5f,
+										  static_cast<Float32>( randomizer.Randomize( -10, 10 ) ) * 0.5f, 0.0f ) );
+	}
+
+	// The clients look at the positions of some of the entities.
+	std::vector<SimulatedClient> clients( clientCount );
+	for( Int32 c = 0; c < clientCount; c++ )
+	{
+		clients[ c ].View = EntityInterest::View( entities[ ( c * 7 ) % entityCount ]->Position.Get( ), static_cast<Float32>( viewRadius ) );
+	}
+
+	Float64 viewTime = 0.0;
+	Float64 viewBytes = 0.0;
+	RunTicks( entityManager, entities, velocities, clients, tickCount, viewTime, viewBytes );
+
+	// Every entity relevant to every client.
+	std::vector<SimulatedClient> allClients( clientCount );
+	Float64 allTime = 0.0;
+	Float64 allBytes = 0.0;
+	RunTicks( entityManager, entities, velocities, allClients, tickCount, allTime, allBytes );
+
+	std::printf( "Entities: %i, clients: %i, view radius: %i\n", entityCount, clientCount, viewRadius );
+	std::printf( "With views:         %.1f us/tick, %.1f bytes/tick per client\n", viewTime, viewBytes );
+	std::printf( "Every entity sent:  %.1f us/tick, %.1f bytes/tick per client\n", allTime, allBytes );
+	return 0;
+}
@@ -0,0 +1,198 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////
+// Interpolation benchmark.
+//
+// Synchronizes entities with interpolated variables from a server
+// entity manager to a client entity manager by snapshot messages,
+// one round of snapshots every 50 milliseconds of server time.
+// Reports the time of taking a client snapshot of the interpolated
+// variables, and the largest interpolation error of a linear motion.
+//
+// Usage: Interpolation [entities = 10000] [rounds = 8]
+//
+////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Server.hpp>
+#include <Bit/Network/Net/Client.hpp>
+#include <Bit/Network/Net/Variable.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Benchmark.hpp>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace Bit;
+using namespace Bit::Net;
+
+static const Uint64 g_RoundTime = 50000;	// Microseconds.
+
+class BenchmarkEntity : public Entity
+{
+
+public:
+
+	InterpolatedVariable<Vector3f32>	Position;
+	InterpolatedVariable<Float32>		Health;
+
+};
+
+class BenchmarkServer : public Server
+{
+
+public:
+
+	using Server::m_EntityManager;
+
+};
+
+class BenchmarkClient : public Client
+{
+
+public:
+
+	BenchmarkClient( ) :
+		Client( 0 )
+	{
+	}
+
+	using Client::m_EntityManager;
+	using Client::GetServerTime;
+	using Client::GetPing;
+
+};
+
+// Link the same class on both sides.
+static void LinkEntities( EntityManager & p_EntityManager )
+{
+	p_EntityManager.LinkEntity<BenchmarkEntity>( "BenchmarkEntity" );
+	p_EntityManager.RegisterVariable( "BenchmarkEntity", "Position", &BenchmarkEntity::Position );
+	p_EntityManager.RegisterVariable( "BenchmarkEntity", "Health", &BenchmarkEntity::Health );
+}
+
+// Set the server time of a snapshot message, the first 8 bytes in network byte order.
+static void SetMessageTime( std::vector<Uint8> & p_Message, const Uint64 p_Time )
+{
+	for( SizeType i = 0; i < 8; i++ )
+	{
+		p_Message[ i ] = static_cast<Uint8>( p_Time >> ( 56 - i * 8 ) );
+	}
+}
+
+// Get the entity count of a snapshot message, 2 bytes in network byte order at byte 13.
+static Uint16 GetEntityCount( const std::vector<Uint8> & p_Message )
+{
+	return static_cast<Uint16>( ( p_Message[ 13 ] << 8 ) | p_Message[ 14 ] );
+}
+
+int main( int p_ArgumentCount, char ** p_ppArguments )
+{
+	const Int32 entityCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 1, 10000 );
+	const Int32 roundCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 2, 8 );
+
+	if( entityCount < 1 || entityCount > 60000 || roundCount < 2 )
+	{
+		std::printf( "Invalid arguments.\n" );
+		return 1;
+	}
+
+	static BenchmarkServer server;
+	static BenchmarkClient client;
+	EntityManager & serverManager = server.m_EntityManager;
+	EntityManager & clientManager = client.m_EntityManager;
+	LinkEntities( serverManager );
+	LinkEntities( clientManager );
+	clientManager.SetInterpolationTime( Milliseconds( 100 ) );
+
+	std::vector<Uint8> message;
+	serverManager.CreateClassTableMessage( message );
+	clientManager.ParseClassTableMessage( &message[ 0 ], message.size( ) );
+
+	std::vector<BenchmarkEntity *> entities;
+	for( Int32 i = 0; i < entityCount; i++ )
+	{
+		entities.push_back( static_cast<BenchmarkEntity *>( serverManager.CreateEntityByName( "BenchmarkEntity" ) ) );
+	}
+
+	// Every round moves the entities by 0.5 units, all the snapshots of a round carry the same time.
+	const Uint64 startTime = client.GetServerTime( ).AsMicroseconds( ) + 1000000;
+	EntityInterest interest;
+	Int32 ackedSnapshot = -1;
+	Uint32 messageCount = 0;
+	for( Int32 round = 0; round < roundCount; round++ )
+	{
+		for( Int32 i = 0; i < entityCount; i++ )
+		{
+			entities[ i ]->Position.Set( Vector3f32( static_cast<Float32>( round ) * 0.5f, static_cast<Float32>( i ), 0.0f ) );
+			entities[ i ]->Health.Set( static_cast<Float32>( round ) * 2.0f );
+		}
+
+		for( Int32 i = 0; i < 10000; i++ )
+		{
+			serverManager.CreateWorldSnapshot( );
+			message.clear( );
+			if( serverManager.CreateSnapshotMessage( ackedSnapshot, EntityInterest::View( ), interest, message ) == false ||
+				GetEntityCount( message ) == 0 )
+			{
+				break;
+			}
+
+			Uint16 snapshotId = 0;
+			SetMessageTime( message, startTime + round * g_RoundTime );
+			if( clientManager.ParseSnapshotMessage( &message[ 0 ], message.size( ), snapshotId ) )
+			{
+				ackedSnapshot = snapshotId;
+			}
+			messageCount++;
+		}
+	}
+
+	// Client snapshots between the last two rounds, delayed by the interpolation time.
+	// The received values are timed by the server time plus the ping, estimated without a connection.
+	const Int32 snapshotCount = 100;
+	const Uint64 firstTime = startTime + client.GetPing( ).AsMicroseconds( ) + ( roundCount - 2 ) * g_RoundTime + 100000;
+	Float32 maxError = 0.0f;
+	Uint64 snapshotTime = 0;
+	for( Int32 s = 0; s < snapshotCount; s++ )
+	{
+		const Uint64 time = firstTime + g_RoundTime * s / snapshotCount;
+		const Uint64 snapshotStart = Timer::GetSystemTimeNanoseconds( );
+		clientManager.TakeSnapshot( 0, Microseconds( time ) );
+		snapshotTime += Timer::GetSystemTimeNanoseconds( ) - snapshotStart;
+
+		// The expected position of the linear motion.
+		const Float32 expected = 0.5f * ( static_cast<Float32>( roundCount - 2 ) + static_cast<Float32>( s ) / snapshotCount );
+		for( Int32 i = 0; i < entityCount; i += 97 )
+		{
+			BenchmarkEntity * pEntity = static_cast<BenchmarkEntity *>( clientManager.GetEntity( entities[ i ]->GetId( ) ) );
+			const Float32 error = pEntity ? std::fabs( pEntity->Position.GetSnapshot( ).x - expected ) : 1000000.0f;
+			maxError = error > maxError ? error : maxError;
+		}
+	}
+
+	std::printf( "Entities: %i, interpolated variables: %i, snapshot messages: %u\n", entityCount, entityCount * 2, messageCount );
+	std::printf( "TakeSnapshot: %.1f us, max position error: %.4f\n",
+				 static_cast<Float64>( snapshotTime ) / 1000.0 / snapshotCount, maxError );
+	return 0;
+}
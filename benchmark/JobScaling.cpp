@@ -0,0 +1,158 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////
+// Job scaling benchmark.
+//
+// Runs the same work by the job system with 1 to N threads, the
+// waiting thread included, 1 thread running the jobs inline without
+// starting the job system. Reports the time of a ParallelFor over an
+// array, the time per tiny job, the time of a recursive fork and
+// join, and the ParallelFor speedup over 1 thread.
+//
+// Usage: JobScaling [max threads = hardware threads] [elements = 1000000]
+//
+////////////////////////////////////////////////////////////////
+
+#include <Bit/System/JobSystem.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Benchmark.hpp>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include <unistd.h>
+
+using namespace Bit;
+
+static const Int32 g_TinyJobCount = 20000;
+static const Int32 g_Fibonacci = 26;
+
+// Fibonacci number, forking a job per call above the serial cutoff.
+static Int64 Fibonacci( JobSystem & p_JobSystem, const Int32 p_Number )
+{
+	if( p_Number < 2 )
+	{
+		return p_Number;
+	}
+	if( p_Number < 18 )
+	{
+		return Fibonacci( p_JobSystem, p_Number - 1 ) + Fibonacci( p_JobSystem, p_Number - 2 );
+	}
+
+	Int64 first = 0;
+	JobSystem::Counter counter;
+	p_JobSystem.Run( [ &p_JobSystem, &first, p_Number ]( )
+	{
+		first = Fibonacci( p_JobSystem, p_Number - 1 );
+	}, &counter );
+	const Int64 second = Fibonacci( p_JobSystem, p_Number - 2 );
+	p_JobSystem.Wait( counter );
+
+	return first + second;
+}
+
+// Return the milliseconds since the start time.
+static Float64 GetMilliseconds( const Uint64 p_StartTime )
+{
+	return static_cast<Float64>( Timer::GetSystemTimeNanoseconds( ) - p_StartTime ) / 1000000.0;
+}
+
+int main( int p_ArgumentCount, char ** p_ppArguments )
+{
+	const Int32 maxThreadCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 1,
+														 static_cast<Int32>( sysconf( _SC_NPROCESSORS_ONLN ) ) );
+	const Int32 elementCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 2, 1000000 );
+
+	if( maxThreadCount < 1 || elementCount < 1 )
+	{
+		std::printf( "Invalid arguments.\n" );
+		return 1;
+	}
+
+	std::vector<Float32> input( elementCount );
+	std::vector<Float64> output( elementCount );
+	for( Int32 i = 0; i < elementCount; i++ )
+	{
+		input[ i ] = static_cast<Float32>( i % 1000 ) * 0.001f;
+	}
+
+	Float64 singleThreadTime = 0.0;
+	for( Int32 threadCount = 1; threadCount <= maxThreadCount; threadCount++ )
+	{
+		JobSystem jobSystem;
+		if( threadCount > 1 && jobSystem.Start( static_cast<Uint32>( threadCount - 1 ) ) == false )
+		{
+			std::printf( "Failed to start the job system.\n" );
+			return 1;
+		}
+
+		// Parallel for, the best of 5 runs.
+		Float64 parallelForTime = 0.0;
+		for( Int32 i = 0; i < 5; i++ )
+		{
+			const Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+			jobSystem.ParallelFor( 0, input.size( ), [ &input, &output ]( const SizeType p_Begin, const SizeType p_End )
+			{
+				for( SizeType j = p_Begin; j < p_End; j++ )
+				{
+					output[ j ] = std::sqrt( input[ j ] ) * 1.5 + std::sin( input[ j ] );
+				}
+			} );
+			const Float64 time = GetMilliseconds( startTime );
+			parallelForTime = i == 0 || time < parallelForTime ? time : parallelForTime;
+		}
+		if( threadCount == 1 )
+		{
+			singleThreadTime = parallelForTime;
+		}
+
+		// Tiny jobs.
+		std::atomic<Int64> sum( 0 );
+		JobSystem::Counter counter;
+		Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+		for( Int32 i = 0; i < g_TinyJobCount; i++ )
+		{
+			jobSystem.Run( [ &sum, i ]( )
+			{
+				sum += i;
+			}, &counter );
+		}
+		jobSystem.Wait( counter );
+		const Float64 tinyJobTime = GetMilliseconds( startTime ) * 1000000.0 / g_TinyJobCount;
+		const Bool sumCorrect = sum == static_cast<Int64>( g_TinyJobCount ) * ( g_TinyJobCount - 1 ) / 2;
+
+		// Fork and join.
+		startTime = Timer::GetSystemTimeNanoseconds( );
+		const Int64 fibonacci = Fibonacci( jobSystem, g_Fibonacci );
+		const Float64 forkJoinTime = GetMilliseconds( startTime );
+
+		std::printf( "Threads: %2i, ParallelFor: %7.2f ms (%.2fx), tiny jobs: %6.1f ns/job%s, fork and join fib(%i) = %lld: %6.2f ms\n",
+					 threadCount, parallelForTime, singleThreadTime / parallelForTime, tinyJobTime, sumCorrect ? "" : " (wrong sum)",
+					 g_Fibonacci, static_cast<long long>( fibonacci ), forkJoinTime );
+
+		jobSystem.Stop( );
+	}
+
+	return 0;
+}
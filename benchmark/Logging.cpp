@@ -0,0 +1,150 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////
+// Logging benchmark.
+//
+// A number of threads log formatted info messages by bitLog at the
+// same time. The messages are counted by a log handle, which can be
+// made slow to fill the message queue. Reports the log calls per
+// second, the latency of the calls on the logging threads, the
+// handled and dropped messages and the time to flush the queue.
+//
+// Usage: Logging [threads = 8] [messages per thread = 20000] [handle microseconds = 0]
+//
+////////////////////////////////////////////////////////////////
+
+#include <Bit/System/Log.hpp>
+#include <Bit/System/Thread.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Benchmark.hpp>
+#include <atomic>
+#include <cstdio>
+#include <vector>
+#include <sched.h>
+
+using namespace Bit;
+
+// Log handle counting the messages, busy waiting for every message.
+class CountingLogHandle : public LogHandle
+{
+
+public:
+
+	CountingLogHandle( const Uint64 p_HandleTime ) :
+		Count( 0 ),
+		Bytes( 0 ),
+		m_HandleTime( p_HandleTime )
+	{
+	}
+
+	virtual void OnMessage( const LogMessage & p_Message )
+	{
+		const Uint64 endTime = Timer::GetSystemTimeNanoseconds( ) + m_HandleTime;
+		while( m_HandleTime && Timer::GetSystemTimeNanoseconds( ) < endTime )
+		{
+		}
+
+		Bytes += p_Message.message.size( );
+		Count++;
+	}
+
+	std::atomic<Uint64> Count;
+	Uint64 Bytes;
+
+private:
+
+	Uint64 m_HandleTime;
+
+};
+
+int main( int p_ArgumentCount, char ** p_ppArguments )
+{
+	const Int32 threadCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 1, 8 );
+	const Int32 messageCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 2, 20000 );
+	const Int32 handleTime = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 3, 0 );
+
+	if( threadCount < 1 || messageCount < 1 || handleTime < 0 )
+	{
+		std::printf( "Invalid arguments.\n" );
+		return 1;
+	}
+
+	static CountingLogHandle handle( static_cast<Uint64>( handleTime ) * 1000ULL );
+	Log::SetHandle( handle );
+
+	// The threads start logging at the same time.
+	std::atomic<Bool> start( false );
+	std::vector<std::vector<Float64> > latencies( threadCount );
+	std::vector<Thread *> threads;
+	for( Int32 i = 0; i < threadCount; i++ )
+	{
+		std::vector<Float64> & threadLatencies = latencies[ i ];
+		threadLatencies.reserve( messageCount );
+
+		threads.push_back( new Thread( [ &start, &threadLatencies, i, messageCount ]( )
+		{
+			while( start == false )
+			{
+				sched_yield( );
+			}
+
+			for( Int32 j = 0; j < messageCount; j++ )
+			{
+				const Uint64 callTime = Timer::GetSystemTimeNanoseconds( );
+				bitLog( Log::Info, Log::Network, "Thread " << i << " message " << j << " value " << 3.25 * j );
+				threadLatencies.push_back( static_cast<Float64>( Timer::GetSystemTimeNanoseconds( ) - callTime ) );
+			}
+		} ) );
+	}
+
+	const Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+	start = true;
+	for( SizeType i = 0; i < threads.size( ); i++ )
+	{
+		threads[ i ]->Finish( );
+		delete threads[ i ];
+	}
+	const Uint64 logTime = Timer::GetSystemTimeNanoseconds( ) - startTime;
+
+	Log::Flush( );
+	const Uint64 flushTime = Timer::GetSystemTimeNanoseconds( ) - startTime - logTime;
+
+	std::vector<Float64> allLatencies;
+	for( SizeType i = 0; i < latencies.size( ); i++ )
+	{
+		allLatencies.insert( allLatencies.end( ), latencies[ i ].begin( ), latencies[ i ].end( ) );
+	}
+
+	const Float64 callCount = static_cast<Float64>( threadCount ) * messageCount;
+	std::printf( "Threads: %i, log calls: %.0f, %.0f calls/s\n", threadCount, callCount,
+				 callCount * 1000000000.0 / static_cast<Float64>( logTime ) );
+	std::printf( "Latency p50: %.0f ns, p99: %.0f ns, p99.9: %.0f ns\n", Benchmark::GetPercentile( allLatencies, 50.0 ),
+				 Benchmark::GetPercentile( allLatencies, 99.0 ), Benchmark::GetPercentile( allLatencies, 99.9 ) );
+	std::printf( "Handled: %llu messages of %llu bytes, dropped: %llu, flush: %.1f ms\n",
+				 static_cast<unsigned long long>( handle.Count ), static_cast<unsigned long long>( handle.Bytes ),
+				 static_cast<unsigned long long>( Log::GetDroppedCount( ) ), static_cast<Float64>( flushTime ) / 1000000.0 );
+
+	Log::SetHandle( Log::GetDefaultHandle( ) );
+	return 0;
+}
@@ -0,0 +1,302 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////
+// Memory pool benchmark.
+//
+// Compares the concurrent memory pool with a memory pool protected
+// by a mutex, the way the server shared its packet pool. Reports the
+// time per get and return by threads getting and returning their
+// own items, and per item passed from producer to consumer threads,
+// with the hits, misses and high water mark of the concurrent pool.
+//
+// Usage: MemoryPools [threads = 4] [operations = 2000000]
+//
+////////////////////////////////////////////////////////////////
+
+#include <Bit/System/ConcurrentMemoryPool.hpp>
+#include <Bit/System/MemoryPool.hpp>
+#include <Bit/System/Mutex.hpp>
+#include <Bit/System/Thread.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Benchmark.hpp>
+#include <atomic>
+#include <cstdio>
+#include <vector>
+#include <sched.h>
+
+using namespace Bit;
+
+static const SizeType g_PoolSize = 4096;
+static const SizeType g_ItemSize = 1500;
+
+// Memory pool protected by a mutex.
+class LockedMemoryPool
+{
+
+public:
+
+	typedef MemoryPool<Uint8>::Item Item;
+
+	LockedMemoryPool( ) :
+		m_Pool( g_PoolSize, g_ItemSize, true )
+	{
+	}
+
+	Item * Get( )
+	{
+		m_Mutex.Lock( );
+		Item * pItem = m_Pool.Get( );
+		m_Mutex.Unlock( );
+		return pItem;
+	}
+
+	void Return( Item * p_pItem )
+	{
+		m_Mutex.Lock( );
+		m_Pool.Return( p_pItem );
+		m_Mutex.Unlock( );
+	}
+
+private:
+
+	MemoryPool<Uint8>	m_Pool;
+	Mutex				m_Mutex;
+
+};
+
+// Concurrent memory pool of the same interface.
+class SharedMemoryPool
+{
+
+public:
+
+	typedef ConcurrentMemoryPool<Uint8>::Item Item;
+
+	SharedMemoryPool( ) :
+		m_Pool( g_PoolSize, g_ItemSize, true )
+	{
+	}
+
+	Item * Get( )
+	{
+		return m_Pool.Get( );
+	}
+
+	void Return( Item * p_pItem )
+	{
+		m_Pool.Return( p_pItem );
+	}
+
+	ConcurrentMemoryPool<Uint8>::Statistics GetStatistics( ) const
+	{
+		return m_Pool.GetStatistics( );
+	}
+
+private:
+
+	ConcurrentMemoryPool<Uint8> m_Pool;
+
+};
+
+// Single producer and single consumer queue of items.
+template<typename ItemType>
+class ItemQueue
+{
+
+public:
+
+	static const Uint32 Size = 1024;
+
+	ItemQueue( ) :
+		m_Head( 0 ),
+		m_Tail( 0 )
+	{
+	}
+
+	Bool Push( ItemType * p_pItem )
+	{
+		const Uint32 tail = m_Tail.load( std::memory_order_relaxed );
+		if( tail - m_Head.load( std::memory_order_acquire ) >= Size )
+		{
+			return false;
+		}
+		m_Items[ tail % Size ] = p_pItem;
+		m_Tail.store( tail + 1, std::memory_order_release );
+		return true;
+	}
+
+	ItemType * Pop( )
+	{
+		const Uint32 head = m_Head.load( std::memory_order_relaxed );
+		if( head == m_Tail.load( std::memory_order_acquire ) )
+		{
+			return NULL;
+		}
+		ItemType * pItem = m_Items[ head % Size ];
+		m_Head.store( head + 1, std::memory_order_release );
+		return pItem;
+	}
+
+private:
+
+	ItemType *				m_Items[ Size ];
+	std::atomic<Uint32>		m_Head;
+	std::atomic<Uint32>		m_Tail;
+
+};
+
+// Join and delete the threads.
+static void FinishThreads( std::vector<Thread *> & p_Threads )
+{
+	for( SizeType i = 0; i < p_Threads.size( ); i++ )
+	{
+		p_Threads[ i ]->Finish( );
+		delete p_Threads[ i ];
+	}
+	p_Threads.clear( );
+}
+
+// Every thread gets 8 items, writes to them and returns them.
+template<typename Pool>
+static Float64 RunSameThread( Pool & p_Pool, const Int32 p_ThreadCount, const Int32 p_OperationCount )
+{
+	const Int32 operationsPerThread = p_OperationCount / p_ThreadCount / 8 * 8;
+
+	const Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+	std::vector<Thread *> threads;
+	for( Int32 i = 0; i < p_ThreadCount; i++ )
+	{
+		threads.push_back( new Thread( [ &p_Pool, operationsPerThread ]( )
+		{
+			typename Pool::Item * items[ 8 ];
+			for( Int32 j = 0; j < operationsPerThread; j += 8 )
+			{
+				for( SizeType k = 0; k < 8; k++ )
+				{
+					items[ k ] = p_Pool.Get( );
+					items[ k ]->GetData( )[ 0 ] = static_cast<Uint8>( j );
+				}
+				for( SizeType k = 0; k < 8; k++ )
+				{
+					p_Pool.Return( items[ k ] );
+				}
+			}
+		} ) );
+	}
+	FinishThreads( threads );
+
+	return static_cast<Float64>( Timer::GetSystemTimeNanoseconds( ) - startTime ) /
+		   ( static_cast<Float64>( operationsPerThread ) * p_ThreadCount );
+}
+
+// Producers get items and pass them to their consumers, returning them.
+template<typename Pool>
+static Float64 RunProducerConsumer( Pool & p_Pool, const Int32 p_PairCount, const Int32 p_OperationCount )
+{
+	typedef ItemQueue<typename Pool::Item> Queue;
+	const Int32 itemsPerPair = p_OperationCount / p_PairCount;
+	std::vector<Queue *> queues;
+
+	const Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+	std::vector<Thread *> threads;
+	for( Int32 i = 0; i < p_PairCount; i++ )
+	{
+		Queue * pQueue = new Queue;
+		queues.push_back( pQueue );
+
+		threads.push_back( new Thread( [ &p_Pool, pQueue, itemsPerPair ]( )
+		{
+			for( Int32 j = 0; j < itemsPerPair; j++ )
+			{
+				typename Pool::Item * pItem = p_Pool.Get( );
+				pItem->GetData( )[ 0 ] = static_cast<Uint8>( j );
+				while( pQueue->Push( pItem ) == false )
+				{
+					sched_yield( );
+				}
+			}
+		} ) );
+
+		threads.push_back( new Thread( [ &p_Pool, pQueue, itemsPerPair ]( )
+		{
+			for( Int32 j = 0; j < itemsPerPair; )
+			{
+				typename Pool::Item * pItem = pQueue->Pop( );
+				if( pItem == NULL )
+				{
+					sched_yield( );
+					continue;
+				}
+				p_Pool.Return( pItem );
+				j++;
+			}
+		} ) );
+	}
+	FinishThreads( threads );
+	const Float64 time = static_cast<Float64>( Timer::GetSystemTimeNanoseconds( ) - startTime ) /
+						 ( static_cast<Float64>( itemsPerPair ) * p_PairCount );
+
+	for( SizeType i = 0; i < queues.size( ); i++ )
+	{
+		delete queues[ i ];
+	}
+
+	return time;
+}
+
+int main( int p_ArgumentCount, char ** p_ppArguments )
+{
+	const Int32 maxThreadCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 1, 4 );
+	const Int32 operationCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 2, 2000000 );
+
+	if( maxThreadCount < 1 || operationCount < maxThreadCount * 8 )
+	{
+		std::printf( "Invalid arguments.\n" );
+		return 1;
+	}
+
+	for( Int32 threadCount = 1; threadCount <= maxThreadCount; threadCount *= 2 )
+	{
+		LockedMemoryPool lockedPool;
+		SharedMemoryPool sharedPool;
+		const Float64 lockedTime = RunSameThread( lockedPool, threadCount, operationCount );
+		const Float64 sharedTime = RunSameThread( sharedPool, threadCount, operationCount );
+		std::printf( "Get and return, %i threads: mutex pool: %.1f ns, concurrent pool: %.1f ns\n", threadCount, lockedTime, sharedTime );
+	}
+
+	for( Int32 pairCount = 1; pairCount * 2 <= maxThreadCount || pairCount == 1; pairCount *= 2 )
+	{
+		LockedMemoryPool lockedPool;
+		SharedMemoryPool sharedPool;
+		const Float64 lockedTime = RunProducerConsumer( lockedPool, pairCount, operationCount / 2 );
+		const Float64 sharedTime = RunProducerConsumer( sharedPool, pairCount, operationCount / 2 );
+
+		const ConcurrentMemoryPool<Uint8>::Statistics statistics = sharedPool.GetStatistics( );
+		std::printf( "Producer and consumer, %i pairs: mutex pool: %.1f ns, concurrent pool: %.1f ns, hits: %llu, misses: %llu, high water: %u\n",
+					 pairCount, lockedTime, sharedTime, static_cast<unsigned long long>( statistics.Hits ),
+					 static_cast<unsigned long long>( statistics.Misses ), static_cast<Uint32>( statistics.HighWater ) );
+	}
+
+	return 0;
+}
@@ -0,0 +1,250 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////
+// Message channel benchmark.
+//
+// Connects a client to a server through the network simulator,
+// adding delay, jitter and loss. The client sends a user message on
+// a channel of every delivery type at a fixed rate. Reports, for
+// every channel, the delivered messages, the messages breaking the
+// guarantees of the delivery type, the latency from sending to
+// handling and the ordering delay measured by the server, an
+// exponentially weighted moving average (1/8 weight) of the time the
+// messages waited in the reorder buffer.
+//
+// Usage: MessageChannels [delay ms = 20] [jitter ms = 15] [loss percent = 10]
+//                        [messages = 1000]
+//
+////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Server.hpp>
+#include <Bit/Network/Net/Client.hpp>
+#include <Bit/Network/Net/NetworkSimulator.hpp>
+#include <Bit/Network/Net/UserMessageDecoder.hpp>
+#include <Bit/System/Mutex.hpp>
+#include <Bit/System/Sleep.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Benchmark.hpp>
+#include <atomic>
+#include <cstdio>
+#include <vector>
+
+using namespace Bit;
+using namespace Bit::Net;
+
+static const Uint16 g_ServerPort = 12387;
+static const Uint16 g_SimulatorPort = 12388;
+
+static const Uint8 g_ChannelCount = 4;
+static const char * const g_ChannelNames[ g_ChannelCount ] =
+{
+	"Unreliable", "UnreliableSequenced", "ReliableUnordered", "ReliableOrdered"
+};
+
+class BenchmarkServer : public Server
+{
+
+public:
+
+	using Server::HookUserMessage;
+	using Server::Start;
+	using Server::GetUserStatistics;
+
+};
+
+class BenchmarkClient : public Client
+{
+
+public:
+
+	BenchmarkClient( ) :
+		Client( 0 )
+	{
+	}
+
+	using Client::Connect;
+	using Client::CreateUserMessage;
+	using Client::SetChannel;
+
+};
+
+// Checks the messages of a channel by the guarantees of its delivery type.
+class ChannelListener : public UserMessageListener
+{
+
+public:
+
+	ChannelListener( ) :
+		Count( 0 ),
+		Violations( 0 ),
+		m_Delivery( DeliveryType::Unreliable ),
+		m_LastIndex( -1 )
+	{
+	}
+
+	void SetDelivery( const DeliveryType::eType p_Delivery, const Int32 p_MessageCount )
+	{
+		m_Delivery = p_Delivery;
+		m_Received.assign( p_MessageCount, false );
+	}
+
+	virtual void HandleMessage( UserMessageDecoder & p_Message )
+	{
+		const Int32 index = p_Message.ReadInt( );
+		Uint64 sent = 0;
+		p_Message.ReadArray( &sent, sizeof( sent ) );
+		const Float64 latency = static_cast<Float64>( Timer::GetSystemTimeNanoseconds( ) - sent ) / 1000000.0;
+
+		Mutex.Lock( );
+
+		// Every delivery type drops duplicates.
+		Bool violation = index < 0 || index >= static_cast<Int32>( m_Received.size( ) ) || m_Received[ index ];
+		if( m_Delivery == DeliveryType::UnreliableSequenced )
+		{
+			violation = violation || index <= m_LastIndex;
+		}
+		else if( m_Delivery == DeliveryType::ReliableOrdered )
+		{
+			violation = violation || index != m_LastIndex + 1;
+		}
+
+		if( violation )
+		{
+			Violations++;
+		}
+		else
+		{
+			m_Received[ index ] = true;
+		}
+		m_LastIndex = index;
+		Latencies.push_back( latency );
+
+		Mutex.Unlock( );
+		Count++;
+	}
+
+	std::atomic<Int32> Count;
+	std::atomic<Int32> Violations;
+	Bit::Mutex Mutex;
+	std::vector<Float64> Latencies;
+
+private:
+
+	DeliveryType::eType m_Delivery;
+	Int32 m_LastIndex;
+	std::vector<Bool> m_Received;
+
+};
+
+int main( int p_ArgumentCount, char ** p_ppArguments )
+{
+	const Int32 delay = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 1, 20 );
+	const Int32 jitter = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 2, 15 );
+	const Int32 loss = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 3, 10 );
+	const Int32 messageCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 4, 1000 );
+
+	if( messageCount < 1 )
+	{
+		std::printf( "Invalid arguments.\n" );
+		return 1;
+	}
+
+	// One message name per channel, the delivery type equals the channel index.
+	BenchmarkServer server;
+	ChannelListener listeners[ g_ChannelCount ];
+	for( Uint8 i = 0; i < g_ChannelCount; i++ )
+	{
+		listeners[ i ].SetDelivery( static_cast<DeliveryType::eType>( i ), messageCount );
+		server.HookUserMessage( &listeners[ i ], g_ChannelNames[ i ] );
+	}
+	if( server.Start( Server::Properties( g_ServerPort, 8, Seconds( 5.0f ) ) ) == false )
+	{
+		std::printf( "Failed to start the server.\n" );
+		return 1;
+	}
+
+	NetworkSimulator simulator;
+	const NetworkSimulator::Settings settings( Milliseconds( delay ), Milliseconds( jitter ), static_cast<Float32>( loss ) / 100.0f );
+	if( simulator.Start( g_SimulatorPort, Address( 127, 0, 0, 1 ), g_ServerPort, settings, 1 ) == false )
+	{
+		std::printf( "Failed to start the network simulator.\n" );
+		return 1;
+	}
+
+	// Connect with a lossless network, the connection packets are not resent.
+	simulator.SetSettings( NetworkSimulator::Settings( Milliseconds( delay ) ) );
+	BenchmarkClient client;
+	for( Uint8 i = 0; i < g_ChannelCount; i++ )
+	{
+		client.SetChannel( i, static_cast<DeliveryType::eType>( i ) );
+	}
+	if( client.Connect( Address( 127, 0, 0, 1 ), g_SimulatorPort, Seconds( 5.0f ) ) != Client::Succeeded )
+	{
+		std::printf( "Failed to connect.\n" );
+		return 1;
+	}
+	simulator.SetSettings( settings );
+
+	// 200 messages per second on every channel.
+	for( Int32 i = 0; i < messageCount; i++ )
+	{
+		for( Uint8 j = 0; j < g_ChannelCount; j++ )
+		{
+			UserMessage * pMessage = client.CreateUserMessage( g_ChannelNames[ j ], 4 + sizeof( Uint64 ) );
+			const Uint64 sent = Timer::GetSystemTimeNanoseconds( );
+			pMessage->WriteInt( i );
+			pMessage->WriteArray( &sent, sizeof( sent ) );
+			pMessage->SendOnChannel( j );
+			delete pMessage;
+		}
+		Sleep( Milliseconds( 5 ) );
+	}
+
+	// Wait for the reliable channels.
+	const Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+	while( ( listeners[ DeliveryType::ReliableUnordered ].Count < messageCount ||
+			 listeners[ DeliveryType::ReliableOrdered ].Count < messageCount ) &&
+		   Timer::GetSystemTimeNanoseconds( ) - startTime < 30000000000ULL )
+	{
+		Sleep( Milliseconds( 10 ) );
+	}
+
+	std::printf( "Delay: %i ms, jitter: %i ms, loss: %i%%, messages per channel: %i\n", delay, jitter, loss, messageCount );
+
+	ConnectionStatistics statistics;
+	server.GetUserStatistics( 0, statistics );
+	for( Uint8 i = 0; i < g_ChannelCount; i++ )
+	{
+		ChannelListener & listener = listeners[ i ];
+		listener.Mutex.Lock( );
+		std::printf( "%-20s delivered: %4i, violations: %i, latency p50: %.1f ms, p99: %.1f ms, ordering delay EWMA: %.1f ms\n",
+					 g_ChannelNames[ i ], static_cast<Int32>( listener.Count ), static_cast<Int32>( listener.Violations ),
+					 Benchmark::GetPercentile( listener.Latencies, 50.0 ), Benchmark::GetPercentile( listener.Latencies, 99.0 ),
+					 statistics.OrderingDelay[ i ].AsMicroseconds( ) / 1000.0 );
+		listener.Mutex.Unlock( );
+	}
+
+	// The client is destroyed, and disconnected, before the server.
+	return 0;
+}
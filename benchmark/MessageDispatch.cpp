@@ -0,0 +1,224 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////
+// Message dispatch benchmark.
+//
+// A loopback client sends small reliable user messages of two types
+// to a server, and the server sends host messages of two types back.
+// Reports the messages per second dispatched to the listeners on
+// the server and on the client, and the messages handled by the
+// wrong listener.
+//
+// Usage: MessageDispatch [messages = 20000] [burst = 1000]
+//
+////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Server.hpp>
+#include <Bit/Network/Net/Client.hpp>
+#include <Bit/Network/Net/HostRecipientFilter.hpp>
+#include <Bit/Network/Net/HostMessageDecoder.hpp>
+#include <Bit/Network/Net/UserMessageDecoder.hpp>
+#include <Bit/System/Sleep.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Benchmark.hpp>
+#include <atomic>
+#include <cstdio>
+
+using namespace Bit;
+using namespace Bit::Net;
+
+static const Uint16 g_Port = 12386;
+static const std::string g_MessageNames[ 2 ] = { "position", "command" };
+
+class BenchmarkServer : public Server
+{
+
+public:
+
+	using Server::HookUserMessage;
+	using Server::CreateHostMessage;
+	using Server::CreateRecipientFilter;
+	using Server::Start;
+
+};
+
+class BenchmarkClient : public Client
+{
+
+public:
+
+	BenchmarkClient( ) :
+		Client( 0 )
+	{
+	}
+
+	using Client::Connect;
+	using Client::HookHostMessage;
+	using Client::CreateUserMessage;
+
+};
+
+// Count the messages, the first integer is the index of the message name.
+template<typename Decoder>
+static void CountMessage( Decoder & p_Message, std::atomic<Int32> & p_Count, std::atomic<Int32> & p_Errors )
+{
+	const Int32 index = p_Message.ReadInt( );
+	if( index < 0 || index > 1 || p_Message.GetName( ) != g_MessageNames[ index ] )
+	{
+		p_Errors++;
+	}
+	p_Count++;
+}
+
+class HostListener : public HostMessageListener
+{
+
+public:
+
+	HostListener( ) :
+		Count( 0 ),
+		Errors( 0 )
+	{
+	}
+
+	virtual void HandleMessage( HostMessageDecoder & p_Message )
+	{
+		CountMessage( p_Message, Count, Errors );
+	}
+
+	std::atomic<Int32> Count;
+	std::atomic<Int32> Errors;
+
+};
+
+class UserListener : public UserMessageListener
+{
+
+public:
+
+	UserListener( ) :
+		Count( 0 ),
+		Errors( 0 )
+	{
+	}
+
+	virtual void HandleMessage( UserMessageDecoder & p_Message )
+	{
+		CountMessage( p_Message, Count, Errors );
+	}
+
+	std::atomic<Int32> Count;
+	std::atomic<Int32> Errors;
+
+};
+
+// Wait for the messages, return the seconds since the start time.
+static Float64 WaitForMessages( std::atomic<Int32> & p_Count, const Int32 p_Expected, const Uint64 p_StartTime )
+{
+	while( p_Count < p_Expected && Timer::GetSystemTimeNanoseconds( ) - p_StartTime < 60000000000ULL )
+	{
+		Sleep( Milliseconds( 1 ) );
+	}
+
+	return static_cast<Float64>( Timer::GetSystemTimeNanoseconds( ) - p_StartTime ) / 1000000000.0;
+}
+
+int main( int p_ArgumentCount, char ** p_ppArguments )
+{
+	const Int32 messageCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 1, 20000 );
+	const Int32 burstSize = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 2, 1000 );
+
+	if( messageCount < 1 || burstSize < 1 )
+	{
+		std::printf( "Invalid arguments.\n" );
+		return 1;
+	}
+
+	BenchmarkServer server;
+	UserListener userListener;
+	server.HookUserMessage( &userListener, g_MessageNames[ 0 ] );
+	server.HookUserMessage( &userListener, g_MessageNames[ 1 ] );
+	if( server.Start( Server::Properties( g_Port, 8, Seconds( 5.0f ) ) ) == false )
+	{
+		std::printf( "Failed to start the server.\n" );
+		return 1;
+	}
+
+	BenchmarkClient client;
+	HostListener hostListener;
+	client.HookHostMessage( &hostListener, g_MessageNames[ 0 ] );
+	client.HookHostMessage( &hostListener, g_MessageNames[ 1 ] );
+	if( client.Connect( Address( 127, 0, 0, 1 ), g_Port, Seconds( 5.0f ) ) != Client::Succeeded )
+	{
+		std::printf( "Failed to connect.\n" );
+		return 1;
+	}
+
+	// User messages, sent in bursts to keep the socket buffers from overflowing.
+	Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+	for( Int32 i = 0; i < messageCount; i++ )
+	{
+		UserMessage * pMessage = client.CreateUserMessage( g_MessageNames[ i % 2 ], 8 );
+		pMessage->WriteInt( i % 2 );
+		pMessage->WriteInt( i );
+		pMessage->Send( true );
+		delete pMessage;
+
+		if( i % burstSize == burstSize - 1 )
+		{
+			Sleep( Milliseconds( 1 ) );
+		}
+	}
+	const Float64 userTime = WaitForMessages( userListener.Count, messageCount, startTime );
+
+	// Host messages.
+	startTime = Timer::GetSystemTimeNanoseconds( );
+	for( Int32 i = 0; i < messageCount; i++ )
+	{
+		HostMessage * pMessage = server.CreateHostMessage( g_MessageNames[ i % 2 ], 8 );
+		pMessage->WriteInt( i % 2 );
+		pMessage->WriteInt( i );
+		HostRecipientFilter * pFilter = server.CreateRecipientFilter( );
+		pFilter->AddAllUsers( );
+		pMessage->Send( pFilter );
+		delete pFilter;
+		delete pMessage;
+
+		if( i % burstSize == burstSize - 1 )
+		{
+			Sleep( Milliseconds( 1 ) );
+		}
+	}
+	const Float64 hostTime = WaitForMessages( hostListener.Count, messageCount, startTime );
+
+	std::printf( "Server: %i/%i user messages, errors: %i, %.3f s, %.0f messages/s\n",
+				 static_cast<Int32>( userListener.Count ), messageCount, static_cast<Int32>( userListener.Errors ),
+				 userTime, static_cast<Float64>( userListener.Count ) / userTime );
+	std::printf( "Client: %i/%i host messages, errors: %i, %.3f s, %.0f messages/s\n",
+				 static_cast<Int32>( hostListener.Count ), messageCount, static_cast<Int32>( hostListener.Errors ),
+				 hostTime, static_cast<Float64>( hostListener.Count ) / hostTime );
+
+	// The client is destroyed, and disconnected, before the server.
+	return 0;
+}
@@ -0,0 +1,176 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////
+// Network simulator benchmark.
+//
+// Connects a client to a server through the network simulator,
+// adding delay, jitter and loss in both directions. The client sends
+// reliable user messages at a fixed rate. Reports the delivered
+// messages and the connection statistics of both sides: round trip
+// time, retransmission timeout, loss and resent packets.
+//
+// Usage: NetworkSimulator [delay ms = 50] [jitter ms = 10] [loss percent = 5]
+//                         [congestion control = 1] [seconds = 5]
+//
+////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Server.hpp>
+#include <Bit/Network/Net/Client.hpp>
+#include <Bit/Network/Net/NetworkSimulator.hpp>
+#include <Bit/Network/Net/UserMessageDecoder.hpp>
+#include <Bit/System/Sleep.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Benchmark.hpp>
+#include <atomic>
+#include <cstdio>
+
+using namespace Bit;
+using namespace Bit::Net;
+
+static const Uint16 g_ServerPort = 12384;
+static const Uint16 g_SimulatorPort = 12385;
+
+class BenchmarkServer : public Server
+{
+
+public:
+
+	using Server::HookUserMessage;
+	using Server::Start;
+	using Server::GetUserStatistics;
+
+};
+
+class BenchmarkClient : public Client
+{
+
+public:
+
+	BenchmarkClient( ) :
+		Client( 0 )
+	{
+	}
+
+	using Client::Connect;
+	using Client::CreateUserMessage;
+	using Client::GetStatistics;
+
+};
+
+class CountingListener : public UserMessageListener
+{
+
+public:
+
+	CountingListener( ) :
+		Count( 0 )
+	{
+	}
+
+	virtual void HandleMessage( UserMessageDecoder & p_Message )
+	{
+		p_Message.ReadInt( );
+		Count++;
+	}
+
+	std::atomic<Int32> Count;
+
+};
+
+// Print the statistics of a connection.
+static void PrintStatistics( const char * p_pName, const ConnectionStatistics & p_Statistics )
+{
+	std::printf( "%s rtt: %.1f ms, variance: %.1f ms, rto: %.1f ms, loss: %.1f%%, sent: %llu, resent: %llu\n", p_pName,
+				 p_Statistics.Rtt.AsMicroseconds( ) / 1000.0, p_Statistics.RttVariance.AsMicroseconds( ) / 1000.0,
+				 p_Statistics.Rto.AsMicroseconds( ) / 1000.0, p_Statistics.PacketLoss,
+				 static_cast<unsigned long long>( p_Statistics.PacketsSent ), static_cast<unsigned long long>( p_Statistics.PacketsLost ) );
+}
+
+int main( int p_ArgumentCount, char ** p_ppArguments )
+{
+	const Int32 delay = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 1, 50 );
+	const Int32 jitter = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 2, 10 );
+	const Int32 loss = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 3, 5 );
+	const Bool congestionControl = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 4, 1 ) != 0;
+	const Int32 seconds = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 5, 5 );
+
+	BenchmarkServer server;
+	CountingListener listener;
+	server.HookUserMessage( &listener, "message" );
+	if( server.Start( Server::Properties( g_ServerPort, 8, Seconds( 5.0f ), 22, 30, "Bit Engine Network",
+										  false, 0, congestionControl ) ) == false )
+	{
+		std::printf( "Failed to start the server.\n" );
+		return 1;
+	}
+
+	NetworkSimulator simulator;
+	const NetworkSimulator::Settings settings( Milliseconds( delay ), Milliseconds( jitter ), static_cast<Float32>( loss ) / 100.0f );
+	if( simulator.Start( g_SimulatorPort, Address( 127, 0, 0, 1 ), g_ServerPort, settings, 1 ) == false )
+	{
+		std::printf( "Failed to start the network simulator.\n" );
+		return 1;
+	}
+
+	// Connect with a lossless network, the connection packets are not resent.
+	simulator.SetSettings( NetworkSimulator::Settings( Milliseconds( delay ) ) );
+	BenchmarkClient client;
+	if( client.Connect( Address( 127, 0, 0, 1 ), g_SimulatorPort, Seconds( 5.0f ) ) != Client::Succeeded )
+	{
+		std::printf( "Failed to connect.\n" );
+		return 1;
+	}
+	simulator.SetSettings( settings );
+
+	// 100 messages per second.
+	const Int32 messageCount = seconds * 100;
+	for( Int32 i = 0; i < messageCount; i++ )
+	{
+		UserMessage * pMessage = client.CreateUserMessage( "message", 4 );
+		pMessage->WriteInt( i );
+		pMessage->Send( true );
+		delete pMessage;
+		Sleep( Milliseconds( 10 ) );
+	}
+
+	const Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+	while( listener.Count < messageCount && Timer::GetSystemTimeNanoseconds( ) - startTime < 30000000000ULL )
+	{
+		Sleep( Milliseconds( 10 ) );
+	}
+	const Float64 drainTime = static_cast<Float64>( Timer::GetSystemTimeNanoseconds( ) - startTime ) / 1000000.0;
+
+	std::printf( "Delay: %i ms, jitter: %i ms, loss: %i%%, congestion control: %s\n", delay, jitter, loss, congestionControl ? "on" : "off" );
+	std::printf( "Delivered: %i/%i, %.1f ms after the last send\n", static_cast<Int32>( listener.Count ), messageCount, drainTime );
+	std::printf( "Simulator forwarded: %llu, lost: %llu\n", static_cast<unsigned long long>( simulator.GetForwardedCount( ) ),
+				 static_cast<unsigned long long>( simulator.GetLostCount( ) ) );
+
+	ConnectionStatistics serverStatistics;
+	PrintStatistics( "Client", client.GetStatistics( ) );
+	if( server.GetUserStatistics( 0, serverStatistics ) )
+	{
+		PrintStatistics( "Server", serverStatistics );
+	}
+	return 0;
+}
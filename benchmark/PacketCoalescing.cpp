@@ -0,0 +1,285 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////
+// Packet coalescing benchmark.
+//
+// A loopback client sends bursts of small reliable user messages,
+// the server answers every one of them by a small host message.
+// Reports the messages, datagrams and bytes sent and received by the
+// client socket, counted by a socket factory.
+//
+// Usage: PacketCoalescing [bursts = 500] [messages per burst = 8]
+//
+////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Server.hpp>
+#include <Bit/Network/Net/Client.hpp>
+#include <Bit/Network/Net/SocketFactory.hpp>
+#include <Bit/Network/Net/HostRecipientFilter.hpp>
+#include <Bit/Network/Net/HostMessageDecoder.hpp>
+#include <Bit/Network/Net/UserMessageDecoder.hpp>
+#include <Bit/Network/UdpSocket.hpp>
+#include <Bit/System/Sleep.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Benchmark.hpp>
+#include <atomic>
+#include <cstdio>
+
+using namespace Bit;
+using namespace Bit::Net;
+
+static const Uint16 g_Port = 12383;
+
+// Counters of the client socket.
+static std::atomic<Uint64> g_SentDatagrams( 0 );
+static std::atomic<Uint64> g_SentBytes( 0 );
+static std::atomic<Uint64> g_ReceivedDatagrams( 0 );
+static std::atomic<Uint64> g_ReceivedBytes( 0 );
+
+class CountingSocket : public UdpSocket
+{
+
+public:
+
+	virtual Int32 Send( const void * p_pData, const SizeType p_Size, const Address & p_Address, const Uint16 p_Port )
+	{
+		const Int32 result = UdpSocket::Send( p_pData, p_Size, p_Address, p_Port );
+		CountSent( result );
+		return result;
+	}
+
+	virtual Int32 SendBatch( const Datagram * p_pDatagrams, const SizeType p_Count )
+	{
+		const Int32 result = UdpSocket::SendBatch( p_pDatagrams, p_Count );
+		for( Int32 i = 0; i < result; i++ )
+		{
+			CountSent( static_cast<Int32>( p_pDatagrams[ i ].HeaderSize + p_pDatagrams[ i ].DataSize ) );
+		}
+		return result;
+	}
+
+	virtual Int32 Receive( void * p_pData, const SizeType p_Size, Address & p_Address, Uint16 & p_Port )
+	{
+		const Int32 result = UdpSocket::Receive( p_pData, p_Size, p_Address, p_Port );
+		CountReceived( result );
+		return result;
+	}
+
+	virtual Int32 Receive( void * p_pData, const SizeType p_Size, Address & p_Address, Uint16 & p_Port, const Time & p_Timeout )
+	{
+		const Int32 result = UdpSocket::Receive( p_pData, p_Size, p_Address, p_Port, p_Timeout );
+		CountReceived( result );
+		return result;
+	}
+
+	virtual Int32 ReceiveBatch( Datagram * p_pDatagrams, const SizeType p_Count, const Time & p_Timeout )
+	{
+		const Int32 result = UdpSocket::ReceiveBatch( p_pDatagrams, p_Count, p_Timeout );
+		for( Int32 i = 0; i < result; i++ )
+		{
+			CountReceived( static_cast<Int32>( p_pDatagrams[ i ].DataSize ) );
+		}
+		return result;
+	}
+
+private:
+
+	static void CountSent( const Int32 p_Size )
+	{
+		if( p_Size > 0 )
+		{
+			g_SentDatagrams++;
+			g_SentBytes += static_cast<Uint64>( p_Size );
+		}
+	}
+
+	static void CountReceived( const Int32 p_Size )
+	{
+		if( p_Size > 0 )
+		{
+			g_ReceivedDatagrams++;
+			g_ReceivedBytes += static_cast<Uint64>( p_Size );
+		}
+	}
+
+};
+
+class CountingSocketFactory : public SocketFactory
+{
+
+public:
+
+	virtual Private::UdpSocketBase * CreateSocket( )
+	{
+		return new CountingSocket;
+	}
+
+};
+
+class BenchmarkServer : public Server
+{
+
+public:
+
+	using Server::HookUserMessage;
+	using Server::CreateHostMessage;
+	using Server::CreateRecipientFilter;
+	using Server::Start;
+
+};
+
+class BenchmarkClient : public Client
+{
+
+public:
+
+	BenchmarkClient( ) :
+		Client( 0 )
+	{
+	}
+
+	using Client::Connect;
+	using Client::HookHostMessage;
+	using Client::CreateUserMessage;
+	using Client::SetSocketFactory;
+
+};
+
+// Answer every user message by a host message.
+class EchoListener : public UserMessageListener
+{
+
+public:
+
+	EchoListener( BenchmarkServer & p_Server ) :
+		Count( 0 ),
+		m_Server( p_Server )
+	{
+	}
+
+	virtual void HandleMessage( UserMessageDecoder & p_Message )
+	{
+		const Int32 value = p_Message.ReadInt( );
+		HostMessage * pMessage = m_Server.CreateHostMessage( "echo", 4 );
+		pMessage->WriteInt( value );
+		HostRecipientFilter * pFilter = m_Server.CreateRecipientFilter( );
+		pFilter->AddUser( p_Message.GetUser( ) );
+		pMessage->Send( pFilter );
+		delete pFilter;
+		delete pMessage;
+		Count++;
+	}
+
+	std::atomic<Int32> Count;
+
+private:
+
+	BenchmarkServer & m_Server;
+
+};
+
+class CountingListener : public HostMessageListener
+{
+
+public:
+
+	CountingListener( ) :
+		Count( 0 )
+	{
+	}
+
+	virtual void HandleMessage( HostMessageDecoder & p_Message )
+	{
+		p_Message.ReadInt( );
+		Count++;
+	}
+
+	std::atomic<Int32> Count;
+
+};
+
+int main( int p_ArgumentCount, char ** p_ppArguments )
+{
+	const Int32 burstCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 1, 500 );
+	const Int32 burstSize = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 2, 8 );
+	const Int32 messageCount = burstCount * burstSize;
+
+	BenchmarkServer server;
+	EchoListener echoListener( server );
+	server.HookUserMessage( &echoListener, "chat" );
+	if( server.Start( Server::Properties( g_Port, 8, Seconds( 5.0f ) ) ) == false )
+	{
+		std::printf( "Failed to start the server.\n" );
+		return 1;
+	}
+
+	CountingSocketFactory socketFactory;
+	BenchmarkClient client;
+	CountingListener countingListener;
+	client.SetSocketFactory( &socketFactory );
+	client.HookHostMessage( &countingListener, "echo" );
+	if( client.Connect( Address( 127, 0, 0, 1 ), g_Port, Seconds( 5.0f ) ) != Client::Succeeded )
+	{
+		std::printf( "Failed to connect.\n" );
+		return 1;
+	}
+
+	// Count the chat traffic only.
+	Sleep( Milliseconds( 200 ) );
+	g_SentDatagrams = 0;
+	g_SentBytes = 0;
+	g_ReceivedDatagrams = 0;
+	g_ReceivedBytes = 0;
+
+	for( Int32 i = 0; i < burstCount; i++ )
+	{
+		for( Int32 j = 0; j < burstSize; j++ )
+		{
+			UserMessage * pMessage = client.CreateUserMessage( "chat", 4 );
+			pMessage->WriteInt( i * burstSize + j );
+			pMessage->Send( true );
+			delete pMessage;
+		}
+		Sleep( Milliseconds( 5 ) );
+	}
+
+	const Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+	while( countingListener.Count < messageCount && Timer::GetSystemTimeNanoseconds( ) - startTime < 30000000000ULL )
+	{
+		Sleep( Milliseconds( 10 ) );
+	}
+
+	// Let the last acknowledgements arrive.
+	Sleep( Milliseconds( 200 ) );
+
+	std::printf( "Messages sent: %i, handled by the server: %i, answers received: %i\n",
+				 messageCount, static_cast<Int32>( echoListener.Count ), static_cast<Int32>( countingListener.Count ) );
+	std::printf( "Client sent:     %llu datagrams, %llu bytes, %.2f messages/datagram\n",
+				 static_cast<unsigned long long>( g_SentDatagrams ), static_cast<unsigned long long>( g_SentBytes ),
+				 static_cast<Float64>( messageCount ) / static_cast<Float64>( g_SentDatagrams ) );
+	std::printf( "Client received: %llu datagrams, %llu bytes, %.2f messages/datagram\n",
+				 static_cast<unsigned long long>( g_ReceivedDatagrams ), static_cast<unsigned long long>( g_ReceivedBytes ),
+				 static_cast<Float64>( countingListener.Count ) / static_cast<Float64>( g_ReceivedDatagrams ) );
+	return 0;
+}
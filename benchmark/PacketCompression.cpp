@@ -0,0 +1,224 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////
+// Packet compression benchmark.
+//
+// Records the entity snapshot messages of moving entities, as full
+// states and delta encoded against the snapshot two ticks back.
+// A dictionary is trained from the first third of the recording,
+// the rest is compressed and decompressed with and without the
+// dictionary. Reports the average message size, the compression
+// ratio and the compression and decompression speed in MB/s of the
+// uncompressed data.
+//
+// Usage: PacketCompression [entities = 300] [ticks = 600] [repeats = 20]
+//
+////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Server.hpp>
+#include <Bit/Network/Net/Variable.hpp>
+#include <Bit/Network/Net/CompressionDictionary.hpp>
+#include <Bit/Network/Net/Private/PacketCompressor.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Benchmark.hpp>
+#include <cstdio>
+#include <vector>
+
+using namespace Bit;
+using namespace Bit::Net;
+
+typedef std::vector<std::vector<Uint8> > MessageVector;
+
+class BenchmarkEntity : public Entity
+{
+
+public:
+
+	Variable<Vector3f32>	Position;
+	Variable<Int32>			Health;
+	Variable<Uint8>			State;
+
+};
+
+class BenchmarkServer : public Server
+{
+
+public:
+
+	using Server::m_EntityManager;
+
+};
+
+// Compress and decompress the messages, printing the results.
+static void RunCompression( const char * p_pName, const MessageVector & p_Messages,
+							const CompressionDictionary * p_pDictionary, const Int32 p_RepeatCount )
+{
+	std::vector<Uint8> compressed;
+	std::vector<Uint8> decompressed;
+	Uint64 inputBytes = 0;
+	Uint64 outputBytes = 0;
+	Uint64 decompressedBytes = 0;
+	Uint32 errors = 0;
+
+	Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+	for( Int32 i = 0; i < p_RepeatCount; i++ )
+	{
+		for( SizeType j = 0; j < p_Messages.size( ); j++ )
+		{
+			const std::vector<Uint8> & message = p_Messages[ j ];
+			compressed.clear( );
+			inputBytes += message.size( );
+			outputBytes += PacketCompressor::Compress( &message[ 0 ], message.size( ), compressed, p_pDictionary ) ?
+						   compressed.size( ) : message.size( );
+		}
+	}
+	const Uint64 compressTime = Timer::GetSystemTimeNanoseconds( ) - startTime;
+
+	// Compress the messages once, timing the decompression only.
+	MessageVector compressedMessages;
+	for( SizeType i = 0; i < p_Messages.size( ); i++ )
+	{
+		compressed.clear( );
+		if( PacketCompressor::Compress( &p_Messages[ i ][ 0 ], p_Messages[ i ].size( ), compressed, p_pDictionary ) )
+		{
+			compressedMessages.push_back( compressed );
+		}
+	}
+
+	startTime = Timer::GetSystemTimeNanoseconds( );
+	for( Int32 i = 0; i < p_RepeatCount; i++ )
+	{
+		for( SizeType j = 0; j < compressedMessages.size( ); j++ )
+		{
+			decompressed.clear( );
+			if( PacketCompressor::Decompress( &compressedMessages[ j ][ 0 ], compressedMessages[ j ].size( ),
+											  decompressed, 65536, p_pDictionary ) == false )
+			{
+				errors++;
+			}
+			decompressedBytes += decompressed.size( );
+		}
+	}
+	const Uint64 decompressTime = Timer::GetSystemTimeNanoseconds( ) - startTime;
+
+	std::printf( "%-22s size: %6.1f B, ratio: %.2f, compress: %6.1f MB/s, decompress: %6.1f MB/s, errors: %u\n", p_pName,
+				 static_cast<Float64>( inputBytes ) / ( p_RepeatCount * p_Messages.size( ) ),
+				 static_cast<Float64>( inputBytes ) / static_cast<Float64>( outputBytes ),
+				 static_cast<Float64>( inputBytes ) * 1000.0 / static_cast<Float64>( compressTime ),
+				 static_cast<Float64>( decompressedBytes ) * 1000.0 / static_cast<Float64>( decompressTime ), errors );
+}
+
+int main( int p_ArgumentCount, char ** p_ppArguments )
+{
+	const Int32 entityCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 1, 300 );
+	const Int32 tickCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 2, 600 );
+	const Int32 repeatCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 3, 20 );
+
+	if( entityCount < 1 || tickCount < 3 || repeatCount < 1 )
+	{
+		std::printf( "Invalid arguments.\n" );
+		return 1;
+	}
+
+	static BenchmarkServer server;
+	EntityManager & entityManager = server.m_EntityManager;
+	entityManager.LinkEntity<BenchmarkEntity>( "BenchmarkEntity" );
+	entityManager.RegisterVariable( "BenchmarkEntity", "Position", &BenchmarkEntity::Position );
+	entityManager.RegisterVariable( "BenchmarkEntity", "Health", &BenchmarkEntity::Health );
+	entityManager.RegisterVariable( "BenchmarkEntity", "State", &BenchmarkEntity::State );
+
+	std::vector<BenchmarkEntity *> entities;
+	for( Int32 i = 0; i < entityCount; i++ )
+	{
+		entities.push_back( static_cast<BenchmarkEntity *>( entityManager.CreateEntityByName( "BenchmarkEntity" ) ) );
+		entities.back( )->Health.Set( 100 );
+	}
+
+	// Record the traffic.
+	MessageVector fullMessages;
+	MessageVector deltaMessages;
+	EntityInterest fullInterest;
+	EntityInterest deltaInterest;
+	std::vector<Uint8> message;
+	Int32 baseline = -1;
+
+	for( Int32 tick = 0; tick < tickCount; tick++ )
+	{
+		// A quarter of the entities move, a few are hurt or change state.
+		for( Int32 i = 0; i < entityCount; i++ )
+		{
+			if( ( i + tick ) % 4 == 0 )
+			{
+				Vector3f32 position = entities[ i ]->Position.Get( );
+				position.x += 0.25f;
+				position.z = static_cast<Float32>( i % 10 );
+				entities[ i ]->Position.Set( position );
+			}
+			if( ( i * 7 + tick ) % 50 == 0 )
+			{
+				entities[ i ]->Health.Set( entities[ i ]->Health.Get( ) - 1 );
+			}
+			if( ( i + tick ) % 90 == 0 )
+			{
+				entities[ i ]->State.Set( static_cast<Uint8>( ( i + tick ) % 3 ) );
+			}
+		}
+
+		const Uint16 snapshotId = entityManager.CreateWorldSnapshot( );
+
+		message.clear( );
+		fullInterest.Clear( );
+		if( entityManager.CreateSnapshotMessage( -1, EntityInterest::View( ), fullInterest, message ) )
+		{
+			fullMessages.push_back( message );
+		}
+
+		message.clear( );
+		if( entityManager.CreateSnapshotMessage( baseline, EntityInterest::View( ), deltaInterest, message ) )
+		{
+			deltaMessages.push_back( message );
+		}
+		baseline = tick >= 2 ? static_cast<Uint16>( snapshotId - 2 ) : -1;
+	}
+
+	std::printf( "Entities: %i, recorded snapshot messages: %u full, %u delta\n", entityCount,
+				 static_cast<Uint32>( fullMessages.size( ) ), static_cast<Uint32>( deltaMessages.size( ) ) );
+
+	const MessageVector * recordings[ 2 ] = { &fullMessages, &deltaMessages };
+	const char * names[ 2 ][ 2 ] = { { "Full", "Full, dictionary" }, { "Delta", "Delta, dictionary" } };
+	for( SizeType i = 0; i < 2; i++ )
+	{
+		const MessageVector & recording = *recordings[ i ];
+		const MessageVector::const_iterator split = recording.begin( ) + recording.size( ) / 3;
+		const MessageVector training( recording.begin( ), split );
+		const MessageVector test( split, recording.end( ) );
+
+		CompressionDictionary dictionary;
+		dictionary.Train( training );
+		RunCompression( names[ i ][ 0 ], test, NULL, repeatCount );
+		RunCompression( names[ i ][ 1 ], test, &dictionary, repeatCount );
+	}
+
+	return 0;
+}
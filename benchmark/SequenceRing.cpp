@@ -0,0 +1,152 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////
+// Sequence ring benchmark.
+//
+// Tracks reliable packets in flight by the sequence ring with its
+// resend timer wheel, and by a std::map scanned every tick, as the
+// connections did before. Reports the send and acknowledgement time
+// per packet, and the resend scan time per tick with the packets in flight.
+//
+// Usage: SequenceRing [packets in flight = 10000] [rounds = 100]
+//
+////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Private/SequenceRing.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Benchmark.hpp>
+#include <cstdio>
+#include <map>
+
+using namespace Bit;
+using namespace Bit::Net;
+
+struct ReliablePacket
+{
+	Uint64	SendTime;
+	Uint32	ResendCount;
+};
+
+int main( int p_ArgumentCount, char ** p_ppArguments )
+{
+	const Int32 packetCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 1, 10000 );
+	const Int32 roundCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 2, 100 );
+
+	if( packetCount < 1 || packetCount > 65535 )
+	{
+		std::printf( "The packet count must be 1 to 65535.\n" );
+		return 1;
+	}
+
+	// The deadlines are far away, no packet is resent.
+	const Time deadline = Seconds( 1000.0f );
+	SequenceRing<ReliablePacket> * pRing = new SequenceRing<ReliablePacket>;
+	std::map<Uint16, ReliablePacket *> packetMap;
+	Uint16 sequence = 0;
+	volatile Uint32 resends = 0;
+
+	// Send and acknowledge.
+	Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+	for( Int32 round = 0; round < roundCount; round++ )
+	{
+		for( Int32 i = 0; i < packetCount; i++ )
+		{
+			pRing->Add( static_cast<Uint16>( sequence + i ), deadline )->ResendCount = 0;
+		}
+		for( Int32 i = 0; i < packetCount; i++ )
+		{
+			pRing->Remove( static_cast<Uint16>( sequence + i ) );
+		}
+		sequence = static_cast<Uint16>( sequence + packetCount );
+	}
+	const Uint64 ringSendTime = Timer::GetSystemTimeNanoseconds( ) - startTime;
+
+	startTime = Timer::GetSystemTimeNanoseconds( );
+	for( Int32 round = 0; round < roundCount; round++ )
+	{
+		for( Int32 i = 0; i < packetCount; i++ )
+		{
+			ReliablePacket * pPacket = new ReliablePacket;
+			pPacket->ResendCount = 0;
+			packetMap[ static_cast<Uint16>( sequence + i ) ] = pPacket;
+		}
+		for( Int32 i = 0; i < packetCount; i++ )
+		{
+			std::map<Uint16, ReliablePacket *>::iterator it = packetMap.find( static_cast<Uint16>( sequence + i ) );
+			delete it->second;
+			packetMap.erase( it );
+		}
+		sequence = static_cast<Uint16>( sequence + packetCount );
+	}
+	const Uint64 mapSendTime = Timer::GetSystemTimeNanoseconds( ) - startTime;
+
+	// Resend scans, one tick per millisecond.
+	for( Int32 i = 0; i < packetCount; i++ )
+	{
+		pRing->Add( static_cast<Uint16>( i ), deadline )->ResendCount = 0;
+		ReliablePacket * pPacket = new ReliablePacket;
+		pPacket->ResendCount = 0;
+		packetMap[ static_cast<Uint16>( i ) ] = pPacket;
+	}
+
+	const Int32 tickCount = 1000;
+	startTime = Timer::GetSystemTimeNanoseconds( );
+	for( Int32 tick = 0; tick < tickCount; tick++ )
+	{
+		pRing->Expire( Milliseconds( tick ), [ & ]( ReliablePacket & p_Packet ) -> Time
+		{
+			p_Packet.ResendCount++;
+			resends++;
+			return deadline;
+		} );
+	}
+	const Uint64 ringScanTime = Timer::GetSystemTimeNanoseconds( ) - startTime;
+
+	startTime = Timer::GetSystemTimeNanoseconds( );
+	for( Int32 tick = 0; tick < tickCount; tick++ )
+	{
+		for( std::map<Uint16, ReliablePacket *>::iterator it = packetMap.begin( ); it != packetMap.end( ); it++ )
+		{
+			if( it->second->ResendCount > 5 )
+			{
+				resends++;
+			}
+		}
+	}
+	const Uint64 mapScanTime = Timer::GetSystemTimeNanoseconds( ) - startTime;
+
+	for( std::map<Uint16, ReliablePacket *>::iterator it = packetMap.begin( ); it != packetMap.end( ); it++ )
+	{
+		delete it->second;
+	}
+	delete pRing;
+
+	const Float64 operations = static_cast<Float64>( packetCount ) * static_cast<Float64>( roundCount );
+	std::printf( "Packets in flight: %i\n", packetCount );
+	std::printf( "Send + ack:  ring %.1f ns/packet, map %.1f ns/packet\n",
+				 static_cast<Float64>( ringSendTime ) / operations, static_cast<Float64>( mapSendTime ) / operations );
+	std::printf( "Resend scan: ring %.2f us/tick, map %.2f us/tick\n",
+				 static_cast<Float64>( ringScanTime ) / 1000.0 / tickCount, static_cast<Float64>( mapScanTime ) / 1000.0 / tickCount );
+	return 0;
+}
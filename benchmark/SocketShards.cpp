@@ -0,0 +1,196 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////
+// Socket shard benchmark.
+//
+// Floods a server from a number of loopback clients, every client
+// sends small unreliable user messages as fast as possible. The
+// clients run in a child process. Reports the user messages per
+// second received by the server, by the number of sockets sharing
+// the server port. Run it on a multi-core machine with 1, 2, 4, ...
+// shards to see the scaling.
+//
+// Usage: SocketShards [shards = 4] [clients = 32] [seconds = 3]
+//
+////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Server.hpp>
+#include <Bit/Network/Net/Client.hpp>
+#include <Bit/Network/Net/UserMessageDecoder.hpp>
+#include <Bit/System/Sleep.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Benchmark.hpp>
+#include <atomic>
+#include <cstdio>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace Bit;
+using namespace Bit::Net;
+
+static const Uint16 g_Port = 12389;
+
+class BenchmarkServer : public Server
+{
+
+public:
+
+	using Server::HookUserMessage;
+	using Server::Start;
+	using Server::Stop;
+	using Server::GetConnectionCount;
+
+};
+
+class BenchmarkClient : public Client
+{
+
+public:
+
+	BenchmarkClient( ) :
+		Client( 0 )
+	{
+	}
+
+	using Client::Connect;
+	using Client::CreateUserMessage;
+
+};
+
+class CountingListener : public UserMessageListener
+{
+
+public:
+
+	CountingListener( ) :
+		Count( 0 )
+	{
+	}
+
+	virtual void HandleMessage( UserMessageDecoder & p_Message )
+	{
+		p_Message.ReadInt( );
+		Count++;
+	}
+
+	std::atomic<Uint32> Count;
+
+};
+
+// Run the clients in a child process, flooding the server after connecting all of them.
+static int RunClients( const Int32 p_ClientCount, const Int32 p_Seconds )
+{
+	std::vector<BenchmarkClient *> clients;
+	Sleep( Milliseconds( 200 ) );
+
+	for( Int32 i = 0; i < p_ClientCount; i++ )
+	{
+		BenchmarkClient * pClient = new BenchmarkClient;
+		if( pClient->Connect( Address( 127, 0, 0, 1 ), g_Port, Seconds( 5.0f ) ) != Client::Succeeded )
+		{
+			std::printf( "Failed to connect client %i.\n", i );
+			delete pClient;
+			break;
+		}
+		clients.push_back( pClient );
+	}
+	Sleep( Milliseconds( 500 ) );
+
+	Uint64 sent = 0;
+	const Uint64 endTime = Timer::GetSystemTimeNanoseconds( ) + static_cast<Uint64>( p_Seconds ) * 1000000000ULL;
+	while( Timer::GetSystemTimeNanoseconds( ) < endTime )
+	{
+		for( SizeType i = 0; i < clients.size( ); i++ )
+		{
+			UserMessage * pMessage = clients[ i ]->CreateUserMessage( "flood", 4 );
+			pMessage->WriteInt( static_cast<Int32>( sent ) );
+			pMessage->Send( false );
+			delete pMessage;
+			sent++;
+		}
+	}
+	std::printf( "Clients sent: %llu messages\n", static_cast<unsigned long long>( sent ) );
+	std::fflush( stdout );
+
+	for( SizeType i = 0; i < clients.size( ); i++ )
+	{
+		delete clients[ i ];
+	}
+
+	return 0;
+}
+
+int main( int p_ArgumentCount, char ** p_ppArguments )
+{
+	const Int32 shardCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 1, 4 );
+	const Int32 clientCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 2, 32 );
+	const Int32 seconds = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 3, 3 );
+
+	if( shardCount < 1 || clientCount < 1 || clientCount > 255 || seconds < 1 )
+	{
+		std::printf( "Invalid arguments.\n" );
+		return 1;
+	}
+
+	const pid_t clientProcess = fork( );
+	if( clientProcess == 0 )
+	{
+		_exit( RunClients( clientCount, seconds ) );
+	}
+
+	BenchmarkServer server;
+	CountingListener listener;
+	server.HookUserMessage( &listener, "flood" );
+	if( server.Start( Server::Properties( g_Port, static_cast<Uint8>( clientCount ), Seconds( 5.0f ), 22, 30,
+										  "Bit Engine Network", false, 0, false, 0, static_cast<Uint32>( shardCount ) ) ) == false )
+	{
+		std::printf( "Failed to start the server.\n" );
+		kill( clientProcess, SIGKILL );
+		return 1;
+	}
+
+	// Measure from the first flooded message until the flood ends.
+	const Uint64 connectTime = Timer::GetSystemTimeNanoseconds( );
+	while( listener.Count == 0 && Timer::GetSystemTimeNanoseconds( ) - connectTime < 30000000000ULL )
+	{
+		Sleep( Milliseconds( 1 ) );
+	}
+	const SizeType connectionCount = server.GetConnectionCount( );
+	const Uint32 startCount = listener.Count;
+	const Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+	const Float64 processTime = Benchmark::GetProcessTime( );
+
+	waitpid( clientProcess, NULL, 0 );
+	const Uint32 count = listener.Count - startCount;
+	const Float64 wallTime = static_cast<Float64>( Timer::GetSystemTimeNanoseconds( ) - startTime ) / 1000000000.0;
+	const Float64 usedTime = Benchmark::GetProcessTime( ) - processTime;
+
+	std::printf( "Shards: %i, connections: %u\n", shardCount, static_cast<Uint32>( connectionCount ) );
+	std::printf( "Server received: %u messages in %.3f s, %.0f messages/s, cpu: %.1f%%\n",
+				 count, wallTime, static_cast<Float64>( count ) / wallTime, 100.0 * usedTime / wallTime );
+
+	server.Stop( );
+	return 0;
+}
@@ -0,0 +1,263 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////
+// Synchronization benchmark.
+//
+// Compares the futex based mutex, semaphore and thread event with
+// pthread_mutex_t and sem_t. Reports the time of an uncontended
+// lock and unlock, of a lock and unlock contended by a number of
+// threads, of an uncontended release and wait, and of a wake round
+// trip between two threads.
+//
+// Usage: Synchronization [threads = 4] [operations = 1000000]
+//
+////////////////////////////////////////////////////////////////
+
+#include <Bit/System/Mutex.hpp>
+#include <Bit/System/Semaphore.hpp>
+#include <Bit/System/ThreadEvent.hpp>
+#include <Bit/System/Thread.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Benchmark.hpp>
+#include <cstdio>
+#include <vector>
+#include <pthread.h>
+#include <semaphore.h>
+
+using namespace Bit;
+
+// pthread mutex of the Mutex interface.
+class PthreadMutex
+{
+
+public:
+
+	PthreadMutex( )
+	{
+		pthread_mutex_init( &m_Mutex, NULL );
+	}
+
+	~PthreadMutex( )
+	{
+		pthread_mutex_destroy( &m_Mutex );
+	}
+
+	void Lock( )
+	{
+		pthread_mutex_lock( &m_Mutex );
+	}
+
+	void Unlock( )
+	{
+		pthread_mutex_unlock( &m_Mutex );
+	}
+
+private:
+
+	pthread_mutex_t m_Mutex;
+
+};
+
+// POSIX semaphore of the Semaphore interface.
+class PosixSemaphore
+{
+
+public:
+
+	PosixSemaphore( )
+	{
+		sem_init( &m_Semaphore, 0, 0 );
+	}
+
+	~PosixSemaphore( )
+	{
+		sem_destroy( &m_Semaphore );
+	}
+
+	void Wait( )
+	{
+		while( sem_wait( &m_Semaphore ) != 0 )
+		{
+		}
+	}
+
+	void Release( )
+	{
+		sem_post( &m_Semaphore );
+	}
+
+private:
+
+	sem_t m_Semaphore;
+
+};
+
+// Auto reset thread event of the Semaphore interface.
+class EventSemaphore
+{
+
+public:
+
+	void Wait( )
+	{
+		m_Event.Wait( );
+	}
+
+	void Release( )
+	{
+		m_Event.Set( );
+	}
+
+private:
+
+	ThreadEvent m_Event;
+
+};
+
+// Return the nanoseconds per operation since the start time.
+static Float64 GetOperationTime( const Uint64 p_StartTime, const Float64 p_OperationCount )
+{
+	return static_cast<Float64>( Timer::GetSystemTimeNanoseconds( ) - p_StartTime ) / p_OperationCount;
+}
+
+template<typename MutexType>
+static Float64 RunUncontended( const Int32 p_OperationCount )
+{
+	MutexType mutex;
+	const Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+	for( Int32 i = 0; i < p_OperationCount; i++ )
+	{
+		mutex.Lock( );
+		mutex.Unlock( );
+	}
+
+	return GetOperationTime( startTime, p_OperationCount );
+}
+
+// Every thread increments a shared counter, the counter is checked.
+template<typename MutexType>
+static Float64 RunContended( const Int32 p_ThreadCount, const Int32 p_OperationCount, Bool & p_Correct )
+{
+	MutexType mutex;
+	Int64 counter = 0;
+	const Int32 operationsPerThread = p_OperationCount / p_ThreadCount;
+
+	const Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+	std::vector<Thread *> threads;
+	for( Int32 i = 0; i < p_ThreadCount; i++ )
+	{
+		threads.push_back( new Thread( [ &mutex, &counter, operationsPerThread ]( )
+		{
+			for( Int32 j = 0; j < operationsPerThread; j++ )
+			{
+				mutex.Lock( );
+				counter++;
+				mutex.Unlock( );
+			}
+		} ) );
+	}
+	for( SizeType i = 0; i < threads.size( ); i++ )
+	{
+		threads[ i ]->Finish( );
+		delete threads[ i ];
+	}
+
+	p_Correct = counter == static_cast<Int64>( operationsPerThread ) * p_ThreadCount;
+	return GetOperationTime( startTime, static_cast<Float64>( operationsPerThread ) * p_ThreadCount );
+}
+
+template<typename SemaphoreType>
+static Float64 RunReleaseWait( const Int32 p_OperationCount )
+{
+	SemaphoreType semaphore;
+	const Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+	for( Int32 i = 0; i < p_OperationCount; i++ )
+	{
+		semaphore.Release( );
+		semaphore.Wait( );
+	}
+
+	return GetOperationTime( startTime, p_OperationCount );
+}
+
+// Two threads waking each other.
+template<typename SemaphoreType>
+static Float64 RunRoundTrip( const Int32 p_RoundTripCount )
+{
+	SemaphoreType ping;
+	SemaphoreType pong;
+
+	const Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+	Thread thread( [ &ping, &pong, p_RoundTripCount ]( )
+	{
+		for( Int32 i = 0; i < p_RoundTripCount; i++ )
+		{
+			ping.Wait( );
+			pong.Release( );
+		}
+	} );
+	for( Int32 i = 0; i < p_RoundTripCount; i++ )
+	{
+		ping.Release( );
+		pong.Wait( );
+	}
+	thread.Finish( );
+
+	return GetOperationTime( startTime, p_RoundTripCount );
+}
+
+int main( int p_ArgumentCount, char ** p_ppArguments )
+{
+	const Int32 threadCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 1, 4 );
+	const Int32 operationCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 2, 1000000 );
+
+	if( threadCount < 1 || operationCount < threadCount )
+	{
+		std::printf( "Invalid arguments.\n" );
+		return 1;
+	}
+
+	// Start a thread first, single threaded processes may skip the atomic operations of pthread.
+	Thread warmup( [ ]( ) { } );
+	warmup.Finish( );
+
+	std::printf( "Uncontended lock and unlock: Mutex: %.1f ns, pthread_mutex_t: %.1f ns\n",
+				 RunUncontended<Mutex>( operationCount ), RunUncontended<PthreadMutex>( operationCount ) );
+
+	Bool mutexCorrect = false;
+	Bool pthreadCorrect = false;
+	const Float64 mutexTime = RunContended<Mutex>( threadCount, operationCount, mutexCorrect );
+	const Float64 pthreadTime = RunContended<PthreadMutex>( threadCount, operationCount, pthreadCorrect );
+	std::printf( "Contended lock and unlock by %i threads: Mutex: %.1f ns%s, pthread_mutex_t: %.1f ns%s\n", threadCount,
+				 mutexTime, mutexCorrect ? "" : " (wrong count)", pthreadTime, pthreadCorrect ? "" : " (wrong count)" );
+
+	std::printf( "Uncontended release and wait: Semaphore: %.1f ns, sem_t: %.1f ns\n",
+				 RunReleaseWait<Semaphore>( operationCount ), RunReleaseWait<PosixSemaphore>( operationCount ) );
+
+	const Int32 roundTripCount = operationCount / 10;
+	std::printf( "Wake round trip: Semaphore: %.0f ns, ThreadEvent: %.0f ns, sem_t: %.0f ns\n",
+				 RunRoundTrip<Semaphore>( roundTripCount ), RunRoundTrip<EventSemaphore>( roundTripCount ),
+				 RunRoundTrip<PosixSemaphore>( roundTripCount ) );
+	return 0;
+}
@@ -0,0 +1,160 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////
+// Timestep jitter benchmark.
+//
+// Runs a tick of 0.3 milliseconds of work at 20, 60 and 128 Hz by
+// Timestep, and by sleeping for the remainder of every tick.
+// Reports the mean tick interval, the deviation from the period,
+// the drift over all the ticks and a histogram of the deviations.
+// Then reports the time to read the monotonic and the TSC clock.
+//
+// Usage: TimestepJitter [seconds per rate = 3] [work microseconds = 300]
+//
+////////////////////////////////////////////////////////////////
+
+#include <Bit/System/Timestep.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Bit/System/Sleep.hpp>
+#include <Benchmark.hpp>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace Bit;
+
+static const Int32 g_BucketCount = 7;
+static const Float64 g_BucketLimits[ g_BucketCount - 1 ] = { 10.0, 50.0, 100.0, 250.0, 500.0, 1000.0 };
+
+// Busy wait, simulating the work of a tick.
+static void Work( const Uint64 p_Time )
+{
+	const Uint64 endTime = Timer::GetSystemTimeNanoseconds( ) + p_Time;
+	while( Timer::GetSystemTimeNanoseconds( ) < endTime )
+	{
+	}
+}
+
+// Print the tick interval statistics of the tick times.
+static void PrintIntervals( const char * p_pName, const Int32 p_Rate, const std::vector<Uint64> & p_TickTimes )
+{
+	const Float64 period = 1000000000.0 / p_Rate;
+	const SizeType intervalCount = p_TickTimes.size( ) - 1;
+	Int32 buckets[ g_BucketCount ] = { 0 };
+	Float64 squareSum = 0.0;
+	Float64 maxDeviation = 0.0;
+
+	for( SizeType i = 1; i < p_TickTimes.size( ); i++ )
+	{
+		const Float64 deviation = std::fabs( static_cast<Float64>( p_TickTimes[ i ] - p_TickTimes[ i - 1 ] ) - period ) / 1000.0;
+		squareSum += deviation * deviation;
+		maxDeviation = deviation > maxDeviation ? deviation : maxDeviation;
+
+		Int32 bucket = 0;
+		while( bucket < g_BucketCount - 1 && deviation >= g_BucketLimits[ bucket ] )
+		{
+			bucket++;
+		}
+		buckets[ bucket ]++;
+	}
+
+	const Float64 totalTime = static_cast<Float64>( p_TickTimes.back( ) - p_TickTimes.front( ) );
+	std::printf( "%-8s %3i Hz: mean: %.3f ms, rms deviation: %6.1f us, max: %6.1f us, drift: %+9.1f us over %u ticks\n",
+				 p_pName, p_Rate, totalTime / intervalCount / 1000000.0, std::sqrt( squareSum / intervalCount ), maxDeviation,
+				 ( totalTime - period * intervalCount ) / 1000.0, static_cast<Uint32>( intervalCount ) );
+	std::printf( "                deviation <10 us: %i, <50 us: %i, <100 us: %i, <250 us: %i, <500 us: %i, <1 ms: %i, >=1 ms: %i\n",
+				 buckets[ 0 ], buckets[ 1 ], buckets[ 2 ], buckets[ 3 ], buckets[ 4 ], buckets[ 5 ], buckets[ 6 ] );
+}
+
+int main( int p_ArgumentCount, char ** p_ppArguments )
+{
+	const Int32 seconds = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 1, 3 );
+	const Int32 workTime = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 2, 300 );
+	const Int32 rates[ 3 ] = { 20, 60, 128 };
+
+	if( seconds < 1 || workTime < 0 || workTime >= 1000000 / rates[ 2 ] )
+	{
+		std::printf( "Invalid arguments.\n" );
+		return 1;
+	}
+
+	const Uint64 work = static_cast<Uint64>( workTime ) * 1000ULL;
+	for( SizeType i = 0; i < 3; i++ )
+	{
+		const Int32 rate = rates[ i ];
+		const Int32 tickCount = seconds * rate;
+		const Uint64 period = 1000000000ULL / rate;
+		std::vector<Uint64> tickTimes;
+		tickTimes.reserve( tickCount + 1 );
+
+		// Sleep for the remainder of every tick.
+		for( Int32 j = 0; j <= tickCount; j++ )
+		{
+			const Uint64 tickTime = Timer::GetSystemTimeNanoseconds( );
+			tickTimes.push_back( tickTime );
+			Work( work );
+			const Uint64 usedTime = Timer::GetSystemTimeNanoseconds( ) - tickTime;
+			if( usedTime < period )
+			{
+				Sleep( Microseconds( ( period - usedTime ) / 1000ULL ) );
+			}
+		}
+		PrintIntervals( "Sleep", rate, tickTimes );
+
+		tickTimes.clear( );
+		Timestep timestep;
+		const Time updateTime = Microseconds( period / 1000ULL );
+		for( Int32 j = 0; j <= tickCount; j++ )
+		{
+			timestep.Execute( updateTime, [ &tickTimes, work ]( )
+			{
+				tickTimes.push_back( Timer::GetSystemTimeNanoseconds( ) );
+				Work( work );
+			} );
+		}
+		PrintIntervals( "Timestep", rate, tickTimes );
+	}
+
+	// Clock reads.
+	const Int32 readCount = 2000000;
+	Uint64 sum = 0;
+	Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+	for( Int32 i = 0; i < readCount; i++ )
+	{
+		sum += Timer::GetSystemTimeNanoseconds( );
+	}
+	const Uint64 monotonicTime = Timer::GetSystemTimeNanoseconds( ) - startTime;
+
+	startTime = Timer::GetSystemTimeNanoseconds( );
+	for( Int32 i = 0; i < readCount; i++ )
+	{
+		sum += Timer::GetTscTime( );
+	}
+	const Uint64 tscTime = Timer::GetSystemTimeNanoseconds( ) - startTime;
+
+	std::printf( "Clock read: monotonic: %.1f ns, TSC: %.1f ns, TSC available: %s (%llu)\n",
+				 static_cast<Float64>( monotonicTime ) / readCount, static_cast<Float64>( tscTime ) / readCount,
+				 Timer::IsTscAvailable( ) ? "yes" : "no", static_cast<unsigned long long>( sum & 1 ) );
+	return 0;
+}
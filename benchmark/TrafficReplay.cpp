@@ -0,0 +1,319 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////
+// Traffic replay benchmark.
+//
+// Records the traffic of a loopback server and client exchanging
+// ordered user and host messages, then replays the server log into
+// new servers and the client log into new clients, without any
+// network. Reports the handled messages, the messages out of order
+// and the replay time of every replay, the same for every replay of
+// a deterministic replay.
+//
+// Usage: TrafficReplay [messages = 500] [speed = 0] [replays = 3]
+//        A speed of 0 replays the datagrams as fast as they are received.
+//
+////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Server.hpp>
+#include <Bit/Network/Net/Client.hpp>
+#include <Bit/Network/Net/TrafficRecorder.hpp>
+#include <Bit/Network/Net/TrafficReplay.hpp>
+#include <Bit/Network/Net/HostRecipientFilter.hpp>
+#include <Bit/Network/Net/HostMessageDecoder.hpp>
+#include <Bit/Network/Net/UserMessageDecoder.hpp>
+#include <Bit/System/Sleep.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Benchmark.hpp>
+#include <atomic>
+#include <cstdio>
+
+using namespace Bit;
+using namespace Bit::Net;
+
+static const Uint16 g_Port = 12391;
+static const std::string g_ServerLog = "TrafficReplayServer.log";
+static const std::string g_ClientLog = "TrafficReplayClient.log";
+
+class BenchmarkServer : public Server
+{
+
+public:
+
+	using Server::HookUserMessage;
+	using Server::CreateHostMessage;
+	using Server::CreateRecipientFilter;
+	using Server::Start;
+
+};
+
+class BenchmarkClient : public Client
+{
+
+public:
+
+	BenchmarkClient( ) :
+		Client( 0 )
+	{
+	}
+
+	using Client::Connect;
+	using Client::HookHostMessage;
+	using Client::CreateUserMessage;
+	using Client::SetSocketFactory;
+
+};
+
+// Count the messages, checking the order of the indices.
+template<typename Decoder>
+static void CountMessage( Decoder & p_Message, std::atomic<Int32> & p_Count, std::atomic<Int32> & p_Errors, Int32 & p_LastIndex )
+{
+	const Int32 index = p_Message.ReadInt( );
+	if( index != p_LastIndex + 1 )
+	{
+		p_Errors++;
+	}
+	p_LastIndex = index;
+	p_Count++;
+}
+
+class HostListener : public HostMessageListener
+{
+
+public:
+
+	HostListener( ) :
+		Count( 0 ),
+		Errors( 0 ),
+		m_LastIndex( -1 )
+	{
+	}
+
+	virtual void HandleMessage( HostMessageDecoder & p_Message )
+	{
+		CountMessage( p_Message, Count, Errors, m_LastIndex );
+	}
+
+	std::atomic<Int32> Count;
+	std::atomic<Int32> Errors;
+
+private:
+
+	Int32 m_LastIndex;
+
+};
+
+class UserListener : public UserMessageListener
+{
+
+public:
+
+	UserListener( ) :
+		Count( 0 ),
+		Errors( 0 ),
+		m_LastIndex( -1 )
+	{
+	}
+
+	virtual void HandleMessage( UserMessageDecoder & p_Message )
+	{
+		CountMessage( p_Message, Count, Errors, m_LastIndex );
+	}
+
+	std::atomic<Int32> Count;
+	std::atomic<Int32> Errors;
+
+private:
+
+	Int32 m_LastIndex;
+
+};
+
+// Wait for the messages, return the seconds since the start time.
+static Float64 WaitForMessages( std::atomic<Int32> & p_Count, const Int32 p_Expected, const Uint64 p_StartTime )
+{
+	while( p_Count < p_Expected && Timer::GetSystemTimeNanoseconds( ) - p_StartTime < 30000000000ULL )
+	{
+		Sleep( Milliseconds( 1 ) );
+	}
+
+	return static_cast<Float64>( Timer::GetSystemTimeNanoseconds( ) - p_StartTime ) / 1000000000.0;
+}
+
+// Record the traffic of a server and a client.
+static Bool Record( const Int32 p_MessageCount )
+{
+	TrafficRecorder serverRecorder;
+	TrafficRecorder clientRecorder;
+	if( serverRecorder.Open( g_ServerLog ) == false || clientRecorder.Open( g_ClientLog ) == false )
+	{
+		std::printf( "Failed to open the traffic logs.\n" );
+		return false;
+	}
+
+	BenchmarkServer server;
+	UserListener userListener;
+	server.HookUserMessage( &userListener, "message" );
+	if( server.Start( Server::Properties( g_Port, 8, Seconds( 5.0f ), 22, 30, "Bit Engine Network",
+										  false, 0, false, 0, 1, 0, &serverRecorder ) ) == false )
+	{
+		std::printf( "Failed to start the server.\n" );
+		return false;
+	}
+
+	BenchmarkClient client;
+	HostListener hostListener;
+	client.HookHostMessage( &hostListener, "message" );
+	client.SetSocketFactory( &clientRecorder );
+	if( client.Connect( Address( 127, 0, 0, 1 ), g_Port, Seconds( 5.0f ) ) != Client::Succeeded )
+	{
+		std::printf( "Failed to connect.\n" );
+		return false;
+	}
+
+	const Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+	for( Int32 i = 0; i < p_MessageCount; i++ )
+	{
+		UserMessage * pUserMessage = client.CreateUserMessage( "message", 4 );
+		pUserMessage->WriteInt( i );
+		pUserMessage->SendOnChannel( 0 );
+		delete pUserMessage;
+
+		HostMessage * pHostMessage = server.CreateHostMessage( "message", 4 );
+		pHostMessage->WriteInt( i );
+		HostRecipientFilter * pFilter = server.CreateRecipientFilter( );
+		pFilter->AddAllUsers( );
+		pFilter->SetChannel( 0 );
+		pHostMessage->Send( pFilter );
+		delete pFilter;
+		delete pHostMessage;
+
+		if( i % 20 == 19 )
+		{
+			Sleep( Milliseconds( 5 ) );
+		}
+	}
+	WaitForMessages( userListener.Count, p_MessageCount, startTime );
+	const Float64 recordTime = WaitForMessages( hostListener.Count, p_MessageCount, startTime );
+
+	// Record the acknowledgements of the last messages.
+	Sleep( Milliseconds( 500 ) );
+	serverRecorder.Close( );
+	clientRecorder.Close( );
+
+	std::printf( "Record: user messages: %i, host messages: %i, errors: %i, %.3f s, server datagrams: %llu, client datagrams: %llu\n",
+				 static_cast<Int32>( userListener.Count ), static_cast<Int32>( hostListener.Count ),
+				 static_cast<Int32>( userListener.Errors + hostListener.Errors ), recordTime,
+				 static_cast<unsigned long long>( serverRecorder.GetRecordCount( ) ),
+				 static_cast<unsigned long long>( clientRecorder.GetRecordCount( ) ) );
+	return true;
+}
+
+// Replay the server log into a new server.
+static void ReplayServer( const Int32 p_MessageCount, const Float32 p_Speed )
+{
+	TrafficReplay replay;
+	if( replay.Load( g_ServerLog ) == false )
+	{
+		std::printf( "Failed to load the server log.\n" );
+		return;
+	}
+	replay.SetSpeed( p_Speed );
+
+	BenchmarkServer server;
+	UserListener userListener;
+	server.HookUserMessage( &userListener, "message" );
+
+	const Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+	if( server.Start( Server::Properties( g_Port, 8, Seconds( 5.0f ), 22, 30, "Bit Engine Network",
+										  false, 0, false, 0, 1, 0, &replay ) ) == false )
+	{
+		std::printf( "Failed to start the server.\n" );
+		return;
+	}
+	const Float64 replayTime = WaitForMessages( userListener.Count, p_MessageCount, startTime );
+
+	std::printf( "Server replay: user messages: %i, errors: %i, %.3f s, replayed datagrams: %llu/%u, sent: %llu\n",
+				 static_cast<Int32>( userListener.Count ), static_cast<Int32>( userListener.Errors ), replayTime,
+				 static_cast<unsigned long long>( replay.GetReplayedCount( ) ), static_cast<Uint32>( replay.GetRecordCount( ) ),
+				 static_cast<unsigned long long>( replay.GetSentCount( ) ) );
+}
+
+// Replay the client log into a new client.
+static void ReplayClient( const Int32 p_MessageCount, const Float32 p_Speed )
+{
+	TrafficReplay replay;
+	Address address;
+	Uint16 port = 0;
+	if( replay.Load( g_ClientLog ) == false || replay.GetRemoteEndpoint( address, port ) == false )
+	{
+		std::printf( "Failed to load the client log.\n" );
+		return;
+	}
+	replay.SetSpeed( p_Speed );
+
+	BenchmarkClient client;
+	HostListener hostListener;
+	client.HookHostMessage( &hostListener, "message" );
+	client.SetSocketFactory( &replay );
+
+	const Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+	if( client.Connect( address, port, Seconds( 5.0f ) ) != Client::Succeeded )
+	{
+		std::printf( "Failed to connect the replayed client.\n" );
+		return;
+	}
+	const Float64 replayTime = WaitForMessages( hostListener.Count, p_MessageCount, startTime );
+
+	std::printf( "Client replay: host messages: %i, errors: %i, %.3f s, replayed datagrams: %llu/%u, sent: %llu\n",
+				 static_cast<Int32>( hostListener.Count ), static_cast<Int32>( hostListener.Errors ), replayTime,
+				 static_cast<unsigned long long>( replay.GetReplayedCount( ) ), static_cast<Uint32>( replay.GetRecordCount( ) ),
+				 static_cast<unsigned long long>( replay.GetSentCount( ) ) );
+}
+
+int main( int p_ArgumentCount, char ** p_ppArguments )
+{
+	const Int32 messageCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 1, 500 );
+	const Int32 speed = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 2, 0 );
+	const Int32 replayCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 3, 3 );
+
+	if( messageCount < 1 || speed < 0 || replayCount < 1 )
+	{
+		std::printf( "Invalid arguments.\n" );
+		return 1;
+	}
+
+	if( Record( messageCount ) == false )
+	{
+		return 1;
+	}
+
+	for( Int32 i = 0; i < replayCount; i++ )
+	{
+		ReplayServer( messageCount, static_cast<Float32>( speed ) );
+		ReplayClient( messageCount, static_cast<Float32>( speed ) );
+	}
+
+	return 0;
+}
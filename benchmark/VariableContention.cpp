@@ -0,0 +1,138 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////
+// Variable contention benchmark.
+//
+// A game thread sets and gets the position of every entity, while a
+// network thread takes world snapshots and reads the positions.
+// Reports the time per Set and Get on the game thread, the number of
+// world snapshots and the reads seeing a partly written value.
+//
+// Usage: VariableContention [entities = 4096] [frames = 500]
+//
+////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Server.hpp>
+#include <Bit/Network/Net/Variable.hpp>
+#include <Bit/System/Thread.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Benchmark.hpp>
+#include <atomic>
+#include <cstdio>
+#include <vector>
+
+using namespace Bit;
+using namespace Bit::Net;
+
+class BenchmarkEntity : public Entity
+{
+
+public:
+
+	Variable<Vector3f32>	Position;
+	Variable<Int32>			Health;
+
+};
+
+class BenchmarkServer : public Server
+{
+
+public:
+
+	using Server::m_EntityManager;
+
+};
+
+int main( int p_ArgumentCount, char ** p_ppArguments )
+{
+	const Int32 entityCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 1, 4096 );
+	const Int32 frameCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 2, 500 );
+
+	if( entityCount < 1 || entityCount > 60000 || frameCount < 1 )
+	{
+		std::printf( "Invalid arguments.\n" );
+		return 1;
+	}
+
+	static BenchmarkServer server;
+	EntityManager & entityManager = server.m_EntityManager;
+	entityManager.LinkEntity<BenchmarkEntity>( "BenchmarkEntity" );
+	entityManager.RegisterVariable( "BenchmarkEntity", "Position", &BenchmarkEntity::Position );
+	entityManager.RegisterVariable( "BenchmarkEntity", "Health", &BenchmarkEntity::Health );
+
+	std::vector<BenchmarkEntity *> entities;
+	for( Int32 i = 0; i < entityCount; i++ )
+	{
+		entities.push_back( static_cast<BenchmarkEntity *>( entityManager.CreateEntityByName( "BenchmarkEntity" ) ) );
+	}
+	entityManager.CreateWorldSnapshot( );
+
+	// The network thread, the components of a position are always equal.
+	std::atomic<Bool> running( true );
+	std::atomic<Uint32> snapshots( 0 );
+	std::atomic<Uint32> tornReads( 0 );
+	Thread networkThread( [ & ]( )
+	{
+		while( running )
+		{
+			entityManager.CreateWorldSnapshot( );
+			snapshots++;
+
+			for( SizeType i = 0; i < entities.size( ); i += 16 )
+			{
+				const Vector3f32 position = entities[ i ]->Position.Get( );
+				if( position.x != position.y || position.x != position.z )
+				{
+					tornReads++;
+				}
+			}
+		}
+	} );
+
+	const Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+	for( Int32 frame = 0; frame < frameCount; frame++ )
+	{
+		for( Int32 i = 0; i < entityCount; i++ )
+		{
+			const Float32 value = static_cast<Float32>( frame * entityCount + i );
+			entities[ i ]->Position.Set( Vector3f32( value, value, value ) );
+
+			const Vector3f32 position = entities[ i ]->Position.Get( );
+			if( position.x != position.z )
+			{
+				tornReads++;
+			}
+		}
+	}
+	const Uint64 gameTime = Timer::GetSystemTimeNanoseconds( ) - startTime;
+
+	running = false;
+	networkThread.Finish( );
+
+	std::printf( "Entities: %i, frames: %i\n", entityCount, frameCount );
+	std::printf( "Game thread: %.1f ns per Set or Get\n",
+				 static_cast<Float64>( gameTime ) / ( 2.0 * static_cast<Float64>( frameCount ) * entityCount ) );
+	std::printf( "Concurrent world snapshots: %u, torn reads: %u\n", static_cast<Uint32>( snapshots ), static_cast<Uint32>( tornReads ) );
+	return 0;
+}
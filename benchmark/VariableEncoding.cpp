@@ -0,0 +1,168 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////
+// Variable encoding benchmark.
+//
+// Encodes and decodes the variables of a typical entity with random
+// values, raw and with the variable encodings. Reports the bytes per
+// entity, the largest round trip error of each variable and the
+// encoding and decoding time.
+//
+// Usage: VariableEncoding [entities = 100000]
+//
+////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/VariableEncoding.hpp>
+#include <Bit/Network/Net/BitStream.hpp>
+#include <Bit/System/Vector3.hpp>
+#include <Bit/System/Vector4.hpp>
+#include <Bit/System/Randomizer.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Benchmark.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace Bit;
+using namespace Bit::Net;
+
+struct EntityState
+{
+	Vector3f32	Position;
+	Vector4f32	Rotation;
+	Vector3f32	Velocity;
+	Int32		Health;
+	Bool		Alive;
+};
+
+// Get a random float in the range.
+static Float32 RandomFloat( Randomizer & p_Randomizer, const Float32 p_Minimum, const Float32 p_Maximum )
+{
+	return p_Minimum + ( p_Maximum - p_Minimum ) * static_cast<Float32>( p_Randomizer.Randomize( 1000000 ) ) / 1000000.0f;
+}
+
+int main( int p_ArgumentCount, char ** p_ppArguments )
+{
+	const Int32 entityCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 1, 100000 );
+
+	const VariableEncoding positionEncoding = VariableEncoding::Quantize( -4096.0f, 4096.0f, 0.01f );
+	const VariableEncoding rotationEncoding = VariableEncoding::SmallestThree( 10 );
+	const VariableEncoding velocityEncoding = VariableEncoding::Quantize( -64.0f, 64.0f, 0.01f );
+	const VariableEncoding healthEncoding = VariableEncoding::VarInt( true );
+	const VariableEncoding aliveEncoding = VariableEncoding::Boolean( );
+	const VariableEncoding rawEncoding;
+
+	Randomizer randomizer( 1 );
+	std::vector<EntityState> states( entityCount );
+	for( Int32 i = 0; i < entityCount; i++ )
+	{
+		EntityState & state = states[ i ];
+		state.Position = Vector3f32( RandomFloat( randomizer, -4096.0f, 4096.0f ),
+									 RandomFloat( randomizer, -4096.0f, 4096.0f ),
+									 RandomFloat( randomizer, -100.0f, 100.0f ) );
+		state.Rotation = Vector4f32( RandomFloat( randomizer, -1.0f, 1.0f ), RandomFloat( randomizer, -1.0f, 1.0f ),
+									 RandomFloat( randomizer, -1.0f, 1.0f ), RandomFloat( randomizer, -1.0f, 1.0f ) );
+		const Float32 length = std::sqrt( state.Rotation.x * state.Rotation.x + state.Rotation.y * state.Rotation.y +
+										  state.Rotation.z * state.Rotation.z + state.Rotation.w * state.Rotation.w );
+		state.Rotation = Vector4f32( state.Rotation.x / length, state.Rotation.y / length,
+									 state.Rotation.z / length, state.Rotation.w / length );
+		state.Velocity = Vector3f32( RandomFloat( randomizer, -64.0f, 64.0f ), RandomFloat( randomizer, -64.0f, 64.0f ), 0.0f );
+		state.Health = randomizer.Randomize( -10, 100 );
+		state.Alive = state.Health > 0;
+	}
+
+	// Raw bytes, the default encoding.
+	std::vector<Uint8> buffer;
+	buffer.reserve( entityCount * sizeof( EntityState ) );
+	BitWriter rawWriter( buffer );
+	for( Int32 i = 0; i < entityCount; i++ )
+	{
+		rawEncoding.Write( rawWriter, &states[ i ].Position, sizeof( Vector3f32 ) );
+		rawEncoding.Write( rawWriter, &states[ i ].Rotation, sizeof( Vector4f32 ) );
+		rawEncoding.Write( rawWriter, &states[ i ].Velocity, sizeof( Vector3f32 ) );
+		rawEncoding.Write( rawWriter, &states[ i ].Health, sizeof( Int32 ) );
+		rawEncoding.Write( rawWriter, &states[ i ].Alive, sizeof( Bool ) );
+	}
+	const SizeType rawSize = buffer.size( );
+
+	// Encoded.
+	buffer.clear( );
+	const Uint64 encodeTime = Timer::GetSystemTimeNanoseconds( );
+	BitWriter writer( buffer );
+	for( Int32 i = 0; i < entityCount; i++ )
+	{
+		positionEncoding.Write( writer, &states[ i ].Position, sizeof( Vector3f32 ) );
+		rotationEncoding.Write( writer, &states[ i ].Rotation, sizeof( Vector4f32 ) );
+		velocityEncoding.Write( writer, &states[ i ].Velocity, sizeof( Vector3f32 ) );
+		healthEncoding.Write( writer, &states[ i ].Health, sizeof( Int32 ) );
+		aliveEncoding.Write( writer, &states[ i ].Alive, sizeof( Bool ) );
+	}
+	const Uint64 decodeTime = Timer::GetSystemTimeNanoseconds( );
+
+	std::vector<EntityState> decoded( entityCount );
+	BitReader reader( &buffer[ 0 ], buffer.size( ) );
+	Bool succeeded = true;
+	for( Int32 i = 0; i < entityCount; i++ )
+	{
+		succeeded &= positionEncoding.Read( reader, &decoded[ i ].Position, sizeof( Vector3f32 ) );
+		succeeded &= rotationEncoding.Read( reader, &decoded[ i ].Rotation, sizeof( Vector4f32 ) );
+		succeeded &= velocityEncoding.Read( reader, &decoded[ i ].Velocity, sizeof( Vector3f32 ) );
+		succeeded &= healthEncoding.Read( reader, &decoded[ i ].Health, sizeof( Int32 ) );
+		succeeded &= aliveEncoding.Read( reader, &decoded[ i ].Alive, sizeof( Bool ) );
+	}
+	const Uint64 endTime = Timer::GetSystemTimeNanoseconds( );
+
+	// Largest errors, the rotation error is the angle between the quaternions.
+	Float32 positionError = 0.0f;
+	Float32 velocityError = 0.0f;
+	Float32 rotationError = 0.0f;
+	Uint32 integerErrors = 0;
+	for( Int32 i = 0; i < entityCount; i++ )
+	{
+		const EntityState & a = states[ i ];
+		const EntityState & b = decoded[ i ];
+		positionError = std::max( positionError, std::fabs( a.Position.x - b.Position.x ) );
+		positionError = std::max( positionError, std::fabs( a.Position.y - b.Position.y ) );
+		positionError = std::max( positionError, std::fabs( a.Position.z - b.Position.z ) );
+		velocityError = std::max( velocityError, std::fabs( a.Velocity.x - b.Velocity.x ) );
+		velocityError = std::max( velocityError, std::fabs( a.Velocity.y - b.Velocity.y ) );
+
+		const Float32 dot = std::fabs( a.Rotation.x * b.Rotation.x + a.Rotation.y * b.Rotation.y +
+									   a.Rotation.z * b.Rotation.z + a.Rotation.w * b.Rotation.w );
+		rotationError = std::max( rotationError, 2.0f * std::acos( dot > 1.0f ? 1.0f : dot ) );
+
+		integerErrors += ( a.Health != b.Health || a.Alive != b.Alive ) ? 1 : 0;
+	}
+
+	std::printf( "Entities: %i, decoded: %s\n", entityCount, succeeded ? "yes" : "no" );
+	std::printf( "Raw:     %.2f bytes/entity\n", static_cast<Float64>( rawSize ) / entityCount );
+	std::printf( "Encoded: %.2f bytes/entity\n", static_cast<Float64>( buffer.size( ) ) / entityCount );
+	std::printf( "Max error, position: %.4f, velocity: %.4f, rotation: %.4f degrees, integers: %u\n",
+				 positionError, velocityError, rotationError * 57.2957795f, integerErrors );
+	std::printf( "Encode: %.1f ns/entity, decode: %.1f ns/entity\n",
+				 static_cast<Float64>( decodeTime - encodeTime ) / entityCount,
+				 static_cast<Float64>( endTime - decodeTime ) / entityCount );
+	return 0;
+}
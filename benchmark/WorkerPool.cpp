@@ -0,0 +1,215 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////
+// Worker pool benchmark.
+//
+// Connects a number of loopback clients to a server, every client
+// sends a reliable user message every 10 milliseconds. Reports the
+// processor time and thread count of the server process and the
+// latency from sending to handling the user messages.
+//
+// Usage: WorkerPool [clients = 200] [messages = 100] [pool = 1] [workers = 0]
+//
+////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Server.hpp>
+#include <Bit/Network/Net/Client.hpp>
+#include <Bit/Network/Net/UserMessageDecoder.hpp>
+#include <Bit/System/Mutex.hpp>
+#include <Bit/System/Sleep.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Benchmark.hpp>
+#include <atomic>
+#include <cstdio>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace Bit;
+using namespace Bit::Net;
+
+static const Uint16 g_Port = 12380;
+
+class BenchmarkServer : public Server
+{
+
+public:
+
+	using Server::HookUserMessage;
+	using Server::Start;
+	using Server::Stop;
+	using Server::GetConnectionCount;
+
+};
+
+class BenchmarkClient : public Client
+{
+
+public:
+
+	BenchmarkClient( ) :
+		Client( 0 )
+	{
+	}
+
+	using Client::Connect;
+	using Client::CreateUserMessage;
+
+};
+
+class LatencyListener : public UserMessageListener
+{
+
+public:
+
+	LatencyListener( ) :
+		m_Count( 0 )
+	{
+	}
+
+	virtual void HandleMessage( UserMessageDecoder & p_Message )
+	{
+		Uint64 sent = 0;
+		p_Message.ReadArray( &sent, sizeof( sent ) );
+		const Float64 latency = static_cast<Float64>( Timer::GetSystemTimeNanoseconds( ) - sent ) / 1000.0;
+
+		m_Mutex.Lock( );
+		m_Latencies.push_back( latency );
+		m_Mutex.Unlock( );
+		m_Count++;
+	}
+
+	std::atomic<Uint32> m_Count;
+	Mutex m_Mutex;
+	std::vector<Float64> m_Latencies;
+
+};
+
+// Run the clients in a child process, keeping the server measurements clean.
+static int RunClients( const Int32 p_ClientCount, const Int32 p_MessageCount )
+{
+	std::vector<BenchmarkClient *> clients;
+	Sleep( Milliseconds( 200 ) );
+
+	for( Int32 i = 0; i < p_ClientCount; i++ )
+	{
+		BenchmarkClient * pClient = new BenchmarkClient;
+		if( pClient->Connect( Address( 127, 0, 0, 1 ), g_Port, Seconds( 5.0f ) ) != Client::Succeeded )
+		{
+			std::printf( "Failed to connect client %i.\n", i );
+			delete pClient;
+			break;
+		}
+		clients.push_back( pClient );
+	}
+
+	for( Int32 i = 0; i < p_MessageCount; i++ )
+	{
+		for( SizeType j = 0; j < clients.size( ); j++ )
+		{
+			UserMessage * pMessage = clients[ j ]->CreateUserMessage( "latency", sizeof( Uint64 ) );
+			const Uint64 sent = Timer::GetSystemTimeNanoseconds( );
+			pMessage->WriteArray( &sent, sizeof( sent ) );
+			pMessage->Send( true );
+			delete pMessage;
+		}
+		Sleep( Milliseconds( 10 ) );
+	}
+
+	// Keep the connections until the resent messages are delivered,
+	// the clients are disconnected when destroyed.
+	Sleep( Seconds( 3.0f ) );
+	for( SizeType i = 0; i < clients.size( ); i++ )
+	{
+		delete clients[ i ];
+	}
+
+	return 0;
+}
+
+int main( int p_ArgumentCount, char ** p_ppArguments )
+{
+	const Int32 clientCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 1, 200 );
+	const Int32 messageCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 2, 100 );
+	const Bool usePool = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 3, 1 ) != 0;
+	const Int32 workerCount = Benchmark::GetArgument( p_ArgumentCount, p_ppArguments, 4, 0 );
+
+	if( clientCount < 1 || clientCount > 255 )
+	{
+		std::printf( "The client count must be 1 to 255.\n" );
+		return 1;
+	}
+
+	const pid_t clientProcess = fork( );
+	if( clientProcess == 0 )
+	{
+		_exit( RunClients( clientCount, messageCount ) );
+	}
+
+	BenchmarkServer server;
+	LatencyListener listener;
+	server.HookUserMessage( &listener, "latency" );
+
+	const Uint32 idleThreads = Benchmark::GetThreadCount( );
+	if( server.Start( Server::Properties( g_Port, static_cast<Uint8>( clientCount ), Seconds( 5.0f ), 22, 30,
+										  "Bit Engine Network", usePool, static_cast<Uint32>( workerCount ) ) ) == false )
+	{
+		std::printf( "Failed to start the server.\n" );
+		kill( clientProcess, SIGKILL );
+		return 1;
+	}
+
+	// Wait for the connections, then measure the message handling.
+	const Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+	while( server.GetConnectionCount( ) < static_cast<SizeType>( clientCount ) &&
+		   Timer::GetSystemTimeNanoseconds( ) - startTime < 30000000000ULL )
+	{
+		Sleep( Milliseconds( 10 ) );
+	}
+	const SizeType connectionCount = server.GetConnectionCount( );
+	const Uint32 serverThreads = Benchmark::GetThreadCount( ) - idleThreads;
+	const Float64 processTime = Benchmark::GetProcessTime( );
+	const Uint64 measureTime = Timer::GetSystemTimeNanoseconds( );
+
+	const Uint32 expected = static_cast<Uint32>( connectionCount * messageCount );
+	while( listener.m_Count < expected && Timer::GetSystemTimeNanoseconds( ) - measureTime < 30000000000ULL )
+	{
+		Sleep( Milliseconds( 10 ) );
+	}
+	const Float64 usedTime = Benchmark::GetProcessTime( ) - processTime;
+	const Float64 wallTime = static_cast<Float64>( Timer::GetSystemTimeNanoseconds( ) - measureTime ) / 1000000000.0;
+
+	listener.m_Mutex.Lock( );
+	std::printf( "Mode: %s, connections: %u, server threads: %u\n", usePool ? "worker pool" : "threaded",
+				 static_cast<Uint32>( connectionCount ), serverThreads );
+	std::printf( "Messages: %u/%u, cpu: %.3f s in %.3f s(%.1f%%)\n", static_cast<Uint32>( listener.m_Count ), expected,
+				 usedTime, wallTime, 100.0 * usedTime / wallTime );
+	std::printf( "Latency p50: %.1f us, p99: %.1f us\n", Benchmark::GetPercentile( listener.m_Latencies, 50.0 ),
+				 Benchmark::GetPercentile( listener.m_Latencies, 99.0 ) );
+	listener.m_Mutex.Unlock( );
+
+	waitpid( clientProcess, NULL, 0 );
+	server.Stop( );
+	return 0;
+}
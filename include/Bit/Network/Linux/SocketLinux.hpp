@@ -43,6 +43,7 @@ namespace Bit
 
         // Friend classes
 		friend class TcpListenerLinux;
+		friend class SocketSelector;
 
 		////////////////////////////////////////////////////////////////
 		/// \brief Default constructor
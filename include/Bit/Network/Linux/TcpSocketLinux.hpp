@@ -59,9 +59,14 @@ namespace Bit
 		/// \param p_Port Server port.
 		/// \param m_Timeout Time in milliseconds until
 		///		the connection attemp timeouts.
+		/// \param p_EndpointPort Local port to bind before connecting,
+		///		0 lets the system pick one.
 		///
 		////////////////////////////////////////////////////////////////
-		virtual Bool Connect( const Address & p_Address, const Uint16 p_Port, const Time & p_Timeout = Time::Infinite );
+		virtual Bool Connect(	const Address & p_Address,
+								const Uint16 p_Port,
+								const Time & p_Timeout = Time::Infinite,
+								const Uint16 p_EndpointPort = 0 );
 
 		////////////////////////////////////////////////////////////////
 		/// \brief Disconnect the socket from the server.
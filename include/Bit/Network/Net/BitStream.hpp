@@ -0,0 +1,154 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_BIT_STREAM_HPP
+#define BIT_NETWORK_NET_BIT_STREAM_HPP
+
+#include <Bit/Build.hpp>
+#include <vector>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \ingroup Network
+		/// \brief Bit stream writer class.
+		///
+		/// Values are packed with the least significant bit first,
+		/// without any padding between them.
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API BitWriter
+		{
+
+		public:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Constructor.
+			///
+			/// \param p_Buffer Buffer to append the written bits to.
+			///
+			////////////////////////////////////////////////////////////////
+			BitWriter( std::vector<Uint8> & p_Buffer );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Write bits.
+			///
+			/// \param p_Value Value to write.
+			/// \param p_BitCount Number of bits to write, 0 - 32.
+			///
+			////////////////////////////////////////////////////////////////
+			void WriteBits( const Uint32 p_Value, const Uint8 p_BitCount );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Write bytes.
+			///
+			////////////////////////////////////////////////////////////////
+			void WriteBytes( const void * p_pData, const SizeType p_DataSize );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Write variable length integer, 7 bits at a time.
+			///
+			////////////////////////////////////////////////////////////////
+			void WriteVarUint( Uint64 p_Value );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the number of written bits.
+			///
+			////////////////////////////////////////////////////////////////
+			SizeType GetBitCount( ) const;
+
+		private:
+
+			// Private variables
+			std::vector<Uint8> &	m_Buffer;		///< The buffer.
+			SizeType				m_BitCount;		///< Number of written bits.
+
+		};
+
+		////////////////////////////////////////////////////////////////
+		/// \ingroup Network
+		/// \brief Bit stream reader class.
+		///
+		/// Reads values written by the bit stream writer.
+		/// All read functions return false if there's not enough data left.
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API BitReader
+		{
+
+		public:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Constructor.
+			///
+			/// \param p_pData Data to read from.
+			/// \param p_DataSize Size of the data.
+			///
+			////////////////////////////////////////////////////////////////
+			BitReader( const void * p_pData, const SizeType p_DataSize );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Read bits.
+			///
+			/// \param p_Value Output value.
+			/// \param p_BitCount Number of bits to read, 0 - 32.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool ReadBits( Uint32 & p_Value, const Uint8 p_BitCount );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Read bytes.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool ReadBytes( void * p_pData, const SizeType p_DataSize );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Read variable length integer.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool ReadVarUint( Uint64 & p_Value );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the number of read bits.
+			///
+			////////////////////////////////////////////////////////////////
+			SizeType GetBitCount( ) const;
+
+		private:
+
+			// Private variables
+			const Uint8 *	m_pData;		///< The data.
+			const SizeType	m_DataSize;		///< Size of the data.
+			SizeType		m_BitCount;		///< Number of read bits.
+
+		};
+
+	}
+
+}
+
+#endif
@@ -28,6 +28,17 @@
 #include <Bit/Network/Net/EntityManager.hpp>
 #include <Bit/Network/Net/Private/NetPacket.hpp>
 #include <Bit/Network/Net/Private/SequenceManager.hpp>
+#include <Bit/Network/Net/Private/FragmentAssembler.hpp>
+#include <Bit/Network/Net/Private/PacketBuilder.hpp>
+#include <Bit/Network/Net/Private/SequenceRing.hpp>
+#include <Bit/Network/Net/Private/RttEstimator.hpp>
+#include <Bit/Network/Net/Private/CongestionController.hpp>
+#include <Bit/Network/Net/Private/MessageTable.hpp>
+#include <Bit/Network/Net/Private/MessageChannels.hpp>
+#include <Bit/Network/Net/Private/PacketCompressor.hpp>
+#include <Bit/Network/Net/CompressionDictionary.hpp>
+#include <Bit/Network/Net/SocketFactory.hpp>
+#include <Bit/Network/Net/ConnectionStatistics.hpp>
 #include <Bit/Network/UdpSocket.hpp>
 #include <Bit/Network/Net/HostMessageListener.hpp>
 #include <Bit/Network/Net/UserMessage.hpp>
@@ -37,7 +48,6 @@
 #include <Bit/System/Timer.hpp>
 #include <queue>
 #include <map>
-#include <list>
 #include <set>
 
 namespace Bit
@@ -150,6 +160,12 @@ namespace Bit
 			////////////////////////////////////////////////////////////////
 			Time GetPing();
 
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the statistics of the connection to the server.
+			///
+			////////////////////////////////////////////////////////////////
+			ConnectionStatistics GetStatistics();
+
 			////////////////////////////////////////////////////////////////
 			/// \brief Get the current time of the server.
 			///
@@ -193,6 +209,39 @@ namespace Bit
 			////////////////////////////////////////////////////////////////
 			UserMessage * CreateUserMessage( const std::string & p_Name, const Int32 p_MessageSize = -1 );
 
+			////////////////////////////////////////////////////////////////
+			/// \brief Set the delivery type of a message channel.
+			///
+			/// Send user messages on the channel via UserMessage::SendOnChannel.
+			/// All the channels are reliable ordered by default.
+			///
+			/// \param p_Channel Channel index, less than MaxChannelCount.
+			/// \param p_Delivery Delivery type of the messages sent on the channel.
+			///
+			/// \return false if the channel is out of range.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool SetChannel( const Uint8 p_Channel, const DeliveryType::eType p_Delivery );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Set the compression dictionary, before connecting.
+			///
+			/// The server compresses by the dictionary if it has the same one,
+			/// else without any dictionary.
+			///
+			////////////////////////////////////////////////////////////////
+			void SetCompressionDictionary( const CompressionDictionary & p_Dictionary );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Set the factory of the socket, before connecting.
+			///
+			/// Record or replay the traffic by TrafficRecorder or TrafficReplay.
+			///
+			/// \param p_pFactory Factory of the socket, NULL for a regular udp socket.
+			///
+			////////////////////////////////////////////////////////////////
+			void SetSocketFactory( SocketFactory * p_pFactory );
+
 			////////////////////////////////////////////////////////////////
 			/// \brief Get the time since last received packet, including heartbeats.
 			///
@@ -210,7 +259,7 @@ namespace Bit
 			////////////////////////////////////////////////////////////////
 			struct ReceivedData
 			{
-				ReceivedData( Uint8 * p_pData, const SizeType p_DataSize, const Uint16 p_Sequence );
+				ReceivedData( const Uint8 * p_pData, const SizeType p_DataSize, const Uint16 p_Sequence );
 				~ReceivedData( );
 
 				Uint16		Sequence;
@@ -225,22 +274,42 @@ namespace Bit
 			////////////////////////////////////////////////////////////////
 			struct ReliablePacket
 			{
-				Uint16		Sequence;
-				Uint8 *		pData;
-				SizeType	DataSize;
-				Timer		SendTimer;
-				Timer		ResendTimer;
-				Bool		Resent;
+				Uint16				Sequence;
+				std::vector<Uint8>	Data;		///< Packet data, the buffer is reused by the pooled packets.
+				Timer				SendTimer;
+				Uint32				Resends;	///< Number of times the packet is resent.
+			};
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Structure for reliable messages too large for a single packet,
+			///			waiting for their fragments to be sent.
+			///
+			////////////////////////////////////////////////////////////////
+			struct FragmentedMessage
+			{
+				PacketType::eType	Type;			///< Packet type of the message.
+				Uint8 *				pData;			///< Copy of the message data.
+				SizeType			DataSize;		///< Size of the message data.
+				Uint16				MessageId;		///< Id of the message.
+				Uint16				NextFragment;	///< Index of the next fragment to send.
+				Uint16				FragmentCount;	///< Number of fragments.
+			};
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Structure for the listeners of a host message.
+			///
+			////////////////////////////////////////////////////////////////
+			struct HostMessageHandler
+			{
+				std::string							Name;		///< Name of the message.
+				std::vector<HostMessageListener *>	Listeners;	///< Listeners of the message.
 			};
 
 			// Private  typedefs
-			typedef std::map<Uint16, ReliablePacket*>					ReliablePacketMap;
-			typedef std::pair<Uint16, ReliablePacket*>					ReliablePacketPair;
-			typedef std::list<Time>										TimeList;
-			typedef std::set<HostMessageListener*>						HostMessageListenerSet;
-			typedef std::map<std::string, HostMessageListenerSet *>		HostMessageListenerMap;
-			typedef std::pair<std::string, HostMessageListenerSet *>	HostMessageListenerPair;
+			typedef SequenceRing<ReliablePacket>						ReliablePacketRing;
+			typedef std::vector<HostMessageHandler>						HostMessageHandlerVector;
 			typedef std::queue<ReceivedData*>							ReceivedDataQueue;
+			typedef std::queue<FragmentedMessage>						FragmentedMessageQueue;
 
 			// Private functions
 			////////////////////////////////////////////////////////////////
@@ -252,6 +321,12 @@ namespace Bit
 										const Bool p_CloseReliableThread,
 										const Bool p_CloseUserMessageThread );
 
+			////////////////////////////////////////////////////////////////
+			/// \brief Handle a single packet, or the packets of a coalesced packet.
+			///
+			////////////////////////////////////////////////////////////////
+			void HandlePacket( Uint8 * p_pData, const SizeType p_DataSize );
+
 			////////////////////////////////////////////////////////////////
 			/// \brief Send unreliable packet to the server.
 			///
@@ -280,7 +355,83 @@ namespace Bit
 								const bool p_AddReliableFlag);
 
 			////////////////////////////////////////////////////////////////
-			/// \brief	Calculate the new ping.
+			/// \brief	Add a reliable packet to the reliable packet ring, without sending it.
+			///
+			/// \param p_pHeader Pointer to the packet header, including the sequence.
+			/// \param p_HeaderSize Size of the packet header.
+			/// \param p_pData Pointer to the packet data, following the header.
+			/// \param p_DataSize Size of the packet data.
+			///
+			/// \return Pointer to the reliable packet, owned by the reliable packet ring.
+			///			NULL if the whole sequence space is waiting for acknowledgement,
+			///			the client is then disconnected by the trigger thread.
+			///
+			////////////////////////////////////////////////////////////////
+			ReliablePacket * CreateReliablePacket(	const Uint16 p_Sequence,
+													const Uint8 * p_pHeader,
+													const SizeType p_HeaderSize,
+													const Uint8 * p_pData,
+													const SizeType p_DataSize );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the time to wait for an acknowledgement before resending a reliable packet.
+			///
+			/// \param p_Resends Number of times the packet is resent.
+			///
+			////////////////////////////////////////////////////////////////
+			Time GetResendTime( const Uint32 p_Resends );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Send the queued fragments, as long as there's room in the fragment window.
+			///
+			////////////////////////////////////////////////////////////////
+			void SendFragments( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Handle a reassembled message.
+			///
+			////////////////////////////////////////////////////////////////
+			void HandleFragmentedMessage( const Uint8 p_MessageType, std::vector<Uint8> & p_Message, const Uint16 p_Sequence );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Remove an acknowledged packet from the reliable packet ring.
+			///
+			////////////////////////////////////////////////////////////////
+			void HandleAcknowledgement( const Uint16 p_Sequence );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Acknowledge a received reliable packet,
+			///			via the acknowledgement header of the next coalesced packet.
+			///
+			////////////////////////////////////////////////////////////////
+			void AcknowledgePacket( const Uint16 p_Sequence );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Add a packet to the coalesced packet, sent at the next tick.
+			///
+			/// \return False if the packet is too large to be coalesced, send it on its own.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool QueuePacket(	const Uint8 * p_pHeader,
+								const SizeType p_HeaderSize,
+								const Uint8 * p_pData,
+								const SizeType p_DataSize );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Send the coalesced packets and the pending acknowledgements.
+			///
+			////////////////////////////////////////////////////////////////
+			void FlushPackets( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Flush the packet builder and send the coalesced packet.
+			///			The packet builder mutex has to be locked.
+			///
+			////////////////////////////////////////////////////////////////
+			void SendCoalescedPacket( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Add a round trip time sample to the round trip time estimation.
 			///
 			////////////////////////////////////////////////////////////////
 			void CalculateNewPing( const Time & p_LapsedTime );
@@ -291,6 +442,28 @@ namespace Bit
 			////////////////////////////////////////////////////////////////
 			void AddHostMessage(ReceivedData * p_ReceivedData);
 
+			////////////////////////////////////////////////////////////////
+			/// \brief	Pass a received host message through its channel.
+			///
+			/// Adds the message if it's its turn, followed by the buffered messages waiting for it.
+			///
+			////////////////////////////////////////////////////////////////
+			void ReceiveHostMessage(const Uint8 * p_pData, const SizeType p_DataSize, const Uint16 p_Sequence);
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Call the listeners of a host message.
+			///
+			////////////////////////////////////////////////////////////////
+			void HandleHostMessage(const Uint8 * p_pData, const SizeType p_DataSize);
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Send the host message ids to the server.
+			///
+			/// \param p_FirstId Id of the first message to send.
+			///
+			////////////////////////////////////////////////////////////////
+			void SendMessageTable(const Uint16 p_FirstId);
+
 			////////////////////////////////////////////////////////////////
 			/// \brief	Add entity update sequence, makes sure we're not handling old entity updates.
 			///
@@ -298,7 +471,8 @@ namespace Bit
 			bool AddEntityUpdateSequence(const Uint16 p_Sequence);
 
 			// Private variables
-			UdpSocket							m_Socket;					///< Udp socket.
+			Private::UdpSocketBase *			m_pSocket;					///< Udp socket, created at connect.
+			SocketFactory *						m_pSocketFactory;			///< Factory of the socket, NULL for a regular udp socket.
 			Uint16								m_Port;						///< Udp and TCP port.
 			Thread								m_Thread;					///< Thread created after the connection is established.
 			Thread								m_TriggerThread;			///< Thread for creating specific triggers.
@@ -315,12 +489,26 @@ namespace Bit
 			ThreadValue<Uint16>					m_Sequence;					///< The sequence of the next packet being sent.
 			ThreadValue<Uint16>					m_EntityUpdateSequence;		///< Last received entitiy update sequence.
 			SequenceManager						m_SequenceManager;			///< Sequence manager.
-			ThreadValue<ReliablePacketMap>		m_ReliableMap;				///< Map of reliable packets.
-			ThreadValue<Time>					m_Ping;						///< Current network ping.
-			TimeList							m_PingList;					///< List of the last pings.
-			ThreadValue<HostMessageListenerMap>	m_HostMessageListeners;		///< Map of user message listeners and their message types.
+			ThreadValue<ReliablePacketRing>		m_ReliablePackets;			///< Ring of reliable packets waiting for acknowledgement.
+			ThreadValue<Bool>					m_ReliableRingFull;			///< Flag for checking if a reliable packet could not be added to the ring.
+			Timer								m_ReliableTimer;			///< Clock of the resend deadlines, protected by the reliable packet mutex.
+			ThreadValue<RttEstimator>			m_Rtt;						///< Round trip time estimation.
+			ThreadValue<CongestionController>	m_Congestion;				///< Loss and delivery rate estimation, the send rate is not limited.
+			ThreadValue<MessageTable>			m_HostMessageTable;			///< Ids of the hooked host messages, sent to the server.
+			ThreadValue<HostMessageHandlerVector>	m_HostMessageHandlers;	///< Listeners of the host messages, message id as index.
+			ThreadValue<MessageTable>			m_UserMessageIds;			///< Ids of the user messages, given by the server.
+			ThreadValue<MessageChannels>		m_Channels;					///< Message channels.
+			ThreadValue<Bool>					m_ChannelsFull;				///< Flag for checking if a message could not be added to the reorder buffers.
+			CompressionDictionary				m_CompressionDictionary;	///< Compression dictionary, set before connecting.
+			Bool								m_UseCompressionDictionary;	///< Flag for checking if the server compresses by the dictionary, only accessed by the receiving thread.
 			ThreadValue<ReceivedDataQueue>		m_UserMessages;				///< Queue of user messages
 			Semaphore							m_UserMessageSemaphore;		///< Semaphore for executing user message listeners.
+			ThreadValue<FragmentedMessageQueue>	m_FragmentedMessages;		///< Queue of fragmented messages being sent.
+			Uint16								m_NextMessageId;			///< Id of the next fragmented message, protected by the fragmented message mutex.
+			SizeType							m_FragmentsInFlight;		///< Number of sent fragments not yet acknowledged, protected by the fragmented message mutex.
+			FragmentAssembler					m_FragmentAssembler;		///< Reassembly of the received fragmented messages.
+			ThreadValue<PacketBuilder>			m_PacketBuilder;			///< Builder of the coalesced packets.
+			std::vector<Uint8>					m_CoalescedPacket;			///< Coalesced packet being sent, protected by the packet builder mutex.
 
 		};
 
@@ -0,0 +1,123 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_COMPRESSION_DICTIONARY_HPP
+#define BIT_NETWORK_NET_COMPRESSION_DICTIONARY_HPP
+
+#include <Bit/Build.hpp>
+#include <vector>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \ingroup Network
+		/// \brief Static dictionary of the packet compression.
+		///
+		/// The compressed packets may refer to the bytes of the dictionary,
+		/// letting small packets, like entity snapshots, reuse the content common to all the traffic.
+		/// Train the dictionary from recorded traffic and give the same dictionary
+		/// to the server and the clients, the checksum is compared at connect.
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API CompressionDictionary
+		{
+
+		public:
+
+			// Public constants
+			static const SizeType MaxSize = 65535;		///< Max size of the dictionary, the offsets of the matches are 16 bit.
+			static const SizeType DefaultSize = 16384;	///< Default size of a trained dictionary.
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Default constructor, an empty dictionary.
+			///
+			////////////////////////////////////////////////////////////////
+			CompressionDictionary( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Set the content of the dictionary.
+			///
+			/// Only the last MaxSize bytes are kept if the data is larger.
+			///
+			////////////////////////////////////////////////////////////////
+			void Set( const Uint8 * p_pData, const SizeType p_Size );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Train the dictionary from samples of recorded traffic.
+			///
+			/// The segments of the samples sharing the most byte sequences with the other samples
+			/// are picked, the most common ones at the end of the dictionary.
+			///
+			/// \param p_Samples Samples, like recorded entity snapshots or host messages.
+			/// \param p_Size Max size of the dictionary.
+			///
+			/// \return False if no segment is common to the samples, the dictionary is empty.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool Train( const std::vector<std::vector<Uint8> > & p_Samples, const SizeType p_Size = DefaultSize );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Clear the dictionary.
+			///
+			////////////////////////////////////////////////////////////////
+			void Clear( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the content of the dictionary.
+			///
+			////////////////////////////////////////////////////////////////
+			const std::vector<Uint8> & GetData( ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the size of the dictionary.
+			///
+			////////////////////////////////////////////////////////////////
+			SizeType GetSize( ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the checksum of the dictionary, 0 if empty.
+			///
+			////////////////////////////////////////////////////////////////
+			Uint32 GetChecksum( ) const;
+
+		private:
+
+			// Friend classes
+			friend class PacketCompressor;
+
+			// Private variables
+			std::vector<Uint8>	m_Data;			///< Content of the dictionary.
+			std::vector<Uint32>	m_HashTable;	///< Last position + 1 of the 4 byte sequences of the content, by their hashes.
+			Uint32				m_Checksum;		///< Checksum of the content.
+
+		};
+
+	}
+
+}
+
+#endif
@@ -0,0 +1,77 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_CONNECTION_STATISTICS_HPP
+#define BIT_NETWORK_NET_CONNECTION_STATISTICS_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/Network/Net/DeliveryType.hpp>
+#include <Bit/System/Time.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \ingroup Network
+		/// \brief Statistics of a network connection.
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API ConnectionStatistics
+		{
+
+		public:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Default constructor.
+			///
+			////////////////////////////////////////////////////////////////
+			ConnectionStatistics( ) :
+				PacketLoss( 0.0f ),
+				SendRate( 0 ),
+				DeliveryRate( 0 ),
+				PacketsSent( 0 ),
+				PacketsLost( 0 )
+			{
+			}
+
+			// Public variables
+			Time		Rtt;			///< Smoothed round trip time.
+			Time		RttVariance;	///< Round trip time variation.
+			Time		Rto;			///< Retransmission timeout of reliable packets.
+			Float32		PacketLoss;		///< Recent loss of reliable packets, in percent.
+			Uint32		SendRate;		///< Send rate limit in bytes per second, 0 if there's no limit.
+			Uint32		DeliveryRate;	///< Estimated delivery rate in bytes per second, from the acknowledgements.
+			Uint64		PacketsSent;	///< Number of sent packets, including the resent ones.
+			Uint64		PacketsLost;	///< Number of reliable packets resent after a timeout.
+			Time		OrderingDelay[ MaxChannelCount ];	///< Exponentially weighted moving average (1/8 weight) of the time the received messages of each channel waited for the preceding ones.
+
+		};
+
+	}
+
+}
+
+#endif
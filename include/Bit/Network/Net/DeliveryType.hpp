@@ -0,0 +1,61 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_DELIVERY_TYPE_HPP
+#define BIT_NETWORK_NET_DELIVERY_TYPE_HPP
+
+#include <Bit/Build.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \ingroup Network
+		/// \brief Delivery type of a message channel.
+		///
+		/// Every channel has its own sequence space and reorder buffer,
+		/// a lost message only holds back the later messages of the same channel.
+		///
+		////////////////////////////////////////////////////////////////
+		struct DeliveryType
+		{
+			enum eType
+			{
+				Unreliable			= 0,	///< Lost messages are not resent, the messages are handled in order of arrival.
+				UnreliableSequenced	= 1,	///< Lost messages are not resent, messages older than the last handled one are dropped.
+				ReliableUnordered	= 2,	///< Lost messages are resent, the messages are handled in order of arrival.
+				ReliableOrdered		= 3		///< Lost messages are resent, the messages are handled in order of sending.
+			};
+		};
+
+		///< Number of message channels per connection.
+		const SizeType MaxChannelCount = 16;
+
+	}
+
+}
+
+#endif
@@ -27,8 +27,10 @@
 #include <Bit/Build.hpp>
 #include <Bit/Network/Net/Variable.hpp>
 #include <Bit/System/ThreadValue.hpp>
+#include <Bit/System/Vector3.hpp>
 #include <string>
 #include <set>
+#include <atomic>
 
 namespace Bit
 {
@@ -93,6 +95,29 @@ namespace Bit
 			////////////////////////////////////////////////////////////////
 			GroupSet GetGroups();
 
+			////////////////////////////////////////////////////////////////
+			/// \brief Set the position of the entity.
+			///
+			/// The position is used for finding the clients the entity is relevant to,
+			/// entities without a position are relevant to every client.
+			///
+			////////////////////////////////////////////////////////////////
+			void SetPosition(const Vector3f32 & p_Position);
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Clear the position of the entity, making it relevant to every client.
+			///
+			////////////////////////////////////////////////////////////////
+			void ClearPosition();
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the position of the entity.
+			///
+			/// \return False if the entity has no position, else true.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool GetPosition(Vector3f32 & p_Position);
+
 		protected:
 
 			////////////////////////////////////////////////////////////////
@@ -108,6 +133,10 @@ namespace Bit
 			std::string				m_Name;				///< Entity name.
 			ThreadValue<GroupSet>	m_Groups;			///< Set of entity groups for this entity.
 			EntityManager *			m_pEntityManager;	///< Entity changer class.
+			Mutex					m_PositionMutex;	///< Mutex for the position.
+			Vector3f32				m_Position;			///< Position of the entity.
+			Bool					m_HasPosition;		///< Flag for checking if the entity has a position.
+			std::atomic<Uint64>		m_DirtyMask;		///< Variables changed since the last world snapshot, bit n is variable n.
 
 		};
 
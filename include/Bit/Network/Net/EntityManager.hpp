@@ -28,9 +28,14 @@
 #include <Bit/Network/Socket.hpp>
 #include <Bit/Network/Net/Variable.hpp>
 #include <Bit/Network/Net/Entity.hpp>
+#include <Bit/Network/Net/VariableEncoding.hpp>
 #include <Bit/Network/Net/Private/NetPacket.hpp>
+#include <Bit/Network/Net/Private/EntitySnapshot.hpp>
+#include <Bit/Network/Net/Private/EntityInterest.hpp>
+#include <Bit/Network/Net/Private/EntityGrid.hpp>
 #include <Bit/System/Log.hpp>
 #include <string>
+#include <cstring>
 #include <vector> 
 #include <map>
 #include <set>
@@ -151,6 +156,12 @@ namespace Bit
 			////////////////////////////////////////////////////////////////
 			void SetExtrapolationTime(const Time & p_Time);
 
+			////////////////////////////////////////////////////////////////
+			/// \brief Set interpolation mode of the interpolated variables.
+			///
+			////////////////////////////////////////////////////////////////
+			void SetInterpolationMode(const InterpolationMode::eMode p_Mode);
+
 			////////////////////////////////////////////////////////////////
 			/// \brief Link entity to a certain key.
 			///
@@ -168,6 +179,7 @@ namespace Bit
 			/// \param p_Class Key of an already linked entity class.
 			/// \param p_Class Key of the entity variable.
 			/// \param p_Pointer Pointer to the variable.
+			/// \param p_Encoding Encoding of the variable in the entity snapshots.
 			///
 			/// \return Pointer to the created entity, NULL if error.
 			///
@@ -175,7 +187,8 @@ namespace Bit
 			template < typename Type, typename Class>
 			bool RegisterVariable(	const std::string & p_Class,
 									const std::string & p_Variable,
-									Variable<Type> Class::* p_pPointer);
+									Variable<Type> Class::* p_pPointer,
+									const VariableEncoding & p_Encoding = VariableEncoding());
 
 			////////////////////////////////////////////////////////////////
 			/// \brief Register entity interpolated variable.
@@ -183,6 +196,7 @@ namespace Bit
 			/// \param p_Class Key of an already linked entity class.
 			/// \param p_Class Key of the entity variable.
 			/// \param p_Pointer Pointer to the interpolated variable.
+			/// \param p_Encoding Encoding of the variable in the entity snapshots.
 			///
 			/// \return Pointer to the created entity, NULL if error.
 			///
@@ -190,7 +204,8 @@ namespace Bit
 			template < typename Type, typename Class>
 			bool RegisterVariable(	const std::string & p_Class,
 									const std::string & p_Variable,
-									InterpolatedVariable<Type> Class::* p_pPointer);
+									InterpolatedVariable<Type> Class::* p_pPointer,
+									const VariableEncoding & p_Encoding = VariableEncoding());
 
 			////////////////////////////////////////////////////////////////
 			/// \brief Set entity variable by variable name.
@@ -213,6 +228,9 @@ namespace Bit
 			/// \param p_GroupId The group to take a snapshot of.
 			/// \param p_Time The time of the snapshot data, this is for interpolated variables only.
 			///
+			/// The snapshots are taken one variable of an entity class at a time,
+			/// the interpolated variables are interpolated in batches.
+			///
 			////////////////////////////////////////////////////////////////
 			void TakeSnapshot(const Uint32 p_GroupId, const Bit::Time & p_Time);
 
@@ -285,38 +303,169 @@ namespace Bit
 											const Bool p_ClearMessage = false );
 
 			////////////////////////////////////////////////////////////////
-			/// \brief	Clear the list of all changed entities.
+			/// \brief	Create the entity class table message, sent once to every client at connection.
+			///
+			/// Classes and variables get ids in the order they are linked and registered,
+			/// snapshot messages are refering to the classes by id.
+			///
+			/// Message structure:
+			///		- Class count(varint)
+			///		* Class:
+			///			- Name length(1)
+			///			- Name(...)
+			///			- Variable count(varint)
+			///			* Variable:
+			///				- Name length(1)
+			///				- Name(...)
+			///				- Data size(varint)
+			///				- Encoding(...)
+			///
+			/// \param p_Message Vector to append the message to.
+			///
+			////////////////////////////////////////////////////////////////
+			void CreateClassTableMessage( std::vector<Uint8> & p_Message );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Parse the entity class table message from the server.
+			///
+			/// \return True if succeeded, else false.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool ParseClassTableMessage( const void * p_pMessage, const SizeType p_MessageSize );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Take a snapshot of the state of all entities and add it to the snapshot history.
+			///			Entities in the deletion queue are deleted first.
+			///
+			/// \return Id of the snapshot.
+			///
+			////////////////////////////////////////////////////////////////
+			Uint16 CreateWorldSnapshot( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Create an entity snapshot message from the latest world snapshot,
+			///			delta encoded against a snapshot acknowledged by the client.
+			///
+			/// Only new, changed and removed entities are part of the message,
+			/// the message is sent unreliably. The full state is sent if the baseline
+			/// is no longer in the snapshot history.
+			///
+			/// Entities with a position outside the view of the client are left out,
+			/// and removed from the client when leaving the view. The entities are prioritized
+			/// by the age of the client's state and their distance to the client,
+			/// changed entities not fitting in MaxSnapshotSize are deferred to the upcoming snapshots.
+			///
+			/// Message structure:
+			///		- Time(8)
+			///		- Snapshot id(2)
+			///		- Baseline id(2)
+			///		- Flags(1)
+			///		- Entity count(2)
+			///		* Entity:
+			///			- Entity id(varint)
+			///			- State type(1)
+			///			* Full state:
+			///				- Class id(varint)
+			///				- State size(varint)
+			///				- State(...)
+			///			* Delta state:
+			///				- Delta size(2)
+			///				- Delta(...)
+			///		- Removed entity count(2)
+			///		* Removed entity:
+			///			- Entity id(varint)
+			///
+			/// \param p_Baseline Id of the baseline snapshot, -1 for sending the full state.
+			/// \param p_View View of the client.
+			/// \param p_Interest Interest management state of the client, the sent entity versions are recorded.
+			/// \param p_Message Vector to append the message to.
+			///
+			/// \return False if there's nothing to send, else true.
 			///
 			////////////////////////////////////////////////////////////////
-			void ClearChangedEntities();
+			Bool CreateSnapshotMessage(	const Int32 p_Baseline,
+										const EntityInterest::View & p_View,
+										EntityInterest & p_Interest,
+										std::vector<Uint8> & p_Message );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Set the cell size of the grid used for finding the entities within the views.
+			///
+			/// Preferably about the view radius of the clients.
+			///
+			////////////////////////////////////////////////////////////////
+			void SetInterestCellSize( const Float32 p_CellSize );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Parse an entity snapshot message from the server.
+			///			Applying the changed states and create entities if needed.
+			///
+			/// \param p_SnapshotId Id of the parsed snapshot, to be acknowledged.
+			///
+			/// \return True if the snapshot should be acknowledged, else false.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool ParseSnapshotMessage(	const void * p_pMessage,
+										const SizeType p_MessageSize,
+										Uint16 & p_SnapshotId );
 
 		private:
 
 			// Forward declarations
 			struct EntityMetaData;
 			struct EntityLink;
+			struct VariableMetaData;
+			struct ServerEntityClass;
+			struct SnapshotCandidate;
 			
 			// Private typedefs
 			typedef std::map<std::string, VariableBase Entity::*>		EntityVariableMap;			///< Map of entity varibles, varaible name as key.
 			typedef std::map<std::string, EntityMetaData*>				EntityMetaDataMap;			///< Map of pointers for creating entities, entity name as key.
 			typedef std::map<Uint16, EntityLink*>						EntityMap;					///< Map of all entities, entity id as key.
-			typedef std::map<Entity *, VariableBase *>					ChangedEntityVariableMap;	///< Mapping entities to variables
-			typedef std::map<std::string, ChangedEntityVariableMap *>	ChangedVariablesMap;		///< Set of changed variables
-			typedef std::map<std::string, ChangedVariablesMap *>		ChangedEntitiesMap;			///< Map of changed entities.
 			typedef std::set<Entity *>									EntitySet;					///< Set of entities.
+			typedef std::vector<EntityMetaData*>						EntityMetaDataVector;		///< Vector of entity class meta data, class id as index.
+			typedef std::vector<VariableMetaData>						VariableMetaDataVector;		///< Vector of entity variables, variable id as index.
+			typedef std::vector<ServerEntityClass>						ServerEntityClassVector;	///< Vector of the server's entity classes, server class id as index.
+			typedef std::vector<SnapshotCandidate>						SnapshotCandidateVector;	///< Vector of entities to add to a snapshot message.
+			typedef std::vector<EntityLink*>							EntityLinkVector;			///< Vector of entity links.
+			typedef void (EntityManager::*SnapshotFunction)(EntityMetaData *, const VariableMetaData &, const Time &);	///< Function for taking the snapshots of a variable.
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Entity variable meta data structure.
+			///
+			////////////////////////////////////////////////////////////////
+			struct VariableMetaData
+			{
+				std::string Name;					///< Name of the variable.
+				VariableBase Entity::* pVariable;	///< Pointer to the variable.
+				SizeType Size;						///< Size of the variable data.
+				SizeType Offset;					///< Offset of the variable data in the state slots.
+				VariableEncoding Encoding;			///< Encoding of the variable in the snapshots.
+				SnapshotFunction pSnapshotFunction;	///< Function for taking the snapshots of the variable.
+			};
 			
 			////////////////////////////////////////////////////////////////
 			/// \brief	Entity meta data structure. Holding the entity variables
 			///			and pointer to the entitiy creating function.
 			///
+			/// The variable data of all the entities of the class is copied to
+			/// contiguous state slots, one slot per entity. Only the changed variables
+			/// are copied when taking a world snapshot.
+			///
 			////////////////////////////////////////////////////////////////
 			struct EntityMetaData
 			{
 
 				size_t TypeHash;
 				std::string RawName;
+				std::string Name;					///< Name of the entity class.
+				Uint32 Id;							///< Class id, sent instead of the name.
 				Entity*(*CreationPointer)();		///< Pointer to function for creating entity.
 				EntityVariableMap EntityVariables;	///< Map of all the variables for this entity.
+				VariableMetaDataVector Variables;	///< Variables in the order of their ids.
+				SizeType StateSize;					///< Size of a state slot, the data size of all the variables.
+				std::vector<Uint8> States;			///< State slots of the entities.
+				EntityLinkVector SlotEntities;		///< Entities of the state slots, slot index as index.
 			};
 
 			////////////////////////////////////////////////////////////////
@@ -325,8 +474,36 @@ namespace Bit
 			////////////////////////////////////////////////////////////////
 			struct EntityLink
 			{
-				std::string Class;	///< Name of the entity's class.
-				Entity * pEntity;	///< Pointer to the entity.
+				std::string Class;			///< Name of the entity's class.
+				EntityMetaData * pMetaData;	///< Meta data of the entity's class.
+				Entity * pEntity;			///< Pointer to the entity.
+				SizeType Slot;				///< Index of the entity's state slot.
+				std::vector<Uint8> State;	///< Encoded state of the entity, updated when the entity is changed.
+			};
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Entity class of the server, received in the class table.
+			///			Maps the server's variable ids to the local variables.
+			///
+			////////////////////////////////////////////////////////////////
+			struct ServerEntityClass
+			{
+				EntityMetaData * pMetaData;							///< Local meta data, NULL if the class is unknown.
+				std::vector<VariableBase Entity::*> Variables;		///< Local variables, NULL if the variable is unknown.
+				std::vector<SizeType> Sizes;						///< Size of the server's variables.
+				std::vector<VariableEncoding> Encodings;			///< Encoding of the server's variables.
+			};
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Entity to add to a snapshot message, server only.
+			///
+			////////////////////////////////////////////////////////////////
+			struct SnapshotCandidate
+			{
+				Uint16 EntityId;								///< Id of the entity.
+				Int32 Version;									///< Id of the world snapshot the client got the entity state from, -1 if new.
+				Float32 Priority;								///< Priority of the entity, higher is sent first.
+				const EntitySnapshot::EntityState * pState;		///< State of the entity in the latest world snapshot.
 			};
 
 			// Private functions
@@ -334,12 +511,33 @@ namespace Bit
 			////////////////////////////////////////////////////////////////
 			/// \brief This function is being called when a network variable is changed.
 			///
+			/// Sets the variable's bit in the dirty mask of the entity,
+			/// server only.
+			///
 			/// \param p_pEntity Pointer to entitiy
 			/// \param p_VariableBase Pointer to variable base class.
 			///
 			////////////////////////////////////////////////////////////////
 			void OnVariableChange(Entity * p_pEntity, VariableBase * p_VariableBase);
 
+			////////////////////////////////////////////////////////////////
+			/// \brief Mark variables of an entity as changed.
+			///
+			/// The entity is added to the dirty entities if it had no changed variables.
+			///
+			/// \param p_Mask Dirty mask, bit n is variable n. The last bit is shared by the variables 63 and up.
+			///
+			////////////////////////////////////////////////////////////////
+			void MarkDirty(Entity * p_pEntity, const Uint64 p_Mask);
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Add a variable to an entity class, giving it the next id.
+			///
+			/// The state slots of already created entities are grown.
+			///
+			////////////////////////////////////////////////////////////////
+			void AddVariable(EntityMetaData * p_pMetaData, VariableMetaData & p_Variable);
+
 			////////////////////////////////////////////////////////////////
 			/// \brief Create a new entity at the given id.
 			///		   Make sure to destroy the entity by yourself.
@@ -357,19 +555,60 @@ namespace Bit
 			///
 			////////////////////////////////////////////////////////////////
 			void DeleteEntitiesInDeletionQueue();
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Take the snapshots of a variable of all the entities of a class.
+			///
+			////////////////////////////////////////////////////////////////
+			template<typename Type>
+			void TakeVariableSnapshots(EntityMetaData * p_pMetaData, const VariableMetaData & p_Variable, const Time & p_Time);
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Interpolate an interpolated variable of all the entities of a class.
+			///
+			////////////////////////////////////////////////////////////////
+			template<typename Type>
+			void TakeInterpolatedSnapshots(EntityMetaData * p_pMetaData, const VariableMetaData & p_Variable, const Time & p_Time);
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Set the variables of an entity from a snapshot state.
+			///
+			/// \return False if the state doesn't match the entity's variables, else true.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool ApplyEntityState(	EntityLink * p_pEntityLink,
+									const ServerEntityClass & p_Class,
+									const Uint8 * p_pState,
+									const SizeType p_StateSize,
+									const Time & p_Time,
+									const Time & p_MinimumTime );
 		
 			// Private variable
 			EntityChanger *			m_pEntityChanger;		///< Poiter to entity changer base class
 			Client *				m_pClient;				///< Null for server owner.
 			Server *				m_pServer;				///< Null for client owner.
 			EntityMetaDataMap		m_EntityMetaDataMap;	///< Map of entity class meta data.
-			ChangedEntitiesMap		m_ChangedEntities;		///< Map of changed entitites
 			EntityMap				m_Entities;				///< Map of all entities.
 			EntitySet				m_EntitiyDeletionQueue;	///< Queue or set of entities to be deleted.
 			Uint32					m_CurrentId;			///< Temporary solution for incremening the ID.
 			Time					m_InterpolationTime;	///< Interpolation time(delay).
 			Time					m_ExtrapolationTime;	///< Extrapolation time( for how long we should extra interpolate).
+			InterpolationMode::eMode m_InterpolationMode;	///< Interpolation mode of the interpolated variables.
+			InterpolationBatch		m_InterpolationBatch;	///< Batch for interpolating the variables, client only.
 			Mutex					m_Mutex;				///< Mutex for making sure we're not destroying entities at the same time we create entity messages.
+			EntitySnapshotHistory	m_SnapshotHistory;		///< Taken world snapshots(server) or received snapshots(client).
+			Uint16					m_SnapshotId;			///< Id of the next world snapshot.
+			EntityMetaDataVector	m_EntityClasses;		///< Entity class meta data, class id as index.
+			ServerEntityClassVector	m_ServerClasses;		///< The server's entity classes, client only.
+			Bool					m_ClassTableReceived;	///< Flag for checking if the server's class table is received, client only.
+			std::vector<Uint8>		m_StateBuffer;			///< Buffer for decoding entity states.
+			EntityGrid				m_InterestGrid;			///< Grid of the entity positions, server only.
+			std::vector<Uint16>		m_GlobalEntities;		///< Entities without a position, relevant to every client. Server only.
+			std::vector<Uint16>		m_QueryBuffer;			///< Buffer for the entities found in the grid.
+			SnapshotCandidateVector	m_Candidates;			///< Buffer for the entities to add to a snapshot message.
+			Mutex					m_DirtyMutex;			///< Mutex for the dirty entities.
+			std::vector<Uint16>		m_DirtyEntities;		///< Entities with changed variables since the last world snapshot.
+			std::vector<Uint16>		m_DirtyBuffer;			///< Dirty entities being handled by the world snapshot.
 
 			/// NEW!
 
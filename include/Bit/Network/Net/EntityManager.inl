@@ -42,10 +42,16 @@ bool EntityManager::LinkEntity( const std::string & p_Key )
 	// Add to the entity meta data map
 	EntityMetaData * pMetaData = new EntityMetaData;
 	pMetaData->TypeHash = typeid(T).hash_code();
-	pMetaData->RawName = typeid(T).raw_name();
+	pMetaData->RawName = typeid(T).name();
+	pMetaData->Name = p_Key;
+	pMetaData->Id = static_cast<Uint32>( m_EntityClasses.size( ) );
 	pMetaData->CreationPointer = &CreateEntityT<T>;
+	pMetaData->StateSize = 0;
 	m_EntityMetaDataMap.insert( it, std::pair<std::string, EntityMetaData*>( p_Key, pMetaData ) );
 
+	// Give the class the next id.
+	m_EntityClasses.push_back( pMetaData );
+
 	// Succeeded.
 	return true;
 }
@@ -55,8 +61,16 @@ bool EntityManager::LinkEntity( const std::string & p_Key )
 template < typename Type, typename Class>
 bool EntityManager::RegisterVariable(	const std::string & p_Class,
 										const std::string & p_Variable,
-										Variable<Type> Class::* p_pPointer)
+										Variable<Type> Class::* p_pPointer,
+										const VariableEncoding & p_Encoding)
 {
+	// Make sure that the encoding supports the variable type.
+	if (p_Encoding.IsValid(sizeof(Type)) == false)
+	{
+		bitLogNetErr(  "Invalid encoding of variable: " << p_Variable );
+		return false;
+	}
+
 	// Find the meta data and make sure it's doesn't already exists.
 	EntityMetaDataMap::iterator it = m_EntityMetaDataMap.find(p_Class);
 	if (it == m_EntityMetaDataMap.end())
@@ -70,7 +84,7 @@ bool EntityManager::RegisterVariable(	const std::string & p_Class,
 	// Error check the class type
 	if (pMetadata->TypeHash != typeid(Class).hash_code())
 	{
-		bitLogNetErr(  "Mismatching entity class type: " << pMetadata->RawName << "  , expecting  " << typeid(Class).raw_name() );
+		bitLogNetErr(  "Mismatching entity class type: " << pMetadata->RawName << "  , expecting  " << typeid(Class).name() );
 		//return false;
 	}
 
@@ -87,6 +101,15 @@ bool EntityManager::RegisterVariable(	const std::string & p_Class,
 	// Add the variable
 	pMetadata->EntityVariables.insert(it2, std::pair<std::string, VariableBase Entity::*>(p_Variable, pVariable));
 
+	// Give the variable the next id.
+	VariableMetaData variable;
+	variable.Name = p_Variable;
+	variable.pVariable = pVariable;
+	variable.Size = sizeof(Type);
+	variable.Encoding = p_Encoding;
+	variable.pSnapshotFunction = &EntityManager::TakeVariableSnapshots<Type>;
+	AddVariable(pMetadata, variable);
+
 	// Succeeded
 	return true;
 }
@@ -96,8 +119,16 @@ bool EntityManager::RegisterVariable(	const std::string & p_Class,
 template < typename Type, typename Class>
 bool EntityManager::RegisterVariable(	const std::string & p_Class,
 										const std::string & p_Variable,
-										InterpolatedVariable<Type> Class::* p_pPointer)
+										InterpolatedVariable<Type> Class::* p_pPointer,
+										const VariableEncoding & p_Encoding)
 {
+	// Make sure that the encoding supports the variable type.
+	if (p_Encoding.IsValid(sizeof(Type)) == false)
+	{
+		bitLogNetErr(  "Invalid encoding of variable: " << p_Variable );
+		return false;
+	}
+
 	// Find the meta data and make sure it's doesn't already exists.
 	EntityMetaDataMap::iterator it = m_EntityMetaDataMap.find(p_Class);
 	if (it == m_EntityMetaDataMap.end())
@@ -121,6 +152,15 @@ bool EntityManager::RegisterVariable(	const std::string & p_Class,
 	// Add the variable
 	pMetadata->EntityVariables.insert(it2, std::pair<std::string, VariableBase Entity::*>(p_Variable, pVariable));
 
+	// Give the variable the next id.
+	VariableMetaData variable;
+	variable.Name = p_Variable;
+	variable.pVariable = pVariable;
+	variable.Size = sizeof(Type);
+	variable.Encoding = p_Encoding;
+	variable.pSnapshotFunction = &EntityManager::TakeInterpolatedSnapshots<Type>;
+	AddVariable(pMetadata, variable);
+
 	// Succeeded
 	return true;
 }
@@ -166,6 +206,35 @@ bool EntityManager::SetVariable( const Uint16 p_EntityId, const std::string & p_
 	return true;
 }
 
+// Function for taking the snapshots of a variable
+template<typename Type>
+void EntityManager::TakeVariableSnapshots(EntityMetaData * p_pMetaData, const VariableMetaData & p_Variable, const Time & p_Time)
+{
+	// Get the varaible pointer
+	Variable<Type> Entity::* pVariable = reinterpret_cast<Variable<Type> Entity::*>(p_Variable.pVariable);
+
+	for (EntityLinkVector::iterator it = p_pMetaData->SlotEntities.begin(); it != p_pMetaData->SlotEntities.end(); it++)
+	{
+		((*it)->pEntity->*pVariable).Variable<Type>::TakeSnapshot(p_Time, m_InterpolationTime, m_ExtrapolationTime);
+	}
+}
+
+// Function for interpolating a variable
+template<typename Type>
+void EntityManager::TakeInterpolatedSnapshots(EntityMetaData * p_pMetaData, const VariableMetaData & p_Variable, const Time & p_Time)
+{
+	// Get the varaible pointer
+	InterpolatedVariable<Type> Entity::* pVariable = reinterpret_cast<InterpolatedVariable<Type> Entity::*>(p_Variable.pVariable);
+
+	// Add the values to interpolate between of all the entities, then interpolate them at once.
+	m_InterpolationBatch.Clear(sizeof(Type) / sizeof(Float32), m_InterpolationMode);
+	for (EntityLinkVector::iterator it = p_pMetaData->SlotEntities.begin(); it != p_pMetaData->SlotEntities.end(); it++)
+	{
+		((*it)->pEntity->*pVariable).Sample(p_Time, m_ExtrapolationTime, m_InterpolationBatch);
+	}
+	m_InterpolationBatch.Evaluate();
+}
+
 template<typename T>
 void * EntityManager::CreateSingleEntityMessage(	const std::string & p_Class,
 													const std::string & p_Variable,
@@ -51,7 +51,7 @@ namespace Bit
 			///
 			////////////////////////////////////////////////////////////////
 			HostMessageDecoder(	const std::string & p_Name,
-								Uint8 *				p_pMessage,
+								const Uint8 *			p_pMessage,
 								SizeType			p_MessageSize );
 
 			////////////////////////////////////////////////////////////////
@@ -114,10 +114,10 @@ namespace Bit
 
 
 			// Private variables.
-			std::string m_Name;			///< Message name.
-			SizeType	m_Position;		///< Current position in message
-			Uint8 *		m_pMessage;		///< Pointer to message.
-			SizeType	m_MessageSize;	///< Size of the message.
+			const std::string &		m_Name;			///< Message name, owned by the handler table.
+			SizeType				m_Position;		///< Current position in message
+			const Uint8 *			m_pMessage;		///< Pointer to message, in the receive buffer.
+			SizeType				m_MessageSize;	///< Size of the message.
 
 		};
 
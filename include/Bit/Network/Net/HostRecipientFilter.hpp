@@ -71,6 +71,8 @@ namespace Bit
 			////////////////////////////////////////////////////////////////
 			/// \brief Set reliable filter to true.
 			///
+			/// The message is sent reliable and unordered, not on any channel.
+			///
 			////////////////////////////////////////////////////////////////
 			void MakeReliable( );
 
@@ -86,6 +88,25 @@ namespace Bit
 			////////////////////////////////////////////////////////////////
 			Bool IsReliable( ) const;
 
+			////////////////////////////////////////////////////////////////
+			/// \brief Send the message on a channel.
+			///
+			/// The delivery type of the channel, set by Server::SetChannel,
+			/// replaces the reliable flag.
+			///
+			/// \param p_Channel Channel index, less than MaxChannelCount.
+			///
+			////////////////////////////////////////////////////////////////
+			void SetChannel( const Uint8 p_Channel );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the channel of the message.
+			///
+			/// \return Channel index, -1 if the message is sent by the reliable flag.
+			///
+			////////////////////////////////////////////////////////////////
+			Int32 GetChannel( ) const;
+
 		private:
 
 			////////////////////////////////////////////////////////////////
@@ -101,6 +122,7 @@ namespace Bit
 			Server *	m_pServer;	///< Server pointer.
 			UserSet		m_Users;	///< Set of all the users
 			bool		m_Reliable;	///< Reliable flag.
+			Int32		m_Channel;	///< Channel index, -1 if not sent on a channel.
 
 
 		};
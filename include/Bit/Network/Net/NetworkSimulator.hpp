@@ -0,0 +1,190 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_NETWORK_SIMULATOR_HPP
+#define BIT_NETWORK_NET_NETWORK_SIMULATOR_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/Network/UdpSocket.hpp>
+#include <Bit/System/Thread.hpp>
+#include <Bit/System/ThreadValue.hpp>
+#include <Bit/System/Randomizer.hpp>
+#include <Bit/System/Timer.hpp>
+#include <map>
+#include <vector>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \ingroup Network
+		/// \brief Network simulator, relaying the traffic of a client and a server.
+		///
+		/// Connect the client to the port of the simulator instead of the server,
+		/// and the packets are forwarded in both directions with injected delay, jitter and loss.
+		/// Used for testing the connections on a loopback interface,
+		/// without any network emulation of the operating system.
+		/// The traffic of a single client is relayed.
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API NetworkSimulator
+		{
+
+		public:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Settings of the simulated network.
+			///
+			////////////////////////////////////////////////////////////////
+			class Settings
+			{
+
+			public:
+
+				////////////////////////////////////////////////////////////////
+				/// \brief Constructor.
+				///
+				/// \param p_Delay One way delay of the packets, in both directions.
+				/// \param p_Jitter Max random deviation from the delay, packets may be reordered.
+				/// \param p_Loss Probability of losing a packet, between 0 and 1.
+				///
+				////////////////////////////////////////////////////////////////
+				Settings(	const Time & p_Delay = Microseconds( 0 ),
+							const Time & p_Jitter = Microseconds( 0 ),
+							const Float32 p_Loss = 0.0f );
+
+				// Public variables
+				Time		Delay;
+				Time		Jitter;
+				Float32		Loss;
+
+			};
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Default constructor.
+			///
+			////////////////////////////////////////////////////////////////
+			NetworkSimulator( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Destructor.
+			///
+			////////////////////////////////////////////////////////////////
+			~NetworkSimulator( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Start relaying packets.
+			///
+			/// \param p_Port Port of the simulator, for the client to connect to.
+			/// \param p_ServerAddress Address of the server.
+			/// \param p_ServerPort Port of the server.
+			/// \param p_Settings Settings of the simulated network.
+			/// \param p_Seed Seed of the random loss and jitter, for reproducible runs.
+			///
+			/// \return True if succeeded, else false.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool Start(	const Uint16 p_Port,
+						const Address & p_ServerAddress,
+						const Uint16 p_ServerPort,
+						const Settings & p_Settings = Settings( ),
+						const Uint32 p_Seed = 0 );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Stop relaying packets, the delayed packets are dropped.
+			///
+			////////////////////////////////////////////////////////////////
+			void Stop( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Change the settings of the simulated network while running.
+			///
+			////////////////////////////////////////////////////////////////
+			void SetSettings( const Settings & p_Settings );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the number of forwarded packets.
+			///
+			////////////////////////////////////////////////////////////////
+			Uint64 GetForwardedCount( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the number of lost packets.
+			///
+			////////////////////////////////////////////////////////////////
+			Uint64 GetLostCount( );
+
+		private:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Packet waiting for its delivery time.
+			///
+			////////////////////////////////////////////////////////////////
+			struct DelayedPacket
+			{
+				Bool				ToServer;	///< Flag for checking if the packet is sent to the server or to the client.
+				std::vector<Uint8>	Data;		///< Packet data.
+			};
+
+			// Private typedefs
+			typedef std::multimap<Uint64, DelayedPacket> DelayedPacketMap;
+
+			// Private functions
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Add a received packet to the delayed packets, unless it's lost.
+			///
+			////////////////////////////////////////////////////////////////
+			void AddPacket( const Uint8 * p_pData, const SizeType p_DataSize, const Bool p_ToServer );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Send the delayed packets up to their delivery time.
+			///
+			////////////////////////////////////////////////////////////////
+			void SendPackets( );
+
+			// Private variables
+			Thread					m_Thread;			///< Thread relaying the packets.
+			UdpSocket				m_Socket;			///< Socket of the simulator.
+			ThreadValue<Bool>		m_Running;			///< Flag for checking if the simulator is running.
+			ThreadValue<Settings>	m_Settings;			///< Settings of the simulated network.
+			Address					m_ServerAddress;	///< Address of the server.
+			Uint16					m_ServerPort;		///< Port of the server.
+			Address					m_ClientAddress;	///< Address of the client, known from its first packet.
+			Uint16					m_ClientPort;		///< Port of the client, 0 until its first packet.
+			Randomizer				m_Randomizer;		///< Randomizer of the loss and jitter.
+			Timer					m_Timer;			///< Clock of the delivery times.
+			DelayedPacketMap		m_DelayedPackets;	///< Delayed packets, ordered by delivery time in microseconds.
+			ThreadValue<Uint64>		m_ForwardedCount;	///< Number of forwarded packets.
+			ThreadValue<Uint64>		m_LostCount;		///< Number of lost packets.
+
+		};
+
+	}
+
+}
+
+#endif
@@ -0,0 +1,166 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_CONGESTION_CONTROLLER_HPP
+#define BIT_NETWORK_NET_CONGESTION_CONTROLLER_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/System/Timer.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \brief	Send rate limiter and congestion controller of a connection.
+		///
+		/// The outgoing traffic is paced by a token bucket, refilled at the send rate.
+		/// With congestion control enabled, the send rate is adapted every sample interval:
+		/// increased while the limiter holds traffic back without any loss,
+		/// and decreased at loss, but not far below the rate the acknowledgements
+		/// show that the connection delivers.
+		/// The loss rate and the delivery rate are estimated even without any limit.
+		///
+		/// The class is not thread safe, protect it with a mutex.
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API CongestionController
+		{
+
+		public:
+
+			// Public constants
+			static const Uint32	MinSendRate			= 16384;		///< Lowest send rate of the congestion control, in bytes per second.
+			static const Uint32	InitialSendRate		= 131072;		///< Initial send rate of the congestion control, in bytes per second.
+			static const Uint32	MaxAdaptiveSendRate	= 104857600;	///< Highest send rate of the congestion control without a max send rate.
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Default constructor, the traffic is not limited.
+			///
+			////////////////////////////////////////////////////////////////
+			CongestionController( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Reset the controller.
+			///
+			/// \param p_CongestionControl Adapt the send rate to the loss of the connection.
+			/// \param p_MaxSendRate Max send rate in bytes per second, 0 for no limit.
+			///
+			////////////////////////////////////////////////////////////////
+			void Reset( const Bool p_CongestionControl, const Uint32 p_MaxSendRate );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Consume send budget for a packet.
+			///
+			/// \param p_Size Size of the packet.
+			/// \param p_Force Consume the budget even if there isn't enough of it,
+			///			for packets that must be sent right away.
+			///
+			/// \return True if the packet can be sent, else false.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool Consume( const SizeType p_Size, const Bool p_Force );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Add an acknowledged packet to the delivery rate estimation.
+			///
+			////////////////////////////////////////////////////////////////
+			void OnAcknowledgement( const SizeType p_Size );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Add a lost packet, resent after a timeout.
+			///
+			////////////////////////////////////////////////////////////////
+			void OnLoss( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the send rate in bytes per second, 0 if there's no limit.
+			///
+			////////////////////////////////////////////////////////////////
+			Uint32 GetSendRate( ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the estimated delivery rate in bytes per second.
+			///
+			////////////////////////////////////////////////////////////////
+			Uint32 GetDeliveryRate( ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the recent packet loss, between 0 and 1.
+			///
+			////////////////////////////////////////////////////////////////
+			Float32 GetLoss( ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the number of packets that consumed send budget.
+			///
+			////////////////////////////////////////////////////////////////
+			Uint64 GetPacketsSent( ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the number of lost packets.
+			///
+			////////////////////////////////////////////////////////////////
+			Uint64 GetPacketsLost( ) const;
+
+		private:
+
+			// Private functions
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Refill the token bucket, and adapt the send rate at the end of the sample interval.
+			///
+			////////////////////////////////////////////////////////////////
+			void Update( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the size of the token bucket.
+			///
+			////////////////////////////////////////////////////////////////
+			Float64 GetBurst( ) const;
+
+			// Private variables
+			Timer		m_Timer;			///< Clock of the controller.
+			Bool		m_Adaptive;			///< Flag for checking if the congestion control is enabled.
+			Float64		m_MaxSendRate;		///< Upper bound of the send rate, 0 for no limit.
+			Float64		m_SendRate;			///< Current send rate in bytes per second, 0 for no limit.
+			Float64		m_Tokens;			///< Send budget in bytes, negative if forced packets overdrew it.
+			Uint64		m_LastUpdate;		///< Time of the last refill in microseconds.
+			Uint64		m_SampleStart;		///< Start of the sample interval in microseconds.
+			Uint64		m_AckedBytes;		///< Acknowledged bytes in the sample interval.
+			Bool		m_SampleLoss;		///< Flag for checking if any packet is lost in the sample interval.
+			Bool		m_SampleLimited;	///< Flag for checking if the limiter held back any packet in the sample interval.
+			Float64		m_DeliveryRate;		///< Smoothed delivery rate in bytes per second.
+			Float64		m_Loss;				///< Smoothed packet loss.
+			Uint64		m_PacketsSent;		///< Number of packets that consumed send budget.
+			Uint64		m_PacketsLost;		///< Number of lost packets.
+
+		};
+
+	}
+
+}
+
+#endif
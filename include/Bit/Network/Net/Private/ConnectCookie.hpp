@@ -0,0 +1,100 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_CONNECT_COOKIE_HPP
+#define BIT_NETWORK_NET_CONNECT_COOKIE_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/System/Time.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \brief	Stateless cookies of the connect handshake.
+		///
+		/// The server answers connect packets with a challenge holding a cookie,
+		/// a SipHash-2-4 of the client's address, port and the current time window,
+		/// keyed by a random secret. Only clients echoing a valid cookie get a connection,
+		/// so connect floods from spoofed addresses do not cost any state on the server.
+		/// A cookie is valid for the window it was created in and the next one.
+		///
+		/// Creating and verifying cookies is thread safe, generating the secret is not.
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API ConnectCookie
+		{
+
+		public:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Default constructor, generating a secret.
+			///
+			////////////////////////////////////////////////////////////////
+			ConnectCookie( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Generate a new random secret, invalidating all the cookies.
+			///
+			////////////////////////////////////////////////////////////////
+			void GenerateSecret( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Create the cookie of a client.
+			///
+			/// \param p_Address Address of the client.
+			/// \param p_Port Port of the client.
+			/// \param p_Time Current time, of a clock not going backwards.
+			///
+			////////////////////////////////////////////////////////////////
+			Uint64 Create( const Uint32 p_Address, const Uint16 p_Port, const Time & p_Time ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Verify the cookie echoed by a client.
+			///
+			/// \return True if the cookie was created for the client, in the current or last time window.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool Verify( const Uint64 p_Cookie, const Uint32 p_Address, const Uint16 p_Port, const Time & p_Time ) const;
+
+		private:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Create the cookie of a client in a time window.
+			///
+			////////////////////////////////////////////////////////////////
+			Uint64 Create( const Uint32 p_Address, const Uint16 p_Port, const Uint64 p_Window ) const;
+
+			// Private variables
+			Uint64	m_Secret[ 2 ];	///< 128 bit secret key.
+
+		};
+
+	}
+
+}
+
+#endif
@@ -27,15 +27,26 @@
 #include <Bit/Build.hpp>
 #include <Bit/Network/Net/Private/NetPacket.hpp>
 #include <Bit/Network/Net/Private/SequenceManager.hpp>
+#include <Bit/Network/Net/Private/ConnectionWorkerPool.hpp>
+#include <Bit/Network/Net/Private/PacketBuffer.hpp>
+#include <Bit/Network/Net/Private/FragmentAssembler.hpp>
+#include <Bit/Network/Net/Private/PacketBuilder.hpp>
+#include <Bit/Network/Net/Private/SequenceRing.hpp>
+#include <Bit/Network/Net/Private/RttEstimator.hpp>
+#include <Bit/Network/Net/Private/CongestionController.hpp>
+#include <Bit/Network/Net/Private/EntityInterest.hpp>
+#include <Bit/Network/Net/Private/MessageTable.hpp>
+#include <Bit/Network/Net/Private/MessageChannels.hpp>
+#include <Bit/Network/Net/Private/ReceiveShard.hpp>
+#include <Bit/Network/Net/Private/PacketCompressor.hpp>
+#include <Bit/Network/Net/ConnectionStatistics.hpp>
 #include <Bit/Network/UdpSocket.hpp>
-#include <Bit/System/MemoryPool.hpp>
+#include <Bit/System/ConcurrentMemoryPool.hpp>
 #include <Bit/System/Thread.hpp>
 #include <Bit/System/ThreadValue.hpp>
 #include <Bit/System/Semaphore.hpp>
 #include <Bit/System/Timer.hpp>
 #include <queue>
-#include <map>
-#include <list>
 #include <set>
 
 namespace Bit
@@ -44,6 +55,9 @@ namespace Bit
 	namespace Net
 	{
 
+		// Forward declarations
+		class Server;
+
 		////////////////////////////////////////////////////////////////
 		/// \brief	Connection class.
 		///
@@ -58,6 +72,7 @@ namespace Bit
 			friend class EntityManager;
 			friend class HostMessage;
 			friend class Event;
+			friend class ConnectionWorkerPool;
 
 			// Public typdefs
 			typedef std::set<Uint32> GroupSet;
@@ -65,12 +80,17 @@ namespace Bit
 			////////////////////////////////////////////////////////////////
 			/// \brief Default constructor.
 			///
+			/// \param p_pReassemblyBudget Reassembly buffer budget shared by the connections of the server.
+			///
 			////////////////////////////////////////////////////////////////
 			Connection(	const Address & p_Address, 
 						const Uint16 & p_Port,
 						const Uint16 & p_UserId,
 						const Bool	p_SendEntityMessages,
 						const Time & p_LosingConnectionTimeout,
+						FragmentAssembler::Budget * p_pReassemblyBudget,
+						const Bool p_CongestionControl = false,
+						const Uint32 p_MaxSendRate = 0,
 						const Time & p_InitialPing = Microseconds( 200000 ) );
 		
 			////////////////////////////////////////////////////////////////
@@ -91,6 +111,12 @@ namespace Bit
 			////////////////////////////////////////////////////////////////
 			Time GetPing( );
 
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the statistics of the connection.
+			///
+			////////////////////////////////////////////////////////////////
+			ConnectionStatistics GetStatistics( );
+
 			////////////////////////////////////////////////////////////////
 			/// \brief Get the user id
 			///
@@ -109,12 +135,6 @@ namespace Bit
 			////////////////////////////////////////////////////////////////
 			Uint16 GetPort( ) const;
 
-			////////////////////////////////////////////////////////////////
-			/// \brief Get the packed address (ip * port + port )
-			///
-			////////////////////////////////////////////////////////////////
-			Uint64 GetPackedAddress( ) const;
-
 			////////////////////////////////////////////////////////////////
 			/// \brief Add entity to group.
 			///
@@ -132,17 +152,18 @@ namespace Bit
 			// Private structs
 
 			////////////////////////////////////////////////////////////////
-			/// \brief Received data structure
+			/// \brief Received user message structure.
+			///
+			/// The message is decoded directly from the pooled packet,
+			/// the packet is returned to the pool after its last message is handled.
 			///
 			////////////////////////////////////////////////////////////////
 			struct ReceivedData
 			{
-				ReceivedData( Uint8 * p_pData, const SizeType p_DataSize, const Uint16 p_Sequence );
-				~ReceivedData( );
-
-				Uint16		Sequence;
-				Uint8 *		pData;
-				SizeType	DataSize;
+				ConcurrentMemoryPool<Uint8>::Item *	pItem;		///< Packet to return after handling the message, NULL if not the last message of the packet.
+				const Uint8 *				pData;		///< Pointer to the message, in the packet or owned.
+				SizeType					DataSize;	///< Size of the message.
+				Bool						Owned;		///< Flag for checking if the message is a copy, deleted after handling it.
 			};
 
 			////////////////////////////////////////////////////////////////
@@ -152,41 +173,106 @@ namespace Bit
 			////////////////////////////////////////////////////////////////
 			struct ReliablePacket
 			{
-				Uint16		Sequence;
-				Uint8 *		pData;
-				SizeType	DataSize;
-				Timer		SendTimer;
-				Timer		ResendTimer;
-				Bool		Resent;
+				Uint16			Sequence;
+				Uint8			Header[ FragmentPacketSize ];	///< Packet type, sequence, reliable flag and fragment header.
+				SizeType		HeaderSize;
+				PacketBuffer *	pPayload;		///< Payload, possibly shared with other connections. NULL if empty.
+				SizeType		PayloadOffset;	///< Offset of the data to send in the payload.
+				SizeType		PayloadSize;	///< Size of the data to send in the payload.
+				Timer			SendTimer;
+				Uint32			Resends;		///< Number of times the packet is resent.
+			};
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Structure for reliable messages too large for a single packet,
+			///			waiting for their fragments to be sent.
+			///
+			////////////////////////////////////////////////////////////////
+			struct FragmentedMessage
+			{
+				PacketType::eType	Type;			///< Packet type of the message.
+				PacketBuffer *		pPayload;		///< Payload of the message.
+				Uint16				MessageId;		///< Id of the message.
+				Uint16				NextFragment;	///< Index of the next fragment to send.
+				Uint16				FragmentCount;	///< Number of fragments.
 			};
 
 			// Private  typedefs
 			//typedef std::queue<ReceivedData*>	ReceivedDataQueue;
-			typedef std::queue<MemoryPool<Uint8>::Item*>	ReceiveDataQueue;
-			typedef std::map<Uint16, ReliablePacket*>		ReliablePacketMap;
-			typedef std::pair<Uint16, ReliablePacket*>		ReliablePacketPair;
-			typedef std::list<Time>							TimeList;
-			typedef std::queue<ReceivedData*>				ReceivedDataQueue;
+			typedef std::queue<ConcurrentMemoryPool<Uint8>::Item*>	ReceiveDataQueue;
+			typedef SequenceRing<ReliablePacket>			ReliablePacketRing;
+			typedef std::queue<ReceivedData>				ReceivedDataQueue;
+			typedef std::vector<ReceivedData>				ReceivedDataVector;
+			typedef std::queue<FragmentedMessage>			FragmentedMessageQueue;
 
 			// Private functions
 
 			////////////////////////////////////////////////////////////////
 			/// \brief Start the threads
 			///
+			/// \param p_pServer Pointer to the server.
+			/// \param p_pShard Receive shard owning the connection, packets are sent by its socket.
+			/// \param p_pWorkerPool	Worker pool driving the connection.
+			///						The connection starts its own threads if NULL.
+			///
+			////////////////////////////////////////////////////////////////
+			void StartThreads( Server * p_pServer, ReceiveShard * p_pShard, ConnectionWorkerPool * p_pWorkerPool = NULL );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Handle a raw packet and return it to the server's memory pool.
+			///
+			////////////////////////////////////////////////////////////////
+			void HandleReceivedData( ConcurrentMemoryPool<Uint8>::Item * p_pItem );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Handle a single packet, or the packets of a coalesced packet.
+			///
+			////////////////////////////////////////////////////////////////
+			void HandlePacket( Uint8 * p_pData, const SizeType p_DataSize );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Call the user message listeners.
+			///
+			////////////////////////////////////////////////////////////////
+			void HandleUserMessage( const Uint8 * p_pData, const SizeType p_DataSize );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Delete the data of a handled user message, and return its packet to the pool.
+			///
+			////////////////////////////////////////////////////////////////
+			void ReleaseUserMessage( ReceivedData & p_ReceivedData );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Check the connection timeout and send alive packets if needed.
+			///
+			/// \return False if the connection timed out, else true.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool CheckConnectionEvents( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Resend the reliable packets not acknowledged in time.
+			///
 			////////////////////////////////////////////////////////////////
-			void StartThreads( Server * p_pServer );
+			void CheckReliablePackets( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Tick task executed by the worker pool.
+			///
+			////////////////////////////////////////////////////////////////
+			void HandleTick( );
 
 			////////////////////////////////////////////////////////////////
 			/// \brief Add raw packet to queue.
 			///
 			////////////////////////////////////////////////////////////////
-			void AddReceivedData( MemoryPool<Uint8>::Item * p_pItem );
+			void AddReceivedData( ConcurrentMemoryPool<Uint8>::Item * p_pItem );
 
 			////////////////////////////////////////////////////////////////
 			/// \brief Poll raw packet from queue.
 			///
 			////////////////////////////////////////////////////////////////
-			MemoryPool<Uint8>::Item * PollReceivedData();
+			ConcurrentMemoryPool<Uint8>::Item * PollReceivedData();
 
 			////////////////////////////////////////////////////////////////
 			/// \brief Get the time since last received packet, including heartbeats.
@@ -216,6 +302,54 @@ namespace Bit
 								bool p_AddSequence,
 								const bool p_AddReliableFlag);
 
+			////////////////////////////////////////////////////////////////
+			/// \brief Create a reliable packet and add it to the reliable packet ring, without sending it.
+			///
+			/// \param p_pPayload	Shared payload, a reference is added and released at acknowledgement.
+			///						NULL for packets without any payload.
+			/// \param p_pFragmentedMessage	Create a packet of the next fragment of the message if not NULL.
+			///
+			/// \return Pointer to the reliable packet, owned by the reliable packet ring.
+			///			NULL if the whole sequence space is waiting for acknowledgement,
+			///			the connection is then failed and disconnected at the next event check.
+			///
+			////////////////////////////////////////////////////////////////
+			ReliablePacket * CreateReliablePacket(	const PacketType::eType p_PacketType,
+													PacketBuffer * p_pPayload,
+													const bool p_AddReliableFlag,
+													const FragmentedMessage * p_pFragmentedMessage = NULL);
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Fill a datagram with the header and payload of a reliable packet.
+			///
+			////////////////////////////////////////////////////////////////
+			void SetDatagram( const ReliablePacket * p_pPacket, UdpSocket::Datagram & p_Datagram ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Release the payload of a reliable packet.
+			///
+			////////////////////////////////////////////////////////////////
+			static void ReleaseReliablePacket( ReliablePacket & p_Packet );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the time to wait for an acknowledgement before resending a reliable packet.
+			///
+			/// \param p_Resends Number of times the packet is resent.
+			///
+			////////////////////////////////////////////////////////////////
+			Time GetResendTime( const Uint32 p_Resends );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Consume send budget of the send rate limit.
+			///
+			/// \param p_Size Size of the packet.
+			/// \param p_Force Send the packet even if it exceeds the send rate.
+			///
+			/// \return True if the packet can be sent, else false.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool ConsumeSendBudget( const SizeType p_Size, const Bool p_Force );
+
 			////////////////////////////////////////////////////////////////
 			/// \brief Send reliable packet to the client.
 			///
@@ -229,16 +363,169 @@ namespace Bit
 								const bool p_AddReliableFlag);
 
 			////////////////////////////////////////////////////////////////
-			/// \brief	Calculate the new ping.
+			/// \brief Send reliable packet with a shared payload to the client.
+			///
+			/// The payload is not copied, a reference is kept until the packet is acknowledged.
+			///
+			////////////////////////////////////////////////////////////////
+			void SendReliable(	const PacketType::eType p_PacketType,
+								PacketBuffer * p_pPayload,
+								const bool p_AddReliableFlag);
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Send the queued fragments, as long as there's room in the fragment window.
+			///
+			////////////////////////////////////////////////////////////////
+			void SendFragments( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Handle a reassembled message.
+			///
+			////////////////////////////////////////////////////////////////
+			void HandleFragmentedMessage( const Uint8 p_MessageType, std::vector<Uint8> & p_Message );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the sequence of the next packet, and increment it.
+			///
+			////////////////////////////////////////////////////////////////
+			Uint16 GetNextSequence( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the last entity snapshot acknowledged by the client.
+			///
+			/// \return Id of the snapshot, -1 if the client hasn't acknowledged any snapshot.
+			///
+			////////////////////////////////////////////////////////////////
+			Int32 GetAckedSnapshot( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Set the last entity snapshot acknowledged by the client.
+			///
+			/// \param p_SnapshotId Id of the snapshot, -1 to send the next snapshot in full.
+			///
+			////////////////////////////////////////////////////////////////
+			void SetAckedSnapshot( const Int32 p_SnapshotId );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Set the view of the client, for the entity interest management.
+			///
+			////////////////////////////////////////////////////////////////
+			void SetEntityView( const EntityInterest::View & p_View );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the view of the client.
+			///
+			////////////////////////////////////////////////////////////////
+			EntityInterest::View GetEntityView( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the entity interest management state,
+			///			only accessed by the entity thread of the server.
+			///
+			////////////////////////////////////////////////////////////////
+			EntityInterest & GetEntityInterest( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Compress the payload of a message by the compression negotiated with the client.
+			///
+			/// Called with the connection mutex of the server locked.
+			///
+			/// \param p_Message Message to compress, replaced by the compressed message.
+			/// \param p_HeaderSize Size of the header preceding the payload, not compressed.
+			///
+			/// \return True if the payload is compressed, false if the client doesn't support compression,
+			///			the payload is smaller than the compression threshold or not smaller compressed.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool CompressMessage( std::vector<Uint8> & p_Message, const SizeType p_HeaderSize );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the compression negotiated with the client.
+			///
+			////////////////////////////////////////////////////////////////
+			CompressionType::eType GetCompression( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Remove an acknowledged packet from the reliable packet ring.
+			///
+			////////////////////////////////////////////////////////////////
+			void HandleAcknowledgement( const Uint16 p_Sequence );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Acknowledge a received reliable packet,
+			///			via the acknowledgement header of the next coalesced packet.
+			///
+			////////////////////////////////////////////////////////////////
+			void AcknowledgePacket( const Uint16 p_Sequence );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Add a packet to the coalesced packet, sent at the next tick.
+			///
+			/// \return False if the packet is too large to be coalesced, send it on its own.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool QueuePacket(	const Uint8 * p_pHeader,
+								const SizeType p_HeaderSize,
+								const Uint8 * p_pData,
+								const SizeType p_DataSize );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Send the coalesced packets and the pending acknowledgements.
+			///
+			////////////////////////////////////////////////////////////////
+			void FlushPackets( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Flush the packet builder and send the coalesced packet.
+			///			The packet builder mutex has to be locked.
+			///
+			////////////////////////////////////////////////////////////////
+			void SendCoalescedPacket( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Restart the timer for the last sent packet.
+			///
+			////////////////////////////////////////////////////////////////
+			void RestartSendTimer( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Add a round trip time sample to the round trip time estimation.
 			///
 			////////////////////////////////////////////////////////////////
 			void CalculateNewPing( const Time & p_LapsedTime );
 
+			////////////////////////////////////////////////////////////////
+			/// \brief	Pass a received user message through its channel.
+			///
+			/// Adds the message if it's its turn, followed by the buffered messages waiting for it.
+			///
+			/// \param p_Copy Copy the message, the data is not in the pooled packet.
+			///
+			////////////////////////////////////////////////////////////////
+			void ReceiveUserMessage( const Uint8 * p_pData, const SizeType p_DataSize, const Bool p_Copy );
+
 			////////////////////////////////////////////////////////////////
 			/// \brief	Function for adding user messages to the function caller queue.
 			///
+			/// The messages are pending until the packet is handled,
+			/// the worker pool handles them at once instead.
+			///
+			/// \param p_pData Pointer to the message.
+			/// \param p_DataSize Size of the message.
+			/// \param p_Copy Copy the message, the data is not in the pooled packet.
+			///
+			////////////////////////////////////////////////////////////////
+			void AddUserMessage( const Uint8 * p_pData, const SizeType p_DataSize, const Bool p_Copy );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Add the pending user messages to the function caller queue.
+			///
+			/// \param p_pItem Packet of the messages, returned to the pool after the last one is handled.
+			///
+			/// \return False if there are no pending messages, return the packet to the pool.
+			///
 			////////////////////////////////////////////////////////////////
-			void AddUserMessage( ReceivedData * p_ReceivedData );
+			Bool AddPendingUserMessages( ConcurrentMemoryPool<Uint8>::Item * p_pItem );
 
 			// Private variables
 			Thread							m_Thread;					///< Thread for handling raw packets.
@@ -246,6 +533,7 @@ namespace Bit
 			Thread							m_EventThread;				///< Thread for creating specific events.
 			Thread							m_ReliableThread;			///< Thread for checking reliable packets for resend.
 			Server *						m_pServer;					///< Pointer to the server.
+			ReceiveShard *					m_pShard;					///< Receive shard owning the connection.
 			const Address					m_Address;					///< The clients's address.
 			const Uint16					m_Port;						///< The client's port.
 			const Uint16					m_UserId;					///< The client's user id.
@@ -257,13 +545,39 @@ namespace Bit
 			ThreadValue<Timer>				m_LastSendTimer;			///< Time for checking when the last sent packet.
 			ThreadValue<Uint16>				m_Sequence;					///< The sequence of the next packet being sent.
 			SequenceManager					m_SequenceManager;			///< Sequence manager.
-			ThreadValue<ReliablePacketMap>	m_ReliableMap;				///< Map of reliable packets.
-			ThreadValue<Time>				m_Ping;						///< Current network ping.
+			ThreadValue<ReliablePacketRing>	m_ReliablePackets;			///< Ring of reliable packets waiting for acknowledgement.
+			std::atomic<Bool>				m_ReliableRingFull;			///< Flag for checking if a reliable packet could not be added to the ring.
+			Timer							m_ReliableTimer;			///< Clock of the resend deadlines, protected by the reliable packet mutex.
+			std::vector<UdpSocket::Datagram>	m_ResendDatagrams;		///< Datagrams of the packets to resend, protected by the reliable packet mutex.
+			ThreadValue<RttEstimator>		m_Rtt;						///< Round trip time estimation.
+			ThreadValue<CongestionController>	m_Congestion;			///< Send rate limit and congestion control.
 			Time							m_LosingConnectionTimeout;	///< Ammount of time without any packets before losing the connection.
-			TimeList						m_PingList;					///< List of the last pings.
 			ThreadValue<ReceivedDataQueue>	m_UserMessages;				///< Queue of user messages.
+			ReceivedDataVector				m_PendingUserMessages;		///< User messages of the packet being handled.
+			ThreadValue<MessageTable>		m_HostMessageIds;			///< Ids of the host messages, given by the client.
+			ThreadValue<MessageChannels>	m_Channels;					///< Message channels, the delivery types are set by the server.
+			std::atomic<Bool>				m_ChannelsFull;				///< Flag for checking if a message could not be added to the reorder buffers.
+			ThreadValue<CompressionType::eType>	m_Compression;			///< Compression of the payloads, negotiated with the client.
+			std::vector<Uint8>				m_CompressionBuffer;		///< Buffer of the compressed messages, protected by the connection mutex of the server.
 			Semaphore						m_UserMessageSemaphore;		///< Semaphore for executing user message listeners.
 			ThreadValue<GroupSet>			m_Groups;					///< Set of entity groups.
+			ThreadValue<Int32>				m_AckedSnapshot;			///< Last entity snapshot acknowledged by the client, -1 if none.
+			ThreadValue<EntityInterest::View>	m_EntityView;			///< View of the client, for the entity interest management.
+			EntityInterest					m_EntityInterest;			///< Entity versions of the sent snapshots, only accessed by the entity thread.
+			ThreadValue<FragmentedMessageQueue>	m_FragmentedMessages;	///< Queue of fragmented messages being sent.
+			Uint16							m_NextMessageId;			///< Id of the next fragmented message, protected by the fragmented message mutex.
+			std::atomic<Uint32>				m_FragmentsInFlight;		///< Number of sent fragments not yet acknowledged.
+			FragmentAssembler				m_FragmentAssembler;		///< Reassembly of the received fragmented messages.
+			ThreadValue<PacketBuilder>		m_PacketBuilder;			///< Builder of the coalesced packets.
+			std::vector<Uint8>				m_CoalescedPacket;			///< Coalesced packet being sent, protected by the packet builder mutex.
+			ConnectionWorkerPool *			m_pWorkerPool;				///< Worker pool driving the connection, NULL if running its own threads.
+			ConnectionWorkerPool::TaskQueue	m_Tasks;					///< Queue of tasks executed by the worker pool.
+			std::atomic<Uint32>				m_PendingTasks;				///< Number of posted tasks not yet executed.
+			std::atomic<Bool>				m_TickPending;				///< Flag for checking if the tick task is posted.
+			ConnectionWorkerPool::Task		m_TickTask;					///< Tick task, reused for every tick.
+			ConnectionWorkerPool::Task		m_RemoveTask;				///< Remove task, posted when the connection is removed from the pool.
+			ConnectionWorkerPool::Task		m_ScheduleTask;				///< Schedule task, queued in a ready queue of the pool.
+			Timer							m_EventTimer;				///< Timer for checking the connection events in the worker pool.
 
 		};
 
@@ -0,0 +1,148 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_CONNECTION_TABLE_HPP
+#define BIT_NETWORK_NET_CONNECTION_TABLE_HPP
+
+#include <Bit/Build.hpp>
+#include <vector>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		// Forward declarations
+		class Connection;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief	Hash table of connections via their address and port.
+		///
+		/// Open addressing with linear probing, keyed on the full (address, port) tuple.
+		/// The table is kept at most half full, and removed entries are
+		/// backward shifted instead of leaving tombstones, keeping the probes short.
+		///
+		/// The class is not thread safe, protect it with a mutex.
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API ConnectionTable
+		{
+
+		public:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Default constructor.
+			///
+			////////////////////////////////////////////////////////////////
+			ConnectionTable( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Reserve space for a number of connections,
+			///		   avoiding rehashing while adding them.
+			///
+			////////////////////////////////////////////////////////////////
+			void Reserve( const SizeType p_Count );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Find a connection.
+			///
+			/// \return Pointer to the connection, NULL if not found.
+			///
+			////////////////////////////////////////////////////////////////
+			Connection * Find( const Uint32 p_Address, const Uint16 p_Port ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Add a connection.
+			///
+			/// \return False if there already is a connection of the address and port.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool Add( const Uint32 p_Address, const Uint16 p_Port, Connection * p_pConnection );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Remove a connection.
+			///
+			/// \return False if not found.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool Remove( const Uint32 p_Address, const Uint16 p_Port );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the number of connections in the table.
+			///
+			////////////////////////////////////////////////////////////////
+			SizeType GetSize( ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Remove all the connections, keeping the capacity.
+			///
+			////////////////////////////////////////////////////////////////
+			void Clear( );
+
+		private:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Slot of the table, empty if the connection is NULL.
+			///
+			////////////////////////////////////////////////////////////////
+			struct Slot
+			{
+				Uint64			Key;			///< Address in the upper and port in the lower 16 bits.
+				Connection *	pConnection;	///< The connection.
+			};
+
+			// Private typedefs
+			typedef std::vector<Slot> SlotVector;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the key of an address and port.
+			///
+			////////////////////////////////////////////////////////////////
+			static Uint64 GetKey( const Uint32 p_Address, const Uint16 p_Port );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the home slot of a key.
+			///
+			////////////////////////////////////////////////////////////////
+			SizeType GetSlot( const Uint64 p_Key ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Resize the table and reinsert the connections.
+			///
+			/// \param p_Capacity New capacity, power of two.
+			///
+			////////////////////////////////////////////////////////////////
+			void Rehash( const SizeType p_Capacity );
+
+			// Private variables
+			SlotVector	m_Slots;	///< Slots of the table, power of two sized.
+			SizeType	m_Size;		///< Number of connections in the table.
+
+		};
+
+	}
+
+}
+
+#endif
@@ -0,0 +1,282 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_CONNECTION_WORKER_POOL_HPP
+#define BIT_NETWORK_NET_CONNECTION_WORKER_POOL_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/System/ConcurrentMemoryPool.hpp>
+#include <Bit/System/Thread.hpp>
+#include <Bit/System/ThreadValue.hpp>
+#include <Bit/System/Semaphore.hpp>
+#include <Bit/System/ThreadEvent.hpp>
+#include <Bit/System/Mutex.hpp>
+#include <atomic>
+#include <vector>
+#include <set>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		// Forward declarations
+		class Connection;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief	Connection worker pool class.
+		///
+		/// A fixed number of worker threads driving every connection of a server,
+		/// instead of running a set of threads per connection.
+		/// Work items (raw packets and timer ticks) are pushed to a lock-free
+		/// queue owned by the connection. A connection is only handed to one
+		/// worker at the time, which guarantees that the work items of
+		/// a single connection are executed serially and in order.
+		/// Connections with pending work items are scheduled round-robin
+		/// to the lock-free ready queues of the workers.
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API ConnectionWorkerPool
+		{
+
+		public:
+
+			// Public friend classes
+			friend class Connection;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Work item structure.
+			///
+			////////////////////////////////////////////////////////////////
+			struct Task
+			{
+
+				////////////////////////////////////////////////////////////////
+				/// \brief Task type enum
+				///
+				////////////////////////////////////////////////////////////////
+				enum eType
+				{
+					Packet,		///< Handle a received raw packet.
+					Tick,		///< Check timeouts, alive packets and reliable resends.
+					Remove,		///< Hand the connection over to the removing thread.
+					Schedule	///< Connection with pending tasks, queued in a ready queue.
+				};
+
+				Task(	const eType p_Type = Tick,
+						ConcurrentMemoryPool<Uint8>::Item * p_pItem = NULL,
+						Connection * p_pConnection = NULL );
+
+				eType									Type;			///< Type of the task.
+				ConcurrentMemoryPool<Uint8>::Item *		pItem;			///< Raw packet, only used by packet tasks.
+				Connection *							pConnection;	///< Scheduled connection, only used by schedule tasks.
+				ConcurrentMemoryPool<Task>::Item *		pPoolItem;		///< Pool item holding the task, NULL if not pooled.
+				std::atomic<Task *>						pNext;			///< Next task in the queue.
+			};
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Intrusive multi-producer single-consumer task queue.
+			///
+			/// Push is wait-free and can be called by any thread.
+			/// Pop may only be called by the single consumer,
+			/// the worker currently owning the connection or the worker owning the ready queue.
+			/// Pop may return NULL for a short moment while a push is in progress.
+			///
+			////////////////////////////////////////////////////////////////
+			class TaskQueue
+			{
+
+			public:
+
+				////////////////////////////////////////////////////////////////
+				/// \brief Default constructor.
+				///
+				////////////////////////////////////////////////////////////////
+				TaskQueue( );
+
+				////////////////////////////////////////////////////////////////
+				/// \brief Push a task to the back of the queue.
+				///
+				////////////////////////////////////////////////////////////////
+				void Push( Task * p_pTask );
+
+				////////////////////////////////////////////////////////////////
+				/// \brief Pop a task from the front of the queue.
+				///
+				/// \return Pointer to the task, NULL if no task is available.
+				///
+				////////////////////////////////////////////////////////////////
+				Task * Pop( );
+
+			private:
+
+				// Private variables
+				std::atomic<Task *>	m_pHead;	///< Last pushed task, written by producers.
+				Task *				m_pTail;	///< Next task to pop, only touched by the consumer.
+				Task				m_Stub;		///< Stub task, keeps the queue non-empty.
+
+			};
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Default constructor.
+			///
+			////////////////////////////////////////////////////////////////
+			ConnectionWorkerPool( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Destructor.
+			///
+			////////////////////////////////////////////////////////////////
+			~ConnectionWorkerPool( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Start the worker threads.
+			///
+			/// \param p_WorkerCount Number of worker threads.
+			///		The number of hardware threads is used if 0.
+			///
+			/// \return True if succeeded, else false.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool Start( const Uint32 p_WorkerCount = 0 );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Stop the worker threads.
+			///
+			/// Remove all the connections before stopping the pool.
+			///
+			////////////////////////////////////////////////////////////////
+			void Stop( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Check if the pool is running.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool IsRunning( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the number of worker threads.
+			///
+			////////////////////////////////////////////////////////////////
+			Uint32 GetWorkerCount( ) const;
+
+		private:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Worker structure.
+			///
+			////////////////////////////////////////////////////////////////
+			struct Worker
+			{
+				Thread		WorkerThread;	///< Thread executing the scheduled connections.
+				TaskQueue	ReadyQueue;		///< Schedule tasks of the connections handed to this worker.
+				Semaphore	ReadySemaphore;	///< Semaphore for the ready queue.
+			};
+
+			// Private  typedefs
+			typedef std::vector<Worker *>		WorkerVector;
+			typedef std::set<Connection *>		ConnectionSet;
+
+			// Private functions
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Add connection to the pool, start sending tick tasks.
+			///
+			////////////////////////////////////////////////////////////////
+			void Add( Connection * p_pConnection );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Remove connection from the pool.
+			///
+			/// Waits on the remove event until the tasks posted before the call are executed,
+			/// the tasks posted after it are released without being executed.
+			/// Must not be called from a worker thread.
+			///
+			////////////////////////////////////////////////////////////////
+			void Remove( Connection * p_pConnection );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Post a task to the connection, schedule it if it's idle.
+			///
+			////////////////////////////////////////////////////////////////
+			void Post( Connection * p_pConnection, Task * p_pTask );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Post a raw packet to the connection, using a pooled task.
+			///
+			////////////////////////////////////////////////////////////////
+			void PostPacket( Connection * p_pConnection, ConcurrentMemoryPool<Uint8>::Item * p_pItem );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Add the connection to the ready queue of a worker and wake it up.
+			///
+			////////////////////////////////////////////////////////////////
+			void Schedule( Connection * p_pConnection );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Pop the next task of a connection, waiting for an in progress push.
+			///
+			/// The connection must have pending tasks.
+			///
+			////////////////////////////////////////////////////////////////
+			Task * PopTask( Connection * p_pConnection );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Release a task without executing it.
+			///
+			////////////////////////////////////////////////////////////////
+			void ReleaseTask( Connection * p_pConnection, Task * p_pTask );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Release all the pending tasks of an idle or abandoned connection.
+			///
+			/// No worker may execute the connection meanwhile.
+			///
+			////////////////////////////////////////////////////////////////
+			void DrainTasks( Connection * p_pConnection );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Execute tasks of a scheduled connection.
+			///
+			////////////////////////////////////////////////////////////////
+			void ExecuteTasks( Connection * p_pConnection );
+
+			// Private variables
+			WorkerVector					m_Workers;			///< Worker threads and their ready queues.
+			std::atomic<Uint32>				m_NextWorker;		///< Round-robin counter of the scheduled connections.
+			Thread							m_TickThread;		///< Thread posting tick tasks to the connections.
+			ConcurrentMemoryPool<Task>		m_TaskPool;			///< Pool of packet tasks.
+			Mutex							m_RemoveMutex;		///< Serializes the removals, there is one remove event.
+			ThreadEvent						m_RemoveEvent;		///< Event set by a worker reaching a remove task.
+			ThreadValue<ConnectionSet>		m_Connections;		///< Set of connections receiving tick tasks.
+			ThreadValue<Bool>				m_Running;			///< Flag for checking if the pool is running.
+			const SizeType					m_TaskBatchSize;	///< Maximum number of tasks executed before rescheduling.
+
+		};
+
+	}
+
+}
+
+#endif
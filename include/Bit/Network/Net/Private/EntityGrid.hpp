@@ -0,0 +1,178 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_ENTITY_GRID_HPP
+#define BIT_NETWORK_NET_ENTITY_GRID_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/System/Vector3.hpp>
+#include <vector>
+#include <unordered_map>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \brief	Uniform grid of entity positions, used for finding
+		///			the entities within the view of a client.
+		///
+		/// Entities are bucketed by the cell they are in, and are only
+		/// moved between the buckets when they cross a cell border.
+		/// Empty cells are removed, the grid is unbounded.
+		///
+		/// The class is not thread safe, protect it with a mutex.
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API EntityGrid
+		{
+
+		public:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Constructor.
+			///
+			/// \param p_CellSize Size of the cells, preferably about the view radius of the clients.
+			///
+			////////////////////////////////////////////////////////////////
+			EntityGrid( const Float32 p_CellSize = 64.0f );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Set the size of the cells, all the entities are rebucketed.
+			///
+			////////////////////////////////////////////////////////////////
+			void SetCellSize( const Float32 p_CellSize );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the size of the cells.
+			///
+			////////////////////////////////////////////////////////////////
+			Float32 GetCellSize( ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Add an entity to the grid, or move it if already added.
+			///
+			////////////////////////////////////////////////////////////////
+			void Set( const Uint16 p_EntityId, const Vector3f32 & p_Position );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Remove an entity from the grid.
+			///
+			/// \return False if the entity is not in the grid, else true.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool Remove( const Uint16 p_EntityId );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the position of an entity.
+			///
+			/// \return False if the entity is not in the grid, else true.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool GetPosition( const Uint16 p_EntityId, Vector3f32 & p_Position ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Find the entities within a sphere.
+			///
+			/// \param p_Position Center of the sphere.
+			/// \param p_Radius Radius of the sphere.
+			/// \param p_Entities Vector to append the ids of the found entities to, in no particular order.
+			///
+			////////////////////////////////////////////////////////////////
+			void Query( const Vector3f32 & p_Position,
+						const Float32 p_Radius,
+						std::vector<Uint16> & p_Entities ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the number of entities in the grid.
+			///
+			////////////////////////////////////////////////////////////////
+			SizeType GetSize( ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Remove all the entities.
+			///
+			////////////////////////////////////////////////////////////////
+			void Clear( );
+
+		private:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Entity in the grid.
+			///
+			////////////////////////////////////////////////////////////////
+			struct Node
+			{
+				Vector3f32	Position;	///< Position of the entity.
+				Uint64		Cell;		///< Key of the cell the entity is in.
+				Uint32		Index;		///< Index of the entity in the cell.
+				Bool		Used;		///< Flag for checking if the entity is in the grid.
+			};
+
+			// Private typedefs
+			typedef std::vector<Uint16>						EntityVector;	///< Vector of entity ids.
+			typedef std::unordered_map<Uint64, EntityVector>	CellMap;	///< Map of the non-empty cells, cell key as key.
+			typedef std::vector<Node>						NodeVector;		///< Vector of nodes, entity id as index.
+
+			// Private functions
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the cell coordinate of a position component.
+			///
+			////////////////////////////////////////////////////////////////
+			Int32 GetCoordinate( const Float32 p_Value ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the key of a cell, from its coordinates.
+			///
+			////////////////////////////////////////////////////////////////
+			static Uint64 GetCellKey( const Int32 p_X, const Int32 p_Y, const Int32 p_Z );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Add an entity to a cell.
+			///
+			////////////////////////////////////////////////////////////////
+			void AddToCell( const Uint16 p_EntityId, Node & p_Node );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Remove an entity from its cell.
+			///
+			////////////////////////////////////////////////////////////////
+			void RemoveFromCell( const Node & p_Node );
+
+			// Private variables
+			Float32		m_CellSize;		///< Size of the cells.
+			Float32		m_InvCellSize;	///< Inverted size of the cells.
+			NodeVector	m_Nodes;		///< Entities of the grid, entity id as index.
+			CellMap		m_Cells;		///< Non-empty cells.
+			SizeType	m_Size;			///< Number of entities in the grid.
+
+		};
+
+	}
+
+}
+
+#endif
@@ -0,0 +1,147 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_ENTITY_INTEREST_HPP
+#define BIT_NETWORK_NET_ENTITY_INTEREST_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/Network/Net/Private/EntitySnapshot.hpp>
+#include <Bit/System/Vector3.hpp>
+#include <vector>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \brief	Interest management state of a single client.
+		///
+		/// The snapshots sent to a client only contain the entities
+		/// within its view, and the entities of the lowest priority are
+		/// deferred to the upcoming snapshots when a snapshot is full.
+		/// The state the client got of an entity might therefore be older
+		/// than the world snapshot it is acknowledging. For every sent snapshot,
+		/// the versions of the entities the client will hold are recorded,
+		/// in order to delta encode against what the client actually got.
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API EntityInterest
+		{
+
+		public:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	View region of a client.
+			///
+			////////////////////////////////////////////////////////////////
+			struct View
+			{
+				////////////////////////////////////////////////////////////////
+				/// \brief Default constructor, everything is within the view.
+				///
+				////////////////////////////////////////////////////////////////
+				View( );
+
+				////////////////////////////////////////////////////////////////
+				/// \brief Constructor.
+				///
+				/// \param p_Position Center of the view.
+				/// \param p_Radius Radius of the view.
+				///
+				////////////////////////////////////////////////////////////////
+				View( const Vector3f32 & p_Position, const Float32 p_Radius );
+
+				Bool		Enabled;	///< Everything is within the view if false.
+				Vector3f32	Position;	///< Center of the view.
+				Float32		Radius;		///< Radius of the view.
+			};
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Version of an entity held by the client.
+			///
+			////////////////////////////////////////////////////////////////
+			struct EntityVersion
+			{
+				Uint16 EntityId;	///< Id of the entity.
+				Uint16 SnapshotId;	///< Id of the world snapshot the client got the entity state from.
+			};
+
+			// Public typedefs
+			typedef std::vector<EntityVersion> EntityVersionVector;	///< Vector of entity versions, sorted by entity id.
+
+			///< Number of recorded snapshots, same as the snapshot history.
+			static const SizeType Capacity = EntitySnapshotHistory::Capacity;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Default constructor.
+			///
+			////////////////////////////////////////////////////////////////
+			EntityInterest( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Start recording the entity versions of a snapshot.
+			///
+			/// The record of the snapshot at the same slot, 32 snapshots ago, is replaced.
+			///
+			/// \return Reference to the empty vector of entity versions.
+			///
+			////////////////////////////////////////////////////////////////
+			EntityVersionVector & Add( const Uint16 p_SnapshotId );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the entity versions of a snapshot.
+			///
+			/// \return Pointer to the entity versions, NULL if the snapshot is not recorded.
+			///
+			////////////////////////////////////////////////////////////////
+			const EntityVersionVector * Get( const Uint16 p_SnapshotId ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Find the version of an entity in a vector of entity versions.
+			///
+			/// \return Id of the world snapshot, -1 if the entity is not found.
+			///
+			////////////////////////////////////////////////////////////////
+			static Int32 Find( const EntityVersionVector & p_Versions, const Uint16 p_EntityId );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Forget all the recorded snapshots.
+			///
+			////////////////////////////////////////////////////////////////
+			void Clear( );
+
+		private:
+
+			// Private variables
+			Int32				m_SnapshotIds[ Capacity ];	///< Ids of the recorded snapshots, -1 if none.
+			EntityVersionVector	m_Versions[ Capacity ];		///< Entity versions of the recorded snapshots.
+
+		};
+
+	}
+
+}
+
+#endif
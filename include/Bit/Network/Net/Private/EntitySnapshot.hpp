@@ -0,0 +1,250 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_ENTITY_SNAPSHOT_HPP
+#define BIT_NETWORK_NET_ENTITY_SNAPSHOT_HPP
+
+#include <Bit/Build.hpp>
+#include <vector>
+#include <map>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \brief	Snapshot of the state of all entities at a server tick.
+		///
+		/// The state of every entity is the data of its variables,
+		/// stored in the order of the variable ids.
+		/// Snapshots are used as baselines for delta encoding,
+		/// the state is XORed with the state of the same entity in the baseline
+		/// and the zero runs of the result are left out.
+		///
+		/// Delta structure:
+		///		* Run:
+		///			- Unchanged byte count(1)
+		///			- Changed byte count(1)
+		///			- Changed bytes XORed with the baseline(...)
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API EntitySnapshot
+		{
+
+		public:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	State of a single entity.
+			///
+			////////////////////////////////////////////////////////////////
+			struct EntityState
+			{
+				Uint32		ClassId;	///< Id of the entity's class.
+				SizeType	Offset;		///< Offset of the state in the snapshot data.
+				SizeType	Size;		///< Size of the state.
+			};
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	State type of an entity in a snapshot message.
+			///
+			////////////////////////////////////////////////////////////////
+			struct StateType
+			{
+				enum eType
+				{
+					Full	= 0,	///< The full state, with the entity's class id.
+					Delta	= 1		///< Delta encoded against the baseline.
+				};
+			};
+
+			///< Snapshot message flag, set if the message is delta encoded against a baseline.
+			static const Uint8 DeltaFlag = 0x01;
+
+			// Public typedefs
+			typedef std::map<Uint16, EntityState> EntityStateMap;	///< Map of entity states, entity id as key.
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Constructor.
+			///
+			/// \param p_Id Id of the snapshot.
+			///
+			////////////////////////////////////////////////////////////////
+			EntitySnapshot( const Uint16 p_Id );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the id of the snapshot.
+			///
+			////////////////////////////////////////////////////////////////
+			Uint16 GetId( ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Add the state of an entity.
+			///
+			/// \param p_EntityId Id of the entity.
+			/// \param p_ClassId Id of the entity's class.
+			/// \param p_Size Size of the entity's state.
+			///
+			/// \return Pointer to the zero initialized state, valid until the next entity is added.
+			///			NULL if the entity is already added.
+			///
+			////////////////////////////////////////////////////////////////
+			Uint8 * AddEntity( const Uint16 p_EntityId, const Uint32 p_ClassId, const SizeType p_Size );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the state of an entity.
+			///
+			/// \return Pointer to the entity state, NULL if the entity is not in the snapshot.
+			///
+			////////////////////////////////////////////////////////////////
+			const EntityState * GetEntity( const Uint16 p_EntityId ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get all the entity states.
+			///
+			////////////////////////////////////////////////////////////////
+			const EntityStateMap & GetEntities( ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the data of an entity state.
+			///
+			////////////////////////////////////////////////////////////////
+			const Uint8 * GetData( const EntityState & p_State ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Delta encode a state against a baseline state of the same size.
+			///
+			/// \param p_pBaseline Baseline state.
+			/// \param p_pState Current state.
+			/// \param p_Size Size of the states.
+			/// \param p_Delta Vector to append the delta to.
+			///
+			/// \return False if the states are equal and nothing is appended, else true.
+			///
+			////////////////////////////////////////////////////////////////
+			static Bool EncodeDelta(	const Uint8 * p_pBaseline,
+										const Uint8 * p_pState,
+										const SizeType p_Size,
+										std::vector<Uint8> & p_Delta );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Decode a delta against a baseline state.
+			///
+			/// \param p_pBaseline Baseline state.
+			/// \param p_pDelta The delta.
+			/// \param p_DeltaSize Size of the delta.
+			/// \param p_pState Output state, of the same size as the baseline.
+			/// \param p_Size Size of the states.
+			///
+			/// \return False if the delta is corrupt, else true.
+			///
+			////////////////////////////////////////////////////////////////
+			static Bool DecodeDelta(	const Uint8 * p_pBaseline,
+										const Uint8 * p_pDelta,
+										const SizeType p_DeltaSize,
+										Uint8 * p_pState,
+										const SizeType p_Size );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Check if a snapshot id is newer than another one, wrapping around.
+			///
+			////////////////////////////////////////////////////////////////
+			static Bool IsNewer( const Uint16 p_Id, const Uint16 p_Than );
+
+		private:
+
+			// Private variables
+			Uint16				m_Id;		///< Id of the snapshot.
+			EntityStateMap		m_Entities;	///< Map of entity states.
+			std::vector<Uint8>	m_Data;		///< Data of all the entity states.
+
+		};
+
+		////////////////////////////////////////////////////////////////
+		/// \brief	Ring of the last snapshots, indexed by snapshot id.
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API EntitySnapshotHistory
+		{
+
+		public:
+
+			///< Number of snapshots in the history. Must be a divisor of 65536.
+			static const SizeType Capacity = 32;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Default constructor.
+			///
+			////////////////////////////////////////////////////////////////
+			EntitySnapshotHistory( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Destructor.
+			///
+			////////////////////////////////////////////////////////////////
+			~EntitySnapshotHistory( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Add a snapshot, the history takes the ownership.
+			///
+			/// The snapshot at the same slot, 32 snapshots ago, is deleted.
+			///
+			////////////////////////////////////////////////////////////////
+			void Add( EntitySnapshot * p_pSnapshot );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get snapshot by id.
+			///
+			/// \return Pointer to the snapshot, NULL if not in the history.
+			///
+			////////////////////////////////////////////////////////////////
+			const EntitySnapshot * Get( const Uint16 p_Id ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the latest added snapshot.
+			///
+			/// \return Pointer to the snapshot, NULL if the history is empty.
+			///
+			////////////////////////////////////////////////////////////////
+			const EntitySnapshot * GetLatest( ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Delete all the snapshots.
+			///
+			////////////////////////////////////////////////////////////////
+			void Clear( );
+
+		private:
+
+			// Private variables
+			EntitySnapshot *	m_pSnapshots[ Capacity ];	///< Ring of snapshots.
+			EntitySnapshot *	m_pLatest;					///< The latest added snapshot.
+
+		};
+
+	}
+
+}
+
+#endif
@@ -0,0 +1,233 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_FRAGMENT_ASSEMBLER_HPP
+#define BIT_NETWORK_NET_FRAGMENT_ASSEMBLER_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/Network/Net/Private/NetPacket.hpp>
+#include <Bit/System/Timer.hpp>
+#include <atomic>
+#include <vector>
+#include <map>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \brief	Reassembly of fragmented reliable messages.
+		///
+		/// Messages larger than FragmentDataSize are split into fragments,
+		/// each fragment is sent as a reliable packet and acknowledged on its own,
+		/// only the lost fragments are resent.
+		/// The total size of the messages being reassembled is bounded,
+		/// fragments of new messages are rejected when the buffer is full,
+		/// and should not be acknowledged, letting the sender resend them later.
+		/// The buffer may be shared with other assemblers through a budget,
+		/// bounding the memory of all the connections of a server.
+		/// Messages not receiving any fragments within the timeout are dropped,
+		/// the received fragments are acknowledged and never resent by the sender.
+		///
+		/// The class is not thread safe, it's used by the receiving thread only.
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API FragmentAssembler
+		{
+
+		public:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Result of adding a fragment.
+			///
+			////////////////////////////////////////////////////////////////
+			struct Result
+			{
+				enum eResult
+				{
+					Rejected	= 0,	///< Corrupt fragment, or no room for the message.
+					Added		= 1,	///< The fragment is added, the message isn't complete yet.
+					Completed	= 2		///< The fragment completed the message.
+				};
+			};
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Buffer size shared by multiple assemblers.
+			///
+			/// The class is thread safe.
+			///
+			////////////////////////////////////////////////////////////////
+			class BIT_API Budget
+			{
+
+			public:
+
+				////////////////////////////////////////////////////////////////
+				/// \brief Constructor.
+				///
+				/// \param p_Size Max size of all the messages being reassembled.
+				///
+				////////////////////////////////////////////////////////////////
+				Budget( const SizeType p_Size );
+
+				////////////////////////////////////////////////////////////////
+				/// \brief Take a part of the budget.
+				///
+				/// \return False if the budget is exceeded, nothing is taken.
+				///
+				////////////////////////////////////////////////////////////////
+				Bool Acquire( const SizeType p_Size );
+
+				////////////////////////////////////////////////////////////////
+				/// \brief Give back a part of the budget.
+				///
+				////////////////////////////////////////////////////////////////
+				void Release( const SizeType p_Size );
+
+			private:
+
+				// Private variables
+				const SizeType			m_Size;	///< Size of the budget.
+				std::atomic<SizeType>	m_Used;	///< Size taken by the assemblers.
+
+			};
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Constructor.
+			///
+			/// \param p_MaxMessageSize Max size of a single message.
+			/// \param p_BufferSize Max size of all the messages being reassembled.
+			/// \param p_pBudget Budget shared with other assemblers, not used if NULL.
+			/// \param p_Timeout Time without new fragments before a message is dropped.
+			///
+			////////////////////////////////////////////////////////////////
+			FragmentAssembler(	const SizeType p_MaxMessageSize = MaxFragmentedMessageSize,
+								const SizeType p_BufferSize = ReassemblyBufferSize,
+								Budget * p_pBudget = NULL,
+								const Time & p_Timeout = Seconds( 10.0f ) );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Destructor.
+			///
+			////////////////////////////////////////////////////////////////
+			~FragmentAssembler( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Add a fragment.
+			///
+			/// \param p_pData Pointer to the fragment header, followed by the fragment data.
+			/// \param p_DataSize Size of the fragment header and data.
+			/// \param p_MessageType Packet type of the completed message.
+			/// \param p_Message Data of the completed message.
+			///
+			/// \return Completed if the message is complete, the message type and data are set.
+			///
+			////////////////////////////////////////////////////////////////
+			Result::eResult AddFragment(	const Uint8 * p_pData,
+											const SizeType p_DataSize,
+											Uint8 & p_MessageType,
+											std::vector<Uint8> & p_Message );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Clear all the messages being reassembled.
+			///
+			////////////////////////////////////////////////////////////////
+			void Clear( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the number of fragments of a message.
+			///
+			////////////////////////////////////////////////////////////////
+			static Uint16 GetFragmentCount( const SizeType p_MessageSize );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Write a fragment header.
+			///
+			/// \param p_pHeader Pointer to the header, FragmentHeaderSize bytes.
+			///
+			////////////////////////////////////////////////////////////////
+			static void WriteHeader(	Uint8 * p_pHeader,
+										const Uint8 p_MessageType,
+										const Uint16 p_MessageId,
+										const Uint16 p_FragmentIndex,
+										const Uint16 p_FragmentCount );
+
+		private:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Drop the messages not receiving any fragments within the timeout.
+			///
+			////////////////////////////////////////////////////////////////
+			void Expire( const Time & p_Time );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Take a part of the buffer, and of the budget.
+			///
+			/// \return False if there is no room.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool Acquire( const SizeType p_Size );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Give back a part of the buffer, and of the budget.
+			///
+			////////////////////////////////////////////////////////////////
+			void Release( const SizeType p_Size );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Message being reassembled.
+			///
+			////////////////////////////////////////////////////////////////
+			struct Message
+			{
+				Uint8				Type;			///< Packet type of the message.
+				Uint16				FragmentCount;	///< Number of fragments.
+				Uint16				ReceivedCount;	///< Number of received fragments.
+				SizeType			LastSize;		///< Data size of the last fragment, 0 if not received.
+				Time				LastTime;		///< Time of the last received fragment.
+				std::vector<Uint8>	Data;			///< Data of the message.
+				std::vector<Bool>	Received;		///< Received flag of the fragments.
+			};
+
+			// Private typedefs
+			typedef std::map<Uint16, Message *> MessageMap;	///< Map of messages, message id as key.
+
+			// Private variables
+			const SizeType	m_MaxMessageSize;	///< Max size of a single message.
+			const SizeType	m_BufferSize;		///< Max size of all the messages being reassembled.
+			Budget *		m_pBudget;			///< Budget shared with other assemblers, NULL if none.
+			const Time		m_Timeout;			///< Time without new fragments before a message is dropped.
+			SizeType		m_BufferedSize;		///< Size of the messages being reassembled.
+			MessageMap		m_Messages;			///< Messages being reassembled.
+			Timer			m_Timer;			///< Clock of the fragment times.
+			Time			m_NextExpireTime;	///< Time of the next check for expired messages.
+
+		};
+
+	}
+
+}
+
+#endif
@@ -0,0 +1,142 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_INTERPOLATION_BATCH_HPP
+#define BIT_NETWORK_NET_INTERPOLATION_BATCH_HPP
+
+#include <Bit/Build.hpp>
+#include <vector>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		// Forward declarations
+		class VariableBase;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Interpolation mode of the interpolated variables.
+		///
+		////////////////////////////////////////////////////////////////
+		struct InterpolationMode
+		{
+			enum eMode
+			{
+				Linear	= 0,	///< Straight line between the two closest values.
+				Hermite	= 1		///< Cubic hermite curve, tangents from the neighbouring values.
+			};
+		};
+
+		////////////////////////////////////////////////////////////////
+		/// \brief	Batch of interpolated variable snapshots.
+		///
+		/// The interpolated variables add the two values to interpolate
+		/// between, and all of them are interpolated in one pass when evaluating.
+		/// The values are stored as one array per Float32 component,
+		/// keeping the interpolation loops free from branches and gathers.
+		///
+		/// Extrapolation is linear in both modes, the variables add equal
+		/// tangents, which turns the hermite curve into a straight line.
+		///
+		/// The class is not thread safe, protect it with a mutex.
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API InterpolationBatch
+		{
+
+		public:
+
+			// Public constants
+			static const SizeType MaxComponents = 4;	///< Maximum number of Float32 components of a value.
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Constructor.
+			///
+			////////////////////////////////////////////////////////////////
+			InterpolationBatch( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Remove all the samples and set the value type of the next samples.
+			///
+			/// \param p_Components Number of Float32 components of the values.
+			/// \param p_Mode Interpolation mode.
+			///
+			////////////////////////////////////////////////////////////////
+			void Clear( const SizeType p_Components, const InterpolationMode::eMode p_Mode );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Add a sample to interpolate.
+			///
+			/// \param p_pVariable The variable to publish the interpolated value of.
+			/// \param p_pSnapshot Snapshot value of the variable.
+			/// \param p_pFrom Value to interpolate from.
+			/// \param p_pTo Value to interpolate to.
+			/// \param p_pFromTangent Tangent at the from value, scaled by the time between the values.
+			/// \param p_pToTangent Tangent at the to value, scaled by the time between the values.
+			/// \param p_Factor Interpolation factor, above 1 when extrapolating.
+			///
+			////////////////////////////////////////////////////////////////
+			void Add(	VariableBase * p_pVariable,
+						Float32 * p_pSnapshot,
+						const Float32 * p_pFrom,
+						const Float32 * p_pTo,
+						const Float32 * p_pFromTangent,
+						const Float32 * p_pToTangent,
+						const Float32 p_Factor );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Interpolate the samples and publish the snapshot values.
+			///
+			////////////////////////////////////////////////////////////////
+			void Evaluate( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the number of samples.
+			///
+			////////////////////////////////////////////////////////////////
+			SizeType GetSize( ) const;
+
+		private:
+
+			// Private variables
+			SizeType					m_Components;					///< Number of Float32 components of the values.
+			InterpolationMode::eMode	m_Mode;							///< Interpolation mode.
+			std::vector<VariableBase *>	m_Variables;					///< Variables of the samples.
+			std::vector<Float32 *>		m_Snapshots;					///< Snapshot values of the samples.
+			std::vector<Float32>		m_Factors;						///< Interpolation factors.
+			std::vector<Float32>		m_From[MaxComponents];			///< Values to interpolate from, per component.
+			std::vector<Float32>		m_To[MaxComponents];			///< Values to interpolate to, per component.
+			std::vector<Float32>		m_FromTangents[MaxComponents];	///< Tangents at the from values, per component, hermite only.
+			std::vector<Float32>		m_ToTangents[MaxComponents];	///< Tangents at the to values, per component, hermite only.
+			std::vector<Float32>		m_Weights[4];					///< Hermite basis weights of the samples.
+			std::vector<Float32>		m_Results[MaxComponents];		///< Interpolated values, per component.
+
+		};
+
+	}
+
+}
+
+#endif
@@ -0,0 +1,223 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_MESSAGE_CHANNELS_HPP
+#define BIT_NETWORK_NET_MESSAGE_CHANNELS_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/Network/Net/DeliveryType.hpp>
+#include <Bit/Network/Net/Private/NetPacket.hpp>
+#include <Bit/System/Timer.hpp>
+#include <vector>
+#include <map>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \brief	Message channels of a connection.
+		///
+		/// Every channel has its own delivery type and sequence space.
+		/// The receiving side keeps a reorder buffer per ordered channel,
+		/// the messages arriving ahead of a lost one wait there until it's resent.
+		/// The reorder buffers are limited by message count and size, the buffered messages
+		/// are already acknowledged and can't be dropped, so the connection is failed beyond the limit.
+		/// The delivery type is sent in the channel byte of every message,
+		/// the receiver doesn't have to know the channel setup of the sender.
+		///
+		/// The class is not thread safe, protect it with a mutex.
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API MessageChannels
+		{
+
+		public:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Result of a received message.
+			///
+			////////////////////////////////////////////////////////////////
+			struct Result
+			{
+				enum eResult
+				{
+					Deliver,	///< Handle the message now, then poll the buffered messages.
+					Buffered,	///< The message is copied to the reorder buffer.
+					Dropped,	///< The message is old, a duplicate or corrupt.
+					Overflow	///< The reorder buffers are full, disconnect.
+				};
+			};
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Constructor.
+			///
+			/// All the channels are reliable ordered by default.
+			///
+			/// \param p_MaxBufferedCount Max number of messages in the reorder buffers of all the channels.
+			/// \param p_MaxBufferedSize Max size of the messages in the reorder buffers of all the channels.
+			///
+			////////////////////////////////////////////////////////////////
+			MessageChannels(	const SizeType p_MaxBufferedCount = ReorderBufferCount,
+								const SizeType p_MaxBufferedSize = ReorderBufferSize );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Reset the sequences and clear the reorder buffers, keeping the delivery types.
+			///
+			////////////////////////////////////////////////////////////////
+			void Clear( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Set the delivery type of a channel, sender side.
+			///
+			/// \return false if the channel is out of range.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool SetDelivery( const Uint8 p_Channel, const DeliveryType::eType p_Delivery );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the delivery type of a channel.
+			///
+			////////////////////////////////////////////////////////////////
+			DeliveryType::eType GetDelivery( const Uint8 p_Channel ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the channel byte and the sequence of the next message sent on a channel.
+			///
+			/// \param p_Channel Channel index, less than MaxChannelCount.
+			/// \param p_ChannelByte The channel byte, containing the channel index and the delivery type.
+			/// \param p_Sequence Sequence of the message in the channel.
+			///
+			/// \return True if the message is sent reliably.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool GetNextMessage( const Uint8 p_Channel, Uint8 & p_ChannelByte, Uint16 & p_Sequence );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Receive a message, receiver side.
+			///
+			/// \param p_ChannelByte Channel byte of the message.
+			/// \param p_Sequence Sequence of the message in its channel.
+			/// \param p_pData Pointer to the message, copied if buffered.
+			/// \param p_DataSize Size of the message.
+			///
+			////////////////////////////////////////////////////////////////
+			Result::eResult Receive(	const Uint8 p_ChannelByte,
+										const Uint16 p_Sequence,
+										const Uint8 * p_pData,
+										const SizeType p_DataSize );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the next buffered message of a channel, if it's its turn.
+			///
+			/// Poll the messages after every delivered message, until false is returned.
+			///
+			/// \param p_ChannelByte Channel byte of the delivered message.
+			/// \param p_Message The buffered message.
+			///
+			/// \return True if a message is returned.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool PollBuffered( const Uint8 p_ChannelByte, std::vector<Uint8> & p_Message );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the time the messages of a channel waited for the preceding ones.
+			///
+			/// Exponentially weighted moving average, every message is weighted 1/8.
+			/// The messages delivered at once are included, with no delay.
+			///
+			////////////////////////////////////////////////////////////////
+			Time GetOrderingDelay( const Uint8 p_Channel ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the number of messages in the reorder buffer of a channel.
+			///
+			////////////////////////////////////////////////////////////////
+			SizeType GetBufferedCount( const Uint8 p_Channel ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Write the channel byte and the sequence to a message header.
+			///
+			////////////////////////////////////////////////////////////////
+			static void WriteChannel( Uint8 * p_pHeader, const Uint8 p_ChannelByte, const Uint16 p_Sequence );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Read the channel byte and the sequence of a message header.
+			///
+			/// \return false if the header is corrupt.
+			///
+			////////////////////////////////////////////////////////////////
+			static Bool ReadChannel( const Uint8 * p_pHeader, const SizeType p_DataSize, Uint8 & p_ChannelByte, Uint16 & p_Sequence );
+
+		private:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Message waiting in the reorder buffer.
+			///
+			////////////////////////////////////////////////////////////////
+			struct BufferedMessage
+			{
+				std::vector<Uint8>	Data;		///< Copy of the message.
+				Timer				WaitTimer;	///< Time since the message arrived.
+			};
+
+			// Private typedefs
+			typedef std::map<Uint16, BufferedMessage> BufferedMessageMap;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Channel state.
+			///
+			////////////////////////////////////////////////////////////////
+			struct Channel
+			{
+				DeliveryType::eType	Delivery;		///< Delivery type of the sent messages.
+				Uint16				SendSequence;	///< Sequence of the next sent message.
+				Uint16				NextSequence;	///< Sequence of the next message to deliver, ordered channels.
+				Bool				HasSequence;	///< Flag for checking if any message is delivered, sequenced channels.
+				Uint16				LastSequence;	///< Sequence of the last delivered message, sequenced channels.
+				BufferedMessageMap	Buffered;		///< Reorder buffer, sequence as key.
+				Uint64				OrderingDelay;	///< Moving average of the time waited for the preceding messages, in microseconds.
+			};
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Add a sample to the moving average of the time waited for the preceding messages.
+			///
+			////////////////////////////////////////////////////////////////
+			static void AddDelaySample( Channel & p_Channel, const Uint64 p_Delay );
+
+			// Private variables
+			Channel			m_Channels[ MaxChannelCount ];	///< The channels, channel index as index.
+			SizeType		m_MaxBufferedCount;				///< Max number of messages in the reorder buffers.
+			SizeType		m_MaxBufferedSize;				///< Max size of the messages in the reorder buffers.
+			SizeType		m_BufferedCount;				///< Number of messages in the reorder buffers.
+			SizeType		m_BufferedSize;					///< Size of the messages in the reorder buffers.
+
+		};
+
+	}
+
+}
+
+#endif
@@ -0,0 +1,144 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_MESSAGE_TABLE_HPP
+#define BIT_NETWORK_NET_MESSAGE_TABLE_HPP
+
+#include <Bit/Build.hpp>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \brief	Table of message names and their ids.
+		///
+		/// The receiver of user and host messages gives every hooked message
+		/// a compact id and sends its table to the sender at connect,
+		/// so the messages can be sent and dispatched by id instead of by name.
+		/// Messages not yet in the sender's table are sent by name, with NameMessageId.
+		///
+		/// The class is not thread safe, protect it with a mutex.
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API MessageTable
+		{
+
+		public:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Add a message to the table, receiver side.
+			///
+			/// \param p_Name Name of the message.
+			///
+			/// \return Id of the message, the same id if it's already added.
+			///			NameMessageId if the name is too long or the table is full.
+			///
+			////////////////////////////////////////////////////////////////
+			Uint16 Add( const std::string & p_Name );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Find the id of a message.
+			///
+			/// \return Id of the message, NameMessageId if not found.
+			///
+			////////////////////////////////////////////////////////////////
+			Uint16 Find( const std::string & p_Name ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the number of message ids in the table.
+			///
+			////////////////////////////////////////////////////////////////
+			SizeType GetSize( ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Clear the table.
+			///
+			////////////////////////////////////////////////////////////////
+			void Clear( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Encode the messages of a message table packet.
+			///
+			/// \param p_Data Vector to append the encoded messages to.
+			/// \param p_FirstId Id of the first message to encode,
+			///			encodes the messages added since a previous encoding.
+			///
+			////////////////////////////////////////////////////////////////
+			void Encode( std::vector<Uint8> & p_Data, const Uint16 p_FirstId = 0 ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Decode the messages of a message table packet, sender side.
+			///
+			/// \return false if the data is corrupt.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool Decode( const Uint8 * p_pData, const SizeType p_DataSize );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Write a message header.
+			///
+			/// \param p_Data Vector to append the header to.
+			/// \param p_Id Id of the message, NameMessageId for sending it by name.
+			/// \param p_Name Name of the message.
+			///
+			////////////////////////////////////////////////////////////////
+			static void WriteHeader( std::vector<Uint8> & p_Data, const Uint16 p_Id, const std::string & p_Name );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Read a message header.
+			///
+			/// \param p_pData Pointer to the message.
+			/// \param p_DataSize Size of the message.
+			/// \param p_Id Id of the message, NameMessageId if sent by name.
+			/// \param p_pName Pointer to the name of the message, if sent by name.
+			/// \param p_HeaderSize Size of the header, the data follows it.
+			///
+			/// \return false if the header is corrupt.
+			///
+			////////////////////////////////////////////////////////////////
+			static Bool ReadHeader(	const Uint8 * p_pData, const SizeType p_DataSize,
+									Uint16 & p_Id, const char *& p_pName, SizeType & p_HeaderSize );
+
+		private:
+
+			// Private typedefs
+			typedef std::vector<std::string>					NameVector;
+			typedef std::unordered_map<std::string, Uint16>		IdMap;
+
+			// Private variables
+			NameVector	m_Names;	///< Names of the messages, message id as index.
+			IdMap		m_Ids;		///< Ids of the messages, message name as key.
+
+		};
+
+	}
+
+}
+
+#endif
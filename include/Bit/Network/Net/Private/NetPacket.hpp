@@ -74,8 +74,18 @@ namespace Bit
 				UserMessage		= 8,	///<	|	Both	|	   Yes		|	Client	|	Server	|
 				HostMessage		= 9,	///<	|	Both	|	   Yes		|	Server	|	Client	|
 				Command			= 10,	///<	|	Yes		|	   Yes		|	Client	|	Server	|
-				Ping			= 11	///<	|	No		|	   Yes		|	Both	|	Both	|
+				Ping			= 11,	///<	|	No		|	   Yes		|	Both	|	Both	|
+				EntitySnapshot	= 12,	///<	|	No		|	   Yes		|	Server	|	Client	|
+				SnapshotAck		= 13,	///<	|	No		|	   No		|	Client	|	Server	|
+				EntityClasses	= 14,	///<	|	Yes		|	   Yes		|	Server	|	Client	|
+				Fragment		= 15,	///<	|	Yes		|	   Yes		|	Both	|	Both	|
+				Coalesced		= 16,	///<	|	No		|	   No		|	Both	|	Both	|
+				MessageTable	= 17,	///<	|	Yes		|	   Yes		|	Both	|	Both	|
+				Challenge		= 18,	///<	|	No		|	   No		|	Server	|	Client	|
+				ChallengeResponse = 19,	///<	|	No		|	   No		|	Client	|	Server	|
+				Compression		= 20,	///<	|	Yes		|	   Yes		|	Both	|	Both	|
 				/// ---------------------------------------------------------------------------------
+				CompressedFlag	= 0x80	///< Flag of compressed packets, combined with the packet type.
 			};
 		};
 
@@ -95,6 +105,123 @@ namespace Bit
 		const SizeType HostMessagePacketSize = 4;
 		const SizeType CommandPacketSize = 3;
 		const SizeType PingPacketSize = 2;
+		const SizeType EntitySnapshotPacketSize = 4;
+		const SizeType SnapshotAckPacketSize = 3;
+		const SizeType EntityClassesPacketSize = 4;
+		const SizeType FragmentPacketSize = 11;
+		const SizeType CoalescedPacketSize = 8;
+		const SizeType MessageTablePacketSize = 4;
+		const SizeType ChallengePacketSize = 11;
+		const SizeType ChallengeResponsePacketSize = 11;
+		const SizeType CompressionPacketSize = 8;
+
+		/*
+			Structure of the connect handshake.
+			-------------------------------------------------------------------------
+				Connect:			1 byte type, 2 bytes connect sequence, identifier.
+				Challenge:			1 byte type, 2 bytes connect sequence, 8 bytes cookie.
+				ChallengeResponse:	1 byte type, 2 bytes connect sequence, 8 bytes cookie, identifier.
+				Accept:				1 byte type, 2 bytes connect sequence, 8 bytes server time.
+
+			The server answers a connect packet with a challenge, without creating any state.
+			The connection is created once the client echoes a valid cookie in a challenge response.
+		*/
+
+		/*
+			Structure of a fragment packet, following the reliable packet header.
+			-------------------------------------------------------------------------
+				+	1 byte packet type of the fragmented message.
+				+	2 bytes message id.
+				+	2 bytes fragment index.
+				+	2 bytes fragment count.
+				+	~ Data, FragmentDataSize bytes for all fragments but the last one.
+		*/
+
+		///< Fragmentation of reliable messages too large for a single datagram.
+		const SizeType FragmentHeaderSize = 7;						///< Size of the fragment header, excluding the packet header.
+		const SizeType FragmentDataSize = 1200;						///< Max data size of a fragment, keeping the datagrams below the MTU.
+		const SizeType FragmentWindowSize = 256;					///< Max number of unacknowledged fragments in flight.
+		const SizeType MaxFragmentedMessageSize = 32 * 1024 * 1024;	///< Max size of a fragmented message sent by the server.
+		const SizeType ReassemblyBufferSize = 64 * 1024 * 1024;		///< Max size of the messages being reassembled by the client.
+		const SizeType MaxUserFragmentedMessageSize = 256 * 1024;	///< Max size of a fragmented message sent by a client.
+		const SizeType UserReassemblyBufferSize = 1024 * 1024;		///< Max size of the messages being reassembled by the server, per connection.
+		const SizeType TotalReassemblyBufferSize = 64 * 1024 * 1024;	///< Max size of the messages being reassembled by the server, for all connections.
+
+		/*
+			Structure of a coalesced packet.
+			-------------------------------------------------------------------------
+				+	1 byte packet type.
+				+	1 byte flags, AckFlag is set if the acknowledgement is valid.
+				+	2 bytes latest received reliable sequence.
+				+	4 bytes ack bitfield, bit n acknowledges the sequence (latest - 1 - n).
+				/	* Packet:
+						+	2 bytes packet size.
+						+	~ Packet, with its regular packet header.
+		*/
+
+		///< Coalescing of packets and acknowledgements.
+		const Uint8 AckFlag = 0x01;									///< Coalesced packet flag, set if the acknowledgement is valid.
+		const SizeType AckBitCount = 32;							///< Number of sequences acknowledged by the ack bitfield.
+		const SizeType CoalescedSizeFieldSize = 2;					///< Size of the size field preceding each packet.
+		const SizeType MaxCoalescedPacketSize = 1200;				///< Max size of a coalesced packet, keeping it below the MTU.
+
+		/*
+			Structure of user and host messages, following the reliable packet header.
+			-------------------------------------------------------------------------
+				+	1 byte message type.
+				+	1 byte channel, the delivery type in the upper 4 bits and the channel index in the lower 4 bits.
+				+	2 bytes sequence of the message in its channel.
+				+	2 bytes message id, given by the receiver in its message table.
+				/	~ Null terminated message name, if the message id is NameMessageId.
+				+	~ Data
+
+			Structure of a message table packet, following the reliable packet header.
+			-------------------------------------------------------------------------
+				*	Message:
+					+	2 bytes message id.
+					+	1 byte name length.
+					+	~ Name, not null terminated.
+		*/
+
+		///< User and host messages.
+		const Uint16 NameMessageId = 0xFFFF;						///< Message id of messages sent by name, the receiver has not told the id yet.
+		const SizeType MessageHeaderSize = 6;						///< Size of the message type, channel, channel sequence and message id.
+		const SizeType MessageChannelOffset = 1;					///< Offset of the channel in the message header.
+		const SizeType MessageIdOffset = 4;							///< Offset of the message id in the message header.
+		const Uint8 ChannelIndexMask = 0x0F;						///< Mask of the channel index in the channel byte.
+		const Uint8 ChannelDeliveryShift = 4;						///< Shift of the delivery type in the channel byte.
+		const SizeType MaxMessageNameLength = 255;					///< Max length of a message name in a message table.
+		const SizeType ReorderBufferCount = 8192;					///< Max number of messages in the reorder buffers of the client.
+		const SizeType ReorderBufferSize = 64 * 1024 * 1024;		///< Max size of the messages in the reorder buffers of the client.
+		const SizeType UserReorderBufferCount = 1024;				///< Max number of messages in the reorder buffers of a connection, server side.
+		const SizeType UserReorderBufferSize = 1024 * 1024;			///< Max size of the messages in the reorder buffers of a connection, server side.
+
+		///< Entity snapshots.
+		const SizeType MaxSnapshotSize = 1200;						///< Max size of a snapshot message, the entities of the lowest priority are deferred to the upcoming snapshots.
+
+		/*
+			Structure of a compressed packet.
+			-------------------------------------------------------------------------
+				+	1 byte packet type, with the CompressedPacketFlag set.
+				+	2 bytes sequence number.
+				+	1 byte reability status.
+				+	4 bytes size of the decompressed data.
+				+	~ Compressed data.
+
+			The packet type of a fragmented message has the flag set if the message is compressed,
+			the message is compressed as a whole before it's fragmented.
+
+			Structure of a compression packet, following the reliable packet header.
+			-------------------------------------------------------------------------
+				+	4 bytes checksum of the compression dictionary, 0 to compress without a dictionary.
+
+			The server offers its dictionary at connection, if the compression is enabled.
+			The client answers with the same checksum if it has the same dictionary, else 0.
+		*/
+
+		///< Compression of entity snapshots and host messages.
+		const Uint8 CompressedPacketFlag = PacketType::CompressedFlag;	///< Packet type flag, set if the data following the packet header is compressed.
+		const SizeType CompressedPacketHeaderSize = 4;				///< Size of the uncompressed packet header of a compressed packet.
 
 		////////////////////////////////////////////////////////////////
 		/// \brief Reject type
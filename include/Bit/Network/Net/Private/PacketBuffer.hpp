@@ -0,0 +1,109 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_PACKET_BUFFER_HPP
+#define BIT_NETWORK_NET_PACKET_BUFFER_HPP
+
+#include <Bit/Build.hpp>
+#include <atomic>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \brief	Reference counted immutable packet buffer.
+		///
+		/// Used for sharing the payload of a broadcasted message between
+		/// the reliable packets of multiple connections. The payload is
+		/// copied once at creation and deleted when the last reference is released.
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API PacketBuffer
+		{
+
+		public:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Create a packet buffer with a reference count of 1.
+			///
+			/// \param p_pData Pointer to the data to copy.
+			/// \param p_DataSize Size of the data.
+			///
+			////////////////////////////////////////////////////////////////
+			static PacketBuffer * Create( const void * p_pData, const SizeType p_DataSize );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Increase the reference count.
+			///
+			////////////////////////////////////////////////////////////////
+			void AddReference( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Decrease the reference count, delete the buffer if it reaches 0.
+			///
+			////////////////////////////////////////////////////////////////
+			void Release( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the data.
+			///
+			////////////////////////////////////////////////////////////////
+			const Uint8 * GetData( ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the data size.
+			///
+			////////////////////////////////////////////////////////////////
+			SizeType GetDataSize( ) const;
+
+		private:
+
+			// Private functions
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Constructor.
+			///
+			////////////////////////////////////////////////////////////////
+			PacketBuffer( const void * p_pData, const SizeType p_DataSize );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Destructor.
+			///
+			////////////////////////////////////////////////////////////////
+			~PacketBuffer( );
+
+			// Private variables
+			Uint8 *					m_pData;		///< Copy of the data.
+			const SizeType			m_DataSize;		///< Size of the data.
+			std::atomic<Uint32>		m_References;	///< Number of references.
+
+		};
+
+	}
+
+}
+
+#endif
@@ -0,0 +1,163 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_PACKET_BUILDER_HPP
+#define BIT_NETWORK_NET_PACKET_BUILDER_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/Network/Net/Private/NetPacket.hpp>
+#include <vector>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \brief	Builder of coalesced packets.
+		///
+		/// Small outgoing packets are coalesced into a single datagram,
+		/// together with an acknowledgement header of the received reliable packets:
+		/// the latest received sequence and a bitfield of the 32 sequences before it.
+		/// The acknowledgement header replaces the standalone acknowledgement packet,
+		/// only reliable packets older than the bitfield are acknowledged on their own.
+		/// The owner flushes the builder at every tick, or when it's full.
+		///
+		/// The class is not thread safe, protect it with a mutex.
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API PacketBuilder
+		{
+
+		public:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Result of adding an acknowledgement.
+			///
+			////////////////////////////////////////////////////////////////
+			struct AckResult
+			{
+				enum eResult
+				{
+					Added	= 0,	///< The sequence is added to the acknowledgement header.
+					Full	= 1,	///< Unsent acknowledgements would be lost, flush the builder and add the sequence again.
+					Old		= 2		///< The sequence is too old for the ack bitfield, acknowledge it on its own.
+				};
+			};
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Default constructor.
+			///
+			////////////////////////////////////////////////////////////////
+			PacketBuilder( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Add the sequence of a received reliable packet to the acknowledgement header.
+			///
+			////////////////////////////////////////////////////////////////
+			AckResult::eResult AddAcknowledgement( const Uint16 p_Sequence );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Add a packet.
+			///
+			/// \param p_pHeader Pointer to the packet header.
+			/// \param p_HeaderSize Size of the packet header.
+			/// \param p_pData Pointer to the packet data, following the header.
+			/// \param p_DataSize Size of the packet data.
+			///
+			/// \return False if there's no room for the packet, flush the builder and add it again.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool AddPacket(	const Uint8 * p_pHeader,
+							const SizeType p_HeaderSize,
+							const Uint8 * p_pData,
+							const SizeType p_DataSize );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Build the coalesced packet of the added packets and acknowledgements.
+			///
+			/// \param p_Packet The coalesced packet.
+			///
+			/// \return False if there's nothing new to send.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool Flush( std::vector<Uint8> & p_Packet );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Clear the packets and the acknowledgement header.
+			///
+			////////////////////////////////////////////////////////////////
+			void Clear( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Check if a packet is small enough to be coalesced.
+			///
+			////////////////////////////////////////////////////////////////
+			static Bool CanCoalesce( const SizeType p_PacketSize );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Read the acknowledgement header of a coalesced packet.
+			///
+			/// \param p_HasAck Set to true if the acknowledgement is valid.
+			///
+			/// \return False if the packet is too small.
+			///
+			////////////////////////////////////////////////////////////////
+			static Bool ReadHeader(	const Uint8 * p_pData,
+									const SizeType p_DataSize,
+									Bool & p_HasAck,
+									Uint16 & p_AckSequence,
+									Uint32 & p_AckBits );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Read the next packet of a coalesced packet.
+			///
+			/// \param p_Position Position of the next packet, initially CoalescedPacketSize.
+			///
+			/// \return False if there are no more packets, or if the packet is corrupt.
+			///
+			////////////////////////////////////////////////////////////////
+			static Bool ReadPacket(	Uint8 * p_pData,
+									const SizeType p_DataSize,
+									SizeType & p_Position,
+									Uint8 *& p_pPacket,
+									SizeType & p_PacketSize );
+
+		private:
+
+			// Private variables
+			std::vector<Uint8>	m_Packets;			///< Added packets, each preceded by its size.
+			Bool				m_HasAck;			///< Flag for checking if any reliable packet is received.
+			Uint16				m_AckSequence;		///< Latest received reliable sequence.
+			Uint32				m_AckBits;			///< Bitfield of the received sequences before the latest one.
+			Bool				m_AckPending;		///< Flag for checking if the latest sequence is unsent.
+			Uint32				m_PendingBits;		///< Bitfield of the unsent acknowledgements before the latest one.
+
+		};
+
+	}
+
+}
+
+#endif
@@ -0,0 +1,121 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_PACKET_COMPRESSOR_HPP
+#define BIT_NETWORK_NET_PACKET_COMPRESSOR_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/Network/Net/CompressionDictionary.hpp>
+#include <vector>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Compression of a connection, negotiated at connect.
+		///
+		////////////////////////////////////////////////////////////////
+		struct CompressionType
+		{
+			enum eType
+			{
+				None		= 0,	///< The packets are not compressed.
+				Plain		= 1,	///< The packets are compressed without dictionary.
+				Dictionary	= 2		///< The packets are compressed with the dictionary of the server.
+			};
+		};
+
+		////////////////////////////////////////////////////////////////
+		/// \brief	Fast LZ compression of packet payloads.
+		///
+		/// LZ77 block format of the LZ4 family: every sequence is a token byte,
+		/// holding the literal length in the upper and the match length - 4 in the lower 4 bits,
+		/// extended by 255 valued bytes if 15, followed by the literals,
+		/// the 2 bytes little endian match offset and the extended match length.
+		/// The last sequence only holds literals. Matches may refer back into the dictionary.
+		///
+		/// The compressed payload starts with the 4 bytes decompressed size.
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API PacketCompressor
+		{
+
+		public:
+
+			// Public constants
+			static const SizeType MinMatchSize = 4;			///< Min size of a match.
+			static const SizeType MaxOffset = 65535;		///< Max offset of a match.
+			static const Uint32 DictionaryHashLog = 14;		///< Number of bits of the dictionary hashes.
+			static const SizeType MaxRatio = 255;			///< Max decompressed size per compressed byte, the length bytes of the format add at most 255 each.
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Compress a payload.
+			///
+			/// \param p_pData Data to compress.
+			/// \param p_Size Size of the data.
+			/// \param p_Output Vector to append the compressed payload to.
+			/// \param p_pDictionary Dictionary, or NULL.
+			///
+			/// \return False if the payload is not smaller compressed, nothing is appended.
+			///
+			////////////////////////////////////////////////////////////////
+			static Bool Compress(	const Uint8 * p_pData, const SizeType p_Size,
+									std::vector<Uint8> & p_Output,
+									const CompressionDictionary * p_pDictionary = NULL );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Decompress a payload.
+			///
+			/// \param p_pData Compressed payload.
+			/// \param p_Size Size of the compressed payload.
+			/// \param p_Output Vector to append the decompressed data to.
+			/// \param p_MaxSize Max decompressed size accepted.
+			/// \param p_pDictionary Dictionary the payload was compressed with, or NULL.
+			///
+			/// The declared decompressed size is checked against p_MaxSize and
+			/// the max ratio of the format before any memory is allocated.
+			///
+			/// \return False if the payload is corrupt or too large, nothing is appended.
+			///
+			////////////////////////////////////////////////////////////////
+			static Bool Decompress(	const Uint8 * p_pData, const SizeType p_Size,
+									std::vector<Uint8> & p_Output,
+									const SizeType p_MaxSize,
+									const CompressionDictionary * p_pDictionary = NULL );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Hash a 4 byte sequence.
+			///
+			////////////////////////////////////////////////////////////////
+			static Uint32 Hash( const Uint8 * p_pData, const Uint32 p_HashLog );
+
+		};
+
+	}
+
+}
+
+#endif
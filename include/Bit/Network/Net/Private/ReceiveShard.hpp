@@ -0,0 +1,73 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_RECEIVE_SHARD_HPP
+#define BIT_NETWORK_NET_RECEIVE_SHARD_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/Network/Net/Private/ConnectionTable.hpp>
+#include <Bit/Network/UdpSocket.hpp>
+#include <Bit/System/ConcurrentMemoryPool.hpp>
+#include <Bit/System/Thread.hpp>
+#include <Bit/System/Mutex.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \brief	Receive shard of the server.
+		///
+		/// Every shard owns a socket bound to the server port, drained by its own thread.
+		/// With several shards the sockets share the port by SO_REUSEPORT and the kernel
+		/// hashes every flow to one of them, so each shard owns the connections of its flows.
+		/// The packet path only locks the connection mutex of the shard.
+		///
+		////////////////////////////////////////////////////////////////
+		struct ReceiveShard
+		{
+			////////////////////////////////////////////////////////////////
+			/// \brief Default constructor.
+			///
+			////////////////////////////////////////////////////////////////
+			ReceiveShard( ) :
+				pSocket( NULL ),
+				pPacketMemoryPool( NULL )
+			{
+			}
+
+			// Public variables
+			Private::UdpSocketBase *			pSocket;			///< Socket of the shard, replies to its flows are sent by it as well.
+			Thread								ReceiveThread;		///< Thread receiving the packets of the socket.
+			Mutex								ConnectionMutex;	///< Mutex for the connections of the shard.
+			ConnectionTable						Connections;		///< Connections of the shard via their addresses and ports.
+			ConcurrentMemoryPool<Uint8> *		pPacketMemoryPool;	///< Memory pool for the packets received by the shard, returned to by the connections.
+		};
+
+	}
+
+}
+
+#endif
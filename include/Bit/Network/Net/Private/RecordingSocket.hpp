@@ -0,0 +1,80 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_RECORDING_SOCKET_HPP
+#define BIT_NETWORK_NET_RECORDING_SOCKET_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/Network/UdpSocket.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		// Forward declarations
+		class TrafficRecorder;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief	Udp socket recording its traffic to a traffic recorder.
+		///
+		/// The datagrams are sent and received by a regular udp socket.
+		///
+		////////////////////////////////////////////////////////////////
+		class RecordingSocket : public Private::UdpSocketBase
+		{
+
+		public:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Constructor.
+			///
+			////////////////////////////////////////////////////////////////
+			RecordingSocket( TrafficRecorder * p_pRecorder );
+
+			// Socket functions, see Private::UdpSocketBase.
+			virtual Bool Open( const Uint16 p_Port = 0 );
+			virtual Bool OpenShared( const Uint16 p_Port );
+			virtual void Close( );
+			virtual void SetBlocking( const Bool p_Blocking );
+			virtual Bool GetBlocking( ) const;
+			virtual Int32 Send( const void * p_pData, const SizeType p_Size, const Address & p_Address, const Uint16 p_Port );
+			virtual Int32 Receive( void * p_pData, const SizeType p_Size, Address & p_Address, Uint16 & p_Port );
+			virtual Int32 Receive( void * p_pData, const SizeType p_Size, Address & p_Address, Uint16 & p_Port, const Time & p_Timeout );
+			virtual Int32 SendBatch( const Datagram * p_pDatagrams, const SizeType p_Count );
+			virtual Int32 ReceiveBatch( Datagram * p_pDatagrams, const SizeType p_Count, const Time & p_Timeout );
+
+		private:
+
+			// Private variables
+			UdpSocket			m_Socket;		///< Socket sending and receiving the datagrams.
+			TrafficRecorder *	m_pRecorder;	///< Recorder of the datagrams.
+
+		};
+
+	}
+
+}
+
+#endif
@@ -0,0 +1,112 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_REPLAY_SOCKET_HPP
+#define BIT_NETWORK_NET_REPLAY_SOCKET_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/Network/UdpSocket.hpp>
+#include <Bit/System/Mutex.hpp>
+#include <map>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		// Forward declarations
+		class TrafficReplay;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief	Fake udp socket, receiving the datagrams of a traffic replay.
+		///
+		/// The sent datagrams are dropped, the connect challenges are kept
+		/// for replacing the cookies of the replayed challenge responses.
+		///
+		////////////////////////////////////////////////////////////////
+		class ReplaySocket : public Private::UdpSocketBase
+		{
+
+		public:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Constructor.
+			///
+			////////////////////////////////////////////////////////////////
+			ReplaySocket( TrafficReplay * p_pReplay );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Destructor, closing the socket.
+			///
+			////////////////////////////////////////////////////////////////
+			~ReplaySocket( );
+
+			// Socket functions, see Private::UdpSocketBase.
+			virtual Bool Open( const Uint16 p_Port = 0 );
+			virtual Bool OpenShared( const Uint16 p_Port );
+			virtual void Close( );
+			virtual void SetBlocking( const Bool p_Blocking );
+			virtual Bool GetBlocking( ) const;
+			virtual Int32 Send( const void * p_pData, const SizeType p_Size, const Address & p_Address, const Uint16 p_Port );
+			virtual Int32 Receive( void * p_pData, const SizeType p_Size, Address & p_Address, Uint16 & p_Port );
+			virtual Int32 Receive( void * p_pData, const SizeType p_Size, Address & p_Address, Uint16 & p_Port, const Time & p_Timeout );
+			virtual Int32 SendBatch( const Datagram * p_pDatagrams, const SizeType p_Count );
+			virtual Int32 ReceiveBatch( Datagram * p_pDatagrams, const SizeType p_Count, const Time & p_Timeout );
+
+		private:
+
+			// Private typedefs
+			typedef std::map<Uint64, Uint64> CookieMap;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Keep the cookie of a sent challenge.
+			///
+			////////////////////////////////////////////////////////////////
+			void AddSentDatagram(	const Address & p_Address, const Uint16 p_Port,
+									const void * p_pHeader, const SizeType p_HeaderSize,
+									const void * p_pData, const SizeType p_DataSize );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Find the next record of the socket.
+			///
+			/// \return False if there are no more records of the socket.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool FindNextRecord( );
+
+			// Private variables
+			TrafficReplay *		m_pReplay;		///< Replay of the socket.
+			Uint32				m_Index;		///< Index of the socket in the replay.
+			SizeType			m_NextRecord;	///< Index of the next record to receive, only accessed by the receiving thread.
+			Bool				m_Opened;		///< Flag for checking if the socket is opened.
+			Mutex				m_Mutex;		///< Mutex for the cookies.
+			CookieMap			m_Cookies;		///< Cookies of the last challenges sent to the endpoints.
+
+		};
+
+	}
+
+}
+
+#endif
@@ -0,0 +1,118 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_RTT_ESTIMATOR_HPP
+#define BIT_NETWORK_NET_RTT_ESTIMATOR_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/System/Time.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \brief	Round trip time estimator.
+		///
+		/// Keeps a smoothed round trip time and its variation,
+		/// and calculates the retransmission timeout from them, as in RFC 6298.
+		/// Only add samples of packets that are not resent,
+		/// their acknowledgement can't tell which one of the sends it belongs to.
+		///
+		/// The class is not thread safe, protect it with a mutex.
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API RttEstimator
+		{
+
+		public:
+
+			// Public constants
+			static const Time MinRto;	///< Lower bound of the retransmission timeout.
+			static const Time MaxRto;	///< Upper bound of the retransmission timeout, also after backoff.
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Constructor.
+			///
+			/// \param p_InitialRtt Round trip time to use until the first sample.
+			///
+			////////////////////////////////////////////////////////////////
+			RttEstimator( const Time & p_InitialRtt = Milliseconds( 200 ) );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Forget the samples and start over from an initial round trip time.
+			///
+			////////////////////////////////////////////////////////////////
+			void Reset( const Time & p_InitialRtt );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Add a round trip time sample.
+			///
+			////////////////////////////////////////////////////////////////
+			void AddSample( const Time & p_Rtt );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the smoothed round trip time.
+			///
+			////////////////////////////////////////////////////////////////
+			Time GetRtt( ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the round trip time variation.
+			///
+			////////////////////////////////////////////////////////////////
+			Time GetRttVariance( ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the retransmission timeout.
+			///
+			////////////////////////////////////////////////////////////////
+			Time GetRto( ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the retransmission timeout of a resent packet.
+			///
+			/// \param p_Resends Number of times the packet is resent.
+			///
+			/// \return The timeout doubled for every resend, at most MaxRto.
+			///
+			////////////////////////////////////////////////////////////////
+			Time GetBackoffRto( const Uint32 p_Resends ) const;
+
+		private:
+
+			// Private variables
+			Bool	m_HasSample;	///< Flag for checking if any sample is added.
+			Uint64	m_Srtt;			///< Smoothed round trip time in microseconds.
+			Uint64	m_RttVar;		///< Round trip time variation in microseconds.
+			Uint64	m_Rto;			///< Retransmission timeout in microseconds.
+
+		};
+
+	}
+
+}
+
+#endif
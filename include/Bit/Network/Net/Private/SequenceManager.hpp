@@ -60,6 +60,12 @@ namespace Bit
 			////////////////////////////////////////////////////////////////
 			Bool AddSequence(const Uint16 p_Sequence);
 
+			////////////////////////////////////////////////////////////////
+			/// \brief Check if the sequence is added.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool HasSequence(const Uint16 p_Sequence) const;
+
 		private:
 
 			// Private variables
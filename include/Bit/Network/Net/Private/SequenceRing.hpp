@@ -0,0 +1,222 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_SEQUENCE_RING_HPP
+#define BIT_NETWORK_NET_SEQUENCE_RING_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/System/Time.hpp>
+#include <vector>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \brief	Ring of items indexed by their 16 bit sequence,
+		///			with a timer wheel of the item deadlines.
+		///
+		/// Used for tracking the sent reliable packets until they are acknowledged.
+		/// The ring covers the whole sequence space, the item of a sequence is found
+		/// in the slot of the sequence, and every item is linked into the wheel bucket
+		/// of its deadline, one bucket per millisecond. Adding, finding, removing and
+		/// expiring items are constant time operations. The slots are allocated in pages
+		/// of PageSize sequences, only the pages of the sequences in flight are kept.
+		/// The items and pages are pooled and reused, no memory is allocated once the
+		/// ring has grown to the number of items in flight.
+		///
+		/// The class is not thread safe, protect it with a mutex.
+		///
+		////////////////////////////////////////////////////////////////
+		template <typename T>
+		class SequenceRing
+		{
+
+		public:
+
+			// Public constants
+			static const SizeType	Capacity		= 65536;	///< Maximum number of items, the whole sequence space.
+			static const SizeType	PageSize		= 256;		///< Number of slots per page.
+			static const SizeType	WheelSize		= 1024;		///< Number of buckets in the timer wheel.
+			static const Uint64		WheelResolution	= 1000;		///< Microseconds per bucket in the timer wheel.
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Default constructor.
+			///
+			////////////////////////////////////////////////////////////////
+			SequenceRing( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Destructor.
+			///
+			////////////////////////////////////////////////////////////////
+			~SequenceRing( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Add an item.
+			///
+			/// \param p_Sequence Sequence of the item.
+			/// \param p_Deadline Time of the first expiration of the item.
+			///
+			/// \return Pointer to the pooled item, valid until it's removed.
+			///			NULL if the sequence is already in the ring, the whole
+			///			sequence space is in flight and the sequence can't be reused.
+			///
+			////////////////////////////////////////////////////////////////
+			T * Add( const Uint16 p_Sequence, const Time & p_Deadline );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get an item.
+			///
+			/// \return Pointer to the item, NULL if the sequence is not found.
+			///
+			////////////////////////////////////////////////////////////////
+			T * Get( const Uint16 p_Sequence );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Remove an item and return it to the pool.
+			///
+			/// \return False if the sequence is not found.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool Remove( const Uint16 p_Sequence );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Expire the items with deadlines up to the given time.
+			///
+			/// Only the wheel buckets passed since the last call are visited.
+			///
+			/// \param p_Time Current time, on the same clock as the deadlines.
+			/// \param p_Function Function called for every expired item,
+			///			Time p_Function( T & p_Item ), returning the next deadline of the item.
+			///
+			////////////////////////////////////////////////////////////////
+			template <typename Function>
+			void Expire( const Time & p_Time, Function p_Function );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Remove all items.
+			///
+			/// \param p_Function Function called for every item before it's removed,
+			///			void p_Function( T & p_Item ).
+			///
+			////////////////////////////////////////////////////////////////
+			template <typename Function>
+			void Clear( Function p_Function );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the number of items.
+			///
+			////////////////////////////////////////////////////////////////
+			SizeType GetSize( ) const;
+
+		private:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Pooled item, linked into a wheel bucket.
+			///
+			////////////////////////////////////////////////////////////////
+			struct Node
+			{
+				T			Item;
+				Uint16		Sequence;
+				Uint64		Deadline;	///< Deadline in wheel ticks.
+				SizeType	Bucket;		///< Index of the wheel bucket.
+				Node *		pPrevious;
+				Node *		pNext;
+			};
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Page of slots.
+			///
+			////////////////////////////////////////////////////////////////
+			struct Page
+			{
+				Node *		pSlots[ PageSize ];
+				SizeType	Count;		///< Number of used slots.
+			};
+
+			// Private functions
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the slot of a sequence.
+			///
+			/// \param p_Create Allocate the page of the slot if missing.
+			///
+			/// \return Pointer to the slot, NULL if the page is missing.
+			///
+			////////////////////////////////////////////////////////////////
+			Node ** GetSlot( const Uint16 p_Sequence, const Bool p_Create );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Clear the slot of a node, and release its page if empty.
+			///
+			////////////////////////////////////////////////////////////////
+			void ClearSlot( Node * p_pNode );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Link a node into the wheel bucket of its deadline.
+			///
+			////////////////////////////////////////////////////////////////
+			void Schedule( Node * p_pNode );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Unlink a node from its wheel bucket.
+			///
+			////////////////////////////////////////////////////////////////
+			void Unschedule( Node * p_pNode );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Copy constructor, the ring is not copyable.
+			///
+			////////////////////////////////////////////////////////////////
+			SequenceRing( const SequenceRing & p_Ring );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Assignment operator, the ring is not copyable.
+			///
+			////////////////////////////////////////////////////////////////
+			SequenceRing & operator = ( const SequenceRing & p_Ring );
+
+			// Private variables
+			std::vector<Page *>	m_Pages;		///< Pages of nodes indexed by sequence / PageSize.
+			std::vector<Page *>	m_FreePages;	///< Pool of unused pages.
+			std::vector<Node *>	m_Wheel;		///< Linked lists of nodes indexed by deadline % WheelSize.
+			std::vector<Node *>	m_FreeNodes;	///< Pool of unused nodes.
+			SizeType			m_Size;			///< Number of items.
+			Uint64				m_CurrentTick;	///< Last expired wheel tick.
+
+		};
+
+		////////////////////////////////////////////////////////////////
+		// Include the inline file.
+		////////////////////////////////////////////////////////////////
+		#include <Bit/Network/Net/Private/SequenceRing.inl>
+
+	}
+
+}
+
+#endif
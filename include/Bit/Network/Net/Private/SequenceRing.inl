@@ -0,0 +1,287 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+const SizeType SequenceRing<T>::Capacity;
+
+template <typename T>
+const SizeType SequenceRing<T>::PageSize;
+
+template <typename T>
+const SizeType SequenceRing<T>::WheelSize;
+
+template <typename T>
+const Uint64 SequenceRing<T>::WheelResolution;
+
+template <typename T>
+SequenceRing<T>::SequenceRing( ) :
+	m_Pages( Capacity / PageSize, static_cast<Page *>( NULL ) ),
+	m_Wheel( WheelSize, static_cast<Node *>( NULL ) ),
+	m_Size( 0 ),
+	m_CurrentTick( 0 )
+{
+}
+
+template <typename T>
+SequenceRing<T>::~SequenceRing( )
+{
+	for( SizeType i = 0; i < m_Wheel.size( ); i++ )
+	{
+		Node * pNode = m_Wheel[ i ];
+		while( pNode )
+		{
+			Node * pNext = pNode->pNext;
+			delete pNode;
+			pNode = pNext;
+		}
+	}
+
+	for( SizeType i = 0; i < m_FreeNodes.size( ); i++ )
+	{
+		delete m_FreeNodes[ i ];
+	}
+
+	for( SizeType i = 0; i < m_Pages.size( ); i++ )
+	{
+		delete m_Pages[ i ];
+	}
+
+	for( SizeType i = 0; i < m_FreePages.size( ); i++ )
+	{
+		delete m_FreePages[ i ];
+	}
+}
+
+template <typename T>
+T * SequenceRing<T>::Add( const Uint16 p_Sequence, const Time & p_Deadline )
+{
+	Node ** ppSlot = GetSlot( p_Sequence, true );
+	if( *ppSlot )
+	{
+		return NULL;
+	}
+
+	// Reuse a pooled node if possible.
+	Node * pNode = NULL;
+	if( m_FreeNodes.size( ) )
+	{
+		pNode = m_FreeNodes.back( );
+		m_FreeNodes.pop_back( );
+	}
+	else
+	{
+		pNode = new Node;
+	}
+
+	pNode->Sequence = p_Sequence;
+	pNode->Deadline = p_Deadline.AsMicroseconds( ) / WheelResolution;
+	Schedule( pNode );
+
+	*ppSlot = pNode;
+	m_Pages[ p_Sequence / PageSize ]->Count++;
+	m_Size++;
+
+	return &pNode->Item;
+}
+
+template <typename T>
+T * SequenceRing<T>::Get( const Uint16 p_Sequence )
+{
+	Node ** ppSlot = GetSlot( p_Sequence, false );
+	if( ppSlot == NULL || *ppSlot == NULL )
+	{
+		return NULL;
+	}
+
+	return &( *ppSlot )->Item;
+}
+
+template <typename T>
+Bool SequenceRing<T>::Remove( const Uint16 p_Sequence )
+{
+	Node ** ppSlot = GetSlot( p_Sequence, false );
+	if( ppSlot == NULL || *ppSlot == NULL )
+	{
+		return false;
+	}
+
+	Node * pNode = *ppSlot;
+	Unschedule( pNode );
+	ClearSlot( pNode );
+	m_FreeNodes.push_back( pNode );
+	m_Size--;
+
+	return true;
+}
+
+template <typename T>
+template <typename Function>
+void SequenceRing<T>::Expire( const Time & p_Time, Function p_Function )
+{
+	const Uint64 tick = p_Time.AsMicroseconds( ) / WheelResolution;
+	if( tick <= m_CurrentTick )
+	{
+		return;
+	}
+
+	// Visit every bucket at most once, even if the last call was a whole wheel ago.
+	Uint64 steps = tick - m_CurrentTick;
+	if( steps > WheelSize )
+	{
+		steps = WheelSize;
+	}
+
+	// Rescheduled nodes are linked into the buckets after the current tick.
+	m_CurrentTick = tick;
+
+	for( Uint64 i = tick - steps + 1; i <= tick; i++ )
+	{
+		Node * pNode = m_Wheel[ static_cast<SizeType>( i % WheelSize ) ];
+		while( pNode )
+		{
+			Node * pNext = pNode->pNext;
+
+			// Nodes of later wheel rounds are left in the bucket.
+			if( pNode->Deadline <= tick )
+			{
+				Unschedule( pNode );
+				pNode->Deadline = p_Function( pNode->Item ).AsMicroseconds( ) / WheelResolution;
+				Schedule( pNode );
+			}
+
+			pNode = pNext;
+		}
+	}
+}
+
+template <typename T>
+template <typename Function>
+void SequenceRing<T>::Clear( Function p_Function )
+{
+	for( SizeType i = 0; i < m_Wheel.size( ); i++ )
+	{
+		Node * pNode = m_Wheel[ i ];
+		while( pNode )
+		{
+			Node * pNext = pNode->pNext;
+
+			p_Function( pNode->Item );
+			ClearSlot( pNode );
+			m_FreeNodes.push_back( pNode );
+
+			pNode = pNext;
+		}
+		m_Wheel[ i ] = NULL;
+	}
+
+	m_Size = 0;
+}
+
+template <typename T>
+SizeType SequenceRing<T>::GetSize( ) const
+{
+	return m_Size;
+}
+
+template <typename T>
+typename SequenceRing<T>::Node ** SequenceRing<T>::GetSlot( const Uint16 p_Sequence, const Bool p_Create )
+{
+	Page *& pPage = m_Pages[ p_Sequence / PageSize ];
+	if( pPage == NULL )
+	{
+		if( p_Create == false )
+		{
+			return NULL;
+		}
+
+		// Reuse a pooled page if possible.
+		if( m_FreePages.size( ) )
+		{
+			pPage = m_FreePages.back( );
+			m_FreePages.pop_back( );
+		}
+		else
+		{
+			pPage = new Page;
+		}
+
+		for( SizeType i = 0; i < PageSize; i++ )
+		{
+			pPage->pSlots[ i ] = NULL;
+		}
+		pPage->Count = 0;
+	}
+
+	return &pPage->pSlots[ p_Sequence % PageSize ];
+}
+
+template <typename T>
+void SequenceRing<T>::ClearSlot( Node * p_pNode )
+{
+	Page *& pPage = m_Pages[ p_pNode->Sequence / PageSize ];
+	pPage->pSlots[ p_pNode->Sequence % PageSize ] = NULL;
+
+	// Return the page to the pool when the last sequence of it is removed.
+	pPage->Count--;
+	if( pPage->Count == 0 )
+	{
+		m_FreePages.push_back( pPage );
+		pPage = NULL;
+	}
+}
+
+template <typename T>
+void SequenceRing<T>::Schedule( Node * p_pNode )
+{
+	// Expired deadlines are linked into the next bucket to expire.
+	const Uint64 tick = p_pNode->Deadline > m_CurrentTick ? p_pNode->Deadline : m_CurrentTick + 1;
+	p_pNode->Bucket = static_cast<SizeType>( tick % WheelSize );
+
+	// Link the node first in the bucket.
+	Node *& pHead = m_Wheel[ p_pNode->Bucket ];
+	p_pNode->pPrevious = NULL;
+	p_pNode->pNext = pHead;
+	if( pHead )
+	{
+		pHead->pPrevious = p_pNode;
+	}
+	pHead = p_pNode;
+}
+
+template <typename T>
+void SequenceRing<T>::Unschedule( Node * p_pNode )
+{
+	if( p_pNode->pPrevious )
+	{
+		p_pNode->pPrevious->pNext = p_pNode->pNext;
+	}
+	else
+	{
+		m_Wheel[ p_pNode->Bucket ] = p_pNode->pNext;
+	}
+
+	if( p_pNode->pNext )
+	{
+		p_pNode->pNext->pPrevious = p_pNode->pPrevious;
+	}
+}
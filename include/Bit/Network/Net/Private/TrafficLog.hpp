@@ -0,0 +1,150 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_TRAFFIC_LOG_HPP
+#define BIT_NETWORK_NET_TRAFFIC_LOG_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/Network/Address.hpp>
+#include <string>
+#include <vector>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		/*
+			Structure of a traffic log.
+			-------------------------------------------------------------------------
+				+	4 bytes magic, "BNTL".
+				+	1 byte version.
+				*	Record:
+					+	~ Varint time since the previous record, in microseconds.
+					+	1 byte direction.
+					+	4 bytes remote address.
+					+	2 bytes remote port.
+					+	~ Varint size of the datagram.
+					+	~ Datagram.
+
+			The address and port are in network byte order.
+		*/
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Direction of a recorded datagram.
+		///
+		////////////////////////////////////////////////////////////////
+		struct TrafficDirection
+		{
+			enum eDirection
+			{
+				Sent		= 0,	///< The datagram was sent by the recorded socket.
+				Received	= 1		///< The datagram was received by the recorded socket.
+			};
+		};
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Recorded datagram.
+		///
+		////////////////////////////////////////////////////////////////
+		struct TrafficRecord
+		{
+			Uint64							Time;			///< Time since the recording started, in microseconds.
+			TrafficDirection::eDirection	Direction;		///< Direction of the datagram.
+			Address							RemoteAddress;	///< Source or destination address.
+			Uint16							RemotePort;		///< Source or destination port.
+			std::vector<Uint8>				Data;			///< Datagram.
+		};
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Encoding of the traffic logs.
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API TrafficLog
+		{
+
+		public:
+
+			// Public typedefs
+			typedef std::vector<TrafficRecord> RecordVector;
+
+			// Public constants
+			static const Uint8 Version = 1;		///< Version of the log format.
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Append the header of a log.
+			///
+			////////////////////////////////////////////////////////////////
+			static void WriteHeader( std::vector<Uint8> & p_Output );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Append a record.
+			///
+			/// The datagram is the header(if any) followed by the data.
+			///
+			/// \param p_TimeDelta Time since the previous record, in microseconds.
+			///
+			////////////////////////////////////////////////////////////////
+			static void WriteRecord(	std::vector<Uint8> & p_Output,
+										const Uint64 p_TimeDelta,
+										const TrafficDirection::eDirection p_Direction,
+										const Address & p_RemoteAddress,
+										const Uint16 p_RemotePort,
+										const void * p_pHeader,
+										const SizeType p_HeaderSize,
+										const void * p_pData,
+										const SizeType p_DataSize );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Read all the records of a log file.
+			///
+			/// \return False if the file can not be opened or is not a log of this version.
+			///			The records of a truncated log are read up to the truncated record.
+			///
+			////////////////////////////////////////////////////////////////
+			static Bool Read( const std::string & p_Filename, RecordVector & p_Records );
+
+		private:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Append a varint, 7 bits at a time.
+			///
+			////////////////////////////////////////////////////////////////
+			static void WriteVarInt( std::vector<Uint8> & p_Output, Uint64 p_Value );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Read a varint.
+			///
+			/// \return False if the data ends before the varint.
+			///
+			////////////////////////////////////////////////////////////////
+			static Bool ReadVarInt( const Uint8 * p_pData, const SizeType p_DataSize, SizeType & p_Position, Uint64 & p_Value );
+
+		};
+
+	}
+
+}
+
+#endif
@@ -28,16 +28,23 @@
 #include <Bit/Network/Net/EntityManager.hpp>
 #include <Bit/Network/Net/Private/NetPacket.hpp>
 #include <Bit/Network/Net/Private/Connection.hpp>
+#include <Bit/Network/Net/Private/ConnectionWorkerPool.hpp>
+#include <Bit/Network/Net/Private/MessageTable.hpp>
+#include <Bit/Network/Net/Private/ReceiveShard.hpp>
+#include <Bit/Network/Net/Private/ConnectCookie.hpp>
+#include <Bit/Network/Net/CompressionDictionary.hpp>
+#include <Bit/Network/Net/SocketFactory.hpp>
 #include <Bit/Network/Net/UserMessageListener.hpp>
 #include <Bit/Network/Net/HostMessage.hpp>
 #include <Bit/Network/UdpSocket.hpp>
 #include <Bit/Network/TcpListener.hpp>
-#include <Bit/System/MemoryPool.hpp>
+#include <Bit/System/ConcurrentMemoryPool.hpp>
 #include <Bit/System/Thread.hpp>
 #include <Bit/System/ThreadValue.hpp>
 #include <Bit/System/Semaphore.hpp>
 #include <queue>
 #include <map>
+#include <list>
 
 #ifdef BIT_PLATFORM_WINDOWS
 #undef CreateEvent
@@ -108,6 +115,18 @@ namespace Bit
 				/// \param p_MaxEntityUpdatesPerSecond	Maximum of entity updates per second.
 				///										Too high will result in more memory usage. Should be same as server update rate.
 				/// \param p_Identifier Identifier used at connection, like a plain text password.
+				/// \param p_UseWorkerPool	Drive all the connections by a shared pool of worker threads,
+				///							instead of starting four threads per connection.
+				/// \param p_WorkerThreadCount Number of worker threads, 0 for the number of hardware threads.
+				/// \param p_CongestionControl	Adapt the send rate of each connection to its loss,
+				///								pacing the entity snapshots and resent packets.
+				/// \param p_MaxSendRate Max send rate per connection in bytes per second, 0 for no limit.
+				/// \param p_SocketShards	Number of sockets sharing the port, each one received by its own thread.
+				///							Greater than 1 requires a fixed port and SO_REUSEPORT(Linux).
+				/// \param p_CompressionThreshold	Min size of the entity snapshots and host messages to compress, 0 to disable the compression.
+				///									Compressed by the Dictionary if the client has the same dictionary.
+				/// \param p_pSocketFactory	Factory of the sockets, NULL for regular udp sockets.
+				///							Record or replay the traffic by TrafficRecorder or TrafficReplay.
 				///
 				////////////////////////////////////////////////////////////////
 				Properties(	const Uint16			p_Port,
@@ -115,7 +134,14 @@ namespace Bit
 							const Time &			p_LosingConnectionTimeout = Seconds(3.0f),
 							const Uint8				p_EntityUpdatesPerSecond = 22,
 							const Uint8				p_MaxEntityUpdatesPerSecond = 30,
-							const std::string &		p_Identifier = "Bit Engine Network" );
+							const std::string &		p_Identifier = "Bit Engine Network",
+							const Bool				p_UseWorkerPool = false,
+							const Uint32			p_WorkerThreadCount = 0,
+							const Bool				p_CongestionControl = false,
+							const Uint32			p_MaxSendRate = 0,
+							const Uint32			p_SocketShards = 1,
+							const Uint32			p_CompressionThreshold = 0,
+							SocketFactory *			p_pSocketFactory = NULL );
 
 				// Public variables
 				Uint16			Port;
@@ -124,6 +150,14 @@ namespace Bit
 				Uint8			EntityUpdatesPerSecond;
 				Uint8			MaxEntityUpdatesPerSecond;
 				std::string		Identifier;
+				Bool			UseWorkerPool;
+				Uint32			WorkerThreadCount;
+				Bool			CongestionControl;
+				Uint32			MaxSendRate;
+				Uint32			SocketShards;
+				Uint32			CompressionThreshold;
+				CompressionDictionary	Dictionary;
+				SocketFactory *	pSocketFactory;
 
 			};
 
@@ -187,6 +221,20 @@ namespace Bit
 			////////////////////////////////////////////////////////////////
 			HostMessage * CreateHostMessage( const std::string & p_Name, const Int32 p_MessageSize = -1 );
 
+			////////////////////////////////////////////////////////////////
+			/// \brief Set the delivery type of a message channel.
+			///
+			/// Send host messages on the channel via HostRecipientFilter::SetChannel.
+			/// All the channels are reliable ordered by default.
+			///
+			/// \param p_Channel Channel index, less than MaxChannelCount.
+			/// \param p_Delivery Delivery type of the messages sent on the channel.
+			///
+			/// \return false if the channel is out of range.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool SetChannel( const Uint8 p_Channel, const DeliveryType::eType p_Delivery );
+
 			////////////////////////////////////////////////////////////////
 			/// \brief Disconnect a user from the server.
 			///
@@ -297,6 +345,36 @@ namespace Bit
 			////////////////////////////////////////////////////////////////
 			void SetSendEntityMessages(const Uint16 p_UserId, const Bool p_Status);
 
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the connection statistics of a user.
+			///
+			/// \return False if the user is not found.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool GetUserStatistics(const Uint16 p_UserId, ConnectionStatistics & p_Statistics);
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Set the view of a user, for the entity interest management.
+			///
+			/// Only entities within the view, and entities without a position,
+			/// are sent to the user. Entities leaving the view are removed from the client.
+			///
+			/// \param p_Position Center of the view.
+			/// \param p_Radius Radius of the view.
+			///
+			/// \return False if the user is not found.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool SetUserView(const Uint16 p_UserId, const Vector3f32 & p_Position, const Float32 p_Radius);
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Clear the view of a user, every entity is sent to the user.
+			///
+			/// \return False if the user is not found.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool ClearUserView(const Uint16 p_UserId);
+
 			// Protected variables
 			EntityManager		m_EntityManager;
 
@@ -310,24 +388,44 @@ namespace Bit
 			////////////////////////////////////////////////////////////////
 			void AddConnectionForCleanup( Connection * p_pConnection );
 
+			////////////////////////////////////////////////////////////////
+			/// \brief Handle a packet received by the thread of a receive shard.
+			///
+			/// \return True if the item was passed to a connection, else false.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool HandleReceivedPacket(ReceiveShard * p_pShard, ConcurrentMemoryPool<Uint8>::Item * p_pItem, const Address & p_Address, const Uint16 p_Port);
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Close the sockets and delete the receive shards.
+			///
+			////////////////////////////////////////////////////////////////
+			void DeleteShards();
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Structure for the listeners of a user message.
+			///
+			////////////////////////////////////////////////////////////////
+			struct UserMessageHandler
+			{
+				std::string							Name;		///< Name of the message.
+				std::vector<UserMessageListener *>	Listeners;	///< Listeners of the message.
+			};
+
 			// Private  typedefs
-			typedef std::map<Uint64,	Connection*>					AddressConnectionMap;
-			typedef std::pair<Uint64,	Connection*>					AddressConnectionMapPair;
 			typedef std::map<Uint16,	Connection*>					UserConnectionMap;
 			typedef std::pair<Uint16,	Connection*>					UserConnectionMapPair;
 			typedef std::list<Connection*>								ConnectionList;
 			typedef std::queue<Uint16>									FreeUserIdMap;
 			typedef std::set<Address>									AddressSet;
-			typedef std::set<UserMessageListener*>						UserMessageListenerSet;
-			typedef std::map<std::string, UserMessageListenerSet *>		UserMessageListenerMap;
-			typedef std::pair<std::string, UserMessageListenerSet *>	UserMessageListenerPair;
+			typedef std::vector<UserMessageHandler>						UserMessageHandlerVector;
+			typedef std::vector<ReceiveShard*>							ReceiveShardVector;
 			
 
 			// Private variables
-			UdpSocket							m_Socket;					///< Udp socket.
+			ReceiveShardVector					m_Shards;					///< Receive shards, each one with its own socket and thread.
 			Uint16								m_Port;						///< Udp socket port.
 			ThreadValue<Timer>					m_ServerTimer;				///< The server timer, time size the server started.
-			Thread								m_MainThread;				///< Thread for handling incoming packets.
 			Thread								m_EntityThread;				///< Thread for sending entity states to users.
 			Thread								m_CleanupThread;			///< Thread for cleaning up connections.
 			Semaphore							m_CleanupSemaphore;			///< Semaphore for cleanups.
@@ -337,16 +435,24 @@ namespace Bit
 			Uint8								m_DefaultEntityTicks;		///< Number of updates per second for the entities.
 			Uint8								m_MaxEntityTicks;			///< Maximum number of updates per second for the entities.
 			FreeUserIdMap						m_FreeUserIds;				///< Queue of free user Ids.
-			AddressConnectionMap				m_AddressConnections;		///< Map of all the connections via their addresses.
 			UserConnectionMap					m_UserConnections;			///< Map of all the connections via their user IDs.
-			Mutex								m_ConnectionMutex;			///< Mutex for the address and user connections.
+			Mutex								m_ConnectionMutex;			///< Mutex for the user connections, not taken by the packet path of known connections.
 			ThreadValue<Bool>					m_Running;					///< Flag for checking if the server is running.
 			ThreadValue<Bool>					m_DefaultSendEntityMessages;///< Default value for new connection, whether or not to send entity messages.
 			ThreadValue<AddressSet>				m_BanSet;					///< Set of banned addresses.
-			ThreadValue<UserMessageListenerMap>	m_UserMessageListeners;		///< Map of user message listeners and their message types.
+			ConnectCookie						m_ConnectCookie;			///< Cookies of the connect challenges.
+			ThreadValue<MessageTable>			m_UserMessageTable;			///< Ids of the hooked user messages, sent to the clients.
+			ThreadValue<UserMessageHandlerVector>	m_UserMessageHandlers;	///< Listeners of the user messages, message id as index.
 			ThreadValue<Time>					m_LosingConnectionTimeout;	///< Amount of time until the connection timeout after not receiving any packets.
-			ThreadValue<MemoryPool<Uint8> *>	m_PacketMemoryPool;			///< Memory pool for packets, make less new, copy and delete operations.
 			const SizeType						m_MaxPacketSize;			///< Max size of a packet.
+			ConnectionWorkerPool				m_WorkerPool;				///< Worker pool driving the connections.
+			Bool								m_UseWorkerPool;			///< Flag for checking if the connections are driven by the worker pool.
+			Bool								m_CongestionControl;		///< Flag for checking if the send rate of the connections is adapted to their loss.
+			Uint32								m_MaxSendRate;				///< Max send rate per connection in bytes per second, 0 for no limit.
+			Uint32								m_CompressionThreshold;		///< Min size of the payloads to compress, 0 if the compression is disabled.
+			CompressionDictionary				m_CompressionDictionary;	///< Dictionary of the compression, offered to the clients.
+			DeliveryType::eType					m_ChannelDeliveries[ MaxChannelCount ];	///< Delivery types of the message channels, protected by the connection mutex.
+			FragmentAssembler::Budget			m_ReassemblyBudget;			///< Reassembly buffer budget shared by all the connections.
 
 		};
 
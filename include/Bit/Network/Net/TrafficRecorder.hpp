@@ -0,0 +1,125 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_TRAFFIC_RECORDER_HPP
+#define BIT_NETWORK_NET_TRAFFIC_RECORDER_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/Network/Net/SocketFactory.hpp>
+#include <Bit/Network/Net/Private/TrafficLog.hpp>
+#include <Bit/System/Mutex.hpp>
+#include <Bit/System/Timer.hpp>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \ingroup Network
+		/// \brief Recorder of the traffic of a server or client.
+		///
+		/// Set the recorder as the socket factory of the server or client,
+		/// and every datagram they send and receive is written to the log file.
+		/// Replay the log by TrafficReplay.
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API TrafficRecorder : public SocketFactory
+		{
+
+		public:
+
+			// Friend classes
+			friend class RecordingSocket;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Default constructor.
+			///
+			////////////////////////////////////////////////////////////////
+			TrafficRecorder( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Destructor, closing the log.
+			///
+			////////////////////////////////////////////////////////////////
+			~TrafficRecorder( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Open the log file and start recording.
+			///
+			/// \return True if succeeded, else false.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool Open( const std::string & p_Filename );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Write the buffered records and close the log file.
+			///
+			////////////////////////////////////////////////////////////////
+			void Close( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the number of recorded datagrams.
+			///
+			////////////////////////////////////////////////////////////////
+			Uint64 GetRecordCount( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Create a socket recording its traffic.
+			///
+			////////////////////////////////////////////////////////////////
+			virtual Private::UdpSocketBase * CreateSocket( );
+
+		private:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Record a datagram, if recording.
+			///
+			////////////////////////////////////////////////////////////////
+			void Record(	const TrafficDirection::eDirection p_Direction,
+							const Address & p_RemoteAddress,
+							const Uint16 p_RemotePort,
+							const void * p_pHeader,
+							const SizeType p_HeaderSize,
+							const void * p_pData,
+							const SizeType p_DataSize );
+
+			// Private variables
+			Mutex				m_Mutex;		///< Mutex for the recording.
+			std::ofstream		m_File;			///< Log file.
+			std::vector<Uint8>	m_Buffer;		///< Records not yet written to the file.
+			Timer				m_Timer;		///< Clock of the records, started at open.
+			Uint64				m_LastTime;		///< Time of the previous record, in microseconds.
+			Uint64				m_RecordCount;	///< Number of recorded datagrams.
+
+		};
+
+	}
+
+}
+
+#endif
@@ -0,0 +1,172 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_TRAFFIC_REPLAY_HPP
+#define BIT_NETWORK_NET_TRAFFIC_REPLAY_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/Network/Net/SocketFactory.hpp>
+#include <Bit/Network/Net/Private/TrafficLog.hpp>
+#include <Bit/System/ThreadValue.hpp>
+#include <string>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \ingroup Network
+		/// \brief Replay of a traffic log into a server or client.
+		///
+		/// Set the replay as the socket factory of the server or client,
+		/// and the datagrams received by the recorded side are received again,
+		/// at the recorded or an accelerated speed, without any network.
+		/// The datagrams sent by the server or client are counted and dropped.
+		///
+		/// Connect a replayed client to the endpoint of GetRemoteEndpoint.
+		/// The connect cookies of a replayed server are replaced by the cookies of the new challenges.
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API TrafficReplay : public SocketFactory
+		{
+
+		public:
+
+			// Friend classes
+			friend class ReplaySocket;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Default constructor.
+			///
+			////////////////////////////////////////////////////////////////
+			TrafficReplay( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Load a traffic log, before creating any sockets.
+			///
+			/// \return True if succeeded, else false.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool Load( const std::string & p_Filename );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Set the speed of the replay.
+			///
+			/// \param p_Speed	Speed relative to the recorded speed, 1 by default.
+			///					0 replays the datagrams as fast as they are received.
+			///
+			////////////////////////////////////////////////////////////////
+			void SetSpeed( const Float32 p_Speed );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the remote endpoint of the first recorded datagram,
+			///			the server of a recorded client.
+			///
+			/// \return False if the log is empty.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool GetRemoteEndpoint( Address & p_Address, Uint16 & p_Port ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the number of recorded datagrams to replay.
+			///
+			////////////////////////////////////////////////////////////////
+			SizeType GetRecordCount( ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the number of replayed datagrams.
+			///
+			////////////////////////////////////////////////////////////////
+			Uint64 GetReplayedCount( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the number of datagrams sent by the server or client.
+			///
+			////////////////////////////////////////////////////////////////
+			Uint64 GetSentCount( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Check if all the recorded datagrams are replayed.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool IsFinished( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Create a socket replaying the log.
+			///
+			/// Several sockets of the same server share the replayed datagrams,
+			/// hashed by their endpoints like the flows of shared sockets.
+			///
+			////////////////////////////////////////////////////////////////
+			virtual Private::UdpSocketBase * CreateSocket( );
+
+		private:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Add an opened socket, the replay starts with the first one.
+			///
+			/// \return Index of the socket.
+			///
+			////////////////////////////////////////////////////////////////
+			Uint32 AddSocket( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Remove a closed socket, the replay restarts when all of them are closed.
+			///
+			////////////////////////////////////////////////////////////////
+			void RemoveSocket( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the index of the socket replaying a record.
+			///
+			////////////////////////////////////////////////////////////////
+			Uint32 GetSocketIndex( const TrafficRecord & p_Record );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the time until a record is due, in microseconds.
+			///
+			/// \return 0 if the record is due.
+			///
+			////////////////////////////////////////////////////////////////
+			Uint64 GetTimeUntilDue( const TrafficRecord & p_Record );
+
+			// Private variables
+			TrafficLog::RecordVector	m_Records;			///< Received records of the log.
+			Address						m_RemoteAddress;	///< Remote address of the first record.
+			Uint16						m_RemotePort;		///< Remote port of the first record, 0 if the log is empty.
+			Uint64						m_FirstTime;		///< Time of the first record.
+			Float32						m_Speed;			///< Speed of the replay.
+			ThreadValue<Uint32>			m_SocketCount;		///< Number of opened sockets.
+			ThreadValue<Uint64>			m_StartTime;		///< System time of the replay start, in microseconds.
+			ThreadValue<Uint64>			m_ReplayedCount;	///< Number of replayed datagrams.
+			ThreadValue<Uint64>			m_SentCount;		///< Number of datagrams sent by the sockets.
+
+		};
+
+	}
+
+}
+
+#endif
@@ -85,9 +85,20 @@ namespace Bit
 			////////////////////////////////////////////////////////////////
 			/// \brief Send user message.
 			///
+			/// The message is not sent on any channel, reliable messages are unordered.
+			///
 			////////////////////////////////////////////////////////////////
 			Bool Send( const Bool p_Reliable = true );
 
+			////////////////////////////////////////////////////////////////
+			/// \brief Send user message on a channel.
+			///
+			/// \param p_Channel Channel index, less than MaxChannelCount.
+			///			The delivery type is set by Client::SetChannel.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool SendOnChannel( const Uint8 p_Channel );
+
 			////////////////////////////////////////////////////////////////
 			/// \brief Get event name
 			///
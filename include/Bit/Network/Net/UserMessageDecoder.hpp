@@ -52,7 +52,7 @@ namespace Bit
 			////////////////////////////////////////////////////////////////
 			UserMessageDecoder(	const std::string & p_Name,
 								const Uint16		p_UserId,
-								Uint8 *				p_pMessage,
+								const Uint8 *			p_pMessage,
 								SizeType			p_MessageSize );
 
 			////////////////////////////////////////////////////////////////
@@ -120,11 +120,11 @@ namespace Bit
 		private:
 
 			// Private variables.
-			std::string m_Name;			///< Message name.
-			Uint16		m_UserId;		/// Id of the user.
-			SizeType	m_Position;		///< Current position in message
-			Uint8 *		m_pMessage;		///< Pointer to message.
-			SizeType	m_MessageSize;	///< Size of the message.
+			const std::string &		m_Name;			///< Message name, owned by the handler table.
+			Uint16					m_UserId;		/// Id of the user.
+			SizeType				m_Position;		///< Current position in message
+			const Uint8 *			m_pMessage;		///< Pointer to message, in the receive buffer.
+			SizeType				m_MessageSize;	///< Size of the message.
 
 		};
 
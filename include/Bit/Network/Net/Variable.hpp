@@ -31,12 +31,14 @@
 #include <Bit/System/Vector2.hpp>
 #include <Bit/System/Vector3.hpp>
 #include <Bit/Network/Net/Private/EntityChanger.hpp>
+#include <Bit/Network/Net/Private/InterpolationBatch.hpp>
 #include <string>
+#include <cstring>
 #include <Bit/System/Log.hpp>
 #include <iterator>
 #include <iomanip>
-#include <list>
 #include <type_traits>
+#include <atomic>
 
 namespace Bit
 {
@@ -60,6 +62,7 @@ namespace Bit
 			// Friend classes
 			template <typename T> friend class Variable;
 			friend class EntityManager;
+			friend class InterpolationBatch;
 
 			////////////////////////////////////////////////////////////////
 			/// \brief Constructor.
@@ -119,13 +122,52 @@ namespace Bit
 			///
 			////////////////////////////////////////////////////////////////
 			virtual void SetIsNewValue(const Bool p_Status);
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Begin writing the value. Waits for any other writer to finish.
+			///
+			/// \return Sequence stamp to pass to EndWrite.
+			///
+			////////////////////////////////////////////////////////////////
+			Uint32 BeginWrite();
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Publish the value written since BeginWrite.
+			///
+			////////////////////////////////////////////////////////////////
+			void EndWrite(const Uint32 p_Sequence);
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Begin reading the value.
+			///
+			/// \return Sequence stamp to pass to EndRead.
+			///
+			////////////////////////////////////////////////////////////////
+			Uint32 BeginRead() const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Finish reading the value.
+			///
+			/// \return true if the value was not written during the read,
+			///			else false and the read has to be retried.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool EndRead(const Uint32 p_Sequence) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Copy the published "static" data, without locking the mutex.
+			///
+			////////////////////////////////////////////////////////////////
+			void LoadData(void * p_pData);
 			
 
 			// Protected variables.
 			const SizeType		m_Size;			///< Size of the varaible.
 			std::string			m_Name;			///< Variable name.
 			Entity *			m_pParent;		///< Parent entity.
-			Mutex				m_Mutex;		///< Mutex for set/get value.
+			Uint16				m_Id;			///< Id of the variable in the entity class.
+			Mutex				m_Mutex;		///< Mutex for the sequence and interpolation values.
+			std::atomic<Uint32>	m_Sequence;		///< Sequence stamp of the value, odd while being written.
 			Uint16				m_LastSequence;	///< Last update sequence.
 
 		};
@@ -211,6 +253,9 @@ namespace Bit
 		/// Get the interpolated data via the GetSnapshot snapshot function after
 		/// callig the TakeSnapshot function via the entity manager.
 		///
+		/// The received values are kept in a fixed size ring buffer,
+		/// the oldest value is overwritten when the buffer is full.
+		///
 		////////////////////////////////////////////////////////////////
 		template <typename T>
 		class InterpolatedVariable : public VariableBase
@@ -221,6 +266,9 @@ namespace Bit
 			// Friend classes
 			friend class EntityManager;
 
+			// Public constants
+			static const SizeType HistorySize = 16;	///< Number of received values to keep.
+
 			////////////////////////////////////////////////////////////////
 			/// \brief Default constructor.
 			///
@@ -286,23 +334,36 @@ namespace Bit
 
 		private:
 
-			// Private structs
+			// Private functions
 			////////////////////////////////////////////////////////////////
-			/// \brief Value strucutre
+			/// \brief Publish a new snapshot value.
 			///
 			////////////////////////////////////////////////////////////////
-			struct Value
-			{
-				Time m_Time;
-				T m_Value;
-				Bool m_InitialFlag;	///< This value is an initial value, and should be modified when another value is added.
-			};
+			void SetSnapshot(const T & p_Value);
 
-			
-			// Private typedef
-			typedef std::list<Value> ValueList;
+			////////////////////////////////////////////////////////////////
+			/// \brief Add the values to interpolate between to a batch,
+			///			or set the snapshot if there's nothing to interpolate.
+			///
+			/// \param p_Time Time of the snapshot.
+			/// \param p_ExtrapolationTime Maximum time to extrapolate past the last value.
+			/// \param p_Batch Batch to add the values to.
+			///
+			////////////////////////////////////////////////////////////////
+			void Sample(const Time & p_Time, const Time & p_ExtrapolationTime, InterpolationBatch & p_Batch);
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the ring buffer index of a value, 0 is the oldest value.
+			///
+			////////////////////////////////////////////////////////////////
+			SizeType GetHistoryIndex(const SizeType p_Index) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Add a value to the ring buffer, overwriting the oldest one if full.
+			///
+			////////////////////////////////////////////////////////////////
+			void AddHistory(const Time & p_Time, const T & p_Value, const Bool p_InitialFlag);
 
-			// Private functions
 			////////////////////////////////////////////////////////////////
 			/// \brief Clear old data.
 			///
@@ -310,7 +371,11 @@ namespace Bit
 			void ClearOldData(const Time & p_MinimumTime);
 			
 			// Private variables
-			ValueList		m_Values;		///< Values of the network variable.
+			Time			m_HistoryTimes[HistorySize];		///< Times of the received values.
+			T				m_HistoryValues[HistorySize];		///< Received values.
+			Bool			m_HistoryInitialFlags[HistorySize];	///< The value is an initial value, and should be modified when another value is added.
+			SizeType		m_HistoryStart;						///< Ring buffer index of the oldest value.
+			SizeType		m_HistoryCount;						///< Number of values in the ring buffer.
 			T				m_LastValue;	///< Server only.
 			T				m_Snapshot;		///< Snapshot value from the last snapshot.
 			Bool			m_NewValue;		///< Is this a new value since the entity manager sent this value to the client?
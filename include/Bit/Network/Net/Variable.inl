@@ -42,46 +42,56 @@ template<typename T>
 void Variable<T>::Set( const T & p_Value )
 {
 	// Set the variable.
-	m_Mutex.Lock( );
+	const Uint32 sequence = BeginWrite();
 	Bool isNewValue = m_Value != p_Value;
 	m_Value = p_Value;
-	m_Mutex.Unlock( );
+	EndWrite(sequence);
 
-	// Call the on variable function for the entity changer
-	if (/*isNewValue &&*/
+	// Mark the variable as changed.
+	if (isNewValue &&
 		m_pParent &&
-		m_pParent->m_pEntityManager/* &&
-		m_pParent->m_pEntityManager->m_pEntityChanger*/)
+		m_pParent->m_pEntityManager)
 	{
-		m_pEntityManager->AddChangedVariable(m_pParent, this);
-		//m_pParent->m_pEntityManager->m_pEntityChanger->OnVariableChange( m_pParent, this );
+		m_pParent->m_pEntityManager->OnVariableChange(m_pParent, this);
 	}
 }
 
 template<typename T>
 T Variable<T>::Get()
 {
-	m_Mutex.Lock();
-	T value = m_Value;
-	m_Mutex.Unlock();
+	T value;
+	Uint32 sequence;
+	do
+	{
+		sequence = BeginRead();
+		memcpy(&value, &m_Value, sizeof(T));
+	}
+	while (EndRead(sequence) == false);
+
 	return value;
 }
 
 template<typename T>
 T Variable<T>::GetSnapshot()
 {
-	m_Mutex.Lock();
-	T value = m_Snapshot;
-	m_Mutex.Unlock();
+	T value;
+	Uint32 sequence;
+	do
+	{
+		sequence = BeginRead();
+		memcpy(&value, &m_Snapshot, sizeof(T));
+	}
+	while (EndRead(sequence) == false);
+
 	return value;
 }
 
 template<typename T>
 void Variable<T>::TakeSnapshot(const Time & p_Time, const Time & p_InterpolationTime, const Time & p_ExtrapolationTime)
 {
-	m_Mutex.Lock();
+	const Uint32 sequence = BeginWrite();
 	m_Snapshot = m_Value;
-	m_Mutex.Unlock();
+	EndWrite(sequence);
 }
 
 template<typename T>
@@ -93,9 +103,9 @@ void * Variable<T>::GetData()
 template<typename T>
 void Variable<T>::SetData(const void * p_pData, const Time & p_Time, const Time & p_MinimumTime)
 {
-	m_Mutex.Lock();
+	const Uint32 sequence = BeginWrite();
 	memcpy(&m_Value, p_pData, m_Size);
-	m_Mutex.Unlock();
+	EndWrite(sequence);
 }
 
 
@@ -108,6 +118,8 @@ void Variable<T>::SetData(const void * p_pData, const Time & p_Time, const Time
 template<typename T>
 InterpolatedVariable<T>::InterpolatedVariable() :
 	VariableBase(sizeof(T)),
+	m_HistoryStart(0),
+	m_HistoryCount(0),
 	m_LastValue(static_cast<T>(0)),
 	m_Snapshot(static_cast<T>(0)),
 	m_NewValue(true),
@@ -124,6 +136,8 @@ InterpolatedVariable<T>::InterpolatedVariable() :
 template<typename T>
 InterpolatedVariable<T>::InterpolatedVariable(const T & p_Value) :
 	VariableBase(sizeof(T)),
+	m_HistoryStart(0),
+	m_HistoryCount(0),
 	m_LastValue(p_Value),
 	m_Snapshot(static_cast<T>(p_Value)),
 	m_NewValue(true),
@@ -146,11 +160,11 @@ void InterpolatedVariable<T>::Set(const T & p_Value)
 		m_pParent->m_pEntityManager->m_pEntityChanger)
 	{
 		// Set the variable.
-		m_Mutex.Lock();
+		const Uint32 sequence = BeginWrite();
 		Bool isNewValue = m_LastValue != p_Value;
 		m_LastValue = p_Value;
 		m_NewValue = true;
-		m_Mutex.Unlock();
+		EndWrite(sequence);
 
 		//if (isNewValue)
 		{
@@ -163,9 +177,15 @@ template<typename T>
 T InterpolatedVariable<T>::Get()
 {
 	// Server only.
-	m_Mutex.Lock();
-	T value = m_LastValue;
-	m_Mutex.Unlock();
+	T value;
+	Uint32 sequence;
+	do
+	{
+		sequence = BeginRead();
+		memcpy(&value, &m_LastValue, sizeof(T));
+	}
+	while (EndRead(sequence) == false);
+
 	return value;
 }
 
@@ -173,162 +193,148 @@ template<typename T>
 T InterpolatedVariable<T>::GetSnapshot()
 {
 	// Client only.
-	m_Mutex.Lock();
-	T value = m_Snapshot;
-	m_Mutex.Unlock();
+	T value;
+	Uint32 sequence;
+	do
+	{
+		sequence = BeginRead();
+		memcpy(&value, &m_Snapshot, sizeof(T));
+	}
+	while (EndRead(sequence) == false);
+
 	return value;
 }
 
 template<typename T>
 void InterpolatedVariable<T>::TakeSnapshot(const Time & p_Time, const Time & p_InterpolationTime, const Time & p_ExtrapolationTime)
+{
+	// Use the interpolation mode of the entity manager.
+	InterpolationMode::eMode mode = InterpolationMode::Linear;
+	if (m_pParent &&
+		m_pParent->m_pEntityManager)
+	{
+		mode = m_pParent->m_pEntityManager->m_InterpolationMode;
+	}
+
+	// Interpolate as a batch of one.
+	InterpolationBatch batch;
+	batch.Clear(sizeof(T) / sizeof(Float32), mode);
+	Sample(p_Time, p_ExtrapolationTime, batch);
+	batch.Evaluate();
+}
+
+template<typename T>
+void InterpolatedVariable<T>::Sample(const Time & p_Time, const Time & p_ExtrapolationTime, InterpolationBatch & p_Batch)
 {
 	// Lock mutex.
 	m_Mutex.Lock();
 
 	// Is there 0 or 1 values?
-	if (m_Values.size() <= 1)
+	if (m_HistoryCount <= 1)
 	{
-		m_Snapshot = m_LastValue;
+		SetSnapshot(m_LastValue);
 		m_Mutex.Unlock();
 		return;
 	}
 
-	// is there just 1 value?
-	/*if (m_Values.size() == 1)
-	{
-		m_Snapshot = m_Values.front().m_Value;
-		m_Mutex.Unlock();
-		return;
-	}*/
-
-	// Check if the time is lower than the first item in the list.
-	// Then, return the last value.
-	if (p_Time < m_Values.front().m_Time)
+	// Check if the time is lower than the first value.
+	// Then, return the first value.
+	const SizeType frontIndex = GetHistoryIndex(0);
+	if (p_Time < m_HistoryTimes[frontIndex])
 	{
-		ValueList::iterator itFirst = m_Values.begin();
-		ValueList::iterator itSecond = std::next(itFirst);
-
-
-		//std::cout << "Not yet: " << m_Values.front().m_Value.x << "    current time: " << p_Time.AsSeconds() << "   time1: " << (*itFirst).m_Time.AsSeconds() << "   time2: " << (*itSecond).m_Time.AsSeconds() << std::endl;
-		m_Snapshot = m_Values.front().m_Value;
+		SetSnapshot(m_HistoryValues[frontIndex]);
 		m_Mutex.Unlock();
 		return;
 	}
 
-	// Store the values to interpoalte between
-	Value * pFirstValue = NULL;
-	Value * pLastValue = NULL;
+	// Find the values to interpolate between.
+	const SizeType lastValue = m_HistoryCount - 1;
+	const SizeType backIndex = GetHistoryIndex(lastValue);
+	SizeType firstValue = lastValue - 1;
+	Time time = p_Time;
+	Bool extrapolating = false;
 
-	// Check if the time is larger than the last item in the list.
-	// Then, check if we should extrapolate the value.
-	if (p_Time >= m_Values.back().m_Time )
+	// Check if the time is larger than the last value.
+	// Then, extrapolate from the last two values.
+	if (p_Time >= m_HistoryTimes[backIndex])
 	{
-		if (m_Values.back().m_InitialFlag == false)
+		if (m_HistoryInitialFlags[backIndex] == false)
 		{
 			m_LastExtrapolationTime = p_Time;
 			m_IsExtrapolating = true;
 		}
 
-	//	std::cout << "Extrapolate. " << std::endl;
-		// have the time exceeded the extrapolation time?
-		/*if (p_Time >= m_Values.back().m_Time + p_ExtrapolationTime)
+		// Don't extrapolate past the extrapolation time.
+		if (time > m_HistoryTimes[backIndex] + p_ExtrapolationTime)
 		{
-
-			// Set snapshot to max extrapolation time.
-
-			m_Snapshot = m_Values.back().m_Value;
-			m_Mutex.Unlock();
-			return;
+			time = m_HistoryTimes[backIndex] + p_ExtrapolationTime;
 		}
 
-
-		// Extrapolate here
-		ValueList::iterator itLast = std::prev(m_Values.end( ));
-		ValueList::iterator itButOne = std::prev(itLast);
-
-		// Get values to itnerpolate between
-		Value * pFirstValue = &(*itButOne);
-		Value * pLastValue = &(*itLast);
-
-		// Calculate interpolation factor.
-		//Float32 extraFactor = p_ExtrapolationTime.AsSeconds() / p_InterpolationTime.AsSeconds();
-		Float32 factor = ((p_Time - pFirstValue->m_Time).AsSeconds() / (pLastValue->m_Time - pFirstValue->m_Time).AsSeconds());
-
-		// calculate the snapshot.
-		m_Snapshot = pFirstValue->m_Value + ((pLastValue->m_Value - pFirstValue->m_Value) * factor);
-		*/
-
-
-		/*m_Snapshot = m_Values.back().m_Value;
-
-		// Unlock mutex.
-		m_Mutex.Unlock();
-		return;*/
-
-
-		ValueList::iterator itLast = std::prev(m_Values.end());
-		ValueList::iterator itLastButOne = std::prev(itLast);
-
-		pFirstValue = &(*itLastButOne);
-		pLastValue = &(*itLast);
-
+		extrapolating = true;
 	}
 	else
 	{
-
-		// The time is somewhere between the first and last value in the list.
-		// We should find 2 values on each side of the current time, then interpolate.
-		Bool foundValues = false;
-		for (ValueList::iterator it = m_Values.begin(); it != std::prev(m_Values.end()); it++)
-		{
-			// Get the next item as well
-			ValueList::iterator itNext = std::next(it);
-
-			if (p_Time >= (*it).m_Time && p_Time < (*itNext).m_Time)
-			{
-				// Get values to interpoale between.
-				pFirstValue = &(*it);
-				pLastValue = &(*itNext);
-				foundValues = true;
-				break;
-			}
-		}
-
-		// Check if we actually found any values.
-		if (foundValues == false)
+		// The time is somewhere between the first and last value,
+		// search from the last value, the time is usually close to it.
+		while (p_Time < m_HistoryTimes[GetHistoryIndex(firstValue)])
 		{
-			bitLogNetErr(  "Could not find any values." );
-			m_Mutex.Unlock();
-			return;
+			firstValue--;
 		}
-
 	}
 
+	const SizeType fromIndex = GetHistoryIndex(firstValue);
+	const SizeType toIndex = GetHistoryIndex(firstValue + 1);
+	const T & from = m_HistoryValues[fromIndex];
+	const T & to = m_HistoryValues[toIndex];
 
 	// Calculate interpolation factor.
-	Float32 factor = (p_Time - pFirstValue->m_Time).AsSeconds() / (pLastValue->m_Time - pFirstValue->m_Time).AsSeconds();
-
-	
-	// calculate the snapshot.
-	m_Snapshot = pFirstValue->m_Value + ((pLastValue->m_Value - pFirstValue->m_Value) * factor);
-
-	
-	//std::cout << factor << std::endl;// "    " << pFirstValue->m_Value.x << "   " << pLastValue->m_Value.x << "       " << m_Snapshot.x << "    time1: " << p_Time.AsSeconds() << "   time2: " << m_Values.front().m_Time.AsSeconds() << std::endl;
-
-	/*
-	std::cout << "Values: " << m_Values.size() << std::endl;
-	for (ValueList::iterator it = m_Values.begin(); it != m_Values.end(); it++)
+	const Float64 duration = (m_HistoryTimes[toIndex] - m_HistoryTimes[fromIndex]).AsSeconds();
+	Float32 factor = 1.0f;
+	if (duration > 0.0)
 	{
-		std::cout << (*it).m_Value.x << std::endl;
+		factor = static_cast<Float32>((time - m_HistoryTimes[fromIndex]).AsSeconds() / duration);
 	}
 
-	std::cout << std::endl;*/
+	// Calculate the tangents from the neighbouring values, scaled to the duration between the values.
+	// Equal tangents makes the curve a straight line, used for extrapolation.
+	T fromTangent = to - from;
+	T toTangent = to - from;
+	if (extrapolating == false)
+	{
+		if (firstValue > 0)
+		{
+			const SizeType previousIndex = GetHistoryIndex(firstValue - 1);
+			const Float64 span = (m_HistoryTimes[toIndex] - m_HistoryTimes[previousIndex]).AsSeconds();
+			if (span > 0.0)
+			{
+				fromTangent = (to - m_HistoryValues[previousIndex]) * static_cast<Float32>(duration / span);
+			}
+		}
+		if (firstValue + 2 < m_HistoryCount)
+		{
+			const SizeType nextIndex = GetHistoryIndex(firstValue + 2);
+			const Float64 span = (m_HistoryTimes[nextIndex] - m_HistoryTimes[fromIndex]).AsSeconds();
+			if (span > 0.0)
+			{
+				toTangent = (m_HistoryValues[nextIndex] - from) * static_cast<Float32>(duration / span);
+			}
+		}
+	}
 
+	// Add the values to the batch.
+	p_Batch.Add(this,
+				reinterpret_cast<Float32 *>(&m_Snapshot),
+				reinterpret_cast<const Float32 *>(&from),
+				reinterpret_cast<const Float32 *>(&to),
+				reinterpret_cast<const Float32 *>(&fromTangent),
+				reinterpret_cast<const Float32 *>(&toTangent),
+				factor);
 
 	// Unlock mutex.
 	m_Mutex.Unlock();
 }
 
+
 template<typename T>
 void * InterpolatedVariable<T>::GetData()
 {
@@ -347,6 +353,7 @@ void InterpolatedVariable<T>::SetData(const void * p_pData, const Time & p_Time,
 	// Set last value
 	T oldLastValue;
 	
+	const Uint32 sequence = BeginWrite();
 	if (m_IsSet)
 	{
 		oldLastValue = m_LastValue;
@@ -357,6 +364,7 @@ void InterpolatedVariable<T>::SetData(const void * p_pData, const Time & p_Time,
 		memcpy(&m_LastValue, p_pData, m_Size);
 		oldLastValue = m_LastValue;
 	}
+	EndWrite(sequence);
 	
 	
 
@@ -367,32 +375,17 @@ void InterpolatedVariable<T>::SetData(const void * p_pData, const Time & p_Time,
 	m_IsSet = true;
 
 	// No previcously added values?
-	if (m_Values.size() == 0)
+	if (m_HistoryCount == 0)
 	{
 		if (m_IsExtrapolating == false)
 		{
-
-			Value value;
-			value.m_InitialFlag = false;
-			value.m_Time = p_Time - Seconds(1.0f / 22.0f);
-			value.m_Value = oldLastValue;
-			m_Values.push_back(value);
-
-			value.m_Time = p_Time;
-			value.m_Value = m_LastValue;
-			m_Values.push_back(value);
+			AddHistory(p_Time - Seconds(1.0f / 22.0f), oldLastValue, false);
+			AddHistory(p_Time, m_LastValue, false);
 		}
 		else
 		{
-			Value value;
-			value.m_InitialFlag = false;
-			value.m_Time = m_LastExtrapolationTime;
-			value.m_Value = m_Snapshot;
-			m_Values.push_back(value);
-
-			value.m_Time = p_Time;
-			value.m_Value = m_LastValue;
-			m_Values.push_back(value);
+			AddHistory(m_LastExtrapolationTime, m_Snapshot, false);
+			AddHistory(p_Time, m_LastValue, false);
 
 			m_IsExtrapolating = false;
 		}
@@ -402,58 +395,31 @@ void InterpolatedVariable<T>::SetData(const void * p_pData, const Time & p_Time,
 	}
 
 	// Error check the time, make sure it's larger than the last value added.
-	if (m_Values.size())
+	const SizeType backIndex = GetHistoryIndex(m_HistoryCount - 1);
+	if (m_HistoryTimes[backIndex] >= p_Time)
 	{
-		if (m_Values.back().m_Time >= p_Time)
-		{
-			m_Mutex.Unlock();
-			return;
-		}
-
-	}
-
-/*	// Set the intial value, if any, to the current one.
-	if (m_Values.size() && m_Values.front().m_InitialFlag)
-	{
-		Value & frontValue = m_Values.front();
-		frontValue.m_Time = p_Time - Seconds(1.0f / 22.0f);
-		frontValue.m_InitialFlag = false;
+		m_Mutex.Unlock();
+		return;
 	}
-	*/
-
-	// Insert the data in the data queue.
-	Value value;
-	value.m_Time = p_Time;
-	value.m_InitialFlag = false;
-	value.m_Value = m_LastValue;
 
 	// Check if this is a stop value( have we received this value before?)
-	if (value.m_Value == m_Values.back().m_Value)
+	Bool initialFlag = false;
+	if (m_LastValue == m_HistoryValues[backIndex])
 	{
-		value.m_InitialFlag = true;
+		initialFlag = true;
 	}
 	else
 	{
 		// Check if we should modify the back values time.
-		Value & backValue = m_Values.back();
-		if (backValue.m_InitialFlag)
+		if (m_HistoryInitialFlags[backIndex])
 		{
-			backValue.m_InitialFlag = false;
-			backValue.m_Time = p_Time - Seconds(1.0f / 22.0f);
+			m_HistoryInitialFlags[backIndex] = false;
+			m_HistoryTimes[backIndex] = p_Time - Seconds(1.0f / 22.0f);
 		}
 	}
 
 	// Add the new value.
-	m_Values.push_back(value);
-
-	/*
-	ValueList::iterator it = std::prev(std::prev(m_Values.end()));
-
-	Float32 diff = (p_Time - (*it).m_Time).AsSeconds();
-
-	std::cout << "diff: " << diff << std::endl;
-	*/
-
+	AddHistory(p_Time, m_LastValue, initialFlag);
 
 	// Unlock mutex.
 	m_Mutex.Unlock();
@@ -464,9 +430,15 @@ template<typename T>
 Bool InterpolatedVariable<T>::IsNewValue()
 {
 	// Server only.
-	m_Mutex.Lock();
-	Bool status = m_NewValue;
-	m_Mutex.Unlock();
+	Bool status;
+	Uint32 sequence;
+	do
+	{
+		sequence = BeginRead();
+		status = m_NewValue;
+	}
+	while (EndRead(sequence) == false);
+
 	return status;
 }
 
@@ -475,9 +447,40 @@ template<typename T>
 void InterpolatedVariable<T>::SetIsNewValue(const Bool p_Status)
 {
 	// Server only.
-	m_Mutex.Lock();
+	const Uint32 sequence = BeginWrite();
 	m_NewValue = p_Status;
-	m_Mutex.Unlock();
+	EndWrite(sequence);
+}
+
+template<typename T>
+void InterpolatedVariable<T>::SetSnapshot(const T & p_Value)
+{
+	const Uint32 sequence = BeginWrite();
+	m_Snapshot = p_Value;
+	EndWrite(sequence);
+}
+
+template<typename T>
+SizeType InterpolatedVariable<T>::GetHistoryIndex(const SizeType p_Index) const
+{
+	return (m_HistoryStart + p_Index) % HistorySize;
+}
+
+template<typename T>
+void InterpolatedVariable<T>::AddHistory(const Time & p_Time, const T & p_Value, const Bool p_InitialFlag)
+{
+	// Overwrite the oldest value if the ring buffer is full.
+	if (m_HistoryCount == HistorySize)
+	{
+		m_HistoryStart = (m_HistoryStart + 1) % HistorySize;
+		m_HistoryCount--;
+	}
+
+	const SizeType index = GetHistoryIndex(m_HistoryCount);
+	m_HistoryTimes[index] = p_Time;
+	m_HistoryValues[index] = p_Value;
+	m_HistoryInitialFlags[index] = p_InitialFlag;
+	m_HistoryCount++;
 }
 
 template<typename T>
@@ -486,37 +489,13 @@ void InterpolatedVariable<T>::ClearOldData(const Time & p_MinimumTime)
 	// lock mutex
 	m_Mutex.Lock();
 
-	// Do always store at least 1.
-	/*if (m_Values.size( ) <= 1)
-	{
-		m_Mutex.Unlock();
-		return;
-	}
-	*/
-	// Go through the items in the list
-	for (ValueList::iterator it = m_Values.begin(); it != /*std::prev(*/m_Values.end()/*)*/;)
+	// Remove the values older than the minimum time, from the oldest value.
+	while (m_HistoryCount && m_HistoryTimes[m_HistoryStart] <= p_MinimumTime)
 	{
-		if ((*it).m_Time <= p_MinimumTime )
-		{
-			it = m_Values.erase(it);
-		}
-		else
-		{
-			break;
-		}
+		m_HistoryStart = (m_HistoryStart + 1) % HistorySize;
+		m_HistoryCount--;
 	}
 
-	/*if (m_Values.size() == 1)
-	{
-		// Get back value and check if we should change the value to the initial value.
-		Value & frontValue = m_Values.front();
-		if (frontValue.m_Time <= p_MinimumTime)
-		{
-			frontValue.m_Value = m_Snapshot;
-			frontValue.m_InitialFlag = true;
-		}
-	}*/
-
 	// Unlock mutex.
 	m_Mutex.Unlock();
 }
\ No newline at end of file
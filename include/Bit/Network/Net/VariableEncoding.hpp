@@ -0,0 +1,187 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_NETWORK_NET_VARIABLE_ENCODING_HPP
+#define BIT_NETWORK_NET_VARIABLE_ENCODING_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/Network/Net/BitStream.hpp>
+#include <vector>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \ingroup Network
+		/// \brief Encoding of entity variables in the entity snapshots.
+		///
+		/// Set per variable when registering the variable to the entity manager.
+		/// Variables are sent as raw bytes by default.
+		///
+		/// Encodings and supported variable types:
+		///		- Raw:				Any type.
+		///		- Quantized:		Float32 and vectors of Float32, each component
+		///							is clamped to a range and rounded to a precision.
+		///		- Smallest three:	Unit quaternion stored in a Vector4f32(x, y, z, w).
+		///		- Boolean:			Bool, sent as a single bit.
+		///		- Varint:			8, 16, 32 and 64 bit integers, 7 bits at a time.
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API VariableEncoding
+		{
+
+		public:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Encoding type.
+			///
+			////////////////////////////////////////////////////////////////
+			struct Type
+			{
+				enum eType
+				{
+					Raw				= 0,
+					Quantized		= 1,
+					SmallestThree	= 2,
+					Boolean			= 3,
+					VarInt			= 4,
+					SignedVarInt	= 5
+				};
+			};
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Default constructor, raw encoding.
+			///
+			////////////////////////////////////////////////////////////////
+			VariableEncoding( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Create quantized float encoding.
+			///
+			/// \param p_Minimum Minimum value of each component.
+			/// \param p_Maximum Maximum value of each component.
+			/// \param p_Precision Precision of each component.
+			///
+			////////////////////////////////////////////////////////////////
+			static VariableEncoding Quantize(	const Float32 p_Minimum,
+												const Float32 p_Maximum,
+												const Float32 p_Precision );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Create smallest three quaternion encoding.
+			///
+			/// \param p_ComponentBits Bits per component, 2 bits are used for the index of the largest component.
+			///
+			////////////////////////////////////////////////////////////////
+			static VariableEncoding SmallestThree( const Uint8 p_ComponentBits = 10 );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Create boolean encoding.
+			///
+			////////////////////////////////////////////////////////////////
+			static VariableEncoding Boolean( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Create variable length integer encoding.
+			///
+			/// \param p_Signed Zig-zag encode signed integers, keeping small negative numbers small.
+			///
+			////////////////////////////////////////////////////////////////
+			static VariableEncoding VarInt( const Bool p_Signed = false );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the encoding type.
+			///
+			////////////////////////////////////////////////////////////////
+			Type::eType GetType( ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Check if the encoding supports variables of the given size.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool IsValid( const SizeType p_Size ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Write the variable data.
+			///
+			////////////////////////////////////////////////////////////////
+			void Write( BitWriter & p_Writer, const void * p_pData, const SizeType p_Size ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Read the variable data.
+			///
+			/// \return False if there's not enough data, else true.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool Read( BitReader & p_Reader, void * p_pData, const SizeType p_Size ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Append the encoding to the entity class table.
+			///
+			/// Structure:
+			///		- Type(1)
+			///		* Quantized:
+			///			- Minimum(4)
+			///			- Maximum(4)
+			///			- Precision(4)
+			///		* Smallest three:
+			///			- Component bits(1)
+			///
+			////////////////////////////////////////////////////////////////
+			void Serialize( std::vector<Uint8> & p_Message ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Read an encoding from the entity class table.
+			///
+			/// \return False if the data is corrupt, else true.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool Deserialize( const Uint8 * p_pData, const SizeType p_DataSize, SizeType & p_Position );
+
+		private:
+
+			// Private functions
+			////////////////////////////////////////////////////////////////
+			/// \brief Calculate the bits needed for the quantized values.
+			///
+			////////////////////////////////////////////////////////////////
+			void CalculateBits( );
+
+			// Private variables
+			Type::eType		m_Type;			///< Encoding type.
+			Float32			m_Minimum;		///< Minimum value, quantized only.
+			Float32			m_Maximum;		///< Maximum value, quantized only.
+			Float32			m_Precision;	///< Precision, quantized only.
+			Uint32			m_Steps;		///< Number of quantization steps, quantized only.
+			Uint8			m_Bits;			///< Bits per quantized value or component.
+
+		};
+
+	}
+
+}
+
+#endif
@@ -46,6 +46,23 @@ namespace Bit
 
         public:
 
+            ////////////////////////////////////////////////////////////////
+            /// \brief Datagram structure, used by the batched functions.
+            ///
+            ////////////////////////////////////////////////////////////////
+            struct Datagram
+            {
+                Datagram( );
+
+                const void *    pHeader;        ///< Optional header sent in front of the data, not used when receiving.
+                SizeType        HeaderSize;     ///< Size of the header.
+                void *          pData;          ///< Pointer to the data buffer.
+                SizeType        BufferSize;     ///< Size of the data buffer, used when receiving.
+                SizeType        DataSize;       ///< Size of the data.
+                Address         RemoteAddress;  ///< Source or destination address.
+                Uint16          RemotePort;     ///< Source or destination port.
+            };
+
             ////////////////////////////////////////////////////////////////
             /// \brief Destructor
             ///
@@ -61,6 +78,18 @@ namespace Bit
             ////////////////////////////////////////////////////////////////
             virtual Bool Open( const Uint16 p_Port = 0 ) = 0;
 
+            ////////////////////////////////////////////////////////////////
+            /// \brief Open the socket, sharing the port with other sockets
+            ///
+            /// All the sockets opened shared on the same port receive its datagrams,
+            /// distributed by the kernel over the sockets by the hash of each flow.
+            /// Only supported on Linux, by SO_REUSEPORT.
+            ///
+            /// \return False if the port can not be shared or the socket failed to open.
+            ///
+            ////////////////////////////////////////////////////////////////
+            virtual Bool OpenShared( const Uint16 p_Port ) = 0;
+
             ////////////////////////////////////////////////////////////////
             /// \brief Close the socket
             ///
@@ -98,6 +127,36 @@ namespace Bit
             ////////////////////////////////////////////////////////////////
            virtual Int32 Receive( void * p_pData, const SizeType p_Size, Address & p_Address, Uint16 & p_Port, const Time & p_Timeout ) = 0;
 
+            ////////////////////////////////////////////////////////////////
+            /// \brief Send multiple datagrams at once.
+            ///
+            /// \param p_pDatagrams Array of datagrams to send,
+            ///     the header(if any) and the data are sent as a single datagram
+            ///     without being copied into a common buffer.
+            /// \param p_Count Number of datagrams in the array.
+            ///
+            /// \return Number of sent datagrams, -1 if an error occured.
+            ///
+            ////////////////////////////////////////////////////////////////
+            virtual Int32 SendBatch( const Datagram * p_pDatagrams, const SizeType p_Count ) = 0;
+
+            ////////////////////////////////////////////////////////////////
+            /// \brief Receive multiple datagrams at once.
+            ///
+            /// Waits until the first datagram arrives or the timeout expires,
+            /// then receives the already queued datagrams without blocking.
+            /// The blocking state of the socket is not changed.
+            ///
+            /// \param p_pDatagrams Array of datagrams, pData and BufferSize
+            ///     must be set for every datagram by the caller.
+            /// \param p_Count Number of datagrams in the array.
+            /// \param p_Timeout Time until the attemp in receiving the first datagram timeouts.
+            ///
+            /// \return Number of received datagrams, 0 if timed out, -1 if an error occured.
+            ///
+            ////////////////////////////////////////////////////////////////
+            virtual Int32 ReceiveBatch( Datagram * p_pDatagrams, const SizeType p_Count, const Time & p_Timeout ) = 0;
+
         private:
 
         };
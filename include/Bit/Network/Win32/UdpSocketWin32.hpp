@@ -67,6 +67,18 @@ namespace Bit
         ////////////////////////////////////////////////////////////////
         virtual Bool Open( const Uint16 p_Port = 0 );
 
+        ////////////////////////////////////////////////////////////////
+        /// \brief Open the socket, sharing the port with other sockets
+        ///
+        /// All the sockets opened shared on the same port receive its datagrams,
+        /// distributed by the kernel over the sockets by the hash of each flow.
+        /// Only supported on Linux, by SO_REUSEPORT.
+        ///
+        /// \return False if the port can not be shared or the socket failed to open.
+        ///
+        ////////////////////////////////////////////////////////////////
+        virtual Bool OpenShared( const Uint16 p_Port );
+
         ////////////////////////////////////////////////////////////////
         /// \brief Close the socket
         ///
@@ -104,6 +116,22 @@ namespace Bit
         ////////////////////////////////////////////////////////////////
        virtual Int32 Receive( void * p_pData, const SizeType p_Size, Address & p_Address, Uint16 & p_Port, const Time & p_Timeout );
 
+        ////////////////////////////////////////////////////////////////
+        /// \brief Send multiple datagrams at once.
+        ///
+        /// \see Private::UdpSocketBase::SendBatch
+        ///
+        ////////////////////////////////////////////////////////////////
+        virtual Int32 SendBatch( const Datagram * p_pDatagrams, const SizeType p_Count );
+
+        ////////////////////////////////////////////////////////////////
+        /// \brief Receive multiple datagrams at once.
+        ///
+        /// \see Private::UdpSocketBase::ReceiveBatch
+        ///
+        ////////////////////////////////////////////////////////////////
+        virtual Int32 ReceiveBatch( Datagram * p_pDatagrams, const SizeType p_Count, const Time & p_Timeout );
+
     };
 
 }
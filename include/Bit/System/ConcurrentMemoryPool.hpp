@@ -0,0 +1,312 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_SYSTEM_CONCURRENT_MEMORY_POOL_HPP
+#define BIT_SYSTEM_CONCURRENT_MEMORY_POOL_HPP
+
+#include <Bit/Build.hpp>
+#include <atomic>
+#include <thread>
+#include <new>
+
+namespace Bit
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup System
+	/// \brief Thread-safe memory pool class.
+	///
+	/// All the items are carved from a single slab allocated up front,
+	/// every item starting at a cache line boundary.
+	/// Free items are cached in magazines, one per thread slot, which
+	/// makes most gets and returns touch a single uncontended cache line.
+	/// Magazines are refilled from and flushed to a lock-free global
+	/// free list, so items returned by other threads than the getting
+	/// thread flow back to the getting thread.
+	///
+	/// Get and Return can be called by any thread without locking.
+	///
+	////////////////////////////////////////////////////////////////
+	template <typename T>
+	class ConcurrentMemoryPool
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \ingroup System
+		/// \brief Concurrent memory pool item class.
+		///
+		////////////////////////////////////////////////////////////////
+		class Item
+		{
+
+		public:
+
+			// Friend classes
+			friend class ConcurrentMemoryPool;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief	Help function for letting
+			///			the user store the ammount of used data in the item.
+			///			Does not affect the data or size in any way.
+			///
+			////////////////////////////////////////////////////////////////
+			void SetUsedSize( const SizeType p_UsedSize );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get memory pool parent.
+			///
+			////////////////////////////////////////////////////////////////
+			ConcurrentMemoryPool<T> * GetParent( ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get item data.
+			///
+			////////////////////////////////////////////////////////////////
+			T * GetData( ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get item data size.
+			///
+			////////////////////////////////////////////////////////////////
+			SizeType GetDataSize( ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get used data.
+			///
+			/// \see SetUsedSize
+			///
+			////////////////////////////////////////////////////////////////
+			SizeType GetUsedSize( ) const;
+
+		private:
+
+			// Private functions
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Default constructor.
+			///
+			////////////////////////////////////////////////////////////////
+			Item( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Destructor.
+			///
+			////////////////////////////////////////////////////////////////
+			~Item( );
+
+			// Private variables.
+			T *							m_pData;			///< Item data, in the slab unless destroyed at return.
+			SizeType					m_UsedSize;			///< Used size, set by the user.
+			Bool						m_DestroyAtReturn;	///< The item was allocated since the pool was empty.
+			ConcurrentMemoryPool<T> *	m_pParent;			///< Parent memory pool.
+			std::atomic<Uint32>			m_Next;				///< Index of the next item in the global free list.
+
+		};
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Memory pool statistics structure.
+		///
+		////////////////////////////////////////////////////////////////
+		struct Statistics
+		{
+
+			Statistics( );
+
+			Uint64		Hits;		///< Number of gets served by the pool.
+			Uint64		Misses;		///< Number of gets not served by the pool, due to the pool being empty.
+			SizeType	HighWater;	///< Highest number of items in use at the same time.
+									///< Sampled when the global free list is touched, which always happens close to exhaustion.
+
+		};
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Default constructor.
+		///
+		///	\param p_PoolSize Number of items in the pool.
+		/// \param p_ItemSize Size of each pool item. Not in bytes,
+		///					  depending on the data type, int = 4 bytes for example.
+		/// \param p_AllocateNewIfEmpty Allocate new item if the memory pool is empty,
+		///								and remove them at return.
+		///
+		////////////////////////////////////////////////////////////////
+		ConcurrentMemoryPool(	const SizeType p_PoolSize,
+								const SizeType p_ItemSize,
+								const Bool p_AllocateNewIfEmpty = true );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Destructor.
+		///
+		/// Return all the items before destroying the pool.
+		///
+		////////////////////////////////////////////////////////////////
+		~ConcurrentMemoryPool( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get pool item.
+		///
+		/// \return Pointer to the item, NULL if the pool is empty
+		///			and new items are not allocated.
+		///
+		////////////////////////////////////////////////////////////////
+		Item * Get( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Return item to the memory pool.
+		///
+		/// \return true if you could return the item to the pool.
+		///
+		////////////////////////////////////////////////////////////////
+		Bool Return( Item * p_pItem );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the number of items in the pool.
+		///
+		////////////////////////////////////////////////////////////////
+		SizeType GetPoolSize( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the size of each pool item.
+		///
+		////////////////////////////////////////////////////////////////
+		SizeType GetItemSize( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the statistics of the pool.
+		///
+		/// The values are only a snapshot while other threads are using the pool.
+		///
+		////////////////////////////////////////////////////////////////
+		Statistics GetStatistics( ) const;
+
+	private:
+
+		// Private constants
+		static const SizeType	CacheLineSize = 64;		///< Assumed size of a cache line, in bytes.
+		static const Uint32		MagazineSize = 32;		///< Maximum number of items in a magazine.
+		static const Uint32		MaxMagazineCount = 64;	///< Maximum number of magazines.
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Per thread slot cache of free items.
+		///
+		////////////////////////////////////////////////////////////////
+		struct Magazine
+		{
+
+			Magazine( );
+
+			std::atomic<Bool>	Locked;						///< Magazine lock, only try-locked.
+			std::atomic<Uint32>	Count;						///< Number of cached items, read by GetStatistics.
+			std::atomic<Uint64>	Hits;						///< Number of gets served by the magazine.
+			Uint32				Items[ MagazineSize ];		///< Indices of the cached items.
+			Uint8				Padding[ CacheLineSize ];	///< Keeps the neighbor magazines out of the cache line.
+
+		};
+
+		// Private functions
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the index of the calling thread.
+		///
+		////////////////////////////////////////////////////////////////
+		static Uint32 GetThreadIndex( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get a slab item by its index, starting at 1.
+		///
+		////////////////////////////////////////////////////////////////
+		Item * GetItem( const Uint32 p_Index ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Pop an item from the global free list.
+		///
+		/// \return Index of the item, 0 if the list is empty.
+		///
+		////////////////////////////////////////////////////////////////
+		Uint32 PopFree( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Push a linked chain of items to the global free list.
+		///
+		/// \param p_First	Index of the first item in the chain.
+		/// \param p_Last	Index of the last item in the chain.
+		/// \param p_Count	Number of items in the chain.
+		///
+		////////////////////////////////////////////////////////////////
+		void PushFree( const Uint32 p_First, const Uint32 p_Last, const Uint32 p_Count );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get items from the global free list, or allocate a new item.
+		///
+		/// \param p_pMagazine Magazine to refill, NULL if the magazine is busy.
+		///
+		////////////////////////////////////////////////////////////////
+		Item * GetGlobal( Magazine * p_pMagazine );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Pop an item cached in any other magazine.
+		///
+		/// Only called when the global free list is empty, so items cached
+		/// by threads no longer using the pool are never out of reach.
+		///
+		/// \param p_pMagazine Magazine of the calling thread, skipped.
+		///
+		/// \return Index of the item, 0 if all the magazines are empty or busy.
+		///
+		////////////////////////////////////////////////////////////////
+		Uint32 PopMagazines( Magazine * p_pMagazine );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Update the high water mark.
+		///
+		////////////////////////////////////////////////////////////////
+		void UpdateHighWater( );
+
+		// Private variables
+		SizeType				m_PoolSize;				///< Number of items in the slab.
+		SizeType				m_ItemSize;				///< Number of T per item.
+		Bool					m_AllocateNewIfEmpty;	///< Allocate new items if the pool is empty.
+		Uint8 *					m_pSlabMemory;			///< Allocated slab memory.
+		Uint8 *					m_pSlab;				///< Cache line aligned slab.
+		SizeType				m_ItemStride;			///< Distance between the items in the slab, in bytes.
+		Item *					m_pItems;				///< Slab items.
+		Magazine *				m_pMagazines;			///< Magazines.
+		Uint32					m_MagazineMask;			///< Number of magazines - 1.
+		std::atomic<Uint64>		m_FreeHead;				///< Global free list head, the tag in the high 32 bits prevents ABA.
+		std::atomic<Int64>		m_FreeCount;			///< Number of items in the global free list.
+		std::atomic<Int64>		m_NewItems;				///< Number of allocated items not yet returned.
+		std::atomic<Uint64>		m_Hits;					///< Number of gets served by the global free list.
+		std::atomic<Uint64>		m_Misses;				///< Number of gets not served by the pool.
+		std::atomic<SizeType>	m_HighWater;			///< Highest sampled number of items in use.
+
+	};
+
+	////////////////////////////////////////////////////////////////
+	// Include the inline file.
+	////////////////////////////////////////////////////////////////
+	#include <Bit/System/ConcurrentMemoryPool.inl>
+
+}
+
+#endif
@@ -0,0 +1,438 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+// Pool item class.
+template <typename T>
+inline void ConcurrentMemoryPool<T>::Item::SetUsedSize( const SizeType p_UsedSize )
+{
+	m_UsedSize = p_UsedSize;
+}
+
+template <typename T>
+inline ConcurrentMemoryPool<T> * ConcurrentMemoryPool<T>::Item::GetParent( ) const
+{
+	return m_pParent;
+}
+
+template <typename T>
+inline T * ConcurrentMemoryPool<T>::Item::GetData( ) const
+{
+	return m_pData;
+}
+
+template <typename T>
+inline SizeType ConcurrentMemoryPool<T>::Item::GetDataSize( ) const
+{
+	return m_pParent->m_ItemSize;
+}
+
+template <typename T>
+inline SizeType ConcurrentMemoryPool<T>::Item::GetUsedSize( ) const
+{
+	return m_UsedSize;
+}
+
+template <typename T>
+inline ConcurrentMemoryPool<T>::Item::Item( ) :
+	m_pData( NULL ),
+	m_UsedSize( 0 ),
+	m_DestroyAtReturn( false ),
+	m_pParent( NULL ),
+	m_Next( 0 )
+{
+}
+
+template <typename T>
+inline ConcurrentMemoryPool<T>::Item::~Item( )
+{
+	// Only items allocated outside of the slab own their data.
+	if( m_DestroyAtReturn )
+	{
+		delete [ ] m_pData;
+	}
+}
+
+// Statistics struct
+template <typename T>
+inline ConcurrentMemoryPool<T>::Statistics::Statistics( ) :
+	Hits( 0 ),
+	Misses( 0 ),
+	HighWater( 0 )
+{
+}
+
+// Magazine struct
+template <typename T>
+inline ConcurrentMemoryPool<T>::Magazine::Magazine( ) :
+	Locked( false ),
+	Count( 0 ),
+	Hits( 0 )
+{
+}
+
+// Concurrent memory pool class
+template <typename T>
+const SizeType ConcurrentMemoryPool<T>::CacheLineSize;
+
+template <typename T>
+const Uint32 ConcurrentMemoryPool<T>::MagazineSize;
+
+template <typename T>
+const Uint32 ConcurrentMemoryPool<T>::MaxMagazineCount;
+
+template <typename T>
+inline ConcurrentMemoryPool<T>::ConcurrentMemoryPool(	const SizeType p_PoolSize,
+														const SizeType p_ItemSize,
+														const Bool p_AllocateNewIfEmpty ) :
+	m_PoolSize( p_PoolSize ),
+	m_ItemSize( p_ItemSize ),
+	m_AllocateNewIfEmpty( p_AllocateNewIfEmpty ),
+	m_pSlabMemory( NULL ),
+	m_pSlab( NULL ),
+	m_ItemStride( 0 ),
+	m_pItems( NULL ),
+	m_pMagazines( NULL ),
+	m_MagazineMask( 0 ),
+	m_FreeHead( 0 ),
+	m_FreeCount( 0 ),
+	m_NewItems( 0 ),
+	m_Hits( 0 ),
+	m_Misses( 0 ),
+	m_HighWater( 0 )
+{
+	// Allocate the slab, every item starts at a cache line.
+	m_ItemStride = ( ( m_ItemSize * sizeof( T ) + CacheLineSize - 1 ) / CacheLineSize ) * CacheLineSize;
+	if( m_ItemStride == 0 )
+	{
+		m_ItemStride = CacheLineSize;
+	}
+
+	m_pSlabMemory = new Uint8[ m_PoolSize * m_ItemStride + CacheLineSize ];
+	m_pSlab = m_pSlabMemory + ( CacheLineSize - reinterpret_cast<SizeType>( m_pSlabMemory ) % CacheLineSize ) % CacheLineSize;
+
+	// Create the items and link them into the global free list.
+	m_pItems = new Item[ m_PoolSize ];
+	for( SizeType i = 0; i < m_PoolSize; i++ )
+	{
+		Item & item = m_pItems[ i ];
+		item.m_pParent = this;
+		item.m_pData = reinterpret_cast<T *>( m_pSlab + i * m_ItemStride );
+		for( SizeType j = 0; j < m_ItemSize; j++ )
+		{
+			new( item.m_pData + j ) T( );
+		}
+		item.m_Next.store( i + 1 < m_PoolSize ? static_cast<Uint32>( i + 2 ) : 0, std::memory_order_relaxed );
+	}
+
+	if( m_PoolSize )
+	{
+		m_FreeHead.store( 1 );
+		m_FreeCount.store( static_cast<Int64>( m_PoolSize ) );
+	}
+
+	// Create two magazines per hardware thread, to keep the threads sharing a magazine few.
+	Uint32 magazineCount = 2;
+	while( magazineCount < std::thread::hardware_concurrency( ) * 2 && magazineCount < MaxMagazineCount )
+	{
+		magazineCount *= 2;
+	}
+	m_pMagazines = new Magazine[ magazineCount ];
+	m_MagazineMask = magazineCount - 1;
+}
+
+template <typename T>
+inline ConcurrentMemoryPool<T>::~ConcurrentMemoryPool( )
+{
+	for( SizeType i = 0; i < m_PoolSize; i++ )
+	{
+		for( SizeType j = 0; j < m_ItemSize; j++ )
+		{
+			m_pItems[ i ].m_pData[ j ].~T( );
+		}
+	}
+
+	delete [ ] m_pMagazines;
+	delete [ ] m_pItems;
+	delete [ ] m_pSlabMemory;
+}
+
+template <typename T>
+inline typename ConcurrentMemoryPool<T>::Item * ConcurrentMemoryPool<T>::Get( )
+{
+	Magazine * pMagazine = &m_pMagazines[ GetThreadIndex( ) & m_MagazineMask ];
+
+	// Another thread is using the magazine, go for the global free list.
+	if( pMagazine->Locked.exchange( true, std::memory_order_acquire ) )
+	{
+		return GetGlobal( NULL );
+	}
+
+	// Take the last cached item.
+	const Uint32 count = pMagazine->Count.load( std::memory_order_relaxed );
+	if( count )
+	{
+		const Uint32 index = pMagazine->Items[ count - 1 ];
+		pMagazine->Count.store( count - 1, std::memory_order_relaxed );
+		pMagazine->Hits.store( pMagazine->Hits.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+		pMagazine->Locked.store( false, std::memory_order_release );
+		return GetItem( index );
+	}
+
+	// Refill the empty magazine.
+	Item * pItem = GetGlobal( pMagazine );
+	pMagazine->Locked.store( false, std::memory_order_release );
+	return pItem;
+}
+
+template <typename T>
+inline Bool ConcurrentMemoryPool<T>::Return( Item * p_pItem )
+{
+	// Validate the item.
+	if( p_pItem == NULL || p_pItem->m_pParent != this )
+	{
+		return false;
+	}
+
+	// Check if we should destroy the item.
+	if( p_pItem->m_DestroyAtReturn )
+	{
+		m_NewItems.fetch_sub( 1, std::memory_order_relaxed );
+		delete p_pItem;
+		return true;
+	}
+
+	p_pItem->m_UsedSize = 0;
+	const Uint32 index = static_cast<Uint32>( p_pItem - m_pItems ) + 1;
+
+	// Another thread is using the magazine, go for the global free list.
+	Magazine * pMagazine = &m_pMagazines[ GetThreadIndex( ) & m_MagazineMask ];
+	if( pMagazine->Locked.exchange( true, std::memory_order_acquire ) )
+	{
+		PushFree( index, index, 1 );
+		return true;
+	}
+
+	// Flush half of the full magazine to the global free list,
+	// the other half is kept for the next gets.
+	Uint32 count = pMagazine->Count.load( std::memory_order_relaxed );
+	if( count == MagazineSize )
+	{
+		const Uint32 flushCount = MagazineSize / 2;
+		const Uint32 first = count - flushCount;
+		for( Uint32 i = first; i < count - 1; i++ )
+		{
+			GetItem( pMagazine->Items[ i ] )->m_Next.store( pMagazine->Items[ i + 1 ], std::memory_order_relaxed );
+		}
+		PushFree( pMagazine->Items[ first ], pMagazine->Items[ count - 1 ], flushCount );
+		count = first;
+	}
+
+	pMagazine->Items[ count ] = index;
+	pMagazine->Count.store( count + 1, std::memory_order_relaxed );
+	pMagazine->Locked.store( false, std::memory_order_release );
+
+	return true;
+}
+
+template <typename T>
+inline SizeType ConcurrentMemoryPool<T>::GetPoolSize( ) const
+{
+	return m_PoolSize;
+}
+
+template <typename T>
+inline SizeType ConcurrentMemoryPool<T>::GetItemSize( ) const
+{
+	return m_ItemSize;
+}
+
+template <typename T>
+inline typename ConcurrentMemoryPool<T>::Statistics ConcurrentMemoryPool<T>::GetStatistics( ) const
+{
+	Statistics statistics;
+	statistics.Hits = m_Hits.load( std::memory_order_relaxed );
+	statistics.Misses = m_Misses.load( std::memory_order_relaxed );
+	statistics.HighWater = m_HighWater.load( std::memory_order_relaxed );
+
+	for( Uint32 i = 0; i <= m_MagazineMask; i++ )
+	{
+		statistics.Hits += m_pMagazines[ i ].Hits.load( std::memory_order_relaxed );
+	}
+
+	return statistics;
+}
+
+template <typename T>
+inline Uint32 ConcurrentMemoryPool<T>::GetThreadIndex( )
+{
+	static std::atomic<Uint32> s_NextIndex( 0 );
+	static thread_local Uint32 s_Index = s_NextIndex.fetch_add( 1, std::memory_order_relaxed );
+	return s_Index;
+}
+
+template <typename T>
+inline typename ConcurrentMemoryPool<T>::Item * ConcurrentMemoryPool<T>::GetItem( const Uint32 p_Index ) const
+{
+	return &m_pItems[ p_Index - 1 ];
+}
+
+template <typename T>
+inline Uint32 ConcurrentMemoryPool<T>::PopFree( )
+{
+	Uint64 head = m_FreeHead.load( std::memory_order_acquire );
+	while( true )
+	{
+		const Uint32 index = static_cast<Uint32>( head );
+		if( index == 0 )
+		{
+			return 0;
+		}
+
+		// The item may be popped and pushed again by other threads meanwhile,
+		// the tag makes the exchange fail in that case.
+		const Uint32 next = GetItem( index )->m_Next.load( std::memory_order_relaxed );
+		const Uint64 newHead = ( ( ( head >> 32 ) + 1 ) << 32 ) | next;
+		if( m_FreeHead.compare_exchange_weak( head, newHead, std::memory_order_acquire, std::memory_order_acquire ) )
+		{
+			m_FreeCount.fetch_sub( 1, std::memory_order_relaxed );
+			return index;
+		}
+	}
+}
+
+template <typename T>
+inline void ConcurrentMemoryPool<T>::PushFree( const Uint32 p_First, const Uint32 p_Last, const Uint32 p_Count )
+{
+	Item * pLast = GetItem( p_Last );
+	Uint64 head = m_FreeHead.load( std::memory_order_relaxed );
+	Uint64 newHead = 0;
+	do
+	{
+		pLast->m_Next.store( static_cast<Uint32>( head ), std::memory_order_relaxed );
+		newHead = ( ( ( head >> 32 ) + 1 ) << 32 ) | p_First;
+	}
+	while( m_FreeHead.compare_exchange_weak( head, newHead, std::memory_order_release, std::memory_order_relaxed ) == false );
+
+	m_FreeCount.fetch_add( p_Count, std::memory_order_relaxed );
+}
+
+template <typename T>
+inline typename ConcurrentMemoryPool<T>::Item * ConcurrentMemoryPool<T>::GetGlobal( Magazine * p_pMagazine )
+{
+	Uint32 index = PopFree( );
+
+	// The global free list is empty, take an item cached by another thread slot.
+	if( index == 0 )
+	{
+		index = PopMagazines( p_pMagazine );
+	}
+
+	// Refill half of the magazine, the first popped item is returned.
+	if( index && p_pMagazine )
+	{
+		Uint32 count = 0;
+		Uint32 cachedIndex = 0;
+		while( count < MagazineSize / 2 && ( cachedIndex = PopFree( ) ) != 0 )
+		{
+			p_pMagazine->Items[ count++ ] = cachedIndex;
+		}
+		p_pMagazine->Count.store( count, std::memory_order_relaxed );
+	}
+
+	if( index )
+	{
+		m_Hits.fetch_add( 1, std::memory_order_relaxed );
+		UpdateHighWater( );
+		return GetItem( index );
+	}
+
+	// The pool is empty.
+	m_Misses.fetch_add( 1, std::memory_order_relaxed );
+	if( m_AllocateNewIfEmpty == false )
+	{
+		UpdateHighWater( );
+		return NULL;
+	}
+
+	Item * pItem = new Item;
+	pItem->m_pParent = this;
+	pItem->m_pData = new T[ m_ItemSize ];
+	pItem->m_DestroyAtReturn = true;
+	m_NewItems.fetch_add( 1, std::memory_order_relaxed );
+	UpdateHighWater( );
+
+	return pItem;
+}
+
+template <typename T>
+inline Uint32 ConcurrentMemoryPool<T>::PopMagazines( Magazine * p_pMagazine )
+{
+	for( Uint32 i = 0; i <= m_MagazineMask; i++ )
+	{
+		Magazine * pMagazine = &m_pMagazines[ i ];
+		if( pMagazine == p_pMagazine ||
+			pMagazine->Count.load( std::memory_order_relaxed ) == 0 ||
+			pMagazine->Locked.exchange( true, std::memory_order_acquire ) )
+		{
+			continue;
+		}
+
+		Uint32 index = 0;
+		const Uint32 count = pMagazine->Count.load( std::memory_order_relaxed );
+		if( count )
+		{
+			index = pMagazine->Items[ count - 1 ];
+			pMagazine->Count.store( count - 1, std::memory_order_relaxed );
+		}
+		pMagazine->Locked.store( false, std::memory_order_release );
+
+		if( index )
+		{
+			return index;
+		}
+	}
+
+	return 0;
+}
+
+template <typename T>
+inline void ConcurrentMemoryPool<T>::UpdateHighWater( )
+{
+	// Items in use are the items neither in the global free list nor in any magazine.
+	Int64 inUse = static_cast<Int64>( m_PoolSize ) + m_NewItems.load( std::memory_order_relaxed ) - m_FreeCount.load( std::memory_order_relaxed );
+	for( Uint32 i = 0; i <= m_MagazineMask; i++ )
+	{
+		inUse -= static_cast<Int64>( m_pMagazines[ i ].Count.load( std::memory_order_relaxed ) );
+	}
+
+	if( inUse <= 0 )
+	{
+		return;
+	}
+
+	SizeType highWater = m_HighWater.load( std::memory_order_relaxed );
+	while( static_cast<SizeType>( inUse ) > highWater &&
+		   m_HighWater.compare_exchange_weak( highWater, static_cast<SizeType>( inUse ), std::memory_order_relaxed ) == false )
+	{
+	}
+}
@@ -0,0 +1,322 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_SYSTEM_JOB_SYSTEM_HPP
+#define BIT_SYSTEM_JOB_SYSTEM_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/System/Thread.hpp>
+#include <Bit/System/ThreadValue.hpp>
+#include <Bit/System/Semaphore.hpp>
+#include <Bit/System/Private/WorkStealingDeque.hpp>
+#include <functional>
+#include <atomic>
+#include <vector>
+#include <queue>
+
+namespace Bit
+{
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup System
+	/// \brief Work-stealing job system.
+	///
+	/// Runs small jobs on a fixed set of worker threads, one per core.
+	/// Every worker owns a work-stealing deque, jobs run by a worker
+	/// are pushed to its own deque and idle workers steal from the
+	/// other deques. Jobs run by other threads are pushed to a
+	/// shared queue.
+	///
+	/// Completion is tracked by counters, a job can increase a counter
+	/// that is decreased once the job has finished, and a job can depend
+	/// on a counter, it is not started until the counter reaches 0.
+	/// Waiting for a counter executes pending jobs instead of blocking,
+	/// so jobs may wait for other jobs.
+	///
+	/// Example:
+	/// \code
+	/// JobSystem jobs;
+	/// jobs.Start( );
+	///
+	/// JobSystem::Counter decoded, uploaded;
+	/// jobs.Run( [ ] ( ) { DecodeTexture( ); }, &decoded );
+	/// jobs.Run( [ ] ( ) { UploadTexture( ); }, &uploaded, &decoded );
+	/// jobs.ParallelFor( 0, entities.size( ), [ & ] ( SizeType p_Begin, SizeType p_End ) { ... } );
+	/// jobs.Wait( uploaded );
+	/// \endcode
+	///
+	////////////////////////////////////////////////////////////////
+	class BIT_API JobSystem
+	{
+
+	public:
+
+		// Forward declarations
+		struct Job;
+
+		// Public typedefs
+		typedef std::function< void( ) > Function;
+		typedef std::function< void( const SizeType p_Begin, const SizeType p_End ) > RangeFunction;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Job counter class.
+		///
+		/// Counts the unfinished jobs associated with the counter.
+		/// Do not destroy a counter with unfinished jobs or dependent jobs,
+		/// call JobSystem::Wait before destroying it.
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API Counter
+		{
+
+		public:
+
+			// Friend classes
+			friend class JobSystem;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Default constructor.
+			///
+			////////////////////////////////////////////////////////////////
+			Counter( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Check if all the jobs of the counter are finished.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool IsDone( ) const;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the number of unfinished jobs.
+			///
+			////////////////////////////////////////////////////////////////
+			Uint32 GetCount( ) const;
+
+		private:
+
+			// Private typedefs
+			typedef std::vector<Job *> JobVector;
+
+			// Private variables
+			std::atomic<Uint32>		m_Count;		///< Number of unfinished jobs.
+			ThreadValue<JobVector>	m_Dependents;	///< Jobs waiting for the counter to reach 0.
+
+		};
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Default constructor.
+		///
+		////////////////////////////////////////////////////////////////
+		JobSystem( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Destructor.
+		///
+		////////////////////////////////////////////////////////////////
+		~JobSystem( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Start the worker threads.
+		///
+		/// \param p_WorkerCount Number of worker threads.
+		///		One less than the number of hardware threads is used if 0,
+		///		since the waiting threads are executing jobs as well.
+		///
+		/// \return True if succeeded, else false.
+		///
+		////////////////////////////////////////////////////////////////
+		Bool Start( const Uint32 p_WorkerCount = 0 );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Stop the worker threads.
+		///
+		/// The pending jobs are executed by the calling thread
+		/// after the workers have stopped, decreasing their counters,
+		/// so no thread is left waiting for them.
+		///
+		////////////////////////////////////////////////////////////////
+		void Stop( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Check if the job system is running.
+		///
+		////////////////////////////////////////////////////////////////
+		Bool IsRunning( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the number of worker threads.
+		///
+		////////////////////////////////////////////////////////////////
+		Uint32 GetWorkerCount( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Run a job.
+		///
+		/// The job is executed right away by the calling thread
+		/// if the job system is not running.
+		///
+		/// \param p_Function		The function to execute.
+		/// \param p_pCounter		Counter to increase until the job is finished. Optional.
+		/// \param p_pDependency	Counter to wait for before the job is started. Optional.
+		///
+		////////////////////////////////////////////////////////////////
+		void Run( const Function & p_Function, Counter * p_pCounter = NULL, Counter * p_pDependency = NULL );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Wait for all the jobs of the counter to finish.
+		///
+		/// The calling thread executes pending jobs while waiting.
+		///
+		////////////////////////////////////////////////////////////////
+		void Wait( Counter & p_Counter );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Execute a function over a range of indices in parallel.
+		///
+		/// The range is split in halves by the jobs, until the size of
+		/// the range is less or equal to the grain size. The upper halves
+		/// are pushed as new jobs which idle workers can steal.
+		/// The function returns when the whole range is executed.
+		///
+		/// \param p_Begin		First index.
+		/// \param p_End		One past the last index.
+		/// \param p_Function	Function executed for every subrange.
+		/// \param p_GrainSize	Maximum number of indices per function call.
+		///		The grain size is picked from the number of workers if 0.
+		///
+		////////////////////////////////////////////////////////////////
+		void ParallelFor( const SizeType p_Begin, const SizeType p_End, const RangeFunction & p_Function, const SizeType p_GrainSize = 0 );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Job structure.
+		///
+		////////////////////////////////////////////////////////////////
+		struct Job
+		{
+
+			Job( const JobSystem::Function & p_Function, Counter * p_pCounter );
+
+			JobSystem::Function		Function;	///< The function to execute.
+			Counter *				pCounter;	///< Counter to decrease when finished, NULL if none.
+
+		};
+
+	private:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Worker structure.
+		///
+		////////////////////////////////////////////////////////////////
+		struct Worker
+		{
+
+			Worker( JobSystem * p_pJobSystem, const Uint32 p_Index );
+
+			JobSystem *						pJobSystem;		///< Owning job system.
+			const Uint32					Index;			///< Index of the worker.
+			Uint32							RandomSeed;		///< Seed for picking victims to steal from.
+			Private::WorkStealingDeque<Job>	Deque;			///< Jobs pushed by the worker.
+			Bit::Thread						Thread;			///< Worker thread.
+
+		};
+
+		// Private typedefs
+		typedef std::vector<Worker *>	WorkerVector;
+		typedef std::queue<Job *>		JobQueue;
+
+		// Private functions
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the worker of the calling thread.
+		///
+		/// \return Pointer to the worker, NULL if the calling thread
+		///			is not a worker of this job system.
+		///
+		////////////////////////////////////////////////////////////////
+		Worker * GetCurrentWorker( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Push a job ready to run and wake up a sleeping worker.
+		///
+		////////////////////////////////////////////////////////////////
+		void Push( Job * p_pJob );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Find a job to execute.
+		///
+		/// Pops from the worker's own deque first, then from the shared queue,
+		/// and finally tries to steal from the other workers.
+		///
+		/// \param p_pWorker The worker of the calling thread, NULL if none.
+		///
+		/// \return Pointer to the job, NULL if no job was found.
+		///
+		////////////////////////////////////////////////////////////////
+		Job * FindJob( Worker * p_pWorker );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Execute and delete a job, decrease its counter.
+		///
+		////////////////////////////////////////////////////////////////
+		void Execute( Job * p_pJob );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Decrease a counter, push the dependent jobs when reaching 0.
+		///
+		////////////////////////////////////////////////////////////////
+		void Decrease( Counter * p_pCounter );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Check if there are any jobs in the queue or in any deque.
+		///
+		////////////////////////////////////////////////////////////////
+		Bool HasJobs( ) const;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Worker thread function.
+		///
+		////////////////////////////////////////////////////////////////
+		void WorkerFunction( Worker * p_pWorker );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Run a job executing a subrange of a parallel for.
+		///
+		////////////////////////////////////////////////////////////////
+		void RunRange( const SizeType p_Begin, const SizeType p_End, const SizeType p_GrainSize,
+					   const RangeFunction * p_pFunction, Counter * p_pCounter );
+
+		// Private variables
+		static const Uint32		SpinCount;			///< Number of failed job searches before a worker sleeps.
+		std::atomic<Bool>		m_Running;			///< Flag for checking if the job system is running.
+		WorkerVector			m_Workers;			///< Worker threads.
+		ThreadValue<JobQueue>	m_Queue;			///< Jobs pushed by other threads than the workers.
+		std::atomic<Uint32>		m_QueueSize;		///< Number of jobs in the shared queue.
+		std::atomic<Uint32>		m_SleepingWorkers;	///< Number of sleeping workers.
+		std::atomic<Uint32>		m_WaitingThreads;	///< Number of threads in Wait, searching the workers for jobs.
+		Semaphore				m_WakeSemaphore;	///< Semaphore for waking up sleeping workers.
+
+	};
+
+}
+
+#endif
@@ -0,0 +1,119 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_SYSTEM_FUTEX_LINUX_HPP
+#define BIT_SYSTEM_FUTEX_LINUX_HPP
+
+#include <Bit/Build.hpp>
+#ifdef BIT_PLATFORM_LINUX
+#include <Bit/System/Time.hpp>
+#include <atomic>
+
+namespace Bit
+{
+
+	namespace Private
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \ingroup System
+		/// \brief Linux futex helper functions.
+		///
+		/// Thin wrappers around the futex system call, used by the
+		/// Linux mutex, semaphore and thread event classes.
+		/// All futexes are process private.
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API FutexLinux
+		{
+
+		public:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the deadline of a relative timeout.
+			///
+			/// \param p_Timeout Relative timeout. No timeout if value is 0.
+			///
+			/// \return Absolute deadline in monotonic clock nanoseconds,
+			///			0 if there is no deadline.
+			///
+			////////////////////////////////////////////////////////////////
+			static Uint64 GetDeadline( const Time & p_Timeout );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Put the calling thread to sleep while the value equals the expected value.
+			///
+			/// The function may return spuriously, the caller is
+			/// expected to check the value again.
+			///
+			/// \param p_Value		The futex word.
+			/// \param p_Expected	The value to sleep on.
+			/// \param p_Deadline	Deadline from GetDeadline. No deadline if value is 0.
+			///
+			/// \return False if the deadline has passed, else true.
+			///
+			////////////////////////////////////////////////////////////////
+			static Bool Wait( std::atomic<Int32> & p_Value, const Int32 p_Expected, const Uint64 p_Deadline = 0 );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Wake up threads waiting on the futex word.
+			///
+			/// \param p_Value	The futex word.
+			/// \param p_Count	Maximum number of threads to wake up.
+			///
+			////////////////////////////////////////////////////////////////
+			static void Wake( std::atomic<Int32> & p_Value, const Int32 p_Count );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Check if spin waiting is worthwhile.
+			///
+			/// Spinning only makes sense if the thread holding the resource
+			/// can run at the same time, on another processor.
+			///
+			/// \return True if there are more than one online processor.
+			///
+			////////////////////////////////////////////////////////////////
+			static Bool IsMultiProcessor( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Hint the CPU that the calling thread is spin waiting.
+			///
+			////////////////////////////////////////////////////////////////
+			static inline void Relax( )
+			{
+				#if defined( __i386__ ) || defined( __x86_64__ )
+					__builtin_ia32_pause( );
+				#else
+					std::atomic_signal_fence( std::memory_order_seq_cst );
+				#endif
+			}
+
+		};
+
+	}
+
+}
+
+#endif
+
+#endif
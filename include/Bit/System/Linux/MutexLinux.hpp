@@ -27,7 +27,7 @@
 
 #include <Bit/Build.hpp>
 #ifdef BIT_PLATFORM_LINUX
-#include <pthread.h>
+#include <atomic>
 
 namespace Bit
 {
@@ -37,6 +37,12 @@ namespace Bit
 	/// \ingroup System
 	/// \brief Linux mutex.
 	///
+	/// Adaptive mutex built on a futex word. A contended lock spins
+	/// for a bounded number of iterations before the thread is put
+	/// to sleep in the kernel. The spin limit adapts to how long
+	/// the lock usually is held. Unlocking only enters the kernel
+	/// if there are sleeping threads.
+	///
 	////////////////////////////////////////////////////////////////
 	class BIT_API MutexLinux
 	{
@@ -69,7 +75,30 @@ namespace Bit
 
 	private:
 
-		pthread_mutex_t m_Mutex;
+		////////////////////////////////////////////////////////////////
+		/// \brief Lock the contended mutex.
+		///
+		////////////////////////////////////////////////////////////////
+		void LockContended( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Mutex states.
+		///
+		////////////////////////////////////////////////////////////////
+		struct State
+		{
+			enum eState
+			{
+				Unlocked = 0,	///< The mutex is unlocked.
+				Locked = 1,		///< The mutex is locked, no threads are sleeping.
+				Contended = 2	///< The mutex is locked, threads might be sleeping.
+			};
+		};
+
+		// Private variables
+		static const Int32		MaxSpinCount;	///< Maximum number of spin iterations before sleeping.
+		std::atomic<Int32>		m_State;		///< Mutex state, the futex word.
+		std::atomic<Int32>		m_SpinCount;	///< Average number of spin iterations needed to lock.
 
 	};
 
@@ -0,0 +1,111 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_SYSTEM_SEMAPHORE_LINUX_HPP
+#define BIT_SYSTEM_SEMAPHORE_LINUX_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/System/Time.hpp>
+#ifdef BIT_PLATFORM_LINUX
+#include <atomic>
+
+namespace Bit
+{
+
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup System
+	/// \brief Linux sempahore.
+	///
+	/// The count is kept in a futex word, waiting threads spin for
+	/// a short while before sleeping in the kernel, and releasing
+	/// threads only enter the kernel if there are sleeping waiters.
+	///
+	////////////////////////////////////////////////////////////////
+	class BIT_API SemaphoreLinux
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Default constructor
+		///
+		////////////////////////////////////////////////////////////////
+		SemaphoreLinux( const Uint32 & p_InitialCount = 0, const Uint32 & p_MaximumCount = 10000 );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Destructor
+		///
+		////////////////////////////////////////////////////////////////
+		~SemaphoreLinux( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Wait until the semaphore is larger than 0.
+		///
+		////////////////////////////////////////////////////////////////
+		void Wait( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Wait until the semaphore is larger than 0.
+		///
+		/// \param p_Timeout	Time for the sempahore wait to timeout.
+		///						No timeout if value is 0.
+		///
+		////////////////////////////////////////////////////////////////
+		void Wait( const Time & p_Timeout );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Release the semaphore by the ammount.
+		///
+		////////////////////////////////////////////////////////////////
+		void Release( const Uint32 & p_Ammount = 1 );
+
+	private:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Decrement the count if it is larger than 0.
+		///
+		/// \return True if the count was decremented, else false.
+		///
+		////////////////////////////////////////////////////////////////
+		Bool TryDecrement( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Wait until the semaphore is larger than 0, or until the deadline.
+		///
+		////////////////////////////////////////////////////////////////
+		void WaitUntil( const Uint64 p_Deadline );
+
+		// Private variables
+		static const Uint32		SpinCount;		///< Number of spin iterations before sleeping.
+		std::atomic<Int32>		m_Count;		///< Current count, the futex word.
+		std::atomic<Int32>		m_Waiters;		///< Number of threads sleeping, or about to sleep.
+		const Int32				m_MaximumCount;	///< Maximum count.
+
+	};
+
+}
+
+#endif
+
+#endif
@@ -0,0 +1,121 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_SYSTEM_THREAD_EVENT_LINUX_HPP
+#define BIT_SYSTEM_THREAD_EVENT_LINUX_HPP
+
+#include <Bit/Build.hpp>
+#include <Bit/System/Time.hpp>
+#ifdef BIT_PLATFORM_LINUX
+#include <atomic>
+
+namespace Bit
+{
+
+
+	////////////////////////////////////////////////////////////////
+	/// \ingroup System
+	/// \brief Linux thread event.
+	///
+	/// Auto reset events wake up a single waiting thread and
+	/// reset when the waiting thread is released.
+	/// Manual reset events wake up all waiting threads and stay
+	/// signaled until reset.
+	///
+	////////////////////////////////////////////////////////////////
+	class BIT_API ThreadEventLinux
+	{
+
+	public:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Default constructor
+		///
+		/// \param p_ManualReset	Reset the event manually via Reset.
+		/// \param p_InitialState	Create the event signaled.
+		///
+		////////////////////////////////////////////////////////////////
+		ThreadEventLinux( const Bool p_ManualReset = false, const Bool p_InitialState = false );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Destructor
+		///
+		////////////////////////////////////////////////////////////////
+		~ThreadEventLinux( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Signal the event.
+		///
+		////////////////////////////////////////////////////////////////
+		void Set( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Reset the event to non-signaled.
+		///
+		////////////////////////////////////////////////////////////////
+		void Reset( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Wait until the event is signaled.
+		///
+		////////////////////////////////////////////////////////////////
+		void Wait( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Wait until the event is signaled.
+		///
+		/// \param p_Timeout	Time for the event wait to timeout.
+		///						No timeout if value is 0.
+		///
+		////////////////////////////////////////////////////////////////
+		void Wait( const Time & p_Timeout );
+
+	private:
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Consume the signal of the event.
+		///
+		/// \return True if the event was signaled, else false.
+		///
+		////////////////////////////////////////////////////////////////
+		Bool TryConsume( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Wait until the event is signaled, or until the deadline.
+		///
+		////////////////////////////////////////////////////////////////
+		void WaitUntil( const Uint64 p_Deadline );
+
+		// Private variables
+		static const Uint32		SpinCount;		///< Number of spin iterations before sleeping.
+		std::atomic<Int32>		m_State;		///< 1 if signaled, else 0. The futex word.
+		std::atomic<Int32>		m_Waiters;		///< Number of threads sleeping, or about to sleep.
+		const Bool				m_ManualReset;	///< Flag for manual reset events.
+
+	};
+
+}
+
+#endif
+
+#endif
@@ -29,6 +29,7 @@
 #ifdef BIT_PLATFORM_LINUX
 #include <Bit/System/SmartMutex.hpp>
 #include <functional>
+#include <pthread.h>
 
 namespace Bit
 {
@@ -104,6 +105,7 @@ namespace Bit
 
 		// Private variables
 		Bool m_Running;			///< Thread status.
+		Bool m_Joinable;		///< The thread is started and not joined yet.
 		pthread_t m_Thread;		///< POSIX thread.
 		Function m_Function;	///< The thread function.
 		Mutex m_Mutex;			///< Mutex for m_Running variable,
@@ -28,15 +28,41 @@
 #include <Bit/Build.hpp>
 #include <Bit/System/Private/LogManager.hpp>
 
+/// Compile time filtering of log messages.
+/// Define BIT_LOG_LEVEL as the least severe Bit::Log::eType to keep, and BIT_LOG_CHANNELS as a
+/// bit mask of the Bit::Log::eChannel channels to keep. Channels above 31 are always kept.
+/// The message expression of a filtered call is never evaluated, and is removed by the compiler.
+/// Example of usage, keeping errors and warnings of the network channel only:
+///		-DBIT_LOG_LEVEL=Bit::Log::Warning -DBIT_LOG_CHANNELS="(1 << Bit::Log::Network)"
+#ifndef BIT_LOG_LEVEL
+#define BIT_LOG_LEVEL Bit::Log::Debug
+#endif
+
+#ifndef BIT_LOG_CHANNELS
+#define BIT_LOG_CHANNELS 0xFFFFFFFF
+#endif
+
+#define bitLogIsEnabled(type, channel) \
+	( static_cast<Bit::Uint32>(type) <= static_cast<Bit::Uint32>(BIT_LOG_LEVEL) && \
+	( static_cast<Bit::Uint32>(channel) > 31 || ( static_cast<Bit::Uint32>(BIT_LOG_CHANNELS) & ( 1U << ( static_cast<Bit::Uint32>(channel) & 31 ) ) ) != 0 ) )
+
 /// Main macro for logging. pass the Bit::Log::eType of the message, and then the message itself.
-/// The following macros are thread safe.
+/// The following macros are thread safe, and do not block: the message is formatted by the calling thread,
+/// and handled by a background thread. Call Bit::Log::Flush to wait for the posted messages.
 /// CAUTION: The message actually is supposed to be in the format: << data << more data << "This is a string".
 /// Example of usage:
 ///		bitLog(Bit::Log::Error, MY_CHANNEL_NUMBER, "This is an error, id: " << 123 );
 #define bitLog(type, channel, message) \
-	Bit::Private::LogManager::Start(type, channel, __FILE__, __LINE__, __FUNCTION__); \
-	Bit::Private::LogManager::GetStream() << message; \
-	Bit::Private::LogManager::End();
+	do \
+	{ \
+		if( bitLogIsEnabled(type, channel) ) \
+		{ \
+			Bit::Private::LogManager::Start(type, channel, __FILE__, __LINE__, __FUNCTION__); \
+			Bit::Private::LogManager::GetStream() << message; \
+			Bit::Private::LogManager::End(); \
+		} \
+	} \
+	while( false )
 
 
 // Macros for logging Errors, Warnings and Info. Just pass the message for respective macro, and the channel.
@@ -48,7 +74,7 @@
 // Macro for loggin Debug messages, only for debug profile.
 #define bitLogDebug(channel, message)	bitLog( Bit::Log::Debug,	channel, message)
 #else
-#define bitLogDebug(message)
+#define bitLogDebug(channel, message)
 #endif
 
 
@@ -56,7 +82,7 @@
 #define bitLogAud(type, message)	bitLog( type,				Bit::Log::Audio, message)
 #define bitLogAudErr(message)		bitLog( Bit::Log::Error,	Bit::Log::Audio, message)
 #define bitLogAudWarn(message)		bitLog( Bit::Log::Warning,	Bit::Log::Audio, message)
-#define bitLogAudInfo(message)		bitLog( Bit::Log::Info,		Bit::Log::Audio)
+#define bitLogAudInfo(message)		bitLog( Bit::Log::Info,		Bit::Log::Audio, message)
 
 #ifdef BIT_BUILD_DEBUG
 // Macro for loggin Audio Debug messages, only for debug profile.
@@ -70,7 +96,7 @@
 #define bitLogGra(type, message)	bitLog( type,				Bit::Log::Graphics, message)
 #define bitLogGraErr(message)		bitLog( Bit::Log::Error,	Bit::Log::Graphics, message)
 #define bitLogGraWarn(message)		bitLog( Bit::Log::Warning,	Bit::Log::Graphics, message)
-#define bitLogGraInfo(message)		bitLog( Bit::Log::Info,		Bit::Log::Graphics)
+#define bitLogGraInfo(message)		bitLog( Bit::Log::Info,		Bit::Log::Graphics, message)
 
 #ifdef BIT_BUILD_DEBUG
 // Macro for loggin Graphics Debug messages, only for debug profile.
@@ -84,7 +110,7 @@
 #define bitLogNet(type, message)	bitLog( type,				Bit::Log::Network, message)
 #define bitLogNetErr(message)		bitLog( Bit::Log::Error,	Bit::Log::Network, message)
 #define bitLogNetWarn(message)		bitLog( Bit::Log::Warning,	Bit::Log::Network, message)
-#define bitLogNetInfo(message)		bitLog( Bit::Log::Info,		Bit::Log::Network)
+#define bitLogNetInfo(message)		bitLog( Bit::Log::Info,		Bit::Log::Network, message)
 
 #ifdef BIT_BUILD_DEBUG
 // Macro for loggin Network Debug messages, only for debug profile.
@@ -98,7 +124,7 @@
 #define bitLogSys(type, message)	bitLog( type,				Bit::Log::System, message)
 #define bitLogSysErr(message)		bitLog( Bit::Log::Error,	Bit::Log::System, message)
 #define bitLogSysWarn(message)		bitLog( Bit::Log::Warning,	Bit::Log::System, message)
-#define bitLogSysInfo(message)		bitLog( Bit::Log::Info,		Bit::Log::System)
+#define bitLogSysInfo(message)		bitLog( Bit::Log::Info,		Bit::Log::System, message)
 
 #ifdef BIT_BUILD_DEBUG
 // Macro for loggin System Debug messages, only for debug profile.
@@ -112,7 +138,7 @@
 #define bitLogWnd(type, message)	bitLog( type,				Bit::Log::Window, message)
 #define bitLogWndErr(message)		bitLog( Bit::Log::Error,	Bit::Log::Window, message)
 #define bitLogWndWarn(message)		bitLog( Bit::Log::Warning,	Bit::Log::Window, message)
-#define bitLogWndInfo(message)		bitLog( Bit::Log::Info,		Bit::Log::Window)
+#define bitLogWndInfo(message)		bitLog( Bit::Log::Info,		Bit::Log::Window, message)
 
 #ifdef BIT_BUILD_DEBUG
 // Macro for loggin Window Debug messages, only for debug profile.
@@ -190,6 +216,18 @@ namespace Bit
 		////////////////////////////////////////////////////////////////
 		static LogHandle & GetDefaultHandle();
 
+		////////////////////////////////////////////////////////////////
+		/// \brief Wait until all the posted messages are handled.
+		///
+		////////////////////////////////////////////////////////////////
+		static void Flush();
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the number of messages dropped due to a full message queue.
+		///
+		////////////////////////////////////////////////////////////////
+		static Uint64 GetDroppedCount();
+
 	};
 
 
@@ -274,6 +312,12 @@ namespace Bit
 		////////////////////////////////////////////////////////////////
 		virtual void OnDebug(const LogMessage & p_Message);
 
+		////////////////////////////////////////////////////////////////
+		/// \brief Virual function fired when all the queued messages are handled.
+		///
+		////////////////////////////////////////////////////////////////
+		virtual void OnFlush();
+
 	};
 
 }
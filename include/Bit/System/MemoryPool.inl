@@ -97,7 +97,7 @@ inline MemoryPool<T>::~MemoryPool()
 }
 
 template <typename T>
-typename inline MemoryPool<T>::Item * MemoryPool<T>::Get()
+inline typename MemoryPool<T>::Item * MemoryPool<T>::Get()
 {
 	if (m_Items.size() == 0)
 	{
@@ -156,7 +156,7 @@ inline SizeType MemoryPool<T>::GetItemCount() const
 }
 
 template <typename T>
-inline void MemoryPool<T>::Add(const SizeType p_Count = 1)
+inline void MemoryPool<T>::Add(const SizeType p_Count)
 {
 	// Create new pool items and add them to the pool
 	for (SizeType i = 0; i < p_Count; i++)
@@ -176,23 +176,26 @@ inline void MemoryPool<T>::SetPoolSize(const SizeType p_Size)
 	{
 		for (SizeType i = m_PoolSize; i < p_Size; i++)
 		{
-			m_Items.push(new Item<T>(this, m_ItemSize));
+			m_Items.push(new Item(this, m_ItemSize));
 		}
 	}
 	// Remove items if needed.
-	else if (pSize < m_PoolSize)
+	else if (p_Size < m_PoolSize)
 	{
-		const SizeType leftToDelete = m_PoolSize - pSize;
+		SizeType leftToDelete = m_PoolSize - p_Size;
 
 		// Delete items
 		while(leftToDelete)
 		{
 			// Break the loop if there are no more items to delete
-			if (m_Item.size() == 0)
+			if (m_Items.size() == 0)
 			{
 				break;
 			}
 
+			delete m_Items.front();
+			m_Items.pop();
+
 			// Decrement the left to delete counter
 			leftToDelete--;
 		}
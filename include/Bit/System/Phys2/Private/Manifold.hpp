@@ -36,6 +36,7 @@ namespace Bit
 
 		// Forward declarations
 		class Body;
+		class Scene;
 
 		namespace Private
 		{
@@ -50,7 +51,7 @@ namespace Bit
 
 			public:
 
-				friend class Scene;
+				friend class Phys2::Scene;
 
 				////////////////////////////////////////////////////////////////
 				/// \brief Constructor
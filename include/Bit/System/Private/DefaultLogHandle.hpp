@@ -55,6 +55,11 @@ namespace Bit
 			////////////////////////////////////////////////////////////////
 			virtual void OnMessage(const LogMessage & p_Message);
 
+			////////////////////////////////////////////////////////////////
+			/// \brief Virual function fired when all the queued messages are handled.
+			///
+			////////////////////////////////////////////////////////////////
+			virtual void OnFlush();
 
 
 		};
@@ -28,7 +28,7 @@
 #include <Bit/Build.hpp>
 #include <Bit/System/Timestamp.hpp>
 #include <string>
-#include <sstream>
+#include <ostream>
 
 namespace Bit
 {
@@ -41,9 +41,14 @@ namespace Bit
 
 		////////////////////////////////////////////////////////////////
 		/// \ingroup System
-		/// \brief Default log handle class.
+		/// \brief Log manager class.
 		///
 		/// Private log class.
+		/// Messages are formatted by the logging thread into a preallocated
+		/// thread local buffer, and posted to a lock-free queue drained by
+		/// a background writer thread, which fires the log handle.
+		/// Messages are dropped if the queue is full, and the number of
+		/// dropped messages is reported by the writer thread.
 		///
 		////////////////////////////////////////////////////////////////
 		class BIT_API LogManager
@@ -51,23 +56,28 @@ namespace Bit
 
 		public:
 
-
 			////////////////////////////////////////////////////////////////
 			/// \brief	Start a new log entry.
 			///			Set meta for the log manager.
 			///
+			/// The file and function strings are not copied,
+			/// they are expected to be string literals.
+			///
 			////////////////////////////////////////////////////////////////
 			static void Start(	const Uint32 p_Type,
-										const Uint32 p_Channel,
-										const std::string & p_File,
-										const Int32 p_Line,
-										const std::string & p_Function);
+								const Uint32 p_Channel,
+								const char * p_pFile,
+								const Int32 p_Line,
+								const char * p_pFunction);
 
 			////////////////////////////////////////////////////////////////
 			/// \brief	Get the data stream for setting messages.
 			///
+			/// The stream belongs to the calling thread. Messages longer than
+			/// MaxMessageSize are truncated.
+			///
 			////////////////////////////////////////////////////////////////
-			static std::stringstream & GetStream();
+			static std::ostream & GetStream();
 
 			////////////////////////////////////////////////////////////////
 			/// \brief	Post message entry.
@@ -87,6 +97,22 @@ namespace Bit
 			////////////////////////////////////////////////////////////////
 			static LogHandle & GetDefaultHandle();
 
+			////////////////////////////////////////////////////////////////
+			/// \brief Wait until all the posted messages are handled.
+			///
+			////////////////////////////////////////////////////////////////
+			static void Flush();
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the number of messages dropped due to a full queue.
+			///
+			////////////////////////////////////////////////////////////////
+			static Uint64 GetDroppedCount();
+
+			// Public constants
+			static const SizeType MaxMessageSize;	///< Maximum size of a message, in bytes.
+			static const SizeType QueueSize;		///< Maximum number of queued messages.
+
 		};
 
 	}
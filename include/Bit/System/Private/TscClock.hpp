@@ -0,0 +1,86 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_SYSTEM_PRIVATE_TSC_CLOCK_HPP
+#define BIT_SYSTEM_PRIVATE_TSC_CLOCK_HPP
+
+#include <Bit/Build.hpp>
+
+namespace Bit
+{
+
+	namespace Private
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \ingroup System
+		/// \brief Clock reading the time stamp counter of the CPU.
+		///
+		/// Reading the counter is a single instruction, no system call or
+		/// virtual dso call is made. The counter is calibrated against the
+		/// monotonic system clock at first use, which takes about 10 milliseconds,
+		/// and anchored to the system clock again every second, correcting the drift.
+		/// The clock is only available on x86 CPUs with an invariant counter,
+		/// a constant rate counter which is synchronized between the cores.
+		///
+		/// \see Timer
+		///
+		////////////////////////////////////////////////////////////////
+		class BIT_API TscClock
+		{
+
+		public:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Check if the CPU has an invariant time stamp counter.
+			///
+			////////////////////////////////////////////////////////////////
+			static Bool IsAvailable( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the time in nanoseconds.
+			///
+			/// The time is in the time base of Timer::GetSystemTimeNanoseconds.
+			/// The difference to the system time is slewed away within a second
+			/// of every anchor, the time never goes backwards.
+			///
+			/// \return Time in nanoseconds, 0 if the clock is not available.
+			///
+			////////////////////////////////////////////////////////////////
+			static Uint64 GetTime( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Get the counter frequency in ticks per second, measured over the last second.
+			///
+			/// \return The frequency, 0 if the clock is not available.
+			///
+			////////////////////////////////////////////////////////////////
+			static Uint64 GetFrequency( );
+
+		};
+
+	}
+
+}
+
+#endif
@@ -0,0 +1,153 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#ifndef BIT_SYSTEM_WORK_STEALING_DEQUE_HPP
+#define BIT_SYSTEM_WORK_STEALING_DEQUE_HPP
+
+#include <Bit/Build.hpp>
+#include <atomic>
+#include <vector>
+
+namespace Bit
+{
+
+	namespace Private
+	{
+
+		////////////////////////////////////////////////////////////////
+		/// \ingroup System
+		/// \brief Chase-Lev work-stealing deque of pointers.
+		///
+		/// The owner thread pushes and pops at the bottom of the deque,
+		/// any other thread may steal from the top. Push and pop are
+		/// lock-free and only synchronize with thieves when the deque
+		/// is almost empty. The deque grows when full, replaced buffers
+		/// are kept until the deque is destroyed, since thieves may
+		/// still be reading from them.
+		///
+		////////////////////////////////////////////////////////////////
+		template <typename T>
+		class WorkStealingDeque
+		{
+
+		public:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Default constructor.
+			///
+			/// \param p_Capacity Initial capacity, rounded up to the power of 2.
+			///
+			////////////////////////////////////////////////////////////////
+			WorkStealingDeque( const SizeType p_Capacity = 256 );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Destructor.
+			///
+			////////////////////////////////////////////////////////////////
+			~WorkStealingDeque( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Push an item to the bottom of the deque.
+			///
+			/// May only be called by the owner thread.
+			///
+			////////////////////////////////////////////////////////////////
+			void Push( T * p_pItem );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Pop an item from the bottom of the deque.
+			///
+			/// May only be called by the owner thread.
+			///
+			/// \return Pointer to the item, NULL if the deque is empty.
+			///
+			////////////////////////////////////////////////////////////////
+			T * Pop( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Steal an item from the top of the deque.
+			///
+			/// Can be called by any thread.
+			///
+			/// \return Pointer to the item, NULL if the deque is empty
+			///			or if another thread won the race for the item.
+			///
+			////////////////////////////////////////////////////////////////
+			T * Steal( );
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Check if the deque is empty.
+			///
+			/// The result is only a snapshot when called by other threads than the owner.
+			///
+			////////////////////////////////////////////////////////////////
+			Bool IsEmpty( ) const;
+
+		private:
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Circular buffer of items.
+			///
+			////////////////////////////////////////////////////////////////
+			struct Buffer
+			{
+
+				Buffer( const Int64 p_Capacity );
+				~Buffer( );
+
+				T * Get( const Int64 p_Index ) const;
+				void Put( const Int64 p_Index, T * p_pItem );
+
+				const Int64			Capacity;	///< Number of items, power of 2.
+				const Int64			Mask;		///< Capacity - 1.
+				std::atomic<T *> *	pItems;		///< Item array.
+
+			};
+
+			// Private typedefs
+			typedef std::vector<Buffer *> BufferVector;
+
+			////////////////////////////////////////////////////////////////
+			/// \brief Replace the buffer by a buffer of twice the size.
+			///
+			////////////////////////////////////////////////////////////////
+			Buffer * Grow( Buffer * p_pBuffer, const Int64 p_Top, const Int64 p_Bottom );
+
+			// Private variables
+			std::atomic<Int64>		m_Top;				///< Index of the next item to steal.
+			std::atomic<Int64>		m_Bottom;			///< Index of the next item to push.
+			std::atomic<Buffer *>	m_pBuffer;			///< Current buffer.
+			BufferVector			m_OldBuffers;		///< Replaced buffers, only touched by the owner.
+
+		};
+
+		////////////////////////////////////////////////////////////////
+		// Include the inline file.
+		////////////////////////////////////////////////////////////////
+		#include <Bit/System/Private/WorkStealingDeque.inl>
+
+	}
+
+}
+
+#endif
@@ -0,0 +1,173 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+// Buffer struct
+template <typename T>
+WorkStealingDeque<T>::Buffer::Buffer( const Int64 p_Capacity ) :
+	Capacity( p_Capacity ),
+	Mask( p_Capacity - 1 ),
+	pItems( new std::atomic<T *>[ static_cast<SizeType>( p_Capacity ) ] )
+{
+}
+
+template <typename T>
+WorkStealingDeque<T>::Buffer::~Buffer( )
+{
+	delete [ ] pItems;
+}
+
+template <typename T>
+T * WorkStealingDeque<T>::Buffer::Get( const Int64 p_Index ) const
+{
+	return pItems[ p_Index & Mask ].load( std::memory_order_relaxed );
+}
+
+template <typename T>
+void WorkStealingDeque<T>::Buffer::Put( const Int64 p_Index, T * p_pItem )
+{
+	pItems[ p_Index & Mask ].store( p_pItem, std::memory_order_relaxed );
+}
+
+// Work stealing deque class
+template <typename T>
+WorkStealingDeque<T>::WorkStealingDeque( const SizeType p_Capacity ) :
+	m_Top( 0 ),
+	m_Bottom( 0 ),
+	m_pBuffer( NULL )
+{
+	Int64 capacity = 2;
+	while( capacity < static_cast<Int64>( p_Capacity ) )
+	{
+		capacity *= 2;
+	}
+
+	m_pBuffer.store( new Buffer( capacity ) );
+}
+
+template <typename T>
+WorkStealingDeque<T>::~WorkStealingDeque( )
+{
+	delete m_pBuffer.load( );
+
+	for( typename BufferVector::iterator it = m_OldBuffers.begin( ); it != m_OldBuffers.end( ); it++ )
+	{
+		delete *it;
+	}
+}
+
+template <typename T>
+void WorkStealingDeque<T>::Push( T * p_pItem )
+{
+	const Int64 bottom = m_Bottom.load( std::memory_order_relaxed );
+	const Int64 top = m_Top.load( std::memory_order_acquire );
+	Buffer * pBuffer = m_pBuffer.load( std::memory_order_relaxed );
+
+	// Grow the buffer if it's full.
+	if( bottom - top > pBuffer->Capacity - 1 )
+	{
+		pBuffer = Grow( pBuffer, top, bottom );
+	}
+
+	// Publish the item before the new bottom.
+	pBuffer->Put( bottom, p_pItem );
+	m_Bottom.store( bottom + 1, std::memory_order_release );
+}
+
+template <typename T>
+T * WorkStealingDeque<T>::Pop( )
+{
+	// Reserve the bottom item before looking at the top,
+	// thieves will see the reservation.
+	const Int64 bottom = m_Bottom.load( std::memory_order_relaxed ) - 1;
+	Buffer * pBuffer = m_pBuffer.load( std::memory_order_relaxed );
+	m_Bottom.store( bottom, std::memory_order_relaxed );
+	std::atomic_thread_fence( std::memory_order_seq_cst );
+	Int64 top = m_Top.load( std::memory_order_relaxed );
+
+	// The deque is empty.
+	if( top > bottom )
+	{
+		m_Bottom.store( bottom + 1, std::memory_order_relaxed );
+		return NULL;
+	}
+
+	T * pItem = pBuffer->Get( bottom );
+
+	// Last item, race against the thieves for it.
+	if( top == bottom )
+	{
+		if( m_Top.compare_exchange_strong( top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) == false )
+		{
+			pItem = NULL;
+		}
+		m_Bottom.store( bottom + 1, std::memory_order_relaxed );
+	}
+
+	return pItem;
+}
+
+template <typename T>
+T * WorkStealingDeque<T>::Steal( )
+{
+	Int64 top = m_Top.load( std::memory_order_acquire );
+	std::atomic_thread_fence( std::memory_order_seq_cst );
+	const Int64 bottom = m_Bottom.load( std::memory_order_acquire );
+
+	// The deque is empty.
+	if( top >= bottom )
+	{
+		return NULL;
+	}
+
+	// Read the item before claiming it, the owner may overwrite the slot once the top moves.
+	Buffer * pBuffer = m_pBuffer.load( std::memory_order_acquire );
+	T * pItem = pBuffer->Get( top );
+	if( m_Top.compare_exchange_strong( top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) == false )
+	{
+		return NULL;
+	}
+
+	return pItem;
+}
+
+template <typename T>
+Bool WorkStealingDeque<T>::IsEmpty( ) const
+{
+	return m_Bottom.load( std::memory_order_relaxed ) <= m_Top.load( std::memory_order_relaxed );
+}
+
+template <typename T>
+typename WorkStealingDeque<T>::Buffer * WorkStealingDeque<T>::Grow( Buffer * p_pBuffer, const Int64 p_Top, const Int64 p_Bottom )
+{
+	Buffer * pBuffer = new Buffer( p_pBuffer->Capacity * 2 );
+	for( Int64 i = p_Top; i < p_Bottom; i++ )
+	{
+		pBuffer->Put( i, p_pBuffer->Get( i ) );
+	}
+
+	// Thieves may still read from the old buffer.
+	m_OldBuffers.push_back( p_pBuffer );
+	m_pBuffer.store( pBuffer, std::memory_order_release );
+
+	return pBuffer;
+}
@@ -30,7 +30,7 @@
 #if defined( BIT_PLATFORM_WINDOWS )
 	#include <Bit/System/Win32/SemaphoreWin32.hpp>
 #elif defined( BIT_PLATFORM_LINUX )
-	//#include <Bit/System/Linux/SemaphoreWin32.hpp>
+	#include <Bit/System/Linux/SemaphoreLinux.hpp>
 #endif
 
 namespace Bit
@@ -39,7 +39,7 @@ namespace Bit
 	#if defined( BIT_PLATFORM_WINDOWS )
 		typedef SemaphoreWin32 Semaphore;
 	#elif defined( BIT_PLATFORM_LINUX )
-		#error No semaphore class implemented yet for linux.
+		typedef SemaphoreLinux Semaphore;
 	#endif
 
 };
@@ -44,6 +44,18 @@ namespace Bit
 	////////////////////////////////////////////////////////////////
 	BIT_API void Sleep( const Time & m_Time );
 
+	////////////////////////////////////////////////////////////////
+	/// \brief Put the current tread to sleep until a deadline.
+	///
+	/// Sleeping until an absolute deadline is not adding up
+	/// wake up latencies, as sleeping for relative times in a loop does.
+	///
+	/// \param p_Deadline The time to wake up at, in the time base of
+	///		Timer::GetSystemTimeNanoseconds.
+	///
+	////////////////////////////////////////////////////////////////
+	BIT_API void SleepUntil( const Time & p_Deadline );
+
 	////////////////////////////////////////////////////////////////
 	/// @}
 	////////////////////////////////////////////////////////////////
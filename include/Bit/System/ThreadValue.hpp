@@ -68,7 +68,7 @@ namespace Bit
 
 		// Public variables
 		T Value;
-		Mutex Mutex;
+		Bit::Mutex Mutex;	///< Qualified, the member name hides the type.
 	};
 
 	////////////////////////////////////////////////////////////////
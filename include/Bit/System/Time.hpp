@@ -44,6 +44,7 @@ namespace Bit
 		friend BIT_API Time Seconds( const Float64 & );
 		friend BIT_API Time Milliseconds( const Uint64 & );
 		friend BIT_API Time Microseconds( const Uint64 & );
+		friend BIT_API Time Nanoseconds( const Uint64 & );
 
 		////////////////////////////////////////////////////////////////
 		/// \brief Default constructor.
@@ -75,6 +76,14 @@ namespace Bit
 		////////////////////////////////////////////////////////////////
 		Uint64 AsMicroseconds( ) const;
 
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the time in nanoseconds.
+		///
+		/// \return Time in nanoseconds as a 64 bit integer value.
+		///
+		////////////////////////////////////////////////////////////////
+		Uint64 AsNanoseconds( ) const;
+
 		////////////////////////////////////////////////////////////////
 		/// \brief Value for representing infinite time.
 		///
@@ -162,10 +171,10 @@ namespace Bit
 	private:
 
 		// Private functions
-		Time( const Uint64 & p_Microseconds );
+		Time( const Uint64 & p_Nanoseconds );
 
 		// Private variables
-		Uint64 m_Microseconds;	///< Time in nanoseconds.
+		Uint64 m_Nanoseconds;	///< Time in nanoseconds.
 
 	};
 
@@ -193,6 +202,14 @@ namespace Bit
 	////////////////////////////////////////////////////////////////
 	BIT_API Time Microseconds( const Uint64 & p_Microseconds );
 
+	////////////////////////////////////////////////////////////////
+	/// \brief Function for initializing a time class
+	///
+	/// \param p_Nanoseconds Time in nanoseconds.
+	///
+	////////////////////////////////////////////////////////////////
+	BIT_API Time Nanoseconds( const Uint64 & p_Nanoseconds );
+
 }
 
 #endif
\ No newline at end of file
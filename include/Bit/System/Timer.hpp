@@ -35,17 +35,37 @@ namespace Bit
 	/// \ingroup System
 	/// \brief Timer class
 	///
+	/// The timer is measuring the time of the monotonic system clock by default,
+	/// which is unaffected by changes of the wall clock.
+	/// The time stamp counter clock is faster to read, and falls back to
+	/// the monotonic clock if the CPU is missing an invariant counter.
+	///
 	////////////////////////////////////////////////////////////////
 	class BIT_API Timer
 	{
 
 	public:
 
+		////////////////////////////////////////////////////////////////
+		/// \brief Clock type enum.
+		///
+		////////////////////////////////////////////////////////////////
+		struct ClockType
+		{
+			enum eType
+			{
+				Monotonic,	///< Monotonic system clock.
+				Tsc			///< Calibrated time stamp counter of the CPU.
+			};
+		};
+
 		////////////////////////////////////////////////////////////////
 		/// \brief Default constructor.
 		///
+		/// \param p_ClockType The clock to measure the time of.
+		///
 		////////////////////////////////////////////////////////////////
-		Timer( );
+		Timer( const ClockType::eType p_ClockType = ClockType::Monotonic );
 
 		////////////////////////////////////////////////////////////////
 		/// \brief Starting the timer.
@@ -84,13 +104,44 @@ namespace Bit
 		////////////////////////////////////////////////////////////////
 		static Uint64 GetSystemTime( );
 
+		////////////////////////////////////////////////////////////////
+		/// \return Get system time in nanoseconds since last startup.
+		///
+		////////////////////////////////////////////////////////////////
+		static Uint64 GetSystemTimeNanoseconds( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the time of the time stamp counter clock.
+		///
+		/// The counter is anchored to the system time every second,
+		/// so the clock does not drift away from it over long intervals.
+		///
+		/// \return Time in nanoseconds in the time base of GetSystemTimeNanoseconds.
+		///			The system time if the time stamp counter is not available.
+		///
+		////////////////////////////////////////////////////////////////
+		static Uint64 GetTscTime( );
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Check if the time stamp counter clock is available.
+		///
+		////////////////////////////////////////////////////////////////
+		static Bool IsTscAvailable( );
+
 	private:
 
+		////////////////////////////////////////////////////////////////
+		/// \brief Get the time of the timer's clock, in nanoseconds.
+		///
+		////////////////////////////////////////////////////////////////
+		Uint64 GetClockTime( ) const;
+
 		////////////////////////////////////////////////////////////////
 		// Private variable members
 		////////////////////////////////////////////////////////////////
-		Uint64 m_StartTime;		///< The start time
-		Uint64 m_Time;			///< The the current time.
+		ClockType::eType m_ClockType;	///< The clock to measure the time of.
+		Uint64 m_StartTime;				///< The start time, in nanoseconds.
+		Uint64 m_Time;					///< The the current time, in nanoseconds.
 
 	};
 }
@@ -37,6 +37,10 @@ namespace Bit
 	/// \brief Timestep class
 	///
 	/// The Execute function locks the current thread until the time as exceeded. 
+	/// Calling Execute in a loop runs the function at a fixed rate: the ticks are
+	/// scheduled at absolute deadlines, so the sleep latencies and the execution
+	/// times are not accumulated as drift. The thread sleeps until shortly before
+	/// the deadline, and spins for the remaining time.
 	///
 	////////////////////////////////////////////////////////////////
 	class Timestep
@@ -50,17 +54,37 @@ namespace Bit
 		////////////////////////////////////////////////////////////////
 		/// \brief Default constructor.
 		///
+		/// \param p_SpinTime Time to spin before each deadline,
+		///		covering the wake up latency of the sleep.
+		///
 		////////////////////////////////////////////////////////////////
-		Timestep(  );
+		Timestep( const Time & p_SpinTime = Microseconds( 200 ) );
 
 		////////////////////////////////////////////////////////////////
-		/// \brief Default constructor.
+		/// \brief Execute a function and wait for the next tick.
+		///
+		/// The schedule is restarted if the update time is changed.
+		/// If the function is more than one update time late,
+		/// the missed ticks are skipped instead of executed in a burst.
 		///
 		/// \return Exceeded time.
 		///
 		////////////////////////////////////////////////////////////////
 		Time Execute( const Time & p_UpdateTime, Function p_Function );
 
+		////////////////////////////////////////////////////////////////
+		/// \brief Restart the schedule at the next call of Execute.
+		///
+		////////////////////////////////////////////////////////////////
+		void Reset( );
+
+	private:
+
+		// Private variables
+		Uint64 m_SpinTime;		///< Time to spin before each deadline, in nanoseconds.
+		Uint64 m_UpdateTime;	///< Update time of the schedule, in nanoseconds.
+		Uint64 m_NextTick;		///< Deadline of the next tick in system time nanoseconds, 0 if not scheduled.
+
 	};
 
 }
@@ -34,7 +34,7 @@
 #if defined( BIT_PLATFORM_WINDOWS )
 	#define bitIsNan _isnan
 #elif defined( BIT_PLATFORM_LINUX )
-	#define bitIsNan isnan
+	#define bitIsNan std::isnan
 #endif
 
 namespace Bit
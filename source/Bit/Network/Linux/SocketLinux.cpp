@@ -24,6 +24,7 @@
 #include <Bit/Network/Linux/SocketLinux.hpp>
 #ifdef BIT_PLATFORM_LINUX
 #include <iostream>
+#include <unistd.h>
 #include <Bit/System/MemoryLeak.hpp>
 
 namespace Bit
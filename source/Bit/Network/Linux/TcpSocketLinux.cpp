@@ -43,7 +43,7 @@ namespace Bit
 		Disconnect( );
 	}
 
-	Bool TcpSocketLinux::Connect( const Address & p_Address, const Uint16 p_Port, const Time & p_Timeout )
+	Bool TcpSocketLinux::Connect( const Address & p_Address, const Uint16 p_Port, const Time & p_Timeout, const Uint16 p_EndpointPort )
 	{
 		// Create the socket
 		if( ( m_Handle = socket( AF_INET, SOCK_STREAM, IPPROTO_TCP ) ) <= 0 )
@@ -52,8 +52,33 @@ namespace Bit
 			return false;
 		}
 
-		// Create an object that's holding the host data
+		// Bind the socket to a port
 		sockaddr_in service;
+
+		if( p_EndpointPort != 0 )
+		{
+			service.sin_family = AF_INET;
+			service.sin_addr.s_addr = htonl( INADDR_ANY );
+			service.sin_port = htons( static_cast<u_short>( p_EndpointPort ) );
+
+			const int optVal = 1;
+			if( setsockopt( m_Handle, SOL_SOCKET, SO_REUSEADDR, &optVal, sizeof( optVal ) ) != 0 )
+			{
+				std::cout << "[TcpSocketLinux::Connect] Can not set reusable socket." << std::endl;
+				Disconnect( );
+				return false;
+			}
+
+			// Bind
+			if( bind( m_Handle, reinterpret_cast<const sockaddr *>( &service ), sizeof( service ) ) != 0 )
+			{
+				std::cout << "[TcpSocketLinux::Connect] Can not bind the socket." << std::endl;
+				Disconnect( );
+				return false;
+			}
+		}
+
+		// Create an object that's holding the host data
 		service.sin_family = AF_INET;
 		service.sin_addr.s_addr = htonl( static_cast<u_long>( p_Address.GetAddress( ) ) );
 		service.sin_port = htons( static_cast<u_short>( p_Port ) );
@@ -25,12 +25,16 @@
 #include <Bit/Network/Linux/UdpSocketLinux.hpp>
 #ifdef BIT_PLATFORM_LINUX
 #include <iostream>
+#include <cstring>
+#include <poll.h>
+#include <errno.h>
 #include <Bit/System/MemoryLeak.hpp>
 
 namespace Bit
 {
 
 	static const Uint64 g_MaxTimeout = 2147483647;
+	static const SizeType g_MaxBatchSize = 64;
 
 	UdpSocketLinux::UdpSocketLinux( ) :
 		UdpSocketBase( )
@@ -72,6 +76,45 @@ namespace Bit
 		return true;
 	}
 
+	Bool UdpSocketLinux::OpenShared( const Uint16 p_Port )
+	{
+#ifdef SO_REUSEPORT
+		// Create the socket
+		if( ( m_Handle = socket( AF_INET, SOCK_DGRAM, IPPROTO_UDP ) ) <= 0 )
+		{
+			std::cout << "[UdpSocketLinux::OpenShared] Can not create the socket. Error: " << errno << std::endl;
+			return false;
+		}
+
+		// Share the port, must be set before binding the socket.
+		int reusePort = 1;
+		if( setsockopt( m_Handle, SOL_SOCKET, SO_REUSEPORT, &reusePort, sizeof( reusePort ) ) != 0 )
+		{
+			std::cout << "[UdpSocketLinux::OpenShared] Can not share the port. Error: " << errno << std::endl;
+			Close( );
+			return false;
+		}
+
+		// Bind the socket
+		sockaddr_in service;
+		service.sin_family = AF_INET;
+		service.sin_addr.s_addr = htonl( INADDR_ANY );
+		service.sin_port = htons( static_cast<u_short>( p_Port ) );
+
+		if( bind( m_Handle, reinterpret_cast<const sockaddr *>( &service ), sizeof( service ) ) != 0 )
+		{
+			std::cout << "[UdpSocketLinux::OpenShared] Can not bind the socket. Error: " << errno << std::endl;
+			Close( );
+			return false;
+		}
+
+		return true;
+#else
+		std::cout << "[UdpSocketLinux::OpenShared] SO_REUSEPORT is not supported." << std::endl;
+		return false;
+#endif
+	}
+
 	void UdpSocketLinux::Close( )
 	{
 		// Close the socket handle
@@ -182,6 +225,152 @@ namespace Bit
 		return -1;
 	}
 
+	Int32 UdpSocketLinux::SendBatch( const Datagram * p_pDatagrams, const SizeType p_Count )
+	{
+		mmsghdr messages[ g_MaxBatchSize ];
+		iovec vectors[ g_MaxBatchSize * 2 ];
+		sockaddr_in addresses[ g_MaxBatchSize ];
+
+		// Send the datagrams in chunks of the max batch size.
+		SizeType sent = 0;
+		while( sent < p_Count )
+		{
+			const SizeType count = ( p_Count - sent ) < g_MaxBatchSize ? ( p_Count - sent ) : g_MaxBatchSize;
+
+			for( SizeType i = 0; i < count; i++ )
+			{
+				const Datagram & datagram = p_pDatagrams[ sent + i ];
+
+				// Destination socket address struct
+				addresses[ i ].sin_family = AF_INET;
+				addresses[ i ].sin_addr.s_addr = htonl( static_cast<u_long>( datagram.RemoteAddress.GetAddress( ) ) );
+				addresses[ i ].sin_port = htons( static_cast<u_short>( datagram.RemotePort ) );
+
+				// Gather the header and the data.
+				iovec * pVectors = &vectors[ i * 2 ];
+				size_t vectorCount = 0;
+				if( datagram.pHeader && datagram.HeaderSize )
+				{
+					pVectors[ vectorCount ].iov_base = const_cast<void *>( datagram.pHeader );
+					pVectors[ vectorCount ].iov_len = static_cast<size_t>( datagram.HeaderSize );
+					vectorCount++;
+				}
+				pVectors[ vectorCount ].iov_base = datagram.pData;
+				pVectors[ vectorCount ].iov_len = static_cast<size_t>( datagram.DataSize );
+				vectorCount++;
+
+				memset( &messages[ i ], 0, sizeof( mmsghdr ) );
+				messages[ i ].msg_hdr.msg_name = &addresses[ i ];
+				messages[ i ].msg_hdr.msg_namelen = sizeof( sockaddr_in );
+				messages[ i ].msg_hdr.msg_iov = pVectors;
+				messages[ i ].msg_hdr.msg_iovlen = vectorCount;
+			}
+
+			// Send the messages
+			int result = sendmmsg( m_Handle, messages, static_cast<unsigned int>( count ), 0 );
+			if( result < 0 )
+			{
+				return sent ? static_cast<Int32>( sent ) : -1;
+			}
+
+			sent += static_cast<SizeType>( result );
+
+			// The socket buffer is full.
+			if( static_cast<SizeType>( result ) < count )
+			{
+				break;
+			}
+		}
+
+		// Return the number of sent datagrams
+		return static_cast<Int32>( sent );
+	}
+
+	Int32 UdpSocketLinux::ReceiveBatch( Datagram * p_pDatagrams, const SizeType p_Count, const Time & p_Timeout )
+	{
+		if( p_Count == 0 )
+		{
+			return 0;
+		}
+
+		// Wait for the first datagram, without changing the blocking status.
+		pollfd pollDescriptor;
+		pollDescriptor.fd = static_cast<int>( m_Handle );
+		pollDescriptor.events = POLLIN;
+		pollDescriptor.revents = 0;
+
+		// Set the time
+		struct timespec ts;
+		if( p_Timeout.AsMicroseconds( ) / 1000000ULL > g_MaxTimeout )
+		{
+			ts.tv_sec	= static_cast<time_t>( g_MaxTimeout );
+			ts.tv_nsec	= 0;
+		}
+		else
+		{
+			ts.tv_sec	= static_cast<time_t>( p_Timeout.AsMicroseconds( ) / 1000000ULL );
+			ts.tv_nsec	= static_cast<long>( p_Timeout.AsMicroseconds( ) % 1000000ULL ) * 1000L;
+		}
+
+		int status = ppoll( &pollDescriptor, 1, &ts, NULL );
+		if( status <= 0 )
+		{
+			return ( status == 0 || errno == EINTR ) ? 0 : -1;
+		}
+
+		mmsghdr messages[ g_MaxBatchSize ];
+		iovec vectors[ g_MaxBatchSize ];
+		sockaddr_in addresses[ g_MaxBatchSize ];
+
+		// Receive the queued datagrams in chunks of the max batch size.
+		SizeType received = 0;
+		while( received < p_Count )
+		{
+			const SizeType count = ( p_Count - received ) < g_MaxBatchSize ? ( p_Count - received ) : g_MaxBatchSize;
+
+			for( SizeType i = 0; i < count; i++ )
+			{
+				Datagram & datagram = p_pDatagrams[ received + i ];
+
+				vectors[ i ].iov_base = datagram.pData;
+				vectors[ i ].iov_len = static_cast<size_t>( datagram.BufferSize );
+
+				memset( &messages[ i ], 0, sizeof( mmsghdr ) );
+				messages[ i ].msg_hdr.msg_name = &addresses[ i ];
+				messages[ i ].msg_hdr.msg_namelen = sizeof( sockaddr_in );
+				messages[ i ].msg_hdr.msg_iov = &vectors[ i ];
+				messages[ i ].msg_hdr.msg_iovlen = 1;
+			}
+
+			// Receive the messages, do not block.
+			int result = recvmmsg( m_Handle, messages, static_cast<unsigned int>( count ), MSG_DONTWAIT, NULL );
+			if( result <= 0 )
+			{
+				break;
+			}
+
+			// Set the sizes, addresses and ports
+			for( int i = 0; i < result; i++ )
+			{
+				Datagram & datagram = p_pDatagrams[ received + i ];
+				datagram.DataSize = static_cast<SizeType>( messages[ i ].msg_len );
+				datagram.RemoteAddress = Address( static_cast<Uint32>( ntohl( (u_long)addresses[ i ].sin_addr.s_addr ) ) );
+				datagram.RemotePort = static_cast<Uint16>( ntohs( addresses[ i ].sin_port ) );
+			}
+
+			received += static_cast<SizeType>( result );
+
+			// No more queued datagrams.
+			if( static_cast<SizeType>( result ) < count )
+			{
+				break;
+			}
+		}
+
+		// Return the number of received datagrams
+		return static_cast<Int32>( received );
+	}
+
 }
 
 #endif
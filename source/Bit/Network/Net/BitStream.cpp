@@ -0,0 +1,181 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/BitStream.hpp>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		// Bit writer class
+		BitWriter::BitWriter( std::vector<Uint8> & p_Buffer ) :
+			m_Buffer( p_Buffer ),
+			m_BitCount( 0 )
+		{
+		}
+
+		void BitWriter::WriteBits( const Uint32 p_Value, const Uint8 p_BitCount )
+		{
+			Uint32 value = p_Value;
+			Uint8 bitsLeft = p_BitCount;
+
+			while( bitsLeft )
+			{
+				// Start a new byte.
+				const Uint8 bitOffset = static_cast<Uint8>( m_BitCount & 7 );
+				if( bitOffset == 0 )
+				{
+					m_Buffer.push_back( 0 );
+				}
+
+				// Fill the current byte.
+				const Uint8 bits = ( 8 - bitOffset ) < bitsLeft ? ( 8 - bitOffset ) : bitsLeft;
+				const Uint32 mask = ( 1UL << bits ) - 1;
+				m_Buffer.back( ) |= static_cast<Uint8>( ( value & mask ) << bitOffset );
+
+				value >>= bits;
+				bitsLeft -= bits;
+				m_BitCount += bits;
+			}
+		}
+
+		void BitWriter::WriteBytes( const void * p_pData, const SizeType p_DataSize )
+		{
+			const Uint8 * pData = reinterpret_cast<const Uint8 *>( p_pData );
+
+			// Copy the bytes directly if we are byte aligned.
+			if( ( m_BitCount & 7 ) == 0 )
+			{
+				m_Buffer.insert( m_Buffer.end( ), pData, pData + p_DataSize );
+				m_BitCount += p_DataSize * 8;
+				return;
+			}
+
+			for( SizeType i = 0; i < p_DataSize; i++ )
+			{
+				WriteBits( pData[ i ], 8 );
+			}
+		}
+
+		void BitWriter::WriteVarUint( Uint64 p_Value )
+		{
+			while( p_Value >= 0x80 )
+			{
+				WriteBits( static_cast<Uint32>( p_Value & 0x7F ) | 0x80, 8 );
+				p_Value >>= 7;
+			}
+			WriteBits( static_cast<Uint32>( p_Value ), 8 );
+		}
+
+		SizeType BitWriter::GetBitCount( ) const
+		{
+			return m_BitCount;
+		}
+
+		// Bit reader class
+		BitReader::BitReader( const void * p_pData, const SizeType p_DataSize ) :
+			m_pData( reinterpret_cast<const Uint8 *>( p_pData ) ),
+			m_DataSize( p_DataSize ),
+			m_BitCount( 0 )
+		{
+		}
+
+		Bool BitReader::ReadBits( Uint32 & p_Value, const Uint8 p_BitCount )
+		{
+			// Make sure that there's enough bits left.
+			if( m_BitCount + p_BitCount > m_DataSize * 8 )
+			{
+				return false;
+			}
+
+			p_Value = 0;
+			Uint8 bitsRead = 0;
+
+			while( bitsRead < p_BitCount )
+			{
+				const Uint8 bitOffset = static_cast<Uint8>( m_BitCount & 7 );
+				const Uint8 bitsLeft = p_BitCount - bitsRead;
+				const Uint8 bits = ( 8 - bitOffset ) < bitsLeft ? ( 8 - bitOffset ) : bitsLeft;
+				const Uint32 mask = ( 1UL << bits ) - 1;
+
+				p_Value |= ( ( static_cast<Uint32>( m_pData[ m_BitCount >> 3 ] ) >> bitOffset ) & mask ) << bitsRead;
+
+				bitsRead += bits;
+				m_BitCount += bits;
+			}
+
+			return true;
+		}
+
+		Bool BitReader::ReadBytes( void * p_pData, const SizeType p_DataSize )
+		{
+			Uint8 * pData = reinterpret_cast<Uint8 *>( p_pData );
+
+			// Make sure that there's enough bits left.
+			if( m_BitCount + p_DataSize * 8 > m_DataSize * 8 )
+			{
+				return false;
+			}
+
+			for( SizeType i = 0; i < p_DataSize; i++ )
+			{
+				Uint32 value = 0;
+				ReadBits( value, 8 );
+				pData[ i ] = static_cast<Uint8>( value );
+			}
+
+			return true;
+		}
+
+		Bool BitReader::ReadVarUint( Uint64 & p_Value )
+		{
+			p_Value = 0;
+			for( Uint32 shift = 0; shift < 64; shift += 7 )
+			{
+				Uint32 byte = 0;
+				if( ReadBits( byte, 8 ) == false )
+				{
+					return false;
+				}
+
+				p_Value |= static_cast<Uint64>( byte & 0x7F ) << shift;
+				if( ( byte & 0x80 ) == 0 )
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		SizeType BitReader::GetBitCount( ) const
+		{
+			return m_BitCount;
+		}
+
+	}
+
+}
@@ -26,7 +26,8 @@
 #include <Bit/System/Timer.hpp>
 #include <Bit/System/Randomizer.hpp>
 #include <Bit/System/Log.hpp>
-#include <Memory>
+#include <memory>
+#include <algorithm>
 #include <Bit/System/MemoryLeak.hpp>
 
 namespace Bit
@@ -38,15 +39,22 @@ namespace Bit
 		Client::Client(const Uint16 p_Port,
 			const Time & p_InitialPing) :
 			m_EntityManager(NULL, NULL, this),
+			m_pSocket(new UdpSocket),
+			m_pSocketFactory(NULL),
 			m_Port(p_Port),
 			m_Connected(false),
 			m_ServerAddress(0),
 			m_ServerPort(0),
 			m_LosingConnectionTimeout(Seconds(3.0f)),
 			m_Sequence(0),
-			m_Ping(p_InitialPing)
+			m_ReliableRingFull(false),
+			m_Rtt(RttEstimator(p_InitialPing * 2ULL)),
+			m_ChannelsFull(false),
+			m_UseCompressionDictionary(false),
+			m_NextMessageId(0),
+			m_FragmentsInFlight(0)
 		{
-
+			m_ReliableTimer.Start();
 		}
 
 		Client::~Client()
@@ -54,17 +62,12 @@ namespace Bit
 			// Disconnect the client.
 			InternalDisconnect(true, true, true, true);
 
-			// Clear the user message listeners
-			m_HostMessageListeners.Mutex.Lock();
-			for (HostMessageListenerMap::iterator it = m_HostMessageListeners.Value.begin();
-				it != m_HostMessageListeners.Value.end();
-				it++)
-			{
-				delete it->second;
-			}
-			m_HostMessageListeners.Value.clear();
-			m_HostMessageListeners.Mutex.Unlock();
+			// Clear the host message listeners
+			m_HostMessageHandlers.Mutex.Lock();
+			m_HostMessageHandlers.Value.clear();
+			m_HostMessageHandlers.Mutex.Unlock();
 
+			delete m_pSocket;
 		}
 
 		Bool Client::PingServer(	const Address & p_ServerAddress,
@@ -144,26 +147,43 @@ namespace Bit
 			// make sure to be disconnected.
 			InternalDisconnect(true, true, true, true);
 
+			// Forget the user message ids of the previous server.
+			m_UserMessageIds.Mutex.Lock();
+			m_UserMessageIds.Value.Clear();
+			m_UserMessageIds.Mutex.Unlock();
+
+			// Restart the channel sequences.
+			m_Channels.Mutex.Lock();
+			m_Channels.Value.Clear();
+			m_Channels.Mutex.Unlock();
+			m_ChannelsFull.Set(false);
+
+			// The packets are not compressed until the server offers the compression.
+			m_UseCompressionDictionary = false;
+
+			// Create the udp socket, by the socket factory if any.
+			delete m_pSocket;
+			m_pSocket = m_pSocketFactory ? m_pSocketFactory->CreateSocket() : new UdpSocket;
+
 			// Open the udp socket.
-			m_Socket.SetBlocking(true);
+			m_pSocket->SetBlocking(true);
 
 			// Open the socket.
-			if (m_Socket.Open(m_Port) == false)
+			if (m_pSocket->Open(m_Port) == false)
 			{
 				return SocketError;
 			}
 
 			// Set blocking and return true.
-			m_Socket.SetBlocking(true);
+			m_pSocket->SetBlocking(true);
 
 			// Create a data buffer.
 			Uint8 buffer[BufferSize];
 
-			// Initialize the ping list
-			for (SizeType i = 0; i < 5; i++)
-			{
-				m_PingList.push_front(m_Ping.Value);
-			}
+			// Reset the statistics of the connection.
+			m_Congestion.Mutex.Lock();
+			m_Congestion.Value.Reset(false, 0);
+			m_Congestion.Mutex.Unlock();
 
 			// Keep on receiving until we get the right packet message from the host
 			Int32 recvSize = 0;
@@ -171,7 +191,6 @@ namespace Bit
 			Uint16 recvPort = 0;
 			Time timeout = p_ConnectionTimeout;
 			const Time sendTime = Seconds(0.2f); ///< How often to check for received packets.
-			const SizeType connectPacketSize = ConnectPacketSize + p_Identifier.size(); ///< Connect packet length
 			bool recvSynAck = false;
 
 
@@ -214,14 +233,14 @@ namespace Bit
 				timerVector[timerVector.size() - 1].Start();
 
 				// Send SYN packet, tell the server that we would like to connect.
-				if (m_Socket.Send(connectionPacket.data(), connectionPacket.size(), p_Address, p_Port) != connectPacketSize)
+				if (m_pSocket->Send(connectionPacket.data(), connectionPacket.size(), p_Address, p_Port) != static_cast<Int32>(connectionPacket.size()))
 				{
 					// Error sending connection packet.
 					return Unknown;
 				}
 
 				// Receive message
-				recvSize = m_Socket.Receive(buffer, BufferSize, recvAddress, recvPort, sendTime);
+				recvSize = m_pSocket->Receive(buffer, BufferSize, recvAddress, recvPort, sendTime);
 
 				// Decrease the timeout time
 				timeout = p_ConnectionTimeout - timeoutTimer.GetLapsedTime();
@@ -305,6 +324,18 @@ namespace Bit
 					}
 
 				}
+				// The server challenges us to echo its cookie, proving that we receive the packets sent to our address.
+				else if (buffer[0] == PacketType::Challenge)
+				{
+					// Send a challenge response instead of the connect packet from now on.
+					connectionPacket.clear();
+					connectionPacket.push_back(PacketType::ChallengeResponse);
+					connectionPacket.push_back('A');
+					connectionPacket.push_back('A');
+					connectionPacket.append(reinterpret_cast<const char *>(&buffer[ConnectPacketSize]), sizeof(Uint64));
+					connectionPacket.append(p_Identifier);
+					continue;
+				}
 				else // Unexpected packet from the server.
 				{
 					// Ignore unexpected oacket from the server.
@@ -357,7 +388,7 @@ namespace Bit
 				while (IsConnected())
 				{
 					// Receive any packet.
-					recvSize = m_Socket.Receive(buffer, bufferSize, address, port, Microseconds(1000));
+					recvSize = m_pSocket->Receive(buffer, bufferSize, address, port, Microseconds(1000));
 
 					// Make sure that the packet is from the server
 					if (address != m_ServerAddress || port != m_ServerPort)
@@ -376,203 +407,8 @@ namespace Bit
 					m_LastRecvTimer.Value.Start();
 					m_LastRecvTimer.Mutex.Unlock();
 
-					// Check the packet type
-					switch (buffer[0])
-					{
-						// The server disconnected.
-					case PacketType::Disconnect:
-					{
-						// Set connected to false.
-						m_Connected.Mutex.Lock();
-						m_Connected.Value = false;
-						m_Connected.Mutex.Unlock();
-
-						// Wait for the threads to finish.
-						m_TriggerThread.Finish();
-						m_ReliableThread.Finish();
-
-						// Reset the sequence.
-						/*m_Sequence.Mutex.Lock();
-						m_Sequence.Value = 0;
-						m_Sequence.Mutex.Unlock();
-						*/
-						return;
-					}
-					break;
-					// ACK packet from server.
-					case PacketType::Acknowledgement:
-					{
-						// Ignore "corrupt" ack packet.
-						if (recvSize != AcknowledgementPacketSize)
-						{
-							continue;
-						}
-
-						// Get the sequence
-						Uint16 sequence = Ntoh16(static_cast<Uint16>(static_cast<Uint8>(buffer[1])) |
-							static_cast<Uint16>(static_cast<Uint8>(buffer[2]) << 8));
-
-						// Find the sequence in the reliable map
-						m_ReliableMap.Mutex.Lock();
-						ReliablePacketMap::iterator it = m_ReliableMap.Value.find(sequence);
-						// Remove the packet from the map if it's found and calculate the ping.
-						if (it != m_ReliableMap.Value.end())
-						{
-							// Calculate the new ping from the lapsed time if it's not a resent packet
-							if (it->second->Resent == false)
-							{
-								CalculateNewPing(it->second->SendTimer.GetLapsedTime());
-							}
-
-							// Clean up the data
-							delete[] it->second->pData;
-							delete it->second;
-
-							// Erase the reliable packet
-							m_ReliableMap.Value.erase(it);
-						}
-						m_ReliableMap.Mutex.Unlock();
-					}
-					break;
-					// Alive packet from server.
-					case PacketType::Alive:
-					{
-						// Ignore "corrupt" alive packet.
-						if (recvSize != AlivePacketSize)
-						{
-							continue;
-						}
-
-						Uint16 sequence = Ntoh16(static_cast<Uint16>(static_cast<Uint8>(buffer[1])) |
-							static_cast<Uint16>(static_cast<Uint8>(buffer[2]) << 8));
-
-						// Use the already allocated packet, change the type
-						buffer[0] = PacketType::Acknowledgement;
-
-						// Send the ack packet
-						m_Socket.Send(buffer, AcknowledgementPacketSize, m_ServerAddress, m_ServerPort);
-					}
-					break;
-					case PacketType::EntityUpdate:
-					{
-						// Error check the recv size
-						if (recvSize <= EntityUpdatePacketSize)
-						{
-							continue;
-						}
-
-						// Check the reliable flag
-						if (buffer[PacketTypeSize + SequenceSize] == ReliabilityType::Reliable)
-						{
-							// Use the already allocated packet, change the type
-							buffer[0] = PacketType::Acknowledgement;
-
-							// Send the ack packet
-							m_Socket.Send(buffer, AcknowledgementPacketSize, m_ServerAddress, m_ServerPort);
-						}
-
-						// Get the sequence
-						const Uint16 sequence = Ntoh16(static_cast<Uint16>(static_cast<Uint8>(buffer[1])) |
-							static_cast<Uint16>(static_cast<Uint8>(buffer[2]) << 8));
-
-						// Add the packets sequence to the sequence manager, do not handle the packet
-						// if we've already received a packet with the same sequence.
-						if (m_SequenceManager.AddSequence(sequence) && AddEntityUpdateSequence(sequence))
-						{
-							m_EntityManager.ParseEntityMessage(sequence, buffer + EntityUpdatePacketSize, recvSize - EntityUpdatePacketSize);
-						}
-
-					}
-					break;
-					case PacketType::EntityDestroyed:
-					{
-						// Error check the recv size
-						if (recvSize < EntityDestroyedPacketSize)
-						{
-							continue;
-						}
-
-						if (buffer[PacketTypeSize + SequenceSize] == ReliabilityType::Reliable)
-						{
-							// Use the already allocated packet, change the type
-							buffer[0] = PacketType::Acknowledgement;
-
-							// Send the ack packet
-							m_Socket.Send(buffer, AcknowledgementPacketSize, m_ServerAddress, m_ServerPort);
-						}
-
-						// Get the sequence
-						const Uint16 sequence = Ntoh16(	static_cast<Uint16>(static_cast<Uint8>(buffer[1])) |
-														static_cast<Uint16>(static_cast<Uint8>(buffer[2]) << 8));
-
-						// Error check the sequence and add it to the sequence manager.
-						if (m_SequenceManager.AddSequence(sequence) == false)
-						{
-							continue;
-						}
-
-
-						// Get entity id
-						Uint16 entityId = Ntoh16(	static_cast<Uint16>(static_cast<Uint8>(buffer[4])) |
-													static_cast<Uint16>(static_cast<Uint8>(buffer[5]) << 8));
-
-						// Get entity
-						Entity * pEntity = m_EntityManager.GetEntity(entityId);
-						if (pEntity == NULL)
-						{
-							bitLogNetErr(  "Trying to destroy NULL entity." );
-							continue;
-						}
-
-						// Call entity destroyed function.
-						OnEntityDestroyed(pEntity);
-
-						// Destroy the entity.
-						m_EntityManager.DestroyEntity(pEntity, true);
-
-
-					}
-					break;
-					case PacketType::HostMessage:
-					{
-						// Error check the recv size
-						if (recvSize <= HostMessagePacketSize)
-						{
-							continue;
-						}
-
-						// Check the reliable flag
-						if (buffer[PacketTypeSize + SequenceSize] == ReliabilityType::Reliable)
-						{
-							// Use the already allocated packet, change the type
-							buffer[0] = PacketType::Acknowledgement;
-
-							// Send the ack packet
-							m_Socket.Send(buffer, AcknowledgementPacketSize, m_ServerAddress, m_ServerPort);
-						}
-
-						// Get the sequence
-						const Uint16 sequence = Ntoh16(static_cast<Uint16>(static_cast<Uint8>(buffer[1])) |
-							static_cast<Uint16>(static_cast<Uint8>(buffer[2]) << 8));
-
-						// Add the packets sequence to the sequence manager, do not handle the packet
-						// if we've already received a packet with the same sequence.
-						if (m_SequenceManager.AddSequence(sequence))
-						{
-
-							// Add the unreliable packet to the received data queue.	
-							ReceivedData * pReceivedData = new ReceivedData(buffer + UserMessagePacketSize,
-								recvSize - UserMessagePacketSize,
-								sequence);
-
-							// Add the host message.
-							AddHostMessage(pReceivedData);
-						}
-					}
-					break;
-					default:
-						break;
-					}
+					// Handle the packet.
+					HandlePacket(buffer, recvSize);
 
 				}
 			}
@@ -587,8 +423,10 @@ namespace Bit
 					// Sleep for some time.
 					Sleep(Milliseconds(10));
 
-					// Disconnect you've not heard anything from the server in a while.
-					if (TimeSinceLastRecvPacket() >= m_LosingConnectionTimeout.Get())
+					// Disconnect you've not heard anything from the server in a while,
+					// or if the server stopped acknowledging the reliable packets,
+					// or if the received messages overflowed the reorder buffers.
+					if (TimeSinceLastRecvPacket() >= m_LosingConnectionTimeout.Get() || m_ReliableRingFull.Get() || m_ChannelsFull.Get())
 					{
 						InternalDisconnect(true, false, true, true);
 						return;
@@ -612,47 +450,47 @@ namespace Bit
 			// Execute the reliable thread
 			m_ReliableThread.Execute([this]()
 			{
-				ReliablePacket * pPacket = NULL;
+				std::vector<UdpSocket::Datagram> datagrams;
 
 				while (IsConnected())
 				{
 					// Sleep for some time.
 					Sleep(Milliseconds(1));
 
-					// Check if we should resend any packet.
-					m_ReliableMap.Mutex.Lock();
+					// Check if we should resend any packet, only the packets past their resend deadline are visited.
+					m_ReliablePackets.Mutex.Lock();
 
-					for (ReliablePacketMap::iterator it = m_ReliableMap.Value.begin();
-						it != m_ReliableMap.Value.end();
-						it++)
+					const Time currentTime = m_ReliableTimer.GetLapsedTime();
+					datagrams.clear();
+					m_ReliablePackets.Value.Expire(currentTime, [this, &currentTime, &datagrams](ReliablePacket & p_Packet) -> Time
 					{
-						pPacket = it->second;
-
-						// Resend packet after ping * 3.0 seconds.
-						// Calculte the resend time.
-						m_Ping.Mutex.Lock();
-						Time resendTime = Microseconds(static_cast<Uint64>(static_cast<Float64>(m_Ping.Value.AsMicroseconds()) * 3.0f));
-						m_Ping.Mutex.Unlock();
-
-						if (pPacket->ResendTimer.GetLapsedTime() >= resendTime)
-						{
-							// Send packet.
-							m_Socket.Send(pPacket->pData, pPacket->DataSize, m_ServerAddress, m_ServerPort);
-
-							// Restart the resend timer
-							pPacket->ResendTimer.Start();
-
-							// Mark the packet as resent.
-							pPacket->Resent = true;
-
-							// Increase the ping if we lose packets
-							m_Ping.Mutex.Lock();
-							m_Ping.Value = Microseconds(static_cast<Uint64>(static_cast<Float64>(m_Ping.Value.AsMicroseconds()) * 1.2f));
-							m_Ping.Mutex.Unlock();
-						}
+						UdpSocket::Datagram datagram;
+						datagram.pData = p_Packet.Data.data();
+						datagram.DataSize = p_Packet.Data.size();
+						datagram.RemoteAddress = m_ServerAddress;
+						datagram.RemotePort = m_ServerPort;
+						datagrams.push_back(datagram);
+
+						// The packet is lost, back off the resend time for every resend.
+						m_Congestion.Mutex.Lock();
+						m_Congestion.Value.Consume(p_Packet.Data.size(), true);
+						m_Congestion.Value.OnLoss();
+						m_Congestion.Mutex.Unlock();
+
+						p_Packet.Resends++;
+						return currentTime + GetResendTime(p_Packet.Resends);
+					});
+
+					// Resend the packets in a single batch.
+					if (datagrams.size())
+					{
+						m_pSocket->SendBatch(datagrams.data(), datagrams.size());
 					}
-					m_ReliableMap.Mutex.Unlock();
 
+					m_ReliablePackets.Mutex.Unlock();
+
+					// Send the packets coalesced since the last tick.
+					FlushPackets();
 				}
 			}
 			);
@@ -676,79 +514,407 @@ namespace Bit
 						// Pop the message
 						m_UserMessages.Value.pop();
 
-						// Get the message name
-						SizeType nameEnd = 1;
-						for (SizeType i = 1; i < pReceivedData->DataSize; i++)
-						{
-							if (pReceivedData->pData[i] == 0)
-							{
-								nameEnd = i;
-								break;
-							}
-						}
+						// Handle the message.
+						HandleHostMessage(pReceivedData->pData, pReceivedData->DataSize);
 
-						// Error check the name length
-						if (nameEnd == 1)
-						{
-							// Delete the received data pointer
-							delete pReceivedData;
-							continue;
-						}
+						// Delete the received data pointer
+						delete pReceivedData;
 
-						// Copy the name.
-						std::string name;
-						name.assign(reinterpret_cast<char*>(pReceivedData->pData + 1), nameEnd - 1);
+					}
 
-						// Check if there is any message left(including empty)
-						if (name.size() + 2 > pReceivedData->DataSize)
-						{
-							// Delete the received data pointer
-							delete pReceivedData;
-							continue;
-						}
+					m_UserMessages.Mutex.Unlock();
+				}
+			}
+			);
+
+			// Send the host message ids, the server sends the hooked messages by id from now on.
+			SendMessageTable(0);
+
+			// The connection succeeded
+			return Succeeded;
+		}
 
-						// Find the listeners for this user message
-						m_HostMessageListeners.Mutex.Lock();
-						HostMessageListenerMap::iterator it = m_HostMessageListeners.Value.find(name);
-						if (it == m_HostMessageListeners.Value.end())
+		void Client::HandlePacket(Uint8 * p_pData, const SizeType p_DataSize)
+		{
+			// Decompress the data of compressed packets, and handle them as regular packets.
+			if (p_pData[0] & CompressedPacketFlag)
+			{
+				if (p_DataSize <= CompressedPacketHeaderSize)
+				{
+					return;
+				}
+
+				std::vector<Uint8> packet(p_pData, p_pData + CompressedPacketHeaderSize);
+				packet[0] = static_cast<Uint8>(packet[0] & ~CompressedPacketFlag);
+				if (PacketCompressor::Decompress(	p_pData + CompressedPacketHeaderSize, p_DataSize - CompressedPacketHeaderSize, packet, MaxFragmentedMessageSize,
+													m_UseCompressionDictionary ? &m_CompressionDictionary : NULL) == false)
+				{
+					bitLogNetErr("Failed to decompress packet of type: " << static_cast<Uint32>(packet[0]));
+					return;
+				}
+
+				HandlePacket(packet.data(), packet.size());
+				return;
+			}
+
+			// Check the packet type
+			switch (p_pData[0])
+			{
+				// The server disconnected.
+			case PacketType::Disconnect:
+			{
+				// Set connected to false.
+				m_Connected.Mutex.Lock();
+				m_Connected.Value = false;
+				m_Connected.Mutex.Unlock();
+
+				// Wait for the threads to finish.
+				m_TriggerThread.Finish();
+				m_ReliableThread.Finish();
+
+				// Reset the sequence.
+				/*m_Sequence.Mutex.Lock();
+				m_Sequence.Value = 0;
+				m_Sequence.Mutex.Unlock();
+				*/
+				return;
+			}
+			break;
+			// ACK packet from server.
+			case PacketType::Acknowledgement:
+			{
+				// Ignore "corrupt" ack packet.
+				if (p_DataSize != AcknowledgementPacketSize)
+				{
+					return;
+				}
+
+				// Get the sequence
+				Uint16 sequence = Ntoh16(static_cast<Uint16>(static_cast<Uint8>(p_pData[1])) |
+					static_cast<Uint16>(static_cast<Uint8>(p_pData[2]) << 8));
+
+				HandleAcknowledgement(sequence);
+			}
+			break;
+			// Coalesced packets and acknowledgements from server.
+			case PacketType::Coalesced:
+			{
+				// Get the acknowledgement header
+				Bool hasAck = false;
+				Uint16 ackSequence = 0;
+				Uint32 ackBits = 0;
+				if (PacketBuilder::ReadHeader(p_pData, p_DataSize, hasAck, ackSequence, ackBits) == false)
+				{
+					return;
+				}
+
+				// Handle the acknowledgements.
+				if (hasAck)
+				{
+					HandleAcknowledgement(ackSequence);
+					for (Uint32 i = 0; i < AckBitCount; i++)
+					{
+						if ((ackBits >> i) & 0x01)
 						{
-							// Delete the received data pointer
-							delete pReceivedData;
-							continue;
+							HandleAcknowledgement(static_cast<Uint16>(ackSequence - 1 - i));
 						}
+					}
+				}
+
+				// Handle the packets, ignore nested coalesced packets.
+				SizeType position = CoalescedPacketSize;
+				Uint8 * pPacket = NULL;
+				SizeType packetSize = 0;
+				while (PacketBuilder::ReadPacket(p_pData, p_DataSize, position, pPacket, packetSize))
+				{
+					if (pPacket[0] != PacketType::Coalesced)
+					{
+						HandlePacket(pPacket, packetSize);
+					}
+				}
+			}
+			break;
+			// Alive packet from server.
+			case PacketType::Alive:
+			{
+				// Ignore "corrupt" alive packet.
+				if (p_DataSize != AlivePacketSize)
+				{
+					return;
+				}
 
-						HostMessageListenerSet * pMessageSet = it->second;
+				Uint16 sequence = Ntoh16(static_cast<Uint16>(static_cast<Uint8>(p_pData[1])) |
+					static_cast<Uint16>(static_cast<Uint8>(p_pData[2]) << 8));
 
-						// Go through the listeners and call the listener function
-						for (HostMessageListenerSet::iterator it2 = pMessageSet->begin(); it2 != pMessageSet->end(); it2++)
-						{
-							// Get the listener.
-							HostMessageListener * pListener = *it2;
+				// Acknowledge the packet
+				AcknowledgePacket(sequence);
+			}
+			break;
+			case PacketType::EntityUpdate:
+			{
+				// Error check the recv size
+				if (p_DataSize <= EntityUpdatePacketSize)
+				{
+					return;
+				}
 
-							// Create a message decoder
-							Uint8 * pDataPointer = pReceivedData->pData + name.size() + 2;
-							const SizeType dataSize = pReceivedData->DataSize - name.size() - 2;
-							HostMessageDecoder messageDecoder(name, pDataPointer, dataSize);
+				// Get the sequence
+				const Uint16 sequence = Ntoh16(static_cast<Uint16>(static_cast<Uint8>(p_pData[1])) |
+					static_cast<Uint16>(static_cast<Uint8>(p_pData[2]) << 8));
 
-							// Use threads????
-							// Handle the message.
-							pListener->HandleMessage(messageDecoder);
-						}
+				// Check the reliable flag
+				if (p_pData[PacketTypeSize + SequenceSize] == ReliabilityType::Reliable)
+				{
+					// Acknowledge the packet
+					AcknowledgePacket(sequence);
+				}
 
-						m_HostMessageListeners.Mutex.Unlock();
+				// Add the packets sequence to the sequence manager, do not handle the packet
+				// if we've already received a packet with the same sequence.
+				if (m_SequenceManager.AddSequence(sequence) && AddEntityUpdateSequence(sequence))
+				{
+					m_EntityManager.ParseEntityMessage(sequence, p_pData + EntityUpdatePacketSize, p_DataSize - EntityUpdatePacketSize);
+				}
 
-						// Delete the received data pointer
-						delete pReceivedData;
+			}
+			break;
+			case PacketType::EntityClasses:
+			{
+				// Error check the recv size
+				if (p_DataSize <= EntityClassesPacketSize)
+				{
+					return;
+				}
 
-					}
+				// Get the sequence
+				const Uint16 sequence = Ntoh16(static_cast<Uint16>(static_cast<Uint8>(p_pData[1])) |
+					static_cast<Uint16>(static_cast<Uint8>(p_pData[2]) << 8));
 
-					m_UserMessages.Mutex.Unlock();
+				// Check the reliable flag
+				if (p_pData[PacketTypeSize + SequenceSize] == ReliabilityType::Reliable)
+				{
+					// Acknowledge the packet
+					AcknowledgePacket(sequence);
+				}
+
+				// Add the packets sequence to the sequence manager, do not handle the packet
+				// if we've already received a packet with the same sequence.
+				if (m_SequenceManager.AddSequence(sequence))
+				{
+					m_EntityManager.ParseClassTableMessage(p_pData + EntityClassesPacketSize, p_DataSize - EntityClassesPacketSize);
 				}
 			}
-			);
+			break;
+			case PacketType::MessageTable:
+			{
+				// Error check the recv size
+				if (p_DataSize <= MessageTablePacketSize)
+				{
+					return;
+				}
 
-			// The connection succeeded
-			return Succeeded;
+				// Get the sequence
+				const Uint16 sequence = Ntoh16(static_cast<Uint16>(static_cast<Uint8>(p_pData[1])) |
+					static_cast<Uint16>(static_cast<Uint8>(p_pData[2]) << 8));
+
+				// Check the reliable flag
+				if (p_pData[PacketTypeSize + SequenceSize] == ReliabilityType::Reliable)
+				{
+					// Acknowledge the packet
+					AcknowledgePacket(sequence);
+				}
+
+				// Add the packets sequence to the sequence manager, do not handle the packet
+				// if we've already received a packet with the same sequence.
+				if (m_SequenceManager.AddSequence(sequence))
+				{
+					m_UserMessageIds.Mutex.Lock();
+					m_UserMessageIds.Value.Decode(p_pData + MessageTablePacketSize, p_DataSize - MessageTablePacketSize);
+					m_UserMessageIds.Mutex.Unlock();
+				}
+			}
+			break;
+			case PacketType::Compression:
+			{
+				// Error check the recv size
+				if (p_DataSize < CompressionPacketSize)
+				{
+					return;
+				}
+
+				// Get the sequence
+				const Uint16 sequence = Ntoh16(static_cast<Uint16>(static_cast<Uint8>(p_pData[1])) |
+					static_cast<Uint16>(static_cast<Uint8>(p_pData[2]) << 8));
+
+				// Check the reliable flag
+				if (p_pData[PacketTypeSize + SequenceSize] == ReliabilityType::Reliable)
+				{
+					// Acknowledge the packet
+					AcknowledgePacket(sequence);
+				}
+
+				if (m_SequenceManager.AddSequence(sequence))
+				{
+					Uint32 checksum = 0;
+					memcpy(&checksum, p_pData + PacketTypeSize + SequenceSize + ReliabilityFlagSize, sizeof(checksum));
+					checksum = Ntoh32(checksum);
+
+					// Accept the dictionary of the server if it's the same as ours, else accept compression without dictionary.
+					m_UseCompressionDictionary = checksum != 0 && checksum == m_CompressionDictionary.GetChecksum();
+					Uint32 answer = Hton32(m_UseCompressionDictionary ? checksum : 0);
+					SendReliable(PacketType::Compression, &answer, sizeof(answer), true);
+				}
+			}
+			break;
+			case PacketType::EntitySnapshot:
+			{
+				// Error check the recv size
+				if (p_DataSize <= EntitySnapshotPacketSize)
+				{
+					return;
+				}
+
+				// Get the sequence
+				const Uint16 sequence = Ntoh16(static_cast<Uint16>(static_cast<Uint8>(p_pData[1])) |
+					static_cast<Uint16>(static_cast<Uint8>(p_pData[2]) << 8));
+
+				// Add the packets sequence to the sequence manager, do not handle the packet
+				// if we've already received a packet with the same sequence.
+				if (m_SequenceManager.AddSequence(sequence) == false)
+				{
+					return;
+				}
+
+				// Parse the snapshot, and acknowledge it for the server to use as baseline.
+				Uint16 snapshotId = 0;
+				if (m_EntityManager.ParseSnapshotMessage(p_pData + EntitySnapshotPacketSize, p_DataSize - EntitySnapshotPacketSize, snapshotId))
+				{
+					const Uint16 networkSnapshotId = Hton16(snapshotId);
+					p_pData[0] = PacketType::SnapshotAck;
+					memcpy(p_pData + 1, &networkSnapshotId, 2);
+
+					// Send the snapshot ack packet
+					m_pSocket->Send(p_pData, SnapshotAckPacketSize, m_ServerAddress, m_ServerPort);
+				}
+			}
+			break;
+			case PacketType::EntityDestroyed:
+			{
+				// Error check the recv size
+				if (p_DataSize < EntityDestroyedPacketSize)
+				{
+					return;
+				}
+
+				// Get the sequence
+				const Uint16 sequence = Ntoh16(	static_cast<Uint16>(static_cast<Uint8>(p_pData[1])) |
+												static_cast<Uint16>(static_cast<Uint8>(p_pData[2]) << 8));
+
+				// Check the reliable flag
+				if (p_pData[PacketTypeSize + SequenceSize] == ReliabilityType::Reliable)
+				{
+					// Acknowledge the packet
+					AcknowledgePacket(sequence);
+				}
+
+				// Error check the sequence and add it to the sequence manager.
+				if (m_SequenceManager.AddSequence(sequence) == false)
+				{
+					return;
+				}
+
+
+				// Get entity id
+				Uint16 entityId = Ntoh16(	static_cast<Uint16>(static_cast<Uint8>(p_pData[4])) |
+											static_cast<Uint16>(static_cast<Uint8>(p_pData[5]) << 8));
+
+				// Get entity, it might already be removed by a snapshot when leaving the view.
+				Entity * pEntity = m_EntityManager.GetEntity(entityId);
+				if (pEntity == NULL)
+				{
+					return;
+				}
+
+				// Call entity destroyed function.
+				OnEntityDestroyed(pEntity);
+
+				// Destroy the entity.
+				m_EntityManager.DestroyEntity(pEntity, true);
+
+
+			}
+			break;
+			case PacketType::HostMessage:
+			{
+				// Error check the recv size
+				if (p_DataSize <= HostMessagePacketSize)
+				{
+					return;
+				}
+
+				// Get the sequence
+				const Uint16 sequence = Ntoh16(static_cast<Uint16>(static_cast<Uint8>(p_pData[1])) |
+					static_cast<Uint16>(static_cast<Uint8>(p_pData[2]) << 8));
+
+				// Check the reliable flag
+				if (p_pData[PacketTypeSize + SequenceSize] == ReliabilityType::Reliable)
+				{
+					// Acknowledge the packet
+					AcknowledgePacket(sequence);
+				}
+
+				// Add the packets sequence to the sequence manager, do not handle the packet
+				// if we've already received a packet with the same sequence.
+				if (m_SequenceManager.AddSequence(sequence))
+				{
+
+					// Add the host message, if it's its turn in the channel.
+					ReceiveHostMessage(p_pData + HostMessagePacketSize, p_DataSize - HostMessagePacketSize, sequence);
+				}
+			}
+			break;
+			case PacketType::Fragment:
+			{
+				// Error check the recv size
+				if (p_DataSize <= FragmentPacketSize)
+				{
+					return;
+				}
+
+				// Get the sequence
+				const Uint16 sequence = Ntoh16(static_cast<Uint16>(static_cast<Uint8>(p_pData[1])) |
+					static_cast<Uint16>(static_cast<Uint8>(p_pData[2]) << 8));
+
+				// Add the fragment to its message if it's not already handled.
+				// Do not acknowledge rejected fragments, the server will resend them.
+				if (m_SequenceManager.HasSequence(sequence) == false)
+				{
+					Uint8 messageType = 0;
+					std::vector<Uint8> message;
+					const FragmentAssembler::Result::eResult result =
+						m_FragmentAssembler.AddFragment(p_pData + PacketTypeSize + SequenceSize + ReliabilityFlagSize,
+														p_DataSize - PacketTypeSize - SequenceSize - ReliabilityFlagSize,
+														messageType, message);
+					if (result == FragmentAssembler::Result::Rejected)
+					{
+						return;
+					}
+
+					m_SequenceManager.AddSequence(sequence);
+
+					if (result == FragmentAssembler::Result::Completed)
+					{
+						HandleFragmentedMessage(messageType, message, sequence);
+					}
+				}
+
+				// Acknowledge the packet
+				AcknowledgePacket(sequence);
+			}
+			break;
+			default:
+				break;
+			}
 		}
 
 		void Client::Disconnect()
@@ -763,7 +929,38 @@ namespace Bit
 
 		Time Client::GetPing()
 		{
-			return m_Ping.Get();
+			m_Rtt.Mutex.Lock();
+			Time time = m_Rtt.Value.GetRtt() / 2ULL;
+			m_Rtt.Mutex.Unlock();
+			return time;
+		}
+
+		ConnectionStatistics Client::GetStatistics()
+		{
+			ConnectionStatistics statistics;
+
+			m_Rtt.Mutex.Lock();
+			statistics.Rtt = m_Rtt.Value.GetRtt();
+			statistics.RttVariance = m_Rtt.Value.GetRttVariance();
+			statistics.Rto = m_Rtt.Value.GetRto();
+			m_Rtt.Mutex.Unlock();
+
+			m_Congestion.Mutex.Lock();
+			statistics.PacketLoss = m_Congestion.Value.GetLoss() * 100.0f;
+			statistics.SendRate = m_Congestion.Value.GetSendRate();
+			statistics.DeliveryRate = m_Congestion.Value.GetDeliveryRate();
+			statistics.PacketsSent = m_Congestion.Value.GetPacketsSent();
+			statistics.PacketsLost = m_Congestion.Value.GetPacketsLost();
+			m_Congestion.Mutex.Unlock();
+
+			m_Channels.Mutex.Lock();
+			for (Uint8 i = 0; i < MaxChannelCount; i++)
+			{
+				statistics.OrderingDelay[i] = m_Channels.Value.GetOrderingDelay(i);
+			}
+			m_Channels.Mutex.Unlock();
+
+			return statistics;
 		}
 
 		Time Client::GetServerTime()
@@ -795,28 +992,40 @@ namespace Bit
 				return false;
 			}
 
-			m_HostMessageListeners.Mutex.Lock();
+			// Give the message an id.
+			m_HostMessageTable.Mutex.Lock();
+			const SizeType messageCount = m_HostMessageTable.Value.GetSize();
+			const Uint16 id = m_HostMessageTable.Value.Add(m_MessageName);
+			m_HostMessageTable.Mutex.Unlock();
 
-			// Find the user mesage set pointer.
-			HostMessageListenerSet * pMessageSet = NULL;
+			if (id == NameMessageId)
+			{
+				bitLogNetErr("Failed to hook host message: " << m_MessageName);
+				return false;
+			}
 
-			// Find the message
-			HostMessageListenerMap::iterator it = m_HostMessageListeners.Value.find(m_MessageName);
-			if (it == m_HostMessageListeners.Value.end())
+			// Add the listener to the handler of the message id.
+			m_HostMessageHandlers.Mutex.Lock();
+
+			if (m_HostMessageHandlers.Value.size() <= id)
 			{
-				// Create a new message
-				pMessageSet = new HostMessageListenerSet;
-				m_HostMessageListeners.Value.insert(HostMessageListenerPair(m_MessageName, pMessageSet));
+				m_HostMessageHandlers.Value.resize(id + 1);
 			}
-			else
+
+			HostMessageHandler & handler = m_HostMessageHandlers.Value[id];
+			handler.Name = m_MessageName;
+			if (std::find(handler.Listeners.begin(), handler.Listeners.end(), p_pListener) == handler.Listeners.end())
 			{
-				pMessageSet = it->second;
+				handler.Listeners.push_back(p_pListener);
 			}
 
-			// Add the listener to the message set
-			pMessageSet->insert(p_pListener);
+			m_HostMessageHandlers.Mutex.Unlock();
 
-			m_HostMessageListeners.Mutex.Unlock();
+			// Tell the server about the new message id.
+			if (id >= messageCount && IsConnected())
+			{
+				SendMessageTable(id);
+			}
 
 			return true;
 		}
@@ -826,13 +1035,32 @@ namespace Bit
 			return new UserMessage(p_Name, this, p_MessageSize);
 		}
 
+		Bool Client::SetChannel(const Uint8 p_Channel, const DeliveryType::eType p_Delivery)
+		{
+			m_Channels.Mutex.Lock();
+			const Bool result = m_Channels.Value.SetDelivery(p_Channel, p_Delivery);
+			m_Channels.Mutex.Unlock();
+
+			return result;
+		}
+
+		void Client::SetCompressionDictionary(const CompressionDictionary & p_Dictionary)
+		{
+			m_CompressionDictionary = p_Dictionary;
+		}
+
+		void Client::SetSocketFactory(SocketFactory * p_pFactory)
+		{
+			m_pSocketFactory = p_pFactory;
+		}
+
 		Time Client::TimeSinceLastRecvPacket()
 		{
 			return m_LastRecvTimer.Get().GetLapsedTime();
 		}
 
 		// Received data struct
-		Client::ReceivedData::ReceivedData(Uint8 * p_pData, const SizeType p_DataSize, const Uint16 p_Sequence) :
+		Client::ReceivedData::ReceivedData(const Uint8 * p_pData, const SizeType p_DataSize, const Uint16 p_Sequence) :
 			Sequence(p_Sequence),
 			DataSize(p_DataSize)
 		{
@@ -861,6 +1089,9 @@ namespace Bit
 
 			if (connected)
 			{
+				// Send the coalesced packets.
+				FlushPackets();
+
 				// Send close packet.
 				SendUnreliable(PacketType::Disconnect, NULL, 0, false, false);
 			}
@@ -890,16 +1121,26 @@ namespace Bit
 			m_Sequence.Mutex.Unlock();
 */
 			// Clear the reliable packets
-			m_ReliableMap.Mutex.Lock();
-			for (ReliablePacketMap::iterator it = m_ReliableMap.Value.begin();
-				it != m_ReliableMap.Value.end();
-				it++)
+			m_ReliablePackets.Mutex.Lock();
+			m_ReliablePackets.Value.Clear([](ReliablePacket &) { });
+			m_ReliablePackets.Mutex.Unlock();
+
+			// Clear the fragmented messages
+			m_FragmentedMessages.Mutex.Lock();
+			while (m_FragmentedMessages.Value.size())
 			{
-				delete[] it->second->pData;
-				delete it->second;
+				delete[] m_FragmentedMessages.Value.front().pData;
+				m_FragmentedMessages.Value.pop();
 			}
-			m_ReliableMap.Value.clear();
-			m_ReliableMap.Mutex.Unlock();
+			m_FragmentsInFlight = 0;
+			m_FragmentedMessages.Mutex.Unlock();
+			m_ReliableRingFull.Set(false);
+			m_FragmentAssembler.Clear();
+
+			// Clear the coalesced packets
+			m_PacketBuilder.Mutex.Lock();
+			m_PacketBuilder.Value.Clear();
+			m_PacketBuilder.Mutex.Unlock();
 
 			// Clear user messages
 			m_UserMessages.Mutex.Lock();
@@ -911,10 +1152,6 @@ namespace Bit
 				delete pReceivedData;
 			}
 			m_UserMessages.Mutex.Unlock();
-
-
-			// Clear the ping list.
-			m_PingList.clear();
 		}
 
 		void Client::SendUnreliable(const PacketType::eType p_PacketType,
@@ -959,8 +1196,16 @@ namespace Bit
 			// Add the data to the new buffer
 			memcpy(pBuffer + (packetSize - p_DataSize), p_pData, p_DataSize);
 
-			// Send the packet.
-			m_Socket.Send(pBuffer, packetSize, m_ServerAddress, m_ServerPort);
+			// Count the packet in the statistics.
+			m_Congestion.Mutex.Lock();
+			m_Congestion.Value.Consume(packetSize, true);
+			m_Congestion.Mutex.Unlock();
+
+			// Coalesce messages, send control packets right away.
+			if (p_AddSequence == false || QueuePacket(pBuffer, packetSize, NULL, 0) == false)
+			{
+				m_pSocket->Send(pBuffer, packetSize, m_ServerAddress, m_ServerPort);
+			}
 
 			// Delete the packet
 			delete[] pBuffer;
@@ -971,10 +1216,36 @@ namespace Bit
 			const SizeType p_DataSize,
 			const bool p_AddReliableFlag)
 		{
-			// Create a new buffer.
-			const SizeType packetSize = p_DataSize + PacketTypeSize + SequenceSize + (p_AddReliableFlag ? 1 : 0);
-			Uint8 * pBuffer = new Uint8[packetSize];
-			pBuffer[0] = static_cast<Uint8>(p_PacketType);
+			// Queue messages too large for a single packet, and send them in fragments.
+			if (p_DataSize > FragmentDataSize)
+			{
+				if (p_DataSize > MaxUserFragmentedMessageSize)
+				{
+					bitLogNetErr("Too large reliable message: " << p_DataSize);
+					return;
+				}
+
+				FragmentedMessage message;
+				message.Type = p_PacketType;
+				message.pData = new Uint8[p_DataSize];
+				message.DataSize = p_DataSize;
+				message.NextFragment = 0;
+				message.FragmentCount = FragmentAssembler::GetFragmentCount(p_DataSize);
+				memcpy(message.pData, p_pData, p_DataSize);
+
+				m_FragmentedMessages.Mutex.Lock();
+				message.MessageId = m_NextMessageId++;
+				m_FragmentedMessages.Value.push(message);
+				m_FragmentedMessages.Mutex.Unlock();
+
+				SendFragments();
+				return;
+			}
+
+			// Create the header.
+			const SizeType headerSize = PacketTypeSize + SequenceSize + (p_AddReliableFlag ? 1 : 0);
+			Uint8 header[PacketTypeSize + SequenceSize + ReliabilityFlagSize];
+			header[0] = static_cast<Uint8>(p_PacketType);
 
 			// Get the current sequence, and increment it.
 			m_Sequence.Mutex.Lock();
@@ -982,35 +1253,309 @@ namespace Bit
 			m_Sequence.Value++;
 			m_Sequence.Mutex.Unlock();
 
-			// Add the sequence to the data buffer.
+			// Add the sequence to the header.
 			Bit::Uint16 sequence = Bit::Hton16(currentSequence);
-			memcpy(pBuffer + 1, &sequence, SequenceSize);
+			memcpy(header + 1, &sequence, SequenceSize);
 
 			// Add the reliable flag
 			if (p_AddReliableFlag)
 			{
-				pBuffer[PacketTypeSize + SequenceSize] = static_cast<Uint8>(ReliabilityType::Reliable);
+				header[PacketTypeSize + SequenceSize] = static_cast<Uint8>(ReliabilityType::Reliable);
 			}
 
-			// Add the data to the buffer
-			memcpy(pBuffer + (packetSize - p_DataSize), p_pData, p_DataSize);
+			// Create the reliable packet and add it to the reliable packet ring.
+			ReliablePacket * pReliablePacket = CreateReliablePacket(currentSequence, header, headerSize, static_cast<const Uint8 *>(p_pData), p_DataSize);
+			if (pReliablePacket == NULL)
+			{
+				return;
+			}
+			const Uint8 * pBuffer = pReliablePacket->Data.data();
+			const SizeType packetSize = pReliablePacket->Data.size();
+
+			// Coalesce small packets with the other packets of the tick.
+			if (QueuePacket(pBuffer, packetSize, NULL, 0))
+			{
+				return;
+			}
+
+			// Send SYN packet, tell the server that we would like to connect.
+			if (m_pSocket->Send(pBuffer, packetSize, m_ServerAddress, m_ServerPort) == packetSize)
+			{
+				// Restart the timer
+				m_LastSendTimer.Mutex.Lock();
+				m_LastSendTimer.Value.Start();
+				m_LastSendTimer.Mutex.Unlock();
+			}
+		}
+
+		Client::ReliablePacket * Client::CreateReliablePacket(	const Uint16 p_Sequence,
+																const Uint8 * p_pHeader,
+																const SizeType p_HeaderSize,
+																const Uint8 * p_pData,
+																const SizeType p_DataSize)
+		{
+			const Time resendTime = GetResendTime(0);
+
+			// Add the packet to the reliable packet ring, the packet is filled while the ring is locked.
+			m_ReliablePackets.Mutex.Lock();
+			const Time deadline = m_ReliableTimer.GetLapsedTime() + resendTime;
+			ReliablePacket * pReliablePacket = m_ReliablePackets.Value.Add(p_Sequence, deadline);
+
+			// The packet of the sequence a whole sequence space ago is still not acknowledged,
+			// the sequence can't be reused. Fail the connection, the packets in the ring are kept until the disconnection.
+			if (pReliablePacket == NULL)
+			{
+				m_ReliablePackets.Mutex.Unlock();
 
-			// Create the reliable packet.
-			ReliablePacket * pReliablePacket = new ReliablePacket;
-			pReliablePacket->pData = pBuffer;
-			pReliablePacket->DataSize = packetSize;
-			pReliablePacket->Sequence = currentSequence;
-			pReliablePacket->Resent = false;
+				m_ReliableRingFull.Mutex.Lock();
+				if (m_ReliableRingFull.Value == false)
+				{
+					bitLogNetErr("Reliable packet never acknowledged: " << p_Sequence);
+					m_ReliableRingFull.Value = true;
+				}
+				m_ReliableRingFull.Mutex.Unlock();
+				return NULL;
+			}
+
+			// Copy the header and the data to the packet buffer.
+			pReliablePacket->Data.assign(p_pHeader, p_pHeader + p_HeaderSize);
+			if (p_DataSize)
+			{
+				pReliablePacket->Data.insert(pReliablePacket->Data.end(), p_pData, p_pData + p_DataSize);
+			}
+
+			pReliablePacket->Sequence = p_Sequence;
+			pReliablePacket->Resends = 0;
 			pReliablePacket->SendTimer.Start();
-			pReliablePacket->ResendTimer.Start();
 
-			// Add the packet to the reliable map.
-			m_ReliableMap.Mutex.Lock();
-			m_ReliableMap.Value.insert(ReliablePacketPair(currentSequence, pReliablePacket));
-			m_ReliableMap.Mutex.Unlock();
+			m_ReliablePackets.Mutex.Unlock();
 
-			// Send SYN packet, tell the server that we would like to connect.
-			if (m_Socket.Send(pBuffer, packetSize, m_ServerAddress, m_ServerPort) == packetSize)
+			// Count the packet in the statistics.
+			m_Congestion.Mutex.Lock();
+			m_Congestion.Value.Consume(p_HeaderSize + p_DataSize, true);
+			m_Congestion.Mutex.Unlock();
+
+			return pReliablePacket;
+		}
+
+		Time Client::GetResendTime(const Uint32 p_Resends)
+		{
+			m_Rtt.Mutex.Lock();
+			const Time resendTime = m_Rtt.Value.GetBackoffRto(p_Resends);
+			m_Rtt.Mutex.Unlock();
+			return resendTime;
+		}
+
+		void Client::SendFragments()
+		{
+			std::vector<UdpSocket::Datagram> datagrams;
+
+			// Create the fragment packets, in the order of the messages.
+			m_FragmentedMessages.Mutex.Lock();
+			while (m_FragmentedMessages.Value.size() && m_FragmentsInFlight < FragmentWindowSize)
+			{
+				FragmentedMessage & message = m_FragmentedMessages.Value.front();
+
+				// Create the fragment packet.
+				const SizeType dataOffset = static_cast<SizeType>(message.NextFragment) * FragmentDataSize;
+				const SizeType dataSize = std::min(FragmentDataSize, message.DataSize - dataOffset);
+				Uint8 header[FragmentPacketSize];
+				header[0] = static_cast<Uint8>(PacketType::Fragment);
+
+				// Get the current sequence, and increment it.
+				m_Sequence.Mutex.Lock();
+				Bit::Uint16 currentSequence = m_Sequence.Value;
+				m_Sequence.Value++;
+				m_Sequence.Mutex.Unlock();
+
+				// Add the sequence, reliable flag and fragment header to the header.
+				Bit::Uint16 sequence = Bit::Hton16(currentSequence);
+				memcpy(header + 1, &sequence, SequenceSize);
+				header[PacketTypeSize + SequenceSize] = static_cast<Uint8>(ReliabilityType::Reliable);
+				FragmentAssembler::WriteHeader(	header + PacketTypeSize + SequenceSize + ReliabilityFlagSize,
+												static_cast<Uint8>(message.Type),
+												message.MessageId,
+												message.NextFragment,
+												message.FragmentCount);
+
+				// Create the reliable packet and add it to the reliable packet ring.
+				ReliablePacket * pReliablePacket = CreateReliablePacket(currentSequence, header, FragmentPacketSize, message.pData + dataOffset, dataSize);
+				if (pReliablePacket == NULL)
+				{
+					break;
+				}
+
+				UdpSocket::Datagram datagram;
+				datagram.pData = pReliablePacket->Data.data();
+				datagram.DataSize = pReliablePacket->Data.size();
+				datagram.RemoteAddress = m_ServerAddress;
+				datagram.RemotePort = m_ServerPort;
+				datagrams.push_back(datagram);
+				m_FragmentsInFlight++;
+
+				// Delete the message data when all fragments are sent.
+				message.NextFragment++;
+				if (message.NextFragment == message.FragmentCount)
+				{
+					delete[] message.pData;
+					m_FragmentedMessages.Value.pop();
+				}
+			}
+			m_FragmentedMessages.Mutex.Unlock();
+
+			// Send the fragments in a single batch.
+			if (datagrams.size() && m_pSocket->SendBatch(datagrams.data(), datagrams.size()) > 0)
+			{
+				// Restart the timer
+				m_LastSendTimer.Mutex.Lock();
+				m_LastSendTimer.Value.Start();
+				m_LastSendTimer.Mutex.Unlock();
+			}
+		}
+
+		void Client::HandleFragmentedMessage(const Uint8 p_MessageType, std::vector<Uint8> & p_Message, const Uint16 p_Sequence)
+		{
+			// Decompress compressed messages, they are compressed as a whole before the fragmentation.
+			if (p_MessageType & CompressedPacketFlag)
+			{
+				std::vector<Uint8> message;
+				if (PacketCompressor::Decompress(	p_Message.data(), p_Message.size(), message, MaxFragmentedMessageSize,
+													m_UseCompressionDictionary ? &m_CompressionDictionary : NULL) == false)
+				{
+					bitLogNetErr("Failed to decompress fragmented message of type: " << static_cast<Uint32>(p_MessageType & ~CompressedPacketFlag));
+					return;
+				}
+
+				HandleFragmentedMessage(static_cast<Uint8>(p_MessageType & ~CompressedPacketFlag), message, p_Sequence);
+				return;
+			}
+
+			switch (p_MessageType)
+			{
+				case PacketType::HostMessage:
+				{
+					ReceiveHostMessage(p_Message.data(), p_Message.size(), p_Sequence);
+				}
+				break;
+				case PacketType::EntityClasses:
+				{
+					m_EntityManager.ParseClassTableMessage(p_Message.data(), p_Message.size());
+				}
+				break;
+				case PacketType::MessageTable:
+				{
+					m_UserMessageIds.Mutex.Lock();
+					m_UserMessageIds.Value.Decode(p_Message.data(), p_Message.size());
+					m_UserMessageIds.Mutex.Unlock();
+				}
+				break;
+				default:
+				{
+					bitLogNetErr("Unexpected fragmented message: " << static_cast<Uint32>(p_MessageType));
+				}
+				break;
+			}
+		}
+
+		void Client::HandleAcknowledgement(const Uint16 p_Sequence)
+		{
+			// Find the sequence in the reliable packet ring
+			Bool fragmentAcked = false;
+			m_ReliablePackets.Mutex.Lock();
+			ReliablePacket * pPacket = m_ReliablePackets.Value.Get(p_Sequence);
+			// Remove the packet from the ring if it's found and calculate the ping.
+			if (pPacket)
+			{
+				// Calculate the new ping from the lapsed time if it's not a resent packet
+				if (pPacket->Resends == 0)
+				{
+					CalculateNewPing(pPacket->SendTimer.GetLapsedTime());
+				}
+
+				// Estimate the delivery rate.
+				m_Congestion.Mutex.Lock();
+				m_Congestion.Value.OnAcknowledgement(pPacket->Data.size());
+				m_Congestion.Mutex.Unlock();
+
+				fragmentAcked = pPacket->Data[0] == PacketType::Fragment;
+
+				// Return the reliable packet to the pool, the data buffer is kept for the next packet.
+				m_ReliablePackets.Value.Remove(p_Sequence);
+			}
+			m_ReliablePackets.Mutex.Unlock();
+
+			// Send the next fragments, there's room in the fragment window.
+			if (fragmentAcked)
+			{
+				m_FragmentedMessages.Mutex.Lock();
+				m_FragmentsInFlight--;
+				m_FragmentedMessages.Mutex.Unlock();
+
+				SendFragments();
+			}
+		}
+
+		void Client::AcknowledgePacket(const Uint16 p_Sequence)
+		{
+			m_PacketBuilder.Mutex.Lock();
+
+			PacketBuilder::AckResult::eResult result = m_PacketBuilder.Value.AddAcknowledgement(p_Sequence);
+
+			// Send the unsent acknowledgements before they are shifted out of the ack bitfield.
+			if (result == PacketBuilder::AckResult::Full)
+			{
+				SendCoalescedPacket();
+				result = m_PacketBuilder.Value.AddAcknowledgement(p_Sequence);
+			}
+
+			m_PacketBuilder.Mutex.Unlock();
+
+			// Acknowledge packets older than the ack bitfield on their own.
+			if (result == PacketBuilder::AckResult::Old)
+			{
+				Uint8 buffer[AcknowledgementPacketSize];
+				const Uint16 sequence = Hton16(p_Sequence);
+				buffer[0] = PacketType::Acknowledgement;
+				memcpy(buffer + 1, &sequence, SequenceSize);
+				m_pSocket->Send(buffer, AcknowledgementPacketSize, m_ServerAddress, m_ServerPort);
+			}
+		}
+
+		Bool Client::QueuePacket(const Uint8 * p_pHeader,
+			const SizeType p_HeaderSize,
+			const Uint8 * p_pData,
+			const SizeType p_DataSize)
+		{
+			if (PacketBuilder::CanCoalesce(p_HeaderSize + p_DataSize) == false)
+			{
+				return false;
+			}
+
+			m_PacketBuilder.Mutex.Lock();
+
+			// Send the coalesced packet if there's no room for the packet.
+			if (m_PacketBuilder.Value.AddPacket(p_pHeader, p_HeaderSize, p_pData, p_DataSize) == false)
+			{
+				SendCoalescedPacket();
+				m_PacketBuilder.Value.AddPacket(p_pHeader, p_HeaderSize, p_pData, p_DataSize);
+			}
+
+			m_PacketBuilder.Mutex.Unlock();
+
+			return true;
+		}
+
+		void Client::FlushPackets()
+		{
+			m_PacketBuilder.Mutex.Lock();
+			SendCoalescedPacket();
+			m_PacketBuilder.Mutex.Unlock();
+		}
+
+		void Client::SendCoalescedPacket()
+		{
+			if (m_PacketBuilder.Value.Flush(m_CoalescedPacket) &&
+				m_pSocket->Send(m_CoalescedPacket.data(), m_CoalescedPacket.size(), m_ServerAddress, m_ServerPort) > 0)
 			{
 				// Restart the timer
 				m_LastSendTimer.Mutex.Lock();
@@ -1021,21 +1566,108 @@ namespace Bit
 
 		void Client::CalculateNewPing(const Time & p_LapsedTime)
 		{
-			// Add the new ping to the ping list
-			m_PingList.pop_front();
-			m_PingList.push_back(p_LapsedTime / 2ULL);
+			m_Rtt.Mutex.Lock();
+			m_Rtt.Value.AddSample(p_LapsedTime);
+			m_Rtt.Mutex.Unlock();
+		}
+
+		void Client::HandleHostMessage(const Uint8 * p_pData, const SizeType p_DataSize)
+		{
+			// Read the message id.
+			Uint16 id = 0;
+			const char * pName = NULL;
+			SizeType headerSize = 0;
+			if (MessageTable::ReadHeader(p_pData, p_DataSize, id, pName, headerSize) == false)
+			{
+				return;
+			}
+
+			// Find the id of messages sent by name.
+			if (pName)
+			{
+				m_HostMessageTable.Mutex.Lock();
+				id = m_HostMessageTable.Value.Find(pName);
+				m_HostMessageTable.Mutex.Unlock();
+			}
+
+			// Go through the listeners and call the listener function
+			m_HostMessageHandlers.Mutex.Lock();
+
+			if (id < m_HostMessageHandlers.Value.size())
+			{
+				const HostMessageHandler & handler = m_HostMessageHandlers.Value[id];
+				for (SizeType i = 0; i < handler.Listeners.size(); i++)
+				{
+					HostMessageDecoder messageDecoder(handler.Name, p_pData + headerSize, p_DataSize - headerSize);
+					handler.Listeners[i]->HandleMessage(messageDecoder);
+				}
+			}
+
+			m_HostMessageHandlers.Mutex.Unlock();
+		}
+
+		void Client::SendMessageTable(const Uint16 p_FirstId)
+		{
+			std::vector<Uint8> table;
+			m_HostMessageTable.Mutex.Lock();
+			m_HostMessageTable.Value.Encode(table, p_FirstId);
+			m_HostMessageTable.Mutex.Unlock();
 
-			// Calculate the new ping
-			Uint64 newPing = 0ULL;
-			for (TimeList::iterator it = m_PingList.begin(); it != m_PingList.end(); it++)
+			if (table.size())
 			{
-				newPing += it->AsMicroseconds();
+				SendReliable(PacketType::MessageTable, table.data(), table.size(), true);
 			}
-			newPing /= static_cast<Uint64>(m_PingList.size());
+		}
 
-			m_Ping.Mutex.Lock();
-			m_Ping.Value = Microseconds(newPing);
-			m_Ping.Mutex.Unlock();
+		void Client::ReceiveHostMessage(const Uint8 * p_pData, const SizeType p_DataSize, const Uint16 p_Sequence)
+		{
+			// Get the channel of the message.
+			Uint8 channel = 0;
+			Uint16 channelSequence = 0;
+			if (MessageChannels::ReadChannel(p_pData, p_DataSize, channel, channelSequence) == false)
+			{
+				return;
+			}
+
+			m_Channels.Mutex.Lock();
+			const MessageChannels::Result::eResult result = m_Channels.Value.Receive(channel, channelSequence, p_pData, p_DataSize);
+			m_Channels.Mutex.Unlock();
+
+			// The message is acknowledged but can't be buffered, fail the connection.
+			if (result == MessageChannels::Result::Overflow)
+			{
+				m_ChannelsFull.Mutex.Lock();
+				if (m_ChannelsFull.Value == false)
+				{
+					bitLogNetErr("Reorder buffer full, channel: " << static_cast<Uint32>(channel & ChannelIndexMask));
+					m_ChannelsFull.Value = true;
+				}
+				m_ChannelsFull.Mutex.Unlock();
+				return;
+			}
+
+			if (result != MessageChannels::Result::Deliver)
+			{
+				return;
+			}
+
+			AddHostMessage(new ReceivedData(p_pData, p_DataSize, p_Sequence));
+
+			// Add the buffered messages waiting for this one.
+			std::vector<Uint8> message;
+			while (true)
+			{
+				m_Channels.Mutex.Lock();
+				const Bool polled = m_Channels.Value.PollBuffered(channel, message);
+				m_Channels.Mutex.Unlock();
+
+				if (polled == false)
+				{
+					break;
+				}
+
+				AddHostMessage(new ReceivedData(message.data(), message.size(), p_Sequence));
+			}
 		}
 
 		void Client::AddHostMessage(ReceivedData * p_pReceivedData)
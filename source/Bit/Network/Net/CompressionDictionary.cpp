@@ -0,0 +1,215 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/CompressionDictionary.hpp>
+#include <Bit/Network/Net/Private/PacketCompressor.hpp>
+#include <algorithm>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		// Constants of the dictionary.
+		const SizeType CompressionDictionary::MaxSize;
+		const SizeType CompressionDictionary::DefaultSize;
+
+		// Training parameters, the size of the counted byte sequences and of the picked segments.
+		static const SizeType g_GramSize = 8;
+		static const SizeType g_SegmentSize = 32;
+		static const Uint32 g_GramHashLog = 16;
+
+		// Hash of the byte sequence counted by the training.
+		static inline Uint32 HashGram( const Uint8 * p_pData )
+		{
+			Uint32 hash = 2166136261U;
+			for( SizeType i = 0; i < g_GramSize; i++ )
+			{
+				hash = ( hash ^ p_pData[ i ] ) * 16777619U;
+			}
+			return hash >> ( 32 - g_GramHashLog );
+		}
+
+		// Segment of a sample, a candidate for the dictionary.
+		struct DictionarySegment
+		{
+			const Uint8 *	pData;
+			SizeType		Size;
+			Uint64			Score;
+
+			bool operator < ( const DictionarySegment & p_Segment ) const
+			{
+				return Score > p_Segment.Score;
+			}
+		};
+
+		// Get the score of a segment, by the number of other occurrences of its byte sequences.
+		static Uint64 GetSegmentScore( const DictionarySegment & p_Segment, const std::vector<Uint32> & p_Counts )
+		{
+			Uint64 score = 0;
+			for( SizeType i = 0; i + g_GramSize <= p_Segment.Size; i++ )
+			{
+				const Uint32 count = p_Counts[ HashGram( p_Segment.pData + i ) ];
+				score += count > 1 ? count - 1 : 0;
+			}
+			return score;
+		}
+
+		CompressionDictionary::CompressionDictionary( ) :
+			m_Checksum( 0 )
+		{
+		}
+
+		void CompressionDictionary::Set( const Uint8 * p_pData, const SizeType p_Size )
+		{
+			Clear( );
+
+			if( p_pData == NULL || p_Size == 0 )
+			{
+				return;
+			}
+
+			// Keep the end of the data, the closest to the compressed data.
+			const SizeType size = std::min( p_Size, MaxSize );
+			m_Data.assign( p_pData + p_Size - size, p_pData + p_Size );
+
+			// FNV-1a checksum, 0 is reserved for no dictionary.
+			m_Checksum = 2166136261U;
+			for( SizeType i = 0; i < m_Data.size( ); i++ )
+			{
+				m_Checksum = ( m_Checksum ^ m_Data[ i ] ) * 16777619U;
+			}
+			if( m_Checksum == 0 )
+			{
+				m_Checksum = 1;
+			}
+
+			// Hash the positions of the content, the later positions overwrite the earlier ones.
+			m_HashTable.assign( static_cast<SizeType>( 1 ) << PacketCompressor::DictionaryHashLog, 0 );
+			for( SizeType i = 0; i + PacketCompressor::MinMatchSize <= m_Data.size( ); i++ )
+			{
+				m_HashTable[ PacketCompressor::Hash( &m_Data[ i ], PacketCompressor::DictionaryHashLog ) ] = static_cast<Uint32>( i + 1 );
+			}
+		}
+
+		Bool CompressionDictionary::Train( const std::vector<std::vector<Uint8> > & p_Samples, const SizeType p_Size )
+		{
+			Clear( );
+
+			const SizeType maxSize = std::min( p_Size, MaxSize );
+
+			// Count the byte sequences of all the samples.
+			std::vector<Uint32> counts( static_cast<SizeType>( 1 ) << g_GramHashLog, 0 );
+			for( SizeType i = 0; i < p_Samples.size( ); i++ )
+			{
+				const std::vector<Uint8> & sample = p_Samples[ i ];
+				for( SizeType j = 0; j + g_GramSize <= sample.size( ); j++ )
+				{
+					counts[ HashGram( &sample[ j ] ) ]++;
+				}
+			}
+
+			// Score the segments of the samples.
+			std::vector<DictionarySegment> segments;
+			for( SizeType i = 0; i < p_Samples.size( ); i++ )
+			{
+				const std::vector<Uint8> & sample = p_Samples[ i ];
+				for( SizeType j = 0; j + g_GramSize <= sample.size( ); j += g_GramSize )
+				{
+					DictionarySegment segment;
+					segment.pData = &sample[ j ];
+					segment.Size = std::min( g_SegmentSize, sample.size( ) - j );
+					segment.Score = GetSegmentScore( segment, counts );
+					if( segment.Score )
+					{
+						segments.push_back( segment );
+					}
+				}
+			}
+			std::sort( segments.begin( ), segments.end( ) );
+
+			// Pick the best segments, forgetting the counts of their sequences
+			// to not pick the same content twice.
+			std::vector<const DictionarySegment *> picked;
+			SizeType size = 0;
+			for( SizeType i = 0; i < segments.size( ) && size < maxSize; i++ )
+			{
+				const DictionarySegment & segment = segments[ i ];
+				if( size + segment.Size > maxSize || GetSegmentScore( segment, counts ) < segment.Size )
+				{
+					continue;
+				}
+
+				for( SizeType j = 0; j + g_GramSize <= segment.Size; j++ )
+				{
+					counts[ HashGram( segment.pData + j ) ] = 0;
+				}
+
+				picked.push_back( &segment );
+				size += segment.Size;
+			}
+
+			if( picked.size( ) == 0 )
+			{
+				return false;
+			}
+
+			// Put the best segments at the end, closest to the compressed data.
+			std::vector<Uint8> data;
+			data.reserve( size );
+			for( SizeType i = picked.size( ); i > 0; i-- )
+			{
+				data.insert( data.end( ), picked[ i - 1 ]->pData, picked[ i - 1 ]->pData + picked[ i - 1 ]->Size );
+			}
+
+			Set( data.data( ), data.size( ) );
+			return true;
+		}
+
+		void CompressionDictionary::Clear( )
+		{
+			m_Data.clear( );
+			m_HashTable.clear( );
+			m_Checksum = 0;
+		}
+
+		const std::vector<Uint8> & CompressionDictionary::GetData( ) const
+		{
+			return m_Data;
+		}
+
+		SizeType CompressionDictionary::GetSize( ) const
+		{
+			return m_Data.size( );
+		}
+
+		Uint32 CompressionDictionary::GetChecksum( ) const
+		{
+			return m_Checksum;
+		}
+
+	}
+
+}
@@ -32,7 +32,10 @@ namespace Bit
 	{
 
 		Entity::Entity( ) :
-			m_pEntityManager( NULL )
+			m_pEntityManager( NULL ),
+			m_Position( 0.0f, 0.0f, 0.0f ),
+			m_HasPosition( false ),
+			m_DirtyMask( 0 )
 		{
 		}
 
@@ -70,6 +73,35 @@ namespace Bit
 			return groupSet;
 		}
 
+		void Entity::SetPosition(const Vector3f32 & p_Position)
+		{
+			m_PositionMutex.Lock();
+			m_Position = p_Position;
+			m_HasPosition = true;
+			m_PositionMutex.Unlock();
+		}
+
+		void Entity::ClearPosition()
+		{
+			m_PositionMutex.Lock();
+			m_HasPosition = false;
+			m_PositionMutex.Unlock();
+		}
+
+		Bool Entity::GetPosition(Vector3f32 & p_Position)
+		{
+			SmartMutex mutex(m_PositionMutex);
+			mutex.Lock();
+
+			if (m_HasPosition == false)
+			{
+				return false;
+			}
+
+			p_Position = m_Position;
+			return true;
+		}
+
 		Entity::~Entity()
 		{
 		}
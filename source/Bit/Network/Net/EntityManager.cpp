@@ -27,6 +27,8 @@
 #include <Bit/System/Vector2.hpp>
 #include <Bit/System/Log.hpp>
 #include <set>
+#include <cstring>
+#include <algorithm>
 #include <Bit/System/MemoryLeak.hpp>
 
 namespace Bit
@@ -35,13 +37,73 @@ namespace Bit
 	namespace Net
 	{
 
+		// Static functions for reading and writing network ordered 16 bit integers.
+		static void AddUint16( std::vector<Uint8> & p_Message, const Uint16 p_Value )
+		{
+			const Uint16 value = Hton16( p_Value );
+			p_Message.push_back( static_cast<Uint8>( value ) );
+			p_Message.push_back( static_cast<Uint8>( value >> 8 ) );
+		}
+
+		static void SetUint16( std::vector<Uint8> & p_Message, const SizeType p_Position, const Uint16 p_Value )
+		{
+			const Uint16 value = Hton16( p_Value );
+			p_Message[ p_Position ] = static_cast<Uint8>( value );
+			p_Message[ p_Position + 1 ] = static_cast<Uint8>( value >> 8 );
+		}
+
+		static Uint16 ReadUint16( const Uint8 * p_pData )
+		{
+			return Ntoh16(	( static_cast<Uint16>( p_pData[ 0 ] ) ) |
+							( static_cast<Uint16>( p_pData[ 1 ] ) << 8 ) );
+		}
+
+		// Static functions for reading and writing variable length integers, 7 bits per byte.
+		static void AddVarUint( std::vector<Uint8> & p_Message, Uint32 p_Value )
+		{
+			while( p_Value >= 0x80 )
+			{
+				p_Message.push_back( static_cast<Uint8>( p_Value | 0x80 ) );
+				p_Value >>= 7;
+			}
+			p_Message.push_back( static_cast<Uint8>( p_Value ) );
+		}
+
+		static Bool ReadVarUint( const Uint8 * p_pData, const SizeType p_DataSize, SizeType & p_Position, Uint32 & p_Value )
+		{
+			p_Value = 0;
+			for( Uint32 shift = 0; shift < 32; shift += 7 )
+			{
+				if( p_Position >= p_DataSize )
+				{
+					return false;
+				}
+
+				const Uint8 byte = p_pData[ p_Position++ ];
+				p_Value |= static_cast<Uint32>( byte & 0x7F ) << shift;
+				if( ( byte & 0x80 ) == 0 )
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		// Entities already held by a client are kept until they are this much further away than the view radius,
+		// avoiding entities at the border of the view from being removed and recreated over and over.
+		static const Float32 g_ViewHysteresis = 1.1f;
+
 		EntityManager::EntityManager(	EntityChanger * p_pEntityChanger,
 										Server * p_pServer,
 										Client * p_pClient) :
 			m_pEntityChanger( p_pEntityChanger ),
 			m_pServer(p_pServer),
 			m_pClient(p_pClient),
-			m_CurrentId( 0 )
+			m_CurrentId( 0 ),
+			m_InterpolationMode( InterpolationMode::Linear ),
+			m_SnapshotId( 0 ),
+			m_ClassTableReceived( false )
 		{
 		}
 
@@ -50,9 +112,6 @@ namespace Bit
 			// Delete entities in the delete queue.
 			DeleteEntitiesInDeletionQueue();
 
-			// Delete changed entities.
-			ClearChangedEntities( );
-			
 
 			for( EntityMap::iterator it =  m_Entities.begin( ); it !=  m_Entities.end( ); it++ )
 			{
@@ -68,6 +127,7 @@ namespace Bit
 			}
 
 			m_EntityMetaDataMap.clear( );
+			m_EntityClasses.clear( );
 
 			// Destroy the enetity changer
 			delete m_pEntityChanger;
@@ -87,35 +147,31 @@ namespace Bit
 			m_ExtrapolationTime = p_Time;
 		}
 
+		void EntityManager::SetInterpolationMode(const InterpolationMode::eMode p_Mode)
+		{
+			m_InterpolationMode = p_Mode;
+		}
+
 		void EntityManager::TakeSnapshot(const Uint32 p_GroupId, const Bit::Time & p_Time)
 		{
 			m_Mutex.Lock();
 
-				
-			for (EntityMap::iterator it = m_Entities.begin(); it != m_Entities.end(); it++)
-			{
-				// Get the entity
-				const std::string & entityName = it->second->Class;
-				Entity * pEntity = it->second->pEntity;
+			const Time time = p_Time - m_InterpolationTime;
 
-				EntityMetaDataMap::iterator it2 = m_EntityMetaDataMap.find(entityName);
-				if (it2 == m_EntityMetaDataMap.end())
+			// Go through the variables of every entity class.
+			for (EntityMetaDataMap::iterator it = m_EntityMetaDataMap.begin(); it != m_EntityMetaDataMap.end(); it++)
+			{
+				EntityMetaData * pMetaData = it->second;
+				if (pMetaData->SlotEntities.size() == 0)
 				{
 					continue;
 				}
 
-
-				// go through the variables
-				EntityVariableMap * pEntityVariableMap = &it2->second->EntityVariables;
-				for (EntityVariableMap::iterator it3 = pEntityVariableMap->begin(); it3 != pEntityVariableMap->end(); it3++)
+				for (VariableMetaDataVector::iterator it2 = pMetaData->Variables.begin(); it2 != pMetaData->Variables.end(); it2++)
 				{
-					VariableBase Entity::* pVariableBase = it3->second;
-
-					// set the snapshot data
-					(pEntity->*pVariableBase).TakeSnapshot(p_Time - m_InterpolationTime, m_InterpolationTime,  m_ExtrapolationTime);
+					(this->*it2->pSnapshotFunction)(pMetaData, *it2, time);
 				}
 			}
-				
 
 			m_Mutex.Unlock();
 		}
@@ -350,7 +406,7 @@ namespace Bit
 							Entity * pNewEntity = CreateEntityAtId(entityName, entityId);
 							mutex.Lock();
 
-							if (pNewEntity == false)
+							if (pNewEntity == NULL)
 							{
 								bitLogNetErr( "Failed to create new entity \"" << entityName << "\" at id " << entityId);
 								return false;
@@ -851,89 +907,895 @@ namespace Bit
 			return true;
 		}
 
-		void EntityManager::ClearChangedEntities()
+		void EntityManager::CreateClassTableMessage( std::vector<Uint8> & p_Message )
 		{
-			// Create a smart mutex.
-			SmartMutex mutex(m_Mutex);
-			mutex.Lock();
-			
-			
+			// Add class count
+			AddVarUint(p_Message, static_cast<Uint32>(m_EntityClasses.size()));
 
-			// Go throguh the changed entities
-			for (ChangedEntitiesMap::iterator	ceIt = m_ChangedEntities.begin();
-												ceIt != m_ChangedEntities.end();)
+			// Go through the classes in the order of their ids.
+			for (EntityMetaDataVector::iterator it = m_EntityClasses.begin(); it != m_EntityClasses.end(); it++)
 			{
-				// Get the pointer to the changed variable map
-				ChangedVariablesMap * pChangedVariablesMap = ceIt->second;
+				EntityMetaData * pMetaData = *it;
 
-				// Flag for checking if we should remove this item from the changed entities.
-				Bool removedChangedEntity = true;
+				// Add class name
+				p_Message.push_back(static_cast<Uint8>(pMetaData->Name.size()));
+				p_Message.insert(p_Message.end(), pMetaData->Name.begin(), pMetaData->Name.end());
 
-				// Go throguh the changed variables
-				for (ChangedVariablesMap::iterator	cvIt = pChangedVariablesMap->begin();
-													cvIt != pChangedVariablesMap->end();)
+				// Add the variables in the order of their ids.
+				AddVarUint(p_Message, static_cast<Uint32>(pMetaData->Variables.size()));
+				for (VariableMetaDataVector::iterator it2 = pMetaData->Variables.begin(); it2 != pMetaData->Variables.end(); it2++)
 				{
-					// Flag for checking if we should remove this item from the changed entities.
-					Bool removedChangedVariableMap = true;
+					p_Message.push_back(static_cast<Uint8>(it2->Name.size()));
+					p_Message.insert(p_Message.end(), it2->Name.begin(), it2->Name.end());
+					AddVarUint(p_Message, static_cast<Uint32>(it2->Size));
+					it2->Encoding.Serialize(p_Message);
+				}
+			}
+		}
 
-					// Get the pointer to the changed entity variable map
-					ChangedEntityVariableMap * pChangedEntityVariableMap = cvIt->second;
+		Bool EntityManager::ParseClassTableMessage( const void * p_pMessage, const SizeType p_MessageSize )
+		{
+			// This is for clients only.
+			if (m_pClient == NULL || p_pMessage == NULL)
+			{
+				return false;
+			}
+
+			const Uint8 * pData = reinterpret_cast<const Uint8 *>(p_pMessage);
+			SizeType dataPos = 0;
+
+			// Read class count
+			Uint32 classCount = 0;
+			if (ReadVarUint(pData, p_MessageSize, dataPos, classCount) == false)
+			{
+				bitLogNetErr("Class table size error.");
+				return false;
+			}
 
-					// Go throguh the changed entity variables.
-					for (ChangedEntityVariableMap::iterator	cevIt = pChangedEntityVariableMap->begin();
-															cevIt != pChangedEntityVariableMap->end();)
+			ServerEntityClassVector serverClasses;
+			for (Uint32 i = 0; i < classCount; i++)
+			{
+				// Read the class name
+				if (dataPos + 1 > p_MessageSize || dataPos + 1 + pData[dataPos] > p_MessageSize)
+				{
+					bitLogNetErr("Class table size error.");
+					return false;
+				}
+
+				std::string className;
+				className.assign(reinterpret_cast<const char*>(pData + dataPos + 1), pData[dataPos]);
+				dataPos += 1 + pData[dataPos];
+
+				// Find the local class, unknown classes are ignored in the snapshots.
+				ServerEntityClass serverClass;
+				EntityMetaDataMap::iterator classIt = m_EntityMetaDataMap.find(className);
+				serverClass.pMetaData = classIt != m_EntityMetaDataMap.end() ? classIt->second : NULL;
+				if (serverClass.pMetaData == NULL)
+				{
+					bitLogNetErr("Unknown entity: \"" << className << "\"");
+				}
+
+				// Read variable count
+				Uint32 variableCount = 0;
+				if (ReadVarUint(pData, p_MessageSize, dataPos, variableCount) == false)
+				{
+					bitLogNetErr("Class table size error.");
+					return false;
+				}
+
+				for (Uint32 j = 0; j < variableCount; j++)
+				{
+					// Read the variable name
+					if (dataPos + 1 > p_MessageSize || dataPos + 1 + pData[dataPos] > p_MessageSize)
+					{
+						bitLogNetErr("Class table size error.");
+						return false;
+					}
+
+					std::string variableName;
+					variableName.assign(reinterpret_cast<const char*>(pData + dataPos + 1), pData[dataPos]);
+					dataPos += 1 + pData[dataPos];
+
+					// Read the data size
+					Uint32 dataSize = 0;
+					if (ReadVarUint(pData, p_MessageSize, dataPos, dataSize) == false)
 					{
-						// Check if we should keep the variable.
-						if (cevIt->second->IsNewValue() == false)
+						bitLogNetErr("Class table size error.");
+						return false;
+					}
+
+					// Read the encoding
+					VariableEncoding encoding;
+					if (encoding.Deserialize(pData, p_MessageSize, dataPos) == false || encoding.IsValid(dataSize) == false)
+					{
+						bitLogNetErr("Class table encoding error.");
+						return false;
+					}
+
+					// Find the local variable, ignore it if it's unknown or of another size.
+					VariableBase Entity::* pVariable = NULL;
+					if (serverClass.pMetaData)
+					{
+						EntityVariableMap::iterator variableIt = serverClass.pMetaData->EntityVariables.find(variableName);
+						if (variableIt == serverClass.pMetaData->EntityVariables.end())
 						{
-							// Remove the variable
-							cevIt = pChangedEntityVariableMap->erase(cevIt);
+							bitLogNetErr("Unknown entity variable(" << className << "): \"" << variableName << "\"");
 						}
 						else
 						{
-							// increment pointer
-							cevIt->second->SetIsNewValue(false);
-							removedChangedEntity = false;
-							removedChangedVariableMap = false;
-							++cevIt;
+							pVariable = variableIt->second;
+						}
+
+						for (VariableMetaDataVector::iterator it = serverClass.pMetaData->Variables.begin(); pVariable && it != serverClass.pMetaData->Variables.end(); it++)
+						{
+							if (it->pVariable == pVariable && it->Size != dataSize)
+							{
+								bitLogNetErr("Unknown size variable(" << className << ")(" << it->Size << "): \"" << dataSize << "\"");
+								pVariable = NULL;
+							}
+						}
+					}
+
+					serverClass.Variables.push_back(pVariable);
+					serverClass.Sizes.push_back(dataSize);
+					serverClass.Encodings.push_back(encoding);
+				}
+
+				serverClasses.push_back(serverClass);
+			}
+
+			// Create a smart mutex.
+			SmartMutex mutex(m_Mutex);
+			mutex.Lock();
+
+			// Use the new class table, the received snapshots are no longer valid baselines.
+			m_ServerClasses.swap(serverClasses);
+			m_SnapshotHistory.Clear();
+			m_ClassTableReceived = true;
+
+			// Unlock the mutex
+			mutex.Unlock();
+
+			// Succeeded
+			return true;
+		}
+
+		Uint16 EntityManager::CreateWorldSnapshot( )
+		{
+			// Delete entities in the delete queue.
+			DeleteEntitiesInDeletionQueue();
+
+			// Create a smart mutex.
+			SmartMutex mutex(m_Mutex);
+			mutex.Lock();
+
+			// Take the entities changed since the last world snapshot.
+			m_DirtyMutex.Lock();
+			m_DirtyEntities.swap(m_DirtyBuffer);
+			m_DirtyMutex.Unlock();
+
+			// Copy the changed variables to the state slots, and encode the states of the changed entities.
+			for (std::vector<Uint16>::iterator it = m_DirtyBuffer.begin(); it != m_DirtyBuffer.end(); it++)
+			{
+				EntityMap::iterator entityIt = m_Entities.find(*it);
+				if (entityIt == m_Entities.end())
+				{
+					continue;
+				}
+
+				EntityLink * pEntityLink = entityIt->second;
+				Entity * pEntity = pEntityLink->pEntity;
+				EntityMetaData * pMetaData = pEntityLink->pMetaData;
+
+				// Changes after this point add the entity to the dirty entities again.
+				const Uint64 dirtyMask = pEntity->m_DirtyMask.exchange(0);
+				if (dirtyMask == 0)
+				{
+					continue;
+				}
+
+				Uint8 * pSlot = pMetaData->States.data() + pEntityLink->Slot * pMetaData->StateSize;
+				for (SizeType i = 0; i < pMetaData->Variables.size(); i++)
+				{
+					if ((dirtyMask & (1ULL << (i < 63 ? i : 63))) == 0)
+					{
+						continue;
+					}
+
+					const VariableMetaData & variableMetaData = pMetaData->Variables[i];
+					VariableBase & variable = pEntity->*variableMetaData.pVariable;
+
+					variable.LoadData(pSlot + variableMetaData.Offset);
+				}
+
+				// Encode the variables to the state, in the order of the variable ids.
+				pEntityLink->State.clear();
+				BitWriter writer(pEntityLink->State);
+				for (VariableMetaDataVector::iterator it2 = pMetaData->Variables.begin(); it2 != pMetaData->Variables.end(); it2++)
+				{
+					it2->Encoding.Write(writer, pSlot + it2->Offset, it2->Size);
+				}
+			}
+			m_DirtyBuffer.clear();
+
+			EntitySnapshot * pSnapshot = new EntitySnapshot(m_SnapshotId++);
+			m_GlobalEntities.clear();
+
+			// Go through the entities
+			for (EntityMap::iterator it = m_Entities.begin(); it != m_Entities.end(); it++)
+			{
+				Entity * pEntity = it->second->pEntity;
+				EntityMetaData * pMetaData = it->second->pMetaData;
+
+				// Keep the interest grid up to date, entities are only rebucketed when crossing a cell border.
+				Vector3f32 position;
+				if (pEntity->GetPosition(position))
+				{
+					m_InterestGrid.Set(it->first, position);
+				}
+				else
+				{
+					m_InterestGrid.Remove(it->first);
+					m_GlobalEntities.push_back(it->first);
+				}
+
+				// Add the encoded state to the snapshot
+				const std::vector<Uint8> & state = it->second->State;
+				Uint8 * pState = pSnapshot->AddEntity(it->first, pMetaData->Id, state.size());
+				memcpy(pState, state.data(), state.size());
+			}
+
+			// Add the snapshot to the history, the oldest snapshot is deleted.
+			m_SnapshotHistory.Add(pSnapshot);
+
+			// Unlock the mutex
+			mutex.Unlock();
+
+			return pSnapshot->GetId();
+		}
+
+		Bool EntityManager::CreateSnapshotMessage(	const Int32 p_Baseline,
+													const EntityInterest::View & p_View,
+													EntityInterest & p_Interest,
+													std::vector<Uint8> & p_Message )
+		{
+			// This is for server only.
+			if (m_pServer == NULL)
+			{
+				return false;
+			}
+
+			// Create a smart mutex.
+			SmartMutex mutex(m_Mutex);
+			mutex.Lock();
+
+			// Get the latest snapshot
+			const EntitySnapshot * pSnapshot = m_SnapshotHistory.GetLatest();
+			if (pSnapshot == NULL)
+			{
+				return false;
+			}
+
+			// Find the baseline and the entity versions the client got with it,
+			// send the full state if it's too old.
+			const EntitySnapshot * pBaseline = NULL;
+			const EntityInterest::EntityVersionVector * pBaselineVersions = NULL;
+			if (p_Baseline >= 0)
+			{
+				pBaseline = m_SnapshotHistory.Get(static_cast<Uint16>(p_Baseline));
+				pBaselineVersions = p_Interest.Get(static_cast<Uint16>(p_Baseline));
+				if (pBaseline == NULL || pBaselineVersions == NULL)
+				{
+					pBaseline = NULL;
+					pBaselineVersions = NULL;
+				}
+			}
+
+			// The client already got the latest snapshot.
+			if (pBaseline == pSnapshot)
+			{
+				return false;
+			}
+
+			const Uint16 snapshotId = pSnapshot->GetId();
+			const Float32 radiusSquared = p_View.Radius * p_View.Radius;
+
+			// Find the entities relevant to the client.
+			m_Candidates.clear();
+			if (p_View.Enabled)
+			{
+				m_QueryBuffer.clear();
+				m_InterestGrid.Query(p_View.Position, p_View.Radius * g_ViewHysteresis, m_QueryBuffer);
+				m_QueryBuffer.insert(m_QueryBuffer.end(), m_GlobalEntities.begin(), m_GlobalEntities.end());
+
+				for (std::vector<Uint16>::iterator it = m_QueryBuffer.begin(); it != m_QueryBuffer.end(); it++)
+				{
+					SnapshotCandidate candidate;
+					candidate.EntityId = *it;
+					candidate.pState = pSnapshot->GetEntity(*it);
+					if (candidate.pState == NULL)
+					{
+						continue;
+					}
+					candidate.Version = pBaselineVersions ? EntityInterest::Find(*pBaselineVersions, *it) : -1;
+
+					// Entities without a position are always relevant, at the distance of the view center.
+					Float32 distanceSquared = 0.0f;
+					Vector3f32 position;
+					if (m_InterestGrid.GetPosition(*it, position))
+					{
+						const Vector3f32 diff = position - p_View.Position;
+						distanceSquared = diff.x * diff.x + diff.y * diff.y + diff.z * diff.z;
+
+						// New entities have to be within the view, not only within the hysteresis.
+						if (candidate.Version < 0 && distanceSquared > radiusSquared)
+						{
+							continue;
 						}
 					}
 
-					// Should we remove this item?
-					if (removedChangedVariableMap)
+					// Prioritize by the age of the client's state, divided by the distance.
+					const Float32 age = candidate.Version >= 0 ?
+						static_cast<Float32>(static_cast<Uint16>(snapshotId - static_cast<Uint16>(candidate.Version))) :
+						static_cast<Float32>(EntitySnapshotHistory::Capacity);
+					candidate.Priority = (age + 1.0f) / (1.0f + (radiusSquared > 0.0f ? distanceSquared / radiusSquared : 0.0f));
+
+					m_Candidates.push_back(candidate);
+				}
+			}
+			else
+			{
+				const EntitySnapshot::EntityStateMap & entities = pSnapshot->GetEntities();
+				for (EntitySnapshot::EntityStateMap::const_iterator it = entities.begin(); it != entities.end(); it++)
+				{
+					SnapshotCandidate candidate;
+					candidate.EntityId = it->first;
+					candidate.pState = &it->second;
+					candidate.Version = pBaselineVersions ? EntityInterest::Find(*pBaselineVersions, it->first) : -1;
+
+					const Float32 age = candidate.Version >= 0 ?
+						static_cast<Float32>(static_cast<Uint16>(snapshotId - static_cast<Uint16>(candidate.Version))) :
+						static_cast<Float32>(EntitySnapshotHistory::Capacity);
+					candidate.Priority = age + 1.0f;
+
+					m_Candidates.push_back(candidate);
+				}
+			}
+
+			// Sort the entities by priority.
+			std::sort(m_Candidates.begin(), m_Candidates.end(), [](const SnapshotCandidate & p_A, const SnapshotCandidate & p_B)
+			{
+				if (p_A.Priority != p_B.Priority)
+				{
+					return p_A.Priority > p_B.Priority;
+				}
+				return p_A.EntityId < p_B.EntityId;
+			});
+
+			// Add time
+			const Uint64 time = Hton64(m_pServer->GetServerTime().AsMicroseconds());
+
+			p_Message.push_back(static_cast<Uint8>(time));
+			p_Message.push_back(static_cast<Uint8>(time >> 8));
+			p_Message.push_back(static_cast<Uint8>(time >> 16));
+			p_Message.push_back(static_cast<Uint8>(time >> 24));
+			p_Message.push_back(static_cast<Uint8>(time >> 32));
+			p_Message.push_back(static_cast<Uint8>(time >> 40));
+			p_Message.push_back(static_cast<Uint8>(time >> 48));
+			p_Message.push_back(static_cast<Uint8>(time >> 56));
+
+			// Add snapshot id, baseline id and flags.
+			AddUint16(p_Message, snapshotId);
+			AddUint16(p_Message, pBaseline ? pBaseline->GetId() : 0);
+			p_Message.push_back(pBaseline ? EntitySnapshot::DeltaFlag : 0);
+
+			// Store the position for the entity count, we need to set it later
+			const SizeType entityCountPos = static_cast<SizeType>(p_Message.size());
+			AddUint16(p_Message, 0);
+			Uint16 entityCount = 0;
+
+			// Record the entity versions the client will hold after this snapshot.
+			EntityInterest::EntityVersionVector & versions = p_Interest.Add(snapshotId);
+			Bool full = false;
+
+			// Go through the relevant entities, in priority order.
+			for (SnapshotCandidateVector::iterator it = m_Candidates.begin(); it != m_Candidates.end(); it++)
+			{
+				const EntitySnapshot::EntityState & state = *it->pState;
+
+				EntityInterest::EntityVersion version;
+				version.EntityId = it->EntityId;
+				version.SnapshotId = snapshotId;
+
+				// Find the state the client got of the entity.
+				const EntitySnapshot * pVersion = NULL;
+				const EntitySnapshot::EntityState * pClientState = NULL;
+				if (it->Version >= 0)
+				{
+					pVersion = m_SnapshotHistory.Get(static_cast<Uint16>(it->Version));
+					pClientState = pVersion ? pVersion->GetEntity(it->EntityId) : NULL;
+
+					if (pClientState &&
+						(pClientState->ClassId != state.ClassId || pClientState->Size != state.Size))
+					{
+						pClientState = NULL;
+					}
+				}
+
+				// The snapshot is full, only unchanged entities are brought up to date.
+				if (full)
+				{
+					if (it->Version < 0)
+					{
+						continue;
+					}
+
+					if (pClientState == NULL ||
+						memcmp(pVersion->GetData(*pClientState), pSnapshot->GetData(state), state.Size) != 0)
+					{
+						version.SnapshotId = static_cast<Uint16>(it->Version);
+					}
+
+					versions.push_back(version);
+					continue;
+				}
+
+				// Store the position of the entity, we might remove it later.
+				const SizeType entityPos = static_cast<SizeType>(p_Message.size());
+				AddVarUint(p_Message, it->EntityId);
+
+				// Add the delta if the client got the entity.
+				if (pClientState)
+				{
+					p_Message.push_back(static_cast<Uint8>(EntitySnapshot::StateType::Delta));
+					const SizeType deltaSizePos = static_cast<SizeType>(p_Message.size());
+					AddUint16(p_Message, 0);
+
+					// Remove the entity from the message if it's unchanged.
+					if (EntitySnapshot::EncodeDelta(pVersion->GetData(*pClientState),
+													pSnapshot->GetData(state),
+													state.Size,
+													p_Message) == false)
+					{
+						p_Message.resize(entityPos);
+						versions.push_back(version);
+						continue;
+					}
+
+					// Set the delta size
+					SetUint16(p_Message, deltaSizePos, static_cast<Uint16>(p_Message.size() - deltaSizePos - 2));
+				}
+				// Add the full state of new entities, or if the client's state is too old.
+				else
+				{
+					p_Message.push_back(static_cast<Uint8>(EntitySnapshot::StateType::Full));
+					AddVarUint(p_Message, state.ClassId);
+					AddVarUint(p_Message, static_cast<Uint32>(state.Size));
+
+					const Uint8 * pState = pSnapshot->GetData(state);
+					p_Message.insert(p_Message.end(), pState, pState + state.Size);
+				}
+
+				// Defer the entity if the snapshot is full, the client keeps its old state.
+				if (p_Message.size() > MaxSnapshotSize && entityCount > 0)
+				{
+					p_Message.resize(entityPos);
+					full = true;
+
+					if (it->Version >= 0)
 					{
-						delete pChangedEntityVariableMap;
-						cvIt = pChangedVariablesMap->erase(cvIt);
+						version.SnapshotId = static_cast<Uint16>(it->Version);
+						versions.push_back(version);
 					}
-					else
+					continue;
+				}
+
+				versions.push_back(version);
+				entityCount++;
+			}
+
+			// Set the entity count
+			SetUint16(p_Message, entityCountPos, entityCount);
+
+			std::sort(versions.begin(), versions.end(), [](const EntityInterest::EntityVersion & p_A, const EntityInterest::EntityVersion & p_B)
+			{
+				return p_A.EntityId < p_B.EntityId;
+			});
+
+			// Add the entities the client got that are removed or no longer relevant.
+			const SizeType removedCountPos = static_cast<SizeType>(p_Message.size());
+			AddUint16(p_Message, 0);
+			Uint16 removedCount = 0;
+
+			if (pBaselineVersions)
+			{
+				EntityInterest::EntityVersionVector::const_iterator it2 = versions.begin();
+				for (EntityInterest::EntityVersionVector::const_iterator it = pBaselineVersions->begin(); it != pBaselineVersions->end(); it++)
+				{
+					while (it2 != versions.end() && it2->EntityId < it->EntityId)
 					{
-						++cvIt;
+						it2++;
 					}
 
+					if (it2 == versions.end() || it2->EntityId != it->EntityId)
+					{
+						AddVarUint(p_Message, it->EntityId);
+						removedCount++;
+					}
 				}
+			}
 
+			// Set the removed entity count
+			SetUint16(p_Message, removedCountPos, removedCount);
 
-				// Should we remove this item?
-				if (removedChangedEntity)
+			// Unlock the mutex
+			mutex.Unlock();
+
+			// Succeeded
+			return true;
+		}
+
+		void EntityManager::SetInterestCellSize( const Float32 p_CellSize )
+		{
+			// Create a smart mutex.
+			SmartMutex mutex(m_Mutex);
+			mutex.Lock();
+
+			m_InterestGrid.SetCellSize(p_CellSize);
+		}
+
+		Bool EntityManager::ParseSnapshotMessage(	const void * p_pMessage,
+													const SizeType p_MessageSize,
+													Uint16 & p_SnapshotId )
+		{
+			// Entity state in the message
+			struct StateRecord
+			{
+				Bool			Full;
+				Uint32			ClassId;
+				const Uint8 *	pData;
+				SizeType		DataSize;
+			};
+			typedef std::map<Uint16, StateRecord> StateRecordMap;
+
+			// Size of the time, snapshot id, baseline id, flags and entity count.
+			const SizeType headerSize = 15;
+
+			// This is for clients only.
+			if (m_pClient == NULL)
+			{
+				return false;
+			}
+
+			// Error check the parameters
+			if (p_pMessage == NULL || p_MessageSize < headerSize + 2)
+			{
+				return false;
+			}
+
+			// Delete the entities removed by earlier snapshots.
+			DeleteEntitiesInDeletionQueue();
+
+			// Calculate the minimum time for cleaning up old interpolation data.
+			Time serverTime = m_pClient->GetServerTime();
+			Time minimumTime = serverTime - m_InterpolationTime - m_ExtrapolationTime;
+
+			// Get the message pointer as an unsigned char pointer
+			const Uint8 * pData = reinterpret_cast<const Uint8 *>(p_pMessage);
+
+			// Read server time
+			Uint64 timeInt = 0;
+			memcpy(&timeInt, pData, sizeof(Uint64));
+			Time time = Microseconds(Ntoh64(timeInt));
+
+			// Read the snapshot header
+			const Uint16 snapshotId = ReadUint16(pData + 8);
+			const Uint16 baselineId = ReadUint16(pData + 10);
+			const Uint8 flags = pData[12];
+			const Uint16 entityCount = ReadUint16(pData + 13);
+			SizeType dataPos = headerSize;
+
+			// Create a smart mutex.
+			SmartMutex mutex(m_Mutex);
+			mutex.Lock();
+
+			// The class ids are unknown until we've got the class table.
+			if (m_ClassTableReceived == false)
+			{
+				return false;
+			}
+
+			// Ignore snapshots older than the latest one.
+			const EntitySnapshot * pLatest = m_SnapshotHistory.GetLatest();
+			if (pLatest && EntitySnapshot::IsNewer(snapshotId, pLatest->GetId()) == false)
+			{
+				return false;
+			}
+
+			// Find the baseline
+			const EntitySnapshot * pBaseline = NULL;
+			if (flags & EntitySnapshot::DeltaFlag)
+			{
+				pBaseline = m_SnapshotHistory.Get(baselineId);
+				if (pBaseline == NULL)
+				{
+					bitLogNetErr("Missing snapshot baseline: " << baselineId);
+					return false;
+				}
+			}
+
+			// Read the entity states
+			StateRecordMap records;
+			for (Uint16 i = 0; i < entityCount; i++)
+			{
+				// Read the entity id and state type.
+				Uint32 entityId = 0;
+				if (ReadVarUint(pData, p_MessageSize, dataPos, entityId) == false || dataPos + 1 > p_MessageSize)
 				{
-					delete pChangedVariablesMap;
-					ceIt = m_ChangedEntities.erase(ceIt);
+					bitLogNetErr("Snapshot size error.");
+					return false;
+				}
+
+				StateRecord record;
+				record.Full = pData[dataPos++] == EntitySnapshot::StateType::Full;
+				record.ClassId = 0;
+
+				if (record.Full)
+				{
+					// Read the class id and state size
+					Uint32 stateSize = 0;
+					if (ReadVarUint(pData, p_MessageSize, dataPos, record.ClassId) == false ||
+						ReadVarUint(pData, p_MessageSize, dataPos, stateSize) == false)
+					{
+						bitLogNetErr("Snapshot size error.");
+						return false;
+					}
+					record.DataSize = stateSize;
 				}
 				else
 				{
-					++ceIt;
+					// Read the delta size
+					if (dataPos + 2 > p_MessageSize)
+					{
+						bitLogNetErr("Snapshot size error.");
+						return false;
+					}
+					record.DataSize = ReadUint16(pData + dataPos);
+					dataPos += 2;
+				}
+
+				record.pData = pData + dataPos;
+				dataPos += record.DataSize;
+
+				if (dataPos > p_MessageSize)
+				{
+					bitLogNetErr("Snapshot size error.");
+					return false;
 				}
 
+				records[static_cast<Uint16>(entityId)] = record;
 			}
 
-			
+			// Read the removed entities
+			if (dataPos + 2 > p_MessageSize)
+			{
+				bitLogNetErr("Snapshot size error.");
+				return false;
+			}
+
+			const Uint16 removedCount = ReadUint16(pData + dataPos);
+			dataPos += 2;
+
+			std::set<Uint16> removedEntities;
+			for (Uint16 i = 0; i < removedCount; i++)
+			{
+				Uint32 entityId = 0;
+				if (ReadVarUint(pData, p_MessageSize, dataPos, entityId) == false)
+				{
+					bitLogNetErr("Snapshot size error.");
+					return false;
+				}
+				removedEntities.insert(static_cast<Uint16>(entityId));
+			}
+
+			// Create the new snapshot, starting with the unchanged entities of the baseline.
+			EntitySnapshot * pSnapshot = new EntitySnapshot(snapshotId);
+
+			if (pBaseline)
+			{
+				const EntitySnapshot::EntityStateMap & baselineEntities = pBaseline->GetEntities();
+				for (EntitySnapshot::EntityStateMap::const_iterator it = baselineEntities.begin(); it != baselineEntities.end(); it++)
+				{
+					if (removedEntities.find(it->first) != removedEntities.end() ||
+						records.find(it->first) != records.end())
+					{
+						continue;
+					}
+
+					Uint8 * pState = pSnapshot->AddEntity(it->first, it->second.ClassId, it->second.Size);
+					memcpy(pState, pBaseline->GetData(it->second), it->second.Size);
+				}
+			}
+
+			// Add the new and changed entities.
+			for (StateRecordMap::iterator it = records.begin(); it != records.end(); it++)
+			{
+				StateRecord & record = it->second;
+
+				if (record.Full)
+				{
+					// Ignore unknown classes.
+					if (record.ClassId >= m_ServerClasses.size() ||
+						m_ServerClasses[record.ClassId].pMetaData == NULL)
+					{
+						bitLogNetErr("Unknown entity class id: " << record.ClassId);
+						continue;
+					}
+
+					Uint8 * pState = pSnapshot->AddEntity(it->first, record.ClassId, record.DataSize);
+					memcpy(pState, record.pData, record.DataSize);
+				}
+				else
+				{
+					// Ignore deltas of entities we didn't know about in the baseline.
+					const EntitySnapshot::EntityState * pBaselineState = pBaseline ? pBaseline->GetEntity(it->first) : NULL;
+					if (pBaselineState == NULL)
+					{
+						bitLogNetErr("Delta of unknown entity: " << it->first);
+						continue;
+					}
+
+					Uint8 * pState = pSnapshot->AddEntity(it->first, pBaselineState->ClassId, pBaselineState->Size);
+					if (EntitySnapshot::DecodeDelta(pBaseline->GetData(*pBaselineState),
+													record.pData,
+													record.DataSize,
+													pState,
+													pBaselineState->Size) == false)
+					{
+						bitLogNetErr("Corrupt delta of entity: " << it->first);
+						delete pSnapshot;
+						return false;
+					}
+				}
+			}
+
+			// Add the snapshot to the history, it's a baseline for upcoming snapshots.
+			m_SnapshotHistory.Add(pSnapshot);
+
+			// Apply the new and changed entity states.
+			std::set<Entity *> newEntities;
+			for (StateRecordMap::iterator it = records.begin(); it != records.end(); it++)
+			{
+				const EntitySnapshot::EntityState * pState = pSnapshot->GetEntity(it->first);
+				if (pState == NULL)
+				{
+					continue;
+				}
+
+				const ServerEntityClass & serverClass = m_ServerClasses[pState->ClassId];
+
+				// Find the entity
+				EntityMap::iterator entityIt = m_Entities.find(it->first);
+				if (entityIt == m_Entities.end())
+				{
+					// Create a new entity. Remeber to unlock mutex before, since we use the same mutex in the CreateEntityAtId function.
+					mutex.Unlock();
+					Entity * pNewEntity = CreateEntityAtId(serverClass.pMetaData->Name, it->first);
+					mutex.Lock();
+
+					if (pNewEntity == NULL)
+					{
+						bitLogNetErr("Failed to create new entity \"" << serverClass.pMetaData->Name << "\" at id " << it->first);
+						continue;
+					}
+
+					// Find the entity again
+					entityIt = m_Entities.find(it->first);
+					if (entityIt == m_Entities.end())
+					{
+						bitLogNetErr("Failed to find new entity \"" << serverClass.pMetaData->Name << "\" at id " << it->first);
+						continue;
+					}
+
+					// Add the entity to the new entity set.
+					newEntities.insert(pNewEntity);
+				}
+
+				// Copy the state to the entity's variables.
+				ApplyEntityState(entityIt->second, serverClass, pSnapshot->GetData(*pState), pState->Size, time + m_pClient->GetPing(), minimumTime);
+			}
+
+			// Find the removed entities, they are destroyed or no longer within the view.
+			std::vector<Entity *> removedEntityPointers;
+			for (std::set<Uint16>::iterator it = removedEntities.begin(); it != removedEntities.end(); it++)
+			{
+				EntityMap::iterator entityIt = m_Entities.find(*it);
+				if (entityIt != m_Entities.end() &&
+					m_EntitiyDeletionQueue.find(entityIt->second->pEntity) == m_EntitiyDeletionQueue.end())
+				{
+					removedEntityPointers.push_back(entityIt->second->pEntity);
+				}
+			}
 
 			// Unlock mutex
 			mutex.Unlock();
+
+			// Call the on entity creation function
+			for (std::set<Entity *>::iterator it = newEntities.begin(); it != newEntities.end(); it++)
+			{
+				m_pClient->OnEntityCreation(*it);
+			}
+
+			// Destroy the removed entities.
+			for (std::vector<Entity *>::iterator it = removedEntityPointers.begin(); it != removedEntityPointers.end(); it++)
+			{
+				m_pClient->OnEntityDestroyed(*it);
+				DestroyEntity(*it, true);
+			}
+
+			// Succeeded
+			p_SnapshotId = snapshotId;
+			return true;
 		}
 
 		void EntityManager::OnVariableChange(Entity * p_pEntity, VariableBase * p_VariableBase)
 		{
+			const Uint16 id = p_VariableBase->m_Id;
+			MarkDirty(p_pEntity, id < 63 ? (1ULL << id) : (1ULL << 63));
+		}
+
+		void EntityManager::MarkDirty(Entity * p_pEntity, const Uint64 p_Mask)
+		{
+			// This is for server only, the client's changes are never sent.
+			if (m_pServer == NULL)
+			{
+				return;
+			}
+
+			// Only the first change since the last world snapshot adds the entity to the dirty entities.
+			if (p_pEntity->m_DirtyMask.fetch_or(p_Mask) != 0)
+			{
+				return;
+			}
+
+			m_DirtyMutex.Lock();
+			m_DirtyEntities.push_back(p_pEntity->GetId());
+			m_DirtyMutex.Unlock();
+		}
+
+		void EntityManager::AddVariable(EntityMetaData * p_pMetaData, VariableMetaData & p_Variable)
+		{
+			// Create a smart mutex.
+			SmartMutex mutex(m_Mutex);
+			mutex.Lock();
+
+			// Add the variable data at the end of the state slots.
+			const SizeType oldStateSize = p_pMetaData->StateSize;
+			p_Variable.Offset = oldStateSize;
+			p_pMetaData->StateSize += p_Variable.Size;
+			p_pMetaData->Variables.push_back(p_Variable);
+
+			// Grow the state slots of the already created entities, and mark the entities as changed.
+			if (p_pMetaData->SlotEntities.size())
+			{
+				std::vector<Uint8> states(p_pMetaData->SlotEntities.size() * p_pMetaData->StateSize, 0);
+				for (SizeType i = 0; i < p_pMetaData->SlotEntities.size(); i++)
+				{
+					memcpy(&states[i * p_pMetaData->StateSize], &p_pMetaData->States[i * oldStateSize], oldStateSize);
+				}
+				p_pMetaData->States.swap(states);
+
+				for (EntityLinkVector::iterator it = p_pMetaData->SlotEntities.begin(); it != p_pMetaData->SlotEntities.end(); it++)
+				{
+					EntityLink * pEntityLink = *it;
+					VariableBase & variable = pEntityLink->pEntity->*p_Variable.pVariable;
+					variable.m_Name = p_Variable.Name;
+					variable.m_pParent = pEntityLink->pEntity;
+					variable.m_Id = static_cast<Uint16>(p_pMetaData->Variables.size() - 1);
+
+					MarkDirty(pEntityLink->pEntity, ~0ULL);
+				}
+			}
 		}
 
 		Entity * EntityManager::CreateEntityAtId(const std::string & p_Key, const Bit::SizeType p_Id)
@@ -968,26 +1830,34 @@ namespace Bit
 
 			// Go through the variables and set the parent(entity)
 			EntityMetaData * pMetadata = it->second;
-			for(	EntityVariableMap::iterator it2 = pMetadata->EntityVariables.begin( );
-					it2 != pMetadata->EntityVariables.end( );
-					it2++ )
+			for (SizeType i = 0; i < pMetadata->Variables.size(); i++)
 			{
 				// Get the current variable pointer
-				VariableBase Entity::*pVariable = it2->second;
+				VariableBase Entity::*pVariable = pMetadata->Variables[i].pVariable;
 
 				// Set the parent of the variable to the entity.
-				(pEntity->*pVariable).m_Name = it2->first;
+				(pEntity->*pVariable).m_Name = pMetadata->Variables[i].Name;
 				(pEntity->*pVariable).m_pParent = pEntity;
+				(pEntity->*pVariable).m_Id = static_cast<Uint16>(i);
 			}
 
 			// Create entity link
 			EntityLink * pEntityLink = new EntityLink;
 			pEntityLink->Class = p_Key;
+			pEntityLink->pMetaData = pMetadata;
 			pEntityLink->pEntity = pEntity;
 
+			// Give the entity the next state slot.
+			pEntityLink->Slot = pMetadata->SlotEntities.size();
+			pMetadata->SlotEntities.push_back(pEntityLink);
+			pMetadata->States.resize(pMetadata->SlotEntities.size() * pMetadata->StateSize, 0);
+
 			// Add the entity to the map
 			m_Entities[p_Id] = pEntityLink;
 
+			// All the variables of the new entity are changed.
+			MarkDirty(pEntity, ~0ULL);
+
 			// Unlock the mutex
 			mutex.Unlock();
 
@@ -1009,37 +1879,6 @@ namespace Bit
 
 				bitLogNetErr(  "Clearing in delete queue: " <<  pEntity->GetId( ) );
 
-				// Remvoe the entity from the changed entity map.
-				// This is not the most efficient way of doing it, but we really have to do this.
-				// Go through the changed entities, and delete them.
-				ChangedEntitiesMap::iterator ceIt = m_ChangedEntities.find(pEntity->GetName());
-				if (ceIt != m_ChangedEntities.end())
-				{
-					for (ChangedVariablesMap::iterator	cvIt = ceIt->second->begin();
-						cvIt != ceIt->second->end();
-						cvIt++)
-					{
-						for (ChangedEntityVariableMap::iterator	cevIt = cvIt->second->begin();
-							cevIt != cvIt->second->end();)
-						{
-							if (cevIt->first == pEntity)
-							{
-								cevIt = cvIt->second->erase(cevIt);
-
-								// break this loop, since we've found the changed variable for this entity.
-								break;
-							}
-							else
-							{
-								++cevIt;
-							}
-						}
-					}
-
-				}	// End of if-statement.
-
-
-
 				// Delete the actual entity.
 
 				// Get the entity link
@@ -1067,6 +1906,21 @@ namespace Bit
 					(pEntity->*pVariable).m_pParent = NULL;
 				}
 
+				// Move the state slot of the last entity of the class into the freed slot.
+				EntityMetaData * pSlotMetaData = linkIt->second->pMetaData;
+				const SizeType slot = linkIt->second->Slot;
+				const SizeType lastSlot = pSlotMetaData->SlotEntities.size() - 1;
+				if (slot != lastSlot)
+				{
+					memcpy(	&pSlotMetaData->States[slot * pSlotMetaData->StateSize],
+							&pSlotMetaData->States[lastSlot * pSlotMetaData->StateSize],
+							pSlotMetaData->StateSize);
+					pSlotMetaData->SlotEntities[slot] = pSlotMetaData->SlotEntities[lastSlot];
+					pSlotMetaData->SlotEntities[slot]->Slot = slot;
+				}
+				pSlotMetaData->SlotEntities.pop_back();
+				pSlotMetaData->States.resize(pSlotMetaData->SlotEntities.size() * pSlotMetaData->StateSize);
+
 				// Delete and remove the link
 				delete linkIt->second;
 				m_Entities.erase(linkIt);
@@ -1074,6 +1928,9 @@ namespace Bit
 				// Get entity id
 				Uint16 entityId = pEntity->GetId();
 
+				// Remove the entity from the interest grid.
+				m_InterestGrid.Remove(entityId);
+
 
 				// Delete the pointer
 				//if (p_Unallocate)
@@ -1090,6 +1947,9 @@ namespace Bit
 					Uint16 entityIdNetwork = Hton16(entityId);
 					memcpy(destroyedData, &entityIdNetwork, destroyedDataSize);
 
+					// Share the payload between all the connections.
+					PacketBuffer * pPayload = PacketBuffer::Create(destroyedData, destroyedDataSize);
+
 					// Go through the connections
 					m_pServer->m_ConnectionMutex.Lock();
 					{
@@ -1097,11 +1957,13 @@ namespace Bit
 							it != m_pServer->m_UserConnections.end();
 							it++)
 						{
-							it->second->SendReliable(PacketType::EntityDestroyed, destroyedData, destroyedDataSize, true);
+							it->second->SendReliable(PacketType::EntityDestroyed, pPayload, true);
 						}
 					}
 					m_pServer->m_ConnectionMutex.Unlock();
 
+					pPayload->Release();
+
 				}
 
 			} // End of loop.
@@ -1113,6 +1975,42 @@ namespace Bit
 			mutex.Unlock();
 
 		}
+
+		Bool EntityManager::ApplyEntityState(	EntityLink * p_pEntityLink,
+												const ServerEntityClass & p_Class,
+												const Uint8 * p_pState,
+												const SizeType p_StateSize,
+												const Time & p_Time,
+												const Time & p_MinimumTime )
+		{
+			// Make sure that the entity is of the same class as the state.
+			if (p_pEntityLink->pMetaData != p_Class.pMetaData)
+			{
+				bitLogNetErr("Entity state class error: " << p_pEntityLink->Class);
+				return false;
+			}
+
+			Entity * pEntity = p_pEntityLink->pEntity;
+			BitReader reader(p_pState, p_StateSize);
+
+			// Decode and set the variables, in the order of the server's variable ids.
+			for (SizeType i = 0; i < p_Class.Variables.size(); i++)
+			{
+				m_StateBuffer.resize(p_Class.Sizes[i]);
+				if (p_Class.Encodings[i].Read(reader, m_StateBuffer.data(), p_Class.Sizes[i]) == false)
+				{
+					bitLogNetErr("Entity state size error(" << p_pEntityLink->Class << "): " << p_StateSize);
+					return false;
+				}
+
+				if (p_Class.Variables[i])
+				{
+					(pEntity->*p_Class.Variables[i]).SetData(m_StateBuffer.data(), p_Time, p_MinimumTime);
+				}
+			}
+
+			return true;
+		}
 	}
 
 }
\ No newline at end of file
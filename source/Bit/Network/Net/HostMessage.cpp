@@ -39,23 +39,11 @@ namespace Bit
 			m_Name( p_Name ),
 			m_pServer( p_pServer )
 		{
+			// The header is added at send, the clients may know the message by different ids.
 			if( p_MessageSize > 0 )
 			{
-				m_Message.reserve( static_cast<MessageVector::size_type>( p_MessageSize ) +
-								   static_cast<MessageVector::size_type>( p_Name.size( ) ) + 2 );
+				m_Message.reserve( static_cast<MessageVector::size_type>( p_MessageSize ) );
 			}
-			else
-			{
-				m_Message.reserve( static_cast<MessageVector::size_type>( p_Name.size( ) ) + 2  );
-			}
-
-			// Add the message type and message name
-			m_Message.push_back( static_cast<Uint8>( eMessageType::UserMessageType ) );
-			for( std::string::size_type i = 0; i < p_Name.size( ); i++ )
-			{
-				m_Message.push_back( static_cast<Uint8>( p_Name[ i ] ) );
-			}
-			m_Message.push_back( 0 );
 		}
 
 		void HostMessage::WriteByte( const Uint8 p_Byte )
@@ -109,6 +97,14 @@ namespace Bit
 				return false;
 			}
 
+			// Encode the payload once per message header, shared by the connections with the same message id and channel sequence.
+			// The clients hooking the messages in the same order share a single payload.
+			// The payload is compressed as a whole, large messages are fragmented after the compression.
+			std::vector<Uint64> payloadHeaders;
+			std::vector<PacketBuffer *> payloads;
+			std::vector<PacketType::eType> payloadTypes;
+			MessageVector message;
+
 			// Go throguh the connections from the server and send the data
 			m_pServer->m_ConnectionMutex.Lock( );
 
@@ -120,7 +116,7 @@ namespace Bit
 				if( it2 == m_pServer->m_UserConnections.end( ) )
 				{
 					// Remove the user from the set if it doesn't exist.
-					p_pFilter->m_Users.erase( it1 );
+					it1 = p_pFilter->m_Users.erase( it1 );
 
 					// Continue to the next user
 					continue;
@@ -134,19 +130,74 @@ namespace Bit
 				// Get the connection
 				Connection * pConnection = it2->second;
 
+				// Get the id the client gave the message, or send it by name.
+				pConnection->m_HostMessageIds.Mutex.Lock( );
+				const Uint16 id = pConnection->m_HostMessageIds.Value.Find( m_Name );
+				pConnection->m_HostMessageIds.Mutex.Unlock( );
+
+				// Get the channel and its sequence, or send it by the reliable flag.
+				Uint8 channel = 0;
+				Uint16 sequence = 0;
+				Bool reliable = p_pFilter->IsReliable( );
+				if( p_pFilter->GetChannel( ) >= 0 )
+				{
+					pConnection->m_Channels.Mutex.Lock( );
+					reliable = pConnection->m_Channels.Value.GetNextMessage( static_cast<Uint8>( p_pFilter->GetChannel( ) ), channel, sequence );
+					pConnection->m_Channels.Mutex.Unlock( );
+				}
+				else
+				{
+					channel = static_cast<Uint8>( ( reliable ? DeliveryType::ReliableUnordered : DeliveryType::Unreliable ) << ChannelDeliveryShift );
+				}
+
+				// Find or encode the payload of the message header and compression.
+				const Uint64 header =	( static_cast<Uint64>( pConnection->GetCompression( ) ) << 48 ) |
+										( static_cast<Uint64>( id ) << 32 ) |
+										( static_cast<Uint64>( channel ) << 16 ) |
+										static_cast<Uint64>( sequence );
+				SizeType payloadIndex = 0;
+				while( payloadIndex < payloadHeaders.size( ) && payloadHeaders[ payloadIndex ] != header )
+				{
+					payloadIndex++;
+				}
+
+				if( payloadIndex == payloadHeaders.size( ) )
+				{
+					message.clear( );
+					message.reserve( m_Message.size( ) + m_Name.size( ) + MessageHeaderSize + 1 );
+					MessageTable::WriteHeader( message, id, m_Name );
+					MessageChannels::WriteChannel( message.data( ), channel, sequence );
+					message.insert( message.end( ), m_Message.begin( ), m_Message.end( ) );
+
+					const Bool compressed = pConnection->CompressMessage( message, 0 );
+
+					payloadHeaders.push_back( header );
+					payloads.push_back( PacketBuffer::Create( message.data( ), message.size( ) ) );
+					payloadTypes.push_back( static_cast<PacketType::eType>( PacketType::HostMessage | ( compressed ? CompressedPacketFlag : 0 ) ) );
+				}
+
+				PacketBuffer * pPayload = payloads[ payloadIndex ];
+				const PacketType::eType type = payloadTypes[ payloadIndex ];
+
 				// Send the message
-				if( p_pFilter->IsReliable( ) )
+				if( reliable )
 				{
-					pConnection->SendReliable(PacketType::HostMessage, reinterpret_cast<void*>(m_Message.data()), m_Message.size(), true );
+					pConnection->SendReliable( type, pPayload, true );
 				}
 				else
 				{
-					pConnection->SendUnreliable(PacketType::HostMessage, reinterpret_cast<void*>(m_Message.data()), m_Message.size(), true, true);
+					pConnection->SendUnreliable( type, const_cast<Uint8 *>( pPayload->GetData( ) ), pPayload->GetDataSize( ), true, true);
 				}
 			}
 
 			m_pServer->m_ConnectionMutex.Unlock( );
 
+			// Release our references, the reliable packets keep the payloads alive.
+			for( SizeType i = 0; i < payloads.size( ); i++ )
+			{
+				payloads[ i ]->Release( );
+			}
+
 			return true;
 		}
 
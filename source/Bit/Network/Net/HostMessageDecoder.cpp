@@ -23,6 +23,7 @@
 
 #include <Bit/Network/Net/HostMessageDecoder.hpp>
 #include <Bit/Network/Socket.hpp>
+#include <cstring>
 #include <Bit/System/MemoryLeak.hpp>
 
 namespace Bit
@@ -32,7 +33,7 @@ namespace Bit
 	{
 
 		HostMessageDecoder::HostMessageDecoder( const std::string & p_Name,
-												Uint8 *		p_pMessage,
+												const Uint8 *	p_pMessage,
 												SizeType	p_MessageSize ) :
 			m_Name( p_Name ),
 			m_Position( 0 ),
@@ -111,7 +112,7 @@ namespace Bit
 			const SizeType length = stringEnd - m_Position;
 
 			// Copy the string.
-			p_String.assign( reinterpret_cast<char*>(m_pMessage + m_Position), length );
+			p_String.assign( reinterpret_cast<const char*>(m_pMessage + m_Position), length );
 
 			// Increment the position by the length + 1
 			m_Position += length + 1;
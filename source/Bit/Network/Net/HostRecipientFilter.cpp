@@ -33,7 +33,8 @@ namespace Bit
 
 		HostRecipientFilter::HostRecipientFilter( Server * p_pServer, const Bool p_Reliable ) :
 			m_pServer( p_pServer ),
-			m_Reliable( p_Reliable )
+			m_Reliable( p_Reliable ),
+			m_Channel( -1 )
 		{
 		}
 
@@ -68,11 +69,13 @@ namespace Bit
 		void HostRecipientFilter::MakeReliable( )
 		{
 			m_Reliable = true;
+			m_Channel = -1;
 		}
 
 		void HostRecipientFilter::MakeUnreliable( )
 		{
 			m_Reliable = false;
+			m_Channel = -1;
 		}
 
 		Bool HostRecipientFilter::IsReliable( ) const
@@ -80,6 +83,16 @@ namespace Bit
 			return m_Reliable;
 		}
 
+		void HostRecipientFilter::SetChannel( const Uint8 p_Channel )
+		{
+			m_Channel = static_cast<Int32>( p_Channel & ChannelIndexMask );
+		}
+
+		Int32 HostRecipientFilter::GetChannel( ) const
+		{
+			return m_Channel;
+		}
+
 	}
 
 }
\ No newline at end of file
@@ -0,0 +1,221 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/NetworkSimulator.hpp>
+#include <Bit/System/Log.hpp>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		// Global variables
+		static const SizeType g_MaxPacketSize = 65536;	///< Size of the receive buffer.
+
+		// Settings class
+		NetworkSimulator::Settings::Settings(	const Time & p_Delay,
+												const Time & p_Jitter,
+												const Float32 p_Loss ) :
+			Delay( p_Delay ),
+			Jitter( p_Jitter ),
+			Loss( p_Loss )
+		{
+		}
+
+		// Network simulator class
+		NetworkSimulator::NetworkSimulator( ) :
+			m_Running( false ),
+			m_ServerPort( 0 ),
+			m_ClientPort( 0 ),
+			m_ForwardedCount( 0 ),
+			m_LostCount( 0 )
+		{
+		}
+
+		NetworkSimulator::~NetworkSimulator( )
+		{
+			Stop( );
+		}
+
+		Bool NetworkSimulator::Start(	const Uint16 p_Port,
+										const Address & p_ServerAddress,
+										const Uint16 p_ServerPort,
+										const Settings & p_Settings,
+										const Uint32 p_Seed )
+		{
+			// Stop the simulator if it's already running.
+			Stop( );
+
+			if( m_Socket.Open( p_Port ) == false )
+			{
+				bitLogNetErr( "Failed to open the simulator socket." );
+				return false;
+			}
+
+			m_ServerAddress = p_ServerAddress;
+			m_ServerPort = p_ServerPort;
+			m_ClientAddress = Address( );
+			m_ClientPort = 0;
+			m_Randomizer = Randomizer( p_Seed );
+			m_Settings.Set( p_Settings );
+			m_ForwardedCount.Set( 0 );
+			m_LostCount.Set( 0 );
+			m_Timer.Start( );
+			m_Running.Set( true );
+
+			m_Thread.Execute( [ this ] ( )
+			{
+				std::vector<Uint8> buffer( g_MaxPacketSize );
+				Address address;
+				Uint16 port = 0;
+
+				while( m_Running.Get( ) )
+				{
+					// Send the packets that are due.
+					SendPackets( );
+
+					// Wait for the next packet, but not past the next delivery time.
+					Time timeout = Milliseconds( 10 );
+					if( m_DelayedPackets.size( ) )
+					{
+						const Uint64 time = m_Timer.GetLapsedTime( ).AsMicroseconds( );
+						const Uint64 deliveryTime = m_DelayedPackets.begin( )->first;
+						timeout = Microseconds( deliveryTime > time ? deliveryTime - time : 0 );
+					}
+
+					const Int32 size = m_Socket.Receive( buffer.data( ), buffer.size( ), address, port, timeout );
+					if( size <= 0 )
+					{
+						continue;
+					}
+
+					// Packets from the server are forwarded to the client, all other packets to the server.
+					if( address == m_ServerAddress && port == m_ServerPort )
+					{
+						if( m_ClientPort )
+						{
+							AddPacket( buffer.data( ), static_cast<SizeType>( size ), false );
+						}
+					}
+					else
+					{
+						m_ClientAddress = address;
+						m_ClientPort = port;
+						AddPacket( buffer.data( ), static_cast<SizeType>( size ), true );
+					}
+				}
+			}
+			);
+
+			return true;
+		}
+
+		void NetworkSimulator::Stop( )
+		{
+			if( m_Running.Get( ) == false )
+			{
+				return;
+			}
+
+			m_Running.Set( false );
+			m_Thread.Finish( );
+			m_Socket.Close( );
+			m_DelayedPackets.clear( );
+		}
+
+		void NetworkSimulator::SetSettings( const Settings & p_Settings )
+		{
+			m_Settings.Set( p_Settings );
+		}
+
+		Uint64 NetworkSimulator::GetForwardedCount( )
+		{
+			return m_ForwardedCount.Get( );
+		}
+
+		Uint64 NetworkSimulator::GetLostCount( )
+		{
+			return m_LostCount.Get( );
+		}
+
+		void NetworkSimulator::AddPacket( const Uint8 * p_pData, const SizeType p_DataSize, const Bool p_ToServer )
+		{
+			m_Settings.Mutex.Lock( );
+			const Settings settings = m_Settings.Value;
+			m_Settings.Mutex.Unlock( );
+
+			// Lose the packet.
+			const Float32 lossRoll = static_cast<Float32>( m_Randomizer.Randomize( 9999 ) ) / 10000.0f;
+			if( lossRoll < settings.Loss )
+			{
+				m_LostCount.Mutex.Lock( );
+				m_LostCount.Value++;
+				m_LostCount.Mutex.Unlock( );
+				return;
+			}
+
+			// Calculate the delivery time, the jitter is evenly distributed around the delay.
+			const Float64 jitterRoll = static_cast<Float64>( m_Randomizer.Randomize( 10000 ) ) / 5000.0 - 1.0;
+			Int64 delay =	static_cast<Int64>( settings.Delay.AsMicroseconds( ) ) +
+							static_cast<Int64>( jitterRoll * static_cast<Float64>( settings.Jitter.AsMicroseconds( ) ) );
+			if( delay < 0 )
+			{
+				delay = 0;
+			}
+			const Uint64 deliveryTime = m_Timer.GetLapsedTime( ).AsMicroseconds( ) + static_cast<Uint64>( delay );
+
+			DelayedPacketMap::iterator it = m_DelayedPackets.insert( DelayedPacketMap::value_type( deliveryTime, DelayedPacket( ) ) );
+			it->second.ToServer = p_ToServer;
+			it->second.Data.assign( p_pData, p_pData + p_DataSize );
+		}
+
+		void NetworkSimulator::SendPackets( )
+		{
+			const Uint64 time = m_Timer.GetLapsedTime( ).AsMicroseconds( );
+
+			while( m_DelayedPackets.size( ) && m_DelayedPackets.begin( )->first <= time )
+			{
+				const DelayedPacket & packet = m_DelayedPackets.begin( )->second;
+
+				if( packet.ToServer )
+				{
+					m_Socket.Send( packet.Data.data( ), packet.Data.size( ), m_ServerAddress, m_ServerPort );
+				}
+				else
+				{
+					m_Socket.Send( packet.Data.data( ), packet.Data.size( ), m_ClientAddress, m_ClientPort );
+				}
+
+				m_ForwardedCount.Mutex.Lock( );
+				m_ForwardedCount.Value++;
+				m_ForwardedCount.Mutex.Unlock( );
+
+				m_DelayedPackets.erase( m_DelayedPackets.begin( ) );
+			}
+		}
+
+	}
+
+}
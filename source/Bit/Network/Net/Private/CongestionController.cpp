@@ -0,0 +1,200 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Private/CongestionController.hpp>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		// Global variables
+		static const Uint64 g_SampleInterval = 100000ULL;	///< Microseconds per sample interval of the rates.
+		static const Float64 g_BurstTime = 0.02;			///< Seconds of send rate that the token bucket holds.
+		static const Float64 g_MinBurst = 2400.0;			///< Least number of bytes that the token bucket holds.
+		static const Float64 g_LossWeight = 1.0 / 16.0;		///< Weight of every packet in the smoothed loss.
+
+		// Congestion controller class
+		CongestionController::CongestionController( )
+		{
+			Reset( false, 0 );
+		}
+
+		void CongestionController::Reset( const Bool p_CongestionControl, const Uint32 p_MaxSendRate )
+		{
+			m_Timer.Start( );
+			m_Adaptive = p_CongestionControl;
+			m_MaxSendRate = static_cast<Float64>( p_MaxSendRate );
+
+			// Start the congestion control slow, and let it increase the rate.
+			if( m_Adaptive )
+			{
+				if( m_MaxSendRate == 0.0 )
+				{
+					m_MaxSendRate = static_cast<Float64>( MaxAdaptiveSendRate );
+				}
+				m_SendRate = m_MaxSendRate < InitialSendRate ? m_MaxSendRate : static_cast<Float64>( InitialSendRate );
+			}
+			else
+			{
+				m_SendRate = m_MaxSendRate;
+			}
+
+			m_Tokens = GetBurst( );
+			m_LastUpdate = 0;
+			m_SampleStart = 0;
+			m_AckedBytes = 0;
+			m_SampleLoss = false;
+			m_SampleLimited = false;
+			m_DeliveryRate = 0.0;
+			m_Loss = 0.0;
+			m_PacketsSent = 0;
+			m_PacketsLost = 0;
+		}
+
+		Bool CongestionController::Consume( const SizeType p_Size, const Bool p_Force )
+		{
+			Update( );
+
+			// Hold the packet back if it doesn't fit the budget.
+			if( m_SendRate > 0.0 && p_Force == false && m_Tokens < static_cast<Float64>( p_Size ) )
+			{
+				m_SampleLimited = true;
+				return false;
+			}
+
+			if( m_SendRate > 0.0 )
+			{
+				m_Tokens -= static_cast<Float64>( p_Size );
+			}
+			m_PacketsSent++;
+
+			return true;
+		}
+
+		void CongestionController::OnAcknowledgement( const SizeType p_Size )
+		{
+			Update( );
+
+			m_AckedBytes += static_cast<Uint64>( p_Size );
+			m_Loss -= m_Loss * g_LossWeight;
+		}
+
+		void CongestionController::OnLoss( )
+		{
+			Update( );
+
+			m_SampleLoss = true;
+			m_Loss += ( 1.0 - m_Loss ) * g_LossWeight;
+			m_PacketsLost++;
+		}
+
+		Uint32 CongestionController::GetSendRate( ) const
+		{
+			return static_cast<Uint32>( m_SendRate );
+		}
+
+		Uint32 CongestionController::GetDeliveryRate( ) const
+		{
+			return static_cast<Uint32>( m_DeliveryRate );
+		}
+
+		Float32 CongestionController::GetLoss( ) const
+		{
+			return static_cast<Float32>( m_Loss );
+		}
+
+		Uint64 CongestionController::GetPacketsSent( ) const
+		{
+			return m_PacketsSent;
+		}
+
+		Uint64 CongestionController::GetPacketsLost( ) const
+		{
+			return m_PacketsLost;
+		}
+
+		void CongestionController::Update( )
+		{
+			const Uint64 time = m_Timer.GetLapsedTime( ).AsMicroseconds( );
+
+			// Refill the token bucket.
+			if( m_SendRate > 0.0 )
+			{
+				const Float64 burst = GetBurst( );
+				m_Tokens += m_SendRate * static_cast<Float64>( time - m_LastUpdate ) / 1000000.0;
+				if( m_Tokens > burst )
+				{
+					m_Tokens = burst;
+				}
+			}
+			m_LastUpdate = time;
+
+			// Wait for the end of the sample interval.
+			const Uint64 sampleTime = time - m_SampleStart;
+			if( sampleTime < g_SampleInterval )
+			{
+				return;
+			}
+
+			// Estimate the delivery rate from the acknowledged bytes.
+			const Float64 deliveryRate = static_cast<Float64>( m_AckedBytes ) * 1000000.0 / static_cast<Float64>( sampleTime );
+			m_DeliveryRate = m_DeliveryRate == 0.0 ? deliveryRate : ( m_DeliveryRate * 3.0 + deliveryRate ) / 4.0;
+
+			// Adapt the send rate.
+			if( m_Adaptive )
+			{
+				if( m_SampleLoss )
+				{
+					// Back off, but not below what the connection evidently delivers.
+					Float64 sendRate = m_SendRate * 0.7;
+					if( sendRate < m_DeliveryRate * 0.9 && m_DeliveryRate * 0.9 < m_SendRate )
+					{
+						sendRate = m_DeliveryRate * 0.9;
+					}
+					m_SendRate = sendRate > MinSendRate ? sendRate : static_cast<Float64>( MinSendRate );
+				}
+				else if( m_SampleLimited )
+				{
+					// Probe for more bandwidth while the limiter holds packets back.
+					const Float64 sendRate = m_SendRate + m_SendRate / 8.0;
+					m_SendRate = sendRate < m_MaxSendRate ? sendRate : m_MaxSendRate;
+				}
+			}
+
+			m_SampleStart = time;
+			m_AckedBytes = 0;
+			m_SampleLoss = false;
+			m_SampleLimited = false;
+		}
+
+		Float64 CongestionController::GetBurst( ) const
+		{
+			return m_SendRate * g_BurstTime > g_MinBurst ? m_SendRate * g_BurstTime : g_MinBurst;
+		}
+
+	}
+
+}
@@ -0,0 +1,118 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Private/ConnectCookie.hpp>
+#include <random>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		// Length of the time windows of the cookies, in microseconds.
+		static const Uint64 g_CookieWindow = 5000000ULL;
+
+		// SipHash round.
+		static inline void SipRound( Uint64 & p_V0, Uint64 & p_V1, Uint64 & p_V2, Uint64 & p_V3 )
+		{
+			p_V0 += p_V1; p_V1 = ( p_V1 << 13 ) | ( p_V1 >> 51 ); p_V1 ^= p_V0; p_V0 = ( p_V0 << 32 ) | ( p_V0 >> 32 );
+			p_V2 += p_V3; p_V3 = ( p_V3 << 16 ) | ( p_V3 >> 48 ); p_V3 ^= p_V2;
+			p_V0 += p_V3; p_V3 = ( p_V3 << 21 ) | ( p_V3 >> 43 ); p_V3 ^= p_V0;
+			p_V2 += p_V1; p_V1 = ( p_V1 << 17 ) | ( p_V1 >> 47 ); p_V1 ^= p_V2; p_V2 = ( p_V2 << 32 ) | ( p_V2 >> 32 );
+		}
+
+		ConnectCookie::ConnectCookie( )
+		{
+			GenerateSecret( );
+		}
+
+		void ConnectCookie::GenerateSecret( )
+		{
+			std::random_device device;
+			for( SizeType i = 0; i < 2; i++ )
+			{
+				m_Secret[ i ] = ( static_cast<Uint64>( device( ) ) << 32 ) | static_cast<Uint64>( device( ) );
+			}
+		}
+
+		Uint64 ConnectCookie::Create( const Uint32 p_Address, const Uint16 p_Port, const Time & p_Time ) const
+		{
+			return Create( p_Address, p_Port, p_Time.AsMicroseconds( ) / g_CookieWindow );
+		}
+
+		Bool ConnectCookie::Verify( const Uint64 p_Cookie, const Uint32 p_Address, const Uint16 p_Port, const Time & p_Time ) const
+		{
+			const Uint64 window = p_Time.AsMicroseconds( ) / g_CookieWindow;
+
+			if( Create( p_Address, p_Port, window ) == p_Cookie )
+			{
+				return true;
+			}
+
+			return window > 0 && Create( p_Address, p_Port, window - 1 ) == p_Cookie;
+		}
+
+		Uint64 ConnectCookie::Create( const Uint32 p_Address, const Uint16 p_Port, const Uint64 p_Window ) const
+		{
+			// SipHash-2-4 of two 64 bit words, the address and port followed by the time window.
+			Uint64 v0 = m_Secret[ 0 ] ^ 0x736F6D6570736575ULL;
+			Uint64 v1 = m_Secret[ 1 ] ^ 0x646F72616E646F6DULL;
+			Uint64 v2 = m_Secret[ 0 ] ^ 0x6C7967656E657261ULL;
+			Uint64 v3 = m_Secret[ 1 ] ^ 0x7465646279746573ULL;
+
+			const Uint64 words[ 2 ] =
+			{
+				( static_cast<Uint64>( p_Address ) << 16 ) | static_cast<Uint64>( p_Port ),
+				p_Window
+			};
+
+			for( SizeType i = 0; i < 2; i++ )
+			{
+				v3 ^= words[ i ];
+				SipRound( v0, v1, v2, v3 );
+				SipRound( v0, v1, v2, v3 );
+				v0 ^= words[ i ];
+			}
+
+			// Final block, holding the message length of 16 bytes.
+			const Uint64 last = static_cast<Uint64>( 16 ) << 56;
+			v3 ^= last;
+			SipRound( v0, v1, v2, v3 );
+			SipRound( v0, v1, v2, v3 );
+			v0 ^= last;
+
+			// Finalization.
+			v2 ^= 0xFF;
+			for( SizeType i = 0; i < 4; i++ )
+			{
+				SipRound( v0, v1, v2, v3 );
+			}
+
+			return v0 ^ v1 ^ v2 ^ v3;
+		}
+
+	}
+
+}
@@ -23,8 +23,12 @@
 
 #include <Bit/Network/Net/Private/Connection.hpp>
 #include <Bit/Network/Net/Server.hpp>
+#include <Bit/Network/Net/Private/EntitySnapshot.hpp>
 #include <Bit/System/Sleep.hpp>
 #include <Bit/System/Timer.hpp>
+#include <Bit/System/Log.hpp>
+#include <algorithm>
+#include <cstring>
 #include <Bit/System/MemoryLeak.hpp>
 
 namespace Bit
@@ -38,8 +42,12 @@ namespace Bit
 								const Uint16 & p_UserId,
 								const Bool	p_SendEntityMessages,
 								const Time & p_LosingConnectionTimeout,
+								FragmentAssembler::Budget * p_pReassemblyBudget,
+								const Bool p_CongestionControl,
+								const Uint32 p_MaxSendRate,
 								const Time & p_InitialPing ) :
 			m_pServer( NULL ),
+			m_pShard( NULL ),
 			m_SendEntityMessages(p_SendEntityMessages),
 			m_Connected( false ),
 			m_Address( p_Address ),
@@ -47,8 +55,24 @@ namespace Bit
 			m_UserId( p_UserId ),
 			m_LosingConnectionTimeout(p_LosingConnectionTimeout),
 			m_Sequence( 0 ),
-			m_Ping( p_InitialPing )
+			m_ReliableRingFull( false ),
+			m_Rtt( RttEstimator( p_InitialPing * 2ULL ) ),
+			m_Channels( MessageChannels( UserReorderBufferCount, UserReorderBufferSize ) ),
+			m_ChannelsFull( false ),
+			m_Compression( CompressionType::None ),
+			m_AckedSnapshot( -1 ),
+			m_NextMessageId( 0 ),
+			m_FragmentsInFlight( 0 ),
+			m_FragmentAssembler( MaxUserFragmentedMessageSize, UserReassemblyBufferSize, p_pReassemblyBudget ),
+			m_pWorkerPool( NULL ),
+			m_PendingTasks( 0 ),
+			m_TickPending( false ),
+			m_TickTask( ConnectionWorkerPool::Task::Tick ),
+			m_RemoveTask( ConnectionWorkerPool::Task::Remove ),
+			m_ScheduleTask( ConnectionWorkerPool::Task::Schedule, NULL, this )
 		{
+			m_ReliableTimer.Start( );
+			m_Congestion.Value.Reset( p_CongestionControl, p_MaxSendRate );
 		}
 
 		Connection::~Connection( )
@@ -67,12 +91,40 @@ namespace Bit
 
 		Time Connection::GetPing( )
 		{
-			m_Ping.Mutex.Lock( );
-			Time time = m_Ping.Value;
-			m_Ping.Mutex.Unlock( );
+			m_Rtt.Mutex.Lock( );
+			Time time = m_Rtt.Value.GetRtt( ) / 2ULL;
+			m_Rtt.Mutex.Unlock( );
 			return time;
 		}
 
+		ConnectionStatistics Connection::GetStatistics( )
+		{
+			ConnectionStatistics statistics;
+
+			m_Rtt.Mutex.Lock( );
+			statistics.Rtt = m_Rtt.Value.GetRtt( );
+			statistics.RttVariance = m_Rtt.Value.GetRttVariance( );
+			statistics.Rto = m_Rtt.Value.GetRto( );
+			m_Rtt.Mutex.Unlock( );
+
+			m_Congestion.Mutex.Lock( );
+			statistics.PacketLoss = m_Congestion.Value.GetLoss( ) * 100.0f;
+			statistics.SendRate = m_Congestion.Value.GetSendRate( );
+			statistics.DeliveryRate = m_Congestion.Value.GetDeliveryRate( );
+			statistics.PacketsSent = m_Congestion.Value.GetPacketsSent( );
+			statistics.PacketsLost = m_Congestion.Value.GetPacketsLost( );
+			m_Congestion.Mutex.Unlock( );
+
+			m_Channels.Mutex.Lock( );
+			for( Uint8 i = 0; i < MaxChannelCount; i++ )
+			{
+				statistics.OrderingDelay[ i ] = m_Channels.Value.GetOrderingDelay( i );
+			}
+			m_Channels.Mutex.Unlock( );
+
+			return statistics;
+		}
+
 		Uint16 Connection::GetUserId( ) const
 		{
 			return m_UserId;
@@ -88,13 +140,6 @@ namespace Bit
 			return m_Port;
 		}
 		
-		Uint64 Connection::GetPackedAddress( ) const
-		{
-			return	static_cast<Uint64>( m_Address.GetAddress( ) ) * 
-					static_cast<Uint64>( m_Port ) +
-					static_cast<Uint64>( m_Port ) ;
-		}
-
 		void Connection::AddToGroup(const Uint32 p_GroupIndex)
 		{
 			m_Groups.Mutex.Lock();
@@ -109,26 +154,12 @@ namespace Bit
 			m_Groups.Mutex.Unlock();
 		}
 
-		// received data struct
-		Connection::ReceivedData::ReceivedData( Uint8 * p_pData,
-												const SizeType p_DataSize,
-												const Uint16 p_Sequence ) :
-			Sequence( p_Sequence ),
-			DataSize( p_DataSize )
-		{
-			pData = new Uint8[ p_DataSize ];
-			memcpy( pData, p_pData, p_DataSize );
-		}
-
-		Connection::ReceivedData::~ReceivedData( )
+		void Connection::StartThreads( Server * p_pServer, ReceiveShard * p_pShard, ConnectionWorkerPool * p_pWorkerPool )
 		{
-			delete [ ] pData;
-		}
-
-		void Connection::StartThreads( Server * p_pServer )
-		{
-			// Set server pointer
+			// Set server, shard and worker pool pointers
 			m_pServer = p_pServer;
+			m_pShard = p_pShard;
+			m_pWorkerPool = p_pWorkerPool;
 
 			// Start the timer for the last recv packet.
 			m_LastRecvTimer.Mutex.Lock( );
@@ -145,17 +176,19 @@ namespace Bit
 			m_Connected.Value = true;
 			m_Connected.Mutex.Unlock( );
 
-			// Initialize the ping list
-			for( SizeType i = 0; i < 5; i++ )
+			// Let the worker pool drive the connection.
+			if( m_pWorkerPool )
 			{
-				m_PingList.push_front( m_Ping.Value );
+				m_EventTimer.Start( );
+				m_pWorkerPool->Add( this );
+				return;
 			}
 
 			// Start the thread.
 			m_Thread.Execute( [ this ] ( )
 			 {
 					// Pointer to the raw packet to handle.
-					MemoryPool<Uint8>::Item * pItem = NULL;
+					ConcurrentMemoryPool<Uint8>::Item * pItem = NULL;
 
 					// Keep on running as long as the server is running.
 					while( IsConnected( ) )
@@ -166,156 +199,7 @@ namespace Bit
 						// Go throguh the packets.
 						while (IsConnected() && (pItem = PollReceivedData()) != NULL)
 						{
-							Uint8 * pData = pItem->GetData();
-							SizeType recvSize = pItem->GetUsedSize();
-
-							// Reset the time for checking last time a packet arrived
-							m_LastRecvTimer.Mutex.Lock( );
-							m_LastRecvTimer.Value.Start( );
-							m_LastRecvTimer.Mutex.Unlock( );
-
-							// Check the packet type
-							switch (pData[0])
-							{
-								// Connect packet from client, we should get the packet here if
-								// the client resent the connection packet.
-								case PacketType::Connect:
-								{
-									// Make sure that the identifier is right.
-									if (recvSize != m_pServer->m_Identifier.size() + 1)
-									{
-										break;
-									}
-									if (memcmp(pData + 1, m_pServer->m_Identifier.data(), m_pServer->m_Identifier.size()) != 0)
-									{
-										break;
-									}
-
-									// Answer the client with a SYNACK packet.
-									pData[0] = PacketType::Accept;
-									m_pServer->m_Socket.Send(pData, 1, m_Address, m_Port);
-								}
-								break;
-								// Disconnect packet from client.
-								case PacketType::Disconnect:
-								{
-
-									// Set the connection flag to false
-									m_Connected.Set(false);
-
-									// Add the connection to the cleanup thread.
-									m_pServer->AddConnectionForCleanup( this );
-
-									// Increase the semaphore for cleanups
-									m_pServer->m_CleanupSemaphore.Release( );
-
-									// Call on disconnect function
-									m_pServer->OnDisconnection( m_UserId );
-
-									// break this switch, the connection thread will terminate.
-									break;
-								}
-								break;
-								// Alive packet from client.
-								case PacketType::Alive:
-								{
-									// Ignore "corrupt" alive packet.
-									if (recvSize != 3)
-									{
-										break;
-									}
-
-									Uint16 sequence = Ntoh16(	static_cast<Uint16>(static_cast<Uint8>(pData[1])) |
-																static_cast<Uint16>(static_cast<Uint8>(pData[2]) << 8));
-
-									// Use the already allocated packet, change the type
-									pData[0] = PacketType::Acknowledgement;
-
-									// Send the ack packet
-									m_pServer->m_Socket.Send(pData, 3, m_Address, m_Port);
-								}
-								break;
-								// ACK packet from client.
-								case PacketType::Acknowledgement:
-								{
-									// Ignore "corrupt" ack packet.
-									if (recvSize != 3)
-									{
-										break;
-									}
-
-									// Get the sequence
-									Uint16 sequence = Ntoh16(	static_cast<Uint16>(static_cast<Uint8>(pData[1])) |
-																static_cast<Uint16>(static_cast<Uint8>(pData[2]) << 8));
-
-									// Find the sequence in the reliable map
-									m_ReliableMap.Mutex.Lock( );
-									ReliablePacketMap::iterator it = m_ReliableMap.Value.find( sequence );
-									// Remove the packet from the map if it's found and calculate the ping.
-									if( it != m_ReliableMap.Value.end( ) )
-									{
-										// Calculate the new ping from the lapsed time if it's not a resent packet
-										if( it->second->Resent == false )
-										{
-											CalculateNewPing( it->second->SendTimer.GetLapsedTime( ) );
-										}
-
-										// Clean up the data
-										delete [ ] it->second->pData;
-										delete it->second;
-
-										// Erase the reliable packet
-										m_ReliableMap.Value.erase( it );
-									}
-									m_ReliableMap.Mutex.Unlock( );
-								}
-								break;
-								case PacketType::UserMessage:
-								{
-									// Error check the recv size
-									if (recvSize <= UserMessagePacketSize)
-									{
-										break;
-									}
-
-									// Get the sequence
-									const Uint16 sequence = Ntoh16(	static_cast<Uint16>(static_cast<Uint8>(pData[1])) |
-																	static_cast<Uint16>(static_cast<Uint8>(pData[2]) << 8));
-
-
-									// Check the reliable flag
-									if (pData[PacketTypeSize + SequenceSize] == ReliabilityType::Reliable)
-									{
-										// Use the already allocated packet, change the type
-										pData[0] = PacketType::Acknowledgement;
-
-										// Send the ack packet
-										m_pServer->m_Socket.Send(pData, AcknowledgementPacketSize, m_Address, m_Port);
-									}
-
-									// Add the packets sequence to the sequence manager, do not handle the packet
-									// if we've already received a packet with the same sequence.
-									if (m_SequenceManager.AddSequence(sequence))
-									{
-
-										// Add the unreliable packet to the received data queue.	
-										ReceivedData * pReceivedData = new ReceivedData(pData + UserMessagePacketSize,
-																						recvSize - UserMessagePacketSize,
-																						sequence);
-
-										// Add the host message.
-										AddUserMessage(pReceivedData);
-									}
-								}
-								break;
-								default:
-									break;
-							};
-
-							// Destroy the packet.
-							m_pServer->m_PacketMemoryPool.Mutex.Lock();
-							m_pServer->m_PacketMemoryPool.Value->Return(pItem);
-							m_pServer->m_PacketMemoryPool.Mutex.Unlock();
+							HandleReceivedData( pItem );
 						}
 
 					}
@@ -335,180 +219,540 @@ namespace Bit
 
 					while( m_UserMessages.Value.size( ) )
 					{
-						// Ge the received data
-						ReceivedData * pReceivedData = m_UserMessages.Value.front( );
-
 						// Pop the message
+						ReceivedData receivedData = m_UserMessages.Value.front( );
 						m_UserMessages.Value.pop( );
 
-						// Get the message name
-						SizeType nameEnd = 1;
-						for( SizeType i = 1; i < pReceivedData->DataSize; i++ )
-						{
-							if( pReceivedData->pData[ i ] == 0 )
-							{
-								nameEnd = i;
-								break;
-							}
-						}
+						// Handle the message, let the packet thread add messages meanwhile.
+						m_UserMessages.Mutex.Unlock( );
+						HandleUserMessage( receivedData.pData, receivedData.DataSize );
+						ReleaseUserMessage( receivedData );
+						m_UserMessages.Mutex.Lock( );
+					}
 
-						// Error check the name length
-						if( nameEnd == 1 )
-						{
-							// Delete the received data pointer
-							delete pReceivedData;
-							continue;
-						}
+					m_UserMessages.Mutex.Unlock( );
+				}
+			}
+			);
 
-						// Copy the name.
-						std::string name;
-						name.assign( reinterpret_cast<char*>(pReceivedData->pData + 1), nameEnd - 1 );
 
-						// Check if there is any message left(including empty)
-						if( name.size( ) + 2 > pReceivedData->DataSize )
-						{
-							// Delete the received data pointer
-							delete pReceivedData;
-							continue;
-						}
+			// Execute the event thread
+			m_EventThread.Execute( [ this ] ( )
+				{
+					while( IsConnected( ) )
+					{
+						// Sleep for some time.
+						Sleep( Milliseconds( 10 ) );
 
-						// Find the listeners for this user message
-						m_pServer->m_UserMessageListeners.Mutex.Lock( );
-						Server::UserMessageListenerMap::iterator it = m_pServer->m_UserMessageListeners.Value.find( name );
-						if( it == m_pServer->m_UserMessageListeners.Value.end( ) )
+						// Check the connection timeout and alive packets.
+						if( CheckConnectionEvents( ) == false )
 						{
-							// Delete the received data pointer
-							delete pReceivedData;
-							continue;
+							return;
 						}
+					}
+				}
+			);
+
+			// Execute the reliable thread
+			m_ReliableThread.Execute( [ this ] ( )
+				{
+					while( IsConnected( ) )
+					{
+						// Sleep for some time.
+						Sleep( Milliseconds( 1 ) );
 
-						Server::UserMessageListenerSet * pMessageSet = it->second;
+						// Check if we should resend any packet.
+						CheckReliablePackets( );
 
-						// Go through the listeners and call the listener function
-						for( Server::UserMessageListenerSet::iterator it2 = pMessageSet->begin( ); it2 != pMessageSet->end( ); it2++ )
-						{
-							// Get the listener.
-							UserMessageListener * pListener = *it2;
+						// Send the packets coalesced since the last tick.
+						FlushPackets( );
+					}
+				}
+			);
 
-							// Create a message decoder
-							Uint8 * pDataPointer =  pReceivedData->pData + name.size( ) + 2;
-							const SizeType dataSize = pReceivedData->DataSize - name.size( ) - 2;
-							UserMessageDecoder messageDecoder( name, m_UserId, pDataPointer, dataSize ) ;
 
-							// Use threads????
-							// Handle the message.
-							pListener->HandleMessage( messageDecoder );
-						}
+		}
+
+		void Connection::HandleReceivedData( ConcurrentMemoryPool<Uint8>::Item * p_pItem )
+		{
+			Uint8 * pData = p_pItem->GetData();
+			SizeType recvSize = p_pItem->GetUsedSize();
+
+			// Reset the time for checking last time a packet arrived
+			m_LastRecvTimer.Mutex.Lock( );
+			m_LastRecvTimer.Value.Start( );
+			m_LastRecvTimer.Mutex.Unlock( );
+
+			// Handle the packet.
+			HandlePacket( pData, recvSize );
 
-						m_pServer->m_UserMessageListeners.Mutex.Unlock( );
+			// Keep the packet until its user messages are handled.
+			if( AddPendingUserMessages( p_pItem ) )
+			{
+				return;
+			}
+
+			// Destroy the packet.
+			m_pShard->pPacketMemoryPool->Return(p_pItem);
+		}
 
-						// Delete the received data pointer
-						delete pReceivedData;
+		void Connection::HandlePacket( Uint8 * p_pData, const SizeType p_DataSize )
+		{
+			// Check the packet type
+			switch (p_pData[0])
+			{
+				// Challenge response from client, we should get the packet here if
+				// the accept packet was lost and the client resent the response.
+				case PacketType::ChallengeResponse:
+				{
+					// Make sure that the identifier is right.
+					if (p_DataSize != m_pServer->m_Identifier.size() + ChallengeResponsePacketSize)
+					{
+						break;
+					}
+					if (memcmp(p_pData + ChallengeResponsePacketSize, m_pServer->m_Identifier.data(), m_pServer->m_Identifier.size()) != 0)
+					{
+						break;
 					}
 
-					m_UserMessages.Mutex.Unlock( );
+					// Answer the client with an accept packet, keeping the connect sequence.
+					const Uint64 serverTime = Hton64(m_pServer->GetServerTime().AsMicroseconds());
+					p_pData[0] = PacketType::Accept;
+					memcpy(&p_pData[ConnectPacketSize], &serverTime, sizeof(Uint64));
+					m_pShard->pSocket->Send(p_pData, AcceptPacketSize, m_Address, m_Port);
 				}
-			}
-			);
+				break;
+				// Disconnect packet from client.
+				case PacketType::Disconnect:
+				{
 
+					// Set the connection flag to false
+					m_Connected.Set(false);
 
-			// Execute the event thread
-			m_EventThread.Execute( [ this ] ( )
+					// Add the connection to the cleanup thread, this releases the cleanup semaphore.
+					m_pServer->AddConnectionForCleanup( this );
+
+					// Call on disconnect function
+					m_pServer->OnDisconnection( m_UserId );
+
+					// break this switch, the connection thread will terminate.
+					break;
+				}
+				break;
+				// Alive packet from client.
+				case PacketType::Alive:
 				{
-					while( IsConnected( ) )
+					// Ignore "corrupt" alive packet.
+					if (p_DataSize != 3)
 					{
-						// Sleep for some time.
-						Sleep( Milliseconds( 10 ) );
+						break;
+					}
 
-						// Disconnect you've not heard anything from the server in a while.
-						const Bit::Time timesinceLastPacket = TimeSinceLastRecvPacket();
-						if (timesinceLastPacket >= m_LosingConnectionTimeout)
-						{
-							// Set the connection flag to false
-							m_Connected.Mutex.Lock( );
-							m_Connected.Value = false;
-							m_Connected.Mutex.Unlock( );
+					Uint16 sequence = Ntoh16(	static_cast<Uint16>(static_cast<Uint8>(p_pData[1])) |
+												static_cast<Uint16>(static_cast<Uint8>(p_pData[2]) << 8));
 
-							// Add the connection to the cleanup thread.
-							m_pServer->AddConnectionForCleanup( this );
+					// Acknowledge the packet
+					AcknowledgePacket(sequence);
+				}
+				break;
+				// ACK packet from client.
+				case PacketType::Acknowledgement:
+				{
+					// Ignore "corrupt" ack packet.
+					if (p_DataSize != 3)
+					{
+						break;
+					}
 
-							// Increase the semaphore for cleanups
-							m_pServer->m_CleanupSemaphore.Release( );
+					// Get the sequence
+					Uint16 sequence = Ntoh16(	static_cast<Uint16>(static_cast<Uint8>(p_pData[1])) |
+												static_cast<Uint16>(static_cast<Uint8>(p_pData[2]) << 8));
 
-							// Call on disconnect function
-							m_pServer->OnDisconnection( m_UserId );
+					HandleAcknowledgement( sequence );
+				}
+				break;
+				// Coalesced packets and acknowledgements from client.
+				case PacketType::Coalesced:
+				{
+					// Get the acknowledgement header
+					Bool hasAck = false;
+					Uint16 ackSequence = 0;
+					Uint32 ackBits = 0;
+					if (PacketBuilder::ReadHeader(p_pData, p_DataSize, hasAck, ackSequence, ackBits) == false)
+					{
+						break;
+					}
 
-							return;
+					// Handle the acknowledgements.
+					if (hasAck)
+					{
+						HandleAcknowledgement(ackSequence);
+						for (Uint32 i = 0; i < AckBitCount; i++)
+						{
+							if ((ackBits >> i) & 0x01)
+							{
+								HandleAcknowledgement(static_cast<Uint16>(ackSequence - 1 - i));
+							}
 						}
+					}
 
-						// Get the lapsed time since the last packet was sent.
-						m_LastSendTimer.Mutex.Lock( );
-						Time lapsedTime =  m_LastSendTimer.Value.GetLapsedTime( );
-						m_LastSendTimer.Mutex.Unlock( );
+					// Handle the packets, ignore nested coalesced packets.
+					SizeType position = CoalescedPacketSize;
+					Uint8 * pPacket = NULL;
+					SizeType packetSize = 0;
+					while (PacketBuilder::ReadPacket(p_pData, p_DataSize, position, pPacket, packetSize))
+					{
+						if (pPacket[0] != PacketType::Coalesced)
+						{
+							HandlePacket(pPacket, packetSize);
+						}
 
-						// Send alive packet if requred
-						if( lapsedTime >= Seconds( 0.5f ) )
+						// Stop dispatching the packets after a disconnect packet.
+						if (pPacket[0] == PacketType::Disconnect)
 						{
-							SendReliable( PacketType::Alive, NULL, 0, false );
+							break;
 						}
 					}
 				}
-			);
+				break;
+				// Entity snapshot ACK packet from client.
+				case PacketType::SnapshotAck:
+				{
+					// Ignore "corrupt" snapshot ack packet.
+					if (p_DataSize != SnapshotAckPacketSize)
+					{
+						break;
+					}
 
-			// Execute the reliable thread
-			m_ReliableThread.Execute( [ this ] ( )
+					// Get the snapshot id
+					const Uint16 snapshotId = Ntoh16(	static_cast<Uint16>(static_cast<Uint8>(p_pData[1])) |
+														static_cast<Uint16>(static_cast<Uint8>(p_pData[2]) << 8));
+
+					// Use the snapshot as baseline if it's newer than the current one.
+					m_AckedSnapshot.Mutex.Lock();
+					if (m_AckedSnapshot.Value < 0 ||
+						EntitySnapshot::IsNewer(snapshotId, static_cast<Uint16>(m_AckedSnapshot.Value)))
+					{
+						m_AckedSnapshot.Value = snapshotId;
+					}
+					m_AckedSnapshot.Mutex.Unlock();
+				}
+				break;
+				case PacketType::UserMessage:
 				{
-					ReliablePacket * pPacket = NULL;
+					// Error check the recv size
+					if (p_DataSize <= UserMessagePacketSize)
+					{
+						break;
+					}
 
-					while( IsConnected( ) )
+					// Get the sequence
+					const Uint16 sequence = Ntoh16(	static_cast<Uint16>(static_cast<Uint8>(p_pData[1])) |
+													static_cast<Uint16>(static_cast<Uint8>(p_pData[2]) << 8));
+
+
+					// Check the reliable flag
+					if (p_pData[PacketTypeSize + SequenceSize] == ReliabilityType::Reliable)
 					{
-						// Sleep for some time.
-						Sleep( Milliseconds( 1 ) );
+						// Acknowledge the packet
+						AcknowledgePacket(sequence);
+					}
 
-						// Check if we should resend any packet.
-						m_ReliableMap.Mutex.Lock( );
-						
-						for(	ReliablePacketMap::iterator it = m_ReliableMap.Value.begin( );
-								it != m_ReliableMap.Value.end( );
-								it++ ) 
-						{
-							pPacket = it->second;
+					// Add the packets sequence to the sequence manager, do not handle the packet
+					// if we've already received a packet with the same sequence.
+					if (m_SequenceManager.AddSequence(sequence))
+					{
+						// Add the user message, decoded from the packet.
+						ReceiveUserMessage(p_pData + UserMessagePacketSize, p_DataSize - UserMessagePacketSize, false);
+					}
+				}
+				break;
+				// Host message ids from client.
+				case PacketType::MessageTable:
+				{
+					// Error check the recv size
+					if (p_DataSize <= MessageTablePacketSize)
+					{
+						break;
+					}
 
-							// Resend packet after ping * 3.0 seconds.
-							// Calculte the resend time.
-							m_Ping.Mutex.Lock( );
-							Time resendTime = Microseconds( static_cast<Uint64>(static_cast<Float64>( m_Ping.Value.AsMicroseconds( ) ) * 3.0f ));
-							m_Ping.Mutex.Unlock( );
+					// Get the sequence
+					const Uint16 sequence = Ntoh16(	static_cast<Uint16>(static_cast<Uint8>(p_pData[1])) |
+													static_cast<Uint16>(static_cast<Uint8>(p_pData[2]) << 8));
 
-							if( pPacket->ResendTimer.GetLapsedTime( ) >= resendTime )
-							{
-								// Send packet.
-								m_pServer->m_Socket.Send( pPacket->pData, pPacket->DataSize, m_Address, m_Port );
+					// Check the reliable flag
+					if (p_pData[PacketTypeSize + SequenceSize] == ReliabilityType::Reliable)
+					{
+						// Acknowledge the packet
+						AcknowledgePacket(sequence);
+					}
 
-								// Restart the resend timer
-								pPacket->ResendTimer.Start( );
+					if (m_SequenceManager.AddSequence(sequence))
+					{
+						m_HostMessageIds.Mutex.Lock();
+						m_HostMessageIds.Value.Decode(p_pData + MessageTablePacketSize, p_DataSize - MessageTablePacketSize);
+						m_HostMessageIds.Mutex.Unlock();
+					}
+				}
+				break;
+				// Answer to the compression offered by the server.
+				case PacketType::Compression:
+				{
+					// Error check the recv size
+					if (p_DataSize < CompressionPacketSize)
+					{
+						break;
+					}
+
+					// Get the sequence
+					const Uint16 sequence = Ntoh16(	static_cast<Uint16>(static_cast<Uint8>(p_pData[1])) |
+													static_cast<Uint16>(static_cast<Uint8>(p_pData[2]) << 8));
 
-								// Mark the packet as resent.
-								pPacket->Resent = true;
+					// Check the reliable flag
+					if (p_pData[PacketTypeSize + SequenceSize] == ReliabilityType::Reliable)
+					{
+						// Acknowledge the packet
+						AcknowledgePacket(sequence);
+					}
+
+					if (m_SequenceManager.AddSequence(sequence))
+					{
+						Uint32 checksum = 0;
+						memcpy(&checksum, p_pData + PacketTypeSize + SequenceSize + ReliabilityFlagSize, sizeof(checksum));
+						checksum = Ntoh32(checksum);
 
-								// Increase the ping if we lose packets
-								m_Ping.Mutex.Lock( );
-								m_Ping.Value = Microseconds( static_cast<Uint64>(static_cast<Float64>( m_Ping.Value.AsMicroseconds( ) ) * 1.2f ));
-								m_Ping.Mutex.Unlock( );
+						// Compress by the dictionary if the client has the same one, else without any dictionary.
+						CompressionType::eType compression = CompressionType::None;
+						if (m_pServer->m_CompressionThreshold)
+						{
+							if (checksum == 0)
+							{
+								compression = CompressionType::Plain;
+							}
+							else if (checksum == m_pServer->m_CompressionDictionary.GetChecksum())
+							{
+								compression = CompressionType::Dictionary;
 							}
 						}
-						m_ReliableMap.Mutex.Unlock( );
+						m_Compression.Set(compression);
+					}
+				}
+				break;
+				// Fragment of a reliable message from client.
+				case PacketType::Fragment:
+				{
+					// Error check the recv size
+					if (p_DataSize <= FragmentPacketSize)
+					{
+						break;
+					}
+
+					// Get the sequence
+					const Uint16 sequence = Ntoh16(	static_cast<Uint16>(static_cast<Uint8>(p_pData[1])) |
+													static_cast<Uint16>(static_cast<Uint8>(p_pData[2]) << 8));
+
+					// Add the fragment to its message if it's not already handled.
+					// Do not acknowledge rejected fragments, the client will resend them.
+					if (m_SequenceManager.HasSequence(sequence) == false)
+					{
+						Uint8 messageType = 0;
+						std::vector<Uint8> message;
+						const FragmentAssembler::Result::eResult result = 
+							m_FragmentAssembler.AddFragment(p_pData + PacketTypeSize + SequenceSize + ReliabilityFlagSize,
+															p_DataSize - PacketTypeSize - SequenceSize - ReliabilityFlagSize,
+															messageType, message);
+						if (result == FragmentAssembler::Result::Rejected)
+						{
+							break;
+						}
+
+						m_SequenceManager.AddSequence(sequence);
 
+						if (result == FragmentAssembler::Result::Completed)
+						{
+							HandleFragmentedMessage(messageType, message);
+						}
 					}
+
+					// Acknowledge the packet
+					AcknowledgePacket(sequence);
 				}
-			);
+				break;
+				default:
+					break;
+			};
+		}
+
+		void Connection::HandleUserMessage( const Uint8 * p_pData, const SizeType p_DataSize )
+		{
+			// Read the message id.
+			Uint16 id = 0;
+			const char * pName = NULL;
+			SizeType headerSize = 0;
+			if( MessageTable::ReadHeader( p_pData, p_DataSize, id, pName, headerSize ) == false )
+			{
+				return;
+			}
+
+			// Find the id of messages sent by name.
+			if( pName )
+			{
+				m_pServer->m_UserMessageTable.Mutex.Lock( );
+				id = m_pServer->m_UserMessageTable.Value.Find( pName );
+				m_pServer->m_UserMessageTable.Mutex.Unlock( );
+			}
 
+			// Go through the listeners and call the listener function
+			m_pServer->m_UserMessageHandlers.Mutex.Lock( );
 
+			if( id < m_pServer->m_UserMessageHandlers.Value.size( ) )
+			{
+				const Server::UserMessageHandler & handler = m_pServer->m_UserMessageHandlers.Value[ id ];
+				for( SizeType i = 0; i < handler.Listeners.size( ); i++ )
+				{
+					UserMessageDecoder messageDecoder( handler.Name, m_UserId, p_pData + headerSize, p_DataSize - headerSize );
+					handler.Listeners[ i ]->HandleMessage( messageDecoder );
+				}
+			}
+
+			m_pServer->m_UserMessageHandlers.Mutex.Unlock( );
+		}
+
+		void Connection::ReleaseUserMessage( ReceivedData & p_ReceivedData )
+		{
+			if( p_ReceivedData.Owned )
+			{
+				delete [ ] p_ReceivedData.pData;
+			}
+
+			if( p_ReceivedData.pItem )
+			{
+				m_pShard->pPacketMemoryPool->Return( p_ReceivedData.pItem );
+			}
+		}
+
+		Bool Connection::CheckConnectionEvents( )
+		{
+			// Disconnect you've not heard anything from the server in a while,
+			// or if the client stopped acknowledging the reliable packets,
+			// or if its messages overflowed the reorder buffers.
+			const Bit::Time timesinceLastPacket = TimeSinceLastRecvPacket();
+			if (timesinceLastPacket >= m_LosingConnectionTimeout || m_ReliableRingFull.load() || m_ChannelsFull.load())
+			{
+				// Set the connection flag to false
+				m_Connected.Mutex.Lock( );
+				m_Connected.Value = false;
+				m_Connected.Mutex.Unlock( );
+
+				// Add the connection to the cleanup thread, this releases the cleanup semaphore.
+				m_pServer->AddConnectionForCleanup( this );
+
+				// Call on disconnect function
+				m_pServer->OnDisconnection( m_UserId );
+
+				return false;
+			}
+
+			// Get the lapsed time since the last packet was sent.
+			m_LastSendTimer.Mutex.Lock( );
+			Time lapsedTime =  m_LastSendTimer.Value.GetLapsedTime( );
+			m_LastSendTimer.Mutex.Unlock( );
+
+			// Send alive packet if requred
+			if( lapsedTime >= Seconds( 0.5f ) )
+			{
+				SendReliable( PacketType::Alive, NULL, 0, false );
+			}
+
+			return true;
+		}
+
+		void Connection::CheckReliablePackets( )
+		{
+			m_ReliablePackets.Mutex.Lock( );
+
+			// Collect the packets past their resend deadline, without scanning the packets in flight.
+			const Time currentTime = m_ReliableTimer.GetLapsedTime( );
+			m_ResendDatagrams.clear( );
+			m_ReliablePackets.Value.Expire( currentTime, [ this, &currentTime ] ( ReliablePacket & p_Packet ) -> Time
+			{
+				// Hold the packet back until the send rate allows it.
+				if( ConsumeSendBudget( p_Packet.HeaderSize + p_Packet.PayloadSize, false ) == false )
+				{
+					return currentTime + Milliseconds( 1 );
+				}
+
+				m_ResendDatagrams.resize( m_ResendDatagrams.size( ) + 1 );
+				SetDatagram( &p_Packet, m_ResendDatagrams.back( ) );
+
+				// The packet is lost, back off the resend time for every resend.
+				m_Congestion.Mutex.Lock( );
+				m_Congestion.Value.OnLoss( );
+				m_Congestion.Mutex.Unlock( );
+
+				p_Packet.Resends++;
+				return currentTime + GetResendTime( p_Packet.Resends );
+			} );
+
+			// Resend the packets in a single batch.
+			if( m_ResendDatagrams.size( ) )
+			{
+				m_pShard->pSocket->SendBatch( m_ResendDatagrams.data( ), m_ResendDatagrams.size( ) );
+			}
+
+			m_ReliablePackets.Mutex.Unlock( );
+		}
+
+		Time Connection::GetResendTime( const Uint32 p_Resends )
+		{
+			m_Rtt.Mutex.Lock( );
+			const Time resendTime = m_Rtt.Value.GetBackoffRto( p_Resends );
+			m_Rtt.Mutex.Unlock( );
+			return resendTime;
+		}
+
+		Bool Connection::ConsumeSendBudget( const SizeType p_Size, const Bool p_Force )
+		{
+			m_Congestion.Mutex.Lock( );
+			const Bool send = m_Congestion.Value.Consume( p_Size, p_Force );
+			m_Congestion.Mutex.Unlock( );
+			return send;
+		}
+
+		void Connection::HandleTick( )
+		{
+			// Let the tick thread post the next tick.
+			m_TickPending.store( false );
+
+			if( IsConnected( ) == false )
+			{
+				return;
+			}
+
+			// Check the reliable packets at every tick.
+			CheckReliablePackets( );
+
+			// Send the packets coalesced since the last tick.
+			FlushPackets( );
+
+			// Check the events every 10th millisecond, as the event thread does.
+			if( m_EventTimer.GetLapsedTime( ) >= Milliseconds( 10 ) )
+			{
+				m_EventTimer.Start( );
+				CheckConnectionEvents( );
+			}
 		}
 
 		
-		void Connection::AddReceivedData(MemoryPool<Uint8>::Item * p_pItem)
+		void Connection::AddReceivedData(ConcurrentMemoryPool<Uint8>::Item * p_pItem)
 		{
+			// Post the packet to the worker pool.
+			if (m_pWorkerPool)
+			{
+				m_pWorkerPool->PostPacket(this, p_pItem);
+				return;
+			}
+
 			// Lock the received data mutex.
 			m_ReceivedData.Mutex.Lock();
 			
@@ -524,9 +768,9 @@ namespace Bit
 			m_ReceivedData.Mutex.Unlock();
 		}
 
-		MemoryPool<Uint8>::Item * Connection::PollReceivedData()
+		ConcurrentMemoryPool<Uint8>::Item * Connection::PollReceivedData()
 		{
-			MemoryPool<Uint8>::Item * pItem = NULL;
+			ConcurrentMemoryPool<Uint8>::Item * pItem = NULL;
 
 			m_ReceivedData.Mutex.Lock();
 			if (m_ReceivedData.Value.size())
@@ -560,29 +804,41 @@ namespace Bit
 
 			if( connected )
 			{
+				// Send the coalesced packets.
+				FlushPackets( );
+
 				// Send close packet.
 				Uint8 buffer = PacketType::Disconnect;
-				m_pServer->m_Socket.Send( &buffer, 1, m_Address, m_Port );
+				m_pShard->pSocket->Send( &buffer, 1, m_Address, m_Port );
 			}
-				
-			// Wait for the threads to finish.
-			if( p_CloseMainThread )
-			{
-				m_ReceivedDataSemaphore.Release();
- 				m_Thread.Finish( );
-			}
-			if( p_CloseEventThread )
-			{
-				m_EventThread.Finish( );
-			}
-			if( p_CloseReliableThread )
+
+			// Remove the connection from the worker pool, no threads are running.
+			if( m_pWorkerPool )
 			{
-				m_ReliableThread.Finish( );
+				m_pWorkerPool->Remove( this );
+				m_pWorkerPool = NULL;
 			}
-			if( p_CloseUserMessageThread )
+			else
 			{
-				m_UserMessageSemaphore.Release( );
-				m_UserMessageThread.Finish( );
+				// Wait for the threads to finish.
+				if( p_CloseMainThread )
+				{
+					m_ReceivedDataSemaphore.Release();
+	 				m_Thread.Finish( );
+				}
+				if( p_CloseEventThread )
+				{
+					m_EventThread.Finish( );
+				}
+				if( p_CloseReliableThread )
+				{
+					m_ReliableThread.Finish( );
+				}
+				if( p_CloseUserMessageThread )
+				{
+					m_UserMessageSemaphore.Release( );
+					m_UserMessageThread.Finish( );
+				}
 			}
 
 			// Reset the sequence.
@@ -591,31 +847,107 @@ namespace Bit
 			m_Sequence.Mutex.Unlock( );
 
 			// Clear the reliable packets
-			m_ReliableMap.Mutex.Lock( );
-			for(	ReliablePacketMap::iterator it = m_ReliableMap.Value.begin( );
-					it != m_ReliableMap.Value.end( );
-					it ++ )
+			m_ReliablePackets.Mutex.Lock( );
+			m_ReliablePackets.Value.Clear( ReleaseReliablePacket );
+			m_ReliablePackets.Mutex.Unlock( );
+
+			// Clear the fragmented messages
+			m_FragmentedMessages.Mutex.Lock( );
+			while( m_FragmentedMessages.Value.size( ) )
+			{
+				m_FragmentedMessages.Value.front( ).pPayload->Release( );
+				m_FragmentedMessages.Value.pop( );
+			}
+			m_FragmentsInFlight = 0;
+			m_FragmentedMessages.Mutex.Unlock( );
+			m_ReliableRingFull = false;
+			m_ChannelsFull = false;
+			m_FragmentAssembler.Clear( );
+
+			// Clear the coalesced packets
+			m_PacketBuilder.Mutex.Lock( );
+			m_PacketBuilder.Value.Clear( );
+			m_PacketBuilder.Mutex.Unlock( );
+
+			// Release the unhandled user messages.
+			m_UserMessages.Mutex.Lock( );
+			while( m_UserMessages.Value.size( ) )
 			{
-				delete [ ] it->second->pData;
-				delete it->second;
+				ReleaseUserMessage( m_UserMessages.Value.front( ) );
+				m_UserMessages.Value.pop( );
 			}
-			m_ReliableMap.Value.clear( );
-			m_ReliableMap.Mutex.Unlock( );
+			m_UserMessages.Mutex.Unlock( );
 
 			// Return all the received data items to the servers memory pool.
 			m_ReceivedData.Mutex.Lock();
-			m_pServer->m_PacketMemoryPool.Mutex.Lock();
 			while (m_ReceivedData.Value.size())
 			{
-				m_pServer->m_PacketMemoryPool.Value->Return(m_ReceivedData.Value.front());
+				m_pShard->pPacketMemoryPool->Return(m_ReceivedData.Value.front());
 
 				m_ReceivedData.Value.pop();
 			}
-			m_pServer->m_PacketMemoryPool.Mutex.Unlock();
 			m_ReceivedData.Mutex.Unlock();
-			
-			// Clear the ping list.
-			m_PingList.clear( );
+		}
+
+		Uint16 Connection::GetNextSequence( )
+		{
+			m_Sequence.Mutex.Lock();
+			Uint16 sequence = m_Sequence.Value;
+			m_Sequence.Value++;
+			m_Sequence.Mutex.Unlock();
+			return sequence;
+		}
+
+		Int32 Connection::GetAckedSnapshot( )
+		{
+			return m_AckedSnapshot.Get( );
+		}
+
+		void Connection::SetAckedSnapshot( const Int32 p_SnapshotId )
+		{
+			m_AckedSnapshot.Set( p_SnapshotId );
+		}
+
+		void Connection::SetEntityView( const EntityInterest::View & p_View )
+		{
+			m_EntityView.Set( p_View );
+		}
+
+		EntityInterest::View Connection::GetEntityView( )
+		{
+			return m_EntityView.Get( );
+		}
+
+		EntityInterest & Connection::GetEntityInterest( )
+		{
+			return m_EntityInterest;
+		}
+
+		Bool Connection::CompressMessage( std::vector<Uint8> & p_Message, const SizeType p_HeaderSize )
+		{
+			const CompressionType::eType compression = m_Compression.Get( );
+			if( compression == CompressionType::None ||
+				p_Message.size( ) < p_HeaderSize + m_pServer->m_CompressionThreshold )
+			{
+				return false;
+			}
+
+			// Keep the header, and compress the payload following it.
+			m_CompressionBuffer.assign( p_Message.begin( ), p_Message.begin( ) + p_HeaderSize );
+			const CompressionDictionary * pDictionary = compression == CompressionType::Dictionary ? &m_pServer->m_CompressionDictionary : NULL;
+			if( PacketCompressor::Compress( p_Message.data( ) + p_HeaderSize, p_Message.size( ) - p_HeaderSize, m_CompressionBuffer, pDictionary ) == false )
+			{
+				return false;
+			}
+
+			// Swap the buffers, the message buffers of the server are reused as compression buffers.
+			p_Message.swap( m_CompressionBuffer );
+			return true;
+		}
+
+		CompressionType::eType Connection::GetCompression( )
+		{
+			return m_Compression.Get( );
 		}
 
 		void Connection::SendUnreliable(	const PacketType::eType p_PacketType,
@@ -658,63 +990,185 @@ namespace Bit
 			// Add the data to the new buffer
 			memcpy(pBuffer + (packetSize - p_DataSize), p_pData, p_DataSize);
 
-			// Send the packet.
-			m_pServer->m_Socket.Send(pBuffer, packetSize, m_Address, m_Port);
+			// Count the packet in the send rate, it's sent right away.
+			ConsumeSendBudget(packetSize, true);
+
+			// Coalesce messages, send control packets right away.
+			if (p_AddSequence == false || QueuePacket(pBuffer, packetSize, NULL, 0) == false)
+			{
+				m_pShard->pSocket->Send(pBuffer, packetSize, m_Address, m_Port);
+			}
 
 			// Delete the packet
 			delete[] pBuffer;
 		}
 
-		void Connection::SendReliable(	const PacketType::eType p_PacketType, 
-										void * p_pData,
-										const Bit::SizeType p_DataSize,
-										const bool p_AddReliableFlag)
+		Connection::ReliablePacket * Connection::CreateReliablePacket(	const PacketType::eType p_PacketType,
+																		PacketBuffer * p_pPayload,
+																		const bool p_AddReliableFlag,
+																		const FragmentedMessage * p_pFragmentedMessage)
 		{
-			// Create a new buffer.
-			const SizeType packetSize = p_DataSize + PacketTypeSize + SequenceSize + (p_AddReliableFlag ? 1 : 0);
-			Uint8 * pBuffer = new Uint8[packetSize];
-			pBuffer[0] = static_cast<Uint8>(p_PacketType);
-
 			// Get the current sequence, and increment it.
 			m_Sequence.Mutex.Lock();
 			Uint16 currentSequence = m_Sequence.Value;
 			m_Sequence.Value++;
 			m_Sequence.Mutex.Unlock();
-	
-			// Add the sequence to the data buffer.
+
+			const Time resendTime = GetResendTime(0);
+
+			// Add the packet to the reliable packet ring, the packet is filled while the ring is locked.
+			m_ReliablePackets.Mutex.Lock();
+			const Time deadline = m_ReliableTimer.GetLapsedTime() + resendTime;
+			ReliablePacket * pReliablePacket = m_ReliablePackets.Value.Add(currentSequence, deadline);
+
+			// The packet of the sequence a whole sequence space ago is still not acknowledged,
+			// the sequence can't be reused. Fail the connection, the packets in the ring are kept until the disconnection.
+			if (pReliablePacket == NULL)
+			{
+				m_ReliablePackets.Mutex.Unlock();
+
+				if (m_ReliableRingFull.exchange(true) == false)
+				{
+					bitLogNetErr("Reliable packet never acknowledged: " << currentSequence);
+				}
+				return NULL;
+			}
+
+			pReliablePacket->Header[0] = static_cast<Uint8>(p_PacketType);
+			pReliablePacket->HeaderSize = PacketTypeSize + SequenceSize + (p_AddReliableFlag ? ReliabilityFlagSize : 0);
+
+			// Add the sequence to the header.
 			Uint16 sequence = Hton16(currentSequence);
-			memcpy(pBuffer + 1, &sequence, SequenceSize);
+			memcpy(pReliablePacket->Header + 1, &sequence, SequenceSize);
 
 			// Add the reliable flag
 			if (p_AddReliableFlag)
 			{
-				pBuffer[PacketTypeSize + SequenceSize] = static_cast<Uint8>(ReliabilityType::Reliable);
+				pReliablePacket->Header[PacketTypeSize + SequenceSize] = static_cast<Uint8>(ReliabilityType::Reliable);
 			}
 
-			// Add the data to the buffer
-			memcpy(pBuffer + (packetSize - p_DataSize), p_pData, p_DataSize);
+			// Keep a reference to the payload until the packet is acknowledged.
+			if (p_pPayload)
+			{
+				p_pPayload->AddReference();
+			}
+			pReliablePacket->pPayload = p_pPayload;
+			pReliablePacket->PayloadOffset = 0;
+			pReliablePacket->PayloadSize = p_pPayload ? p_pPayload->GetDataSize() : 0;
+
+			// Add the fragment header and send the fragment's part of the payload only.
+			if (p_pFragmentedMessage)
+			{
+				FragmentAssembler::WriteHeader(	pReliablePacket->Header + pReliablePacket->HeaderSize,
+												static_cast<Uint8>(p_pFragmentedMessage->Type),
+												p_pFragmentedMessage->MessageId,
+												p_pFragmentedMessage->NextFragment,
+												p_pFragmentedMessage->FragmentCount);
+				pReliablePacket->HeaderSize += FragmentHeaderSize;
+				pReliablePacket->PayloadOffset = static_cast<SizeType>(p_pFragmentedMessage->NextFragment) * FragmentDataSize;
+				pReliablePacket->PayloadSize = std::min(FragmentDataSize, pReliablePacket->PayloadSize - pReliablePacket->PayloadOffset);
+			}
 
-			// Create the reliable packet.
-			ReliablePacket * pReliablePacket = new ReliablePacket;
-			pReliablePacket->pData = pBuffer;
-			pReliablePacket->DataSize = packetSize;
 			pReliablePacket->Sequence = currentSequence;
-			pReliablePacket->Resent = false;
+			pReliablePacket->Resends = 0;
 			pReliablePacket->SendTimer.Start();
-			pReliablePacket->ResendTimer.Start();
 
-			// Add the packet to the reliable map.
-			m_ReliableMap.Mutex.Lock();
-			m_ReliableMap.Value.insert(ReliablePacketPair(currentSequence, pReliablePacket));
-			m_ReliableMap.Mutex.Unlock();
+			const SizeType packetSize = pReliablePacket->HeaderSize + pReliablePacket->PayloadSize;
+
+			m_ReliablePackets.Mutex.Unlock();
+
+			// Count the packet in the send rate, reliable packets are never held back.
+			ConsumeSendBudget(packetSize, true);
+
+			return pReliablePacket;
+		}
+
+		void Connection::SetDatagram( const ReliablePacket * p_pPacket, UdpSocket::Datagram & p_Datagram ) const
+		{
+			p_Datagram.pHeader = p_pPacket->Header;
+			p_Datagram.HeaderSize = p_pPacket->HeaderSize;
+			p_Datagram.pData = p_pPacket->pPayload ? const_cast<Uint8 *>(p_pPacket->pPayload->GetData()) + p_pPacket->PayloadOffset : NULL;
+			p_Datagram.DataSize = p_pPacket->PayloadSize;
+			p_Datagram.RemoteAddress = m_Address;
+			p_Datagram.RemotePort = m_Port;
+		}
+
+		void Connection::ReleaseReliablePacket( ReliablePacket & p_Packet )
+		{
+			if (p_Packet.pPayload)
+			{
+				p_Packet.pPayload->Release();
+				p_Packet.pPayload = NULL;
+			}
+		}
+
+		void Connection::SendReliable(	const PacketType::eType p_PacketType, 
+										void * p_pData,
+										const Bit::SizeType p_DataSize,
+										const bool p_AddReliableFlag)
+		{
+			// Copy the data to a payload only referenced by this connection.
+			PacketBuffer * pPayload = p_DataSize ? PacketBuffer::Create(p_pData, p_DataSize) : NULL;
+
+			SendReliable(p_PacketType, pPayload, p_AddReliableFlag);
+
+			if (pPayload)
+			{
+				pPayload->Release();
+			}
+		}
+
+		void Connection::SendReliable(	const PacketType::eType p_PacketType,
+										PacketBuffer * p_pPayload,
+										const bool p_AddReliableFlag)
+		{
+			// Queue messages too large for a single packet, and send them in fragments.
+			if (p_pPayload && p_pPayload->GetDataSize() > FragmentDataSize)
+			{
+				if (p_pPayload->GetDataSize() > MaxFragmentedMessageSize)
+				{
+					bitLogNetErr("Too large reliable message: " << p_pPayload->GetDataSize());
+					return;
+				}
+
+				p_pPayload->AddReference();
+
+				FragmentedMessage message;
+				message.Type = p_PacketType;
+				message.pPayload = p_pPayload;
+				message.NextFragment = 0;
+				message.FragmentCount = FragmentAssembler::GetFragmentCount(p_pPayload->GetDataSize());
+
+				m_FragmentedMessages.Mutex.Lock();
+				message.MessageId = m_NextMessageId++;
+				m_FragmentedMessages.Value.push(message);
+				m_FragmentedMessages.Mutex.Unlock();
+
+				SendFragments();
+				return;
+			}
+
+			// Create the reliable packet and add it to the reliable packet ring.
+			ReliablePacket * pReliablePacket = CreateReliablePacket(p_PacketType, p_pPayload, p_AddReliableFlag);
+			if (pReliablePacket == NULL)
+			{
+				return;
+			}
+
+			// Coalesce small packets with the other packets of the tick.
+			const Uint8 * pPayloadData = p_pPayload ? p_pPayload->GetData() + pReliablePacket->PayloadOffset : NULL;
+			if (QueuePacket(pReliablePacket->Header, pReliablePacket->HeaderSize, pPayloadData, pReliablePacket->PayloadSize))
+			{
+				return;
+			}
 
 			// Send SYN packet, tell the server that we would like to connect.
-			if (m_pServer->m_Socket.Send(pBuffer, packetSize, m_Address, m_Port) == packetSize)
+			UdpSocket::Datagram datagram;
+			SetDatagram(pReliablePacket, datagram);
+			if (m_pShard->pSocket->SendBatch(&datagram, 1) == 1)
 			{
 				// Restart the timer
-				m_LastSendTimer.Mutex.Lock();
-				m_LastSendTimer.Value.Start();
-				m_LastSendTimer.Mutex.Unlock();
+				RestartSendTimer();
 			}
 
 
@@ -759,7 +1213,7 @@ namespace Bit
 			m_ReliableMap.Mutex.Unlock();
 
 			// Send SYN packet, tell the server that we would like to connect.
-			if (m_pServer->m_Socket.Send(pData, packetSize, m_Address, m_Port) == packetSize)
+			if (m_pShard->pSocket->Send(pData, packetSize, m_Address, m_Port) == packetSize)
 			{
 				// Restart the timer
 				m_LastSendTimer.Mutex.Lock();
@@ -769,32 +1223,290 @@ namespace Bit
 			*/
 		}
 
+		void Connection::SendFragments( )
+		{
+			std::vector<UdpSocket::Datagram> datagrams;
+
+			// Create the fragment packets, in the order of the messages.
+			m_FragmentedMessages.Mutex.Lock();
+			while (m_FragmentedMessages.Value.size() && m_FragmentsInFlight < FragmentWindowSize)
+			{
+				FragmentedMessage & message = m_FragmentedMessages.Value.front();
+
+				ReliablePacket * pReliablePacket = CreateReliablePacket(PacketType::Fragment, message.pPayload, true, &message);
+				if (pReliablePacket == NULL)
+				{
+					break;
+				}
+				datagrams.resize(datagrams.size() + 1);
+				SetDatagram(pReliablePacket, datagrams.back());
+				m_FragmentsInFlight++;
+
+				// Release the message when all fragments are sent, the fragment packets keep their own references.
+				message.NextFragment++;
+				if (message.NextFragment == message.FragmentCount)
+				{
+					message.pPayload->Release();
+					m_FragmentedMessages.Value.pop();
+				}
+			}
+			m_FragmentedMessages.Mutex.Unlock();
+
+			// Send the fragments in a single batch.
+			if (datagrams.size() && m_pShard->pSocket->SendBatch(datagrams.data(), datagrams.size()) > 0)
+			{
+				RestartSendTimer();
+			}
+		}
+
+		void Connection::HandleFragmentedMessage( const Uint8 p_MessageType, std::vector<Uint8> & p_Message )
+		{
+			switch (p_MessageType)
+			{
+				case PacketType::UserMessage:
+				{
+					ReceiveUserMessage(p_Message.data(), p_Message.size(), true);
+				}
+				break;
+				case PacketType::MessageTable:
+				{
+					m_HostMessageIds.Mutex.Lock();
+					m_HostMessageIds.Value.Decode(p_Message.data(), p_Message.size());
+					m_HostMessageIds.Mutex.Unlock();
+				}
+				break;
+				default:
+				{
+					bitLogNetErr("Unexpected fragmented message: " << static_cast<Uint32>(p_MessageType));
+				}
+				break;
+			}
+		}
+
+		void Connection::HandleAcknowledgement( const Uint16 p_Sequence )
+		{
+			// Find the sequence in the reliable packet ring
+			Bool fragmentAcked = false;
+			m_ReliablePackets.Mutex.Lock( );
+			ReliablePacket * pPacket = m_ReliablePackets.Value.Get( p_Sequence );
+			// Remove the packet from the ring if it's found and calculate the ping.
+			if( pPacket )
+			{
+				// Calculate the new ping from the lapsed time if it's not a resent packet
+				if( pPacket->Resends == 0 )
+				{
+					CalculateNewPing( pPacket->SendTimer.GetLapsedTime( ) );
+				}
+
+				// Estimate the delivery rate.
+				m_Congestion.Mutex.Lock( );
+				m_Congestion.Value.OnAcknowledgement( pPacket->HeaderSize + pPacket->PayloadSize );
+				m_Congestion.Mutex.Unlock( );
+
+				fragmentAcked = pPacket->Header[ 0 ] == PacketType::Fragment;
+
+				// Clean up the data
+				ReleaseReliablePacket( *pPacket );
+
+				// Return the reliable packet to the pool
+				m_ReliablePackets.Value.Remove( p_Sequence );
+			}
+			m_ReliablePackets.Mutex.Unlock( );
+
+			// Send the next fragments, there's room in the fragment window.
+			if( fragmentAcked )
+			{
+				m_FragmentsInFlight--;
+				SendFragments( );
+			}
+		}
+
+		void Connection::AcknowledgePacket( const Uint16 p_Sequence )
+		{
+			m_PacketBuilder.Mutex.Lock( );
+
+			PacketBuilder::AckResult::eResult result = m_PacketBuilder.Value.AddAcknowledgement( p_Sequence );
+
+			// Send the unsent acknowledgements before they are shifted out of the ack bitfield.
+			if( result == PacketBuilder::AckResult::Full )
+			{
+				SendCoalescedPacket( );
+				result = m_PacketBuilder.Value.AddAcknowledgement( p_Sequence );
+			}
+
+			m_PacketBuilder.Mutex.Unlock( );
+
+			// Acknowledge packets older than the ack bitfield on their own.
+			if( result == PacketBuilder::AckResult::Old )
+			{
+				Uint8 buffer[ AcknowledgementPacketSize ];
+				const Uint16 sequence = Hton16( p_Sequence );
+				buffer[ 0 ] = PacketType::Acknowledgement;
+				memcpy( buffer + 1, &sequence, SequenceSize );
+				m_pShard->pSocket->Send( buffer, AcknowledgementPacketSize, m_Address, m_Port );
+			}
+		}
+
+		Bool Connection::QueuePacket(	const Uint8 * p_pHeader,
+										const SizeType p_HeaderSize,
+										const Uint8 * p_pData,
+										const SizeType p_DataSize )
+		{
+			if( PacketBuilder::CanCoalesce( p_HeaderSize + p_DataSize ) == false )
+			{
+				return false;
+			}
+
+			m_PacketBuilder.Mutex.Lock( );
+
+			// Send the coalesced packet if there's no room for the packet.
+			if( m_PacketBuilder.Value.AddPacket( p_pHeader, p_HeaderSize, p_pData, p_DataSize ) == false )
+			{
+				SendCoalescedPacket( );
+				m_PacketBuilder.Value.AddPacket( p_pHeader, p_HeaderSize, p_pData, p_DataSize );
+			}
+
+			m_PacketBuilder.Mutex.Unlock( );
+
+			return true;
+		}
+
+		void Connection::FlushPackets( )
+		{
+			m_PacketBuilder.Mutex.Lock( );
+			SendCoalescedPacket( );
+			m_PacketBuilder.Mutex.Unlock( );
+		}
+
+		void Connection::SendCoalescedPacket( )
+		{
+			if( m_PacketBuilder.Value.Flush( m_CoalescedPacket ) &&
+				m_pShard->pSocket->Send( m_CoalescedPacket.data( ), m_CoalescedPacket.size( ), m_Address, m_Port ) > 0 )
+			{
+				RestartSendTimer( );
+			}
+		}
+
+		void Connection::RestartSendTimer( )
+		{
+			m_LastSendTimer.Mutex.Lock( );
+			m_LastSendTimer.Value.Start( );
+			m_LastSendTimer.Mutex.Unlock( );
+		}
+
 		void Connection::CalculateNewPing( const Time & p_LapsedTime )
 		{
-			// Add the new ping to the ping list
-			m_PingList.pop_front( );
-			m_PingList.push_back( p_LapsedTime / 2ULL );
+			m_Rtt.Mutex.Lock( );
+			m_Rtt.Value.AddSample( p_LapsedTime );
+			m_Rtt.Mutex.Unlock( );
+		}
+
+		void Connection::ReceiveUserMessage( const Uint8 * p_pData, const SizeType p_DataSize, const Bool p_Copy )
+		{
+			// Get the channel of the message.
+			Uint8 channel = 0;
+			Uint16 sequence = 0;
+			if( MessageChannels::ReadChannel( p_pData, p_DataSize, channel, sequence ) == false )
+			{
+				return;
+			}
+
+			m_Channels.Mutex.Lock( );
+			const MessageChannels::Result::eResult result = m_Channels.Value.Receive( channel, sequence, p_pData, p_DataSize );
+			m_Channels.Mutex.Unlock( );
+
+			// The message is acknowledged but can't be buffered, fail the connection.
+			if( result == MessageChannels::Result::Overflow )
+			{
+				if( m_ChannelsFull.exchange( true ) == false )
+				{
+					bitLogNetErr( "Reorder buffer full, channel: " << static_cast<Uint32>( channel & ChannelIndexMask ) );
+				}
+				return;
+			}
+
+			if( result != MessageChannels::Result::Deliver )
+			{
+				return;
+			}
+
+			AddUserMessage( p_pData, p_DataSize, p_Copy );
+
+			// Add the buffered messages waiting for this one.
+			// The channel mutex is not locked while adding, the worker pool handles the messages at once.
+			std::vector<Uint8> message;
+			while( true )
+			{
+				m_Channels.Mutex.Lock( );
+				const Bool polled = m_Channels.Value.PollBuffered( channel, message );
+				m_Channels.Mutex.Unlock( );
+
+				if( polled == false )
+				{
+					break;
+				}
+
+				AddUserMessage( message.data( ), message.size( ), true );
+			}
+		}
+
+		void Connection::AddUserMessage( const Uint8 * p_pData, const SizeType p_DataSize, const Bool p_Copy )
+		{
+			// Handle the message right away in the worker, keeping the order of the packets.
+			if( m_pWorkerPool )
+			{
+				HandleUserMessage( p_pData, p_DataSize );
+				return;
+			}
 
-			// Calculate the new ping
-			Uint64 newPing = 0ULL;
-			for( TimeList::iterator it = m_PingList.begin( ); it != m_PingList.end( ); it++ )
+			ReceivedData receivedData;
+			receivedData.pItem = NULL;
+			receivedData.pData = p_pData;
+			receivedData.DataSize = p_DataSize;
+			receivedData.Owned = p_Copy;
+
+			// Copy messages that are not in the pooled packet, such as reassembled messages.
+			if( p_Copy )
 			{
-				newPing += it->AsMicroseconds( );
+				Uint8 * pData = new Uint8[ p_DataSize ];
+				memcpy( pData, p_pData, p_DataSize );
+				receivedData.pData = pData;
 			}
-			newPing /= static_cast<Uint64>( m_PingList.size( ) );
-										
-			m_Ping.Mutex.Lock( );
-			m_Ping.Value = Microseconds( newPing );
-			m_Ping.Mutex.Unlock( ); 
+
+			m_PendingUserMessages.push_back( receivedData );
 		}
 
-		void Connection::AddUserMessage( ReceivedData * p_pReceivedData )
+		Bool Connection::AddPendingUserMessages( ConcurrentMemoryPool<Uint8>::Item * p_pItem )
 		{
+			if( m_PendingUserMessages.size( ) == 0 )
+			{
+				return false;
+			}
+
+			// The last message of the packet returns it to the pool.
+			m_PendingUserMessages.back( ).pItem = p_pItem;
+
+			// Release the messages if the packet disconnected the client, no thread is handling them.
+			if( IsConnected( ) == false )
+			{
+				for( SizeType i = 0; i < m_PendingUserMessages.size( ); i++ )
+				{
+					ReleaseUserMessage( m_PendingUserMessages[ i ] );
+				}
+				m_PendingUserMessages.clear( );
+				return true;
+			}
+
 			m_UserMessages.Mutex.Lock( );
-			m_UserMessages.Value.push( p_pReceivedData );
+			for( SizeType i = 0; i < m_PendingUserMessages.size( ); i++ )
+			{
+				m_UserMessages.Value.push( m_PendingUserMessages[ i ] );
+			}
 			m_UserMessages.Mutex.Unlock( );
 
+			m_PendingUserMessages.clear( );
 			m_UserMessageSemaphore.Release( );
+			return true;
 		}
 
 	}
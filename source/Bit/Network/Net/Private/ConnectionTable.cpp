@@ -0,0 +1,208 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Private/ConnectionTable.hpp>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		// Initial number of slots, power of two.
+		static const SizeType g_InitialCapacity = 16;
+
+		ConnectionTable::ConnectionTable( ) :
+			m_Size( 0 )
+		{
+		}
+
+		void ConnectionTable::Reserve( const SizeType p_Count )
+		{
+			// Keep the table at most half full.
+			SizeType capacity = m_Slots.size( ) ? m_Slots.size( ) : g_InitialCapacity;
+			while( capacity < p_Count * 2 )
+			{
+				capacity *= 2;
+			}
+
+			if( capacity != m_Slots.size( ) )
+			{
+				Rehash( capacity );
+			}
+		}
+
+		Connection * ConnectionTable::Find( const Uint32 p_Address, const Uint16 p_Port ) const
+		{
+			if( m_Size == 0 )
+			{
+				return NULL;
+			}
+
+			// Probe until the key or an empty slot is found.
+			const Uint64 key = GetKey( p_Address, p_Port );
+			const SizeType mask = m_Slots.size( ) - 1;
+			for( SizeType i = GetSlot( key ); ; i = ( i + 1 ) & mask )
+			{
+				const Slot & slot = m_Slots[ i ];
+				if( slot.pConnection == NULL )
+				{
+					return NULL;
+				}
+				if( slot.Key == key )
+				{
+					return slot.pConnection;
+				}
+			}
+		}
+
+		Bool ConnectionTable::Add( const Uint32 p_Address, const Uint16 p_Port, Connection * p_pConnection )
+		{
+			if( p_pConnection == NULL )
+			{
+				return false;
+			}
+
+			// Grow the table before it gets more than half full.
+			Reserve( m_Size + 1 );
+
+			const Uint64 key = GetKey( p_Address, p_Port );
+			const SizeType mask = m_Slots.size( ) - 1;
+			for( SizeType i = GetSlot( key ); ; i = ( i + 1 ) & mask )
+			{
+				Slot & slot = m_Slots[ i ];
+				if( slot.pConnection == NULL )
+				{
+					slot.Key = key;
+					slot.pConnection = p_pConnection;
+					m_Size++;
+					return true;
+				}
+				if( slot.Key == key )
+				{
+					return false;
+				}
+			}
+		}
+
+		Bool ConnectionTable::Remove( const Uint32 p_Address, const Uint16 p_Port )
+		{
+			if( m_Size == 0 )
+			{
+				return false;
+			}
+
+			// Find the slot of the key.
+			const Uint64 key = GetKey( p_Address, p_Port );
+			const SizeType mask = m_Slots.size( ) - 1;
+			SizeType hole = GetSlot( key );
+			while( m_Slots[ hole ].Key != key || m_Slots[ hole ].pConnection == NULL )
+			{
+				if( m_Slots[ hole ].pConnection == NULL )
+				{
+					return false;
+				}
+				hole = ( hole + 1 ) & mask;
+			}
+
+			// Shift the following entries of the probe sequence back into the hole,
+			// unless that would move them before their home slot.
+			for( SizeType i = ( hole + 1 ) & mask; m_Slots[ i ].pConnection != NULL; i = ( i + 1 ) & mask )
+			{
+				const SizeType home = GetSlot( m_Slots[ i ].Key );
+				if( ( ( i - home ) & mask ) >= ( ( i - hole ) & mask ) )
+				{
+					m_Slots[ hole ] = m_Slots[ i ];
+					hole = i;
+				}
+			}
+
+			m_Slots[ hole ].pConnection = NULL;
+			m_Size--;
+			return true;
+		}
+
+		SizeType ConnectionTable::GetSize( ) const
+		{
+			return m_Size;
+		}
+
+		void ConnectionTable::Clear( )
+		{
+			for( SizeType i = 0; i < m_Slots.size( ); i++ )
+			{
+				m_Slots[ i ].pConnection = NULL;
+			}
+			m_Size = 0;
+		}
+
+		Uint64 ConnectionTable::GetKey( const Uint32 p_Address, const Uint16 p_Port )
+		{
+			return ( static_cast<Uint64>( p_Address ) << 16 ) | static_cast<Uint64>( p_Port );
+		}
+
+		SizeType ConnectionTable::GetSlot( const Uint64 p_Key ) const
+		{
+			// Mix the bits of the key, the addresses of a subnet and the ports only differ in a few bits.
+			Uint64 hash = p_Key;
+			hash ^= hash >> 33;
+			hash *= 0xFF51AFD7ED558CCDULL;
+			hash ^= hash >> 33;
+			hash *= 0xC4CEB9FE1A85EC53ULL;
+			hash ^= hash >> 33;
+
+			return static_cast<SizeType>( hash ) & ( m_Slots.size( ) - 1 );
+		}
+
+		void ConnectionTable::Rehash( const SizeType p_Capacity )
+		{
+			SlotVector slots( p_Capacity );
+			for( SizeType i = 0; i < slots.size( ); i++ )
+			{
+				slots[ i ].Key = 0;
+				slots[ i ].pConnection = NULL;
+			}
+			m_Slots.swap( slots );
+
+			// Reinsert the connections.
+			const SizeType mask = m_Slots.size( ) - 1;
+			for( SizeType i = 0; i < slots.size( ); i++ )
+			{
+				if( slots[ i ].pConnection == NULL )
+				{
+					continue;
+				}
+
+				SizeType j = GetSlot( slots[ i ].Key );
+				while( m_Slots[ j ].pConnection != NULL )
+				{
+					j = ( j + 1 ) & mask;
+				}
+				m_Slots[ j ] = slots[ i ];
+			}
+		}
+
+	}
+
+}
@@ -0,0 +1,400 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Private/ConnectionWorkerPool.hpp>
+#include <Bit/Network/Net/Private/Connection.hpp>
+#include <Bit/System/Sleep.hpp>
+#include <thread>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		// Task struct
+		ConnectionWorkerPool::Task::Task( const eType p_Type, ConcurrentMemoryPool<Uint8>::Item * p_pItem, Connection * p_pConnection ) :
+			Type( p_Type ),
+			pItem( p_pItem ),
+			pConnection( p_pConnection ),
+			pPoolItem( NULL ),
+			pNext( NULL )
+		{
+		}
+
+		// Task queue class
+		ConnectionWorkerPool::TaskQueue::TaskQueue( ) :
+			m_pHead( &m_Stub ),
+			m_pTail( &m_Stub )
+		{
+		}
+
+		void ConnectionWorkerPool::TaskQueue::Push( Task * p_pTask )
+		{
+			p_pTask->pNext.store( NULL, std::memory_order_relaxed );
+
+			// Swap the head and link the previous head to the new task.
+			Task * pPrevious = m_pHead.exchange( p_pTask, std::memory_order_acq_rel );
+			pPrevious->pNext.store( p_pTask, std::memory_order_release );
+		}
+
+		ConnectionWorkerPool::Task * ConnectionWorkerPool::TaskQueue::Pop( )
+		{
+			Task * pTail = m_pTail;
+			Task * pNext = pTail->pNext.load( std::memory_order_acquire );
+
+			// Skip the stub task.
+			if( pTail == &m_Stub )
+			{
+				if( pNext == NULL )
+				{
+					return NULL;
+				}
+
+				m_pTail = pNext;
+				pTail = pNext;
+				pNext = pNext->pNext.load( std::memory_order_acquire );
+			}
+
+			// More than one task in the queue.
+			if( pNext )
+			{
+				m_pTail = pNext;
+				return pTail;
+			}
+
+			// A push is in progress.
+			if( pTail != m_pHead.load( std::memory_order_acquire ) )
+			{
+				return NULL;
+			}
+
+			// Last task in the queue, push the stub back in order to pop it.
+			Push( &m_Stub );
+			pNext = pTail->pNext.load( std::memory_order_acquire );
+			if( pNext )
+			{
+				m_pTail = pNext;
+				return pTail;
+			}
+
+			return NULL;
+		}
+
+		// Connection worker pool class
+		ConnectionWorkerPool::ConnectionWorkerPool( ) :
+			m_NextWorker( 0 ),
+			m_TaskPool( 4096, 1 ),
+			m_Running( false ),
+			m_TaskBatchSize( 32 )
+		{
+		}
+
+		ConnectionWorkerPool::~ConnectionWorkerPool( )
+		{
+			Stop( );
+		}
+
+		Bool ConnectionWorkerPool::Start( const Uint32 p_WorkerCount )
+		{
+			if( IsRunning( ) )
+			{
+				return false;
+			}
+
+			// Size the pool to the number of hardware threads.
+			Uint32 workerCount = p_WorkerCount;
+			if( workerCount == 0 )
+			{
+				workerCount = static_cast<Uint32>( std::thread::hardware_concurrency( ) );
+				if( workerCount == 0 )
+				{
+					workerCount = 1;
+				}
+			}
+
+			m_Running.Set( true );
+
+			// Create the workers before starting them, Schedule reads the worker vector.
+			for( Uint32 i = 0; i < workerCount; i++ )
+			{
+				m_Workers.push_back( new Worker );
+			}
+
+			// Start the worker threads.
+			for( WorkerVector::iterator it = m_Workers.begin( ); it != m_Workers.end( ); it++ )
+			{
+				Worker * pWorker = *it;
+
+				pWorker->WorkerThread.Execute( [ this, pWorker ] ( )
+				{
+					while( IsRunning( ) )
+					{
+						// Wait for a connection with pending tasks.
+						pWorker->ReadySemaphore.Wait( );
+
+						// Get the connection, the push may still be in progress.
+						Task * pTask = NULL;
+						while( ( pTask = pWorker->ReadyQueue.Pop( ) ) == NULL && IsRunning( ) )
+						{
+							Sleep( Microseconds( 0 ) );
+						}
+						if( pTask == NULL )
+						{
+							continue;
+						}
+
+						// Execute the connection's tasks.
+						ExecuteTasks( pTask->pConnection );
+					}
+				}
+				);
+			}
+
+			// Start the tick thread.
+			m_TickThread.Execute( [ this ] ( )
+			{
+				while( IsRunning( ) )
+				{
+					// Sleep for some time.
+					Sleep( Milliseconds( 1 ) );
+
+					// Post a tick task to every connection without a pending tick.
+					m_Connections.Mutex.Lock( );
+					for(	ConnectionSet::iterator it = m_Connections.Value.begin( );
+							it != m_Connections.Value.end( );
+							it++ )
+					{
+						Connection * pConnection = *it;
+						if( pConnection->m_TickPending.exchange( true ) == false )
+						{
+							Post( pConnection, &pConnection->m_TickTask );
+						}
+					}
+					m_Connections.Mutex.Unlock( );
+				}
+			}
+			);
+
+			return true;
+		}
+
+		void ConnectionWorkerPool::Stop( )
+		{
+			if( IsRunning( ) == false )
+			{
+				return;
+			}
+
+			// Set the running flag to false.
+			m_Running.Set( false );
+
+			// Wait for the tick thread to finish.
+			m_TickThread.Finish( );
+
+			// Wake up and wait for the workers to finish.
+			for( WorkerVector::iterator it = m_Workers.begin( ); it != m_Workers.end( ); it++ )
+			{
+				(*it)->ReadySemaphore.Release( );
+				(*it)->WorkerThread.Finish( );
+			}
+
+			// Release the tasks left in the connection queues, no worker is executing them.
+			m_Connections.Mutex.Lock( );
+			for(	ConnectionSet::iterator it = m_Connections.Value.begin( );
+					it != m_Connections.Value.end( );
+					it++ )
+			{
+				DrainTasks( *it );
+			}
+			m_Connections.Mutex.Unlock( );
+
+			// Delete the workers, the ready queues only hold the schedule tasks of the connections.
+			for( WorkerVector::iterator it = m_Workers.begin( ); it != m_Workers.end( ); it++ )
+			{
+				delete *it;
+			}
+			m_Workers.clear( );
+		}
+
+		Bool ConnectionWorkerPool::IsRunning( )
+		{
+			m_Running.Mutex.Lock( );
+			Bool running = m_Running.Value;
+			m_Running.Mutex.Unlock( );
+			return running;
+		}
+
+		Uint32 ConnectionWorkerPool::GetWorkerCount( ) const
+		{
+			return static_cast<Uint32>( m_Workers.size( ) );
+		}
+
+		void ConnectionWorkerPool::Add( Connection * p_pConnection )
+		{
+			m_Connections.Mutex.Lock( );
+			m_Connections.Value.insert( p_pConnection );
+			m_Connections.Mutex.Unlock( );
+		}
+
+		void ConnectionWorkerPool::Remove( Connection * p_pConnection )
+		{
+			// Stop posting tick tasks.
+			m_Connections.Mutex.Lock( );
+			m_Connections.Value.erase( p_pConnection );
+			m_Connections.Mutex.Unlock( );
+
+			// Release the tasks right away if no worker is running.
+			if( IsRunning( ) == false )
+			{
+				DrainTasks( p_pConnection );
+				return;
+			}
+
+			// Wait for a worker to reach the remove task, the tasks posted before it are executed.
+			m_RemoveMutex.Lock( );
+			Post( p_pConnection, &p_pConnection->m_RemoveTask );
+			m_RemoveEvent.Wait( );
+			m_RemoveMutex.Unlock( );
+
+			// The worker left the connection at the remove task without decreasing the pending tasks,
+			// release the tasks posted after it.
+			while( p_pConnection->m_PendingTasks.fetch_sub( 1 ) != 1 )
+			{
+				ReleaseTask( p_pConnection, PopTask( p_pConnection ) );
+			}
+		}
+
+		void ConnectionWorkerPool::Post( Connection * p_pConnection, Task * p_pTask )
+		{
+			p_pConnection->m_Tasks.Push( p_pTask );
+
+			// Schedule the connection if it was idle.
+			if( p_pConnection->m_PendingTasks.fetch_add( 1 ) == 0 )
+			{
+				Schedule( p_pConnection );
+			}
+		}
+
+		void ConnectionWorkerPool::PostPacket( Connection * p_pConnection, ConcurrentMemoryPool<Uint8>::Item * p_pItem )
+		{
+			// Take the task from the pool instead of allocating it for every packet.
+			ConcurrentMemoryPool<Task>::Item * pPoolItem = m_TaskPool.Get( );
+			Task * pTask = pPoolItem->GetData( );
+			pTask->Type = Task::Packet;
+			pTask->pItem = p_pItem;
+			pTask->pPoolItem = pPoolItem;
+
+			Post( p_pConnection, pTask );
+		}
+
+		void ConnectionWorkerPool::Schedule( Connection * p_pConnection )
+		{
+			// Hand the connection to the next worker, the connection is in at most one ready queue.
+			const Uint32 index = m_NextWorker.fetch_add( 1, std::memory_order_relaxed );
+			Worker * pWorker = m_Workers[ index % m_Workers.size( ) ];
+
+			pWorker->ReadyQueue.Push( &p_pConnection->m_ScheduleTask );
+			pWorker->ReadySemaphore.Release( );
+		}
+
+		ConnectionWorkerPool::Task * ConnectionWorkerPool::PopTask( Connection * p_pConnection )
+		{
+			Task * pTask = NULL;
+			while( ( pTask = p_pConnection->m_Tasks.Pop( ) ) == NULL )
+			{
+				Sleep( Microseconds( 0 ) );
+			}
+
+			return pTask;
+		}
+
+		void ConnectionWorkerPool::ReleaseTask( Connection * p_pConnection, Task * p_pTask )
+		{
+			if( p_pTask->Type == Task::Packet )
+			{
+				p_pTask->pItem->GetParent( )->Return( p_pTask->pItem );
+				m_TaskPool.Return( p_pTask->pPoolItem );
+			}
+			else if( p_pTask->Type == Task::Tick )
+			{
+				p_pConnection->m_TickPending.store( false );
+			}
+		}
+
+		void ConnectionWorkerPool::DrainTasks( Connection * p_pConnection )
+		{
+			while( p_pConnection->m_PendingTasks.load( ) != 0 )
+			{
+				ReleaseTask( p_pConnection, PopTask( p_pConnection ) );
+				p_pConnection->m_PendingTasks.fetch_sub( 1 );
+			}
+		}
+
+		void ConnectionWorkerPool::ExecuteTasks( Connection * p_pConnection )
+		{
+			SizeType executed = 0;
+
+			while( true )
+			{
+				// Pop the next task, the push may still be in progress.
+				Task * pTask = PopTask( p_pConnection );
+
+				// Execute the task.
+				if( pTask->Type == Task::Packet )
+				{
+					p_pConnection->HandleReceivedData( pTask->pItem );
+					m_TaskPool.Return( pTask->pPoolItem );
+				}
+				else if( pTask->Type == Task::Tick )
+				{
+					p_pConnection->HandleTick( );
+				}
+				else
+				{
+					// The removing thread owns the connection from now on.
+					// Do not touch the connection after this point.
+					m_RemoveEvent.Set( );
+					return;
+				}
+
+				// The connection is idle and can be scheduled by the next post.
+				// Do not touch the connection after this point.
+				if( p_pConnection->m_PendingTasks.fetch_sub( 1 ) == 1 )
+				{
+					return;
+				}
+
+				// Let other connections run.
+				if( ++executed == m_TaskBatchSize )
+				{
+					Schedule( p_pConnection );
+					return;
+				}
+			}
+		}
+
+	}
+
+}
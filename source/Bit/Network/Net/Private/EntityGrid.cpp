@@ -0,0 +1,274 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Private/EntityGrid.hpp>
+#include <cmath>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		// Global variables
+		static const Int32 g_CoordinateBits = 21;
+		static const Int32 g_MaxCoordinate = (1 << (g_CoordinateBits - 1)) - 1;
+		static const Uint64 g_CoordinateMask = (1ULL << g_CoordinateBits) - 1ULL;
+
+		// Entity grid class
+		EntityGrid::EntityGrid( const Float32 p_CellSize ) :
+			m_CellSize( p_CellSize > 0.0f ? p_CellSize : 64.0f ),
+			m_InvCellSize( 1.0f / m_CellSize ),
+			m_Size( 0 )
+		{
+		}
+
+		void EntityGrid::SetCellSize( const Float32 p_CellSize )
+		{
+			if( p_CellSize <= 0.0f || p_CellSize == m_CellSize )
+			{
+				return;
+			}
+
+			m_CellSize = p_CellSize;
+			m_InvCellSize = 1.0f / p_CellSize;
+
+			// Rebucket all the entities.
+			m_Cells.clear( );
+			for( SizeType i = 0; i < m_Nodes.size( ); i++ )
+			{
+				if( m_Nodes[ i ].Used )
+				{
+					AddToCell( static_cast<Uint16>( i ), m_Nodes[ i ] );
+				}
+			}
+		}
+
+		Float32 EntityGrid::GetCellSize( ) const
+		{
+			return m_CellSize;
+		}
+
+		void EntityGrid::Set( const Uint16 p_EntityId, const Vector3f32 & p_Position )
+		{
+			if( p_EntityId >= m_Nodes.size( ) )
+			{
+				Node node;
+				node.Cell = 0;
+				node.Index = 0;
+				node.Used = false;
+				m_Nodes.resize( static_cast<SizeType>( p_EntityId ) + 1, node );
+			}
+
+			Node & node = m_Nodes[ p_EntityId ];
+			node.Position = p_Position;
+
+			const Uint64 cell = GetCellKey(	GetCoordinate( p_Position.x ),
+											GetCoordinate( p_Position.y ),
+											GetCoordinate( p_Position.z ) );
+
+			// Only rebucket the entity if it crossed a cell border.
+			if( node.Used )
+			{
+				if( node.Cell == cell )
+				{
+					return;
+				}
+
+				RemoveFromCell( node );
+			}
+			else
+			{
+				node.Used = true;
+				m_Size++;
+			}
+
+			AddToCell( p_EntityId, node );
+		}
+
+		Bool EntityGrid::Remove( const Uint16 p_EntityId )
+		{
+			if( p_EntityId >= m_Nodes.size( ) || m_Nodes[ p_EntityId ].Used == false )
+			{
+				return false;
+			}
+
+			Node & node = m_Nodes[ p_EntityId ];
+			RemoveFromCell( node );
+			node.Used = false;
+			m_Size--;
+
+			return true;
+		}
+
+		Bool EntityGrid::GetPosition( const Uint16 p_EntityId, Vector3f32 & p_Position ) const
+		{
+			if( p_EntityId >= m_Nodes.size( ) || m_Nodes[ p_EntityId ].Used == false )
+			{
+				return false;
+			}
+
+			p_Position = m_Nodes[ p_EntityId ].Position;
+			return true;
+		}
+
+		void EntityGrid::Query(	const Vector3f32 & p_Position,
+								const Float32 p_Radius,
+								std::vector<Uint16> & p_Entities ) const
+		{
+			if( p_Radius < 0.0f || m_Size == 0 )
+			{
+				return;
+			}
+
+			const Float32 radiusSquared = p_Radius * p_Radius;
+
+			// Get the range of cells overlapping the bounding box of the sphere.
+			const Int32 minX = GetCoordinate( p_Position.x - p_Radius );
+			const Int32 minY = GetCoordinate( p_Position.y - p_Radius );
+			const Int32 minZ = GetCoordinate( p_Position.z - p_Radius );
+			const Int32 maxX = GetCoordinate( p_Position.x + p_Radius );
+			const Int32 maxY = GetCoordinate( p_Position.y + p_Radius );
+			const Int32 maxZ = GetCoordinate( p_Position.z + p_Radius );
+
+			const Uint64 cellCount =	static_cast<Uint64>( maxX - minX + 1 ) *
+										static_cast<Uint64>( maxY - minY + 1 ) *
+										static_cast<Uint64>( maxZ - minZ + 1 );
+
+			// Go through the non-empty cells instead, if there are fewer of them.
+			if( cellCount > static_cast<Uint64>( m_Cells.size( ) ) )
+			{
+				for( CellMap::const_iterator it = m_Cells.begin( ); it != m_Cells.end( ); it++ )
+				{
+					const EntityVector & entities = it->second;
+					for( EntityVector::const_iterator it2 = entities.begin( ); it2 != entities.end( ); it2++ )
+					{
+						const Vector3f32 diff = m_Nodes[ *it2 ].Position - p_Position;
+						if( diff.x * diff.x + diff.y * diff.y + diff.z * diff.z <= radiusSquared )
+						{
+							p_Entities.push_back( *it2 );
+						}
+					}
+				}
+
+				return;
+			}
+
+			for( Int32 z = minZ; z <= maxZ; z++ )
+			{
+				for( Int32 y = minY; y <= maxY; y++ )
+				{
+					for( Int32 x = minX; x <= maxX; x++ )
+					{
+						CellMap::const_iterator it = m_Cells.find( GetCellKey( x, y, z ) );
+						if( it == m_Cells.end( ) )
+						{
+							continue;
+						}
+
+						const EntityVector & entities = it->second;
+						for( EntityVector::const_iterator it2 = entities.begin( ); it2 != entities.end( ); it2++ )
+						{
+							const Vector3f32 diff = m_Nodes[ *it2 ].Position - p_Position;
+							if( diff.x * diff.x + diff.y * diff.y + diff.z * diff.z <= radiusSquared )
+							{
+								p_Entities.push_back( *it2 );
+							}
+						}
+					}
+				}
+			}
+		}
+
+		SizeType EntityGrid::GetSize( ) const
+		{
+			return m_Size;
+		}
+
+		void EntityGrid::Clear( )
+		{
+			m_Nodes.clear( );
+			m_Cells.clear( );
+			m_Size = 0;
+		}
+
+		Int32 EntityGrid::GetCoordinate( const Float32 p_Value ) const
+		{
+			const Float32 coordinate = std::floor( p_Value * m_InvCellSize );
+
+			// Clamp the coordinate, also taking care of nan.
+			if( !( coordinate >= static_cast<Float32>( -g_MaxCoordinate ) ) )
+			{
+				return -g_MaxCoordinate;
+			}
+			if( coordinate > static_cast<Float32>( g_MaxCoordinate ) )
+			{
+				return g_MaxCoordinate;
+			}
+
+			return static_cast<Int32>( coordinate );
+		}
+
+		Uint64 EntityGrid::GetCellKey( const Int32 p_X, const Int32 p_Y, const Int32 p_Z )
+		{
+			return	( static_cast<Uint64>( p_X + g_MaxCoordinate ) & g_CoordinateMask ) |
+					( ( static_cast<Uint64>( p_Y + g_MaxCoordinate ) & g_CoordinateMask ) << g_CoordinateBits ) |
+					( ( static_cast<Uint64>( p_Z + g_MaxCoordinate ) & g_CoordinateMask ) << ( g_CoordinateBits * 2 ) );
+		}
+
+		void EntityGrid::AddToCell( const Uint16 p_EntityId, Node & p_Node )
+		{
+			p_Node.Cell = GetCellKey(	GetCoordinate( p_Node.Position.x ),
+										GetCoordinate( p_Node.Position.y ),
+										GetCoordinate( p_Node.Position.z ) );
+
+			EntityVector & entities = m_Cells[ p_Node.Cell ];
+			p_Node.Index = static_cast<Uint32>( entities.size( ) );
+			entities.push_back( p_EntityId );
+		}
+
+		void EntityGrid::RemoveFromCell( const Node & p_Node )
+		{
+			CellMap::iterator it = m_Cells.find( p_Node.Cell );
+			if( it == m_Cells.end( ) )
+			{
+				return;
+			}
+
+			// Move the last entity of the cell into the hole.
+			EntityVector & entities = it->second;
+			const Uint16 lastId = entities.back( );
+			entities[ p_Node.Index ] = lastId;
+			m_Nodes[ lastId ].Index = p_Node.Index;
+			entities.pop_back( );
+
+			if( entities.empty( ) )
+			{
+				m_Cells.erase( it );
+			}
+		}
+
+	}
+
+}
@@ -0,0 +1,108 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Private/EntityInterest.hpp>
+#include <algorithm>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		// View structure
+		EntityInterest::View::View( ) :
+			Enabled( false ),
+			Position( 0.0f, 0.0f, 0.0f ),
+			Radius( 0.0f )
+		{
+		}
+
+		EntityInterest::View::View( const Vector3f32 & p_Position, const Float32 p_Radius ) :
+			Enabled( true ),
+			Position( p_Position ),
+			Radius( p_Radius )
+		{
+		}
+
+		// Entity interest class
+		EntityInterest::EntityInterest( )
+		{
+			Clear( );
+		}
+
+		EntityInterest::EntityVersionVector & EntityInterest::Add( const Uint16 p_SnapshotId )
+		{
+			const SizeType index = static_cast<SizeType>( p_SnapshotId ) % Capacity;
+
+			m_SnapshotIds[ index ] = static_cast<Int32>( p_SnapshotId );
+			m_Versions[ index ].clear( );
+
+			return m_Versions[ index ];
+		}
+
+		const EntityInterest::EntityVersionVector * EntityInterest::Get( const Uint16 p_SnapshotId ) const
+		{
+			const SizeType index = static_cast<SizeType>( p_SnapshotId ) % Capacity;
+
+			if( m_SnapshotIds[ index ] != static_cast<Int32>( p_SnapshotId ) )
+			{
+				return NULL;
+			}
+
+			return &m_Versions[ index ];
+		}
+
+		Int32 EntityInterest::Find( const EntityVersionVector & p_Versions, const Uint16 p_EntityId )
+		{
+			EntityVersion version;
+			version.EntityId = p_EntityId;
+			version.SnapshotId = 0;
+
+			EntityVersionVector::const_iterator it = std::lower_bound(	p_Versions.begin( ), p_Versions.end( ), version,
+																		[]( const EntityVersion & p_A, const EntityVersion & p_B )
+																		{
+																			return p_A.EntityId < p_B.EntityId;
+																		} );
+
+			if( it == p_Versions.end( ) || it->EntityId != p_EntityId )
+			{
+				return -1;
+			}
+
+			return static_cast<Int32>( it->SnapshotId );
+		}
+
+		void EntityInterest::Clear( )
+		{
+			for( SizeType i = 0; i < Capacity; i++ )
+			{
+				m_SnapshotIds[ i ] = -1;
+				m_Versions[ i ].clear( );
+			}
+		}
+
+	}
+
+}
@@ -0,0 +1,237 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Private/EntitySnapshot.hpp>
+#include <cstring>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		// Entity snapshot class
+		EntitySnapshot::EntitySnapshot( const Uint16 p_Id ) :
+			m_Id( p_Id )
+		{
+		}
+
+		Uint16 EntitySnapshot::GetId( ) const
+		{
+			return m_Id;
+		}
+
+		Uint8 * EntitySnapshot::AddEntity( const Uint16 p_EntityId, const Uint32 p_ClassId, const SizeType p_Size )
+		{
+			// Make sure that the entity isn't already added.
+			EntityStateMap::iterator it = m_Entities.find( p_EntityId );
+			if( it != m_Entities.end( ) )
+			{
+				return NULL;
+			}
+
+			EntityState state;
+			state.ClassId = p_ClassId;
+			state.Offset = static_cast<SizeType>( m_Data.size( ) );
+			state.Size = p_Size;
+			m_Entities.insert( it, EntityStateMap::value_type( p_EntityId, state ) );
+
+			// Make space for the state.
+			m_Data.resize( m_Data.size( ) + p_Size, 0 );
+			return m_Data.data( ) + state.Offset;
+		}
+
+		const EntitySnapshot::EntityState * EntitySnapshot::GetEntity( const Uint16 p_EntityId ) const
+		{
+			EntityStateMap::const_iterator it = m_Entities.find( p_EntityId );
+			if( it == m_Entities.end( ) )
+			{
+				return NULL;
+			}
+
+			return &it->second;
+		}
+
+		const EntitySnapshot::EntityStateMap & EntitySnapshot::GetEntities( ) const
+		{
+			return m_Entities;
+		}
+
+		const Uint8 * EntitySnapshot::GetData( const EntityState & p_State ) const
+		{
+			return m_Data.data( ) + p_State.Offset;
+		}
+
+		Bool EntitySnapshot::EncodeDelta(	const Uint8 * p_pBaseline,
+											const Uint8 * p_pState,
+											const SizeType p_Size,
+											std::vector<Uint8> & p_Delta )
+		{
+			const SizeType startSize = static_cast<SizeType>( p_Delta.size( ) );
+			SizeType pos = 0;
+
+			while( pos < p_Size )
+			{
+				// Count the unchanged bytes.
+				SizeType unchanged = 0;
+				while( pos + unchanged < p_Size && unchanged < 255 &&
+					   p_pBaseline[ pos + unchanged ] == p_pState[ pos + unchanged ] )
+				{
+					unchanged++;
+				}
+
+				// Count the changed bytes.
+				const SizeType changedPos = pos + unchanged;
+				SizeType changed = 0;
+				while( changedPos + changed < p_Size && changed < 255 &&
+					   p_pBaseline[ changedPos + changed ] != p_pState[ changedPos + changed ] )
+				{
+					changed++;
+				}
+
+				// Leave out the trailing unchanged bytes.
+				if( changed == 0 && changedPos == p_Size )
+				{
+					break;
+				}
+
+				// Add the run.
+				p_Delta.push_back( static_cast<Uint8>( unchanged ) );
+				p_Delta.push_back( static_cast<Uint8>( changed ) );
+				for( SizeType i = 0; i < changed; i++ )
+				{
+					p_Delta.push_back( p_pBaseline[ changedPos + i ] ^ p_pState[ changedPos + i ] );
+				}
+
+				pos = changedPos + changed;
+			}
+
+			return p_Delta.size( ) != startSize;
+		}
+
+		Bool EntitySnapshot::DecodeDelta(	const Uint8 * p_pBaseline,
+											const Uint8 * p_pDelta,
+											const SizeType p_DeltaSize,
+											Uint8 * p_pState,
+											const SizeType p_Size )
+		{
+			// Start from the baseline.
+			memcpy( p_pState, p_pBaseline, p_Size );
+
+			SizeType deltaPos = 0;
+			SizeType pos = 0;
+			while( deltaPos < p_DeltaSize )
+			{
+				// Error check the run header.
+				if( deltaPos + 2 > p_DeltaSize )
+				{
+					return false;
+				}
+
+				const SizeType unchanged = p_pDelta[ deltaPos ];
+				const SizeType changed = p_pDelta[ deltaPos + 1 ];
+				deltaPos += 2;
+
+				// Error check the run.
+				pos += unchanged;
+				if( pos + changed > p_Size || deltaPos + changed > p_DeltaSize )
+				{
+					return false;
+				}
+
+				// XOR the changed bytes.
+				for( SizeType i = 0; i < changed; i++ )
+				{
+					p_pState[ pos + i ] ^= p_pDelta[ deltaPos + i ];
+				}
+
+				pos += changed;
+				deltaPos += changed;
+			}
+
+			return true;
+		}
+
+		Bool EntitySnapshot::IsNewer( const Uint16 p_Id, const Uint16 p_Than )
+		{
+			return p_Id != p_Than && static_cast<Uint16>( p_Id - p_Than ) < 32768;
+		}
+
+		// Entity snapshot history class
+		EntitySnapshotHistory::EntitySnapshotHistory( ) :
+			m_pLatest( NULL )
+		{
+			memset( m_pSnapshots, 0, sizeof( m_pSnapshots ) );
+		}
+
+		EntitySnapshotHistory::~EntitySnapshotHistory( )
+		{
+			Clear( );
+		}
+
+		void EntitySnapshotHistory::Add( EntitySnapshot * p_pSnapshot )
+		{
+			EntitySnapshot *& pSlot = m_pSnapshots[ p_pSnapshot->GetId( ) % Capacity ];
+			if( pSlot )
+			{
+				delete pSlot;
+			}
+
+			pSlot = p_pSnapshot;
+			m_pLatest = p_pSnapshot;
+		}
+
+		const EntitySnapshot * EntitySnapshotHistory::Get( const Uint16 p_Id ) const
+		{
+			EntitySnapshot * pSnapshot = m_pSnapshots[ p_Id % Capacity ];
+			if( pSnapshot == NULL || pSnapshot->GetId( ) != p_Id )
+			{
+				return NULL;
+			}
+
+			return pSnapshot;
+		}
+
+		const EntitySnapshot * EntitySnapshotHistory::GetLatest( ) const
+		{
+			return m_pLatest;
+		}
+
+		void EntitySnapshotHistory::Clear( )
+		{
+			for( SizeType i = 0; i < Capacity; i++ )
+			{
+				if( m_pSnapshots[ i ] )
+				{
+					delete m_pSnapshots[ i ];
+					m_pSnapshots[ i ] = NULL;
+				}
+			}
+
+			m_pLatest = NULL;
+		}
+
+	}
+
+}
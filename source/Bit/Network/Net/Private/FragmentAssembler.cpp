@@ -0,0 +1,279 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Private/FragmentAssembler.hpp>
+#include <Bit/Network/Socket.hpp>
+#include <Bit/System/Log.hpp>
+#include <cstring>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		// Fragment assembler budget class
+		FragmentAssembler::Budget::Budget( const SizeType p_Size ) :
+			m_Size( p_Size ),
+			m_Used( 0 )
+		{
+		}
+
+		Bool FragmentAssembler::Budget::Acquire( const SizeType p_Size )
+		{
+			SizeType used = m_Used.load( );
+			do
+			{
+				if( used + p_Size > m_Size )
+				{
+					return false;
+				}
+			}
+			while( m_Used.compare_exchange_weak( used, used + p_Size ) == false );
+
+			return true;
+		}
+
+		void FragmentAssembler::Budget::Release( const SizeType p_Size )
+		{
+			m_Used.fetch_sub( p_Size );
+		}
+
+		// Fragment assembler class
+		FragmentAssembler::FragmentAssembler(	const SizeType p_MaxMessageSize,
+												const SizeType p_BufferSize,
+												Budget * p_pBudget,
+												const Time & p_Timeout ) :
+			m_MaxMessageSize( p_MaxMessageSize ),
+			m_BufferSize( p_BufferSize ),
+			m_pBudget( p_pBudget ),
+			m_Timeout( p_Timeout ),
+			m_BufferedSize( 0 ),
+			m_NextExpireTime( Time::Zero )
+		{
+			m_Timer.Start( );
+		}
+
+		FragmentAssembler::~FragmentAssembler( )
+		{
+			Clear( );
+		}
+
+		FragmentAssembler::Result::eResult FragmentAssembler::AddFragment(	const Uint8 * p_pData,
+																			const SizeType p_DataSize,
+																			Uint8 & p_MessageType,
+																			std::vector<Uint8> & p_Message )
+		{
+			// Error check the size of the fragment.
+			if( p_DataSize <= FragmentHeaderSize || p_DataSize > FragmentHeaderSize + FragmentDataSize )
+			{
+				return Result::Rejected;
+			}
+
+			// Read the fragment header.
+			Uint16 messageId = 0;
+			Uint16 fragmentIndex = 0;
+			Uint16 fragmentCount = 0;
+			const Uint8 messageType = p_pData[ 0 ];
+			memcpy( &messageId, p_pData + 1, 2 );
+			memcpy( &fragmentIndex, p_pData + 3, 2 );
+			memcpy( &fragmentCount, p_pData + 5, 2 );
+			messageId = Ntoh16( messageId );
+			fragmentIndex = Ntoh16( fragmentIndex );
+			fragmentCount = Ntoh16( fragmentCount );
+			const SizeType dataSize = p_DataSize - FragmentHeaderSize;
+
+			// Error check the fragment index and size, all fragments but the last one are full.
+			if( fragmentCount < 2 || fragmentIndex >= fragmentCount ||
+				( fragmentIndex + 1 < fragmentCount && dataSize != FragmentDataSize ) )
+			{
+				return Result::Rejected;
+			}
+
+			// Drop the messages not completed in time, at most once a second unless the buffer is full.
+			const Time time = m_Timer.GetLapsedTime( );
+			if( time >= m_NextExpireTime )
+			{
+				Expire( time );
+			}
+
+			// Find the message, or create it if there's room for it.
+			Message * pMessage = NULL;
+			MessageMap::iterator it = m_Messages.find( messageId );
+			if( it != m_Messages.end( ) )
+			{
+				pMessage = it->second;
+
+				// Make sure that the fragment belongs to the message.
+				if( pMessage->Type != messageType || pMessage->FragmentCount != fragmentCount )
+				{
+					return Result::Rejected;
+				}
+
+				// Ignore resent fragments.
+				if( pMessage->Received[ fragmentIndex ] )
+				{
+					return Result::Added;
+				}
+			}
+			else
+			{
+				// Compare fragment counts, the size of the last fragment is unknown until it arrives.
+				if( fragmentCount > GetFragmentCount( m_MaxMessageSize ) )
+				{
+					return Result::Rejected;
+				}
+
+				const SizeType maxSize = static_cast<SizeType>( fragmentCount ) * FragmentDataSize;
+
+				// Make room by dropping the expired messages, the messages in progress are kept,
+				// their received fragments are acknowledged and would never be resent.
+				if( Acquire( maxSize ) == false )
+				{
+					Expire( time );
+					if( Acquire( maxSize ) == false )
+					{
+						return Result::Rejected;
+					}
+				}
+
+				pMessage = new Message;
+				pMessage->Type = messageType;
+				pMessage->FragmentCount = fragmentCount;
+				pMessage->ReceivedCount = 0;
+				pMessage->LastSize = 0;
+				pMessage->Data.resize( maxSize );
+				pMessage->Received.resize( fragmentCount, false );
+				m_Messages.insert( it, MessageMap::value_type( messageId, pMessage ) );
+			}
+
+			// Copy the fragment data to the message.
+			memcpy( pMessage->Data.data( ) + static_cast<SizeType>( fragmentIndex ) * FragmentDataSize, p_pData + FragmentHeaderSize, dataSize );
+			pMessage->Received[ fragmentIndex ] = true;
+			pMessage->ReceivedCount++;
+			pMessage->LastTime = time;
+			if( fragmentIndex + 1 == fragmentCount )
+			{
+				pMessage->LastSize = dataSize;
+			}
+
+			if( pMessage->ReceivedCount < fragmentCount )
+			{
+				return Result::Added;
+			}
+
+			// The message is complete, hand it over.
+			Release( pMessage->Data.size( ) );
+			pMessage->Data.resize( static_cast<SizeType>( fragmentCount - 1 ) * FragmentDataSize + pMessage->LastSize );
+			p_MessageType = pMessage->Type;
+			p_Message.swap( pMessage->Data );
+
+			m_Messages.erase( messageId );
+			delete pMessage;
+
+			return Result::Completed;
+		}
+
+		void FragmentAssembler::Clear( )
+		{
+			for( MessageMap::iterator it = m_Messages.begin( ); it != m_Messages.end( ); it++ )
+			{
+				Release( it->second->Data.size( ) );
+				delete it->second;
+			}
+			m_Messages.clear( );
+		}
+
+		Uint16 FragmentAssembler::GetFragmentCount( const SizeType p_MessageSize )
+		{
+			return static_cast<Uint16>( ( p_MessageSize + FragmentDataSize - 1 ) / FragmentDataSize );
+		}
+
+		void FragmentAssembler::Expire( const Time & p_Time )
+		{
+			m_NextExpireTime = p_Time + Seconds( 1.0f );
+
+			MessageMap::iterator it = m_Messages.begin( );
+			while( it != m_Messages.end( ) )
+			{
+				Message * pMessage = it->second;
+				if( p_Time - pMessage->LastTime < m_Timeout )
+				{
+					it++;
+					continue;
+				}
+
+				bitLogNetWarn( "Fragmented message timed out: " << it->first << ", " << pMessage->ReceivedCount << " of " << pMessage->FragmentCount << " fragments received." );
+
+				Release( pMessage->Data.size( ) );
+				delete pMessage;
+				m_Messages.erase( it++ );
+			}
+		}
+
+		Bool FragmentAssembler::Acquire( const SizeType p_Size )
+		{
+			if( m_BufferedSize + p_Size > m_BufferSize )
+			{
+				return false;
+			}
+
+			if( m_pBudget && m_pBudget->Acquire( p_Size ) == false )
+			{
+				return false;
+			}
+
+			m_BufferedSize += p_Size;
+			return true;
+		}
+
+		void FragmentAssembler::Release( const SizeType p_Size )
+		{
+			m_BufferedSize -= p_Size;
+
+			if( m_pBudget )
+			{
+				m_pBudget->Release( p_Size );
+			}
+		}
+
+		void FragmentAssembler::WriteHeader(	Uint8 * p_pHeader,
+												const Uint8 p_MessageType,
+												const Uint16 p_MessageId,
+												const Uint16 p_FragmentIndex,
+												const Uint16 p_FragmentCount )
+		{
+			const Uint16 messageId = Hton16( p_MessageId );
+			const Uint16 fragmentIndex = Hton16( p_FragmentIndex );
+			const Uint16 fragmentCount = Hton16( p_FragmentCount );
+
+			p_pHeader[ 0 ] = p_MessageType;
+			memcpy( p_pHeader + 1, &messageId, 2 );
+			memcpy( p_pHeader + 3, &fragmentIndex, 2 );
+			memcpy( p_pHeader + 5, &fragmentCount, 2 );
+		}
+
+	}
+
+}
@@ -0,0 +1,177 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Private/InterpolationBatch.hpp>
+#include <Bit/Network/Net/Variable.hpp>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		InterpolationBatch::InterpolationBatch( ) :
+			m_Components( 1 ),
+			m_Mode( InterpolationMode::Linear )
+		{
+		}
+
+		void InterpolationBatch::Clear( const SizeType p_Components, const InterpolationMode::eMode p_Mode )
+		{
+			m_Components = p_Components < MaxComponents ? p_Components : MaxComponents;
+			m_Mode = p_Mode;
+
+			m_Variables.clear( );
+			m_Snapshots.clear( );
+			m_Factors.clear( );
+			for( SizeType c = 0; c < MaxComponents; c++ )
+			{
+				m_From[ c ].clear( );
+				m_To[ c ].clear( );
+				m_FromTangents[ c ].clear( );
+				m_ToTangents[ c ].clear( );
+			}
+		}
+
+		void InterpolationBatch::Add(	VariableBase * p_pVariable,
+										Float32 * p_pSnapshot,
+										const Float32 * p_pFrom,
+										const Float32 * p_pTo,
+										const Float32 * p_pFromTangent,
+										const Float32 * p_pToTangent,
+										const Float32 p_Factor )
+		{
+			m_Variables.push_back( p_pVariable );
+			m_Snapshots.push_back( p_pSnapshot );
+			m_Factors.push_back( p_Factor );
+
+			for( SizeType c = 0; c < m_Components; c++ )
+			{
+				m_From[ c ].push_back( p_pFrom[ c ] );
+				m_To[ c ].push_back( p_pTo[ c ] );
+			}
+
+			// The tangents are only used by the hermite curve.
+			if( m_Mode == InterpolationMode::Hermite )
+			{
+				for( SizeType c = 0; c < m_Components; c++ )
+				{
+					m_FromTangents[ c ].push_back( p_pFromTangent[ c ] );
+					m_ToTangents[ c ].push_back( p_pToTangent[ c ] );
+				}
+			}
+		}
+
+		void InterpolationBatch::Evaluate( )
+		{
+			const SizeType count = m_Variables.size( );
+			if( count == 0 )
+			{
+				return;
+			}
+
+			const Float32 * pFactors = m_Factors.data( );
+
+			if( m_Mode == InterpolationMode::Hermite )
+			{
+				// Calculate the basis weights once for all the components.
+				for( SizeType k = 0; k < 4; k++ )
+				{
+					m_Weights[ k ].resize( count );
+				}
+
+				Float32 * pH00 = m_Weights[ 0 ].data( );
+				Float32 * pH10 = m_Weights[ 1 ].data( );
+				Float32 * pH01 = m_Weights[ 2 ].data( );
+				Float32 * pH11 = m_Weights[ 3 ].data( );
+
+				for( SizeType i = 0; i < count; i++ )
+				{
+					const Float32 t = pFactors[ i ];
+					const Float32 t2 = t * t;
+					const Float32 t3 = t2 * t;
+
+					pH00[ i ] = 2.0f * t3 - 3.0f * t2 + 1.0f;
+					pH10[ i ] = t3 - 2.0f * t2 + t;
+					pH01[ i ] = 3.0f * t2 - 2.0f * t3;
+					pH11[ i ] = t3 - t2;
+				}
+
+				for( SizeType c = 0; c < m_Components; c++ )
+				{
+					m_Results[ c ].resize( count );
+
+					const Float32 * pFrom = m_From[ c ].data( );
+					const Float32 * pTo = m_To[ c ].data( );
+					const Float32 * pFromTangent = m_FromTangents[ c ].data( );
+					const Float32 * pToTangent = m_ToTangents[ c ].data( );
+					Float32 * pResult = m_Results[ c ].data( );
+
+					for( SizeType i = 0; i < count; i++ )
+					{
+						pResult[ i ] =	pH00[ i ] * pFrom[ i ] + pH10[ i ] * pFromTangent[ i ] +
+										pH01[ i ] * pTo[ i ] + pH11[ i ] * pToTangent[ i ];
+					}
+				}
+			}
+			else
+			{
+				for( SizeType c = 0; c < m_Components; c++ )
+				{
+					m_Results[ c ].resize( count );
+
+					const Float32 * pFrom = m_From[ c ].data( );
+					const Float32 * pTo = m_To[ c ].data( );
+					Float32 * pResult = m_Results[ c ].data( );
+
+					for( SizeType i = 0; i < count; i++ )
+					{
+						pResult[ i ] = pFrom[ i ] + ( pTo[ i ] - pFrom[ i ] ) * pFactors[ i ];
+					}
+				}
+			}
+
+			// Publish the snapshot values.
+			for( SizeType i = 0; i < count; i++ )
+			{
+				VariableBase * pVariable = m_Variables[ i ];
+				Float32 * pSnapshot = m_Snapshots[ i ];
+
+				const Uint32 sequence = pVariable->BeginWrite( );
+				for( SizeType c = 0; c < m_Components; c++ )
+				{
+					pSnapshot[ c ] = m_Results[ c ][ i ];
+				}
+				pVariable->EndWrite( sequence );
+			}
+		}
+
+		SizeType InterpolationBatch::GetSize( ) const
+		{
+			return m_Variables.size( );
+		}
+
+	}
+
+}
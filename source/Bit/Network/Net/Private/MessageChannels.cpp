@@ -0,0 +1,246 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Private/MessageChannels.hpp>
+#include <Bit/Network/Net/Private/NetPacket.hpp>
+#include <Bit/Network/Socket.hpp>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		MessageChannels::MessageChannels( const SizeType p_MaxBufferedCount, const SizeType p_MaxBufferedSize ) :
+			m_MaxBufferedCount( p_MaxBufferedCount ),
+			m_MaxBufferedSize( p_MaxBufferedSize )
+		{
+			for( SizeType i = 0; i < MaxChannelCount; i++ )
+			{
+				m_Channels[ i ].Delivery = DeliveryType::ReliableOrdered;
+			}
+
+			Clear( );
+		}
+
+		void MessageChannels::Clear( )
+		{
+			for( SizeType i = 0; i < MaxChannelCount; i++ )
+			{
+				Channel & channel = m_Channels[ i ];
+				channel.SendSequence = 0;
+				channel.NextSequence = 0;
+				channel.HasSequence = false;
+				channel.LastSequence = 0;
+				channel.Buffered.clear( );
+				channel.OrderingDelay = 0;
+			}
+
+			m_BufferedCount = 0;
+			m_BufferedSize = 0;
+		}
+
+		Bool MessageChannels::SetDelivery( const Uint8 p_Channel, const DeliveryType::eType p_Delivery )
+		{
+			if( p_Channel >= MaxChannelCount )
+			{
+				return false;
+			}
+
+			m_Channels[ p_Channel ].Delivery = p_Delivery;
+			return true;
+		}
+
+		DeliveryType::eType MessageChannels::GetDelivery( const Uint8 p_Channel ) const
+		{
+			if( p_Channel >= MaxChannelCount )
+			{
+				return DeliveryType::Unreliable;
+			}
+
+			return m_Channels[ p_Channel ].Delivery;
+		}
+
+		Bool MessageChannels::GetNextMessage( const Uint8 p_Channel, Uint8 & p_ChannelByte, Uint16 & p_Sequence )
+		{
+			Channel & channel = m_Channels[ p_Channel & ChannelIndexMask ];
+
+			p_ChannelByte = static_cast<Uint8>( channel.Delivery << ChannelDeliveryShift ) | ( p_Channel & ChannelIndexMask );
+
+			// Only the sequenced and ordered channels are using the sequence.
+			p_Sequence = 0;
+			if( channel.Delivery == DeliveryType::UnreliableSequenced ||
+				channel.Delivery == DeliveryType::ReliableOrdered )
+			{
+				p_Sequence = channel.SendSequence;
+				channel.SendSequence++;
+			}
+
+			return	channel.Delivery == DeliveryType::ReliableUnordered ||
+					channel.Delivery == DeliveryType::ReliableOrdered;
+		}
+
+		MessageChannels::Result::eResult MessageChannels::Receive(	const Uint8 p_ChannelByte,
+																	const Uint16 p_Sequence,
+																	const Uint8 * p_pData,
+																	const SizeType p_DataSize )
+		{
+			Channel & channel = m_Channels[ p_ChannelByte & ChannelIndexMask ];
+
+			switch( p_ChannelByte >> ChannelDeliveryShift )
+			{
+				// The duplicates are already removed by the sequence manager.
+				case DeliveryType::Unreliable:
+				case DeliveryType::ReliableUnordered:
+				{
+					return Result::Deliver;
+				}
+				// Drop the messages older than the last delivered one.
+				case DeliveryType::UnreliableSequenced:
+				{
+					const Uint16 distance = p_Sequence - channel.LastSequence;
+					if( channel.HasSequence && ( distance == 0 || distance >= 0x8000 ) )
+					{
+						return Result::Dropped;
+					}
+
+					channel.HasSequence = true;
+					channel.LastSequence = p_Sequence;
+					return Result::Deliver;
+				}
+				// Buffer the messages arriving ahead of the next one.
+				case DeliveryType::ReliableOrdered:
+				{
+					const Uint16 distance = p_Sequence - channel.NextSequence;
+					if( distance == 0 )
+					{
+						channel.NextSequence++;
+						AddDelaySample( channel, 0 );
+						return Result::Deliver;
+					}
+
+					// Old messages are resent duplicates.
+					if( distance >= 0x8000 || channel.Buffered.find( p_Sequence ) != channel.Buffered.end( ) )
+					{
+						return Result::Dropped;
+					}
+
+					// The message is already acknowledged, it can't be dropped.
+					if( m_BufferedCount >= m_MaxBufferedCount || p_DataSize > m_MaxBufferedSize - m_BufferedSize )
+					{
+						return Result::Overflow;
+					}
+					m_BufferedCount++;
+					m_BufferedSize += p_DataSize;
+
+					BufferedMessage & message = channel.Buffered[ p_Sequence ];
+					message.Data.assign( p_pData, p_pData + p_DataSize );
+					message.WaitTimer.Start( );
+					return Result::Buffered;
+				}
+				default:
+				break;
+			}
+
+			return Result::Dropped;
+		}
+
+		Bool MessageChannels::PollBuffered( const Uint8 p_ChannelByte, std::vector<Uint8> & p_Message )
+		{
+			if( ( p_ChannelByte >> ChannelDeliveryShift ) != DeliveryType::ReliableOrdered )
+			{
+				return false;
+			}
+
+			Channel & channel = m_Channels[ p_ChannelByte & ChannelIndexMask ];
+			if( channel.Buffered.size( ) == 0 )
+			{
+				return false;
+			}
+
+			BufferedMessageMap::iterator it = channel.Buffered.find( channel.NextSequence );
+			if( it == channel.Buffered.end( ) )
+			{
+				return false;
+			}
+
+			AddDelaySample( channel, it->second.WaitTimer.GetLapsedTime( ).AsMicroseconds( ) );
+			m_BufferedCount--;
+			m_BufferedSize -= it->second.Data.size( );
+			p_Message.swap( it->second.Data );
+			channel.Buffered.erase( it );
+			channel.NextSequence++;
+			return true;
+		}
+
+		Time MessageChannels::GetOrderingDelay( const Uint8 p_Channel ) const
+		{
+			if( p_Channel >= MaxChannelCount )
+			{
+				return Microseconds( 0 );
+			}
+
+			return Microseconds( m_Channels[ p_Channel ].OrderingDelay );
+		}
+
+		SizeType MessageChannels::GetBufferedCount( const Uint8 p_Channel ) const
+		{
+			if( p_Channel >= MaxChannelCount )
+			{
+				return 0;
+			}
+
+			return m_Channels[ p_Channel ].Buffered.size( );
+		}
+
+		void MessageChannels::WriteChannel( Uint8 * p_pHeader, const Uint8 p_ChannelByte, const Uint16 p_Sequence )
+		{
+			const Uint16 sequence = Hton16( p_Sequence );
+
+			p_pHeader[ MessageChannelOffset ] = p_ChannelByte;
+			p_pHeader[ MessageChannelOffset + 1 ] = static_cast<Uint8>( sequence );
+			p_pHeader[ MessageChannelOffset + 2 ] = static_cast<Uint8>( sequence >> 8 );
+		}
+
+		Bool MessageChannels::ReadChannel( const Uint8 * p_pHeader, const SizeType p_DataSize, Uint8 & p_ChannelByte, Uint16 & p_Sequence )
+		{
+			if( p_DataSize < MessageHeaderSize )
+			{
+				return false;
+			}
+
+			p_ChannelByte = p_pHeader[ MessageChannelOffset ];
+			p_Sequence = Ntoh16(	static_cast<Uint16>( p_pHeader[ MessageChannelOffset + 1 ] ) |
+									static_cast<Uint16>( p_pHeader[ MessageChannelOffset + 2 ] ) << 8 );
+			return true;
+		}
+
+		void MessageChannels::AddDelaySample( Channel & p_Channel, const Uint64 p_Delay )
+		{
+			p_Channel.OrderingDelay = ( p_Channel.OrderingDelay * 7ULL + p_Delay ) / 8ULL;
+		}
+
+	}
+
+}
@@ -0,0 +1,192 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Private/MessageTable.hpp>
+#include <Bit/Network/Net/Private/NetPacket.hpp>
+#include <Bit/Network/Socket.hpp>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		Uint16 MessageTable::Add( const std::string & p_Name )
+		{
+			// Error check the name, the length is encoded in a single byte.
+			if( p_Name.size( ) == 0 || p_Name.size( ) > MaxMessageNameLength )
+			{
+				return NameMessageId;
+			}
+
+			// Return the id of already added messages.
+			IdMap::const_iterator it = m_Ids.find( p_Name );
+			if( it != m_Ids.end( ) )
+			{
+				return it->second;
+			}
+
+			// Make sure that the table isn't full.
+			if( m_Names.size( ) >= static_cast<SizeType>( NameMessageId ) )
+			{
+				return NameMessageId;
+			}
+
+			// Give the message the next id.
+			const Uint16 id = static_cast<Uint16>( m_Names.size( ) );
+			m_Names.push_back( p_Name );
+			m_Ids[ p_Name ] = id;
+			return id;
+		}
+
+		Uint16 MessageTable::Find( const std::string & p_Name ) const
+		{
+			IdMap::const_iterator it = m_Ids.find( p_Name );
+			if( it == m_Ids.end( ) )
+			{
+				return NameMessageId;
+			}
+
+			return it->second;
+		}
+
+		SizeType MessageTable::GetSize( ) const
+		{
+			return m_Names.size( );
+		}
+
+		void MessageTable::Clear( )
+		{
+			m_Names.clear( );
+			m_Ids.clear( );
+		}
+
+		void MessageTable::Encode( std::vector<Uint8> & p_Data, const Uint16 p_FirstId ) const
+		{
+			for( SizeType i = p_FirstId; i < m_Names.size( ); i++ )
+			{
+				const std::string & name = m_Names[ i ];
+				const Uint16 id = Hton16( static_cast<Uint16>( i ) );
+
+				p_Data.push_back( static_cast<Uint8>( id ) );
+				p_Data.push_back( static_cast<Uint8>( id >> 8 ) );
+				p_Data.push_back( static_cast<Uint8>( name.size( ) ) );
+				p_Data.insert( p_Data.end( ), name.begin( ), name.end( ) );
+			}
+		}
+
+		Bool MessageTable::Decode( const Uint8 * p_pData, const SizeType p_DataSize )
+		{
+			SizeType position = 0;
+			while( position < p_DataSize )
+			{
+				// Error check the message size.
+				if( position + 3 > p_DataSize )
+				{
+					return false;
+				}
+
+				const Uint16 id = Ntoh16( static_cast<Uint16>( p_pData[ position ] ) |
+										  static_cast<Uint16>( p_pData[ position + 1 ] ) << 8 );
+				const SizeType nameLength = static_cast<SizeType>( p_pData[ position + 2 ] );
+				position += 3;
+
+				if( id == NameMessageId || nameLength == 0 || position + nameLength > p_DataSize )
+				{
+					return false;
+				}
+
+				// Set the id of the message, the receiver decides the ids.
+				const std::string name( reinterpret_cast<const char *>( p_pData + position ), nameLength );
+				position += nameLength;
+
+				if( m_Names.size( ) <= static_cast<SizeType>( id ) )
+				{
+					m_Names.resize( static_cast<SizeType>( id ) + 1 );
+				}
+				m_Names[ id ] = name;
+				m_Ids[ name ] = id;
+			}
+
+			return true;
+		}
+
+		void MessageTable::WriteHeader( std::vector<Uint8> & p_Data, const Uint16 p_Id, const std::string & p_Name )
+		{
+			const Uint16 id = Hton16( p_Id );
+
+			// The channel is written at send.
+			p_Data.push_back( static_cast<Uint8>( eMessageType::UserMessageType ) );
+			p_Data.push_back( 0 );
+			p_Data.push_back( 0 );
+			p_Data.push_back( 0 );
+			p_Data.push_back( static_cast<Uint8>( id ) );
+			p_Data.push_back( static_cast<Uint8>( id >> 8 ) );
+
+			// Add the message name if the receiver hasn't told the id yet.
+			if( p_Id == NameMessageId )
+			{
+				p_Data.insert( p_Data.end( ), p_Name.begin( ), p_Name.end( ) );
+				p_Data.push_back( 0 );
+			}
+		}
+
+		Bool MessageTable::ReadHeader(	const Uint8 * p_pData, const SizeType p_DataSize,
+										Uint16 & p_Id, const char *& p_pName, SizeType & p_HeaderSize )
+		{
+			// Error check the header size.
+			if( p_DataSize < MessageHeaderSize )
+			{
+				return false;
+			}
+
+			p_Id = Ntoh16(	static_cast<Uint16>( p_pData[ MessageIdOffset ] ) |
+							static_cast<Uint16>( p_pData[ MessageIdOffset + 1 ] ) << 8 );
+			p_pName = NULL;
+			p_HeaderSize = MessageHeaderSize;
+
+			// Find the end of the message name.
+			if( p_Id == NameMessageId )
+			{
+				SizeType nameEnd = MessageHeaderSize;
+				while( nameEnd < p_DataSize && p_pData[ nameEnd ] != 0 )
+				{
+					nameEnd++;
+				}
+
+				if( nameEnd == p_DataSize || nameEnd == MessageHeaderSize )
+				{
+					return false;
+				}
+
+				p_pName = reinterpret_cast<const char *>( p_pData + MessageHeaderSize );
+				p_HeaderSize = nameEnd + 1;
+			}
+
+			return true;
+		}
+
+	}
+
+}
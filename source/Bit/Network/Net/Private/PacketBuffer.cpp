@@ -0,0 +1,85 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Private/PacketBuffer.hpp>
+#include <cstring>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		PacketBuffer * PacketBuffer::Create( const void * p_pData, const SizeType p_DataSize )
+		{
+			return new PacketBuffer( p_pData, p_DataSize );
+		}
+
+		void PacketBuffer::AddReference( )
+		{
+			m_References.fetch_add( 1, std::memory_order_relaxed );
+		}
+
+		void PacketBuffer::Release( )
+		{
+			// Delete the buffer when the last reference is released.
+			if( m_References.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+			{
+				delete this;
+			}
+		}
+
+		const Uint8 * PacketBuffer::GetData( ) const
+		{
+			return m_pData;
+		}
+
+		SizeType PacketBuffer::GetDataSize( ) const
+		{
+			return m_DataSize;
+		}
+
+		PacketBuffer::PacketBuffer( const void * p_pData, const SizeType p_DataSize ) :
+			m_pData( NULL ),
+			m_DataSize( p_DataSize ),
+			m_References( 1 )
+		{
+			if( m_DataSize )
+			{
+				m_pData = new Uint8[ m_DataSize ];
+				memcpy( m_pData, p_pData, m_DataSize );
+			}
+		}
+
+		PacketBuffer::~PacketBuffer( )
+		{
+			if( m_pData )
+			{
+				delete [ ] m_pData;
+			}
+		}
+
+	}
+
+}
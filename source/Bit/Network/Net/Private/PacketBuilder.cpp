@@ -0,0 +1,227 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Private/PacketBuilder.hpp>
+#include <Bit/Network/Socket.hpp>
+#include <cstring>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		// Packet builder class
+		PacketBuilder::PacketBuilder( ) :
+			m_HasAck( false ),
+			m_AckSequence( 0 ),
+			m_AckBits( 0 ),
+			m_AckPending( false ),
+			m_PendingBits( 0 )
+		{
+		}
+
+		PacketBuilder::AckResult::eResult PacketBuilder::AddAcknowledgement( const Uint16 p_Sequence )
+		{
+			// The very first reliable packet.
+			if( m_HasAck == false )
+			{
+				m_HasAck = true;
+				m_AckSequence = p_Sequence;
+				m_AckPending = true;
+				return AckResult::Added;
+			}
+
+			const Uint16 distance = static_cast<Uint16>( p_Sequence - m_AckSequence );
+
+			// Resent latest packet, acknowledge it again.
+			if( distance == 0 )
+			{
+				m_AckPending = true;
+				return AckResult::Added;
+			}
+
+			// Newer packet, shift the bitfield and make it the latest one.
+			if( distance < 32768 )
+			{
+				// Bit 0 of the extended bitfields is the current latest sequence.
+				const Uint64 bits = ( static_cast<Uint64>( m_AckBits ) << 1 ) | 1;
+				const Uint64 pendingBits = ( static_cast<Uint64>( m_PendingBits ) << 1 ) | ( m_AckPending ? 1 : 0 );
+
+				// Make sure that no unsent acknowledgement is shifted out of the bitfield.
+				if( distance > AckBitCount )
+				{
+					if( pendingBits )
+					{
+						return AckResult::Full;
+					}
+
+					m_AckBits = 0;
+					m_PendingBits = 0;
+				}
+				else
+				{
+					if( ( pendingBits << ( distance - 1 ) ) >> AckBitCount )
+					{
+						return AckResult::Full;
+					}
+
+					m_AckBits = static_cast<Uint32>( bits << ( distance - 1 ) );
+					m_PendingBits = static_cast<Uint32>( pendingBits << ( distance - 1 ) );
+				}
+
+				m_AckSequence = p_Sequence;
+				m_AckPending = true;
+				return AckResult::Added;
+			}
+
+			// Older packet, set its bit if it's within the bitfield.
+			const Uint16 age = static_cast<Uint16>( m_AckSequence - p_Sequence );
+			if( age > AckBitCount )
+			{
+				return AckResult::Old;
+			}
+
+			const Uint32 bit = 1U << ( age - 1 );
+			m_AckBits |= bit;
+			m_PendingBits |= bit;
+			return AckResult::Added;
+		}
+
+		Bool PacketBuilder::AddPacket(	const Uint8 * p_pHeader,
+										const SizeType p_HeaderSize,
+										const Uint8 * p_pData,
+										const SizeType p_DataSize )
+		{
+			const SizeType packetSize = p_HeaderSize + p_DataSize;
+			if( CoalescedPacketSize + m_Packets.size( ) + CoalescedSizeFieldSize + packetSize > MaxCoalescedPacketSize )
+			{
+				return false;
+			}
+
+			// Add the size and the packet.
+			const Uint16 size = Hton16( static_cast<Uint16>( packetSize ) );
+			const Uint8 * pSize = reinterpret_cast<const Uint8 *>( &size );
+			m_Packets.insert( m_Packets.end( ), pSize, pSize + CoalescedSizeFieldSize );
+			m_Packets.insert( m_Packets.end( ), p_pHeader, p_pHeader + p_HeaderSize );
+			if( p_DataSize )
+			{
+				m_Packets.insert( m_Packets.end( ), p_pData, p_pData + p_DataSize );
+			}
+
+			return true;
+		}
+
+		Bool PacketBuilder::Flush( std::vector<Uint8> & p_Packet )
+		{
+			// Nothing new to send.
+			if( m_Packets.size( ) == 0 && m_AckPending == false && m_PendingBits == 0 )
+			{
+				return false;
+			}
+
+			// Add the acknowledgement header, followed by the packets.
+			const Uint16 ackSequence = Hton16( m_AckSequence );
+			const Uint32 ackBits = Hton32( m_AckBits );
+			p_Packet.resize( CoalescedPacketSize );
+			p_Packet[ 0 ] = static_cast<Uint8>( PacketType::Coalesced );
+			p_Packet[ 1 ] = m_HasAck ? AckFlag : 0;
+			memcpy( p_Packet.data( ) + 2, &ackSequence, 2 );
+			memcpy( p_Packet.data( ) + 4, &ackBits, 4 );
+			p_Packet.insert( p_Packet.end( ), m_Packets.begin( ), m_Packets.end( ) );
+
+			m_Packets.clear( );
+			m_AckPending = false;
+			m_PendingBits = 0;
+
+			return true;
+		}
+
+		void PacketBuilder::Clear( )
+		{
+			m_Packets.clear( );
+			m_HasAck = false;
+			m_AckSequence = 0;
+			m_AckBits = 0;
+			m_AckPending = false;
+			m_PendingBits = 0;
+		}
+
+		Bool PacketBuilder::CanCoalesce( const SizeType p_PacketSize )
+		{
+			return CoalescedPacketSize + CoalescedSizeFieldSize + p_PacketSize <= MaxCoalescedPacketSize;
+		}
+
+		Bool PacketBuilder::ReadHeader(	const Uint8 * p_pData,
+										const SizeType p_DataSize,
+										Bool & p_HasAck,
+										Uint16 & p_AckSequence,
+										Uint32 & p_AckBits )
+		{
+			if( p_DataSize < CoalescedPacketSize )
+			{
+				return false;
+			}
+
+			Uint16 ackSequence = 0;
+			Uint32 ackBits = 0;
+			memcpy( &ackSequence, p_pData + 2, 2 );
+			memcpy( &ackBits, p_pData + 4, 4 );
+
+			p_HasAck = ( p_pData[ 1 ] & AckFlag ) != 0;
+			p_AckSequence = Ntoh16( ackSequence );
+			p_AckBits = Ntoh32( ackBits );
+			return true;
+		}
+
+		Bool PacketBuilder::ReadPacket(	Uint8 * p_pData,
+										const SizeType p_DataSize,
+										SizeType & p_Position,
+										Uint8 *& p_pPacket,
+										SizeType & p_PacketSize )
+		{
+			if( p_Position + CoalescedSizeFieldSize > p_DataSize )
+			{
+				return false;
+			}
+
+			Uint16 size = 0;
+			memcpy( &size, p_pData + p_Position, CoalescedSizeFieldSize );
+			size = Ntoh16( size );
+
+			// Error check the packet size.
+			if( size == 0 || p_Position + CoalescedSizeFieldSize + size > p_DataSize )
+			{
+				return false;
+			}
+
+			p_pPacket = p_pData + p_Position + CoalescedSizeFieldSize;
+			p_PacketSize = size;
+			p_Position += CoalescedSizeFieldSize + size;
+			return true;
+		}
+
+	}
+
+}
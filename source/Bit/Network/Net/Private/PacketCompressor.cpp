@@ -0,0 +1,369 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Private/PacketCompressor.hpp>
+#include <Bit/Network/Net/Private/NetPacket.hpp>
+#include <Bit/Network/Socket.hpp>
+#include <algorithm>
+#include <cstring>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		// Constants of the compressor.
+		const SizeType PacketCompressor::MinMatchSize;
+		const SizeType PacketCompressor::MaxOffset;
+		const Uint32 PacketCompressor::DictionaryHashLog;
+		const SizeType PacketCompressor::MaxRatio;
+
+		// Size of the decompressed size at the start of the payload.
+		static const SizeType g_SizeFieldSize = 4;
+
+		// Max and min number of bits of the hashes of the data being compressed.
+		static const Uint32 g_MaxHashLog = 12;
+		static const Uint32 g_MinHashLog = 8;
+
+		// Write a literal or match length exceeding the token.
+		static inline void WriteLength( std::vector<Uint8> & p_Output, SizeType p_Length )
+		{
+			while( p_Length >= 255 )
+			{
+				p_Output.push_back( 255 );
+				p_Length -= 255;
+			}
+			p_Output.push_back( static_cast<Uint8>( p_Length ) );
+		}
+
+		// Read a literal or match length exceeding the token.
+		static inline Bool ReadLength( const Uint8 *& p_pData, const Uint8 * p_pEnd, SizeType & p_Length )
+		{
+			Uint8 value = 255;
+			while( value == 255 )
+			{
+				if( p_pData == p_pEnd )
+				{
+					return false;
+				}
+				value = *p_pData++;
+				p_Length += value;
+			}
+			return true;
+		}
+
+		// Write a sequence of literals followed by a match, or the last literals if the match size is 0.
+		static inline void WriteSequence(	std::vector<Uint8> & p_Output,
+											const Uint8 * p_pLiterals, const SizeType p_LiteralSize,
+											const SizeType p_Offset, const SizeType p_MatchSize )
+		{
+			const SizeType matchLength = p_MatchSize ? p_MatchSize - PacketCompressor::MinMatchSize : 0;
+			const Uint8 token =	static_cast<Uint8>( ( p_LiteralSize < 15 ? p_LiteralSize : 15 ) << 4 ) |
+								static_cast<Uint8>( matchLength < 15 ? matchLength : 15 );
+			p_Output.push_back( token );
+
+			if( p_LiteralSize >= 15 )
+			{
+				WriteLength( p_Output, p_LiteralSize - 15 );
+			}
+			p_Output.insert( p_Output.end( ), p_pLiterals, p_pLiterals + p_LiteralSize );
+
+			if( p_MatchSize == 0 )
+			{
+				return;
+			}
+
+			p_Output.push_back( static_cast<Uint8>( p_Offset ) );
+			p_Output.push_back( static_cast<Uint8>( p_Offset >> 8 ) );
+			if( matchLength >= 15 )
+			{
+				WriteLength( p_Output, matchLength - 15 );
+			}
+		}
+
+		static inline Uint32 Read32( const Uint8 * p_pData )
+		{
+			Uint32 value;
+			memcpy( &value, p_pData, sizeof( Uint32 ) );
+			return value;
+		}
+
+		Uint32 PacketCompressor::Hash( const Uint8 * p_pData, const Uint32 p_HashLog )
+		{
+			return ( Read32( p_pData ) * 2654435761U ) >> ( 32 - p_HashLog );
+		}
+
+		Bool PacketCompressor::Compress(	const Uint8 * p_pData, const SizeType p_Size,
+											std::vector<Uint8> & p_Output,
+											const CompressionDictionary * p_pDictionary )
+		{
+			if( p_pData == NULL || p_Size == 0 || p_Size > MaxFragmentedMessageSize )
+			{
+				return false;
+			}
+
+			const SizeType outputStart = p_Output.size( );
+			p_Output.reserve( outputStart + g_SizeFieldSize + p_Size );
+
+			// Write the decompressed size.
+			const Uint32 size = Hton32( static_cast<Uint32>( p_Size ) );
+			const Uint8 * pSize = reinterpret_cast<const Uint8 *>( &size );
+			p_Output.insert( p_Output.end( ), pSize, pSize + g_SizeFieldSize );
+
+			// Size the hash table by the data, small packets don't need to clear a large table.
+			Uint32 hashLog = g_MinHashLog;
+			while( hashLog < g_MaxHashLog && ( static_cast<SizeType>( 1 ) << hashLog ) < p_Size )
+			{
+				hashLog++;
+			}
+			Uint32 hashTable[ 1 << g_MaxHashLog ];
+			memset( hashTable, 0, sizeof( Uint32 ) << hashLog );
+
+			// Get the dictionary, if not empty.
+			const Uint8 * pDictionary = NULL;
+			SizeType dictionarySize = 0;
+			if( p_pDictionary && p_pDictionary->m_Data.size( ) )
+			{
+				pDictionary = p_pDictionary->m_Data.data( );
+				dictionarySize = p_pDictionary->m_Data.size( );
+			}
+
+			const Uint8 * pEnd = p_pData + p_Size;
+			const Uint8 * pAnchor = p_pData;
+			const Uint8 * pCurrent = p_pData;
+
+			while( pCurrent + MinMatchSize <= pEnd )
+			{
+				const SizeType position = static_cast<SizeType>( pCurrent - p_pData );
+				const Uint32 hash = Hash( pCurrent, hashLog );
+				const Uint32 candidate = hashTable[ hash ];
+				hashTable[ hash ] = static_cast<Uint32>( position + 1 );
+
+				const Uint8 * pMatch = NULL;
+				SizeType matchSize = 0;
+				SizeType offset = 0;
+
+				// Look for a match in the data.
+				if( candidate && position - ( candidate - 1 ) <= MaxOffset &&
+					Read32( p_pData + candidate - 1 ) == Read32( pCurrent ) )
+				{
+					pMatch = p_pData + candidate - 1;
+					offset = position - ( candidate - 1 );
+					matchSize = MinMatchSize;
+					while( pCurrent + matchSize < pEnd && pMatch[ matchSize ] == pCurrent[ matchSize ] )
+					{
+						matchSize++;
+					}
+
+					// Extend the match backwards over the literals.
+					while( pCurrent > pAnchor && pMatch > p_pData && pCurrent[ -1 ] == pMatch[ -1 ] )
+					{
+						pCurrent--;
+						pMatch--;
+						matchSize++;
+					}
+				}
+				// Look for a match in the dictionary.
+				else if( pDictionary )
+				{
+					const Uint32 dictionaryCandidate = p_pDictionary->m_HashTable[ Hash( pCurrent, DictionaryHashLog ) ];
+					if( dictionaryCandidate )
+					{
+						const SizeType dictionaryPosition = dictionaryCandidate - 1;
+						const SizeType dictionaryOffset = position + dictionarySize - dictionaryPosition;
+						if( dictionaryOffset <= MaxOffset && dictionaryPosition + MinMatchSize <= dictionarySize &&
+							Read32( pDictionary + dictionaryPosition ) == Read32( pCurrent ) )
+						{
+							pMatch = pDictionary + dictionaryPosition;
+							offset = dictionaryOffset;
+							matchSize = MinMatchSize;
+							while(	pCurrent + matchSize < pEnd && dictionaryPosition + matchSize < dictionarySize &&
+									pMatch[ matchSize ] == pCurrent[ matchSize ] )
+							{
+								matchSize++;
+							}
+						}
+					}
+				}
+
+				// Skip ahead faster through incompressible data.
+				if( pMatch == NULL )
+				{
+					pCurrent += 1 + ( static_cast<SizeType>( pCurrent - pAnchor ) >> 6 );
+					continue;
+				}
+
+				WriteSequence( p_Output, pAnchor, static_cast<SizeType>( pCurrent - pAnchor ), offset, matchSize );
+				pCurrent += matchSize;
+				pAnchor = pCurrent;
+
+				// Hash a position within the match, improving the next matches.
+				if( pCurrent + MinMatchSize <= pEnd && matchSize > 2 )
+				{
+					hashTable[ Hash( pCurrent - 2, hashLog ) ] = static_cast<Uint32>( pCurrent - 2 - p_pData + 1 );
+				}
+
+				// Give up early if the output is already too large.
+				if( p_Output.size( ) - outputStart >= p_Size )
+				{
+					p_Output.resize( outputStart );
+					return false;
+				}
+			}
+
+			// Write the last literals.
+			WriteSequence( p_Output, pAnchor, static_cast<SizeType>( pEnd - pAnchor ), 0, 0 );
+
+			if( p_Output.size( ) - outputStart >= p_Size )
+			{
+				p_Output.resize( outputStart );
+				return false;
+			}
+
+			return true;
+		}
+
+		Bool PacketCompressor::Decompress(	const Uint8 * p_pData, const SizeType p_Size,
+											std::vector<Uint8> & p_Output,
+											const SizeType p_MaxSize,
+											const CompressionDictionary * p_pDictionary )
+		{
+			if( p_pData == NULL || p_Size <= g_SizeFieldSize )
+			{
+				return false;
+			}
+
+			// Read the decompressed size, and reject sizes the payload can't hold before allocating them.
+			Uint32 size = 0;
+			memcpy( &size, p_pData, g_SizeFieldSize );
+			const SizeType decompressedSize = static_cast<SizeType>( Ntoh32( size ) );
+			if( decompressedSize == 0 || decompressedSize > p_MaxSize ||
+				decompressedSize / MaxRatio > p_Size - g_SizeFieldSize )
+			{
+				return false;
+			}
+
+			const Uint8 * pDictionary = NULL;
+			SizeType dictionarySize = 0;
+			if( p_pDictionary && p_pDictionary->m_Data.size( ) )
+			{
+				pDictionary = p_pDictionary->m_Data.data( );
+				dictionarySize = p_pDictionary->m_Data.size( );
+			}
+
+			const SizeType outputStart = p_Output.size( );
+			p_Output.resize( outputStart + decompressedSize );
+			Uint8 * pOutputBegin = p_Output.data( ) + outputStart;
+			Uint8 * pOutput = pOutputBegin;
+			Uint8 * pOutputEnd = pOutputBegin + decompressedSize;
+
+			const Uint8 * pCurrent = p_pData + g_SizeFieldSize;
+			const Uint8 * pEnd = p_pData + p_Size;
+
+			while( pCurrent < pEnd )
+			{
+				const Uint8 token = *pCurrent++;
+
+				// Copy the literals.
+				SizeType literalSize = token >> 4;
+				if( literalSize == 15 && ReadLength( pCurrent, pEnd, literalSize ) == false )
+				{
+					break;
+				}
+				if( literalSize > static_cast<SizeType>( pEnd - pCurrent ) ||
+					literalSize > static_cast<SizeType>( pOutputEnd - pOutput ) )
+				{
+					break;
+				}
+				memcpy( pOutput, pCurrent, literalSize );
+				pOutput += literalSize;
+				pCurrent += literalSize;
+
+				// The last sequence only holds literals.
+				if( pCurrent == pEnd )
+				{
+					if( pOutput != pOutputEnd )
+					{
+						break;
+					}
+					return true;
+				}
+
+				// Read the match.
+				if( pEnd - pCurrent < 2 )
+				{
+					break;
+				}
+				const SizeType offset = static_cast<SizeType>( pCurrent[ 0 ] ) | ( static_cast<SizeType>( pCurrent[ 1 ] ) << 8 );
+				pCurrent += 2;
+
+				SizeType matchSize = token & 15;
+				if( matchSize == 15 && ReadLength( pCurrent, pEnd, matchSize ) == false )
+				{
+					break;
+				}
+				matchSize += MinMatchSize;
+
+				const SizeType decoded = static_cast<SizeType>( pOutput - pOutputBegin );
+				if( offset == 0 || offset > decoded + dictionarySize ||
+					matchSize > static_cast<SizeType>( pOutputEnd - pOutput ) )
+				{
+					break;
+				}
+
+				// Copy the part of the match within the dictionary.
+				if( offset > decoded )
+				{
+					const SizeType dictionaryPosition = dictionarySize - ( offset - decoded );
+					const SizeType dictionaryPart = std::min( matchSize, dictionarySize - dictionaryPosition );
+					memcpy( pOutput, pDictionary + dictionaryPosition, dictionaryPart );
+					pOutput += dictionaryPart;
+					matchSize -= dictionaryPart;
+				}
+
+				// Copy the rest of the match within the output, byte by byte if overlapping.
+				const Uint8 * pMatch = offset > decoded ? pOutputBegin : pOutput - offset;
+				if( static_cast<SizeType>( pOutput - pMatch ) >= matchSize )
+				{
+					memcpy( pOutput, pMatch, matchSize );
+					pOutput += matchSize;
+				}
+				else
+				{
+					for( SizeType i = 0; i < matchSize; i++ )
+					{
+						*pOutput++ = *pMatch++;
+					}
+				}
+			}
+
+			// Corrupt payload.
+			p_Output.resize( outputStart );
+			return false;
+		}
+
+	}
+
+}
@@ -0,0 +1,120 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Private/RecordingSocket.hpp>
+#include <Bit/Network/Net/TrafficRecorder.hpp>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		RecordingSocket::RecordingSocket( TrafficRecorder * p_pRecorder ) :
+			m_pRecorder( p_pRecorder )
+		{
+		}
+
+		Bool RecordingSocket::Open( const Uint16 p_Port )
+		{
+			return m_Socket.Open( p_Port );
+		}
+
+		Bool RecordingSocket::OpenShared( const Uint16 p_Port )
+		{
+			return m_Socket.OpenShared( p_Port );
+		}
+
+		void RecordingSocket::Close( )
+		{
+			m_Socket.Close( );
+		}
+
+		void RecordingSocket::SetBlocking( const Bool p_Blocking )
+		{
+			m_Socket.SetBlocking( p_Blocking );
+		}
+
+		Bool RecordingSocket::GetBlocking( ) const
+		{
+			return m_Socket.GetBlocking( );
+		}
+
+		Int32 RecordingSocket::Send( const void * p_pData, const SizeType p_Size, const Address & p_Address, const Uint16 p_Port )
+		{
+			const Int32 size = m_Socket.Send( p_pData, p_Size, p_Address, p_Port );
+			if( size > 0 )
+			{
+				m_pRecorder->Record( TrafficDirection::Sent, p_Address, p_Port, NULL, 0, p_pData, static_cast<SizeType>( size ) );
+			}
+			return size;
+		}
+
+		Int32 RecordingSocket::Receive( void * p_pData, const SizeType p_Size, Address & p_Address, Uint16 & p_Port )
+		{
+			const Int32 size = m_Socket.Receive( p_pData, p_Size, p_Address, p_Port );
+			if( size > 0 )
+			{
+				m_pRecorder->Record( TrafficDirection::Received, p_Address, p_Port, NULL, 0, p_pData, static_cast<SizeType>( size ) );
+			}
+			return size;
+		}
+
+		Int32 RecordingSocket::Receive( void * p_pData, const SizeType p_Size, Address & p_Address, Uint16 & p_Port, const Time & p_Timeout )
+		{
+			const Int32 size = m_Socket.Receive( p_pData, p_Size, p_Address, p_Port, p_Timeout );
+			if( size > 0 )
+			{
+				m_pRecorder->Record( TrafficDirection::Received, p_Address, p_Port, NULL, 0, p_pData, static_cast<SizeType>( size ) );
+			}
+			return size;
+		}
+
+		Int32 RecordingSocket::SendBatch( const Datagram * p_pDatagrams, const SizeType p_Count )
+		{
+			const Int32 count = m_Socket.SendBatch( p_pDatagrams, p_Count );
+			for( Int32 i = 0; i < count; i++ )
+			{
+				const Datagram & datagram = p_pDatagrams[ i ];
+				m_pRecorder->Record(	TrafficDirection::Sent, datagram.RemoteAddress, datagram.RemotePort,
+										datagram.pHeader, datagram.HeaderSize, datagram.pData, datagram.DataSize );
+			}
+			return count;
+		}
+
+		Int32 RecordingSocket::ReceiveBatch( Datagram * p_pDatagrams, const SizeType p_Count, const Time & p_Timeout )
+		{
+			const Int32 count = m_Socket.ReceiveBatch( p_pDatagrams, p_Count, p_Timeout );
+			for( Int32 i = 0; i < count; i++ )
+			{
+				const Datagram & datagram = p_pDatagrams[ i ];
+				m_pRecorder->Record(	TrafficDirection::Received, datagram.RemoteAddress, datagram.RemotePort,
+										NULL, 0, datagram.pData, datagram.DataSize );
+			}
+			return count;
+		}
+
+	}
+
+}
@@ -0,0 +1,251 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Private/ReplaySocket.hpp>
+#include <Bit/Network/Net/TrafficReplay.hpp>
+#include <Bit/Network/Net/Private/NetPacket.hpp>
+#include <Bit/System/SmartMutex.hpp>
+#include <Bit/System/Sleep.hpp>
+#include <algorithm>
+#include <cstring>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		// Static variables
+		static const SizeType g_CookieOffset = PacketTypeSize + SequenceSize;	///< Offset of the cookie in the challenge packets.
+
+		ReplaySocket::ReplaySocket( TrafficReplay * p_pReplay ) :
+			m_pReplay( p_pReplay ),
+			m_Index( 0 ),
+			m_NextRecord( 0 ),
+			m_Opened( false )
+		{
+		}
+
+		ReplaySocket::~ReplaySocket( )
+		{
+			Close( );
+		}
+
+		Bool ReplaySocket::Open( const Uint16 )
+		{
+			// The port is not used, the sockets are replayed in the order they were opened.
+			Close( );
+
+			m_Index = m_pReplay->AddSocket( );
+			m_NextRecord = 0;
+			m_Opened = true;
+			return true;
+		}
+
+		Bool ReplaySocket::OpenShared( const Uint16 )
+		{
+			return Open( 0 );
+		}
+
+		void ReplaySocket::Close( )
+		{
+			if( m_Opened )
+			{
+				m_pReplay->RemoveSocket( );
+				m_Opened = false;
+			}
+		}
+
+		void ReplaySocket::SetBlocking( const Bool p_Blocking )
+		{
+			m_Blocking = p_Blocking;
+		}
+
+		Bool ReplaySocket::GetBlocking( ) const
+		{
+			return m_Blocking;
+		}
+
+		Int32 ReplaySocket::Send( const void * p_pData, const SizeType p_Size, const Address & p_Address, const Uint16 p_Port )
+		{
+			AddSentDatagram( p_Address, p_Port, NULL, 0, p_pData, p_Size );
+			return static_cast<Int32>( p_Size );
+		}
+
+		Int32 ReplaySocket::Receive( void * p_pData, const SizeType p_Size, Address & p_Address, Uint16 & p_Port )
+		{
+			// Wait for the next datagram if blocking, like a regular socket.
+			Int32 size = 0;
+			do
+			{
+				size = Receive( p_pData, p_Size, p_Address, p_Port, Milliseconds( 100 ) );
+			}
+			while( size == 0 && m_Blocking );
+
+			return size;
+		}
+
+		Int32 ReplaySocket::Receive( void * p_pData, const SizeType p_Size, Address & p_Address, Uint16 & p_Port, const Time & p_Timeout )
+		{
+			Datagram datagram;
+			datagram.pData = p_pData;
+			datagram.BufferSize = p_Size;
+
+			const Int32 count = ReceiveBatch( &datagram, 1, p_Timeout );
+			if( count <= 0 )
+			{
+				return count;
+			}
+
+			p_Address = datagram.RemoteAddress;
+			p_Port = datagram.RemotePort;
+			return static_cast<Int32>( datagram.DataSize );
+		}
+
+		Int32 ReplaySocket::SendBatch( const Datagram * p_pDatagrams, const SizeType p_Count )
+		{
+			for( SizeType i = 0; i < p_Count; i++ )
+			{
+				const Datagram & datagram = p_pDatagrams[ i ];
+				AddSentDatagram(	datagram.RemoteAddress, datagram.RemotePort,
+									datagram.pHeader, datagram.HeaderSize,
+									datagram.pData, datagram.DataSize );
+			}
+
+			return static_cast<Int32>( p_Count );
+		}
+
+		Int32 ReplaySocket::ReceiveBatch( Datagram * p_pDatagrams, const SizeType p_Count, const Time & p_Timeout )
+		{
+			if( m_Opened == false )
+			{
+				return -1;
+			}
+
+			// Nothing more to receive, wait for the timeout like an idle socket.
+			if( FindNextRecord( ) == false )
+			{
+				Sleep( p_Timeout );
+				return 0;
+			}
+
+			// Wait for the next record to be due.
+			const Uint64 timeUntilDue = m_pReplay->GetTimeUntilDue( m_pReplay->m_Records[ m_NextRecord ] );
+			if( timeUntilDue )
+			{
+				if( timeUntilDue > p_Timeout.AsMicroseconds( ) )
+				{
+					Sleep( p_Timeout );
+					return 0;
+				}
+
+				Sleep( Microseconds( timeUntilDue ) );
+			}
+
+			// Receive the due records.
+			SizeType count = 0;
+			while(	count < p_Count && FindNextRecord( ) &&
+					m_pReplay->GetTimeUntilDue( m_pReplay->m_Records[ m_NextRecord ] ) == 0 )
+			{
+				const TrafficRecord & record = m_pReplay->m_Records[ m_NextRecord ];
+				Datagram & datagram = p_pDatagrams[ count ];
+				Uint8 * pData = reinterpret_cast<Uint8 *>( datagram.pData );
+
+				datagram.DataSize = std::min( record.Data.size( ), datagram.BufferSize );
+				datagram.RemoteAddress = record.RemoteAddress;
+				datagram.RemotePort = record.RemotePort;
+				memcpy( pData, record.Data.data( ), datagram.DataSize );
+
+				// Replace the recorded cookie of a challenge response by the cookie of the new challenge.
+				// Hold the response back until the challenge is sent, the server handles the received datagrams in order.
+				if( datagram.DataSize >= ChallengeResponsePacketSize && pData[ 0 ] == PacketType::ChallengeResponse )
+				{
+					const Uint64 key = ( static_cast<Uint64>( record.RemoteAddress.GetAddress( ) ) << 16 ) | record.RemotePort;
+
+					m_Mutex.Lock( );
+					CookieMap::iterator it = m_Cookies.find( key );
+					const Bool challenged = it != m_Cookies.end( );
+					if( challenged )
+					{
+						memcpy( pData + g_CookieOffset, &it->second, sizeof( Uint64 ) );
+					}
+					m_Mutex.Unlock( );
+
+					if( challenged == false )
+					{
+						if( count == 0 )
+						{
+							Sleep( std::min( p_Timeout, Microseconds( 1000 ) ) );
+						}
+						break;
+					}
+				}
+
+				m_NextRecord++;
+				count++;
+			}
+
+			m_pReplay->m_ReplayedCount.Mutex.Lock( );
+			m_pReplay->m_ReplayedCount.Value += count;
+			m_pReplay->m_ReplayedCount.Mutex.Unlock( );
+
+			return static_cast<Int32>( count );
+		}
+
+		void ReplaySocket::AddSentDatagram(	const Address & p_Address, const Uint16 p_Port,
+											const void *, const SizeType p_HeaderSize,
+											const void * p_pData, const SizeType p_DataSize )
+		{
+			m_pReplay->m_SentCount.Mutex.Lock( );
+			m_pReplay->m_SentCount.Value++;
+			m_pReplay->m_SentCount.Mutex.Unlock( );
+
+			// Keep the cookie of a challenge, the challenges are sent without any separate header.
+			const Uint8 * pData = reinterpret_cast<const Uint8 *>( p_pData );
+			if( p_HeaderSize == 0 && p_DataSize >= ChallengePacketSize && pData[ 0 ] == PacketType::Challenge )
+			{
+				const Uint64 key = ( static_cast<Uint64>( p_Address.GetAddress( ) ) << 16 ) | p_Port;
+
+				SmartMutex mutex( m_Mutex );
+				mutex.Lock( );
+
+				memcpy( &m_Cookies[ key ], pData + g_CookieOffset, sizeof( Uint64 ) );
+			}
+		}
+
+		Bool ReplaySocket::FindNextRecord( )
+		{
+			// Skip the records of the other sockets.
+			const TrafficLog::RecordVector & records = m_pReplay->m_Records;
+			while( m_NextRecord < records.size( ) && m_pReplay->GetSocketIndex( records[ m_NextRecord ] ) != m_Index )
+			{
+				m_NextRecord++;
+			}
+
+			return m_NextRecord < records.size( );
+		}
+
+	}
+
+}
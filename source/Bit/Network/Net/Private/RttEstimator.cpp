@@ -0,0 +1,105 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Private/RttEstimator.hpp>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		// Static variables
+		const Time RttEstimator::MinRto = Milliseconds( 50 );
+		const Time RttEstimator::MaxRto = Seconds( 3.0f );
+
+		// Rtt estimator class
+		RttEstimator::RttEstimator( const Time & p_InitialRtt )
+		{
+			Reset( p_InitialRtt );
+		}
+
+		void RttEstimator::Reset( const Time & p_InitialRtt )
+		{
+			m_HasSample = false;
+			m_Srtt = p_InitialRtt.AsMicroseconds( );
+			m_RttVar = m_Srtt / 2ULL;
+			m_Rto = m_Srtt + 4ULL * m_RttVar;
+		}
+
+		void RttEstimator::AddSample( const Time & p_Rtt )
+		{
+			const Uint64 rtt = p_Rtt.AsMicroseconds( );
+
+			// The first sample replaces the initial round trip time.
+			if( m_HasSample == false )
+			{
+				m_HasSample = true;
+				m_Srtt = rtt;
+				m_RttVar = rtt / 2ULL;
+			}
+			else
+			{
+				// RTTVAR = 3/4 * RTTVAR + 1/4 * |SRTT - R|, SRTT = 7/8 * SRTT + 1/8 * R
+				const Uint64 error = rtt > m_Srtt ? rtt - m_Srtt : m_Srtt - rtt;
+				m_RttVar = ( 3ULL * m_RttVar + error ) / 4ULL;
+				m_Srtt = ( 7ULL * m_Srtt + rtt ) / 8ULL;
+			}
+
+			// RTO = SRTT + 4 * RTTVAR, within the bounds.
+			m_Rto = m_Srtt + 4ULL * m_RttVar;
+		}
+
+		Time RttEstimator::GetRtt( ) const
+		{
+			return Microseconds( m_Srtt );
+		}
+
+		Time RttEstimator::GetRttVariance( ) const
+		{
+			return Microseconds( m_RttVar );
+		}
+
+		Time RttEstimator::GetRto( ) const
+		{
+			return GetBackoffRto( 0 );
+		}
+
+		Time RttEstimator::GetBackoffRto( const Uint32 p_Resends ) const
+		{
+			const Uint64 minRto = MinRto.AsMicroseconds( );
+			const Uint64 maxRto = MaxRto.AsMicroseconds( );
+
+			Uint64 rto = m_Rto < minRto ? minRto : m_Rto;
+			for( Uint32 i = 0; i < p_Resends && rto < maxRto; i++ )
+			{
+				rto *= 2ULL;
+			}
+
+			return Microseconds( rto < maxRto ? rto : maxRto );
+		}
+
+	}
+
+}
@@ -76,6 +76,14 @@ namespace Bit
 			return true;
 		}
 
+		Bool SequenceManager::HasSequence(const Uint16 p_Sequence) const
+		{
+			const Uint32 arrayIndex = static_cast<Uint32>(p_Sequence) / 32;
+			const Uint32 bitIndex = static_cast<Uint32>(p_Sequence) % 32;
+
+			return ((m_SequenceBits[arrayIndex] >> bitIndex) & 0x01) != 0;
+		}
+
 
 	}
 
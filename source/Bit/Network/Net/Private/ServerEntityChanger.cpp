@@ -44,55 +44,8 @@ namespace Bit
 				return;
 			}
 
-			// Add changed variable
-			//m_pEntityManager->AddChangedVariable(p_pEntity, p_pVariableBase);
-
-			/*
-			// Lock the entity manager mutex.
-			SmartMutex mutex(m_pEntityManager->m_Mutex);
-			mutex.Lock();
-
-			EntityManager::ChangedEntitiesMap * pChangedEntities = &m_pEntityManager->m_ChangedEntities;
-
-			// Check if the entity already is changed at some pointer, if the entity
-			EntityManager::ChangedEntitiesMap::iterator it = pChangedEntities->find( p_pEntity->GetName( ) );
-			EntityManager::ChangedVariablesMap * pChangedVariables = NULL;
-			if( it == pChangedEntities->end( ) )
-			{
-				// Add the entity
-				pChangedVariables = new EntityManager::ChangedVariablesMap;
-				(*pChangedEntities)[ p_pEntity->GetName( ) ] = pChangedVariables;
-			}
-			else
-			{
-				pChangedVariables = it->second;
-			}
-
-			// Check if the variable already is changed
-			EntityManager::ChangedVariablesMap::iterator it2 = pChangedVariables->find( p_pVariableBase->GetName( ) );
-			EntityManager::ChangedEntityVariableMap * pChangedEntityVariables = NULL;
-			if( it2 == pChangedVariables->end( ) )
-			{
-				// Add the entity
-				pChangedEntityVariables = new EntityManager::ChangedEntityVariableMap;
-				(*pChangedVariables)[ p_pVariableBase->GetName( ) ] = pChangedEntityVariables;
-			}
-			else
-			{
-				pChangedEntityVariables = it2->second;
-			}
-
-			// Insert the entity and variable if needed
-			EntityManager::ChangedEntityVariableMap::iterator it3 = pChangedEntityVariables->find( p_pEntity );
-			if( it3 == pChangedEntityVariables->end( ) )
-			{
-				(*pChangedEntityVariables)[ p_pEntity ] = p_pVariableBase;
-			}
-
-			// Unlock the mutex.
-			mutex.Unlock();
-			*/
-
+			// Mark the variable as changed.
+			m_pEntityManager->OnVariableChange( p_pEntity, p_pVariableBase );
 		}
 
 
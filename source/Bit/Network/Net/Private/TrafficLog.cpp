@@ -0,0 +1,178 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/Private/TrafficLog.hpp>
+#include <Bit/Network/Socket.hpp>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		// Static variables
+		static const Uint8 g_Magic[ 4 ] = { 'B', 'N', 'T', 'L' };
+		static const SizeType g_HeaderSize = 5;
+		static const SizeType g_EndpointSize = 7;
+
+		const Uint8 TrafficLog::Version;
+
+		void TrafficLog::WriteHeader( std::vector<Uint8> & p_Output )
+		{
+			p_Output.insert( p_Output.end( ), g_Magic, g_Magic + 4 );
+			p_Output.push_back( Version );
+		}
+
+		void TrafficLog::WriteRecord(	std::vector<Uint8> & p_Output,
+										const Uint64 p_TimeDelta,
+										const TrafficDirection::eDirection p_Direction,
+										const Address & p_RemoteAddress,
+										const Uint16 p_RemotePort,
+										const void * p_pHeader,
+										const SizeType p_HeaderSize,
+										const void * p_pData,
+										const SizeType p_DataSize )
+		{
+			WriteVarInt( p_Output, p_TimeDelta );
+
+			// Add the direction and the endpoint.
+			const Uint32 address = Hton32( p_RemoteAddress.GetAddress( ) );
+			const Uint16 port = Hton16( p_RemotePort );
+			const SizeType position = p_Output.size( );
+			p_Output.resize( position + g_EndpointSize );
+			p_Output[ position ] = static_cast<Uint8>( p_Direction );
+			memcpy( &p_Output[ position + 1 ], &address, 4 );
+			memcpy( &p_Output[ position + 5 ], &port, 2 );
+
+			// Add the datagram.
+			WriteVarInt( p_Output, static_cast<Uint64>( p_HeaderSize + p_DataSize ) );
+			if( p_HeaderSize )
+			{
+				const Uint8 * pHeader = reinterpret_cast<const Uint8 *>( p_pHeader );
+				p_Output.insert( p_Output.end( ), pHeader, pHeader + p_HeaderSize );
+			}
+			if( p_DataSize )
+			{
+				const Uint8 * pData = reinterpret_cast<const Uint8 *>( p_pData );
+				p_Output.insert( p_Output.end( ), pData, pData + p_DataSize );
+			}
+		}
+
+		Bool TrafficLog::Read( const std::string & p_Filename, RecordVector & p_Records )
+		{
+			std::ifstream fin( p_Filename.c_str( ), std::fstream::binary );
+			if( fin.is_open( ) == false )
+			{
+				return false;
+			}
+
+			std::vector<Uint8> log( ( std::istreambuf_iterator<char>( fin ) ), std::istreambuf_iterator<char>( ) );
+			fin.close( );
+
+			// Error check the header.
+			if( log.size( ) < g_HeaderSize || memcmp( log.data( ), g_Magic, 4 ) != 0 || log[ 4 ] != Version )
+			{
+				return false;
+			}
+
+			// Read the records.
+			p_Records.clear( );
+			SizeType position = g_HeaderSize;
+			Uint64 time = 0;
+			while( position < log.size( ) )
+			{
+				Uint64 timeDelta = 0;
+				if( ReadVarInt( log.data( ), log.size( ), position, timeDelta ) == false ||
+					position + g_EndpointSize > log.size( ) )
+				{
+					break;
+				}
+
+				Uint32 address = 0;
+				Uint16 port = 0;
+				const Uint8 direction = log[ position ];
+				memcpy( &address, &log[ position + 1 ], 4 );
+				memcpy( &port, &log[ position + 5 ], 2 );
+				position += g_EndpointSize;
+
+				Uint64 size = 0;
+				if( direction > TrafficDirection::Received ||
+					ReadVarInt( log.data( ), log.size( ), position, size ) == false ||
+					size > log.size( ) - position )
+				{
+					break;
+				}
+
+				time += timeDelta;
+
+				TrafficRecord record;
+				record.Time = time;
+				record.Direction = static_cast<TrafficDirection::eDirection>( direction );
+				record.RemoteAddress = Address( Ntoh32( address ) );
+				record.RemotePort = Ntoh16( port );
+				p_Records.push_back( record );
+				p_Records.back( ).Data.assign( log.begin( ) + position, log.begin( ) + position + static_cast<SizeType>( size ) );
+				position += static_cast<SizeType>( size );
+			}
+
+			return true;
+		}
+
+		void TrafficLog::WriteVarInt( std::vector<Uint8> & p_Output, Uint64 p_Value )
+		{
+			while( p_Value >= 0x80 )
+			{
+				p_Output.push_back( static_cast<Uint8>( p_Value | 0x80 ) );
+				p_Value >>= 7;
+			}
+			p_Output.push_back( static_cast<Uint8>( p_Value ) );
+		}
+
+		Bool TrafficLog::ReadVarInt( const Uint8 * p_pData, const SizeType p_DataSize, SizeType & p_Position, Uint64 & p_Value )
+		{
+			p_Value = 0;
+			for( Uint32 shift = 0; shift < 64; shift += 7 )
+			{
+				if( p_Position >= p_DataSize )
+				{
+					return false;
+				}
+
+				const Uint8 byte = p_pData[ p_Position++ ];
+				p_Value |= static_cast<Uint64>( byte & 0x7F ) << shift;
+				if( ( byte & 0x80 ) == 0 )
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+	}
+
+}
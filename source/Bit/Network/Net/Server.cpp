@@ -29,6 +29,8 @@
 #include <Bit/System/Timestep.hpp>
 #include <Bit/System/SmartMutex.hpp>
 #include <Bit/System/Log.hpp>
+#include <algorithm>
+#include <cstring>
 #include <Bit/System/MemoryLeak.hpp>
 
 namespace Bit
@@ -43,7 +45,14 @@ namespace Bit
 			MaxConnections(255),
 			LosingConnectionTimeout(Seconds(3.0f)),
 			EntityUpdatesPerSecond(20),
-			Identifier("Bit Engine Network")
+			Identifier("Bit Engine Network"),
+			UseWorkerPool(false),
+			WorkerThreadCount(0),
+			CongestionControl(false),
+			MaxSendRate(0),
+			SocketShards(1),
+			CompressionThreshold(0),
+			pSocketFactory(NULL)
 		{
 		}
 
@@ -52,13 +61,27 @@ namespace Bit
 										const Time & p_LosingConnectionTimeout,
 										const Uint8 p_EntityUpdatesPerSecond,
 										const Uint8 p_MaxEntityUpdatesPerSecond,
-										const std::string & p_Identifier) :
+										const std::string & p_Identifier,
+										const Bool p_UseWorkerPool,
+										const Uint32 p_WorkerThreadCount,
+										const Bool p_CongestionControl,
+										const Uint32 p_MaxSendRate,
+										const Uint32 p_SocketShards,
+										const Uint32 p_CompressionThreshold,
+										SocketFactory * p_pSocketFactory) :
 			Port(p_Port),
 			MaxConnections(p_MaxConnections),
 			LosingConnectionTimeout(p_LosingConnectionTimeout),
 			EntityUpdatesPerSecond(p_EntityUpdatesPerSecond),
 			MaxEntityUpdatesPerSecond(p_MaxEntityUpdatesPerSecond),
-			Identifier(p_Identifier)
+			Identifier(p_Identifier),
+			UseWorkerPool(p_UseWorkerPool),
+			WorkerThreadCount(p_WorkerThreadCount),
+			CongestionControl(p_CongestionControl),
+			MaxSendRate(p_MaxSendRate),
+			SocketShards(p_SocketShards),
+			CompressionThreshold(p_CompressionThreshold),
+			pSocketFactory(p_pSocketFactory)
 		{
 		}
 
@@ -69,10 +92,17 @@ namespace Bit
 			m_DefaultEntityTicks(0),
 			m_MaxEntityTicks(0),
 			m_DefaultSendEntityMessages( true ),
-			m_PacketMemoryPool(NULL),
-			m_MaxPacketSize(2048)
+			m_MaxPacketSize(2048),
+			m_UseWorkerPool(false),
+			m_CongestionControl(false),
+			m_MaxSendRate(0),
+			m_CompressionThreshold(0),
+			m_ReassemblyBudget(TotalReassemblyBufferSize)
 		{
-
+			for (SizeType i = 0; i < MaxChannelCount; i++)
+			{
+				m_ChannelDeliveries[i] = DeliveryType::ReliableOrdered;
+			}
 		}
 
 		Server::~Server()
@@ -106,6 +136,30 @@ namespace Bit
 			return new HostMessage(p_Name, this, p_MessageSize);
 		}
 
+		Bool Server::SetChannel(const Uint8 p_Channel, const DeliveryType::eType p_Delivery)
+		{
+			if (p_Channel >= MaxChannelCount)
+			{
+				return false;
+			}
+
+			// Set the delivery type of the new and the current connections.
+			m_ConnectionMutex.Lock();
+
+			m_ChannelDeliveries[p_Channel] = p_Delivery;
+
+			for (UserConnectionMap::iterator it = m_UserConnections.begin(); it != m_UserConnections.end(); it++)
+			{
+				it->second->m_Channels.Mutex.Lock();
+				it->second->m_Channels.Value.SetDelivery(p_Channel, p_Delivery);
+				it->second->m_Channels.Mutex.Unlock();
+			}
+
+			m_ConnectionMutex.Unlock();
+
+			return true;
+		}
+
 		Bool Server::DisconnectUser(const Uint16 p_UserId)
 		{
 			// Find the connection via user id.
@@ -145,21 +199,9 @@ namespace Bit
 			// Add the entity index to the connection.
 			it->second->AddToGroup(p_GroupIndex);
 
-			// Create the entity message
-			std::vector<Uint8> message;
-			if (m_EntityManager.CreateFullEntityMessage(message, false) == false)
-			{
-				return;
-			}
-
-			// Error check the message
-			if (message.size() == 0)
-			{
-				return;
-			}
-
-			// Send realiable message.
-			it->second->SendReliable(PacketType::EntityUpdate, reinterpret_cast<Uint8 *>(message.data()), message.size(), true);
+			// Send the full entity state in the next snapshot,
+			// it's delta encoded as soon as the client acknowledges it.
+			it->second->SetAckedSnapshot(-1);
 		}
 
 		void Server::RemoveUserFromGroup(const Uint16 p_UserId, const Uint32 p_GroupIndex)
@@ -243,12 +285,36 @@ namespace Bit
 
 		Bool Server::Start(const Properties & p_Properties)
 		{
-			// Open the udp socket.
-			if (m_Socket.Open(p_Properties.Port) == false)
+			// Get the number of receive shards, sharing the port requires a fixed one.
+			SizeType shardCount = p_Properties.SocketShards > 0 ? static_cast<SizeType>(p_Properties.SocketShards) : 1;
+			if (shardCount > 1 && p_Properties.Port == 0)
 			{
-				return false;
+				bitLogNetErr(  "Socket shards require a fixed port, using a single socket." );
+				shardCount = 1;
+			}
+
+			// Open the udp sockets of the receive shards, each one with its own packet memory pool.
+			for (SizeType i = 0; i < shardCount; i++)
+			{
+				ReceiveShard * pShard = new ReceiveShard;
+				pShard->pSocket = p_Properties.pSocketFactory ? p_Properties.pSocketFactory->CreateSocket() : new UdpSocket;
+				m_Shards.push_back(pShard);
+
+				const Bool opened = shardCount == 1 ?	pShard->pSocket->Open(p_Properties.Port) :
+														pShard->pSocket->OpenShared(p_Properties.Port);
+				if (opened == false)
+				{
+					bitLogNetErr(  "Failed to open the socket of receive shard " << i << "." );
+					DeleteShards();
+					return false;
+				}
+				pShard->pSocket->SetBlocking(true);
+
+				// Any shard may own all the connections.
+				pShard->Connections.Reserve(p_Properties.MaxConnections);
+
+				pShard->pPacketMemoryPool = new ConcurrentMemoryPool<Uint8>(p_Properties.MaxConnections * 64 / shardCount, m_MaxPacketSize, true);
 			}
-			m_Socket.SetBlocking(true);
 
 			// Set host port
 			m_Port = p_Properties.Port;
@@ -272,187 +338,110 @@ namespace Bit
 			// Set the identifier
 			m_Identifier = p_Properties.Identifier;
 
-			// Create the packet memory pool
-			m_PacketMemoryPool.Set(new MemoryPool<Uint8>(p_Properties.MaxConnections * 64, m_MaxPacketSize, true));
+			// Invalidate the connect cookies of any earlier run.
+			m_ConnectCookie.GenerateSecret();
 
-			// Start the server timer.
-			m_ServerTimer.Get().Start();
+			// Set the send rate of the connections.
+			m_CongestionControl = p_Properties.CongestionControl;
+			m_MaxSendRate = p_Properties.MaxSendRate;
 
-			// Start the server thread.
-			m_MainThread.Execute([this]()
-			{
-				Address address;
-				Uint16 port = 0;
-				Int16 recvSize = 0;
+			// Set the compression of the entity snapshots and host messages.
+			m_CompressionThreshold = p_Properties.CompressionThreshold;
+			m_CompressionDictionary = p_Properties.Dictionary;
 
-				// Set the running flag to true.
-				m_Running.Mutex.Lock();
-				m_Running.Value = true;
-				m_Running.Mutex.Unlock();
-
-				// Receive packets as long as the server is running.
-				while (IsRunning())
-				{
-					// Get item from memory pool
-
-					m_PacketMemoryPool.Mutex.Lock();
-					MemoryPool<Uint8>::Item *pItem = m_PacketMemoryPool.Get()->Get();
-					m_PacketMemoryPool.Mutex.Unlock();
+			// Start the worker pool.
+			m_UseWorkerPool = p_Properties.UseWorkerPool;
+			if (m_UseWorkerPool && m_WorkerPool.Start(p_Properties.WorkerThreadCount) == false)
+			{
+				bitLogNetErr(  "Failed to start the worker pool." );
+				DeleteShards();
+				return false;
+			}
 
+			// Start the server timer.
+			m_ServerTimer.Get().Start();
 
-					Uint8 * pBuffer = pItem->GetData();
+			// Set the running flag to true before starting the threads of the shards.
+			m_Running.Mutex.Lock();
+			m_Running.Value = true;
+			m_Running.Mutex.Unlock();
 
-					// Error check the item and it's data.
-					if (pItem == NULL || pBuffer == NULL)
+			// Start the receive threads, one per shard.
+			for (SizeType s = 0; s < m_Shards.size(); s++)
+			{
+				ReceiveShard * pShard = m_Shards[s];
+				pShard->ReceiveThread.Execute([this, pShard]()
+				{
+					// Datagrams of the receive batch, each one using a memory pool item.
+					const SizeType batchSize = 32;
+					UdpSocket::Datagram datagrams[batchSize];
+					ConcurrentMemoryPool<Uint8>::Item * items[batchSize];
+					for (SizeType i = 0; i < batchSize; i++)
 					{
-						bitLogNetErr(  "Null memory pool item." );
-						continue;
+						items[i] = NULL;
 					}
 
-					// Receive a packet.
-					// Loop while the server is running and until we receive a valid packet.
+					// Receive packets as long as the server is running.
 					while (IsRunning())
 					{
-						if ((recvSize = m_Socket.Receive(pBuffer, m_MaxPacketSize, address, port, Milliseconds(5))) > 0)
+						// Get items from memory pool for the datagrams passed to connections.
+						Bool validItems = true;
+						for (SizeType i = 0; i < batchSize; i++)
 						{
-							break;
-						}
-					}
-
-					// get the client address as an index.
-					Uint64 clientAddress = static_cast<Uint64>(address.GetAddress()) *
-						static_cast<Uint64>(port)+
-						static_cast<Uint64>(port);
+							if (items[i] == NULL)
+							{
+								items[i] = pShard->pPacketMemoryPool->Get();
 
-					// Lock the connection mutex.
-					m_ConnectionMutex.Lock();
+								// Error check the item and it's data.
+								if (items[i] == NULL || items[i]->GetData() == NULL)
+								{
+									validItems = false;
+									break;
+								}
 
-					// Check if we received a packet from a connected client.
-					AddressConnectionMap::iterator it = m_AddressConnections.find(clientAddress);
-					if (it != m_AddressConnections.end())
-					{
-						// Send the packet to the client thread.
-						pItem->SetUsedSize(recvSize);
-						it->second->AddReceivedData(pItem);
-						m_ConnectionMutex.Unlock();
-						continue;
-					}
-
-					// Use a do while loop with false condition in order to 
-					// jump over and skip code later.
-					do
-					{
-						// This is not a packet from an already connected client,
-						// check if the client is tryin go connect.
-						if (pBuffer[0] == PacketType::Connect)
-						{
-							// Make sure that the identifier is right.
-							if (recvSize != m_Identifier.size() + ConnectPacketSize)
-							{
-								// Go to the return packet label.
-								break;
+								datagrams[i].pData = items[i]->GetData();
+								datagrams[i].BufferSize = m_MaxPacketSize;
 							}
-							if (memcmp(pBuffer + ConnectPacketSize, m_Identifier.data(), m_Identifier.size()) != 0)
-							{
-								// Go to the return packet label.
-								break;
-							}
-
-							// Check if the address is banned
-							m_BanSet.Mutex.Lock();
-							if (m_BanSet.Value.find(address.GetAddress()) != m_BanSet.Value.end())
-							{
-								// Send ban packet
-								pBuffer[0] = PacketType::Reject;
-								pBuffer[1] = RejectType::Banned;
-								m_Socket.Send(pBuffer, RejectPacketSize, address, port);
+						}
 
-								// Unlock the ban set mutex.
-								m_BanSet.Mutex.Unlock();
+						if (validItems == false)
+						{
+							bitLogNetErr(  "Null memory pool item." );
+							Sleep(Milliseconds(1));
+							continue;
+						}
 
-								// Go to the return packet label.
-								break;
-							}
-							m_BanSet.Mutex.Unlock();
+						// Receive a batch of packets.
+						const Int32 count = pShard->pSocket->ReceiveBatch(datagrams, batchSize, Milliseconds(5));
 
-							// Send Deny packet if the server is full.
-							if (m_AddressConnections.size() == m_MaxConnections || m_FreeUserIds.size() == 0)
+						// Handle the packets.
+						for (Int32 i = 0; i < count; i++)
+						{
+							if (datagrams[i].DataSize == 0)
 							{
-								pBuffer[0] = PacketType::Reject;
-								pBuffer[1] = RejectType::Full;
-								m_Socket.Send(pBuffer, RejectPacketSize, address, port);
-
-								// Go to the return packet label.
-								break;
+								continue;
 							}
 
-							// Run the on pre connection function
-							std::vector<Uint32> groupVector;
-							if (OnPreConnection(address, port, groupVector) == false)
+							items[i]->SetUsedSize(datagrams[i].DataSize);
+							if (HandleReceivedPacket(pShard, items[i], datagrams[i].RemoteAddress, datagrams[i].RemotePort))
 							{
-								// SEND REJECT MESSAGE HERE PLEASE.
-								pBuffer[0] = PacketType::Reject;
-								pBuffer[1] = RejectType::Full;
-								m_Socket.Send(pBuffer, RejectPacketSize, address, port);
-
-								break;
+								// The connection owns the item now.
+								items[i] = NULL;
 							}
-
-
-							// Answer the client with an accept packet.
-							pBuffer[0] = PacketType::Accept;
-
-							// Get server time
-							m_ServerTimer.Mutex.Lock();
-							Uint64 serverTime = m_ServerTimer.Value.GetLapsedTime().AsMicroseconds();
-							m_ServerTimer.Mutex.Unlock();
-
-							Uint64 nServerTime = Hton64(serverTime);
-							memcpy(&(pBuffer[3]), &nServerTime, sizeof(Uint64));
-
-							m_Socket.Send(pBuffer, AcceptPacketSize, address, port);
-
-							// Get a user id for this connection
-							const Uint16 userId = m_FreeUserIds.front();
-							m_FreeUserIds.pop();
-
-							// Create the connection
-							Connection * pConnection = new Connection(address, port, userId, m_DefaultSendEntityMessages.Get(), m_LosingConnectionTimeout.Value);
-
-							// Add the client to the address connection map
-							m_AddressConnections.insert(AddressConnectionMapPair(clientAddress, pConnection));
-
-							// Add the client to the user connection map
-							m_UserConnections.insert(UserConnectionMapPair(userId, pConnection));
-
-							// Start client thread.
-							pConnection->StartThreads(this);
-
-							// Run the on post connection function.
-							// Release the connection mutex as well to let the user send messages and such.
-							m_ConnectionMutex.Unlock();
-							OnPostConnection(userId);
-							m_ConnectionMutex.Lock();
 						}
-						// Ping packet.
-						else if (pBuffer[0] == PacketType::Ping && recvSize == PingPacketSize)
+					}
+
+					// Return the items to the memory pool.
+					for (SizeType i = 0; i < batchSize; i++)
+					{
+						if (items[i])
 						{
-							// Send back the ping packet.
-							m_Socket.Send(pBuffer, PingPacketSize, address, port);
+							pShard->pPacketMemoryPool->Return(items[i]);
 						}
-
-					} while (false);
-
-					// Unlock the connection mutex.
-					m_ConnectionMutex.Unlock();
-
-					// Return the item to the memory pool.
-					m_PacketMemoryPool.Mutex.Lock();
-					m_PacketMemoryPool.Value->Return(pItem);
-					m_PacketMemoryPool.Mutex.Unlock();
+					}
 				}
+				);
 			}
-			);
 
 			// Start the entity thread
 			m_EntityThread.Execute([this]()
@@ -460,6 +449,11 @@ namespace Bit
 				// Create an instance of a timestep
 				Timestep timestep;
 
+				// Snapshot messages, datagrams and connections of the entity snapshot broadcast.
+				std::vector<std::vector<Uint8> > messages;
+				std::vector<UdpSocket::Datagram> datagrams;
+				std::vector<Connection *> connections;
+
 				// Run the 
 				while (IsRunning())
 				{
@@ -473,33 +467,85 @@ namespace Bit
 					Time time = Seconds(1.0f / static_cast<Float32>(m_DefaultEntityTicks));
 
 					// Execute the timestep
-					timestep.Execute(time, [this]()
+					timestep.Execute(time, [this, &messages, &datagrams, &connections]()
 					{
-						// Create the entity message
-						std::vector<Uint8> message;
-						if (m_EntityManager.CreateEntityMessage(message, false) == false)
-						{
-							return;
-						}
-
-						// Error check the message
-						if (message.size() == 0)
-						{
-							return;
-						}
+						// Take a snapshot of the entities.
+						m_EntityManager.CreateWorldSnapshot();
 
-						// Send the message to all the connections
+						// Send the snapshot to all the connections,
+						// delta encoded against the last snapshot acknowledged by each client.
+						// The packets are sent by the sockets of the shards owning the connections.
 						m_ConnectionMutex.Lock();
 
-						for (UserConnectionMap::iterator it = m_UserConnections.begin();
-							it != m_UserConnections.end();
-							it++)
+						SizeType messageCount = 0;
+						for (SizeType s = 0; s < m_Shards.size(); s++)
 						{
-							// Should we send entity messages to this client?
-							if (it->second->m_SendEntityMessages.Get())
+							datagrams.clear();
+							connections.clear();
+
+							for (UserConnectionMap::iterator it = m_UserConnections.begin();
+								it != m_UserConnections.end();
+								it++)
 							{
-								// Send unrealiable message.
-								it->second->SendReliable(PacketType::EntityUpdate, reinterpret_cast<Uint8 *>(message.data()), message.size(), true);
+								// Should we send entity messages to this client?
+								if (it->second->m_pShard != m_Shards[s] || it->second->m_SendEntityMessages.Get() == false)
+								{
+									continue;
+								}
+
+								// Reuse the message buffers between the ticks.
+								if (messages.size() <= messageCount)
+								{
+									messages.resize(messageCount + 1);
+								}
+								std::vector<Uint8> & message = messages[messageCount];
+
+								// Make space for the packet header.
+								message.resize(EntitySnapshotPacketSize);
+
+								// Create the snapshot message, of the entities within the view of the client.
+								if (m_EntityManager.CreateSnapshotMessage(	it->second->GetAckedSnapshot(),
+																			it->second->GetEntityView(),
+																			it->second->GetEntityInterest(),
+																			message) == false)
+								{
+									continue;
+								}
+
+								// Compress the snapshot if the client supports it.
+								const Bool compressed = it->second->CompressMessage(message, EntitySnapshotPacketSize);
+
+								// Skip the snapshot if it exceeds the send rate of the connection,
+								// the next one is delta encoded against the same baseline.
+								if (it->second->ConsumeSendBudget(message.size(), false) == false)
+								{
+									continue;
+								}
+
+								// Add the packet type, sequence and the unreliable flag.
+								const Uint16 sequence = Hton16(it->second->GetNextSequence());
+								message[0] = static_cast<Uint8>(PacketType::EntitySnapshot) | (compressed ? CompressedPacketFlag : 0);
+								memcpy(&message[PacketTypeSize], &sequence, SequenceSize);
+								message[PacketTypeSize + SequenceSize] = static_cast<Uint8>(ReliabilityType::Unreliable);
+
+								UdpSocket::Datagram datagram;
+								datagram.pData = message.data();
+								datagram.DataSize = message.size();
+								datagram.RemoteAddress = it->second->GetAddress();
+								datagram.RemotePort = it->second->GetPort();
+								datagrams.push_back(datagram);
+								connections.push_back(it->second);
+								messageCount++;
+							}
+
+							// Send all the packets of the shard at once.
+							if (datagrams.size())
+							{
+								const Int32 sent = m_Shards[s]->pSocket->SendBatch(datagrams.data(), datagrams.size());
+								for (Int32 i = 0; i < sent; i++)
+								{
+									connections[i]->RestartSendTimer();
+								}
 							}
 						}
 
@@ -539,28 +585,24 @@ namespace Bit
 						continue;
 					}
 
-					// Get the packet address and user id.
-					const Uint64 packetAddress = pConnection->GetPackedAddress();
+					// Get the user id.
 					const Uint16 userId = pConnection->GetUserId();
 
-					// Delete the connection
-					delete pConnection;
-
 					// Pop the connection from the list
 					m_CleanupConnections.Value.pop_front();
 
 					// Unlock mutex
 					m_CleanupConnections.Mutex.Unlock();
 
-					// Remove the connection and wait for the connection to thread to finish
+					// Remove the connection before deleting it,
+					// the receive thread of its shard must not pass any more packets to the connection.
 					m_ConnectionMutex.Lock();
 
-					// Erase the connection from the address connections
-					AddressConnectionMap::iterator it1 = m_AddressConnections.find(packetAddress);
-					if (it1 != m_AddressConnections.end())
-					{
-						m_AddressConnections.erase(it1);
-					}
+					// Erase the connection from the address connections of its shard
+					ReceiveShard * pShard = pConnection->m_pShard;
+					pShard->ConnectionMutex.Lock();
+					pShard->Connections.Remove(pConnection->GetAddress().GetAddress(), pConnection->GetPort());
+					pShard->ConnectionMutex.Unlock();
 
 					// Erase the connection from the user id connections
 					UserConnectionMap::iterator it2 = m_UserConnections.find(userId);
@@ -569,7 +611,14 @@ namespace Bit
 						m_UserConnections.erase(it2);
 					}
 
+					// Unlock the connection mutex
+					m_ConnectionMutex.Unlock();
+
+					// Delete the connection
+					delete pConnection;
+
 					// Restore the user id to the free user id queue
+					m_ConnectionMutex.Lock();
 					m_FreeUserIds.push(userId);
 
 					// Unlock the connection mutex
@@ -606,39 +655,34 @@ namespace Bit
 				m_CleanupConnections.Mutex.Unlock();
 
 
-				// Wait for the main thread to finish
-				m_MainThread.Finish();
+				// Wait for the receive threads to finish
+				for (SizeType i = 0; i < m_Shards.size(); i++)
+				{
+					m_Shards[i]->ReceiveThread.Finish();
+				}
 
-				// Disconnect all the connections
+				// Disconnect and delete all the connections
 				m_ConnectionMutex.Lock();
-				AddressConnectionMap::iterator it = m_AddressConnections.begin();
-				while (it != m_AddressConnections.end())
+				for (UserConnectionMap::iterator it = m_UserConnections.begin(); it != m_UserConnections.end(); it++)
 				{
-					// Disconnect and delete the connection.
-					Connection * pConnection = it->second;
-					delete pConnection;
-
-					// Erase the connection
-					m_AddressConnections.erase(it);
-
-					// Get the beginning again.
-					it = m_AddressConnections.begin();
+					delete it->second;
 				}
 
-				// Remove all the user connections
+				// Remove all the user and address connections
 				m_UserConnections.clear();
+				for (SizeType i = 0; i < m_Shards.size(); i++)
+				{
+					m_Shards[i]->Connections.Clear();
+				}
 
 				// Unlock the mutex
 				m_ConnectionMutex.Unlock();
 
-				// Delete the packet memory pool
-				if (m_PacketMemoryPool.Get())
-				{
-					delete m_PacketMemoryPool.Get();
-				}
+				// Stop the worker pool, all the connections are removed.
+				m_WorkerPool.Stop();
 
-				// Close the sockets
-				m_Socket.Close();
+				// Close the sockets and delete the packet memory pools
+				DeleteShards();
 
 			}
 		}
@@ -670,46 +714,63 @@ namespace Bit
 				return false;
 			}
 
-			m_UserMessageListeners.Mutex.Lock();
+			// Give the message an id.
+			m_UserMessageTable.Mutex.Lock();
+			const SizeType messageCount = m_UserMessageTable.Value.GetSize();
+			const Uint16 id = m_UserMessageTable.Value.Add(m_MessageName);
+			std::vector<Uint8> table;
+			m_UserMessageTable.Value.Encode(table, static_cast<Uint16>(messageCount));
+			m_UserMessageTable.Mutex.Unlock();
+
+			if (id == NameMessageId)
+			{
+				bitLogNetErr("Failed to hook user message: " << m_MessageName);
+				return false;
+			}
 
-			// Find the user mesage set pointer.
-			UserMessageListenerSet * pMessageSet = NULL;
+			// Add the listener to the handler of the message id.
+			m_UserMessageHandlers.Mutex.Lock();
 
-			// Find the message
-			UserMessageListenerMap::iterator it = m_UserMessageListeners.Value.find(m_MessageName);
-			if (it == m_UserMessageListeners.Value.end())
+			if (m_UserMessageHandlers.Value.size() <= id)
 			{
-				// Create a new message
-				pMessageSet = new UserMessageListenerSet;
-				m_UserMessageListeners.Value.insert(UserMessageListenerPair(m_MessageName, pMessageSet));
+				m_UserMessageHandlers.Value.resize(id + 1);
 			}
-			else
+
+			UserMessageHandler & handler = m_UserMessageHandlers.Value[id];
+			handler.Name = m_MessageName;
+			if (std::find(handler.Listeners.begin(), handler.Listeners.end(), p_pListener) == handler.Listeners.end())
 			{
-				pMessageSet = it->second;
+				handler.Listeners.push_back(p_pListener);
 			}
 
-			// Add the listener to the message set
-			pMessageSet->insert(p_pListener);
+			m_UserMessageHandlers.Mutex.Unlock();
 
-			m_UserMessageListeners.Mutex.Unlock();
+			// Tell the connected clients about the new message id,
+			// the clients connecting from now on get it in the full table.
+			if (table.size())
+			{
+				m_ConnectionMutex.Lock();
+				for (UserConnectionMap::iterator it = m_UserConnections.begin(); it != m_UserConnections.end(); it++)
+				{
+					it->second->SendReliable(PacketType::MessageTable, table.data(), table.size(), true);
+				}
+				m_ConnectionMutex.Unlock();
+			}
 
 			return true;
 		}
 
 		void Server::UnhookUserMessages()
 		{
-			m_UserMessageListeners.Mutex.Lock();
+			// Keep the message ids, the clients may still send messages by them.
+			m_UserMessageHandlers.Mutex.Lock();
 
-			for (UserMessageListenerMap::iterator it = m_UserMessageListeners.Value.begin();
-				it != m_UserMessageListeners.Value.end();
-				it++)
+			for (SizeType i = 0; i < m_UserMessageHandlers.Value.size(); i++)
 			{
-				delete it->second;
+				m_UserMessageHandlers.Value[i].Listeners.clear();
 			}
-			m_UserMessageListeners.Value.clear();
 
-
-			m_UserMessageListeners.Mutex.Unlock();
+			m_UserMessageHandlers.Mutex.Unlock();
 		}
 
 		Uint16 Server::GetHostPort()
@@ -726,7 +787,7 @@ namespace Bit
 		{
 			// Get the count.
 			m_ConnectionMutex.Lock();
-			SizeType count = m_AddressConnections.size();
+			SizeType count = m_UserConnections.size();
 			m_ConnectionMutex.Unlock();
 
 			// Return the count.
@@ -755,6 +816,244 @@ namespace Bit
 			m_ConnectionMutex.Unlock();
 		}
 
+		Bool Server::GetUserStatistics(const Uint16 p_UserId, ConnectionStatistics & p_Statistics)
+		{
+			// Find the client.
+			m_ConnectionMutex.Lock();
+
+			UserConnectionMap::iterator it = m_UserConnections.find(p_UserId);
+			if (it == m_UserConnections.end())
+			{
+				m_ConnectionMutex.Unlock();
+				return false;
+			}
+
+			p_Statistics = it->second->GetStatistics();
+
+			m_ConnectionMutex.Unlock();
+			return true;
+		}
+
+		Bool Server::SetUserView(const Uint16 p_UserId, const Vector3f32 & p_Position, const Float32 p_Radius)
+		{
+			// Find the client.
+			m_ConnectionMutex.Lock();
+
+			UserConnectionMap::iterator it = m_UserConnections.find(p_UserId);
+			if (it == m_UserConnections.end())
+			{
+				m_ConnectionMutex.Unlock();
+				return false;
+			}
+
+			it->second->SetEntityView(EntityInterest::View(p_Position, p_Radius));
+
+			m_ConnectionMutex.Unlock();
+			return true;
+		}
+
+		Bool Server::ClearUserView(const Uint16 p_UserId)
+		{
+			// Find the client.
+			m_ConnectionMutex.Lock();
+
+			UserConnectionMap::iterator it = m_UserConnections.find(p_UserId);
+			if (it == m_UserConnections.end())
+			{
+				m_ConnectionMutex.Unlock();
+				return false;
+			}
+
+			it->second->SetEntityView(EntityInterest::View());
+
+			m_ConnectionMutex.Unlock();
+			return true;
+		}
+
+		Bool Server::HandleReceivedPacket(ReceiveShard * p_pShard, ConcurrentMemoryPool<Uint8>::Item * p_pItem, const Address & p_Address, const Uint16 p_Port)
+		{
+			Uint8 * pBuffer = p_pItem->GetData();
+			const SizeType recvSize = p_pItem->GetUsedSize();
+
+			// Check if we received a packet from a connected client,
+			// the kernel hashes the flow of the client to the same shard for every packet.
+			p_pShard->ConnectionMutex.Lock();
+			Connection * pConnected = p_pShard->Connections.Find(p_Address.GetAddress(), p_Port);
+			if (pConnected)
+			{
+				// Send the packet to the client thread.
+				pConnected->AddReceivedData(p_pItem);
+				p_pShard->ConnectionMutex.Unlock();
+				return true;
+			}
+			p_pShard->ConnectionMutex.Unlock();
+
+			// Ping packet, no connection needed.
+			if (pBuffer[0] == PacketType::Ping && recvSize == PingPacketSize)
+			{
+				// Send back the ping packet.
+				p_pShard->pSocket->Send(pBuffer, PingPacketSize, p_Address, p_Port);
+				return false;
+			}
+
+			// Answer connect packets with a challenge, without creating any state.
+			if (pBuffer[0] == PacketType::Connect)
+			{
+				// Make sure that the identifier is right.
+				if (recvSize == m_Identifier.size() + ConnectPacketSize &&
+					memcmp(pBuffer + ConnectPacketSize, m_Identifier.data(), m_Identifier.size()) == 0)
+				{
+					// Keep the connect sequence, followed by the cookie of the client.
+					const Uint64 cookie = Hton64(m_ConnectCookie.Create(p_Address.GetAddress(), p_Port, GetServerTime()));
+					pBuffer[0] = PacketType::Challenge;
+					memcpy(&pBuffer[ConnectPacketSize], &cookie, sizeof(Uint64));
+					p_pShard->pSocket->Send(pBuffer, ChallengePacketSize, p_Address, p_Port);
+				}
+
+				return false;
+			}
+
+			// Any other packet must be a challenge response, with the right identifier and cookie.
+			if (pBuffer[0] != PacketType::ChallengeResponse ||
+				recvSize != m_Identifier.size() + ChallengeResponsePacketSize ||
+				memcmp(pBuffer + ChallengeResponsePacketSize, m_Identifier.data(), m_Identifier.size()) != 0)
+			{
+				return false;
+			}
+
+			Uint64 cookie = 0;
+			memcpy(&cookie, &pBuffer[ConnectPacketSize], sizeof(Uint64));
+			if (m_ConnectCookie.Verify(Ntoh64(cookie), p_Address.GetAddress(), p_Port, GetServerTime()) == false)
+			{
+				return false;
+			}
+
+			// The client proved that it receives packets sent to its address, lock the connection mutex.
+			m_ConnectionMutex.Lock();
+
+			// Use a do while loop with false condition in order to 
+			// jump over and skip code later.
+			do
+			{
+				// This is not a packet from an already connected client,
+				// the client answered the challenge and is trying to connect.
+
+				// Check if the p_Address is banned
+				m_BanSet.Mutex.Lock();
+				if (m_BanSet.Value.find(p_Address.GetAddress()) != m_BanSet.Value.end())
+				{
+					// Send ban packet
+					pBuffer[0] = PacketType::Reject;
+					pBuffer[1] = RejectType::Banned;
+					p_pShard->pSocket->Send(pBuffer, RejectPacketSize, p_Address, p_Port);
+
+					// Unlock the ban set mutex.
+					m_BanSet.Mutex.Unlock();
+
+					// Go to the return packet label.
+					break;
+				}
+				m_BanSet.Mutex.Unlock();
+
+				// Send Deny packet if the server is full.
+				if (m_UserConnections.size() == m_MaxConnections || m_FreeUserIds.size() == 0)
+				{
+					pBuffer[0] = PacketType::Reject;
+					pBuffer[1] = RejectType::Full;
+					p_pShard->pSocket->Send(pBuffer, RejectPacketSize, p_Address, p_Port);
+
+					// Go to the return packet label.
+					break;
+				}
+
+				// Run the on pre connection function
+				std::vector<Uint32> groupVector;
+				if (OnPreConnection(p_Address, p_Port, groupVector) == false)
+				{
+					// SEND REJECT MESSAGE HERE PLEASE.
+					pBuffer[0] = PacketType::Reject;
+					pBuffer[1] = RejectType::Full;
+					p_pShard->pSocket->Send(pBuffer, RejectPacketSize, p_Address, p_Port);
+
+					break;
+				}
+
+
+				// Answer the client with an accept packet.
+				pBuffer[0] = PacketType::Accept;
+
+				// Get server time
+				m_ServerTimer.Mutex.Lock();
+				Uint64 serverTime = m_ServerTimer.Value.GetLapsedTime().AsMicroseconds();
+				m_ServerTimer.Mutex.Unlock();
+
+				Uint64 nServerTime = Hton64(serverTime);
+				memcpy(&(pBuffer[3]), &nServerTime, sizeof(Uint64));
+
+				p_pShard->pSocket->Send(pBuffer, AcceptPacketSize, p_Address, p_Port);
+
+				// Get a user id for this connection
+				const Uint16 userId = m_FreeUserIds.front();
+				m_FreeUserIds.pop();
+
+				// Create the connection
+				Connection * pConnection = new Connection(p_Address, p_Port, userId, m_DefaultSendEntityMessages.Get(), m_LosingConnectionTimeout.Value, &m_ReassemblyBudget, m_CongestionControl, m_MaxSendRate);
+
+				// Add the client to the address connection table of the shard
+				p_pShard->ConnectionMutex.Lock();
+				p_pShard->Connections.Add(p_Address.GetAddress(), p_Port, pConnection);
+				p_pShard->ConnectionMutex.Unlock();
+
+				// Add the client to the user connection map
+				m_UserConnections.insert(UserConnectionMapPair(userId, pConnection));
+
+				// Set the delivery types of the message channels.
+				for (Uint8 i = 0; i < MaxChannelCount; i++)
+				{
+					pConnection->m_Channels.Value.SetDelivery(i, m_ChannelDeliveries[i]);
+				}
+
+				// Start client thread, or let the worker pool drive the client.
+				pConnection->StartThreads(this, p_pShard, m_UseWorkerPool ? &m_WorkerPool : NULL);
+
+				// Send the entity class table, the snapshots are refering to the classes by id.
+				std::vector<Uint8> classTable;
+				m_EntityManager.CreateClassTableMessage(classTable);
+				pConnection->SendReliable(PacketType::EntityClasses, classTable.data(), classTable.size(), true);
+
+				// Send the user message ids, the client sends the hooked messages by id from now on.
+				std::vector<Uint8> messageTable;
+				m_UserMessageTable.Mutex.Lock();
+				m_UserMessageTable.Value.Encode(messageTable);
+				m_UserMessageTable.Mutex.Unlock();
+				if (messageTable.size())
+				{
+					pConnection->SendReliable(PacketType::MessageTable, messageTable.data(), messageTable.size(), true);
+				}
+
+				// Offer the compression, by the dictionary if any.
+				// The payloads are not compressed until the client answers.
+				if (m_CompressionThreshold)
+				{
+					Uint32 checksum = Hton32(m_CompressionDictionary.GetChecksum());
+					pConnection->SendReliable(PacketType::Compression, &checksum, sizeof(checksum), true);
+				}
+
+				// Run the on post connection function.
+				// Release the connection mutex as well to let the user send messages and such.
+				m_ConnectionMutex.Unlock();
+				OnPostConnection(userId);
+				m_ConnectionMutex.Lock();
+
+			} while (false);
+
+			// Unlock the connection mutex.
+			m_ConnectionMutex.Unlock();
+
+			// The item was not passed to any connection.
+			return false;
+		}
+
 		void Server::AddConnectionForCleanup( Connection * p_pConnection )
 		{
 			// Add the connection to the cleanup thread.
@@ -767,6 +1066,7 @@ namespace Bit
 			{
 				if( p_pConnection == (*it) )
 				{
+					m_CleanupConnections.Mutex.Unlock( );
 					return;
 				}
 			}
@@ -778,6 +1078,28 @@ namespace Bit
 			m_CleanupSemaphore.Release( );
 		}
 
+		void Server::DeleteShards()
+		{
+			for (SizeType i = 0; i < m_Shards.size(); i++)
+			{
+				ReceiveShard * pShard = m_Shards[i];
+
+				// Close and delete the socket
+				pShard->pSocket->Close();
+				delete pShard->pSocket;
+
+				// Delete the packet memory pool
+				if (pShard->pPacketMemoryPool)
+				{
+					delete pShard->pPacketMemoryPool;
+				}
+
+				delete pShard;
+			}
+
+			m_Shards.clear();
+		}
+
 	}
 
 }
\ No newline at end of file
@@ -0,0 +1,136 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/TrafficRecorder.hpp>
+#include <Bit/Network/Net/Private/RecordingSocket.hpp>
+#include <Bit/System/SmartMutex.hpp>
+#include <Bit/System/Log.hpp>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		// Static variables
+		static const SizeType g_FlushSize = 64 * 1024;	///< Size of the buffered records written to the file at once.
+
+		TrafficRecorder::TrafficRecorder( ) :
+			m_LastTime( 0 ),
+			m_RecordCount( 0 )
+		{
+		}
+
+		TrafficRecorder::~TrafficRecorder( )
+		{
+			Close( );
+		}
+
+		Bool TrafficRecorder::Open( const std::string & p_Filename )
+		{
+			Close( );
+
+			SmartMutex mutex( m_Mutex );
+			mutex.Lock( );
+
+			m_File.open( p_Filename.c_str( ), std::fstream::binary );
+			if( m_File.is_open( ) == false )
+			{
+				bitLogNetErr( "Failed to open traffic log: " << p_Filename );
+				return false;
+			}
+
+			m_Buffer.clear( );
+			TrafficLog::WriteHeader( m_Buffer );
+			m_LastTime = 0;
+			m_RecordCount = 0;
+			m_Timer.Start( );
+
+			return true;
+		}
+
+		void TrafficRecorder::Close( )
+		{
+			SmartMutex mutex( m_Mutex );
+			mutex.Lock( );
+
+			if( m_File.is_open( ) == false )
+			{
+				return;
+			}
+
+			m_File.write( reinterpret_cast<const char *>( m_Buffer.data( ) ), m_Buffer.size( ) );
+			m_File.close( );
+			m_Buffer.clear( );
+		}
+
+		Uint64 TrafficRecorder::GetRecordCount( )
+		{
+			SmartMutex mutex( m_Mutex );
+			mutex.Lock( );
+
+			return m_RecordCount;
+		}
+
+		Private::UdpSocketBase * TrafficRecorder::CreateSocket( )
+		{
+			return new RecordingSocket( this );
+		}
+
+		void TrafficRecorder::Record(	const TrafficDirection::eDirection p_Direction,
+										const Address & p_RemoteAddress,
+										const Uint16 p_RemotePort,
+										const void * p_pHeader,
+										const SizeType p_HeaderSize,
+										const void * p_pData,
+										const SizeType p_DataSize )
+		{
+			SmartMutex mutex( m_Mutex );
+			mutex.Lock( );
+
+			if( m_File.is_open( ) == false )
+			{
+				return;
+			}
+
+			// The records are written in order of the clock, even if several threads are recording.
+			const Uint64 time = m_Timer.GetLapsedTime( ).AsMicroseconds( );
+			const Uint64 timeDelta = time > m_LastTime ? time - m_LastTime : 0;
+			m_LastTime += timeDelta;
+
+			TrafficLog::WriteRecord(	m_Buffer, timeDelta, p_Direction, p_RemoteAddress, p_RemotePort,
+										p_pHeader, p_HeaderSize, p_pData, p_DataSize );
+			m_RecordCount++;
+
+			// Write the records to the file once in a while.
+			if( m_Buffer.size( ) >= g_FlushSize )
+			{
+				m_File.write( reinterpret_cast<const char *>( m_Buffer.data( ) ), m_Buffer.size( ) );
+				m_Buffer.clear( );
+			}
+		}
+
+	}
+
+}
@@ -0,0 +1,185 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/TrafficReplay.hpp>
+#include <Bit/Network/Net/Private/ReplaySocket.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Bit/System/Log.hpp>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		TrafficReplay::TrafficReplay( ) :
+			m_RemoteAddress( 0 ),
+			m_RemotePort( 0 ),
+			m_FirstTime( 0 ),
+			m_Speed( 1.0f ),
+			m_SocketCount( 0 ),
+			m_StartTime( 0 ),
+			m_ReplayedCount( 0 ),
+			m_SentCount( 0 )
+		{
+		}
+
+		Bool TrafficReplay::Load( const std::string & p_Filename )
+		{
+			TrafficLog::RecordVector records;
+			if( TrafficLog::Read( p_Filename, records ) == false )
+			{
+				bitLogNetErr( "Failed to load traffic log: " << p_Filename );
+				return false;
+			}
+
+			m_RemoteAddress = Address( 0 );
+			m_RemotePort = 0;
+			m_FirstTime = 0;
+			if( records.size( ) )
+			{
+				m_RemoteAddress = records.front( ).RemoteAddress;
+				m_RemotePort = records.front( ).RemotePort;
+				m_FirstTime = records.front( ).Time;
+			}
+
+			// Keep the received datagrams, the sent ones are sent again by the replayed server or client.
+			m_Records.clear( );
+			for( TrafficLog::RecordVector::iterator it = records.begin( ); it != records.end( ); it++ )
+			{
+				if( it->Direction == TrafficDirection::Received )
+				{
+					m_Records.push_back( TrafficRecord( ) );
+					m_Records.back( ).Time = it->Time;
+					m_Records.back( ).Direction = it->Direction;
+					m_Records.back( ).RemoteAddress = it->RemoteAddress;
+					m_Records.back( ).RemotePort = it->RemotePort;
+					m_Records.back( ).Data.swap( it->Data );
+				}
+			}
+
+			m_ReplayedCount.Set( 0 );
+			m_SentCount.Set( 0 );
+
+			return true;
+		}
+
+		void TrafficReplay::SetSpeed( const Float32 p_Speed )
+		{
+			m_Speed = p_Speed;
+		}
+
+		Bool TrafficReplay::GetRemoteEndpoint( Address & p_Address, Uint16 & p_Port ) const
+		{
+			if( m_RemotePort == 0 )
+			{
+				return false;
+			}
+
+			p_Address = m_RemoteAddress;
+			p_Port = m_RemotePort;
+			return true;
+		}
+
+		SizeType TrafficReplay::GetRecordCount( ) const
+		{
+			return m_Records.size( );
+		}
+
+		Uint64 TrafficReplay::GetReplayedCount( )
+		{
+			return m_ReplayedCount.Get( );
+		}
+
+		Uint64 TrafficReplay::GetSentCount( )
+		{
+			return m_SentCount.Get( );
+		}
+
+		Bool TrafficReplay::IsFinished( )
+		{
+			return m_ReplayedCount.Get( ) >= static_cast<Uint64>( m_Records.size( ) );
+		}
+
+		Private::UdpSocketBase * TrafficReplay::CreateSocket( )
+		{
+			return new ReplaySocket( this );
+		}
+
+		Uint32 TrafficReplay::AddSocket( )
+		{
+			m_SocketCount.Mutex.Lock( );
+
+			// Start the replay clock by the first socket.
+			if( m_SocketCount.Value == 0 )
+			{
+				m_StartTime.Set( Timer::GetSystemTime( ) );
+			}
+			const Uint32 index = m_SocketCount.Value++;
+
+			m_SocketCount.Mutex.Unlock( );
+
+			return index;
+		}
+
+		void TrafficReplay::RemoveSocket( )
+		{
+			m_SocketCount.Mutex.Lock( );
+			if( m_SocketCount.Value )
+			{
+				m_SocketCount.Value--;
+			}
+			m_SocketCount.Mutex.Unlock( );
+		}
+
+		Uint32 TrafficReplay::GetSocketIndex( const TrafficRecord & p_Record )
+		{
+			const Uint32 socketCount = m_SocketCount.Get( );
+			if( socketCount <= 1 )
+			{
+				return 0;
+			}
+
+			// Hash the endpoint, every flow is received by the same socket.
+			Uint32 hash = p_Record.RemoteAddress.GetAddress( ) * 2654435761UL;
+			hash ^= static_cast<Uint32>( p_Record.RemotePort ) * 40503UL;
+			hash ^= hash >> 16;
+			return hash % socketCount;
+		}
+
+		Uint64 TrafficReplay::GetTimeUntilDue( const TrafficRecord & p_Record )
+		{
+			if( m_Speed <= 0.0f )
+			{
+				return 0;
+			}
+
+			const Uint64 dueTime = static_cast<Uint64>( static_cast<Float64>( p_Record.Time - m_FirstTime ) / static_cast<Float64>( m_Speed ) );
+			const Uint64 time = Timer::GetSystemTime( ) - m_StartTime.Get( );
+			return dueTime > time ? dueTime - time : 0;
+		}
+
+	}
+
+}
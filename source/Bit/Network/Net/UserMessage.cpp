@@ -39,23 +39,19 @@ namespace Bit
 			m_Name( p_Name ),
 			m_pClient( p_pClient )
 		{
+			// Send the message by the id the server gave it, or by name if not told yet.
+			m_pClient->m_UserMessageIds.Mutex.Lock( );
+			const Uint16 id = m_pClient->m_UserMessageIds.Value.Find( p_Name );
+			m_pClient->m_UserMessageIds.Mutex.Unlock( );
+
 			if( p_MessageSize > 0 )
 			{
 				m_Message.reserve( static_cast<MessageVector::size_type>( p_MessageSize ) +
-								   static_cast<MessageVector::size_type>( p_Name.size( ) ) + 2 );
-			}
-			else
-			{
-				m_Message.reserve( static_cast<MessageVector::size_type>( p_Name.size( ) ) + 2  );
+								   static_cast<MessageVector::size_type>( p_Name.size( ) ) + MessageHeaderSize + 1 );
 			}
 
-			// Add the message type and message name
-			m_Message.push_back( static_cast<Uint8>( eMessageType::UserMessageType ) );
-			for( std::string::size_type i = 0; i < p_Name.size( ); i++ )
-			{
-				m_Message.push_back( static_cast<Uint8>( p_Name[ i ] ) );
-			}
-			m_Message.push_back( 0 );
+			// Add the message type and message id
+			MessageTable::WriteHeader( m_Message, id, p_Name );
 		}
 
 		void UserMessage::WriteByte( const Uint8 p_Byte )
@@ -103,6 +99,10 @@ namespace Bit
 
 		Bool UserMessage::Send( const Bool p_Reliable )
 		{
+			// Send the message outside of the channels.
+			const DeliveryType::eType delivery = p_Reliable ? DeliveryType::ReliableUnordered : DeliveryType::Unreliable;
+			MessageChannels::WriteChannel( m_Message.data( ), static_cast<Uint8>( delivery << ChannelDeliveryShift ), 0 );
+
 			// Send the message
 			if( p_Reliable )
 			{
@@ -116,6 +116,35 @@ namespace Bit
 			return true;
 		}
 
+		Bool UserMessage::SendOnChannel( const Uint8 p_Channel )
+		{
+			if( p_Channel >= MaxChannelCount )
+			{
+				return false;
+			}
+
+			// Get the sequence of the message in the channel.
+			Uint8 channel = 0;
+			Uint16 sequence = 0;
+			m_pClient->m_Channels.Mutex.Lock( );
+			const Bool reliable = m_pClient->m_Channels.Value.GetNextMessage( p_Channel, channel, sequence );
+			m_pClient->m_Channels.Mutex.Unlock( );
+
+			MessageChannels::WriteChannel( m_Message.data( ), channel, sequence );
+
+			// Send the message
+			if( reliable )
+			{
+				m_pClient->SendReliable( PacketType::UserMessage, reinterpret_cast<void*>( m_Message.data( ) ), m_Message.size( ), true );
+			}
+			else
+			{
+				m_pClient->SendUnreliable(PacketType::UserMessage, reinterpret_cast<void*>(m_Message.data()), m_Message.size(), true, true);
+			}
+
+			return true;
+		}
+
 		const std::string & UserMessage::GetName( ) const
 		{
 			return m_Name;
@@ -23,6 +23,7 @@
 
 #include <Bit/Network/Net/UserMessageDecoder.hpp>
 #include <Bit/Network/Socket.hpp>
+#include <cstring>
 #include <Bit/System/MemoryLeak.hpp>
 
 namespace Bit
@@ -33,7 +34,7 @@ namespace Bit
 
 		UserMessageDecoder::UserMessageDecoder( const std::string & p_Name,
 												const Uint16 p_UserId, 
-												Uint8 *		p_pMessage,
+												const Uint8 *	p_pMessage,
 												SizeType	p_MessageSize ) :
 			m_Name( p_Name ),
 			m_UserId( p_UserId ),
@@ -113,7 +114,7 @@ namespace Bit
 			const SizeType length = stringEnd - m_Position;
 
 			// Copy the string.
-			p_String.assign( reinterpret_cast<char*>(m_pMessage + m_Position), length );
+			p_String.assign( reinterpret_cast<const char*>(m_pMessage + m_Position), length );
 
 			// Increment the position by the length + 1
 			m_Position += length + 1;
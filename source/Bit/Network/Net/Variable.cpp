@@ -23,6 +23,7 @@
 
 #include <Bit/Network/Net/Variable.hpp>
 #include <Bit/Network/Net/Private/EntityChanger.hpp>
+#include <cstring>
 #include <Bit/System/MemoryLeak.hpp>
 
 namespace Bit
@@ -34,6 +35,8 @@ namespace Bit
 		VariableBase::VariableBase( SizeType p_Size ) :
 			m_Size( p_Size ),
 			m_pParent( NULL ),
+			m_Id( 0 ),
+			m_Sequence( 0 ),
 			m_LastSequence( 0 )
 		{
 		}
@@ -77,6 +80,58 @@ namespace Bit
 		{
 		}
 
+		Uint32 VariableBase::BeginWrite()
+		{
+			// Make the sequence odd, the sequence is already odd if another thread is writing.
+			Uint32 sequence = m_Sequence.load(std::memory_order_relaxed);
+			while ((sequence & 1) ||
+				m_Sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed) == false)
+			{
+				sequence = m_Sequence.load(std::memory_order_relaxed);
+			}
+
+			// Keep the value writes after the sequence write.
+			std::atomic_thread_fence(std::memory_order_release);
+			return sequence + 1;
+		}
+
+		void VariableBase::EndWrite(const Uint32 p_Sequence)
+		{
+			m_Sequence.store(p_Sequence + 1, std::memory_order_release);
+		}
+
+		Uint32 VariableBase::BeginRead() const
+		{
+			// Wait for the writer to finish.
+			Uint32 sequence = m_Sequence.load(std::memory_order_acquire);
+			while (sequence & 1)
+			{
+				sequence = m_Sequence.load(std::memory_order_acquire);
+			}
+
+			return sequence;
+		}
+
+		Bool VariableBase::EndRead(const Uint32 p_Sequence) const
+		{
+			// Keep the value reads before the sequence read.
+			std::atomic_thread_fence(std::memory_order_acquire);
+			return m_Sequence.load(std::memory_order_relaxed) == p_Sequence;
+		}
+
+		void VariableBase::LoadData(void * p_pData)
+		{
+			const void * pValue = GetData();
+
+			Uint32 sequence;
+			do
+			{
+				sequence = BeginRead();
+				memcpy(p_pData, pValue, m_Size);
+			}
+			while (EndRead(sequence) == false);
+		}
+
 	}
 
 }
\ No newline at end of file
@@ -0,0 +1,414 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/Network/Net/VariableEncoding.hpp>
+#include <Bit/Network/Socket.hpp>
+#include <cstring>
+#include <cmath>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	namespace Net
+	{
+
+		// Largest value of the three smallest components of a unit quaternion, 1 / sqrt(2).
+		static const Float32 g_SmallestThreeRange = 0.70710678f;
+
+		VariableEncoding::VariableEncoding( ) :
+			m_Type( Type::Raw ),
+			m_Minimum( 0.0f ),
+			m_Maximum( 0.0f ),
+			m_Precision( 0.0f ),
+			m_Steps( 0 ),
+			m_Bits( 0 )
+		{
+		}
+
+		VariableEncoding VariableEncoding::Quantize(	const Float32 p_Minimum,
+														const Float32 p_Maximum,
+														const Float32 p_Precision )
+		{
+			VariableEncoding encoding;
+			encoding.m_Type = Type::Quantized;
+			encoding.m_Minimum = p_Minimum;
+			encoding.m_Maximum = p_Maximum;
+			encoding.m_Precision = p_Precision;
+			encoding.CalculateBits( );
+			return encoding;
+		}
+
+		VariableEncoding VariableEncoding::SmallestThree( const Uint8 p_ComponentBits )
+		{
+			VariableEncoding encoding;
+			encoding.m_Type = Type::SmallestThree;
+			encoding.m_Bits = p_ComponentBits > 31 ? 31 : ( p_ComponentBits < 2 ? 2 : p_ComponentBits );
+			return encoding;
+		}
+
+		VariableEncoding VariableEncoding::Boolean( )
+		{
+			VariableEncoding encoding;
+			encoding.m_Type = Type::Boolean;
+			return encoding;
+		}
+
+		VariableEncoding VariableEncoding::VarInt( const Bool p_Signed )
+		{
+			VariableEncoding encoding;
+			encoding.m_Type = p_Signed ? Type::SignedVarInt : Type::VarInt;
+			return encoding;
+		}
+
+		VariableEncoding::Type::eType VariableEncoding::GetType( ) const
+		{
+			return m_Type;
+		}
+
+		Bool VariableEncoding::IsValid( const SizeType p_Size ) const
+		{
+			switch( m_Type )
+			{
+				case Type::Raw:
+					return true;
+				case Type::Quantized:
+					return p_Size && ( p_Size % sizeof( Float32 ) ) == 0 && m_Precision > 0.0f && m_Maximum >= m_Minimum;
+				case Type::SmallestThree:
+					return p_Size == sizeof( Float32 ) * 4;
+				case Type::Boolean:
+					return p_Size == 1;
+				case Type::VarInt:
+				case Type::SignedVarInt:
+					return p_Size == 1 || p_Size == 2 || p_Size == 4 || p_Size == 8;
+				default:
+					break;
+			}
+
+			return false;
+		}
+
+		void VariableEncoding::Write( BitWriter & p_Writer, const void * p_pData, const SizeType p_Size ) const
+		{
+			switch( m_Type )
+			{
+				case Type::Quantized:
+				{
+					const SizeType count = p_Size / sizeof( Float32 );
+					for( SizeType i = 0; i < count; i++ )
+					{
+						Float32 value = 0.0f;
+						memcpy( &value, reinterpret_cast<const Uint8 *>( p_pData ) + i * sizeof( Float32 ), sizeof( Float32 ) );
+
+						// Clamp the value to the range, NaN ends up at the minimum.
+						if( ( value > m_Minimum ) == false )
+						{
+							value = m_Minimum;
+						}
+						else if( value > m_Maximum )
+						{
+							value = m_Maximum;
+						}
+
+						const Float64 step = std::floor( ( static_cast<Float64>( value ) - m_Minimum ) / m_Precision + 0.5 );
+						p_Writer.WriteBits( step >= m_Steps ? m_Steps : static_cast<Uint32>( step ), m_Bits );
+					}
+				}
+				break;
+				case Type::SmallestThree:
+				{
+					Float32 components[ 4 ];
+					memcpy( components, p_pData, sizeof( components ) );
+
+					// Find the largest component, it's calculated from the other three.
+					Uint32 largest = 0;
+					for( Uint32 i = 1; i < 4; i++ )
+					{
+						if( std::fabs( components[ i ] ) > std::fabs( components[ largest ] ) )
+						{
+							largest = i;
+						}
+					}
+
+					// q and -q are the same rotation, make the largest component positive.
+					const Float32 sign = components[ largest ] < 0.0f ? -1.0f : 1.0f;
+					const Uint32 maxStep = ( 1UL << m_Bits ) - 1;
+
+					p_Writer.WriteBits( largest, 2 );
+					for( Uint32 i = 0; i < 4; i++ )
+					{
+						if( i == largest )
+						{
+							continue;
+						}
+
+						Float32 value = components[ i ] * sign;
+						value = value < -g_SmallestThreeRange ? -g_SmallestThreeRange : ( value > g_SmallestThreeRange ? g_SmallestThreeRange : value );
+
+						const Uint32 step = static_cast<Uint32>( ( value + g_SmallestThreeRange ) / ( 2.0f * g_SmallestThreeRange ) * maxStep + 0.5f );
+						p_Writer.WriteBits( step > maxStep ? maxStep : step, m_Bits );
+					}
+				}
+				break;
+				case Type::Boolean:
+				{
+					p_Writer.WriteBits( *reinterpret_cast<const Uint8 *>( p_pData ) ? 1 : 0, 1 );
+				}
+				break;
+				case Type::VarInt:
+				case Type::SignedVarInt:
+				{
+					Uint64 value = 0;
+					Int64 signedValue = 0;
+					switch( p_Size )
+					{
+						case 1: { Uint8 v; memcpy( &v, p_pData, 1 ); value = v; signedValue = static_cast<Int8>( v ); } break;
+						case 2: { Uint16 v; memcpy( &v, p_pData, 2 ); value = v; signedValue = static_cast<Int16>( v ); } break;
+						case 4: { Uint32 v; memcpy( &v, p_pData, 4 ); value = v; signedValue = static_cast<Int32>( v ); } break;
+						default: { Uint64 v; memcpy( &v, p_pData, 8 ); value = v; signedValue = static_cast<Int64>( v ); } break;
+					}
+
+					// Zig-zag encode signed values.
+					if( m_Type == Type::SignedVarInt )
+					{
+						value = ( static_cast<Uint64>( signedValue ) << 1 ) ^ static_cast<Uint64>( signedValue >> 63 );
+					}
+
+					p_Writer.WriteVarUint( value );
+				}
+				break;
+				default:
+				{
+					p_Writer.WriteBytes( p_pData, p_Size );
+				}
+				break;
+			}
+		}
+
+		Bool VariableEncoding::Read( BitReader & p_Reader, void * p_pData, const SizeType p_Size ) const
+		{
+			switch( m_Type )
+			{
+				case Type::Quantized:
+				{
+					const SizeType count = p_Size / sizeof( Float32 );
+					for( SizeType i = 0; i < count; i++ )
+					{
+						Uint32 step = 0;
+						if( p_Reader.ReadBits( step, m_Bits ) == false )
+						{
+							return false;
+						}
+
+						Float32 value = m_Minimum + static_cast<Float32>( step ) * m_Precision;
+						value = value > m_Maximum ? m_Maximum : value;
+						memcpy( reinterpret_cast<Uint8 *>( p_pData ) + i * sizeof( Float32 ), &value, sizeof( Float32 ) );
+					}
+				}
+				break;
+				case Type::SmallestThree:
+				{
+					Uint32 largest = 0;
+					if( p_Reader.ReadBits( largest, 2 ) == false )
+					{
+						return false;
+					}
+
+					const Uint32 maxStep = ( 1UL << m_Bits ) - 1;
+					Float32 components[ 4 ];
+					Float32 sum = 0.0f;
+
+					for( Uint32 i = 0; i < 4; i++ )
+					{
+						if( i == largest )
+						{
+							continue;
+						}
+
+						Uint32 step = 0;
+						if( p_Reader.ReadBits( step, m_Bits ) == false )
+						{
+							return false;
+						}
+
+						components[ i ] = static_cast<Float32>( step ) / maxStep * ( 2.0f * g_SmallestThreeRange ) - g_SmallestThreeRange;
+						sum += components[ i ] * components[ i ];
+					}
+
+					components[ largest ] = sum < 1.0f ? std::sqrt( 1.0f - sum ) : 0.0f;
+					memcpy( p_pData, components, sizeof( components ) );
+				}
+				break;
+				case Type::Boolean:
+				{
+					Uint32 value = 0;
+					if( p_Reader.ReadBits( value, 1 ) == false )
+					{
+						return false;
+					}
+					*reinterpret_cast<Uint8 *>( p_pData ) = static_cast<Uint8>( value );
+				}
+				break;
+				case Type::VarInt:
+				case Type::SignedVarInt:
+				{
+					Uint64 value = 0;
+					if( p_Reader.ReadVarUint( value ) == false )
+					{
+						return false;
+					}
+
+					// Zig-zag decode signed values.
+					if( m_Type == Type::SignedVarInt )
+					{
+						value = ( value >> 1 ) ^ ( ~( value & 1 ) + 1 );
+					}
+
+					switch( p_Size )
+					{
+						case 1: { Uint8 v = static_cast<Uint8>( value ); memcpy( p_pData, &v, 1 ); } break;
+						case 2: { Uint16 v = static_cast<Uint16>( value ); memcpy( p_pData, &v, 2 ); } break;
+						case 4: { Uint32 v = static_cast<Uint32>( value ); memcpy( p_pData, &v, 4 ); } break;
+						default: { memcpy( p_pData, &value, 8 ); } break;
+					}
+				}
+				break;
+				default:
+				{
+					return p_Reader.ReadBytes( p_pData, p_Size );
+				}
+				break;
+			}
+
+			return true;
+		}
+
+		void VariableEncoding::Serialize( std::vector<Uint8> & p_Message ) const
+		{
+			p_Message.push_back( static_cast<Uint8>( m_Type ) );
+
+			if( m_Type == Type::Quantized )
+			{
+				const Float32 values[ 3 ] = { m_Minimum, m_Maximum, m_Precision };
+				for( SizeType i = 0; i < 3; i++ )
+				{
+					Uint32 value = 0;
+					memcpy( &value, &values[ i ], sizeof( Uint32 ) );
+					value = Hton32( value );
+
+					const Uint8 * pValue = reinterpret_cast<const Uint8 *>( &value );
+					p_Message.insert( p_Message.end( ), pValue, pValue + sizeof( Uint32 ) );
+				}
+			}
+			else if( m_Type == Type::SmallestThree )
+			{
+				p_Message.push_back( m_Bits );
+			}
+		}
+
+		Bool VariableEncoding::Deserialize( const Uint8 * p_pData, const SizeType p_DataSize, SizeType & p_Position )
+		{
+			if( p_Position + 1 > p_DataSize )
+			{
+				return false;
+			}
+
+			const Uint8 type = p_pData[ p_Position++ ];
+			switch( type )
+			{
+				case Type::Raw:
+				{
+					*this = VariableEncoding( );
+				}
+				break;
+				case Type::Quantized:
+				{
+					if( p_Position + 12 > p_DataSize )
+					{
+						return false;
+					}
+
+					Float32 values[ 3 ];
+					for( SizeType i = 0; i < 3; i++ )
+					{
+						Uint32 value = 0;
+						memcpy( &value, p_pData + p_Position, sizeof( Uint32 ) );
+						value = Ntoh32( value );
+						memcpy( &values[ i ], &value, sizeof( Float32 ) );
+						p_Position += sizeof( Uint32 );
+					}
+
+					*this = Quantize( values[ 0 ], values[ 1 ], values[ 2 ] );
+				}
+				break;
+				case Type::SmallestThree:
+				{
+					if( p_Position + 1 > p_DataSize )
+					{
+						return false;
+					}
+
+					*this = SmallestThree( p_pData[ p_Position++ ] );
+				}
+				break;
+				case Type::Boolean:
+				{
+					*this = Boolean( );
+				}
+				break;
+				case Type::VarInt:
+				case Type::SignedVarInt:
+				{
+					*this = VarInt( type == Type::SignedVarInt );
+				}
+				break;
+				default:
+					return false;
+			}
+
+			return true;
+		}
+
+		void VariableEncoding::CalculateBits( )
+		{
+			m_Steps = 0;
+			m_Bits = 0;
+
+			if( m_Precision <= 0.0f || m_Maximum <= m_Minimum )
+			{
+				return;
+			}
+
+			// Calculate the number of steps, and the bits needed to represent them.
+			const Float64 steps = std::floor( ( static_cast<Float64>( m_Maximum ) - m_Minimum ) / m_Precision + 0.5 );
+			m_Steps = steps >= 4294967295.0 ? 4294967295UL : static_cast<Uint32>( steps );
+
+			while( m_Bits < 32 && ( static_cast<Uint64>( 1 ) << m_Bits ) <= m_Steps )
+			{
+				m_Bits++;
+			}
+		}
+
+	}
+
+}
@@ -25,6 +25,7 @@
 #include <Bit/Network/Win32/UdpSocketWin32.hpp>
 #ifdef BIT_PLATFORM_WINDOWS
 #include <Bit/System/Log.hpp>
+#include <vector>
 #include <Bit/System/MemoryLeak.hpp>
 
 namespace Bit
@@ -72,6 +73,13 @@ namespace Bit
 		return true;
 	}
 
+	Bool UdpSocketWin32::OpenShared( const Uint16 p_Port )
+	{
+		// SO_REUSEADDR lets the sockets bind the same port, but does not distribute the datagrams among them.
+		bitLogNetErr( "Sharing the port is not supported." );
+		return false;
+	}
+
 	void UdpSocketWin32::Close( )
 	{
 		// Close the socket handle
@@ -182,6 +190,80 @@ namespace Bit
 		return -1;
 	}
 
+	Int32 UdpSocketWin32::SendBatch( const Datagram * p_pDatagrams, const SizeType p_Count )
+	{
+		// Winsock has no batched datagram function, send them one by one.
+		std::vector<Uint8> buffer;
+		SizeType sent = 0;
+		for( ; sent < p_Count; sent++ )
+		{
+			const Datagram & datagram = p_pDatagrams[ sent ];
+			const void * pData = datagram.pData;
+			SizeType dataSize = datagram.DataSize;
+
+			// Put the header and the data in the same buffer.
+			if( datagram.pHeader && datagram.HeaderSize )
+			{
+				buffer.resize( datagram.HeaderSize + datagram.DataSize );
+				memcpy( buffer.data( ), datagram.pHeader, datagram.HeaderSize );
+				if( datagram.DataSize )
+				{
+					memcpy( buffer.data( ) + datagram.HeaderSize, datagram.pData, datagram.DataSize );
+				}
+				pData = buffer.data( );
+				dataSize = buffer.size( );
+			}
+
+			if( Send( pData, dataSize, datagram.RemoteAddress, datagram.RemotePort ) < 0 )
+			{
+				return sent ? static_cast<Int32>( sent ) : -1;
+			}
+		}
+
+		// Return the number of sent datagrams
+		return static_cast<Int32>( sent );
+	}
+
+	Int32 UdpSocketWin32::ReceiveBatch( Datagram * p_pDatagrams, const SizeType p_Count, const Time & p_Timeout )
+	{
+		if( p_Count == 0 )
+		{
+			return 0;
+		}
+
+		// Wait for the first datagram.
+		Int32 size = Receive(	p_pDatagrams[ 0 ].pData, p_pDatagrams[ 0 ].BufferSize,
+								p_pDatagrams[ 0 ].RemoteAddress, p_pDatagrams[ 0 ].RemotePort, p_Timeout );
+		if( size < 0 )
+		{
+			return 0;
+		}
+		p_pDatagrams[ 0 ].DataSize = static_cast<SizeType>( size );
+
+		// Receive the already queued datagrams.
+		SizeType received = 1;
+		for( ; received < p_Count; received++ )
+		{
+			// Check if there is any data left to read.
+			u_long available = 0;
+			if( ioctlsocket( m_Handle, FIONREAD, &available ) != 0 || available == 0 )
+			{
+				break;
+			}
+
+			Datagram & datagram = p_pDatagrams[ received ];
+			size = Receive( datagram.pData, datagram.BufferSize, datagram.RemoteAddress, datagram.RemotePort );
+			if( size < 0 )
+			{
+				break;
+			}
+			datagram.DataSize = static_cast<SizeType>( size );
+		}
+
+		// Return the number of received datagrams
+		return static_cast<Int32>( received );
+	}
+
 }
 
 #endif
@@ -0,0 +1,466 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/System/JobSystem.hpp>
+#include <thread>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	// Worker of the calling thread, NULL if the thread is not a worker.
+	static thread_local void * g_pCurrentWorker = NULL;
+
+	// Counter class
+	JobSystem::Counter::Counter( ) :
+		m_Count( 0 )
+	{
+	}
+
+	Bool JobSystem::Counter::IsDone( ) const
+	{
+		return m_Count.load( std::memory_order_acquire ) == 0;
+	}
+
+	Uint32 JobSystem::Counter::GetCount( ) const
+	{
+		return m_Count.load( std::memory_order_acquire );
+	}
+
+	// Job struct
+	JobSystem::Job::Job( const JobSystem::Function & p_Function, Counter * p_pCounter ) :
+		Function( p_Function ),
+		pCounter( p_pCounter )
+	{
+	}
+
+	// Worker struct
+	JobSystem::Worker::Worker( JobSystem * p_pJobSystem, const Uint32 p_Index ) :
+		pJobSystem( p_pJobSystem ),
+		Index( p_Index ),
+		RandomSeed( p_Index * 2654435761U + 1 )
+	{
+	}
+
+	// Job system class
+	const Uint32 JobSystem::SpinCount = 64;
+
+	JobSystem::JobSystem( ) :
+		m_Running( false ),
+		m_QueueSize( 0 ),
+		m_SleepingWorkers( 0 ),
+		m_WaitingThreads( 0 )
+	{
+	}
+
+	JobSystem::~JobSystem( )
+	{
+		Stop( );
+	}
+
+	Bool JobSystem::Start( const Uint32 p_WorkerCount )
+	{
+		if( IsRunning( ) )
+		{
+			return false;
+		}
+
+		// Size the job system to the number of hardware threads,
+		// the threads waiting for jobs are helping out.
+		Uint32 workerCount = p_WorkerCount;
+		if( workerCount == 0 )
+		{
+			workerCount = static_cast<Uint32>( std::thread::hardware_concurrency( ) );
+			workerCount = workerCount > 1 ? workerCount - 1 : 1;
+		}
+
+		m_Running.store( true );
+
+		// Create all the workers before starting any thread, the workers are stealing from each other.
+		for( Uint32 i = 0; i < workerCount; i++ )
+		{
+			m_Workers.push_back( new Worker( this, i ) );
+		}
+
+		// Start the worker threads.
+		for( WorkerVector::iterator it = m_Workers.begin( ); it != m_Workers.end( ); it++ )
+		{
+			Worker * pWorker = *it;
+			pWorker->Thread.Execute( [ this, pWorker ] ( )
+			{
+				WorkerFunction( pWorker );
+			}
+			);
+		}
+
+		return true;
+	}
+
+	void JobSystem::Stop( )
+	{
+		if( IsRunning( ) == false )
+		{
+			return;
+		}
+
+		// Set the running flag to false.
+		m_Running.store( false );
+
+		// Wake up and wait for the workers to finish.
+		m_WakeSemaphore.Release( static_cast<Uint32>( m_Workers.size( ) ) );
+		for( WorkerVector::iterator it = m_Workers.begin( ); it != m_Workers.end( ); it++ )
+		{
+			(*it)->Thread.Finish( );
+		}
+
+		// Execute the pending jobs, stealing them from the stopped workers.
+		// Their counters must reach 0, other threads may be waiting for them,
+		// and the jobs depending on them are pushed to the shared queue.
+		Job * pJob = NULL;
+		while( ( pJob = FindJob( NULL ) ) != NULL )
+		{
+			Execute( pJob );
+		}
+
+		// Let the waiting threads see their counters done before deleting the workers they are searching.
+		while( m_WaitingThreads.load( ) != 0 )
+		{
+			std::this_thread::yield( );
+		}
+
+		// Delete the workers.
+		for( WorkerVector::iterator it = m_Workers.begin( ); it != m_Workers.end( ); it++ )
+		{
+			delete *it;
+		}
+		m_Workers.clear( );
+	}
+
+	Bool JobSystem::IsRunning( ) const
+	{
+		return m_Running.load( std::memory_order_acquire );
+	}
+
+	Uint32 JobSystem::GetWorkerCount( ) const
+	{
+		return static_cast<Uint32>( m_Workers.size( ) );
+	}
+
+	void JobSystem::Run( const Function & p_Function, Counter * p_pCounter, Counter * p_pDependency )
+	{
+		// Execute the job right away if there are no workers.
+		if( m_Workers.size( ) == 0 )
+		{
+			p_Function( );
+			return;
+		}
+
+		if( p_pCounter )
+		{
+			p_pCounter->m_Count.fetch_add( 1 );
+		}
+
+		Job * pJob = new Job( p_Function, p_pCounter );
+
+		// Hold back the job until the dependency is done.
+		// The dependency reaches 0 while its dependents are locked, see Decrease.
+		if( p_pDependency )
+		{
+			p_pDependency->m_Dependents.Mutex.Lock( );
+			if( p_pDependency->m_Count.load( ) != 0 )
+			{
+				p_pDependency->m_Dependents.Value.push_back( pJob );
+				p_pDependency->m_Dependents.Mutex.Unlock( );
+				return;
+			}
+			p_pDependency->m_Dependents.Mutex.Unlock( );
+		}
+
+		Push( pJob );
+	}
+
+	void JobSystem::Wait( Counter & p_Counter )
+	{
+		Worker * pWorker = GetCurrentWorker( );
+		m_WaitingThreads.fetch_add( 1 );
+
+		// Execute jobs until the counter is done.
+		Uint32 failedSearches = 0;
+		while( p_Counter.IsDone( ) == false )
+		{
+			Job * pJob = FindJob( pWorker );
+			if( pJob )
+			{
+				Execute( pJob );
+				failedSearches = 0;
+				continue;
+			}
+
+			// Back off, the remaining jobs are being executed by other threads.
+			if( ++failedSearches > SpinCount )
+			{
+				std::this_thread::yield( );
+			}
+		}
+
+		m_WaitingThreads.fetch_sub( 1 );
+
+		// Make sure that the last decrease has released the counter, the caller may destroy it.
+		p_Counter.m_Dependents.Mutex.Lock( );
+		p_Counter.m_Dependents.Mutex.Unlock( );
+	}
+
+	void JobSystem::ParallelFor( const SizeType p_Begin, const SizeType p_End, const RangeFunction & p_Function, const SizeType p_GrainSize )
+	{
+		if( p_End <= p_Begin )
+		{
+			return;
+		}
+
+		// Split the range into about 8 subranges per thread, enough to balance the load,
+		// without paying for too many jobs.
+		SizeType grainSize = p_GrainSize;
+		if( grainSize == 0 )
+		{
+			grainSize = ( p_End - p_Begin ) / ( ( m_Workers.size( ) + 1 ) * 8 );
+			if( grainSize == 0 )
+			{
+				grainSize = 1;
+			}
+		}
+
+		// No need for any jobs.
+		if( p_End - p_Begin <= grainSize || m_Workers.size( ) == 0 )
+		{
+			p_Function( p_Begin, p_End );
+			return;
+		}
+
+		Counter counter;
+		RunRange( p_Begin, p_End, grainSize, &p_Function, &counter );
+		Wait( counter );
+	}
+
+	JobSystem::Worker * JobSystem::GetCurrentWorker( ) const
+	{
+		Worker * pWorker = reinterpret_cast<Worker *>( g_pCurrentWorker );
+		if( pWorker && pWorker->pJobSystem == this )
+		{
+			return pWorker;
+		}
+
+		return NULL;
+	}
+
+	void JobSystem::Push( Job * p_pJob )
+	{
+		// Workers push to their own deque, other threads to the shared queue.
+		Worker * pWorker = GetCurrentWorker( );
+		if( pWorker )
+		{
+			pWorker->Deque.Push( p_pJob );
+		}
+		else
+		{
+			m_Queue.Mutex.Lock( );
+			m_Queue.Value.push( p_pJob );
+			m_QueueSize.fetch_add( 1 );
+			m_Queue.Mutex.Unlock( );
+		}
+
+		// Wake up a sleeping worker. Pairs with the fence in WorkerFunction,
+		// either the worker sees the job, or we see the sleeping worker.
+		std::atomic_thread_fence( std::memory_order_seq_cst );
+		if( m_SleepingWorkers.load( std::memory_order_relaxed ) > 0 )
+		{
+			m_WakeSemaphore.Release( );
+		}
+	}
+
+	JobSystem::Job * JobSystem::FindJob( Worker * p_pWorker )
+	{
+		Job * pJob = NULL;
+
+		// Pop from the worker's own deque.
+		if( p_pWorker && ( pJob = p_pWorker->Deque.Pop( ) ) != NULL )
+		{
+			return pJob;
+		}
+
+		// Pop from the shared queue.
+		if( m_QueueSize.load( std::memory_order_relaxed ) > 0 )
+		{
+			m_Queue.Mutex.Lock( );
+			if( m_Queue.Value.size( ) )
+			{
+				pJob = m_Queue.Value.front( );
+				m_Queue.Value.pop( );
+				m_QueueSize.fetch_sub( 1 );
+			}
+			m_Queue.Mutex.Unlock( );
+
+			if( pJob )
+			{
+				return pJob;
+			}
+		}
+
+		// Steal from the other workers, starting at a random worker.
+		const Uint32 workerCount = static_cast<Uint32>( m_Workers.size( ) );
+		Uint32 start = 0;
+		if( p_pWorker )
+		{
+			p_pWorker->RandomSeed ^= p_pWorker->RandomSeed << 13;
+			p_pWorker->RandomSeed ^= p_pWorker->RandomSeed >> 17;
+			p_pWorker->RandomSeed ^= p_pWorker->RandomSeed << 5;
+			start = p_pWorker->RandomSeed % workerCount;
+		}
+
+		for( Uint32 i = 0; i < workerCount; i++ )
+		{
+			Worker * pVictim = m_Workers[ ( start + i ) % workerCount ];
+			if( pVictim != p_pWorker && ( pJob = pVictim->Deque.Steal( ) ) != NULL )
+			{
+				return pJob;
+			}
+		}
+
+		return NULL;
+	}
+
+	void JobSystem::Execute( Job * p_pJob )
+	{
+		p_pJob->Function( );
+
+		if( p_pJob->pCounter )
+		{
+			Decrease( p_pJob->pCounter );
+		}
+
+		delete p_pJob;
+	}
+
+	void JobSystem::Decrease( Counter * p_pCounter )
+	{
+		// Not the last job, no need to lock the dependents.
+		Uint32 count = p_pCounter->m_Count.load( std::memory_order_relaxed );
+		while( count > 1 )
+		{
+			if( p_pCounter->m_Count.compare_exchange_weak( count, count - 1, std::memory_order_acq_rel, std::memory_order_relaxed ) )
+			{
+				return;
+			}
+		}
+
+		// Possibly the last job, reach 0 while the dependents are locked,
+		// so no dependent job can be added after they are pushed.
+		Counter::JobVector dependents;
+		p_pCounter->m_Dependents.Mutex.Lock( );
+		if( p_pCounter->m_Count.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+		{
+			dependents.swap( p_pCounter->m_Dependents.Value );
+		}
+		p_pCounter->m_Dependents.Mutex.Unlock( );
+
+		// Do not touch the counter after this point, the waiting thread may have destroyed it.
+		for( Counter::JobVector::iterator it = dependents.begin( ); it != dependents.end( ); it++ )
+		{
+			Push( *it );
+		}
+	}
+
+	Bool JobSystem::HasJobs( ) const
+	{
+		if( m_QueueSize.load( std::memory_order_relaxed ) > 0 )
+		{
+			return true;
+		}
+
+		for( WorkerVector::const_iterator it = m_Workers.begin( ); it != m_Workers.end( ); it++ )
+		{
+			if( (*it)->Deque.IsEmpty( ) == false )
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void JobSystem::WorkerFunction( Worker * p_pWorker )
+	{
+		g_pCurrentWorker = p_pWorker;
+
+		Uint32 failedSearches = 0;
+		while( IsRunning( ) )
+		{
+			Job * pJob = FindJob( p_pWorker );
+			if( pJob )
+			{
+				Execute( pJob );
+				failedSearches = 0;
+				continue;
+			}
+
+			// Keep searching for a while, new jobs are often pushed in bursts.
+			if( ++failedSearches < SpinCount )
+			{
+				std::this_thread::yield( );
+				continue;
+			}
+
+			// Sleep until a job is pushed. Pairs with the fence in Push,
+			// the jobs must be checked after announcing the sleep.
+			m_SleepingWorkers.fetch_add( 1 );
+			std::atomic_thread_fence( std::memory_order_seq_cst );
+			if( HasJobs( ) == false && IsRunning( ) )
+			{
+				m_WakeSemaphore.Wait( );
+			}
+			m_SleepingWorkers.fetch_sub( 1 );
+			failedSearches = 0;
+		}
+
+		g_pCurrentWorker = NULL;
+	}
+
+	void JobSystem::RunRange(	const SizeType p_Begin, const SizeType p_End, const SizeType p_GrainSize,
+								const RangeFunction * p_pFunction, Counter * p_pCounter )
+	{
+		Run( [ this, p_Begin, p_End, p_GrainSize, p_pFunction, p_pCounter ] ( )
+		{
+			// Split off the upper halves as new jobs, for other workers to steal.
+			SizeType end = p_End;
+			while( end - p_Begin > p_GrainSize )
+			{
+				const SizeType middle = p_Begin + ( end - p_Begin ) / 2;
+				RunRange( middle, end, p_GrainSize, p_pFunction, p_pCounter );
+				end = middle;
+			}
+
+			( *p_pFunction )( p_Begin, end );
+		},
+		p_pCounter );
+	}
+
+}
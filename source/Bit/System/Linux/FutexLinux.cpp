@@ -0,0 +1,96 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/System/Linux/FutexLinux.hpp>
+#include <Bit/System/Timer.hpp>
+#ifdef BIT_PLATFORM_LINUX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	namespace Private
+	{
+
+		// The futex system call operates on plain 32 bit integers, std::atomic<Int32> is lock free and shares its layout.
+		static int * GetFutexAddress( std::atomic<Int32> & p_Value )
+		{
+			return reinterpret_cast<int *>( &p_Value );
+		}
+
+		Uint64 FutexLinux::GetDeadline( const Time & p_Timeout )
+		{
+			if( p_Timeout == Time::Zero || p_Timeout == Time::Infinite )
+			{
+				return 0;
+			}
+
+			return Timer::GetSystemTimeNanoseconds( ) + p_Timeout.AsNanoseconds( );
+		}
+
+		Bool FutexLinux::Wait( std::atomic<Int32> & p_Value, const Int32 p_Expected, const Uint64 p_Deadline )
+		{
+			// Sleep without timeout.
+			if( p_Deadline == 0 )
+			{
+				syscall( SYS_futex, GetFutexAddress( p_Value ), FUTEX_WAIT_PRIVATE, p_Expected, NULL, NULL, 0 );
+				return true;
+			}
+
+			// The bitset wait takes an absolute CLOCK_MONOTONIC timeout,
+			// so spurious wake ups do not extend the total wait time.
+			struct timespec deadline;
+			deadline.tv_sec = static_cast<time_t>( p_Deadline / 1000000000ULL );
+			deadline.tv_nsec = static_cast<long>( p_Deadline % 1000000000ULL );
+
+			if( syscall(	SYS_futex, GetFutexAddress( p_Value ), FUTEX_WAIT_BITSET_PRIVATE, p_Expected,
+							&deadline, NULL, FUTEX_BITSET_MATCH_ANY ) == -1 &&
+				errno == ETIMEDOUT )
+			{
+				return false;
+			}
+
+			return true;
+		}
+
+		Bool FutexLinux::IsMultiProcessor( )
+		{
+			static const Bool multiProcessor = sysconf( _SC_NPROCESSORS_ONLN ) > 1;
+			return multiProcessor;
+		}
+
+		void FutexLinux::Wake( std::atomic<Int32> & p_Value, const Int32 p_Count )
+		{
+			syscall( SYS_futex, GetFutexAddress( p_Value ), FUTEX_WAKE_PRIVATE, p_Count, NULL, NULL, 0 );
+		}
+
+	}
+
+}
+
+#endif
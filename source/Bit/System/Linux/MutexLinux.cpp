@@ -24,29 +24,85 @@
 
 #include <Bit/System/Linux/MutexLinux.hpp>
 #ifdef BIT_PLATFORM_LINUX
+#include <Bit/System/Linux/FutexLinux.hpp>
 #include <Bit/System/MemoryLeak.hpp>
 
 namespace Bit
 {
 
-	MutexLinux::MutexLinux( )
+	const Int32 MutexLinux::MaxSpinCount = 100;
+
+	MutexLinux::MutexLinux( ) :
+		m_State( State::Unlocked ),
+		m_SpinCount( 0 )
 	{
-		pthread_mutex_init( &m_Mutex, NULL );
 	}
 
 	MutexLinux::~MutexLinux( )
 	{
-		pthread_mutex_destroy( &m_Mutex );
 	}
 
 	void MutexLinux::Lock( )
 	{
-	    pthread_mutex_lock( &m_Mutex );
+		// Fast path, the mutex is unlocked.
+		Int32 state = State::Unlocked;
+		if( m_State.compare_exchange_strong( state, State::Locked, std::memory_order_acquire, std::memory_order_relaxed ) )
+		{
+			return;
+		}
+
+		LockContended( );
 	}
 
 	void MutexLinux::Unlock( )
 	{
-	    pthread_mutex_unlock( &m_Mutex );
+		// Wake up a sleeping thread if the mutex was contended.
+		if( m_State.exchange( State::Unlocked, std::memory_order_release ) == State::Contended )
+		{
+			Private::FutexLinux::Wake( m_State, 1 );
+		}
+	}
+
+	void MutexLinux::LockContended( )
+	{
+		// Spin while the mutex is held by a running thread.
+		// Allow twice the average spin count, so the average can grow.
+		// There is no point in spinning on a single processor machine.
+		const Int32 spinCount = m_SpinCount.load( std::memory_order_relaxed );
+		Int32 maxSpins = spinCount * 2 + 10 < MaxSpinCount ? spinCount * 2 + 10 : MaxSpinCount;
+		if( Private::FutexLinux::IsMultiProcessor( ) == false )
+		{
+			maxSpins = 0;
+		}
+
+		for( Int32 i = 0; i < maxSpins; i++ )
+		{
+			Int32 state = m_State.load( std::memory_order_relaxed );
+
+			// Stop spinning if there are sleeping threads, they are first in line.
+			if( state == State::Contended )
+			{
+				break;
+			}
+
+			if( state == State::Unlocked &&
+				m_State.compare_exchange_weak( state, State::Locked, std::memory_order_acquire, std::memory_order_relaxed ) )
+			{
+				m_SpinCount.store( spinCount + ( i - spinCount ) / 8, std::memory_order_relaxed );
+				return;
+			}
+
+			Private::FutexLinux::Relax( );
+		}
+
+		m_SpinCount.store( spinCount + ( maxSpins - spinCount ) / 8, std::memory_order_relaxed );
+
+		// Sleep until the mutex is unlocked. The mutex is marked as contended,
+		// since it is unknown if other threads are sleeping.
+		while( m_State.exchange( State::Contended, std::memory_order_acquire ) != State::Unlocked )
+		{
+			Private::FutexLinux::Wait( m_State, State::Contended );
+		}
 	}
 
 }
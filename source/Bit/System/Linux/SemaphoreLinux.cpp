@@ -0,0 +1,130 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/System/Linux/SemaphoreLinux.hpp>
+#ifdef BIT_PLATFORM_LINUX
+#include <Bit/System/Linux/FutexLinux.hpp>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	const Uint32 SemaphoreLinux::SpinCount = 100;
+
+	SemaphoreLinux::SemaphoreLinux( const Uint32 & p_InitialCount, const Uint32 & p_MaximumCount ) :
+		m_Count( static_cast<Int32>( p_InitialCount ) ),
+		m_Waiters( 0 ),
+		m_MaximumCount( static_cast<Int32>( p_MaximumCount ) )
+	{
+	}
+		
+	SemaphoreLinux::~SemaphoreLinux( )
+	{
+	}
+		
+	void SemaphoreLinux::Wait( )
+	{
+		WaitUntil( 0 );
+	}
+
+	void SemaphoreLinux::Wait( const Time & p_Timeout )
+	{
+		WaitUntil( Private::FutexLinux::GetDeadline( p_Timeout ) );
+	}
+
+	void SemaphoreLinux::Release( const Uint32 & p_Ammount )
+	{
+		if( p_Ammount == 0 )
+		{
+			return;
+		}
+
+		// Increase the count, but never above the maximum count.
+		Int32 count = m_Count.load( std::memory_order_relaxed );
+		Int32 newCount = 0;
+		do
+		{
+			newCount = count + static_cast<Int32>( p_Ammount );
+			if( newCount > m_MaximumCount )
+			{
+				newCount = m_MaximumCount;
+			}
+
+			if( newCount == count )
+			{
+				return;
+			}
+		}
+		while( m_Count.compare_exchange_weak( count, newCount ) == false );
+
+		// Only enter the kernel if there are any waiters.
+		if( m_Waiters.load( ) > 0 )
+		{
+			Private::FutexLinux::Wake( m_Count, newCount - count );
+		}
+	}
+
+	Bool SemaphoreLinux::TryDecrement( )
+	{
+		Int32 count = m_Count.load( std::memory_order_relaxed );
+		while( count > 0 )
+		{
+			if( m_Count.compare_exchange_weak( count, count - 1, std::memory_order_acquire, std::memory_order_relaxed ) )
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void SemaphoreLinux::WaitUntil( const Uint64 p_Deadline )
+	{
+		// Spin for a short while, the semaphore is often released soon.
+		const Uint32 spinCount = Private::FutexLinux::IsMultiProcessor( ) ? SpinCount : 0;
+		for( Uint32 i = 0; i < spinCount; i++ )
+		{
+			if( TryDecrement( ) )
+			{
+				return;
+			}
+			Private::FutexLinux::Relax( );
+		}
+
+		// Sleep until the count is larger than 0.
+		// The waiter count must be increased before checking the count,
+		// else a release between the check and the sleep would be missed.
+		m_Waiters.fetch_add( 1 );
+		while( TryDecrement( ) == false )
+		{
+			if( Private::FutexLinux::Wait( m_Count, 0, p_Deadline ) == false )
+			{
+				break;
+			}
+		}
+		m_Waiters.fetch_sub( 1 );
+	}
+
+}
+
+#endif
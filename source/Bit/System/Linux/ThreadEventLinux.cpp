@@ -0,0 +1,113 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/System/Linux/ThreadEventLinux.hpp>
+#ifdef BIT_PLATFORM_LINUX
+#include <Bit/System/Linux/FutexLinux.hpp>
+#include <climits>
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	const Uint32 ThreadEventLinux::SpinCount = 100;
+
+	ThreadEventLinux::ThreadEventLinux( const Bool p_ManualReset, const Bool p_InitialState ) :
+		m_State( p_InitialState ? 1 : 0 ),
+		m_Waiters( 0 ),
+		m_ManualReset( p_ManualReset )
+	{
+	}
+
+	ThreadEventLinux::~ThreadEventLinux( )
+	{
+	}
+
+	void ThreadEventLinux::Set( )
+	{
+		if( m_State.exchange( 1 ) == 1 )
+		{
+			return;
+		}
+
+		// Only enter the kernel if there are any waiters.
+		if( m_Waiters.load( ) > 0 )
+		{
+			Private::FutexLinux::Wake( m_State, m_ManualReset ? INT_MAX : 1 );
+		}
+	}
+
+	void ThreadEventLinux::Reset( )
+	{
+		m_State.store( 0 );
+	}
+
+	void ThreadEventLinux::Wait( )
+	{
+		WaitUntil( 0 );
+	}
+
+	void ThreadEventLinux::Wait( const Time & p_Timeout )
+	{
+		WaitUntil( Private::FutexLinux::GetDeadline( p_Timeout ) );
+	}
+
+	Bool ThreadEventLinux::TryConsume( )
+	{
+		if( m_ManualReset )
+		{
+			return m_State.load( std::memory_order_acquire ) == 1;
+		}
+
+		Int32 signaled = 1;
+		return m_State.compare_exchange_strong( signaled, 0, std::memory_order_acquire, std::memory_order_relaxed );
+	}
+
+	void ThreadEventLinux::WaitUntil( const Uint64 p_Deadline )
+	{
+		// Spin for a short while before sleeping.
+		const Uint32 spinCount = Private::FutexLinux::IsMultiProcessor( ) ? SpinCount : 0;
+		for( Uint32 i = 0; i < spinCount; i++ )
+		{
+			if( TryConsume( ) )
+			{
+				return;
+			}
+			Private::FutexLinux::Relax( );
+		}
+
+		// Sleep until the event is signaled.
+		m_Waiters.fetch_add( 1 );
+		while( TryConsume( ) == false )
+		{
+			if( Private::FutexLinux::Wait( m_State, 0, p_Deadline ) == false )
+			{
+				break;
+			}
+		}
+		m_Waiters.fetch_sub( 1 );
+	}
+
+}
+
+#endif
@@ -30,12 +30,14 @@ namespace Bit
 {
 
 	ThreadLinux::ThreadLinux( ) :
-		m_Running( false )
+		m_Running( false ),
+		m_Joinable( false )
 	{
 	}
 
 	ThreadLinux::ThreadLinux( Function p_Function ) :
-		m_Running( false )
+		m_Running( false ),
+		m_Joinable( false )
 	{
 		Execute( p_Function );
 	}
@@ -50,20 +52,28 @@ namespace Bit
 		{
 			m_Function = p_Function;
 
-			pthread_create( &m_Thread, NULL, StaticThreadFunction, reinterpret_cast<void *>( this ) );
+			m_Joinable = pthread_create( &m_Thread, NULL, StaticThreadFunction, reinterpret_cast<void *>( this ) ) == 0;
 		}
 	}
 
 	void ThreadLinux::Finish( )
 	{
-	    // Wait for the function to finish
-        pthread_join( m_Thread, NULL );
-    }
+		// Join the thread once, the handle is invalid if never started or already joined.
+		if( m_Joinable )
+		{
+			// Wait for the function to finish
+			pthread_join( m_Thread, NULL );
+			m_Joinable = false;
+		}
+	}
 
 	void ThreadLinux::Terminate( )
 	{
 		// Terminate the thread.
-		pthread_cancel( m_Thread );
+		if( m_Joinable )
+		{
+			pthread_cancel( m_Thread );
+		}
 	}
 
 	Bool ThreadLinux::IsRunning( )
@@ -39,6 +39,16 @@ namespace Bit
 		return Private::LogManager::GetDefaultHandle();
 	}
 
+	void Log::Flush()
+	{
+		Private::LogManager::Flush();
+	}
+
+	Uint64 Log::GetDroppedCount()
+	{
+		return Private::LogManager::GetDroppedCount();
+	}
+
 
 	// Log message structure
 	LogMessage::LogMessage() :
@@ -73,5 +83,9 @@ namespace Bit
 	{
 	}
 
+	void LogHandle::OnFlush()
+	{
+	}
+
 
 }
\ No newline at end of file
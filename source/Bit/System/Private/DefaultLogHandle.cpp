@@ -34,7 +34,12 @@ namespace Bit
 
 		void DefaultLogHandle::OnMessage(const LogMessage & p_Message)
 		{
-			std::cout <<  p_Message.message << std::endl;
+			std::cout <<  p_Message.message << '\n';
+		}
+
+		void DefaultLogHandle::OnFlush()
+		{
+			std::cout.flush();
 		}
 
 	}
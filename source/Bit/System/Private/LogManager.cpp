@@ -26,6 +26,16 @@
 #include <Bit/System/Log.hpp>
 #include <Bit/System/Private/DefaultLogHandle.hpp>
 #include <Bit/System/SmartMutex.hpp>
+#include <Bit/System/Thread.hpp>
+#include <Bit/System/ThreadEvent.hpp>
+#include <Bit/System/Sleep.hpp>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <streambuf>
+#include <thread>
 #include <Bit/System/MemoryLeak.hpp>
 
 namespace Bit
@@ -34,87 +44,511 @@ namespace Bit
 	namespace Private
 	{
 
+		// Constants
+		const SizeType LogManager::MaxMessageSize = 512;
+		const SizeType LogManager::QueueSize = 1024;
+
 		// Static data
-		static std::stringstream			g_MessageStream;
-		static LogMessage					g_Message;
 		static Mutex						g_Mutex;
 		static Private::DefaultLogHandle	g_DefaultLogHandle;
-		static LogHandle *					g_CurrentLogHandle = &g_DefaultLogHandle;
-
+		static std::atomic<LogHandle *>		g_CurrentLogHandle(&g_DefaultLogHandle);
 
-		// Log manager class
-		void LogManager::Start(	const Uint32 p_Type,
-										const Uint32 p_Channel,
-										const std::string & p_File,
-										const Int32 p_Line,
-										const std::string & p_Function)
+		static LogHandle & GetHandle()
 		{
-			// Lock the mutex.
-			g_Mutex.Lock();
-
-			// Set message meta data.
-			g_Message.type = static_cast<Log::eType>(p_Type);
-			g_Message.channel = p_Channel;
-			g_Message.file = p_File;
-			g_Message.line = p_Line;
-			g_Message.function = p_Function;
+			return *g_CurrentLogHandle.load();
 		}
 
-		std::stringstream & LogManager::GetStream()
+		static void FireHandle(const LogMessage & p_Message)
 		{
-			return g_MessageStream;
-		}
-
-
-		void LogManager::End()
-		{
-
-			// Check the size.
-			if (g_MessageStream.str().size() == 0)
-			{
-				// Unlock the mutex
-				g_Mutex.Unlock();
-				return;
-			}
-
-			// Set the message.
-			g_Message.message = g_MessageStream.str();
-			g_MessageStream.str("");
-
-			// Set the timestamp
-			g_Message.timestamp = Timestamp::Now();
+			LogHandle & handle = GetHandle();
 
 			// Fire the OnMessage function for the handle.
-			g_CurrentLogHandle->OnMessage(g_Message);
+			handle.OnMessage(p_Message);
 
 			// Also fire the On[eType] function for the handle.
-			switch (g_Message.type)
+			switch (p_Message.type)
 			{
 			case Log::Error:
-				g_CurrentLogHandle->OnError(g_Message);
+				handle.OnError(p_Message);
 				break;
 			case Log::Warning:
-				g_CurrentLogHandle->OnWarning(g_Message);
+				handle.OnWarning(p_Message);
 				break;
 			case Log::Info:
-				g_CurrentLogHandle->OnInfo(g_Message);
+				handle.OnInfo(p_Message);
 				break;
 			case Log::Debug:
-				g_CurrentLogHandle->OnDebug(g_Message);
+				handle.OnDebug(p_Message);
 				break;
-			
+
 			default:
 				break;
 			};
+		}
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Stream buffer writing to a fixed size array, truncating at overflow.
+		///
+		////////////////////////////////////////////////////////////////
+		class LogStreamBuffer : public std::streambuf
+		{
+
+		public:
+
+			LogStreamBuffer()
+			{
+				Reset();
+			}
+
+			void Reset()
+			{
+				setp(m_Data, m_Data + LogManager::MaxMessageSize);
+			}
+
+			const char * GetData() const
+			{
+				return pbase();
+			}
+
+			SizeType GetSize() const
+			{
+				return static_cast<SizeType>(pptr() - pbase());
+			}
+
+		private:
+
+			char m_Data[LogManager::MaxMessageSize];
+
+		};
 
-			// Unlock the mutex
-			g_Mutex.Unlock();
-			
+		////////////////////////////////////////////////////////////////
+		/// \brief Thread local message formatter.
+		///
+		////////////////////////////////////////////////////////////////
+		struct LogFormatter
+		{
+
+			LogFormatter() :
+				Stream(&Buffer),
+				Type(0),
+				Channel(0),
+				pFile(""),
+				Line(0),
+				pFunction("")
+			{
+			}
+
+			LogStreamBuffer	Buffer;		///< Message buffer.
+			std::ostream	Stream;		///< Stream writing to the buffer.
+			Uint32			Type;		///< Message type.
+			Uint32			Channel;	///< Message channel.
+			const char *	pFile;		///< Source file, string literal.
+			Int32			Line;		///< Source line.
+			const char *	pFunction;	///< Source function, string literal.
+
+		};
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Queued log record.
+		///
+		////////////////////////////////////////////////////////////////
+		struct LogRecord
+		{
+
+			std::atomic<Uint64>	Sequence;	///< Slot sequence, see LogQueue.
+			Uint32				Type;		///< Message type.
+			Uint32				Channel;	///< Message channel.
+			const char *		pFile;		///< Source file, string literal.
+			Int32				Line;		///< Source line.
+			const char *		pFunction;	///< Source function, string literal.
+			Timestamp			Time;		///< Time of the message, taken by the posting thread.
+			SizeType			Size;		///< Message size.
+			char				Message[LogManager::MaxMessageSize];	///< Message data.
+
+		};
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Bounded lock-free multi-producer single-consumer queue of log records.
+		///
+		/// Every slot carries a sequence number. A slot is free for the producer
+		/// at position p if its sequence is p, and ready for the consumer if its
+		/// sequence is p + 1. Producers claim positions by a compare and swap,
+		/// the consumer frees the slot for the next lap by setting the sequence
+		/// to p + QueueSize.
+		///
+		/// Producers register in the producer count before checking the state,
+		/// so Stop can wait for the ones that saw a running queue and handle
+		/// their messages, the rest handle their messages by themselves.
+		///
+		////////////////////////////////////////////////////////////////
+		class LogQueue
+		{
+
+		public:
+
+			LogQueue() :
+				m_pRecords(new LogRecord[LogManager::QueueSize]),
+				m_Mask(static_cast<Uint64>(LogManager::QueueSize) - 1),
+				m_EnqueuePosition(0),
+				m_DequeuePosition(0),
+				m_DroppedCount(0),
+				m_ReportedDropCount(0),
+				m_ProducerCount(0),
+				m_WriterSleeping(false),
+				m_State(Running)
+			{
+				for (SizeType i = 0; i < LogManager::QueueSize; i++)
+				{
+					m_pRecords[i].Sequence.store(i, std::memory_order_relaxed);
+				}
+
+				m_WriterThread.Execute([this]()
+				{
+					WriterFunction();
+				});
+			}
+
+			Bool Push(const LogFormatter & p_Formatter, const Timestamp & p_Timestamp)
+			{
+				// Register the producer, and let the caller handle the message if the writer is stopping.
+				m_ProducerCount.fetch_add(1);
+				if (m_State.load() != Running)
+				{
+					m_ProducerCount.fetch_sub(1);
+					return false;
+				}
+
+				// Claim a slot.
+				Uint64 position = m_EnqueuePosition.load(std::memory_order_relaxed);
+				LogRecord * pRecord = NULL;
+				while (true)
+				{
+					pRecord = &m_pRecords[position & m_Mask];
+					const Int64 difference = static_cast<Int64>(pRecord->Sequence.load(std::memory_order_acquire)) - static_cast<Int64>(position);
+
+					if (difference == 0)
+					{
+						if (m_EnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+						{
+							break;
+						}
+					}
+					// The queue is full, drop the message.
+					else if (difference < 0)
+					{
+						m_DroppedCount.fetch_add(1, std::memory_order_relaxed);
+						m_ProducerCount.fetch_sub(1);
+						WakeWriter();
+						return true;
+					}
+					else
+					{
+						position = m_EnqueuePosition.load(std::memory_order_relaxed);
+					}
+				}
+
+				// Fill and publish the record.
+				pRecord->Type = p_Formatter.Type;
+				pRecord->Channel = p_Formatter.Channel;
+				pRecord->pFile = p_Formatter.pFile;
+				pRecord->Line = p_Formatter.Line;
+				pRecord->pFunction = p_Formatter.pFunction;
+				pRecord->Time = p_Timestamp;
+				pRecord->Size = p_Formatter.Buffer.GetSize();
+				memcpy(pRecord->Message, p_Formatter.Buffer.GetData(), pRecord->Size);
+				pRecord->Sequence.store(position + 1, std::memory_order_release);
+				m_ProducerCount.fetch_sub(1);
+
+				WakeWriter();
+				return true;
+			}
+
+			void Flush()
+			{
+				// Wait for the writer to pass the messages posted so far.
+				const Uint64 position = m_EnqueuePosition.load(std::memory_order_acquire);
+				while (m_DequeuePosition.load(std::memory_order_acquire) < position && IsRunning())
+				{
+					m_WriterEvent.Set();
+					Sleep(Microseconds(100));
+				}
+
+				// The dequeue position is passed before the messages are handled and flushed,
+				// wait for the writer to leave the handled batch. It holds the mutex across Pop, FireHandle and OnFlush.
+				SmartMutex smartMutex(g_Mutex);
+				smartMutex.Lock();
+			}
+
+			void Stop()
+			{
+				// Turn away new producers, and let the writer handle the queued messages.
+				m_State.store(Stopping);
+				m_WriterEvent.Set();
+				m_WriterThread.Finish();
+
+				// Wait for the producers that saw the running queue, and handle their messages.
+				while (m_ProducerCount.load() != 0)
+				{
+					std::this_thread::yield();
+				}
+
+				SmartMutex smartMutex(g_Mutex);
+				smartMutex.Lock();
+
+				LogMessage message;
+				Bool handled = false;
+				while (Pop(message))
+				{
+					FireHandle(message);
+					handled = true;
+				}
+				if (handled)
+				{
+					GetHandle().OnFlush();
+				}
+
+				m_State.store(Stopped);
+			}
+
+			Bool IsRunning() const
+			{
+				return m_State.load() != Stopped;
+			}
+
+			Uint64 GetDroppedCount() const
+			{
+				return m_DroppedCount.load(std::memory_order_relaxed);
+			}
+
+		private:
+
+			enum eState
+			{
+				Running,
+				Stopping,
+				Stopped
+			};
+
+			void WakeWriter()
+			{
+				// Pairs with the fence in WriterFunction, either the writer sees the record, or we see the sleeping writer.
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				if (m_WriterSleeping.load(std::memory_order_relaxed))
+				{
+					m_WriterEvent.Set();
+				}
+			}
+
+			Bool Pop(LogMessage & p_Message)
+			{
+				const Uint64 position = m_DequeuePosition.load(std::memory_order_relaxed);
+				LogRecord * pRecord = &m_pRecords[position & m_Mask];
+				if (pRecord->Sequence.load(std::memory_order_acquire) != position + 1)
+				{
+					return false;
+				}
+
+				p_Message.type = static_cast<Log::eType>(pRecord->Type);
+				p_Message.channel = pRecord->Channel;
+				p_Message.file = pRecord->pFile;
+				p_Message.line = pRecord->Line;
+				p_Message.function = pRecord->pFunction;
+				p_Message.timestamp = pRecord->Time;
+				p_Message.message.assign(pRecord->Message, pRecord->Size);
+
+				// Free the slot for the next lap.
+				pRecord->Sequence.store(position + LogManager::QueueSize, std::memory_order_release);
+				m_DequeuePosition.store(position + 1, std::memory_order_release);
+				return true;
+			}
+
+			void WriterFunction()
+			{
+				LogMessage message;
+				SizeType idleCount = 0;
+
+				while (true)
+				{
+					// Handle all the queued messages, exclusive with the messages handled
+					// by the producers while the writer is stopping.
+					g_Mutex.Lock();
+
+					SizeType handled = 0;
+					while (Pop(message))
+					{
+						FireHandle(message);
+						handled++;
+					}
+
+					// Report dropped messages.
+					const Uint64 droppedCount = m_DroppedCount.load(std::memory_order_relaxed);
+					if (droppedCount != m_ReportedDropCount)
+					{
+						std::stringstream ss;
+						ss << "Log queue full, dropped " << (droppedCount - m_ReportedDropCount) << " messages.";
+						message.type = Log::Warning;
+						message.channel = Log::System;
+						message.file = __FILE__;
+						message.line = __LINE__;
+						message.function = __FUNCTION__;
+						message.message = ss.str();
+						message.timestamp = Timestamp::Now();
+						FireHandle(message);
+						m_ReportedDropCount = droppedCount;
+						handled++;
+					}
+
+					if (handled)
+					{
+						GetHandle().OnFlush();
+					}
+
+					g_Mutex.Unlock();
+
+					if (handled)
+					{
+						idleCount = 0;
+						continue;
+					}
+
+					if (m_State.load() != Running)
+					{
+						return;
+					}
+
+					// Let the producers run for a while before sleeping, messages tend to come in bursts
+					// and waking up a sleeping writer for every message is expensive.
+					if (idleCount < MaxIdleCount)
+					{
+						idleCount++;
+						std::this_thread::yield();
+						continue;
+					}
+					idleCount = 0;
+
+					// Sleep until a message is posted.
+					m_WriterSleeping.store(true, std::memory_order_relaxed);
+					std::atomic_thread_fence(std::memory_order_seq_cst);
+					const Uint64 position = m_DequeuePosition.load(std::memory_order_relaxed);
+					if (m_pRecords[position & m_Mask].Sequence.load(std::memory_order_acquire) != position + 1 &&
+						m_DroppedCount.load(std::memory_order_relaxed) == m_ReportedDropCount &&
+						m_State.load() == Running)
+					{
+						m_WriterEvent.Wait(Milliseconds(100));
+					}
+					m_WriterSleeping.store(false, std::memory_order_relaxed);
+				}
+			}
+
+			// Private constants
+			static const SizeType	MaxIdleCount = 16;		///< Number of yields before the writer sleeps.
+
+			// Private variables
+			LogRecord *				m_pRecords;				///< Record slots, never deleted since messages may be posted at exit.
+			const Uint64			m_Mask;					///< Queue size - 1.
+			std::atomic<Uint64>		m_EnqueuePosition;		///< Next position to claim by the producers.
+			std::atomic<Uint64>		m_DequeuePosition;		///< Next position to handle by the writer.
+			std::atomic<Uint64>		m_DroppedCount;			///< Number of dropped messages.
+			Uint64					m_ReportedDropCount;	///< Number of dropped messages reported, only touched by the writer.
+			std::atomic<Uint32>		m_ProducerCount;		///< Number of producers in Push.
+			std::atomic<Bool>		m_WriterSleeping;		///< Flag for checking if the writer is about to sleep.
+			std::atomic<Int32>		m_State;				///< State of the writer thread.
+			ThreadEvent				m_WriterEvent;			///< Event for waking up the writer.
+			Thread					m_WriterThread;			///< Writer thread.
+
+		};
+
+		static LogFormatter & GetFormatter()
+		{
+			static thread_local LogFormatter formatter;
+			return formatter;
+		}
+
+		static void StopLogQueue();
+
+		static LogQueue & GetLogQueue()
+		{
+			// The queue is never destroyed, messages may still be posted by static destructors.
+			// The writer thread is stopped at exit, after that the messages are handled synchronously.
+			static LogQueue * pQueue = NULL;
+			static std::once_flag onceFlag;
+			std::call_once(onceFlag, []()
+			{
+				pQueue = new LogQueue;
+				std::atexit(StopLogQueue);
+			});
+			return *pQueue;
+		}
+
+		static void StopLogQueue()
+		{
+			GetLogQueue().Stop();
+		}
+
+
+		// Log manager class
+		void LogManager::Start(	const Uint32 p_Type,
+								const Uint32 p_Channel,
+								const char * p_pFile,
+								const Int32 p_Line,
+								const char * p_pFunction)
+		{
+			// Set message meta data.
+			LogFormatter & formatter = GetFormatter();
+			formatter.Type = p_Type;
+			formatter.Channel = p_Channel;
+			formatter.pFile = p_pFile;
+			formatter.Line = p_Line;
+			formatter.pFunction = p_pFunction;
+
+			// Clear the previous message, and the error state of a truncated message.
+			formatter.Buffer.Reset();
+			formatter.Stream.clear();
+		}
+
+		std::ostream & LogManager::GetStream()
+		{
+			return GetFormatter().Stream;
+		}
+
+		void LogManager::End()
+		{
+			LogFormatter & formatter = GetFormatter();
+
+			// Check the size.
+			if (formatter.Buffer.GetSize() == 0)
+			{
+				return;
+			}
+
+			// Take the time now, the writer may handle the message much later.
+			const Timestamp timestamp = Timestamp::Now();
+
+			// Post the message to the writer thread.
+			if (GetLogQueue().Push(formatter, timestamp))
+			{
+				return;
+			}
+
+			// The writer thread is stopping, handle the message right away.
+			LogMessage message;
+			message.type = static_cast<Log::eType>(formatter.Type);
+			message.channel = formatter.Channel;
+			message.file = formatter.pFile;
+			message.line = formatter.Line;
+			message.function = formatter.pFunction;
+			message.message.assign(formatter.Buffer.GetData(), formatter.Buffer.GetSize());
+			message.timestamp = timestamp;
+
+			SmartMutex smartMutex(g_Mutex);
+			smartMutex.Lock();
+			FireHandle(message);
+			GetHandle().OnFlush();
 		}
 
 		void LogManager::SetHandle(LogHandle & p_Handle)
 		{
-			g_CurrentLogHandle = &p_Handle;
+			g_CurrentLogHandle.store(&p_Handle);
 		}
 
 		LogHandle & LogManager::GetDefaultHandle()
@@ -122,6 +556,16 @@ namespace Bit
 			return g_DefaultLogHandle;
 		}
 
+		void LogManager::Flush()
+		{
+			GetLogQueue().Flush();
+		}
+
+		Uint64 LogManager::GetDroppedCount()
+		{
+			return GetLogQueue().GetDroppedCount();
+		}
+
 	}
 
 }
\ No newline at end of file
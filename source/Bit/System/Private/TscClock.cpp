@@ -0,0 +1,309 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/System/Private/TscClock.hpp>
+#include <Bit/System/Timer.hpp>
+#include <Bit/System/Sleep.hpp>
+#include <atomic>
+
+////////////////////////////////////////////////////////////////
+// Platform dependent includes
+////////////////////////////////////////////////////////////////
+#if defined( _M_IX86 ) || defined( _M_X64 )
+	#include <intrin.h>
+	#define BIT_TSC_CLOCK
+#elif defined( __i386__ ) || defined( __x86_64__ )
+	#include <x86intrin.h>
+	#include <cpuid.h>
+	#define BIT_TSC_CLOCK
+#endif
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	namespace Private
+	{
+
+#ifdef BIT_TSC_CLOCK
+
+		// Interval between the anchors of the counter to the system clock, in nanoseconds.
+		static const Uint64 g_AnchorInterval = 1000000000ULL;
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Anchor of the time stamp counter to the system clock.
+		///
+		/// Ticks are converted to nanoseconds by a 32.32 fixed point multiplier,
+		/// avoiding divisions when reading the clock.
+		///
+		////////////////////////////////////////////////////////////////
+		struct TscAnchor
+		{
+
+			TscAnchor( ) :
+				Ticks( 0 ),
+				Time( 0 ),
+				Multiplier( 0 )
+			{
+			}
+
+			std::atomic<Uint64>	Ticks;		///< Counter value at the anchor.
+			std::atomic<Uint64>	Time;		///< Time at the anchor, in nanoseconds.
+			std::atomic<Uint64>	Multiplier;	///< Nanoseconds per tick, 32.32 fixed point.
+
+		};
+
+		////////////////////////////////////////////////////////////////
+		/// \brief Calibration of the time stamp counter.
+		///
+		/// The counter is anchored to the system clock again every second,
+		/// by the first thread reading the clock after the interval.
+		/// The rate is measured over the last interval, and the difference
+		/// to the system clock is slewed away over the next interval,
+		/// keeping the time continuous and never going backwards.
+		///
+		/// The anchors are double buffered, the new anchor is written to the
+		/// unused buffer before the generation is increased. The readers
+		/// retry if the generation changed while reading the anchor.
+		///
+		////////////////////////////////////////////////////////////////
+		struct TscCalibration
+		{
+
+			TscCalibration( ) :
+				Available( false ),
+				Frequency( 0 ),
+				IntervalTicks( 0 ),
+				Generation( 0 ),
+				Anchoring( false ),
+				SystemTicks( 0 ),
+				SystemTime( 0 )
+			{
+				// Check for the invariant counter, cpuid leaf 0x80000007, bit 8 of edx.
+				unsigned int registers[ 4 ] = { 0, 0, 0, 0 };
+				#if defined( _M_IX86 ) || defined( _M_X64 )
+					__cpuid( reinterpret_cast<int *>( registers ), 0x80000000 );
+					if( registers[ 0 ] >= 0x80000007 )
+					{
+						__cpuid( reinterpret_cast<int *>( registers ), 0x80000007 );
+					}
+					else
+					{
+						registers[ 3 ] = 0;
+					}
+				#else
+					if( __get_cpuid( 0x80000007, &registers[ 0 ], &registers[ 1 ], &registers[ 2 ], &registers[ 3 ] ) == 0 )
+					{
+						registers[ 3 ] = 0;
+					}
+				#endif
+
+				if( ( registers[ 3 ] & ( 1 << 8 ) ) == 0 )
+				{
+					return;
+				}
+
+				// Count the ticks during a sleep.
+				const Uint64 startTime = Timer::GetSystemTimeNanoseconds( );
+				const Uint64 startTicks = __rdtsc( );
+				Sleep( Milliseconds( 10 ) );
+				const Uint64 endTime = Timer::GetSystemTimeNanoseconds( );
+				const Uint64 endTicks = __rdtsc( );
+
+				if( endTime <= startTime || endTicks <= startTicks )
+				{
+					return;
+				}
+
+				const Float64 ticksPerNanosecond =	static_cast<Float64>( endTicks - startTicks ) /
+													static_cast<Float64>( endTime - startTime );
+
+				Frequency.store( static_cast<Uint64>( ticksPerNanosecond * 1000000000.0 ) );
+				IntervalTicks = static_cast<Uint64>( ticksPerNanosecond * static_cast<Float64>( g_AnchorInterval ) );
+				Anchors[ 0 ].Ticks.store( endTicks );
+				Anchors[ 0 ].Time.store( endTime );
+				Anchors[ 0 ].Multiplier.store( static_cast<Uint64>( 4294967296.0 / ticksPerNanosecond ) );
+				SystemTicks = endTicks;
+				SystemTime = endTime;
+				Available = true;
+			}
+
+			Uint64 GetTime( )
+			{
+				while( true )
+				{
+					// Read the current anchor, and retry if it was replaced meanwhile.
+					const Uint32 generation = Generation.load( std::memory_order_acquire );
+					const TscAnchor & anchor = Anchors[ generation & 1 ];
+					const Uint64 baseTicks = anchor.Ticks.load( std::memory_order_relaxed );
+					const Uint64 baseTime = anchor.Time.load( std::memory_order_relaxed );
+					const Uint64 multiplier = anchor.Multiplier.load( std::memory_order_relaxed );
+					std::atomic_thread_fence( std::memory_order_acquire );
+					if( Generation.load( std::memory_order_relaxed ) != generation )
+					{
+						continue;
+					}
+
+					// The counters of the cores may be a few ticks apart, never go before the anchor.
+					const Uint64 ticks = __rdtsc( );
+					if( ticks <= baseTicks )
+					{
+						return baseTime;
+					}
+
+					const Uint64 time = baseTime + ToNanoseconds( ticks - baseTicks, multiplier );
+					if( ticks - baseTicks >= IntervalTicks )
+					{
+						Anchor( generation, ticks, time );
+					}
+
+					return time;
+				}
+			}
+
+			void Anchor( const Uint32 p_Generation, const Uint64 p_Ticks, const Uint64 p_Time )
+			{
+				// Let a single thread anchor the counter, the others keep reading the current anchor.
+				if( Anchoring.exchange( true, std::memory_order_acquire ) )
+				{
+					return;
+				}
+				if( Generation.load( std::memory_order_relaxed ) != p_Generation )
+				{
+					Anchoring.store( false, std::memory_order_release );
+					return;
+				}
+
+				// Keep the anchor writes after the generation read, see GetTime.
+				std::atomic_thread_fence( std::memory_order_release );
+
+				// Measure the rate over the last interval.
+				const Uint64 systemTime = Timer::GetSystemTimeNanoseconds( );
+				const Float64 nanosecondsPerTick =	static_cast<Float64>( systemTime - SystemTime ) /
+													static_cast<Float64>( p_Ticks - SystemTicks );
+
+				// Slew the difference to the system time away over the next interval.
+				// Step forward if far behind, and slow down to at most half the rate if ahead.
+				const Int64 interval = static_cast<Int64>( g_AnchorInterval );
+				Int64 difference = static_cast<Int64>( systemTime - p_Time );
+				Uint64 time = p_Time;
+				if( difference > interval )
+				{
+					time = systemTime;
+					difference = 0;
+				}
+				else if( difference < -interval / 2 )
+				{
+					difference = -interval / 2;
+				}
+
+				const Float64 slew = static_cast<Float64>( interval + difference ) / static_cast<Float64>( interval );
+
+				TscAnchor & anchor = Anchors[ ( p_Generation + 1 ) & 1 ];
+				anchor.Ticks.store( p_Ticks, std::memory_order_relaxed );
+				anchor.Time.store( time, std::memory_order_relaxed );
+				anchor.Multiplier.store( static_cast<Uint64>( nanosecondsPerTick * slew * 4294967296.0 ), std::memory_order_relaxed );
+				Generation.store( p_Generation + 1, std::memory_order_release );
+
+				Frequency.store( static_cast<Uint64>( 1000000000.0 / nanosecondsPerTick ), std::memory_order_relaxed );
+				SystemTicks = p_Ticks;
+				SystemTime = systemTime;
+				Anchoring.store( false, std::memory_order_release );
+			}
+
+			static Uint64 ToNanoseconds( const Uint64 p_Ticks, const Uint64 p_Multiplier )
+			{
+				// 64 x 64 bit multiplication, keeping bit 32 to 95 of the product.
+				#if defined( _M_X64 )
+					Uint64 high = 0;
+					const Uint64 low = _umul128( p_Ticks, p_Multiplier, &high );
+					return ( high << 32 ) | ( low >> 32 );
+				#elif defined( __x86_64__ )
+					return static_cast<Uint64>( ( static_cast<unsigned __int128>( p_Ticks ) * p_Multiplier ) >> 32 );
+				#else
+					const Uint64 low = ( p_Ticks & 0xFFFFFFFFULL ) * p_Multiplier;
+					const Uint64 high = ( p_Ticks >> 32 ) * p_Multiplier;
+					return high + ( low >> 32 );
+				#endif
+			}
+
+			Bool				Available;		///< Flag checking if the counter is invariant and calibrated.
+			std::atomic<Uint64>	Frequency;		///< Ticks per second, measured over the last interval.
+			Uint64				IntervalTicks;	///< Ticks between the anchors.
+			TscAnchor			Anchors[ 2 ];	///< Current and next anchor, indexed by the generation.
+			std::atomic<Uint32>	Generation;		///< Number of anchors made after the calibration.
+			std::atomic<Bool>	Anchoring;		///< Flag checking if a thread is anchoring the counter.
+			Uint64				SystemTicks;	///< Counter value at the last system time read, only touched while anchoring.
+			Uint64				SystemTime;		///< Last system time read, in nanoseconds, only touched while anchoring.
+
+		};
+
+		static TscCalibration & GetCalibration( )
+		{
+			static TscCalibration calibration;
+			return calibration;
+		}
+
+		Bool TscClock::IsAvailable( )
+		{
+			return GetCalibration( ).Available;
+		}
+
+		Uint64 TscClock::GetTime( )
+		{
+			TscCalibration & calibration = GetCalibration( );
+			if( calibration.Available == false )
+			{
+				return 0;
+			}
+
+			return calibration.GetTime( );
+		}
+
+		Uint64 TscClock::GetFrequency( )
+		{
+			return GetCalibration( ).Frequency.load( std::memory_order_relaxed );
+		}
+
+#else
+
+		Bool TscClock::IsAvailable( )
+		{
+			return false;
+		}
+
+		Uint64 TscClock::GetTime( )
+		{
+			return 0;
+		}
+
+		Uint64 TscClock::GetFrequency( )
+		{
+			return 0;
+		}
+
+#endif
+
+	}
+
+}
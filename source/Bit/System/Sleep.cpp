@@ -23,13 +23,15 @@
 // ///////////////////////////////////////////////////////////////////////////
 
 #include <Bit/System/Sleep.hpp>
+#include <Bit/System/Timer.hpp>
 #include <Bit/System/MemoryLeak.hpp>
 
 #include <float.h>
 #if defined( BIT_PLATFORM_WINDOWS )
 	#include <Windows.h>
 #elif defined( BIT_PLATFORM_LINUX )
-	#include <unistd.h>
+	#include <time.h>
+	#include <errno.h>
 #endif
 
 namespace Bit
@@ -41,7 +43,37 @@ namespace Bit
         // USE SELECT INSTEAD
 		::Sleep( static_cast<DWORD>( m_Time.AsMilliseconds( ) ) );
 #elif defined( BIT_PLATFORM_LINUX )
-		usleep( m_Time.AsMicroseconds( ) );
+		const Uint64 nanoseconds = m_Time.AsNanoseconds( );
+
+		timespec time;
+		time.tv_sec = static_cast<time_t>( nanoseconds / 1000000000ULL );
+		time.tv_nsec = static_cast<long>( nanoseconds % 1000000000ULL );
+
+		// Continue sleeping for the remaining time if interrupted by a signal.
+		while( clock_nanosleep( CLOCK_MONOTONIC, 0, &time, &time ) == EINTR )
+		{
+		}
+#endif
+	}
+
+	BIT_API void SleepUntil( const Time & p_Deadline )
+	{
+#if defined( BIT_PLATFORM_WINDOWS )
+		const Uint64 now = Timer::GetSystemTimeNanoseconds( );
+		if( p_Deadline.AsNanoseconds( ) > now )
+		{
+			Sleep( p_Deadline - Nanoseconds( now ) );
+		}
+#elif defined( BIT_PLATFORM_LINUX )
+		const Uint64 nanoseconds = p_Deadline.AsNanoseconds( );
+
+		timespec deadline;
+		deadline.tv_sec = static_cast<time_t>( nanoseconds / 1000000000ULL );
+		deadline.tv_nsec = static_cast<long>( nanoseconds % 1000000000ULL );
+
+		while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL ) == EINTR )
+		{
+		}
 #endif
 	}
 
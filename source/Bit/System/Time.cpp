@@ -28,116 +28,126 @@
 namespace Bit
 {
 
-	const Time Time::Infinite = Microseconds(0xFFFFFFFFFFFFFFFFULL);
-	const Time Time::Zero = Microseconds(0);
+	const Time Time::Infinite = Nanoseconds(0xFFFFFFFFFFFFFFFFULL);
+	const Time Time::Zero = Nanoseconds(0);
 
 
 	Time::Time() :
-		m_Microseconds(0)
+		m_Nanoseconds(0)
 	{
 	}
 
 	Float64 Time::AsSeconds() const
 	{
-		return static_cast<Float64>(m_Microseconds) / 1000000.0f;
+		return static_cast<Float64>(m_Nanoseconds) / 1000000000.0;
 	}
 
 	Uint64 Time::AsMilliseconds() const
 	{
-		return m_Microseconds / 1000ULL;
+		return m_Nanoseconds / 1000000ULL;
 	}
 
 	Uint64 Time::AsMicroseconds() const
 	{
-		return m_Microseconds;
+		return m_Nanoseconds / 1000ULL;
+	}
+
+	Uint64 Time::AsNanoseconds() const
+	{
+		return m_Nanoseconds;
 	}
 
 	Bool Time::operator == (const Time & p_Time) const
 	{
-		return m_Microseconds == p_Time.m_Microseconds;
+		return m_Nanoseconds == p_Time.m_Nanoseconds;
 	}
 
 	Bool Time::operator != (const Time & p_Time) const
 	{
-		return m_Microseconds != p_Time.m_Microseconds;
+		return m_Nanoseconds != p_Time.m_Nanoseconds;
 	}
 
 	Bool Time::operator > (const Time & p_Time) const
 	{
-		return m_Microseconds > p_Time.m_Microseconds;
+		return m_Nanoseconds > p_Time.m_Nanoseconds;
 	}
 
 	Bool Time::operator < (const Time & p_Time) const
 	{
-		return m_Microseconds < p_Time.m_Microseconds;
+		return m_Nanoseconds < p_Time.m_Nanoseconds;
 	}
 
 	Bool Time::operator >= (const Time & p_Time) const
 	{
-		return m_Microseconds >= p_Time.m_Microseconds;
+		return m_Nanoseconds >= p_Time.m_Nanoseconds;
 	}
 
 	Bool Time::operator <= (const Time & p_Time) const
 	{
-		return m_Microseconds <= p_Time.m_Microseconds;
+		return m_Nanoseconds <= p_Time.m_Nanoseconds;
 	}
 
 	Time Time::operator + (const Time & p_Time) const
 	{
-		return Time(m_Microseconds + p_Time.m_Microseconds);
+		return Time(m_Nanoseconds + p_Time.m_Nanoseconds);
 	}
 
 	Time & Time::operator += (const Time & p_Time)
 	{
-		m_Microseconds += p_Time.m_Microseconds;
+		m_Nanoseconds += p_Time.m_Nanoseconds;
 		return *this;
 	}
 
 	Time Time::operator - (const Time & p_Time) const
 	{
-		if (p_Time.m_Microseconds > m_Microseconds)
+		if (p_Time.m_Nanoseconds > m_Nanoseconds)
 		{
 			return Time(0);
 		}
 
-		return Time(m_Microseconds - p_Time.m_Microseconds);
+		return Time(m_Nanoseconds - p_Time.m_Nanoseconds);
 	}
 
 	Time Time::operator * (const Uint64 & p_Value) const
 	{
-		return Time(m_Microseconds * p_Value);
+		return Time(m_Nanoseconds * p_Value);
 	}
 
 	Time Time::operator / (const Uint64 & p_Value) const
 	{
-		return Time(m_Microseconds / p_Value);
+		return Time(m_Nanoseconds / p_Value);
 	}
 
 	Time Time::operator % (const Time & p_Time) const
 	{
-		return Time(m_Microseconds % p_Time.m_Microseconds);
+		return Time(m_Nanoseconds % p_Time.m_Nanoseconds);
 	}
 
 	// Private functions
-	Time::Time( const Uint64 & p_Microseconds ) :
-		m_Microseconds( p_Microseconds )
+	Time::Time( const Uint64 & p_Nanoseconds ) :
+		m_Nanoseconds( p_Nanoseconds )
 	{
 	}
 
 	// Functions for initializing time classes
 	BIT_API Time Seconds( const Float64 & p_Seconds )
 	{
-		return Time( static_cast<Uint64>( p_Seconds * 1000000.0f ) );
+		return Time( static_cast<Uint64>( p_Seconds * 1000000000.0 ) );
 	}
 
 	BIT_API Time Milliseconds( const Uint64 & p_Milliseconds )
 	{
-		return Time( p_Milliseconds * 1000ULL );
+		return Time( p_Milliseconds * 1000000ULL );
 	}
 
 	BIT_API Time Microseconds( const Uint64 & p_Microseconds )
 	{
-		return Time( p_Microseconds );
+		return Time( p_Microseconds * 1000ULL );
+	}
+
+	BIT_API Time Nanoseconds( const Uint64 & p_Nanoseconds )
+	{
+		return Time( p_Nanoseconds );
 	}
 
 }
\ No newline at end of file
@@ -23,6 +23,7 @@
 // ///////////////////////////////////////////////////////////////////////////
 
 #include <Bit/System/Timer.hpp>
+#include <Bit/System/Private/TscClock.hpp>
 #include <ctime>
 #include <Bit/System/MemoryLeak.hpp>
 
@@ -32,13 +33,14 @@
 #ifdef BIT_PLATFORM_WINDOWS
 	#include <windows.h>
 #elif defined( BIT_PLATFORM_LINUX )
-	#include <sys/time.h>
+	#include <time.h>
 #endif
 
 namespace Bit
 {
 
-	Timer::Timer( ) :
+	Timer::Timer( const ClockType::eType p_ClockType ) :
+		m_ClockType( p_ClockType ),
 		m_StartTime( 0 ),
 		m_Time( 0 )
 	{
@@ -46,52 +48,87 @@ namespace Bit
 
 	void Timer::Start( )
 	{
-		m_StartTime = GetSystemTime( );
+		m_StartTime = GetClockTime( );
 	}
 
 	void Timer::Stop( )
 	{
-		Uint64 CurrentTime = GetSystemTime( );
+		Uint64 CurrentTime = GetClockTime( );
 
 		m_Time = ( CurrentTime - m_StartTime );
 	}
 
 	Time Timer::GetTime( )
 	{
-		return Microseconds( m_Time );
+		return Nanoseconds( m_Time );
 	}
 
 	Time Timer::GetLapsedTime( )
 	{
 		Stop( );
-		return Microseconds( m_Time );
+		return Nanoseconds( m_Time );
 	}
 
 	Uint64 Timer::GetSystemTime( )
+	{
+		return GetSystemTimeNanoseconds( ) / 1000ULL;
+	}
+
+	Uint64 Timer::GetSystemTimeNanoseconds( )
 	{
 		// Windows implementation.
 		#ifdef BIT_PLATFORM_WINDOWS
 
-			Int64 counter = 0;
-			Int64 frequency = 0;
+			static Int64 frequency = 0;
+			if( frequency == 0 )
+			{
+				QueryPerformanceFrequency( (LARGE_INTEGER*)&frequency );
+			}
 
+			Int64 counter = 0;
 			QueryPerformanceCounter( (LARGE_INTEGER*)&counter );
-			QueryPerformanceFrequency( (LARGE_INTEGER*)&frequency );
 
-			Float64 timeFloat = (static_cast<Float64>(counter) * 1000000.0f ) / static_cast<Float64>(frequency);
-			return static_cast<Uint64>(timeFloat);
+			// Split the conversion, the counter times one billion would overflow after a few hours.
+			return	static_cast<Uint64>( counter / frequency ) * 1000000000ULL +
+					static_cast<Uint64>( counter % frequency ) * 1000000000ULL / static_cast<Uint64>( frequency );
 
 		// Linux implementation.
 		#elif defined( BIT_PLATFORM_LINUX )
 
-			timeval Time;
-			gettimeofday( &Time, 0 );
+			// The monotonic clock is not affected by changes of the wall clock.
+			timespec time;
+			clock_gettime( CLOCK_MONOTONIC, &time );
 
-			return	static_cast< Int64 >( Time.tv_sec ) * 1000000 +
-					static_cast< Int64 >( Time.tv_usec );
+			return	static_cast< Uint64 >( time.tv_sec ) * 1000000000ULL +
+					static_cast< Uint64 >( time.tv_nsec );
 
 		#endif
 	}
 
-}
+	Uint64 Timer::GetTscTime( )
+	{
+		const Uint64 time = Private::TscClock::GetTime( );
+		if( time == 0 )
+		{
+			return GetSystemTimeNanoseconds( );
+		}
+
+		return time;
+	}
+
+	Bool Timer::IsTscAvailable( )
+	{
+		return Private::TscClock::IsAvailable( );
+	}
+
+	Uint64 Timer::GetClockTime( ) const
+	{
+		if( m_ClockType == ClockType::Tsc )
+		{
+			return GetTscTime( );
+		}
+
+		return GetSystemTimeNanoseconds( );
+	}
 
+}
\ No newline at end of file
@@ -172,8 +172,13 @@ namespace Bit
 		time_t now = time(0);
 		//tm * localtm = localtime(&now);
 		tm * localtm = new tm;
+	#if defined( BIT_PLATFORM_WINDOWS )
 		if (localtime_s(localtm, &now) != 0)
+	#else
+		if (localtime_r(&now, localtm) == NULL)
+	#endif
 		{
+			delete localtm;
 			return Timestamp();
 		}
 
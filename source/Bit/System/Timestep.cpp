@@ -25,44 +25,71 @@
 #include <Bit/System/Timestep.hpp>
 #include <Bit/System/Timer.hpp>
 #include <Bit/System/Sleep.hpp>
-#include <complex>
-#include <iostream>
+#include <thread>
 #include <Bit/System/MemoryLeak.hpp>
 
 namespace Bit
 {
 
-	Timestep::Timestep(  )
+	Timestep::Timestep( const Time & p_SpinTime ) :
+		m_SpinTime( p_SpinTime.AsNanoseconds( ) ),
+		m_UpdateTime( 0 ),
+		m_NextTick( 0 )
 	{
 	}
 
 	Time Timestep::Execute( const Time & p_UpdateTime, Function p_Function )
 	{
-		// Start a timer
-		Timer timer;
-		timer.Start( );
+		const Uint64 updateTime = p_UpdateTime.AsNanoseconds( );
+
+		// Start a new schedule at the current time.
+		if( m_NextTick == 0 || m_UpdateTime != updateTime )
+		{
+			m_UpdateTime = updateTime;
+			m_NextTick = Timer::GetSystemTimeNanoseconds( );
+		}
 
 		// Call the function
 		p_Function( );
 
-		// Calculate the sleep time
-		timer.Stop( );
-		Time sleepTime = p_UpdateTime - timer.GetTime( );
-		Float64 exceeded = std::abs<Float64>( p_UpdateTime.AsSeconds( ) - timer.GetTime( ).AsSeconds( ) );
+		// The next deadline is relative to the previous one, not to the current time,
+		// a late tick is shortening the wait for the following one.
+		m_NextTick += m_UpdateTime;
 
-		// Sleep for some time
-		if( exceeded > 0.0f )
+		Uint64 time = Timer::GetSystemTimeNanoseconds( );
+		if( time >= m_NextTick )
 		{
-			Sleep( sleepTime );
+			const Uint64 exceeded = time - m_NextTick;
+
+			// Skip the missed ticks if more than one tick late.
+			if( exceeded > m_UpdateTime )
+			{
+				m_NextTick = time;
+			}
+
+			// Return the exceeded time
+			return Nanoseconds( exceeded );
 		}
-		else
+
+		// Sleep until shortly before the deadline.
+		if( m_NextTick - time > m_SpinTime )
 		{
-			// Return the exceeded time
-			return Seconds( exceeded );
+			SleepUntil( Nanoseconds( m_NextTick - m_SpinTime ) );
 		}
-	
+
+		// Spin for the remaining time.
+		while( Timer::GetSystemTimeNanoseconds( ) < m_NextTick )
+		{
+			std::this_thread::yield( );
+		}
+
 		// Succeeded in time.
 		return Microseconds( 0 );
 	}
 
+	void Timestep::Reset( )
+	{
+		m_NextTick = 0;
+	}
+
 }
\ No newline at end of file
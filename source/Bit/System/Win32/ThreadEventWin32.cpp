@@ -0,0 +1,73 @@
+// Copyright (C) 2013 Jimmie Bergmann - jimmiebergmann@gmail.com
+//
+// This software is provided 'as-is', without any express or
+// implied warranty. In no event will the authors be held
+// liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute
+// it freely, subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but
+//    is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any
+//    source distribution.
+// ///////////////////////////////////////////////////////////////////////////
+
+#include <Bit/System/Win32/ThreadEventWin32.hpp>
+#ifdef BIT_PLATFORM_WINDOWS
+#include <Bit/System/MemoryLeak.hpp>
+
+namespace Bit
+{
+
+	ThreadEventWin32::ThreadEventWin32( const Bool p_ManualReset, const Bool p_InitialState )
+	{
+		m_Event = CreateEvent( NULL, p_ManualReset ? TRUE : FALSE, p_InitialState ? TRUE : FALSE, NULL );
+	}
+
+	ThreadEventWin32::~ThreadEventWin32( )
+	{
+		CloseHandle( m_Event );
+	}
+
+	void ThreadEventWin32::Set( )
+	{
+		SetEvent( m_Event );
+	}
+
+	void ThreadEventWin32::Reset( )
+	{
+		ResetEvent( m_Event );
+	}
+
+	void ThreadEventWin32::Wait( )
+	{
+		WaitForSingleObject( m_Event, INFINITE );
+	}
+
+	void ThreadEventWin32::Wait( const Time & p_Timeout )
+	{
+		DWORD time = static_cast<DWORD>( p_Timeout.AsMilliseconds( ) );
+
+		// Do not timeout
+		if( time == 0 )
+		{
+			WaitForSingleObject( m_Event, INFINITE );
+			return;
+		}
+
+		// Wait for the event to be signaled, with timeout
+		WaitForSingleObject( m_Event, time );
+	}
+
+}
+
+#endif